@@ -1,5 +1,32 @@
 #include "internal.h"
 
+// Point the access context at the rows that are stored contiguously with the row at the 0-based index.
+static bool map_access_rows(access_cxt_t* acxt, uint32_t row_index, bool make_writable)
+{
+    mdtable_t* table = acxt->table;
+    assert(row_index < acxt->rows_end);
+
+    if (make_writable)
+    {
+        // Read from the writable copy so reads observe prior writes.
+        uint8_t* row_data = get_writable_table_row(table, row_index);
+        if (row_data == NULL)
+            return false;
+        acxt->writable_data = row_data + acxt->col_offset;
+        acxt->data = acxt->writable_data;
+    }
+    else
+    {
+        acxt->data = get_table_row_data(table, row_index) + acxt->col_offset;
+    }
+
+    // Compute the beginning of the row after the last valid row.
+    acxt->contiguous_rows_end = get_table_contiguous_rows_end(table, row_index);
+    uint32_t last_row = acxt->rows_end < acxt->contiguous_rows_end ? acxt->rows_end : acxt->contiguous_rows_end;
+    acxt->end = acxt->data - acxt->col_offset + ((size_t)(last_row - row_index) * table->row_size_bytes);
+    return true;
+}
+
 bool create_access_context(mdcursor_t* cursor, col_index_t col_idx, uint32_t row_count, bool make_writable, access_cxt_t* acxt)
 {
     assert(acxt != NULL);
@@ -20,25 +47,16 @@ bool create_access_context(mdcursor_t* cursor, col_index_t col_idx, uint32_t row
     acxt->col_details = table->column_details[idx];
 
     // Compute the offset into the first row.
-    uint32_t offset = ExtractOffset(acxt->col_details);
+    acxt->col_offset = ExtractOffset(acxt->col_details);
 
-    if (make_writable)
-    {
-        acxt->writable_data = get_writable_table_data(table, make_writable);
-        acxt->writable_data = acxt->writable_data + (row * table->row_size_bytes) + offset;
-    }
-    else
-    {
-        acxt->writable_data = NULL;
-    }
-    
-    acxt->start = acxt->data = table->data.ptr + (row * table->row_size_bytes) + offset;
+    // Compute the row after the last valid row.
+    acxt->rows_end = (row_count > table->row_count - row) ? table->row_count : row + row_count;
 
-    // Compute the beginning of the row after the last valid row.
-    uint32_t last_row = row + row_count;
-    if (last_row > table->row_count)
-        last_row = table->row_count;
-    acxt->end = table->data.ptr + (last_row * table->row_size_bytes);
+    acxt->writable_data = NULL;
+    if (!map_access_rows(acxt, row, make_writable))
+        return false;
+
+    acxt->start = acxt->data;
 
     // Limit the data read to the width of the column
     acxt->data_len_col = (acxt->col_details & mdtc_b2) ? 2 : 4;
@@ -86,5 +104,13 @@ bool next_row(access_cxt_t* acxt)
 
     // Restore the data length of the column data.
     acxt->data_len = acxt->data_len_col;
-    return acxt->data < acxt->end;
+    if (acxt->data < acxt->end)
+        return true;
+
+    // Tables edited in place are split into segments,
+    // so the next row may not be contiguous with this one.
+    if (acxt->contiguous_rows_end < acxt->rows_end)
+        return map_access_rows(acxt, acxt->contiguous_rows_end, acxt->writable_data != NULL);
+
+    return false;
 }
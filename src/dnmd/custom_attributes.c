@@ -0,0 +1,941 @@
+#include "internal.h"
+
+// Custom attribute value blobs - ECMA-335 II.23.3
+
+// The type of an argument as it is serialized.
+typedef struct ca_type__
+{
+    uint8_t type_code; // SERIALIZATION_TYPE_*
+    uint8_t element_type_code; // For arrays, the SERIALIZATION_TYPE_* of the elements.
+    uint8_t underlying_type_code; // 0 for enums that aren't defined in the metadata.
+    mdToken enum_type;
+    char const* enum_type_name;
+    uint32_t enum_type_name_len;
+} ca_type_t;
+
+typedef struct ca_ctor_sig__
+{
+    uint32_t param_count;
+    ca_type_t params[];
+} ca_ctor_sig_t;
+
+// Parsed constructor signatures are indexed by MethodDef row, then by MemberRef row.
+// The row counts are fixed for the lifetime of the cache as any edit releases it.
+struct mdca_cache__
+{
+    uint32_t methoddef_count;
+    uint32_t memberref_count;
+    ca_ctor_sig_t* volatile ctors[];
+};
+
+void free_ca_cache(mdcxt_t* cxt)
+{
+    assert(cxt != NULL);
+    mdca_cache_t* cache = cxt->ca_cache;
+    if (cache == NULL)
+        return;
+
+    for (uint32_t i = 0; i < cache->methoddef_count + cache->memberref_count; ++i)
+        free(cache->ctors[i]);
+    free(cache);
+    cxt->ca_cache = NULL;
+}
+
+static bool is_integer_type(uint32_t type_code)
+{
+    switch (type_code)
+    {
+        case ELEMENT_TYPE_BOOLEAN:
+        case ELEMENT_TYPE_CHAR:
+        case ELEMENT_TYPE_I1:
+        case ELEMENT_TYPE_U1:
+        case ELEMENT_TYPE_I2:
+        case ELEMENT_TYPE_U2:
+        case ELEMENT_TYPE_I4:
+        case ELEMENT_TYPE_U4:
+        case ELEMENT_TYPE_I8:
+        case ELEMENT_TYPE_U8:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool is_primitive_type(uint32_t type_code)
+{
+    return is_integer_type(type_code)
+        || type_code == ELEMENT_TYPE_R4
+        || type_code == ELEMENT_TYPE_R8;
+}
+
+static bool read_type_def_or_ref(uint8_t const** sig, size_t* sig_len, mdToken* type)
+{
+    uint32_t raw;
+    mdtable_id_t table;
+    uint32_t row;
+    if (!decompress_u32(sig, sig_len, &raw)
+        || !decompose_coded_index(raw, mdtc_idx_coded | InsertCodedIndex(mdci_TypeDefOrRef), &table, &row))
+    {
+        return false;
+    }
+
+    *type = CreateTokenType(table) | row;
+    return true;
+}
+
+// Skip a Type in a signature - ECMA-335 II.23.2.12
+static bool skip_type(uint8_t const** sig, size_t* sig_len)
+{
+    uint8_t element_type;
+    uint32_t raw;
+    for (;;)
+    {
+        if (!read_u8(sig, sig_len, &element_type))
+            return false;
+
+        switch (element_type)
+        {
+            case ELEMENT_TYPE_CMOD_OPT:
+            case ELEMENT_TYPE_CMOD_REQD:
+                if (!decompress_u32(sig, sig_len, &raw))
+                    return false;
+                continue;
+            // Prefixes of another type.
+            case ELEMENT_TYPE_PINNED:
+            case ELEMENT_TYPE_BYREF:
+            case ELEMENT_TYPE_SZARRAY:
+            case ELEMENT_TYPE_PTR:
+                continue;
+            case ELEMENT_TYPE_CLASS:
+            case ELEMENT_TYPE_VALUETYPE:
+            case ELEMENT_TYPE_VAR:
+            case ELEMENT_TYPE_MVAR:
+                return decompress_u32(sig, sig_len, &raw);
+            case ELEMENT_TYPE_ARRAY:
+            {
+                // ArrayShape - ECMA-335 II.23.2.13
+                uint32_t rank;
+                uint32_t count;
+                if (!skip_type(sig, sig_len)
+                    || !decompress_u32(sig, sig_len, &rank)
+                    || !decompress_u32(sig, sig_len, &count))
+                {
+                    return false;
+                }
+
+                // Signed compression uses the same encoded lengths, so the sizes
+                // and lower bounds can be skipped the same way.
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    if (!decompress_u32(sig, sig_len, &raw))
+                        return false;
+                }
+                if (!decompress_u32(sig, sig_len, &count))
+                    return false;
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    if (!decompress_u32(sig, sig_len, &raw))
+                        return false;
+                }
+                return true;
+            }
+            case ELEMENT_TYPE_GENERICINST:
+            {
+                uint32_t count;
+                if (!read_u8(sig, sig_len, &element_type)
+                    || !decompress_u32(sig, sig_len, &raw)
+                    || !decompress_u32(sig, sig_len, &count))
+                {
+                    return false;
+                }
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    if (!skip_type(sig, sig_len))
+                        return false;
+                }
+                return true;
+            }
+            case ELEMENT_TYPE_FNPTR:
+            {
+                // MethodDefSig or MethodRefSig - ECMA-335 II.23.2.1 and II.23.2.2
+                uint8_t calling_convention;
+                uint32_t count;
+                if (!read_u8(sig, sig_len, &calling_convention))
+                    return false;
+                if ((calling_convention & IMAGE_CEE_CS_CALLCONV_GENERIC) && !decompress_u32(sig, sig_len, &raw))
+                    return false;
+                if (!decompress_u32(sig, sig_len, &count) || !skip_type(sig, sig_len))
+                    return false;
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    if (*sig_len > 0 && **sig == ELEMENT_TYPE_SENTINEL)
+                        (void)advance_stream(sig, sig_len, 1);
+                    if (!skip_type(sig, sig_len))
+                        return false;
+                }
+                return true;
+            }
+            case ELEMENT_TYPE_VOID:
+            case ELEMENT_TYPE_STRING:
+            case ELEMENT_TYPE_TYPEDBYREF:
+            case ELEMENT_TYPE_I:
+            case ELEMENT_TYPE_U:
+            case ELEMENT_TYPE_OBJECT:
+                return true;
+            default:
+                return is_primitive_type(element_type);
+        }
+    }
+}
+
+static bool get_type_name(mdcxt_t* cxt, mdToken type, char const** nspace, char const** name)
+{
+    mdcursor_t cursor;
+    if (!md_token_to_cursor(cxt, type, &cursor))
+        return false;
+
+    switch (ExtractTokenType(type))
+    {
+        case mdtid_TypeDef:
+            return 1 == md_get_column_value_as_utf8(cursor, mdtTypeDef_TypeNamespace, 1, nspace)
+                && 1 == md_get_column_value_as_utf8(cursor, mdtTypeDef_TypeName, 1, name);
+        case mdtid_TypeRef:
+            return 1 == md_get_column_value_as_utf8(cursor, mdtTypeRef_TypeNamespace, 1, nspace)
+                && 1 == md_get_column_value_as_utf8(cursor, mdtTypeRef_TypeName, 1, name);
+        default:
+            return false;
+    }
+}
+
+// Find a TypeDef that isn't nested in another type by its namespace and name.
+// The strings are not null-terminated.
+static bool find_type_def(mdcxt_t* cxt, char const* nspace, size_t nspace_len, char const* name, size_t name_len, mdcursor_t* type_def)
+{
+    mdcursor_t cursor;
+    uint32_t count;
+    if (!md_create_cursor(cxt, mdtid_TypeDef, &cursor, &count))
+        return false;
+
+    for (uint32_t i = 0; i < count; ++i, (void)md_cursor_next(&cursor))
+    {
+        uint32_t flags;
+        char const* type_nspace;
+        char const* type_name;
+        if (1 != md_get_column_value_as_constant(cursor, mdtTypeDef_Flags, 1, &flags)
+            || 1 != md_get_column_value_as_utf8(cursor, mdtTypeDef_TypeName, 1, &type_name)
+            || 1 != md_get_column_value_as_utf8(cursor, mdtTypeDef_TypeNamespace, 1, &type_nspace))
+        {
+            return false;
+        }
+
+        if (IsTdNested(flags))
+            continue;
+
+        if (strncmp(type_name, name, name_len) == 0 && type_name[name_len] == '\0'
+            && strncmp(type_nspace, nspace, nspace_len) == 0 && type_nspace[nspace_len] == '\0')
+        {
+            *type_def = cursor;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Get the underlying type of an enum from the type of its instance field - ECMA-335 II.14.3
+static bool get_enum_underlying_type(mdcursor_t type_def, uint8_t* underlying_type)
+{
+    mdcursor_t field;
+    uint32_t count;
+    if (!md_get_column_value_as_range(type_def, mdtTypeDef_FieldList, &field, &count))
+        return false;
+
+    for (uint32_t i = 0; i < count; ++i, (void)md_cursor_next(&field))
+    {
+        mdcursor_t target;
+        uint32_t flags;
+        if (!md_resolve_indirect_cursor(field, &target)
+            || 1 != md_get_column_value_as_constant(target, mdtField_Flags, 1, &flags))
+        {
+            return false;
+        }
+
+        if (IsFdStatic(flags))
+            continue;
+
+        // FieldSig - ECMA-335 II.23.2.4
+        uint8_t const* sig;
+        uint32_t sig_len_raw;
+        if (1 != md_get_column_value_as_blob(target, mdtField_Signature, 1, &sig, &sig_len_raw))
+            return false;
+
+        size_t sig_len = sig_len_raw;
+        uint8_t kind;
+        if (!read_u8(&sig, &sig_len, &kind) || kind != IMAGE_CEE_CS_CALLCONV_FIELD)
+            return false;
+
+        uint8_t element_type;
+        uint32_t raw;
+        for (;;)
+        {
+            if (!read_u8(&sig, &sig_len, &element_type))
+                return false;
+            if (element_type != ELEMENT_TYPE_CMOD_OPT && element_type != ELEMENT_TYPE_CMOD_REQD)
+                break;
+            if (!decompress_u32(&sig, &sig_len, &raw))
+                return false;
+        }
+
+        if (!is_integer_type(element_type))
+            return false;
+        *underlying_type = element_type;
+        return true;
+    }
+    return false;
+}
+
+// Resolve the underlying type of an enum referenced from a signature.
+// Enums defined outside of the metadata are resolved when a value is parsed.
+static void resolve_enum_type(mdcxt_t* cxt, mdToken enum_type, ca_type_t* type)
+{
+    type->type_code = SERIALIZATION_TYPE_ENUM;
+    type->enum_type = enum_type;
+
+    mdcursor_t type_def;
+    bool found = false;
+    if (ExtractTokenType(enum_type) == mdtid_TypeDef)
+    {
+        found = md_token_to_cursor(cxt, enum_type, &type_def);
+    }
+    else if (ExtractTokenType(enum_type) == mdtid_TypeRef)
+    {
+        // A reference to a type in this module is scoped to the module.
+        mdcursor_t type_ref;
+        mdToken scope;
+        char const* nspace;
+        char const* name;
+        found = md_token_to_cursor(cxt, enum_type, &type_ref)
+            && 1 == md_get_column_value_as_token(type_ref, mdtTypeRef_ResolutionScope, 1, &scope)
+            && ExtractTokenType(scope) == mdtid_Module
+            && get_type_name(cxt, enum_type, &nspace, &name)
+            && find_type_def(cxt, nspace, strlen(nspace), name, strlen(name), &type_def);
+    }
+
+    if (!found || !get_enum_underlying_type(type_def, &type->underlying_type_code))
+        type->underlying_type_code = 0;
+}
+
+// Resolve the underlying type of an enum from its serialized name.
+// The name is in the format of Type.GetType(), so may be assembly qualified.
+// Only enums defined in the metadata, and not nested in another type, are resolved.
+// Other enums are resolved when a value is parsed.
+static void resolve_enum_type_name(mdcxt_t* cxt, char const* enum_type_name, uint32_t enum_type_name_len, ca_type_t* type)
+{
+    type->type_code = SERIALIZATION_TYPE_ENUM;
+    type->enum_type_name = enum_type_name;
+    type->enum_type_name_len = enum_type_name_len;
+
+    size_t full_name_len = 0;
+    size_t last_dot = SIZE_MAX;
+    bool nested = false;
+    for (; full_name_len < enum_type_name_len && enum_type_name[full_name_len] != ','; ++full_name_len)
+    {
+        if (enum_type_name[full_name_len] == '.')
+            last_dot = full_name_len;
+        else if (enum_type_name[full_name_len] == '+')
+            nested = true;
+    }
+
+    mdcursor_t type_def;
+    bool found = false;
+    if (!nested)
+    {
+        found = last_dot == SIZE_MAX
+            ? find_type_def(cxt, "", 0, enum_type_name, full_name_len, &type_def)
+            : find_type_def(cxt, enum_type_name, last_dot, enum_type_name + last_dot + 1, full_name_len - last_dot - 1, &type_def);
+    }
+
+    if (!found || !get_enum_underlying_type(type_def, &type->underlying_type_code))
+        type->underlying_type_code = 0;
+}
+
+// Find the signature of a generic argument of the type that declares a constructor.
+static bool get_generic_argument(mdcxt_t* cxt, mdcursor_t ctor, uint32_t index, uint8_t const** arg_sig, size_t* arg_sig_len)
+{
+    // Only a MemberRef can reference a constructor on an instantiated generic type.
+    mdToken ctor_tk;
+    mdToken parent;
+    mdcursor_t type_spec;
+    uint8_t const* sig;
+    uint32_t sig_len_raw;
+    if (!md_cursor_to_token(ctor, &ctor_tk)
+        || ExtractTokenType(ctor_tk) != mdtid_MemberRef
+        || 1 != md_get_column_value_as_token(ctor, mdtMemberRef_Class, 1, &parent)
+        || ExtractTokenType(parent) != mdtid_TypeSpec
+        || !md_token_to_cursor(cxt, parent, &type_spec)
+        || 1 != md_get_column_value_as_blob(type_spec, mdtTypeSpec_Signature, 1, &sig, &sig_len_raw))
+    {
+        return false;
+    }
+
+    size_t sig_len = sig_len_raw;
+    uint8_t element_type;
+    mdToken generic_type;
+    uint32_t count;
+    if (!read_u8(&sig, &sig_len, &element_type)
+        || element_type != ELEMENT_TYPE_GENERICINST
+        || !read_u8(&sig, &sig_len, &element_type)
+        || !read_type_def_or_ref(&sig, &sig_len, &generic_type)
+        || !decompress_u32(&sig, &sig_len, &count)
+        || index >= count)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < index; ++i)
+    {
+        if (!skip_type(&sig, &sig_len))
+            return false;
+    }
+
+    *arg_sig = sig;
+    *arg_sig_len = sig_len;
+    return true;
+}
+
+// Parse the type of a constructor parameter into the type it is serialized as.
+static bool parse_ctor_param(mdcxt_t* cxt, mdcursor_t ctor, uint8_t const** sig, size_t* sig_len, bool allow_array, bool allow_generic, ca_type_t* type)
+{
+    uint8_t element_type;
+    uint32_t raw;
+    for (;;)
+    {
+        if (!read_u8(sig, sig_len, &element_type))
+            return false;
+        if (element_type != ELEMENT_TYPE_CMOD_OPT && element_type != ELEMENT_TYPE_CMOD_REQD)
+            break;
+        if (!decompress_u32(sig, sig_len, &raw))
+            return false;
+    }
+
+    mdToken class_type;
+    char const* nspace;
+    char const* name;
+    switch (element_type)
+    {
+        case ELEMENT_TYPE_STRING:
+            type->type_code = SERIALIZATION_TYPE_STRING;
+            return true;
+        case ELEMENT_TYPE_OBJECT:
+            type->type_code = SERIALIZATION_TYPE_TAGGED_OBJECT;
+            return true;
+        case ELEMENT_TYPE_CLASS:
+            // System.Type is the only class other than System.String and System.Object
+            // that can be a custom attribute argument.
+            if (!read_type_def_or_ref(sig, sig_len, &class_type)
+                || !get_type_name(cxt, class_type, &nspace, &name)
+                || strcmp(nspace, "System") != 0
+                || strcmp(name, "Type") != 0)
+            {
+                return false;
+            }
+            type->type_code = SERIALIZATION_TYPE_TYPE;
+            return true;
+        case ELEMENT_TYPE_VALUETYPE:
+            if (!read_type_def_or_ref(sig, sig_len, &class_type))
+                return false;
+            resolve_enum_type(cxt, class_type, type);
+            return true;
+        case ELEMENT_TYPE_SZARRAY:
+        {
+            ca_type_t element = { 0 };
+            if (!allow_array || !parse_ctor_param(cxt, ctor, sig, sig_len, false, allow_generic, &element))
+                return false;
+            *type = element;
+            type->type_code = SERIALIZATION_TYPE_SZARRAY;
+            type->element_type_code = element.type_code;
+            return true;
+        }
+        case ELEMENT_TYPE_VAR:
+        {
+            // A generic attribute's constructor refers to the type arguments of the attribute type.
+            uint8_t const* arg_sig;
+            size_t arg_sig_len;
+            return allow_generic
+                && decompress_u32(sig, sig_len, &raw)
+                && get_generic_argument(cxt, ctor, raw, &arg_sig, &arg_sig_len)
+                && parse_ctor_param(cxt, ctor, &arg_sig, &arg_sig_len, allow_array, false, type);
+        }
+        default:
+            if (!is_primitive_type(element_type))
+                return false;
+            type->type_code = element_type;
+            return true;
+    }
+}
+
+// Parse a constructor's MethodDefSig or MethodRefSig - ECMA-335 II.23.2.1 and II.23.2.2
+static md_blob_parse_result_t parse_ctor_sig(mdcxt_t* cxt, mdcursor_t ctor, col_index_t sig_col, ca_ctor_sig_t** ctor_sig)
+{
+    uint8_t const* sig;
+    uint32_t sig_len_raw;
+    if (1 != md_get_column_value_as_blob(ctor, sig_col, 1, &sig, &sig_len_raw))
+        return mdbpr_InvalidBlob;
+
+    size_t sig_len = sig_len_raw;
+    uint8_t calling_convention;
+    uint32_t generic_param_count;
+    uint32_t param_count;
+    if (!read_u8(&sig, &sig_len, &calling_convention)
+        || ((calling_convention & IMAGE_CEE_CS_CALLCONV_GENERIC) && !decompress_u32(&sig, &sig_len, &generic_param_count))
+        || !decompress_u32(&sig, &sig_len, &param_count)
+        || !skip_type(&sig, &sig_len)) // RetType
+    {
+        return mdbpr_InvalidBlob;
+    }
+
+    // Every parameter takes at least a byte in the signature, so this bounds the allocation.
+    if (param_count > sig_len)
+        return mdbpr_InvalidBlob;
+
+    ca_ctor_sig_t* parsed = (ca_ctor_sig_t*)calloc(1, sizeof(ca_ctor_sig_t) + param_count * sizeof(ca_type_t));
+    if (parsed == NULL)
+        return mdbpr_OutOfMemory;
+
+    parsed->param_count = param_count;
+    for (uint32_t i = 0; i < param_count; ++i)
+    {
+        if (!parse_ctor_param(cxt, ctor, &sig, &sig_len, true, true, &parsed->params[i]))
+        {
+            free(parsed);
+            return mdbpr_InvalidBlob;
+        }
+    }
+
+    *ctor_sig = parsed;
+    return mdbpr_Success;
+}
+
+static md_blob_parse_result_t get_ctor_sig(mdcxt_t* cxt, mdcursor_t ctor, ca_ctor_sig_t const** ctor_sig)
+{
+    mdToken ctor_tk;
+    if (!md_cursor_to_token(ctor, &ctor_tk))
+        return mdbpr_InvalidArgument;
+
+    uint32_t methoddef_count = cxt->tables[mdtid_MethodDef].row_count;
+    uint32_t memberref_count = cxt->tables[mdtid_MemberRef].row_count;
+    uint32_t rid = RidFromToken(ctor_tk);
+    uint32_t index;
+    col_index_t sig_col;
+    switch (ExtractTokenType(ctor_tk))
+    {
+        case mdtid_MethodDef:
+            if (rid == 0 || rid > methoddef_count)
+                return mdbpr_InvalidArgument;
+            index = rid - 1;
+            sig_col = mdtMethodDef_Signature;
+            break;
+        case mdtid_MemberRef:
+            if (rid == 0 || rid > memberref_count)
+                return mdbpr_InvalidArgument;
+            index = methoddef_count + rid - 1;
+            sig_col = mdtMemberRef_Signature;
+            break;
+        default:
+            return mdbpr_InvalidArgument;
+    }
+
+    mdca_cache_t* cache = (mdca_cache_t*)atomic_load_ptr((void* volatile*)&cxt->ca_cache);
+    if (cache == NULL)
+    {
+        size_t slot_count = (size_t)methoddef_count + memberref_count;
+        mdca_cache_t* new_cache = (mdca_cache_t*)calloc(1, sizeof(mdca_cache_t) + slot_count * sizeof(ca_ctor_sig_t*));
+        if (new_cache == NULL)
+            return mdbpr_OutOfMemory;
+
+        new_cache->methoddef_count = methoddef_count;
+        new_cache->memberref_count = memberref_count;
+        if (atomic_publish_ptr((void* volatile*)&cxt->ca_cache, new_cache))
+        {
+            cache = new_cache;
+        }
+        else
+        {
+            // Another thread published a cache first.
+            free(new_cache);
+            cache = (mdca_cache_t*)atomic_load_ptr((void* volatile*)&cxt->ca_cache);
+        }
+    }
+    assert(cache->methoddef_count == methoddef_count && cache->memberref_count == memberref_count);
+
+    ca_ctor_sig_t* parsed = (ca_ctor_sig_t*)atomic_load_ptr((void* volatile*)&cache->ctors[index]);
+    if (parsed == NULL)
+    {
+        md_blob_parse_result_t result = parse_ctor_sig(cxt, ctor, sig_col, &parsed);
+        if (result != mdbpr_Success)
+            return result;
+
+        if (!atomic_publish_ptr((void* volatile*)&cache->ctors[index], parsed))
+        {
+            // Another thread parsed the signature first.
+            free(parsed);
+            parsed = (ca_ctor_sig_t*)atomic_load_ptr((void* volatile*)&cache->ctors[index]);
+        }
+    }
+
+    *ctor_sig = parsed;
+    return mdbpr_Success;
+}
+
+// Writes the parsed arguments while they fit in the value, and counts all of them.
+typedef struct ca_parser__
+{
+    mdcxt_t* cxt;
+    md_enum_resolver_t enum_resolver;
+    void* enum_resolver_context;
+    bool unresolved_enum;
+    md_custom_attribute_value_t* value;
+    uint32_t arg_capacity;
+    uint32_t arg_count;
+    md_custom_attribute_arg_t scratch;
+} ca_parser_t;
+
+static md_custom_attribute_arg_t* add_arg(ca_parser_t* parser)
+{
+    md_custom_attribute_arg_t* arg = parser->arg_count < parser->arg_capacity
+        ? &parser->value->args[parser->arg_count]
+        : &parser->scratch;
+    parser->arg_count++;
+    memset(arg, 0, sizeof(*arg));
+    return arg;
+}
+
+// Read a SerString - ECMA-335 II.23.3
+static bool read_ser_string(uint8_t const** blob, size_t* blob_len, char const** str, uint32_t* str_len)
+{
+    if (*blob_len > 0 && **blob == 0xff)
+    {
+        (void)advance_stream(blob, blob_len, 1);
+        *str = NULL;
+        *str_len = 0;
+        return true;
+    }
+
+    uint32_t len;
+    if (!decompress_u32(blob, blob_len, &len) || len > *blob_len)
+        return false;
+
+    *str = (char const*)*blob;
+    *str_len = len;
+    return advance_stream(blob, blob_len, len);
+}
+
+// Read a FieldOrPropType - ECMA-335 II.23.3
+static bool read_field_or_prop_type(mdcxt_t* cxt, uint8_t const** blob, size_t* blob_len, bool allow_array, ca_type_t* type)
+{
+    memset(type, 0, sizeof(*type));
+    uint8_t type_code;
+    if (!read_u8(blob, blob_len, &type_code))
+        return false;
+
+    char const* enum_type_name;
+    uint32_t enum_type_name_len;
+    switch (type_code)
+    {
+        case SERIALIZATION_TYPE_STRING:
+        case SERIALIZATION_TYPE_TYPE:
+        case SERIALIZATION_TYPE_TAGGED_OBJECT:
+            type->type_code = type_code;
+            return true;
+        case SERIALIZATION_TYPE_ENUM:
+            if (!read_ser_string(blob, blob_len, &enum_type_name, &enum_type_name_len) || enum_type_name == NULL)
+                return false;
+            resolve_enum_type_name(cxt, enum_type_name, enum_type_name_len, type);
+            return true;
+        case SERIALIZATION_TYPE_SZARRAY:
+        {
+            ca_type_t element;
+            if (!allow_array || !read_field_or_prop_type(cxt, blob, blob_len, false, &element))
+                return false;
+            *type = element;
+            type->type_code = SERIALIZATION_TYPE_SZARRAY;
+            type->element_type_code = element.type_code;
+            return true;
+        }
+        default:
+            if (!is_primitive_type(type_code))
+                return false;
+            type->type_code = type_code;
+            return true;
+    }
+}
+
+static bool read_integer(uint8_t const** blob, size_t* blob_len, uint8_t type_code, uint64_t* value)
+{
+    switch (type_code)
+    {
+        case ELEMENT_TYPE_BOOLEAN:
+        case ELEMENT_TYPE_U1:
+        {
+            uint8_t v;
+            if (!read_u8(blob, blob_len, &v))
+                return false;
+            *value = v;
+            return true;
+        }
+        case ELEMENT_TYPE_I1:
+        {
+            int8_t v;
+            if (!read_i8(blob, blob_len, &v))
+                return false;
+            *value = (uint64_t)(int64_t)v;
+            return true;
+        }
+        case ELEMENT_TYPE_CHAR:
+        case ELEMENT_TYPE_U2:
+        {
+            uint16_t v;
+            if (!read_u16(blob, blob_len, &v))
+                return false;
+            *value = v;
+            return true;
+        }
+        case ELEMENT_TYPE_I2:
+        {
+            int16_t v;
+            if (!read_i16(blob, blob_len, &v))
+                return false;
+            *value = (uint64_t)(int64_t)v;
+            return true;
+        }
+        case ELEMENT_TYPE_U4:
+        {
+            uint32_t v;
+            if (!read_u32(blob, blob_len, &v))
+                return false;
+            *value = v;
+            return true;
+        }
+        case ELEMENT_TYPE_I4:
+        {
+            int32_t v;
+            if (!read_i32(blob, blob_len, &v))
+                return false;
+            *value = (uint64_t)(int64_t)v;
+            return true;
+        }
+        case ELEMENT_TYPE_U8:
+        case ELEMENT_TYPE_I8:
+            return read_u64(blob, blob_len, value);
+        default:
+            assert(!"Unexpected integer type");
+            return false;
+    }
+}
+
+// Resolve the underlying type of an enum that isn't defined in the metadata with the caller's resolver.
+static bool resolve_external_enum(ca_parser_t* parser, ca_type_t* type)
+{
+    assert(type->type_code == SERIALIZATION_TYPE_ENUM);
+    if (type->underlying_type_code != 0)
+        return true;
+
+    uint8_t underlying_type;
+    if (parser->enum_resolver == NULL
+        || !parser->enum_resolver(parser->enum_resolver_context, type->enum_type, type->enum_type_name, type->enum_type_name_len, &underlying_type)
+        || !is_integer_type(underlying_type))
+    {
+        parser->unresolved_enum = true;
+        return false;
+    }
+
+    type->underlying_type_code = underlying_type;
+    return true;
+}
+
+// Read an Elem, or a FixedArg that is an array, and add it and its elements to the parsed arguments.
+static bool read_fixed_arg(ca_parser_t* parser, uint8_t const** blob, size_t* blob_len, ca_type_t const* type, md_custom_attribute_arg_t const* base)
+{
+    ca_type_t boxed_type;
+    bool boxed = false;
+    if (type->type_code == SERIALIZATION_TYPE_TAGGED_OBJECT)
+    {
+        // Array elements that are boxed can't themselves be arrays.
+        if (!read_field_or_prop_type(parser->cxt, blob, blob_len, base->kind != mdcak_ArrayElement, &boxed_type)
+            || boxed_type.type_code == SERIALIZATION_TYPE_TAGGED_OBJECT)
+        {
+            return false;
+        }
+        type = &boxed_type;
+        boxed = true;
+    }
+
+    md_custom_attribute_arg_t* arg = add_arg(parser);
+    *arg = *base;
+    arg->type_code = type->type_code;
+    arg->boxed = boxed;
+    arg->underlying_type_code = type->underlying_type_code;
+    arg->enum_type = type->enum_type;
+    arg->enum_type_name = type->enum_type_name;
+    arg->enum_type_name_len = type->enum_type_name_len;
+
+    uint32_t raw;
+    uint64_t raw64;
+    switch (type->type_code)
+    {
+        case SERIALIZATION_TYPE_STRING:
+        case SERIALIZATION_TYPE_TYPE:
+            if (!read_ser_string(blob, blob_len, &arg->value.string.str, &arg->value.string.len))
+                return false;
+            arg->is_null = arg->value.string.str == NULL;
+            return true;
+        case SERIALIZATION_TYPE_ENUM:
+        {
+            ca_type_t enum_type = *type;
+            if (!resolve_external_enum(parser, &enum_type))
+                return false;
+            arg->underlying_type_code = enum_type.underlying_type_code;
+            return read_integer(blob, blob_len, enum_type.underlying_type_code, &arg->value.integer);
+        }
+        case SERIALIZATION_TYPE_R4:
+            if (!read_u32(blob, blob_len, &raw))
+                return false;
+            memcpy(&arg->value.r4, &raw, sizeof(float));
+            return true;
+        case SERIALIZATION_TYPE_R8:
+            if (!read_u64(blob, blob_len, &raw64))
+                return false;
+            memcpy(&arg->value.r8, &raw64, sizeof(double));
+            return true;
+        case SERIALIZATION_TYPE_SZARRAY:
+        {
+            arg->element_type_code = type->element_type_code;
+            uint32_t count;
+            if (!read_u32(blob, blob_len, &count))
+                return false;
+
+            arg->is_null = count == UINT32_MAX;
+            if (arg->is_null)
+                return true;
+
+            // Every element takes at least a byte, so this bounds the number of elements.
+            if (count > *blob_len)
+                return false;
+            arg->value.element_count = count;
+
+            ca_type_t element_type = *type;
+            element_type.type_code = type->element_type_code;
+            element_type.element_type_code = 0;
+
+            // Resolve the enum of the elements once for the whole array.
+            if (element_type.type_code == SERIALIZATION_TYPE_ENUM)
+            {
+                if (!resolve_external_enum(parser, &element_type))
+                    return false;
+                arg->underlying_type_code = element_type.underlying_type_code;
+            }
+
+            md_custom_attribute_arg_t element_base = { 0 };
+            element_base.kind = mdcak_ArrayElement;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                if (!read_fixed_arg(parser, blob, blob_len, &element_type, &element_base))
+                    return false;
+            }
+            return true;
+        }
+        default:
+            assert(is_integer_type(type->type_code));
+            return read_integer(blob, blob_len, type->type_code, &arg->value.integer);
+    }
+}
+
+static md_blob_parse_result_t parse_value(ca_parser_t* parser, ca_ctor_sig_t const* ctor_sig, uint8_t const* blob, size_t blob_len)
+{
+    // Prolog
+    uint16_t prolog;
+    if (!read_u16(&blob, &blob_len, &prolog) || prolog != 0x0001)
+        return mdbpr_InvalidBlob;
+
+    md_custom_attribute_arg_t base = { 0 };
+    base.kind = mdcak_FixedArgument;
+    for (uint32_t i = 0; i < ctor_sig->param_count; ++i)
+    {
+        if (!read_fixed_arg(parser, &blob, &blob_len, &ctor_sig->params[i], &base))
+            return parser->unresolved_enum ? mdbpr_UnresolvedEnum : mdbpr_InvalidBlob;
+    }
+
+    uint16_t named_arg_count;
+    if (!read_u16(&blob, &blob_len, &named_arg_count))
+        return mdbpr_InvalidBlob;
+
+    for (uint32_t i = 0; i < named_arg_count; ++i)
+    {
+        uint8_t kind;
+        ca_type_t type;
+        if (!read_u8(&blob, &blob_len, &kind)
+            || (kind != SERIALIZATION_TYPE_FIELD && kind != SERIALIZATION_TYPE_PROPERTY)
+            || !read_field_or_prop_type(parser->cxt, &blob, &blob_len, true, &type)
+            || !read_ser_string(&blob, &blob_len, &base.name, &base.name_len)
+            || base.name == NULL)
+        {
+            return mdbpr_InvalidBlob;
+        }
+
+        base.kind = kind == SERIALIZATION_TYPE_FIELD ? mdcak_Field : mdcak_Property;
+        if (!read_fixed_arg(parser, &blob, &blob_len, &type, &base))
+            return parser->unresolved_enum ? mdbpr_UnresolvedEnum : mdbpr_InvalidBlob;
+    }
+
+    if (parser->value != NULL)
+    {
+        parser->value->fixed_arg_count = ctor_sig->param_count;
+        parser->value->named_arg_count = named_arg_count;
+        parser->value->arg_count = parser->arg_count;
+    }
+    return mdbpr_Success;
+}
+
+md_blob_parse_result_t md_parse_custom_attribute_value(
+    mdhandle_t handle,
+    mdcursor_t ctor,
+    uint8_t const* blob,
+    size_t blob_len,
+    md_enum_resolver_t enum_resolver,
+    void* enum_resolver_context,
+    md_custom_attribute_value_t* value,
+    size_t* buffer_len)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || blob == NULL || buffer_len == NULL)
+        return mdbpr_InvalidArgument;
+
+    ca_ctor_sig_t const* ctor_sig;
+    md_blob_parse_result_t result = get_ctor_sig(cxt, ctor, &ctor_sig);
+    if (result != mdbpr_Success)
+        return result;
+
+    // Write the arguments while they fit and keep counting past the end,
+    // so the blob is only decoded once when the buffer is large enough.
+    ca_parser_t parser = { 0 };
+    parser.cxt = cxt;
+    parser.enum_resolver = enum_resolver;
+    parser.enum_resolver_context = enum_resolver_context;
+    if (value != NULL && *buffer_len >= sizeof(md_custom_attribute_value_t))
+    {
+        size_t capacity = (*buffer_len - sizeof(md_custom_attribute_value_t)) / sizeof(value->args[0]);
+        parser.value = value;
+        parser.arg_capacity = capacity > UINT32_MAX ? UINT32_MAX : (uint32_t)capacity;
+    }
+
+    result = parse_value(&parser, ctor_sig, blob, blob_len);
+    if (result != mdbpr_Success)
+        return result;
+
+    size_t required_size = sizeof(md_custom_attribute_value_t) + parser.arg_count * sizeof(value->args[0]);
+    if (parser.value == NULL || parser.arg_count > parser.arg_capacity)
+    {
+        *buffer_len = required_size;
+        return mdbpr_InsufficientBuffer;
+    }
+    return mdbpr_Success;
+}
@@ -0,0 +1,231 @@
+#include "internal.h"
+
+// Decoded names of Portable PDB Document rows and a hash index of them.
+
+#define MIN_DOCUMENT_BUCKET_COUNT 16
+
+typedef struct doc_row__
+{
+    uint32_t hash;
+    uint32_t next; // Row id of the next row in the same bucket, or 0.
+} doc_row_t;
+
+// Rows are chained in row order in buckets keyed by the hash of their case-folded name,
+// so case-sensitive and case-insensitive lookups share the index.
+typedef struct doc_hash_index__
+{
+    uint32_t bucket_mask;
+    uint32_t* buckets; // Row id of the first row in each bucket, or 0.
+    doc_row_t rows[]; // Indexed by row id - 1.
+} doc_hash_index_t;
+
+// Names are decoded the first time they are used. The hash index is built on the first lookup.
+struct mddocname_index__
+{
+    uint32_t row_count;
+    doc_hash_index_t* volatile hash_index;
+    char* volatile names[]; // Indexed by row id - 1.
+};
+
+void free_document_name_index(mdcxt_t* cxt)
+{
+    assert(cxt != NULL);
+    mddocname_index_t* index = cxt->document_name_index;
+    if (index == NULL)
+        return;
+
+    for (uint32_t i = 0; i < index->row_count; ++i)
+        free(index->names[i]);
+    free(index->hash_index);
+    free(index);
+    cxt->document_name_index = NULL;
+}
+
+static mddocname_index_t* get_document_name_index(mdcxt_t* cxt)
+{
+    mddocname_index_t* index = (mddocname_index_t*)atomic_load_ptr((void* volatile*)&cxt->document_name_index);
+    if (index != NULL)
+        return index;
+
+    uint32_t row_count = cxt->tables[mdtid_Document].row_count;
+    mddocname_index_t* new_index = (mddocname_index_t*)calloc(1, sizeof(mddocname_index_t) + row_count * sizeof(char*));
+    if (new_index == NULL)
+        return NULL;
+
+    new_index->row_count = row_count;
+    if (atomic_publish_ptr((void* volatile*)&cxt->document_name_index, new_index))
+        return new_index;
+
+    // Another thread published an index first.
+    free(new_index);
+    return (mddocname_index_t*)atomic_load_ptr((void* volatile*)&cxt->document_name_index);
+}
+
+static char const* get_name(mdcxt_t* cxt, mddocname_index_t* index, uint32_t row_id)
+{
+    assert(row_id != 0 && row_id <= index->row_count);
+    char* volatile* slot = &index->names[row_id - 1];
+    char* name = (char*)atomic_load_ptr((void* volatile*)slot);
+    if (name != NULL)
+        return name;
+
+    uint8_t const* blob;
+    uint32_t blob_len;
+    mdcursor_t document = create_cursor(&cxt->tables[mdtid_Document], row_id);
+    if (1 != md_get_column_value_as_blob(document, mdtDocument_Name, 1, &blob, &blob_len))
+        return NULL;
+
+    size_t name_len = 0;
+    if (md_parse_document_name(cxt, blob, blob_len, NULL, &name_len) != mdbpr_InsufficientBuffer)
+        return NULL;
+
+    char* new_name = (char*)malloc(name_len);
+    if (new_name == NULL)
+        return NULL;
+
+    if (md_parse_document_name(cxt, blob, blob_len, new_name, &name_len) != mdbpr_Success)
+    {
+        free(new_name);
+        return NULL;
+    }
+
+    if (atomic_publish_ptr((void* volatile*)slot, new_name))
+        return new_name;
+
+    // Another thread decoded the name first.
+    free(new_name);
+    return (char const*)atomic_load_ptr((void* volatile*)slot);
+}
+
+static char fold_case(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+// FNV-1a over the case-folded name.
+static uint32_t hash_name(char const* name)
+{
+    uint32_t hash = 2166136261u;
+    for (; *name != '\0'; ++name)
+    {
+        hash ^= (uint8_t)fold_case(*name);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool names_equal(char const* lhs, char const* rhs, bool ignore_case)
+{
+    if (!ignore_case)
+        return strcmp(lhs, rhs) == 0;
+
+    for (; *lhs != '\0' && fold_case(*lhs) == fold_case(*rhs); ++lhs, ++rhs)
+        ;
+    return fold_case(*lhs) == fold_case(*rhs);
+}
+
+static doc_hash_index_t* build_hash_index(mdcxt_t* cxt, mddocname_index_t* index)
+{
+    uint32_t row_count = index->row_count;
+    uint32_t bucket_count = MIN_DOCUMENT_BUCKET_COUNT;
+    while (bucket_count < row_count)
+    {
+        if (bucket_count > (UINT32_MAX / 2) / sizeof(uint32_t))
+            return NULL;
+        bucket_count <<= 1;
+    }
+
+    doc_hash_index_t* hash_index = (doc_hash_index_t*)malloc(
+        sizeof(doc_hash_index_t) + row_count * sizeof(doc_row_t) + bucket_count * sizeof(uint32_t));
+    if (hash_index == NULL)
+        return NULL;
+
+    hash_index->bucket_mask = bucket_count - 1;
+    hash_index->buckets = (uint32_t*)&hash_index->rows[row_count];
+    memset(hash_index->buckets, 0, bucket_count * sizeof(uint32_t));
+
+    // Link the rows from last to first so each bucket is in row order.
+    for (uint32_t row_id = row_count; row_id > 0; --row_id)
+    {
+        char const* name = get_name(cxt, index, row_id);
+        if (name == NULL)
+        {
+            free(hash_index);
+            return NULL;
+        }
+
+        doc_row_t* row = &hash_index->rows[row_id - 1];
+        row->hash = hash_name(name);
+        uint32_t* bucket = &hash_index->buckets[row->hash & hash_index->bucket_mask];
+        row->next = *bucket;
+        *bucket = row_id;
+    }
+    return hash_index;
+}
+
+static doc_hash_index_t* get_hash_index(mdcxt_t* cxt, mddocname_index_t* index)
+{
+    doc_hash_index_t* hash_index = (doc_hash_index_t*)atomic_load_ptr((void* volatile*)&index->hash_index);
+    if (hash_index != NULL)
+        return hash_index;
+
+    doc_hash_index_t* new_hash_index = build_hash_index(cxt, index);
+    if (new_hash_index == NULL)
+        return NULL;
+
+    if (atomic_publish_ptr((void* volatile*)&index->hash_index, new_hash_index))
+        return new_hash_index;
+
+    // Another thread published an index first.
+    free(new_hash_index);
+    return (doc_hash_index_t*)atomic_load_ptr((void* volatile*)&index->hash_index);
+}
+
+bool md_get_document_name(mdcursor_t document, char const** name)
+{
+    if (name == NULL)
+        return false;
+
+    mdtable_t* table = CursorTable(&document);
+    if (table == NULL || table->cxt == NULL || table->table_id != mdtid_Document)
+        return false;
+
+    uint32_t row_id = CursorRow(&document);
+    mddocname_index_t* index = get_document_name_index(table->cxt);
+    if (index == NULL || row_id == 0 || row_id > index->row_count)
+        return false;
+
+    *name = get_name(table->cxt, index, row_id);
+    return *name != NULL;
+}
+
+bool md_find_document(mdhandle_t handle, char const* name, bool ignore_case, mdcursor_t* document)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || name == NULL || document == NULL)
+        return false;
+
+    mddocname_index_t* index = get_document_name_index(cxt);
+    if (index == NULL)
+        return false;
+
+    doc_hash_index_t* hash_index = get_hash_index(cxt, index);
+    if (hash_index == NULL)
+        return false;
+
+    uint32_t hash = hash_name(name);
+    for (uint32_t row_id = hash_index->buckets[hash & hash_index->bucket_mask]; row_id != 0; row_id = hash_index->rows[row_id - 1].next)
+    {
+        if (hash_index->rows[row_id - 1].hash != hash)
+            continue;
+
+        // All names were decoded when the hash index was built.
+        char const* candidate = (char const*)atomic_load_ptr((void* volatile*)&index->names[row_id - 1]);
+        if (names_equal(candidate, name, ignore_case))
+        {
+            *document = create_cursor(&cxt->tables[mdtid_Document], row_id);
+            return true;
+        }
+    }
+    return false;
+}
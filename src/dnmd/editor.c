@@ -30,8 +30,23 @@ typedef struct mdeditor__
 
 static mdeditor_t* get_editor(mdcxt_t* cxt)
 {
+    // All edits go through the editor, so this is where an edit is observed.
     if (cxt->editor != NULL)
+    {
+        cxt->revision++;
+        free_ca_cache(cxt);
+        free_sig_cache(cxt);
+#ifdef DNMD_PORTABLE_PDB
+        free_sequence_point_indexes(cxt);
+        free_local_scope_index(cxt);
+        free_document_name_index(cxt);
+#endif // DNMD_PORTABLE_PDB
         return cxt->editor;
+    }
+
+    // Snapshots can't be edited.
+    if (cxt->context_flags & mdc_read_only)
+        return NULL;
 
     assert(cxt->editor == NULL);
     // If we haven't edited yet, initialize the table editor.
@@ -69,6 +84,14 @@ static mdeditor_t* get_editor(mdcxt_t* cxt)
     // Connect the editor and context.
     editor->cxt = cxt;
     cxt->editor = editor;
+    cxt->revision++;
+    free_ca_cache(cxt);
+    free_sig_cache(cxt);
+#ifdef DNMD_PORTABLE_PDB
+    free_sequence_point_indexes(cxt);
+    free_local_scope_index(cxt);
+    free_document_name_index(cxt);
+#endif // DNMD_PORTABLE_PDB
     return editor;
 }
 
@@ -121,32 +144,165 @@ bool create_and_fill_indirect_table(mdcxt_t* cxt, mdtable_id_t original_table, m
     return true;
 }
 
-uint8_t* get_writable_table_data(mdtable_t* table, bool make_writable)
+// Make sure that editable data isn't shared with a snapshot before modifying it in place.
+// Data appended past the end of the in-use data isn't visible to snapshots and doesn't require this.
+static bool unshare_editable_data(mdcxt_t* cxt, mddata_t* editable_data, mdcdata_t* data)
+{
+    assert(editable_data->ptr != NULL && editable_data->ptr == data->ptr);
+    if (!is_mdmem_shared(editable_data->ptr))
+        return true;
+
+    void* mem = alloc_mdmem(cxt, editable_data->size);
+    if (mem == NULL)
+        return false;
+    memcpy(mem, data->ptr, data->size);
+    free_mdmem(cxt, editable_data->ptr);
+    editable_data->ptr = mem;
+    data->ptr = mem;
+    return true;
+}
+
+// Tables larger than a single segment are copied on write a segment at a time,
+// so editing a few rows in a large table doesn't require copying the whole table.
+#define TABLE_SEGMENT_SIZE 4096
+
+static uint32_t get_table_segment_count(mdtable_t const* table)
 {
+    uint32_t rows_per_segment = 1u << table->segment_row_shift;
+    return (table->row_count + rows_per_segment - 1) >> table->segment_row_shift;
+}
+
+static bool create_table_segments(mdcxt_t* cxt, mdtable_t* table)
+{
+    assert(table->segments == NULL && table->row_size_bytes != 0);
+
+    // Use the largest power of two number of rows that fits in a segment.
+    uint8_t shift = 0;
+    while (((size_t)table->row_size_bytes << (shift + 1)) <= TABLE_SEGMENT_SIZE)
+        shift++;
+    table->segment_row_shift = shift;
+
+    size_t map_size = get_table_segment_count(table) * sizeof(uint8_t*);
+    uint8_t** segments = alloc_mdmem(cxt, map_size);
+    if (segments == NULL)
+        return false;
+    memset(segments, 0, map_size);
+    table->segments = segments;
+    return true;
+}
+
+static void free_table_segments(mdcxt_t* cxt, mdtable_t* table)
+{
+    assert(table->segments != NULL);
+    uint32_t segment_count = get_table_segment_count(table);
+    for (uint32_t i = 0; i < segment_count; ++i)
+        free_mdmem(cxt, table->segments[i]);
+
+    free_mdmem(cxt, table->segments);
+    table->segments = NULL;
+    table->segment_row_shift = 0;
+}
+
+// Copy all rows of a table that has been edited in place into a single editable allocation
+// with space for at least capacity bytes.
+static bool merge_table_segments(mdeditor_t* editor, mdtable_t* table, size_t capacity)
+{
+    assert(table->segments != NULL && editor->tables[table->table_id].data.ptr == NULL);
+    if (capacity < table->data.size)
+        capacity = table->data.size;
+
+    uint8_t* mem = alloc_mdmem(editor->cxt, capacity);
+    if (mem == NULL)
+        return false;
+
+    size_t segment_size = (size_t)table->row_size_bytes << table->segment_row_shift;
+    uint32_t segment_count = get_table_segment_count(table);
+    for (uint32_t i = 0; i < segment_count; ++i)
+    {
+        size_t offset = segment_size * i;
+        size_t size = table->data.size - offset < segment_size ? table->data.size - offset : segment_size;
+        memcpy(mem + offset, table->segments[i] != NULL ? table->segments[i] : table->data.ptr + offset, size);
+    }
+
+    free_table_segments(editor->cxt, table);
+
+    editor->tables[table->table_id].data.ptr = mem;
+    editor->tables[table->table_id].data.size = capacity;
+    table->data.ptr = mem;
+    return true;
+}
+
+static void observe_row_edit(mdtable_t* table, uint32_t row_index)
+{
+    // The row being added to the end of the table isn't an existing row.
+    if (!table->is_adding_new_row || row_index != table->row_count - 1)
+        table->revision++;
+
+    update_ref_index_for_edited_row(table, row_index);
+}
+
+uint8_t* get_writable_table_row(mdtable_t* table, uint32_t row_index)
+{
+    assert(row_index < table->row_count);
     mdeditor_t* editor = get_editor(table->cxt);
     if (editor == NULL)
         return NULL;
 
+    observe_row_edit(table, row_index);
+
     mddata_t* table_data = &editor->tables[table->table_id].data;
+    if (table_data->ptr != NULL)
+    {
+        if (!unshare_editable_data(table->cxt, table_data, &table->data))
+            return NULL;
+        return table_data->ptr + (size_t)row_index * table->row_size_bytes;
+    }
 
-    if (table_data->ptr == NULL && make_writable)
+    if (table->segments == NULL && table->data.size <= TABLE_SEGMENT_SIZE)
     {
-        // If we're trying to get writable data for a table that has not been edited,
+        // If we're trying to get writable data for a small table that has not been edited,
         // then we need to allocate space for it and copy the contents for editing.
-        // TODO: Should we allocate more space than the table currently uses to ensure
-        // immediate table growth doesn't require a realloc?
         void* mem = alloc_mdmem(table->cxt, table->data.size);
         if (mem == NULL)
             return NULL;
         table_data->ptr = mem;
-        if (table_data->ptr == NULL)
-            return NULL;
         table_data->size = table->data.size;
         memcpy(table_data->ptr, table->data.ptr, table->data.size);
         table->data.ptr = table_data->ptr;
+        return table_data->ptr + (size_t)row_index * table->row_size_bytes;
     }
 
-    return table_data->ptr;
+    // Larger tables are copied on write one segment at a time.
+    if (table->segments == NULL && !create_table_segments(table->cxt, table))
+        return NULL;
+
+    // The segment map and segments may be shared with a snapshot, in which case they are copied as well.
+    if (is_mdmem_shared(table->segments))
+    {
+        size_t map_size = get_table_segment_count(table) * sizeof(uint8_t*);
+        uint8_t** segments = alloc_mdmem(table->cxt, map_size);
+        if (segments == NULL)
+            return NULL;
+        memcpy(segments, table->segments, map_size);
+        free_mdmem(table->cxt, table->segments);
+        table->segments = segments;
+    }
+
+    uint32_t segment = row_index >> table->segment_row_shift;
+    uint32_t segment_first_row = segment << table->segment_row_shift;
+    if (table->segments[segment] == NULL || is_mdmem_shared(table->segments[segment]))
+    {
+        uint32_t segment_rows = get_table_contiguous_rows_end(table, row_index) - segment_first_row;
+        size_t segment_size = (size_t)segment_rows * table->row_size_bytes;
+        uint8_t* mem = alloc_mdmem(table->cxt, segment_size);
+        if (mem == NULL)
+            return NULL;
+        memcpy(mem, get_table_row_data(table, segment_first_row), segment_size);
+        free_mdmem(table->cxt, table->segments[segment]);
+        table->segments[segment] = mem;
+    }
+
+    return table->segments[segment] + (size_t)(row_index - segment_first_row) * table->row_size_bytes;
 }
 
 // Copy a row from one table to another.
@@ -289,16 +445,20 @@ static bool set_column_size_for_max_row_count(mdeditor_t* editor, mdtable_t* tab
 
     // Go through all of the columns of each row and copy them to the new memory for the table
     // in their correct size.
-    uint8_t const* table_data = table->data.ptr;
-    size_t table_data_length = table->data.size;
     uint8_t* new_table_data = new_data_blob;
     size_t new_table_data_length = new_allocation_size;
     for (uint32_t i = 0; i < table->row_count; i++)
     {
-        if (!copy_row(&new_table_data, &new_table_data_length, new_column_details, &table_data, &table_data_length, table->column_details, table->column_count))
+        uint8_t const* row_data = get_table_row_data(table, i);
+        size_t row_data_length = table->row_size_bytes;
+        if (!copy_row(&new_table_data, &new_table_data_length, new_column_details, &row_data, &row_data_length, table->column_details, table->column_count))
             return false;
     }
 
+    // The table is now stored in a single allocation.
+    if (table->segments != NULL)
+        free_table_segments(editor->cxt, table);
+
     // Update the public view of the table to have the new schema and point to the new data.
     table->row_size_bytes = new_row_size;
     table->data.ptr = new_data_blob;
@@ -428,17 +588,30 @@ bool insert_row_into_table(mdcxt_t* cxt, mdtable_id_t table_id, uint32_t row_ind
         return false;
 
     // If we are out of space in our table, then we need to allocate a new table buffer.
+    // Inserting a row shifts all following rows, so a table edited in place is first merged into a single allocation.
+    if (target_table_editor->table->segments != NULL)
+    {
+        if (!merge_table_segments(editor, target_table_editor->table, target_table_editor->table->data.size * 2))
+            return false;
+    }
+
     if (target_table_editor->data.ptr == NULL || target_table_editor->data.size < target_table_editor->table->row_size_bytes * (size_t)(target_table_editor->table->row_count + 1))
     {
         if (!allocate_more_editable_space(editor->cxt, &target_table_editor->data, &target_table_editor->table->data, (target_table_editor->table->row_count + 1) * target_table_editor->table->row_size_bytes))
             return false;
     }
+    else if (!unshare_editable_data(editor->cxt, &target_table_editor->data, &target_table_editor->table->data))
+    {
+        return false;
+    }
 
     size_t next_row_start_offset = target_table_editor->table->row_size_bytes * (size_t)(row_index - 1);
     size_t last_row_end_offset = target_table_editor->table->row_size_bytes * (size_t)target_table_editor->table->row_count;
 
     if (next_row_start_offset < last_row_end_offset)
     {
+        observe_row_edit(target_table_editor->table, row_index - 1);
+
         // If we're inserting a row in the middle of the table, then we need to move the rows after it down.
         memmove(
             target_table_editor->data.ptr + next_row_start_offset + target_table_editor->table->row_size_bytes,
@@ -508,6 +681,10 @@ bool update_referenced_type_system_table_row_count(mdcxt_t* cxt, mdtable_id_t up
         if (!allocate_more_editable_space(editor->cxt, &editor->pdb_heap.heap, editor->pdb_heap.stream, pdb_heap_size))
             return false;
     }
+    else if (!unshare_editable_data(editor->cxt, &editor->pdb_heap.heap, editor->pdb_heap.stream))
+    {
+        return false;
+    }
 
     uint8_t* pdb_heap_data = editor->pdb_heap.heap.ptr;
     size_t pdb_heap_data_length = editor->pdb_heap.heap.size;
@@ -541,6 +718,41 @@ bool update_referenced_type_system_table_row_count(mdcxt_t* cxt, mdtable_id_t up
 }
 #endif // DNMD_PORTABLE_PDB
 
+static size_t collect_mem(void const* ptr, void** mem, size_t count)
+{
+    if (ptr == NULL)
+        return count;
+    if (mem != NULL)
+        mem[count] = (void*)ptr;
+    return count + 1;
+}
+
+size_t collect_editor_mem(mdcxt_t* cxt, void** mem)
+{
+    mdeditor_t* editor = cxt->editor;
+    assert(editor != NULL);
+
+    size_t count = 0;
+    count = collect_mem(editor->strings_heap.heap.ptr, mem, count);
+    count = collect_mem(editor->guid_heap.heap.ptr, mem, count);
+    count = collect_mem(editor->blob_heap.heap.ptr, mem, count);
+    count = collect_mem(editor->user_string_heap.heap.ptr, mem, count);
+    count = collect_mem(editor->pdb_heap.heap.ptr, mem, count);
+    for (mdtable_id_t id = mdtid_First; id < mdtid_End; ++id)
+    {
+        mdtable_t* table = editor->tables[id].table;
+        count = collect_mem(editor->tables[id].data.ptr, mem, count);
+        if (table->segments != NULL)
+        {
+            count = collect_mem(table->segments, mem, count);
+            uint32_t segment_count = get_table_segment_count(table);
+            for (uint32_t i = 0; i < segment_count; ++i)
+                count = collect_mem(table->segments[i], mem, count);
+        }
+    }
+    return count;
+}
+
 static md_heap_editor_t* get_heap_editor_by_id(mdeditor_t* editor, mdtcol_t heap_id)
 {
     switch (heap_id)
@@ -382,28 +382,144 @@ bool md_apply_delta(mdhandle_t handle, mdhandle_t delta_handle)
 typedef struct mdmem__
 {
     struct mdmem__* next;
+    struct mdmem__* prev;
+    // The memory is freed when the last reference is released.
+    // Memory is shared between a context and its snapshots - see md_snapshot_handle().
+    int32_t volatile refcount;
     size_t size;
     uint8_t data[];
 } mdmem_t;
 
+static mdmem_t* get_mdmem(void const* mem)
+{
+    // We need to get back to the mdmem_t header from the start of the block.
+    return (mdmem_t*)((char*)mem - offsetof(mdmem_t, data));
+}
+
+static void release_mdmem(mdmem_t* m)
+{
+    if (atomic_decrement(&m->refcount) == 0)
+        free(m);
+}
+
 void md_destroy_handle(mdhandle_t handle)
 {
     mdcxt_t* cxt = extract_mdcxt(handle);
     if (cxt == NULL)
         return;
 
+    free_ca_cache(cxt);
+    free_sig_cache(cxt);
+    free_ref_indexes(cxt);
+#ifdef DNMD_PORTABLE_PDB
+    free_sequence_point_indexes(cxt);
+    free_local_scope_index(cxt);
+    free_document_name_index(cxt);
+#endif // DNMD_PORTABLE_PDB
+    md_pe_close(cxt->pe);
+
+    for (size_t i = 0; i < cxt->shared_mem_count; ++i)
+        release_mdmem(get_mdmem(cxt->shared_mem[i]));
+
     mdmem_t* tmp;
     mdmem_t* curr = cxt->mem;
     while(curr != NULL)
     {
         tmp = curr->next;
-        free(curr);
+        release_mdmem(curr);
         curr = tmp;
     }
 
     free(cxt);
 }
 
+bool md_snapshot_handle(mdhandle_t handle, mdhandle_t* snapshot)
+{
+    if (snapshot == NULL)
+        return false;
+
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL)
+        return false;
+
+    // A row that is being added may not be fully initialized.
+    for (mdtable_id_t id = mdtid_First; id < mdtid_End; ++id)
+    {
+        if (cxt->tables[id].is_adding_new_row)
+            return false;
+    }
+
+    mdcxt_t snapshot_cxt;
+    memcpy(&snapshot_cxt, cxt, sizeof(snapshot_cxt));
+    snapshot_cxt.editor = NULL;
+    snapshot_cxt.tables = NULL;
+    snapshot_cxt.mem = NULL;
+    snapshot_cxt.shared_mem = NULL;
+    snapshot_cxt.shared_mem_count = 0;
+    snapshot_cxt.write_plan = NULL;
+    snapshot_cxt.ca_cache = NULL;
+    snapshot_cxt.sig_cache = NULL;
+    snapshot_cxt.type_ref_index = NULL;
+    snapshot_cxt.assembly_ref_index = NULL;
+#ifdef DNMD_PORTABLE_PDB
+    snapshot_cxt.sequence_point_cache = NULL;
+    snapshot_cxt.document_line_index = NULL;
+    snapshot_cxt.local_scope_index = NULL;
+    snapshot_cxt.document_name_index = NULL;
+#endif // DNMD_PORTABLE_PDB
+    snapshot_cxt.context_flags |= mdc_read_only;
+    if (cxt->editor != NULL)
+        snapshot_cxt.context_flags |= mdc_edited;
+
+    mdcxt_t* pcxt = allocate_full_context(&snapshot_cxt);
+    if (pcxt == NULL)
+        return false;
+
+    // The snapshot shares the PE the source was read from.
+    if (pcxt->pe != NULL)
+        add_pe_ref(pcxt->pe);
+
+    // The table views are copied so the source can update its own views as it is edited.
+    for (mdtable_id_t id = mdtid_First; id < mdtid_End; ++id)
+    {
+        mdtable_t* table = &pcxt->tables[id];
+        mdtcol_t* column_details = table->column_details;
+        memcpy(table, &cxt->tables[id], sizeof(*table));
+        memcpy(column_details, cxt->tables[id].column_details, sizeof(mdtcol_t) * get_table_column_count(id));
+        table->column_details = column_details;
+        if (table->cxt != NULL)
+            table->cxt = pcxt;
+    }
+
+    // Take a reference on all memory the tables and heaps are stored in.
+    // Only edited contexts own memory and only snapshots share memory, so a context never has both.
+    assert(cxt->editor == NULL || cxt->shared_mem_count == 0);
+    size_t shared_count = cxt->editor != NULL ? collect_editor_mem(cxt, NULL) : cxt->shared_mem_count;
+    if (shared_count != 0)
+    {
+        void** shared_mem = alloc_mdmem(pcxt, shared_count * sizeof(void*));
+        if (shared_mem == NULL)
+        {
+            md_destroy_handle(pcxt);
+            return false;
+        }
+
+        if (cxt->editor != NULL)
+            (void)collect_editor_mem(cxt, shared_mem);
+        else
+            memcpy(shared_mem, cxt->shared_mem, shared_count * sizeof(void*));
+
+        for (size_t i = 0; i < shared_count; ++i)
+            (void)atomic_increment(&get_mdmem(shared_mem[i])->refcount);
+
+        pcxt->shared_mem = shared_mem;
+        pcxt->shared_mem_count = shared_count;
+    }
+
+    *snapshot = pcxt;
+    return true;
+}
+
 bool md_validate(mdhandle_t handle)
 {
     mdcxt_t* cxt = extract_mdcxt(handle);
@@ -725,6 +841,22 @@ char const* md_get_version_string(mdhandle_t handle)
     return cxt->version;
 }
 
+uint64_t md_get_revision(mdhandle_t handle)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL)
+        return 0;
+    return cxt->revision;
+}
+
+uint64_t md_get_table_revision(mdhandle_t handle, mdtable_id_t table_id)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || table_id < mdtid_First || table_id >= mdtid_End)
+        return 0;
+    return cxt->tables[table_id].revision;
+}
+
 mdcxt_t* extract_mdcxt(mdhandle_t md)
 {
     mdcxt_t* cxt = (mdcxt_t*)md;
@@ -740,7 +872,11 @@ void* alloc_mdmem(mdcxt_t* cxt, size_t length)
     if (m != NULL)
     {
         m->next = cxt->mem;
+        m->prev = NULL;
+        m->refcount = 1;
         m->size = length;
+        if (cxt->mem != NULL)
+            cxt->mem->prev = m;
         cxt->mem = m;
         return m->data;
     }
@@ -753,88 +889,85 @@ void free_mdmem(mdcxt_t* cxt, void* mem)
     if (mem == NULL)
         return;
 
-    // We need to get back to the mdmem_t header from the start of the block.
-    mdmem_t* m = (mdmem_t*)((char*)mem - offsetof(mdmem_t, data));
+    mdmem_t* m = get_mdmem(mem);
 
     // Remove m from the chain of tracked memory.
-    if (cxt->mem == m)
-    {
-        cxt->mem = m->next;
-    }
+    if (m->prev != NULL)
+        m->prev->next = m->next;
     else
-    {
-        for (mdmem_t* p = cxt->mem; p != NULL; p = p->next)
-        {
-            if (p->next == m)
-            {
-                p->next = m->next;
-                break;
-            }
-        }
-    }
+        cxt->mem = m->next;
+
+    if (m->next != NULL)
+        m->next->prev = m->prev;
+
+    // Now that we aren't tracking the memory, release our reference to it.
+    release_mdmem(m);
+}
 
-    // Now that we aren't tracking the memory, free it.
-    free(m);
+bool is_mdmem_shared(void const* mem)
+{
+    assert(mem != NULL);
+    return atomic_load(&get_mdmem(mem)->refcount) > 1;
 }
 
-static size_t get_stream_header_and_contents_size(char const* heap_name, size_t heap_size)
+// II.24.2.2 Stream header
+static size_t get_stream_header_size(char const* name)
 {
-    assert(heap_name != NULL);
-    // II.24.2.2 Stream header
-    size_t const base_stream_header_size =
-        sizeof(uint32_t) // Offset
+    assert(name != NULL);
+    return sizeof(uint32_t) // Offset
         + sizeof(uint32_t) // Size
-        // Name is variable length and calculated below
+        + align_to((uint32_t)strlen(name) + 1, 4) // Name, padded to a 4-byte boundary
     ;
+}
 
-    // Add the size of the stream header
-    // II.24.2.2 Stream name is padded to a 4-byte boundary
-    size_t save_size = base_stream_header_size;
-    save_size += align_to((uint32_t)strlen(heap_name) + 1, 4);
-    // Add the size of the stream itself.
-    // It's not placed directly after the header in the image,
-    // but we might as well account for it here while we're checking
-    // the heap's existence.
-    save_size += heap_size;
-
-    return save_size;
+static size_t place_region(mdwrite_region_t* region, size_t offset, size_t size, size_t padded_size)
+{
+    assert(region != NULL && size <= padded_size);
+    region->offset = offset;
+    region->size = size;
+    region->padded_size = padded_size;
+    return offset + padded_size;
 }
 
-static size_t get_table_stream_size(mdcxt_t* cxt)
+// Check if the image may differ from the metadata the context was created with.
+static bool has_edits(mdcxt_t const* cxt)
 {
-    // II.24.2.6 #~ stream
-    size_t const table_stream_header_size =        
-        + sizeof(uint32_t) // Reserved
-        + sizeof(uint8_t) // MajorVersion
-        + sizeof(uint8_t) // MinorVersion
-        + sizeof(uint8_t) // HeapSizes
-        + sizeof(uint8_t) // Reserved
-        + sizeof(uint64_t) // Valid tables
-        + sizeof(uint64_t) // Sorted tables
-        // Rows and Tables entries are both variable length and calculated below
-    ;
-    
-    size_t save_size = table_stream_header_size;
-    
+    return cxt->editor != NULL || (cxt->context_flags & mdc_edited) == mdc_edited;
+}
+
+// Compute the layout of the image. The streams are laid out in the order their headers are written.
+static bool build_write_plan(mdcxt_t* cxt, mdwrite_plan_t* plan)
+{
+    assert(cxt != NULL && has_edits(cxt) && plan != NULL);
+    memset(plan, 0, sizeof(*plan));
+    plan->context_flags = cxt->context_flags;
+    plan->tables_stream_name = "#~";
+
+    if (cxt->context_flags & mdc_minimal_delta)
+        plan->tables_stream_name = "#-";
+
+    size_t table_count = 0;
     for (uint8_t i = 0; i < MDTABLE_MAX_COUNT; ++i)
     {
         if (cxt->tables[i].cxt != NULL && cxt->tables[i].row_count != 0)
         {
-            save_size += sizeof(uint32_t); // Row count
-            save_size += cxt->tables[i].data.size; // Table data
+            // We don't support saving if we are in the process of adding a new row.
+            if (cxt->tables[i].is_adding_new_row)
+                return false;
+
+            plan->valid_tables |= (1ULL << i);
+            if (cxt->tables[i].is_sorted)
+                plan->sorted_tables |= (1ULL << i);
+            table_count++;
+
+            // Indirect tables only exist in images that use the uncompresed stream.
+            if (table_is_indirect_table((mdtable_id_t)i))
+                plan->tables_stream_name = "#-";
         }
     }
-    
-    return save_size;
-}
 
-static size_t get_image_size(mdcxt_t* cxt)
-{    
-    if (cxt->editor == NULL)
-        return cxt->raw_metadata.size;
-    
-    // II.24.2.1 Metadata Root size
-    size_t const image_header_size =
+    // II.24.2.1 Metadata Root
+    size_t offset =
         sizeof(uint32_t) // Signature
         + sizeof(uint16_t) // MajorVersion
         + sizeof(uint16_t) // MinorVersion
@@ -844,40 +977,182 @@ static size_t get_image_size(mdcxt_t* cxt)
         + sizeof(uint16_t) // Flags
         + sizeof(uint16_t) // Streams (number of streams)
     ;
-    
-    size_t save_size = image_header_size;
 
+    // Stream headers
+    if (cxt->context_flags & mdc_minimal_delta)
+    {
+        offset += get_stream_header_size("#JTD");
+        plan->stream_count++;
+    }
+    if (cxt->strings_heap.size != 0)
+    {
+        offset += get_stream_header_size("#Strings");
+        plan->stream_count++;
+    }
     if (cxt->blob_heap.size != 0)
-        save_size += get_stream_header_and_contents_size("#Blob", cxt->blob_heap.size);
+    {
+        offset += get_stream_header_size("#Blob");
+        plan->stream_count++;
+    }
     if (cxt->guid_heap.size != 0)
-        save_size += get_stream_header_and_contents_size("#GUID", cxt->guid_heap.size);
-    if (cxt->strings_heap.size != 0)
-        save_size += get_stream_header_and_contents_size("#Strings", align_to((uint32_t)cxt->strings_heap.size, 4));
+    {
+        offset += get_stream_header_size("#GUID");
+        plan->stream_count++;
+    }
     if (cxt->user_string_heap.size != 0)
-        save_size += get_stream_header_and_contents_size("#US", cxt->user_string_heap.size);
+    {
+        offset += get_stream_header_size("#US");
+        plan->stream_count++;
+    }
+#ifdef DNMD_PORTABLE_PDB
+    if (cxt->pdb.size != 0)
+    {
+        offset += get_stream_header_size("#Pdb");
+        plan->stream_count++;
+    }
+#endif // DNMD_PORTABLE_PDB
+    // The tables stream is always included.
+    offset += get_stream_header_size(plan->tables_stream_name);
+    plan->stream_count++;
+
+    // Stream contents
+    // The strings heap should be aligned to 4 bytes.
+    offset = place_region(&plan->strings_heap, offset, cxt->strings_heap.size, align_to((uint32_t)cxt->strings_heap.size, 4));
+    offset = place_region(&plan->blob_heap, offset, cxt->blob_heap.size, cxt->blob_heap.size);
+    offset = place_region(&plan->guid_heap, offset, cxt->guid_heap.size, cxt->guid_heap.size);
+    offset = place_region(&plan->user_string_heap, offset, cxt->user_string_heap.size, cxt->user_string_heap.size);
+#ifdef DNMD_PORTABLE_PDB
+    offset = place_region(&plan->pdb, offset, cxt->pdb.size, cxt->pdb.size);
+#endif // DNMD_PORTABLE_PDB
 
-    if (cxt->context_flags & mdc_minimal_delta)
-        save_size += get_stream_header_and_contents_size("#JTD", 0);
-    
-    // All names of the tables stream are the same length,
-    // so pick the one in the standard.
-    save_size += get_stream_header_and_contents_size("#~", get_table_stream_size(cxt));
+    // II.24.2.6 #~ stream
+    size_t table_offset = offset
+        + sizeof(uint32_t) // Reserved
+        + sizeof(uint8_t) // MajorVersion
+        + sizeof(uint8_t) // MinorVersion
+        + sizeof(uint8_t) // HeapSizes
+        + sizeof(uint8_t) // Reserved
+        + sizeof(uint64_t) // Valid tables
+        + sizeof(uint64_t) // Sorted tables
+        + table_count * sizeof(uint32_t) // Rows
+    ;
+
+    for (uint8_t i = 0; i < MDTABLE_MAX_COUNT; ++i)
+    {
+        if (plan->valid_tables & (1ULL << i))
+            table_offset = place_region(&plan->tables[i], table_offset, cxt->tables[i].data.size, cxt->tables[i].data.size);
+    }
+
+    size_t table_stream_size = table_offset - offset;
+    if (table_stream_size > UINT32_MAX)
+        return false;
+
+    offset = place_region(&plan->tables_stream, offset, table_stream_size, table_stream_size);
+    plan->image_size = offset;
+    return true;
+}
+
+// Check if the plan still describes the image for the current state of the metadata.
+static bool is_write_plan_current(mdcxt_t* cxt, mdwrite_plan_t const* plan)
+{
+    assert(cxt != NULL && plan != NULL);
+
+    // A failed plan computation is never current.
+    if (plan->image_size == 0
+        || plan->context_flags != cxt->context_flags
+        || plan->strings_heap.size != cxt->strings_heap.size
+        || plan->blob_heap.size != cxt->blob_heap.size
+        || plan->guid_heap.size != cxt->guid_heap.size
+        || plan->user_string_heap.size != cxt->user_string_heap.size)
+    {
+        return false;
+    }
+
+#ifdef DNMD_PORTABLE_PDB
+    if (plan->pdb.size != cxt->pdb.size)
+        return false;
+#endif // DNMD_PORTABLE_PDB
+
+    for (uint8_t i = 0; i < MDTABLE_MAX_COUNT; ++i)
+    {
+        mdtable_t const* table = &cxt->tables[i];
+        bool valid = table->cxt != NULL && table->row_count != 0;
+        if (valid != ((plan->valid_tables & (1ULL << i)) != 0))
+            return false;
+
+        if (!valid)
+            continue;
+
+        if (table->is_adding_new_row
+            || table->is_sorted != ((plan->sorted_tables & (1ULL << i)) != 0)
+            || table->data.size != plan->tables[i].size)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Get the layout for the image, reusing the layout from a previous call if it is still valid.
+static mdwrite_plan_t const* get_write_plan(mdcxt_t* cxt)
+{
+    assert(cxt != NULL && has_edits(cxt));
+
+    mdwrite_plan_t* plan = cxt->write_plan;
+    if (plan != NULL && is_write_plan_current(cxt, plan))
+        return plan;
+
+    if (plan == NULL)
+    {
+        plan = alloc_mdmem(cxt, sizeof(*plan));
+        if (plan == NULL)
+            return NULL;
+        cxt->write_plan = plan;
+    }
+
+    if (!build_write_plan(cxt, plan))
+    {
+        plan->image_size = 0;
+        return NULL;
+    }
 
-    return save_size;
+    return plan;
+}
+
+bool md_prepare_write(mdhandle_t handle, size_t* len)
+{
+    if (len == NULL)
+        return false;
+
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL)
+        return false;
+
+    // Without edits, the image is the original metadata.
+    if (!has_edits(cxt))
+    {
+        *len = cxt->raw_metadata.size;
+        return true;
+    }
+
+    mdwrite_plan_t const* plan = get_write_plan(cxt);
+    if (plan == NULL)
+        return false;
+
+    *len = plan->image_size;
+    return true;
 }
 
 // II.24.2.2 Stream header
-static bool write_stream_header(char const* name, size_t size, mddata_t* offset_space, uint8_t** buffer, size_t* buffer_len)
+static bool write_stream_header(char const* name, mdwrite_region_t const* region, uint8_t** buffer, size_t* buffer_len)
 {
-    assert(offset_space != NULL);
+    assert(region != NULL);
     size_t name_len = strlen(name);
     size_t name_buf_len = align_to((uint32_t)name_len + 1, 4);
 
-    offset_space->ptr = *buffer;
-    offset_space->size = 4;
-
-    if (!advance_output_stream(buffer, buffer_len, 4) // Offset
-        || !write_u32(buffer, buffer_len, (uint32_t)size)) // Size
+    if (!write_u32(buffer, buffer_len, (uint32_t)region->offset) // Offset
+        || !write_u32(buffer, buffer_len, (uint32_t)region->padded_size)) // Size
     {
         return false;
     }
@@ -887,13 +1162,139 @@ static bool write_stream_header(char const* name, size_t size, mddata_t* offset_
 
     // Name
     memcpy(*buffer, name, name_len + 1);
-    advance_output_stream(buffer, buffer_len, name_len + 1);
     // Pad the name to a 4-byte boundary.
-    advance_output_stream(buffer, buffer_len, name_buf_len - name_len - 1);
+    memset(*buffer + name_len + 1, 0, name_buf_len - name_len - 1);
+    advance_output_stream(buffer, buffer_len, name_buf_len);
 
     return true;
 }
 
+// Copies of stream and table data are split into chunks
+// so the work can be spread evenly over the worker threads.
+#define WRITE_COPY_CHUNK_SIZE (256 * 1024)
+
+// Only use an additional worker thread for each multiple of this many bytes.
+// Below this, starting a thread costs more than the copy itself.
+#define WRITE_COPY_BYTES_PER_WORKER (2 * 1024 * 1024)
+
+typedef struct write_source__
+{
+    mdwrite_region_t const* region;
+    uint8_t const* src;
+    mdtable_t const* table; // Set when the source is a table that may have been edited in place.
+} write_source_t;
+
+typedef struct write_copy__
+{
+    write_source_t const* source;
+    uint8_t* image;
+    size_t offset;
+    size_t size;
+} write_copy_t;
+
+// Copy the bytes [offset, offset + size) of a source to its region of the image.
+static void copy_source_range(write_source_t const* source, uint8_t* image, size_t offset, size_t size)
+{
+    uint8_t* dest = image + source->region->offset;
+    mdtable_t const* table = source->table;
+    if (table == NULL || table->segments == NULL)
+    {
+        memcpy(dest + offset, source->src + offset, size);
+        return;
+    }
+
+    // Copy-on-write segments hold the edited rows of the table, see editor.c.
+    size_t segment_size = (size_t)table->row_size_bytes << table->segment_row_shift;
+    size_t end = offset + size;
+    while (offset < end)
+    {
+        size_t segment = offset / segment_size;
+        size_t segment_offset = offset - (segment * segment_size);
+        size_t count = segment_size - segment_offset;
+        if (count > end - offset)
+            count = end - offset;
+
+        uint8_t const* src = table->segments[segment] != NULL
+            ? table->segments[segment] + segment_offset
+            : source->src + offset;
+        memcpy(dest + offset, src, count);
+        offset += count;
+    }
+}
+
+static void run_write_copy(void* arg, size_t index)
+{
+    write_copy_t const* copy = &((write_copy_t const*)arg)[index];
+    copy_source_range(copy->source, copy->image, copy->offset, copy->size);
+}
+
+// Copy all streams and tables into the image.
+// Each source targets a disjoint region of the image, so the copies can run concurrently.
+static bool write_image_contents(mdcxt_t* cxt, mdwrite_plan_t const* plan, uint8_t* image)
+{
+    write_source_t sources[5 + MDTABLE_MAX_COUNT];
+    size_t source_count = 0;
+    sources[source_count++] = (write_source_t){ &plan->strings_heap, cxt->strings_heap.ptr, NULL };
+    sources[source_count++] = (write_source_t){ &plan->blob_heap, cxt->blob_heap.ptr, NULL };
+    sources[source_count++] = (write_source_t){ &plan->guid_heap, cxt->guid_heap.ptr, NULL };
+    sources[source_count++] = (write_source_t){ &plan->user_string_heap, cxt->user_string_heap.ptr, NULL };
+#ifdef DNMD_PORTABLE_PDB
+    sources[source_count++] = (write_source_t){ &plan->pdb, cxt->pdb.ptr, NULL };
+#endif // DNMD_PORTABLE_PDB
+    for (uint8_t i = 0; i < MDTABLE_MAX_COUNT; ++i)
+    {
+        if (plan->valid_tables & (1ULL << i))
+            sources[source_count++] = (write_source_t){ &plan->tables[i], cxt->tables[i].data.ptr, &cxt->tables[i] };
+    }
+    assert(source_count <= ARRAY_SIZE(sources));
+
+    // Zero out any padding after the data.
+    size_t chunk_count = 0;
+    for (size_t i = 0; i < source_count; ++i)
+    {
+        mdwrite_region_t const* region = sources[i].region;
+        if (region->padded_size != region->size)
+            memset(image + region->offset + region->size, 0, region->padded_size - region->size);
+        chunk_count += (region->size + WRITE_COPY_CHUNK_SIZE - 1) / WRITE_COPY_CHUNK_SIZE;
+    }
+
+    size_t max_workers = plan->image_size / WRITE_COPY_BYTES_PER_WORKER;
+    if (max_workers <= 1 || chunk_count <= 1)
+    {
+        for (size_t i = 0; i < source_count; ++i)
+        {
+            if (sources[i].region->size != 0)
+                copy_source_range(&sources[i], image, 0, sources[i].region->size);
+        }
+        return true;
+    }
+
+    write_copy_t* copies = (write_copy_t*)malloc(chunk_count * sizeof(write_copy_t));
+    if (copies == NULL)
+        return false;
+
+    size_t copy_count = 0;
+    for (size_t i = 0; i < source_count; ++i)
+    {
+        mdwrite_region_t const* region = sources[i].region;
+        for (size_t copied = 0; copied < region->size; copied += WRITE_COPY_CHUNK_SIZE)
+        {
+            size_t remaining = region->size - copied;
+            copies[copy_count].source = &sources[i];
+            copies[copy_count].image = image;
+            copies[copy_count].offset = copied;
+            copies[copy_count].size = remaining < WRITE_COPY_CHUNK_SIZE ? remaining : WRITE_COPY_CHUNK_SIZE;
+            copy_count++;
+        }
+    }
+    assert(copy_count == chunk_count);
+
+    parallel_for(copy_count, max_workers, run_write_copy, copies);
+
+    free(copies);
+    return true;
+}
+
 bool md_write_to_buffer(mdhandle_t handle, uint8_t* buffer, size_t* len)
 {
     if (len == NULL)
@@ -903,12 +1304,11 @@ bool md_write_to_buffer(mdhandle_t handle, uint8_t* buffer, size_t* len)
     if (cxt == NULL)
         return false;
 
-    size_t image_size = get_image_size(cxt);
     size_t const full_buffer_len = *len;
 
     // Handle the case where no edits have occurred.
     // This operation is basically a "copy to new buffer".
-    if (cxt->editor == NULL)
+    if (!has_edits(cxt))
     {
         if (buffer == NULL || full_buffer_len < cxt->raw_metadata.size)
         {
@@ -918,10 +1318,14 @@ bool md_write_to_buffer(mdhandle_t handle, uint8_t* buffer, size_t* len)
         memcpy(buffer, cxt->raw_metadata.ptr, cxt->raw_metadata.size);
         return true;
     }
-    
-    if (buffer == NULL || full_buffer_len < image_size)
+
+    mdwrite_plan_t const* plan = get_write_plan(cxt);
+    if (plan == NULL)
+        return false;
+
+    if (buffer == NULL || full_buffer_len < plan->image_size)
     {
-        *len = image_size;
+        *len = plan->image_size;
         return false;
     }
 
@@ -934,224 +1338,97 @@ bool md_write_to_buffer(mdhandle_t handle, uint8_t* buffer, size_t* len)
     {
         return false;
     }
-    
+
     size_t version_str_len = strlen(cxt->version);
     uint32_t version_buf_len = align_to((uint32_t)version_str_len + 1, 4);
 
     if (!write_u32(&buffer, &remaining_buffer_len, (uint32_t)version_buf_len))
         return false;
-    
+
     if (remaining_buffer_len < version_buf_len)
         return false;
-    
+
     memcpy(buffer, cxt->version, version_str_len + 1);
     // Pad the version string to a 4-byte boundary.
     memset(buffer + version_str_len + 1, 0, version_buf_len - version_str_len - 1);
     advance_output_stream(&buffer, &remaining_buffer_len, version_buf_len);
 
-    if (!write_u16(&buffer, &remaining_buffer_len, cxt->flags))
-        return false;
-    
-    uint16_t stream_count = 0;
-    if (cxt->blob_heap.size != 0)
-        stream_count++;
-    if (cxt->guid_heap.size != 0)
-        stream_count++;
-    if (cxt->strings_heap.size != 0)
-        stream_count++;
-    if (cxt->user_string_heap.size != 0)
-        stream_count++;
-
-    char const* tables_stream_name = "#~";
-
-    if (cxt->context_flags & mdc_minimal_delta)
+    if (!write_u16(&buffer, &remaining_buffer_len, cxt->flags)
+        || !write_u16(&buffer, &remaining_buffer_len, plan->stream_count))
     {
-        tables_stream_name = "#-";
-        stream_count++;
-    }
-
-    uint64_t valid_tables = 0;
-    uint64_t sorted_tables = 0;
-    for (uint8_t i = 0; i < MDTABLE_MAX_COUNT; ++i)
-    {
-        if (cxt->tables[i].cxt != NULL && cxt->tables[i].row_count != 0)
-        {
-            // We don't support saving if we are in the process of adding a new row.
-            if (cxt->tables[i].is_adding_new_row)
-                return false;
-
-            valid_tables |= (1ULL << i);
-            if (cxt->tables[i].is_sorted)
-                sorted_tables |= (1ULL << i);
-            
-            // Indirect tables only exist in images that use the uncompresed stream.
-            if (table_is_indirect_table((mdtable_id_t)i))
-                tables_stream_name = "#-";
-        }
-    }
-
-    // The tables stream is always included.
-    stream_count++;
-    
-    if (!write_u16(&buffer, &remaining_buffer_len, stream_count))
         return false;
-
-    mddata_t blob_heap_offset_space = { 0 };
-    mddata_t strings_heap_offset_space = { 0 };
-    mddata_t guid_heap_offset_space = { 0 };
-    mddata_t user_string_heap_offset_space = { 0 };
-    mddata_t tables_heap_offset_space = { 0 };
-#ifdef DNMD_PORTABLE_PDB
-    mddata_t pdb_offset_space = { 0 };
-#endif
+    }
 
     // Write the stream headers.
     if (cxt->context_flags & mdc_minimal_delta)
     {
-        mddata_t offset_space;
-        if (!write_stream_header("#JTD", 0, &offset_space, &buffer, &remaining_buffer_len))
-            return false;
-        
         // Set the stream offset to the location of the stream header.
         // There's no content in this stream, but the offset must be valid.
-        write_u32(&offset_space.ptr, &offset_space.size, (uint32_t)((uint8_t*)offset_space.ptr - buffer_start));
-    }
-
-    if (cxt->strings_heap.size != 0)
-    {
-        // The strings heap should be aligned to 4 bytes.
-        if (!write_stream_header("#Strings", align_to((uint32_t)cxt->strings_heap.size, 4), &strings_heap_offset_space, &buffer, &remaining_buffer_len))
-            return false;
-    }
-
-    if (cxt->blob_heap.size != 0)
-    {
-        if (!write_stream_header("#Blob", cxt->blob_heap.size, &blob_heap_offset_space, &buffer, &remaining_buffer_len))
-            return false;
-    }
-
-    if (cxt->guid_heap.size != 0)
-    {
-        if (!write_stream_header("#GUID", cxt->guid_heap.size, &guid_heap_offset_space, &buffer, &remaining_buffer_len))
-            return false;
-    }
-
-    if (cxt->user_string_heap.size != 0)
-    {
-        if (!write_stream_header("#US", cxt->user_string_heap.size, &user_string_heap_offset_space, &buffer, &remaining_buffer_len))
+        mdwrite_region_t jtd = { (size_t)(buffer - buffer_start), 0, 0 };
+        if (!write_stream_header("#JTD", &jtd, &buffer, &remaining_buffer_len))
             return false;
     }
 
-#ifdef DNMD_PORTABLE_PDB
-    if (cxt->pdb.size != 0)
-    {
-        if (!write_stream_header("#Pdb", cxt->pdb.size, &pdb_offset_space, &buffer, &remaining_buffer_len))
-            return false;
-    }
-#endif // DNMD_PORTABLE_PDB
-
-    size_t table_stream_size = get_table_stream_size(cxt);
-
-    if (table_stream_size > UINT32_MAX)
+    if (cxt->strings_heap.size != 0 && !write_stream_header("#Strings", &plan->strings_heap, &buffer, &remaining_buffer_len))
         return false;
 
-    if (!write_stream_header(tables_stream_name, (uint32_t)table_stream_size, &tables_heap_offset_space, &buffer, &remaining_buffer_len))
+    if (cxt->blob_heap.size != 0 && !write_stream_header("#Blob", &plan->blob_heap, &buffer, &remaining_buffer_len))
         return false;
 
-    // Write the stream data
-    if (cxt->strings_heap.size != 0)
-    {
-        assert(strings_heap_offset_space.ptr != NULL && strings_heap_offset_space.size == 4);
-        write_u32(&strings_heap_offset_space.ptr, &strings_heap_offset_space.size, (uint32_t)(buffer - buffer_start));
-        uint32_t string_heap_size = align_to((uint32_t)cxt->strings_heap.size, 4);
-        if (remaining_buffer_len < string_heap_size)
-            return false;
-        memcpy(buffer, cxt->strings_heap.ptr, cxt->strings_heap.size);
-        memset((uint8_t*)buffer + cxt->strings_heap.size, 0, string_heap_size - cxt->strings_heap.size);
-        advance_output_stream(&buffer, &remaining_buffer_len, string_heap_size);
-    }
-
-    if (cxt->blob_heap.size != 0)
-    {
-        assert(blob_heap_offset_space.ptr != NULL && blob_heap_offset_space.size == 4);
-        write_u32(&blob_heap_offset_space.ptr, &blob_heap_offset_space.size, (uint32_t)(buffer - buffer_start));
-        if (remaining_buffer_len < cxt->blob_heap.size)
-            return false;
-        memcpy(buffer, cxt->blob_heap.ptr, cxt->blob_heap.size);
-        advance_output_stream(&buffer, &remaining_buffer_len, cxt->blob_heap.size);
-    }
-
-    if (cxt->guid_heap.size != 0)
-    {
-        assert(guid_heap_offset_space.ptr != NULL && guid_heap_offset_space.size == 4);
-        write_u32(&guid_heap_offset_space.ptr, &guid_heap_offset_space.size, (uint32_t)(buffer - buffer_start));
-        if (remaining_buffer_len < cxt->guid_heap.size)
-            return false;
-        memcpy(buffer, cxt->guid_heap.ptr, cxt->guid_heap.size);
-        advance_output_stream(&buffer, &remaining_buffer_len, cxt->guid_heap.size);
-    }
+    if (cxt->guid_heap.size != 0 && !write_stream_header("#GUID", &plan->guid_heap, &buffer, &remaining_buffer_len))
+        return false;
 
-    if (cxt->user_string_heap.size != 0)
-    {
-        assert(user_string_heap_offset_space.ptr != NULL && user_string_heap_offset_space.size == 4);
-        write_u32(&user_string_heap_offset_space.ptr, &user_string_heap_offset_space.size, (uint32_t)(buffer - buffer_start));
-        if (remaining_buffer_len < cxt->user_string_heap.size)
-            return false;
-        memcpy(buffer, cxt->user_string_heap.ptr, cxt->user_string_heap.size);
-        advance_output_stream(&buffer, &remaining_buffer_len, cxt->user_string_heap.size);
-    }
+    if (cxt->user_string_heap.size != 0 && !write_stream_header("#US", &plan->user_string_heap, &buffer, &remaining_buffer_len))
+        return false;
 
 #ifdef DNMD_PORTABLE_PDB
-    if (cxt->pdb.size != 0)
-    {
-        assert(pdb_offset_space.ptr != NULL && pdb_offset_space.size == 4);
-        write_u32(&pdb_offset_space.ptr, &pdb_offset_space.size, (uint32_t)(buffer - buffer_start));
-        if (remaining_buffer_len < cxt->pdb.size)
-            return false;
-        memcpy(buffer, cxt->pdb.ptr, cxt->pdb.size);
-        advance_output_stream(&buffer, &remaining_buffer_len, cxt->pdb.size);
-    }
+    if (cxt->pdb.size != 0 && !write_stream_header("#Pdb", &plan->pdb, &buffer, &remaining_buffer_len))
+        return false;
 #endif // DNMD_PORTABLE_PDB
 
-    if (remaining_buffer_len < table_stream_size)
+    if (!write_stream_header(plan->tables_stream_name, &plan->tables_stream, &buffer, &remaining_buffer_len))
         return false;
 
+    // The first stream's contents immediately follow the stream headers.
+    assert((size_t)(buffer - buffer_start) == plan->strings_heap.offset);
+
     // Always write the table stream header. This is required for a valid image.
-    assert(tables_heap_offset_space.ptr != NULL && tables_heap_offset_space.size == 4);
-    write_u32(&tables_heap_offset_space.ptr, &tables_heap_offset_space.size, (uint32_t)(buffer - buffer_start));
+    buffer = buffer_start + plan->tables_stream.offset;
+    remaining_buffer_len = full_buffer_len - plan->tables_stream.offset;
     if (!write_u32(&buffer, &remaining_buffer_len, 0) // Reserved
         || !write_u8(&buffer, &remaining_buffer_len, 2) // MajorVersion
         || !write_u8(&buffer, &remaining_buffer_len, 0) // MinorVersion
         || !write_u8(&buffer, &remaining_buffer_len, (uint8_t)(cxt->context_flags & mdc_image_flags & ~mdc_extra_data)) // HeapOffsetSizes, excluding the extra data flag as we don't save it to write out.
         || !write_u8(&buffer, &remaining_buffer_len, 1) // Reserved
-        || !write_u64(&buffer, &remaining_buffer_len, valid_tables)
-        || !write_u64(&buffer, &remaining_buffer_len, sorted_tables))
+        || !write_u64(&buffer, &remaining_buffer_len, plan->valid_tables)
+        || !write_u64(&buffer, &remaining_buffer_len, plan->sorted_tables))
     {
         return false;
     }
 
-    if (valid_tables != 0)
+    for (uint8_t i = 0; i < MDTABLE_MAX_COUNT; ++i)
     {
-        for (uint8_t i = 0; i < MDTABLE_MAX_COUNT; ++i)
-        {
-            if (valid_tables & (1ULL << i))
-            {
-                if (!write_u32(&buffer, &remaining_buffer_len, cxt->tables[i].row_count))
-                    return false;
-            }
-        }
-
-        for (uint8_t i = 0; i < MDTABLE_MAX_COUNT; ++i)
+        if (plan->valid_tables & (1ULL << i))
         {
-            if (valid_tables & (1ULL << i))
-            {
-                assert (remaining_buffer_len >= cxt->tables[i].data.size);
-                memcpy(buffer, cxt->tables[i].data.ptr, cxt->tables[i].data.size);
-                advance_output_stream(&buffer, &remaining_buffer_len, cxt->tables[i].data.size);
-            }
+            if (!write_u32(&buffer, &remaining_buffer_len, cxt->tables[i].row_count))
+                return false;
         }
     }
 
-    assert(full_buffer_len - remaining_buffer_len == image_size);
+    // The stream and table data is all that remains.
+    return write_image_contents(cxt, plan, buffer_start);
+}
+
+bool md_get_original_image(mdhandle_t handle, uint8_t const** data, size_t* data_len)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || data == NULL || data_len == NULL)
+        return false;
+
+    if (has_edits(cxt) || cxt->raw_metadata.ptr == NULL)
+        return false;
+
+    *data = cxt->raw_metadata.ptr;
+    *data_len = cxt->raw_metadata.size;
     return true;
 }
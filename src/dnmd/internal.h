@@ -8,6 +8,7 @@
 #include <string.h>
 #include <corhdr.h>
 #include <dnmd.h>
+#include <dnmd_pe.h>
 #ifdef DNMD_PORTABLE_PDB
 #include <dnmd_pdb.h>
 #endif
@@ -94,6 +95,8 @@ typedef enum
     mdc_extra_data        = 0x0040,
     mdc_image_flags       = 0xffff,
     mdc_minimal_delta     = 0x00010000,
+    mdc_read_only         = 0x00020000, // The context is a snapshot and can't be edited.
+    mdc_edited            = 0x00040000, // The snapshot was created from an edited context.
 } mdcxt_flag_t;
 
 // Macros used to insert/extract the column offset.
@@ -124,8 +127,15 @@ typedef struct mdtable__
     bool is_sorted : 1;
     bool is_adding_new_row : 1;
     uint8_t table_id;
+    uint8_t segment_row_shift; // Log2 of the number of rows in each segment
+    uint64_t revision; // Incremented when an existing row is edited or moved - see md_get_table_revision().
     struct mdcxt__* cxt; // Non-null is indication of complete initialization
     mdtcol_t* column_details;
+
+    // Copy-on-write segments for a table that has been edited in place - see editor.c.
+    // A null segment is unmodified and is read from data.
+    // Null when all rows are in data.
+    uint8_t** segments;
 } mdtable_t;
 
 typedef mdcdata_t mdstream_t;
@@ -134,6 +144,24 @@ typedef struct mdmem__ mdmem_t;
 
 typedef struct mdeditor__ mdeditor_t;
 
+typedef struct mdwrite_plan__ mdwrite_plan_t;
+
+typedef struct mdca_cache__ mdca_cache_t;
+
+typedef struct mdsig_cache__ mdsig_cache_t;
+
+typedef struct mdref_index__ mdref_index_t;
+
+#ifdef DNMD_PORTABLE_PDB
+typedef struct mdseqpt_cache__ mdseqpt_cache_t;
+
+typedef struct mddocline_index__ mddocline_index_t;
+
+typedef struct mdscope_index__ mdscope_index_t;
+
+typedef struct mddocname_index__ mddocname_index_t;
+#endif // DNMD_PORTABLE_PDB
+
 typedef struct mdcxt__
 {
     uint32_t magic; // mdlib magic
@@ -162,6 +190,51 @@ typedef struct mdcxt__
 
     // Additional memory used for dynamic operations
     mdmem_t* mem;
+
+    // Memory shared with the context this context is a snapshot of
+    void** shared_mem;
+    size_t shared_mem_count;
+
+    // Layout of the image computed by md_prepare_write
+    mdwrite_plan_t* write_plan;
+
+    // Incremented on every edit - see md_get_revision().
+    uint64_t revision;
+
+    // Parsed custom attribute constructor signatures - see custom_attributes.c.
+    // Readers publish to the cache concurrently, so it is only accessed atomically.
+    mdca_cache_t* volatile ca_cache;
+
+    // Decoded signatures - see signatures.c.
+    // Readers publish to the cache concurrently, so it is only accessed atomically.
+    mdsig_cache_t* volatile sig_cache;
+
+    // Hash indexes of the TypeRef and AssemblyRef tables - see ref_index.c.
+    // Readers publish the indexes concurrently, so they are only accessed atomically outside of edits.
+    mdref_index_t* volatile type_ref_index;
+    mdref_index_t* volatile assembly_ref_index;
+
+    // PE image the metadata was read from - see md_create_handle_from_pe().
+    // The context holds a reference on it.
+    mdpe_t pe;
+
+#ifdef DNMD_PORTABLE_PDB
+    // Decoded sequence points of recently used methods - see sequence_points.c.
+    // Readers take and return the entries concurrently, so it is only accessed atomically.
+    mdseqpt_cache_t* volatile sequence_point_cache;
+
+    // Line ranges of the methods in each Document - see sequence_points.c.
+    // Readers publish the index concurrently, so it is only accessed atomically outside of edits.
+    mddocline_index_t* volatile document_line_index;
+
+    // Nesting of the LocalScope rows - see local_scopes.c.
+    // Readers publish the index concurrently, so it is only accessed atomically outside of edits.
+    mdscope_index_t* volatile local_scope_index;
+
+    // Decoded Document names and a hash index of them - see documents.c.
+    // Readers publish the names and index concurrently, so they are only accessed atomically outside of edits.
+    mddocname_index_t* volatile document_name_index;
+#endif // DNMD_PORTABLE_PDB
 } mdcxt_t;
 
 // Extract a context from the mdhandle_t.
@@ -171,9 +244,53 @@ mdcxt_t* extract_mdcxt(mdhandle_t md);
 void* alloc_mdmem(mdcxt_t* cxt, size_t length);
 void free_mdmem(mdcxt_t* cxt, void* mem);
 
+// Check if tracked memory is also referenced by a snapshot of the context.
+// Shared memory must be copied before it is modified.
+bool is_mdmem_shared(void const* mem);
+
+// Collect the tracked memory that backs the tables and heaps of an edited context.
+// If mem is NULL, only the number of allocations is returned.
+size_t collect_editor_mem(mdcxt_t* cxt, void** mem);
+
 // Merge the supplied delta into the context.
 bool merge_in_delta(mdcxt_t* cxt, mdcxt_t* delta);
 
+// Release the cache of parsed custom attribute constructor signatures.
+// The context must not be in use by other threads.
+void free_ca_cache(mdcxt_t* cxt);
+
+// Release the cache of decoded signatures.
+// The context must not be in use by other threads.
+void free_sig_cache(mdcxt_t* cxt);
+
+// Release the TypeRef and AssemblyRef indexes.
+// The context must not be in use by other threads.
+void free_ref_indexes(mdcxt_t* cxt);
+
+#ifdef DNMD_PORTABLE_PDB
+// Release the cache of decoded sequence points and the Document line index.
+// The context must not be in use by other threads.
+void free_sequence_point_indexes(mdcxt_t* cxt);
+
+// Release the LocalScope nesting index.
+// The context must not be in use by other threads.
+void free_local_scope_index(mdcxt_t* cxt);
+
+// Release the decoded Document names and their hash index.
+// The context must not be in use by other threads.
+void free_document_name_index(mdcxt_t* cxt);
+#endif // DNMD_PORTABLE_PDB
+
+// Keep the TypeRef and AssemblyRef indexes consistent with an edit to a row (0-based) of the table.
+// Edits to the row being added to the end of the table are ignored until the row is committed.
+void update_ref_index_for_edited_row(mdtable_t* table, uint32_t row_index);
+
+// Add a committed row to the index of its table, if the table is indexed.
+void update_ref_index_for_committed_row(mdcursor_t row);
+
+// Take a reference on the PE, which is released with md_pe_close().
+void add_pe_ref(mdpe_t pe);
+
 //
 // Streams
 //
@@ -342,6 +459,32 @@ static col_index_t index_to_col(uint8_t idx, mdtable_id_t table_id)
     return (col_index_t)idx;
 #endif
 }
+
+// Get the data for the row at the 0-based index in the table.
+static uint8_t const* get_table_row_data(mdtable_t const* table, uint32_t row_index)
+{
+    assert(table != NULL && row_index < table->row_count);
+    if (table->segments != NULL)
+    {
+        uint32_t segment = row_index >> table->segment_row_shift;
+        uint8_t const* segment_data = table->segments[segment];
+        if (segment_data != NULL)
+            return segment_data + (size_t)(row_index - (segment << table->segment_row_shift)) * table->row_size_bytes;
+    }
+    return table->data.ptr + (size_t)row_index * table->row_size_bytes;
+}
+
+// Get the 0-based index of the row after the last row that is
+// stored contiguously with the row at the 0-based index in the table.
+static uint32_t get_table_contiguous_rows_end(mdtable_t const* table, uint32_t row_index)
+{
+    assert(table != NULL && row_index < table->row_count);
+    if (table->segments == NULL)
+        return table->row_count;
+
+    uint32_t segment_end = ((row_index >> table->segment_row_shift) + 1) << table->segment_row_shift;
+    return segment_end < table->row_count ? segment_end : table->row_count;
+}
 #ifdef __GNUC__
 #pragma GCC diagnostic pop
 #endif
@@ -362,6 +505,9 @@ typedef struct access_cxt__
     size_t data_len;
     uint32_t data_len_col;
     uint32_t next_row_stride;
+    uint32_t col_offset;
+    uint32_t rows_end; // 0-based index of the row after the last row that is accessed
+    uint32_t contiguous_rows_end; // 0-based index of the row after the last row addressable from data
 } access_cxt_t;
 
 bool create_access_context(mdcursor_t* cursor, col_index_t col_idx, uint32_t row_count, bool make_writable, access_cxt_t* acxt);
@@ -416,7 +562,7 @@ bool compress_u32(uint32_t data, uint8_t* compressed, size_t* compressed_len);
 // Editing
 bool create_and_fill_indirect_table(mdcxt_t* cxt, mdtable_id_t original_table, mdtable_id_t indirect_table);
 bool allocate_new_table(mdcxt_t* cxt, mdtable_id_t table_id);
-uint8_t* get_writable_table_data(mdtable_t* table, bool make_writable);
+uint8_t* get_writable_table_row(mdtable_t* table, uint32_t row_index);
 bool initialize_new_table_details(mdcxt_t* cxt, mdtable_id_t id, mdtable_t* table);
 int32_t update_shifted_row_references(mdcursor_t* c, uint32_t count, uint8_t col_index, mdtable_id_t updated_table, uint32_t original_starting_table_index, uint32_t new_starting_table_index);
 bool insert_row_into_table(mdcxt_t* cxt, mdtable_id_t table_id, uint32_t row_index, mdcursor_t* new_row);
@@ -432,4 +578,124 @@ bool append_heap(mdcxt_t* cxt, mdcxt_t* delta, mdtcol_t heap_id);
 
 extern mdguid_t const empty_guid;
 
+//
+// Image writing
+//
+
+// Location of a stream or table in the written image.
+typedef struct mdwrite_region__
+{
+    size_t offset; // Offset from the start of the image
+    size_t size; // Size of the source data
+    size_t padded_size; // Size of the region in the image
+} mdwrite_region_t;
+
+// Layout of a metadata image with the final offsets of each stream and table.
+// The plan records the state it was computed from so it can be reused
+// as long as the metadata hasn't changed shape.
+struct mdwrite_plan__
+{
+    size_t image_size;
+    uint16_t stream_count;
+    char const* tables_stream_name;
+    mdcxt_flag_t context_flags;
+    uint64_t valid_tables;
+    uint64_t sorted_tables;
+
+    mdwrite_region_t strings_heap;
+    mdwrite_region_t guid_heap;
+    mdwrite_region_t blob_heap;
+    mdwrite_region_t user_string_heap;
+#ifdef DNMD_PORTABLE_PDB
+    mdwrite_region_t pdb;
+#endif // DNMD_PORTABLE_PDB
+    mdwrite_region_t tables_stream;
+    mdwrite_region_t tables[MDTABLE_MAX_COUNT];
+};
+
+//
+// Atomic operations
+//
+
+#ifdef _MSC_VER
+#include <intrin.h>
+static inline int32_t atomic_increment(int32_t volatile* value)
+{
+    return _InterlockedIncrement((long volatile*)value);
+}
+
+static inline int32_t atomic_decrement(int32_t volatile* value)
+{
+    return _InterlockedDecrement((long volatile*)value);
+}
+
+static inline int32_t atomic_load(int32_t volatile* value)
+{
+    return _InterlockedOr((long volatile*)value, 0);
+}
+
+static inline void* atomic_load_ptr(void* volatile* ptr)
+{
+    return _InterlockedCompareExchangePointer(ptr, NULL, NULL);
+}
+
+// Publish the value if no value has been published yet.
+static inline bool atomic_publish_ptr(void* volatile* ptr, void* value)
+{
+    return _InterlockedCompareExchangePointer(ptr, value, NULL) == NULL;
+}
+
+// Take the published value, leaving nothing published.
+static inline void* atomic_take_ptr(void* volatile* ptr)
+{
+    return _InterlockedExchangePointer(ptr, NULL);
+}
+#else
+static inline int32_t atomic_increment(int32_t volatile* value)
+{
+    return __atomic_add_fetch(value, 1, __ATOMIC_RELAXED);
+}
+
+static inline int32_t atomic_decrement(int32_t volatile* value)
+{
+    return __atomic_sub_fetch(value, 1, __ATOMIC_ACQ_REL);
+}
+
+static inline int32_t atomic_load(int32_t volatile* value)
+{
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void* atomic_load_ptr(void* volatile* ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+// Publish the value if no value has been published yet.
+static inline bool atomic_publish_ptr(void* volatile* ptr, void* value)
+{
+    void* expected = NULL;
+    return __atomic_compare_exchange_n(ptr, &expected, value, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+// Take the published value, leaving nothing published.
+static inline void* atomic_take_ptr(void* volatile* ptr)
+{
+    return __atomic_exchange_n(ptr, NULL, __ATOMIC_ACQ_REL);
+}
+#endif // !_MSC_VER
+
+//
+// Parallel work
+//
+
+typedef void (*parallel_fn_t)(void* arg, size_t index);
+
+// Get the maximum number of threads parallel_for will use.
+size_t get_max_parallelism(void);
+
+// Invoke fn for each index in [0, count) using at most max_workers threads, including the calling thread.
+// Returns once all indices have been processed.
+void parallel_for(size_t count, size_t max_workers, parallel_fn_t fn, void* arg);
+
 #endif // _SRC_DNMD_INTERNAL_H_
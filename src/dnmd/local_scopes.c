@@ -0,0 +1,192 @@
+#include "internal.h"
+
+// Local scope lookup for Portable PDB LocalScope rows.
+
+typedef struct scope_range__
+{
+    uint32_t start;
+    uint64_t end;
+    // The row of the innermost scope of the same method that contains this one, or 0.
+    uint32_t parent;
+} scope_range_t;
+
+// The LocalScope table is sorted by method, then by start offset, then by descending length.
+// The scopes of a method are in pre-order of their nesting, so the parent of each scope
+// is found in one pass with a stack of the open scopes.
+// Element N - 1 describes row N.
+struct mdscope_index__
+{
+    uint32_t row_count;
+    scope_range_t scopes[];
+};
+
+void free_local_scope_index(mdcxt_t* cxt)
+{
+    assert(cxt != NULL);
+    free(cxt->local_scope_index);
+    cxt->local_scope_index = NULL;
+}
+
+static mdscope_index_t* build_local_scope_index(mdcxt_t* cxt)
+{
+    mdcursor_t cursor;
+    uint32_t row_count;
+    if (!md_create_cursor(cxt, mdtid_LocalScope, &cursor, &row_count))
+        return NULL;
+
+    mdscope_index_t* index = (mdscope_index_t*)malloc(sizeof(mdscope_index_t) + row_count * sizeof(scope_range_t));
+    mdToken* methods = (mdToken*)malloc(row_count * sizeof(mdToken));
+    uint32_t* starts = (uint32_t*)malloc(row_count * sizeof(uint32_t));
+    uint32_t* lengths = (uint32_t*)malloc(row_count * sizeof(uint32_t));
+    // The rows of the open scopes, from outermost to innermost.
+    uint32_t* open = (uint32_t*)malloc(row_count * sizeof(uint32_t));
+    bool success = index != NULL && methods != NULL && starts != NULL && lengths != NULL && open != NULL;
+
+    // Read the columns of all rows at once.
+    success = success
+        && (int32_t)row_count == md_get_column_value_as_token(cursor, mdtLocalScope_Method, row_count, methods)
+        && (int32_t)row_count == md_get_column_value_as_constant(cursor, mdtLocalScope_StartOffset, row_count, starts)
+        && (int32_t)row_count == md_get_column_value_as_constant(cursor, mdtLocalScope_Length, row_count, lengths);
+
+    uint32_t open_count = 0;
+    for (uint32_t i = 0; success && i < row_count; ++i)
+    {
+        scope_range_t* scope = &index->scopes[i];
+        scope->start = starts[i];
+        scope->end = (uint64_t)starts[i] + lengths[i];
+
+        if (i != 0 && methods[i] != methods[i - 1])
+            open_count = 0;
+
+        // Close the scopes that don't contain this one.
+        while (open_count > 0)
+        {
+            scope_range_t const* candidate = &index->scopes[open[open_count - 1] - 1];
+            if (candidate->start <= scope->start && scope->end <= candidate->end)
+                break;
+            open_count--;
+        }
+
+        scope->parent = open_count > 0 ? open[open_count - 1] : 0;
+        open[open_count++] = i + 1;
+    }
+
+    free(open);
+    free(lengths);
+    free(starts);
+    free(methods);
+    if (!success)
+    {
+        free(index);
+        return NULL;
+    }
+
+    index->row_count = row_count;
+    return index;
+}
+
+static mdscope_index_t* get_local_scope_index(mdcxt_t* cxt)
+{
+    mdscope_index_t* index = (mdscope_index_t*)atomic_load_ptr((void* volatile*)&cxt->local_scope_index);
+    if (index != NULL)
+        return index;
+
+    mdscope_index_t* new_index = build_local_scope_index(cxt);
+    if (new_index == NULL)
+        return NULL;
+
+    if (atomic_publish_ptr((void* volatile*)&cxt->local_scope_index, new_index))
+        return new_index;
+
+    // Another thread published an index first.
+    free(new_index);
+    return (mdscope_index_t*)atomic_load_ptr((void* volatile*)&cxt->local_scope_index);
+}
+
+static bool read_local_scope(mdcursor_t scope_cursor, scope_range_t const* range, md_local_scope_t* scope)
+{
+    scope->scope = scope_cursor;
+    scope->start_offset = range->start;
+    scope->length = (uint32_t)(range->end - range->start);
+
+    if (1 != md_get_column_value_as_cursor(scope_cursor, mdtLocalScope_ImportScope, 1, &scope->import_scope)
+        || !md_get_column_value_as_range(scope_cursor, mdtLocalScope_VariableList, &scope->variables, &scope->variable_count)
+        || !md_get_column_value_as_range(scope_cursor, mdtLocalScope_ConstantList, &scope->constants, &scope->constant_count))
+    {
+        return false;
+    }
+
+    // Resolve the first row in case the list runs through an indirection table, so the range can be iterated directly.
+    return md_resolve_indirect_cursor(scope->variables, &scope->variables)
+        && md_resolve_indirect_cursor(scope->constants, &scope->constants);
+}
+
+bool md_get_local_scopes_at_offset(mdhandle_t handle, mdToken method_def, uint32_t il_offset, md_local_scope_t* scopes, uint32_t* scope_count)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || scope_count == NULL)
+        return false;
+
+    if (ExtractTokenType(method_def) != mdtid_MethodDef)
+        return false;
+
+    mdcursor_t begin;
+    uint32_t row_count;
+    if (!md_create_cursor(handle, mdtid_LocalScope, &begin, &row_count))
+    {
+        // The LocalScope table is empty.
+        *scope_count = 0;
+        return true;
+    }
+
+    mdcursor_t method_scopes;
+    uint32_t method_scope_count;
+    switch (md_find_range_from_cursor(begin, mdtLocalScope_Method, RidFromToken(method_def), &method_scopes, &method_scope_count))
+    {
+    case MD_RANGE_FOUND:
+        break;
+    case MD_RANGE_NOT_FOUND:
+        *scope_count = 0;
+        return true;
+    default:
+        return false;
+    }
+
+    mdscope_index_t* index = get_local_scope_index(cxt);
+    if (index == NULL)
+        return false;
+
+    // Find the last scope of the method that starts at or before the offset.
+    uint32_t first_row = CursorRow(&method_scopes);
+    uint32_t lo = first_row;
+    uint32_t hi = first_row + method_scope_count;
+    assert(hi - 1 <= index->row_count);
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (index->scopes[mid - 1].start <= il_offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    // Every scope that contains the offset is that scope or one of its parents.
+    uint32_t capacity = scopes != NULL ? *scope_count : 0;
+    uint32_t count = 0;
+    for (uint32_t row = lo - 1; row >= first_row; row = index->scopes[row - 1].parent)
+    {
+        scope_range_t const* range = &index->scopes[row - 1];
+        if (il_offset >= range->end)
+            continue;
+
+        if (count < capacity
+            && !read_local_scope(create_cursor(&cxt->tables[mdtid_LocalScope], row), range, &scopes[count]))
+        {
+            return false;
+        }
+        count++;
+    }
+
+    *scope_count = count;
+    return scopes == NULL || count <= capacity;
+}
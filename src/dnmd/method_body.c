@@ -0,0 +1,297 @@
+#include "internal.h"
+
+// Method bodies - II.25.4
+
+// II.25.4.2 - Tiny headers store the code size in the upper six bits.
+#define TINY_FORMAT_CODE_SIZE_SHIFT 2
+#define TINY_FORMAT_MAX_STACK 8
+
+// II.25.4.3 - Fat headers are three 4-byte words.
+#define FAT_FORMAT_HEADER_SIZE 3
+#define FAT_FORMAT_FLAGS_MASK 0x0fff
+#define FAT_FORMAT_SIZE_SHIFT 12
+
+// II.25.4.5 - Data sections are 4-byte aligned and start with a kind byte.
+#define SMALL_SECTION_HEADER_SIZE 4
+#define SMALL_CLAUSE_SIZE 12
+#define FAT_SECTION_HEADER_SIZE 4
+#define FAT_CLAUSE_SIZE 24
+
+static bool read_method_body(mdpe_t pe, mdToken method, uint32_t rva, md_method_body_t* body)
+{
+    assert(pe != NULL && body != NULL);
+    memset(body, 0, sizeof(*body));
+    body->method = method;
+    body->rva = rva;
+
+    size_t available;
+    uint8_t const* curr = md_pe_rva_to_data(pe, rva, &available);
+    if (curr == NULL)
+        return false;
+
+    uint8_t const* header = curr;
+    size_t header_len = available;
+    uint8_t first;
+    if (!read_u8(&header, &header_len, &first))
+        return false;
+
+    // The format is in the low two bits. CorILMethod_FormatMask also covers the low bit of a tiny header's size.
+    switch (first & (CorILMethod_FormatMask >> 1))
+    {
+    case CorILMethod_TinyFormat:
+        body->flags = CorILMethod_TinyFormat;
+        body->max_stack = TINY_FORMAT_MAX_STACK;
+        body->il_size = first >> TINY_FORMAT_CODE_SIZE_SHIFT;
+        break;
+
+    case CorILMethod_FatFormat:
+    {
+        header = curr;
+        header_len = available;
+        uint16_t flags_and_size;
+        if (!read_u16(&header, &header_len, &flags_and_size)
+            || (flags_and_size >> FAT_FORMAT_SIZE_SHIFT) != FAT_FORMAT_HEADER_SIZE
+            || !read_u16(&header, &header_len, &body->max_stack)
+            || !read_u32(&header, &header_len, &body->il_size)
+            || !read_u32(&header, &header_len, &body->local_var_sig))
+        {
+            return false;
+        }
+
+        body->flags = flags_and_size & FAT_FORMAT_FLAGS_MASK;
+        if (body->local_var_sig != 0 && ExtractTokenType(body->local_var_sig) != mdtid_StandAloneSig)
+            return false;
+        break;
+    }
+
+    default:
+        return false;
+    }
+
+    if (body->il_size > header_len)
+        return false;
+
+    body->il = header;
+    if (!(body->flags & CorILMethod_MoreSects))
+        return true;
+
+    // Data sections follow the IL, aligned to 4 bytes from the start of the header.
+    size_t sections_offset = align_to((uint32_t)((header - curr) + body->il_size), 4);
+    if (sections_offset > available)
+        return false;
+
+    body->sections = curr + sections_offset;
+    body->sections_len = available - sections_offset;
+
+    // Count the clauses so callers can size the array passed to md_get_exception_clauses().
+    return md_get_exception_clauses(body, NULL, &body->exception_clause_count);
+}
+
+bool md_get_method_body(mdcursor_t method_def, md_method_body_t* body)
+{
+    if (body == NULL)
+        return false;
+
+    mdtable_t* table = CursorTable(&method_def);
+    if (table == NULL || table->cxt == NULL || table->table_id != mdtid_MethodDef)
+        return false;
+
+    mdpe_t pe = table->cxt->pe;
+    if (pe == NULL)
+        return false;
+
+    mdToken method;
+    uint32_t rva;
+    uint32_t impl_flags;
+    if (!md_cursor_to_token(method_def, &method)
+        || 1 != md_get_column_value_as_constant(method_def, mdtMethodDef_Rva, 1, &rva)
+        || 1 != md_get_column_value_as_constant(method_def, mdtMethodDef_ImplFlags, 1, &impl_flags))
+    {
+        return false;
+    }
+
+    // Abstract, runtime-implemented and P/Invoke methods have no body.
+    // The RVA of a native method (for example, from a mixed-mode image) is machine code.
+    if (rva == 0 || !IsMiIL(impl_flags))
+        return false;
+
+    return read_method_body(pe, method, rva, body);
+}
+
+bool md_get_exception_clauses(md_method_body_t const* body, md_exception_clause_t* clauses, uint32_t* clause_count)
+{
+    if (body == NULL || clause_count == NULL)
+        return false;
+
+    uint32_t capacity = clauses != NULL ? *clause_count : 0;
+    uint32_t count = 0;
+
+    uint8_t const* curr = body->sections;
+    size_t curr_len = body->sections_len;
+    uint8_t kind = (body->flags & CorILMethod_MoreSects) ? CorILMethod_Sect_MoreSects : 0;
+    while (kind & CorILMethod_Sect_MoreSects)
+    {
+        // Each section starts on a 4-byte boundary.
+        size_t misalignment = (size_t)(curr - body->sections) % 4;
+        if (misalignment != 0 && !advance_stream(&curr, &curr_len, 4 - misalignment))
+            return false;
+
+        uint8_t const* section = curr;
+        size_t section_len = curr_len;
+        uint32_t data_size;
+        uint32_t clause_size;
+        if (!read_u8(&section, &section_len, &kind))
+            return false;
+
+        if (kind & CorILMethod_Sect_FatFormat)
+        {
+            // The data size is the three bytes after the kind.
+            uint32_t header;
+            section = curr;
+            section_len = curr_len;
+            if (!read_u32(&section, &section_len, &header))
+                return false;
+            data_size = header >> 8;
+            if (data_size < FAT_SECTION_HEADER_SIZE)
+                return false;
+            clause_size = FAT_CLAUSE_SIZE;
+            data_size -= FAT_SECTION_HEADER_SIZE;
+        }
+        else
+        {
+            uint8_t small_size;
+            if (!read_u8(&section, &section_len, &small_size)
+                || small_size < SMALL_SECTION_HEADER_SIZE
+                || !advance_stream(&section, &section_len, 2))
+            {
+                return false;
+            }
+            clause_size = SMALL_CLAUSE_SIZE;
+            data_size = small_size - SMALL_SECTION_HEADER_SIZE;
+        }
+
+        if (data_size > section_len)
+            return false;
+
+        if ((kind & CorILMethod_Sect_KindMask) == CorILMethod_Sect_EHTable)
+        {
+            uint8_t const* clause_data = section;
+            size_t clause_data_len = data_size;
+            for (uint32_t i = 0; i < data_size / clause_size; ++i, ++count)
+            {
+                if (count >= capacity)
+                    continue;
+
+                md_exception_clause_t* clause = &clauses[count];
+                bool read;
+                if (clause_size == FAT_CLAUSE_SIZE)
+                {
+                    read = read_u32(&clause_data, &clause_data_len, &clause->flags)
+                        && read_u32(&clause_data, &clause_data_len, &clause->try_offset)
+                        && read_u32(&clause_data, &clause_data_len, &clause->try_length)
+                        && read_u32(&clause_data, &clause_data_len, &clause->handler_offset)
+                        && read_u32(&clause_data, &clause_data_len, &clause->handler_length)
+                        && read_u32(&clause_data, &clause_data_len, &clause->class_token_or_filter_offset);
+                }
+                else
+                {
+                    uint16_t flags;
+                    uint16_t try_offset;
+                    uint8_t try_length;
+                    uint16_t handler_offset;
+                    uint8_t handler_length;
+                    read = read_u16(&clause_data, &clause_data_len, &flags)
+                        && read_u16(&clause_data, &clause_data_len, &try_offset)
+                        && read_u8(&clause_data, &clause_data_len, &try_length)
+                        && read_u16(&clause_data, &clause_data_len, &handler_offset)
+                        && read_u8(&clause_data, &clause_data_len, &handler_length)
+                        && read_u32(&clause_data, &clause_data_len, &clause->class_token_or_filter_offset);
+                    clause->flags = flags;
+                    clause->try_offset = try_offset;
+                    clause->try_length = try_length;
+                    clause->handler_offset = handler_offset;
+                    clause->handler_length = handler_length;
+                }
+
+                if (!read)
+                    return false;
+            }
+        }
+
+        // Move past the section header and its data.
+        if (!advance_stream(&curr, &curr_len, (size_t)(section - curr) + data_size))
+            return false;
+    }
+
+    *clause_count = count;
+    return clauses == NULL || count <= capacity;
+}
+
+typedef struct method_rva__
+{
+    uint32_t rva;
+    uint32_t row;
+} method_rva_t;
+
+static int compare_method_rva(void const* l, void const* r)
+{
+    method_rva_t const* left = l;
+    method_rva_t const* right = r;
+    if (left->rva != right->rva)
+        return left->rva < right->rva ? -1 : 1;
+    return left->row < right->row ? -1 : (left->row > right->row ? 1 : 0);
+}
+
+bool md_get_method_bodies(mdhandle_t handle, md_method_body_t* bodies, uint32_t* body_count)
+{
+    if (body_count == NULL)
+        return false;
+
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || cxt->pe == NULL)
+        return false;
+
+    mdcursor_t cursor;
+    uint32_t row_count;
+    if (!md_create_cursor(handle, mdtid_MethodDef, &cursor, &row_count))
+    {
+        // The MethodDef table is empty.
+        *body_count = 0;
+        return true;
+    }
+
+    // Read all RVAs at once and visit the bodies in RVA order, so the image is read sequentially.
+    method_rva_t* methods = (method_rva_t*)malloc(row_count * sizeof(*methods));
+    uint32_t* rvas = (uint32_t*)malloc(row_count * sizeof(*rvas));
+    uint32_t* impl_flags = (uint32_t*)malloc(row_count * sizeof(*impl_flags));
+    bool success = methods != NULL && rvas != NULL && impl_flags != NULL
+        && (int32_t)row_count == md_get_column_value_as_constant(cursor, mdtMethodDef_Rva, row_count, rvas)
+        && (int32_t)row_count == md_get_column_value_as_constant(cursor, mdtMethodDef_ImplFlags, row_count, impl_flags);
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; success && i < row_count; ++i)
+    {
+        if (rvas[i] == 0 || !IsMiIL(impl_flags[i]))
+            continue;
+        methods[count].rva = rvas[i];
+        methods[count].row = i + 1;
+        count++;
+    }
+
+    if (success && bodies != NULL && count <= *body_count)
+    {
+        qsort(methods, count, sizeof(*methods), compare_method_rva);
+        for (uint32_t i = 0; success && i < count; ++i)
+            success = read_method_body(cxt->pe, TokenFromRid(methods[i].row, CreateTokenType(mdtid_MethodDef)), methods[i].rva, &bodies[i]);
+    }
+    else if (success && bodies != NULL)
+    {
+        success = false;
+    }
+
+    free(impl_flags);
+    free(rvas);
+    free(methods);
+    *body_count = count;
+    return success;
+}
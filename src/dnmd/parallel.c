@@ -0,0 +1,133 @@
+#include "internal.h"
+
+#ifdef BUILD_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// Upper bound on the number of threads used for a single parallel operation.
+// The work we parallelize is memory bound, so more threads than this
+// rarely helps and just adds start-up cost.
+#define MAX_WORKER_COUNT 8
+
+typedef struct parallel_worker__
+{
+    parallel_fn_t fn;
+    void* arg;
+    size_t first;
+    size_t count;
+    size_t stride;
+} parallel_worker_t;
+
+static void run_worker(parallel_worker_t* worker)
+{
+    // Workers process interleaved indices so that when work items are of
+    // similar size each worker is given a similar amount of work.
+    for (size_t i = worker->first; i < worker->count; i += worker->stride)
+        worker->fn(worker->arg, i);
+}
+
+#ifdef BUILD_WINDOWS
+typedef HANDLE worker_thread_t;
+
+static DWORD WINAPI worker_thread_start(LPVOID arg)
+{
+    run_worker((parallel_worker_t*)arg);
+    return 0;
+}
+
+static bool start_worker_thread(parallel_worker_t* worker, worker_thread_t* thread)
+{
+    *thread = CreateThread(NULL, 0, worker_thread_start, worker, 0, NULL);
+    return *thread != NULL;
+}
+
+static void join_worker_thread(worker_thread_t thread)
+{
+    (void)WaitForSingleObject(thread, INFINITE);
+    (void)CloseHandle(thread);
+}
+
+static size_t get_processor_count(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (size_t)info.dwNumberOfProcessors;
+}
+#else
+typedef pthread_t worker_thread_t;
+
+static void* worker_thread_start(void* arg)
+{
+    run_worker((parallel_worker_t*)arg);
+    return NULL;
+}
+
+static bool start_worker_thread(parallel_worker_t* worker, worker_thread_t* thread)
+{
+    return pthread_create(thread, NULL, worker_thread_start, worker) == 0;
+}
+
+static void join_worker_thread(worker_thread_t thread)
+{
+    (void)pthread_join(thread, NULL);
+}
+
+static size_t get_processor_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+}
+#endif // !BUILD_WINDOWS
+
+size_t get_max_parallelism(void)
+{
+    size_t count = get_processor_count();
+    return count < MAX_WORKER_COUNT ? count : MAX_WORKER_COUNT;
+}
+
+void parallel_for(size_t count, size_t max_workers, parallel_fn_t fn, void* arg)
+{
+    assert(fn != NULL);
+
+    size_t worker_count = get_max_parallelism();
+    if (worker_count > max_workers)
+        worker_count = max_workers;
+    if (worker_count > count)
+        worker_count = count;
+
+    parallel_worker_t workers[MAX_WORKER_COUNT];
+    worker_thread_t threads[MAX_WORKER_COUNT];
+    for (size_t i = 0; i < worker_count; ++i)
+    {
+        workers[i].fn = fn;
+        workers[i].arg = arg;
+        workers[i].first = i;
+        workers[i].count = count;
+        workers[i].stride = worker_count;
+    }
+
+    // The calling thread acts as the first worker.
+    // If we fail to start a thread, the remaining
+    // work is folded back onto the calling thread.
+    size_t started = 0;
+    for (size_t i = 1; i < worker_count; ++i)
+    {
+        if (!start_worker_thread(&workers[i], &threads[i]))
+            break;
+        started++;
+    }
+
+    if (worker_count > 0)
+        run_worker(&workers[0]);
+
+    // Process the indices assigned to any workers that didn't start.
+    for (size_t i = started + 1; i < worker_count; ++i)
+        run_worker(&workers[i]);
+
+    for (size_t i = 1; i <= started; ++i)
+        join_worker_thread(threads[i]);
+}
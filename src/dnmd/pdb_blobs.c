@@ -80,71 +80,44 @@ md_blob_parse_result_t md_parse_document_name(mdhandle_t handle, uint8_t const*
     return result;
 }
 
-// We only support up to UINT32_MAX - 1 sequence points per method.
-// Technically, the number of supported sequence points in the spec is unbounded.
-// However, the PE format that an ECMA-335 blob is commonly wrapped in
-// can only support up to 4GB files, so we can't possibly have UINT32_MAX - 1 entries
-// in any existing scenario anyway.
-static uint32_t get_num_sequence_points(mdcursor_t method_debug_information, uint8_t const* blob, size_t blob_len)
+// Read the header of a SequencePoints blob.
+// The initial document is stored in the blob only if the MethodDebugInformation row doesn't have one.
+static bool read_sequence_points_header(
+    mdcursor_t method_debug_information,
+    uint8_t const** blob,
+    size_t* blob_len,
+    uint32_t* signature,
+    mdcursor_t* initial_document)
 {
-    uint32_t num_records = 0;
-    uint32_t ignored;
-    if (!decompress_u32(&blob, &blob_len, &ignored)) // header LocalSignature
-        return UINT32_MAX;
+    // header LocalSignature
+    if (!decompress_u32(blob, blob_len, signature))
+        return false;
 
     mdcursor_t document;
     if (1 != md_get_column_value_as_cursor(method_debug_information, mdtMethodDebugInformation_Document, 1, &document))
-        return UINT32_MAX;
+        return false;
 
-    if (CursorNull(&document) && !decompress_u32(&blob, &blob_len, &ignored)) // header InitialDocument
-        return UINT32_MAX;
+    // Create a "null" cursor to default-initialize the document field.
+    mdcxt_t* cxt = extract_mdcxt(md_extract_handle_from_cursor(method_debug_information));
+    *initial_document = create_cursor(&cxt->tables[mdtid_Document], 0);
 
-    bool first_record = true;
-    while (blob_len > 0)
+    // header InitialDocument
+    uint32_t document_rid = 0;
+    if (CursorNull(&document)
+        && !decompress_u32(blob, blob_len, &document_rid))
     {
-        if (num_records == UINT32_MAX)
-            return UINT32_MAX;
-        num_records++;
-        uint32_t il_offset;
-        if (!decompress_u32(&blob, &blob_len, &il_offset)) // ILOffset
-            return UINT32_MAX;
-
-        // The first record cannot be a document record
-        if (!first_record && il_offset == 0)
-        {
-            uint32_t document_offset;
-            if (!decompress_u32(&blob, &blob_len, &document_offset)) // Document
-                return UINT32_MAX;
-        }
-        else
-        {
-            // We don't need to check if we need to do an unsigned or signed decompression
-            // as we will always read the same number of bytes and we don't care about the values here
-            // as we're only calculating the number of records.
-            uint32_t delta_lines;
-            if (!decompress_u32(&blob, &blob_len, &delta_lines)) // DeltaLines
-                return UINT32_MAX;
-
-            uint32_t delta_columns;
-            if (!decompress_u32(&blob, &blob_len, &delta_columns)) // DeltaColumns
-                return UINT32_MAX;
-            if (delta_lines != 0 || delta_columns != 0)
-            {
-                uint32_t start_line;
-                if (!decompress_u32(&blob, &blob_len, &start_line)) // StartLine
-                    return UINT32_MAX;
-                uint32_t start_column;
-                if (!decompress_u32(&blob, &blob_len, &start_column)) // StartColumn
-                    return UINT32_MAX;
-            }
-        }
-
-        first_record = false;
+        return false;
     }
 
-    return num_records;
+    return document_rid == 0
+        || md_token_to_cursor(cxt, CreateTokenType(mdtid_Document) | document_rid, initial_document);
 }
 
+// We only support up to UINT32_MAX - 1 sequence points per method.
+// Technically, the number of supported sequence points in the spec is unbounded.
+// However, the PE format that an ECMA-335 blob is commonly wrapped in
+// can only support up to 4GB files, so we can't possibly have UINT32_MAX - 1 entries
+// in any existing scenario anyway.
 md_blob_parse_result_t md_parse_sequence_points(
     mdcursor_t method_debug_information,
     uint8_t const* blob,
@@ -158,63 +131,56 @@ md_blob_parse_result_t md_parse_sequence_points(
     if (blob == NULL || buffer_len == NULL)
         return mdbpr_InvalidArgument;
 
-    uint32_t num_records = get_num_sequence_points(method_debug_information, blob, blob_len);
-
-    if (num_records == UINT32_MAX)
+    // The blob is decoded in a single pass. Records are written while they fit
+    // in the buffer and are only counted after that, so the required size is known at the end.
+    if (sequence_points != NULL && *buffer_len < sizeof(md_sequence_points_t))
+        sequence_points = NULL;
+    size_t capacity = sequence_points != NULL
+        ? (*buffer_len - sizeof(md_sequence_points_t)) / sizeof(sequence_points->records[0])
+        : 0;
+
+    uint32_t signature;
+    mdcursor_t initial_document;
+    if (!read_sequence_points_header(method_debug_information, &blob, &blob_len, &signature, &initial_document))
         return mdbpr_InvalidBlob;
 
-    size_t required_size = sizeof(md_sequence_points_t) + num_records * sizeof(sequence_points->records[0]);
-    if (sequence_points == NULL || *buffer_len < required_size)
-    {
-        *buffer_len = required_size;
-        return mdbpr_InsufficientBuffer;
-    }
-
-    // header LocalSignature
-    if (!decompress_u32(&blob, &blob_len, &sequence_points->signature))
-        return mdbpr_InvalidBlob;
-
-    mdcursor_t document;
-    if (1 != md_get_column_value_as_cursor(method_debug_information, mdtMethodDebugInformation_Document, 1, &document))
-        return mdbpr_InvalidBlob;
-
-    // Create a "null" cursor to default-initialize the document field.
     mdcxt_t* cxt = extract_mdcxt(md_extract_handle_from_cursor(method_debug_information));
-    sequence_points->document = create_cursor(&cxt->tables[mdtid_Document], 0);
-
-    // header InitialDocument
-    uint32_t document_rid = 0;
-    if (CursorNull(&document)
-        && !decompress_u32(&blob, &blob_len, &document_rid))
-    {
-        return mdbpr_InvalidBlob;
-    }
 
-    if (document_rid != 0
-        && !md_token_to_cursor(cxt, CreateTokenType(mdtid_Document) | document_rid, &sequence_points->document))
+    if (sequence_points != NULL)
     {
-        return mdbpr_InvalidBlob;
+        sequence_points->signature = signature;
+        sequence_points->document = initial_document;
     }
 
     bool seen_non_hidden_sequence_point = false;
-    for (uint32_t i = 0; blob_len > 0 && i < num_records; ++i)
+    uint32_t num_records = 0;
+    for (; blob_len > 0; ++num_records)
     {
+        if (num_records == UINT32_MAX)
+            return mdbpr_InvalidBlob;
+
+        bool store = num_records < capacity;
         uint32_t il_offset;
         if (!decompress_u32(&blob, &blob_len, &il_offset)) // ILOffset
             return mdbpr_InvalidBlob;
 
         // Check if the method transitioned
         // into a new source file.
-        if (i != 0 && il_offset == 0)
+        if (num_records != 0 && il_offset == 0)
         {
             uint32_t document_row_id;
             if (!decompress_u32(&blob, &blob_len, &document_row_id)) // Document
                 return mdbpr_InvalidBlob;
 
-            sequence_points->records[i].kind = mdsp_DocumentRecord;
-            if (!md_token_to_cursor(cxt, CreateTokenType(mdtid_Document) | document_row_id, &sequence_points->records[i].document.document))
+            mdcursor_t record_document;
+            if (!md_token_to_cursor(cxt, CreateTokenType(mdtid_Document) | document_row_id, &record_document))
                 return mdbpr_InvalidBlob;
 
+            if (store)
+            {
+                sequence_points->records[num_records].kind = mdsp_DocumentRecord;
+                sequence_points->records[num_records].document.document = record_document;
+            }
             continue;
         }
 
@@ -241,8 +207,11 @@ md_blob_parse_result_t md_parse_sequence_points(
         // Check for hidden point
         if (delta_lines == 0 && delta_columns == 0)
         {
-            sequence_points->records[i].kind = mdsp_HiddenSequencePointRecord;
-            sequence_points->records[i].hidden_sequence_point.rolling_il_offset = il_offset;
+            if (store)
+            {
+                sequence_points->records[num_records].kind = mdsp_HiddenSequencePointRecord;
+                sequence_points->records[num_records].hidden_sequence_point.rolling_il_offset = il_offset;
+            }
             continue;
         }
 
@@ -275,21 +244,179 @@ md_blob_parse_result_t md_parse_sequence_points(
             start_column = start_column_raw;
         }
 
-        sequence_points->records[i].kind = mdsp_SequencePointRecord;
-        sequence_points->records[i].sequence_point.rolling_il_offset = il_offset;
-        sequence_points->records[i].sequence_point.delta_lines = delta_lines;
-        sequence_points->records[i].sequence_point.delta_columns = delta_columns;
-        sequence_points->records[i].sequence_point.rolling_start_line = start_line;
-        sequence_points->records[i].sequence_point.rolling_start_column = start_column;
+        if (store)
+        {
+            sequence_points->records[num_records].kind = mdsp_SequencePointRecord;
+            sequence_points->records[num_records].sequence_point.rolling_il_offset = il_offset;
+            sequence_points->records[num_records].sequence_point.delta_lines = delta_lines;
+            sequence_points->records[num_records].sequence_point.delta_columns = delta_columns;
+            sequence_points->records[num_records].sequence_point.rolling_start_line = start_line;
+            sequence_points->records[num_records].sequence_point.rolling_start_column = start_column;
+        }
     }
 
-    if (blob_len != 0)
-        return mdbpr_InvalidBlob;
+    size_t required_size = sizeof(md_sequence_points_t) + num_records * sizeof(sequence_points->records[0]);
+    if (sequence_points == NULL || num_records > capacity)
+    {
+        *buffer_len = required_size;
+        return mdbpr_InsufficientBuffer;
+    }
 
     sequence_points->record_count = num_records;
     return mdbpr_Success;
 }
 
+md_blob_parse_result_t md_init_sequence_point_reader(
+    mdcursor_t method_debug_information,
+    uint8_t const* blob,
+    size_t blob_len,
+    md_sequence_point_reader_t* reader)
+{
+    if (CursorNull(&method_debug_information) || CursorEnd(&method_debug_information))
+        return mdbpr_InvalidArgument;
+
+    if (blob == NULL || reader == NULL)
+        return mdbpr_InvalidArgument;
+
+    memset(reader, 0, sizeof(*reader));
+    if (!read_sequence_points_header(method_debug_information, &blob, &blob_len, &reader->signature, &reader->document))
+        return mdbpr_InvalidBlob;
+
+    // The blob only has an initial document if the row doesn't.
+    if (CursorNull(&reader->document)
+        && 1 != md_get_column_value_as_cursor(method_debug_information, mdtMethodDebugInformation_Document, 1, &reader->document))
+    {
+        return mdbpr_InvalidBlob;
+    }
+
+    reader->blob = blob;
+    reader->blob_len = blob_len;
+    reader->first_record = true;
+    return mdbpr_Success;
+}
+
+bool md_read_sequence_point(md_sequence_point_reader_t* reader, md_sequence_point_t* point)
+{
+    if (reader == NULL || point == NULL || reader->invalid)
+        return false;
+
+    while (reader->blob_len > 0)
+    {
+        // Stop on the first malformed record. Reading it again would yield the same result.
+        reader->invalid = true;
+
+        uint32_t il_offset;
+        if (!decompress_u32(&reader->blob, &reader->blob_len, &il_offset)) // ILOffset
+            return false;
+
+        // Document records switch the source file of the following records.
+        if (!reader->first_record && il_offset == 0)
+        {
+            uint32_t document_row_id;
+            if (!decompress_u32(&reader->blob, &reader->blob_len, &document_row_id)) // Document
+                return false;
+
+            mdcxt_t* cxt = extract_mdcxt(md_extract_handle_from_cursor(reader->document));
+            if (!md_token_to_cursor(cxt, CreateTokenType(mdtid_Document) | document_row_id, &reader->document))
+                return false;
+
+            reader->invalid = false;
+            continue;
+        }
+
+        // The offset of the first record is absolute and the others are deltas from the previous record.
+        if (!reader->first_record && il_offset > UINT32_MAX - reader->il_offset)
+            return false;
+        reader->il_offset = reader->first_record ? il_offset : reader->il_offset + il_offset;
+        reader->first_record = false;
+
+        uint32_t delta_lines;
+        if (!decompress_u32(&reader->blob, &reader->blob_len, &delta_lines)) // DeltaLines
+            return false;
+
+        int64_t delta_columns;
+        if (delta_lines == 0)
+        {
+            uint32_t raw_delta_columns;
+            if (!decompress_u32(&reader->blob, &reader->blob_len, &raw_delta_columns)) // DeltaColumns
+                return false;
+            delta_columns = raw_delta_columns;
+        }
+        else
+        {
+            int32_t raw_delta_columns;
+            if (!decompress_i32(&reader->blob, &reader->blob_len, &raw_delta_columns)) // DeltaColumns
+                return false;
+            delta_columns = raw_delta_columns;
+        }
+
+        point->il_offset = reader->il_offset;
+        point->document = reader->document;
+
+        // Check for hidden point
+        if (delta_lines == 0 && delta_columns == 0)
+        {
+            point->hidden = true;
+            point->start_line = MD_HIDDEN_SEQUENCE_POINT_LINE;
+            point->start_column = 0;
+            point->end_line = MD_HIDDEN_SEQUENCE_POINT_LINE;
+            point->end_column = 0;
+            reader->invalid = false;
+            return true;
+        }
+
+        // The start of the first non-hidden point is absolute and the others are
+        // signed deltas from the start of the previous non-hidden point.
+        int64_t start_line;
+        int64_t start_column;
+        if (!reader->seen_non_hidden)
+        {
+            uint32_t start_line_raw;
+            if (!decompress_u32(&reader->blob, &reader->blob_len, &start_line_raw)) // StartLine
+                return false;
+            uint32_t start_column_raw;
+            if (!decompress_u32(&reader->blob, &reader->blob_len, &start_column_raw)) // StartColumn
+                return false;
+            start_line = start_line_raw;
+            start_column = start_column_raw;
+        }
+        else
+        {
+            int32_t start_line_raw;
+            if (!decompress_i32(&reader->blob, &reader->blob_len, &start_line_raw)) // StartLine
+                return false;
+            int32_t start_column_raw;
+            if (!decompress_i32(&reader->blob, &reader->blob_len, &start_column_raw)) // StartColumn
+                return false;
+            start_line = (int64_t)reader->start_line + start_line_raw;
+            start_column = (int64_t)reader->start_column + start_column_raw;
+        }
+
+        int64_t end_line = start_line + delta_lines;
+        int64_t end_column = start_column + delta_columns;
+        if (start_line < 0 || end_line > UINT32_MAX
+            || start_column < 0 || start_column > UINT32_MAX
+            || end_column < 0 || end_column > UINT32_MAX)
+        {
+            return false;
+        }
+
+        reader->seen_non_hidden = true;
+        reader->start_line = (uint32_t)start_line;
+        reader->start_column = (uint32_t)start_column;
+
+        point->hidden = false;
+        point->start_line = (uint32_t)start_line;
+        point->start_column = (uint32_t)start_column;
+        point->end_line = (uint32_t)end_line;
+        point->end_column = (uint32_t)end_column;
+        reader->invalid = false;
+        return true;
+    }
+
+    return false;
+}
+
 md_blob_parse_result_t md_parse_local_constant_sig(mdhandle_t handle, uint8_t const* blob, size_t blob_len, md_local_constant_sig_t* local_constant_sig, size_t* buffer_len)
 {
     if (extract_mdcxt(handle) == NULL || blob == NULL || buffer_len == NULL)
@@ -0,0 +1,382 @@
+#include "internal.h"
+
+// PE envelope of a CLI image - II.25.
+// Headers are read through the byte stream functions so the image is never copied
+// and integers are read as little-endian on all hosts.
+
+// II.25.2.1 - 'MZ' and the offset of the PE signature.
+#define DOS_SIGNATURE 0x5A4D
+#define DOS_LFANEW_OFFSET 0x3c
+
+// II.25.2.1 - 'PE\0\0'
+#define PE_SIGNATURE 0x00004550
+
+// II.25.2.2 - Bytes between NumberOfSections and SizeOfOptionalHeader.
+#define FILE_HEADER_SKIPPED_SIZE 12
+
+// II.25.2.3 - Magic of the PE32 and PE32+ optional headers and the offset of NumberOfRvaAndSizes in each.
+#define PE32_MAGIC 0x10b
+#define PE32_PLUS_MAGIC 0x20b
+#define PE32_RVA_AND_SIZES_OFFSET 92
+#define PE32_PLUS_RVA_AND_SIZES_OFFSET 108
+#define DATA_DIRECTORY_SIZE 8
+#define CLI_HEADER_DIRECTORY 14
+
+// II.25.3
+#define SECTION_HEADER_SIZE 40
+#define SECTION_VIRTUAL_SIZE_OFFSET 8
+
+// II.25.3.3
+#define CLI_HEADER_SIZE 72
+
+struct mdpe__
+{
+    // The PE is shared by its opener and the handles created from it.
+    int32_t volatile refcount;
+    uint8_t const* image;
+    size_t image_len;
+    mdpe_layout_t layout;
+
+    // Data directories - II.25.2.3.3
+    uint8_t const* directories;
+    uint32_t directory_count;
+
+    // Section headers - II.25.3
+    uint8_t const* sections;
+    uint16_t section_count;
+
+    md_pe_info_t info;
+    uint32_t metadata_rva;
+    uint32_t metadata_size;
+};
+
+typedef struct section__
+{
+    uint32_t virtual_address;
+    uint32_t virtual_size;
+    uint32_t size_of_raw_data;
+    uint32_t pointer_to_raw_data;
+} section_t;
+
+static bool read_section(mdpe_t pe, uint16_t index, section_t* section)
+{
+    assert(index < pe->section_count);
+    uint8_t const* curr = pe->sections + (size_t)index * SECTION_HEADER_SIZE + SECTION_VIRTUAL_SIZE_OFFSET;
+    size_t curr_len = SECTION_HEADER_SIZE - SECTION_VIRTUAL_SIZE_OFFSET;
+    if (!read_u32(&curr, &curr_len, &section->virtual_size)
+        || !read_u32(&curr, &curr_len, &section->virtual_address)
+        || !read_u32(&curr, &curr_len, &section->size_of_raw_data)
+        || !read_u32(&curr, &curr_len, &section->pointer_to_raw_data))
+    {
+        return false;
+    }
+
+    // Some linkers leave the virtual size as zero.
+    if (section->virtual_size == 0)
+        section->virtual_size = section->size_of_raw_data;
+    return true;
+}
+
+static bool read_directory(mdpe_t pe, uint32_t index, uint32_t* rva, uint32_t* size)
+{
+    if (index >= pe->directory_count)
+    {
+        *rva = 0;
+        *size = 0;
+        return true;
+    }
+
+    uint8_t const* curr = pe->directories + (size_t)index * DATA_DIRECTORY_SIZE;
+    size_t curr_len = DATA_DIRECTORY_SIZE;
+    return read_u32(&curr, &curr_len, rva)
+        && read_u32(&curr, &curr_len, size);
+}
+
+static bool read_cli_header(mdpe_t pe)
+{
+    uint32_t rva;
+    uint32_t size;
+    if (!read_directory(pe, CLI_HEADER_DIRECTORY, &rva, &size))
+        return false;
+
+    if (rva == 0 && size == 0)
+        return true;
+
+    size_t available;
+    uint8_t const* curr = md_pe_rva_to_data(pe, rva, &available);
+    if (curr == NULL || available < CLI_HEADER_SIZE || size < CLI_HEADER_SIZE)
+        return false;
+
+    size_t curr_len = CLI_HEADER_SIZE;
+    uint32_t cb;
+    if (!read_u32(&curr, &curr_len, &cb)
+        || cb < CLI_HEADER_SIZE
+        || !read_u16(&curr, &curr_len, &pe->info.major_runtime_version)
+        || !read_u16(&curr, &curr_len, &pe->info.minor_runtime_version)
+        || !read_u32(&curr, &curr_len, &pe->metadata_rva)
+        || !read_u32(&curr, &curr_len, &pe->metadata_size)
+        || !read_u32(&curr, &curr_len, &pe->info.cli_flags)
+        || !read_u32(&curr, &curr_len, &pe->info.entry_point))
+    {
+        return false;
+    }
+
+    pe->info.has_cli_header = true;
+    return true;
+}
+
+bool md_pe_open(void const* image, size_t image_len, mdpe_layout_t layout, mdpe_t* pe)
+{
+    if (image == NULL || pe == NULL)
+        return false;
+
+    if (layout != mdpe_layout_flat && layout != mdpe_layout_mapped)
+        return false;
+
+    struct mdpe__ parsed;
+    memset(&parsed, 0, sizeof(parsed));
+    parsed.refcount = 1;
+    parsed.image = image;
+    parsed.image_len = image_len;
+    parsed.layout = layout;
+
+    // DOS header - II.25.2.1
+    uint8_t const* curr = image;
+    size_t curr_len = image_len;
+    uint16_t dos_signature;
+    uint32_t lfanew;
+    if (!read_u16(&curr, &curr_len, &dos_signature)
+        || dos_signature != DOS_SIGNATURE
+        || !advance_stream(&curr, &curr_len, DOS_LFANEW_OFFSET - sizeof(dos_signature))
+        || !read_u32(&curr, &curr_len, &lfanew))
+    {
+        return false;
+    }
+
+    if (lfanew > image_len)
+        return false;
+
+    // PE signature and file header - II.25.2.2
+    curr = parsed.image + lfanew;
+    curr_len = image_len - lfanew;
+    uint32_t pe_signature;
+    uint16_t optional_header_size;
+    if (!read_u32(&curr, &curr_len, &pe_signature)
+        || pe_signature != PE_SIGNATURE
+        || !read_u16(&curr, &curr_len, &parsed.info.machine)
+        || !read_u16(&curr, &curr_len, &parsed.section_count)
+        || !advance_stream(&curr, &curr_len, FILE_HEADER_SKIPPED_SIZE)
+        || !read_u16(&curr, &curr_len, &optional_header_size)
+        || !advance_stream(&curr, &curr_len, sizeof(uint16_t)))
+    {
+        return false;
+    }
+
+    // Optional header - II.25.2.3
+    // The section headers follow it, so they are found from its declared size.
+    uint8_t const* optional_header = curr;
+    size_t optional_header_len = optional_header_size;
+    if (!advance_stream(&curr, &curr_len, optional_header_size))
+        return false;
+
+    uint16_t magic;
+    if (!read_u16(&optional_header, &optional_header_len, &magic))
+        return false;
+
+    size_t rva_and_sizes_offset;
+    if (magic == PE32_MAGIC)
+    {
+        rva_and_sizes_offset = PE32_RVA_AND_SIZES_OFFSET;
+    }
+    else if (magic == PE32_PLUS_MAGIC)
+    {
+        parsed.info.is_pe32_plus = true;
+        rva_and_sizes_offset = PE32_PLUS_RVA_AND_SIZES_OFFSET;
+    }
+    else
+    {
+        return false;
+    }
+
+    // Only the directories the optional header has room for are used.
+    if (!advance_stream(&optional_header, &optional_header_len, rva_and_sizes_offset - sizeof(magic))
+        || !read_u32(&optional_header, &optional_header_len, &parsed.directory_count))
+    {
+        return false;
+    }
+    if (parsed.directory_count > optional_header_len / DATA_DIRECTORY_SIZE)
+        parsed.directory_count = (uint32_t)(optional_header_len / DATA_DIRECTORY_SIZE);
+    parsed.directories = optional_header;
+
+    // Section headers - II.25.3
+    if (parsed.section_count > curr_len / SECTION_HEADER_SIZE)
+        return false;
+    parsed.sections = curr;
+
+    // Sections are ordered by RVA, which permits them to be binary searched.
+    section_t prev = { 0 };
+    section_t section;
+    for (uint16_t i = 0; i < parsed.section_count; ++i)
+    {
+        if (!read_section(&parsed, i, &section))
+            return false;
+
+        if (i > 0 && section.virtual_address < (uint64_t)prev.virtual_address + prev.virtual_size)
+            return false;
+
+        if (layout == mdpe_layout_flat
+            && section.size_of_raw_data != 0
+            && section.pointer_to_raw_data > image_len)
+        {
+            return false;
+        }
+        prev = section;
+    }
+
+    // CLI header - II.25.3.3
+    if (!read_cli_header(&parsed))
+        return false;
+
+    mdpe_t result = (mdpe_t)malloc(sizeof(*result));
+    if (result == NULL)
+        return false;
+
+    memcpy(result, &parsed, sizeof(*result));
+    *pe = result;
+    return true;
+}
+
+void add_pe_ref(mdpe_t pe)
+{
+    assert(pe != NULL);
+    (void)atomic_increment(&pe->refcount);
+}
+
+void md_pe_close(mdpe_t pe)
+{
+    if (pe == NULL)
+        return;
+
+    if (atomic_decrement(&pe->refcount) == 0)
+        free(pe);
+}
+
+bool md_pe_get_info(mdpe_t pe, md_pe_info_t* info)
+{
+    if (pe == NULL || info == NULL)
+        return false;
+
+    *info = pe->info;
+    return true;
+}
+
+bool md_pe_get_directory(mdpe_t pe, uint32_t index, uint32_t* rva, uint32_t* size)
+{
+    if (pe == NULL || rva == NULL || size == NULL)
+        return false;
+
+    return read_directory(pe, index, rva, size);
+}
+
+uint8_t const* md_pe_rva_to_data(mdpe_t pe, uint32_t rva, size_t* available)
+{
+    if (pe == NULL || available == NULL)
+        return NULL;
+
+    // Find the last section that starts at or before the RVA.
+    section_t section;
+    uint16_t lo = 0;
+    uint16_t hi = pe->section_count;
+    while (lo < hi)
+    {
+        uint16_t mid = (uint16_t)(lo + (hi - lo) / 2);
+        if (!read_section(pe, mid, &section))
+            return NULL;
+
+        if (section.virtual_address <= rva)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == 0 || !read_section(pe, lo - 1, &section))
+        return NULL;
+
+    uint32_t delta = rva - section.virtual_address;
+    if (delta >= section.virtual_size)
+        return NULL;
+
+    size_t offset;
+    size_t section_len;
+    if (pe->layout == mdpe_layout_mapped)
+    {
+        offset = rva;
+        section_len = section.virtual_size - delta;
+    }
+    else
+    {
+        // Data past the raw data is zero-initialized by the loader and isn't in the file.
+        uint32_t raw_size = section.size_of_raw_data < section.virtual_size ? section.size_of_raw_data : section.virtual_size;
+        if (delta >= raw_size)
+            return NULL;
+
+        offset = (size_t)section.pointer_to_raw_data + delta;
+        section_len = raw_size - delta;
+    }
+
+    if (offset >= pe->image_len)
+        return NULL;
+
+    size_t image_remaining = pe->image_len - offset;
+    *available = section_len < image_remaining ? section_len : image_remaining;
+    return pe->image + offset;
+}
+
+bool md_pe_get_metadata(mdpe_t pe, void const** data, size_t* data_len)
+{
+    if (pe == NULL || data == NULL || data_len == NULL)
+        return false;
+
+    if (!pe->info.has_cli_header || pe->metadata_size == 0)
+        return false;
+
+    size_t available;
+    uint8_t const* metadata = md_pe_rva_to_data(pe, pe->metadata_rva, &available);
+    if (metadata == NULL || available < pe->metadata_size)
+        return false;
+
+    *data = metadata;
+    *data_len = pe->metadata_size;
+    return true;
+}
+
+bool md_create_handle_from_pe(mdpe_t pe, mdhandle_t* handle)
+{
+    if (handle == NULL)
+        return false;
+
+    void const* metadata;
+    size_t metadata_len;
+    if (!md_pe_get_metadata(pe, &metadata, &metadata_len))
+        return false;
+
+    mdhandle_t h;
+    if (!md_create_handle(metadata, metadata_len, &h))
+        return false;
+
+    mdcxt_t* cxt = extract_mdcxt(h);
+    assert(cxt != NULL && cxt->pe == NULL);
+    add_pe_ref(pe);
+    cxt->pe = pe;
+    *handle = h;
+    return true;
+}
+
+mdpe_t md_get_pe(mdhandle_t handle)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL)
+        return NULL;
+
+    return cxt->pe;
+}
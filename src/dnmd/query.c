@@ -124,6 +124,51 @@ bool md_walk_user_string_heap(mdhandle_t handle, mduserstringcursor_t* cursor, m
     return true;
 }
 
+bool md_get_row_raw(mdhandle_t handle, mdtable_id_t table_id, uint32_t row, uint8_t const** data)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || table_id < mdtid_First || table_id >= mdtid_End || data == NULL)
+        return false;
+
+    mdtable_t const* table = &cxt->tables[table_id];
+    if (row == 0 || row > table->row_count)
+        return false;
+
+    *data = get_table_row_data(table, row - 1);
+    return true;
+}
+
+bool md_get_heap(mdhandle_t handle, md_heap_id_t heap_id, uint8_t const** data, uint32_t* size)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || data == NULL || size == NULL)
+        return false;
+
+    mdtcol_t heap;
+    switch (heap_id)
+    {
+    case mdhid_String:
+        heap = mdtc_hstring;
+        break;
+    case mdhid_Guid:
+        heap = mdtc_hguid;
+        break;
+    case mdhid_Blob:
+        heap = mdtc_hblob;
+        break;
+    case mdhid_UserString:
+        heap = mdtc_hus;
+        break;
+    default:
+        return false;
+    }
+
+    mdstream_t const* h = get_heap_by_id(cxt, heap);
+    *data = h->ptr;
+    *size = (uint32_t)h->size;
+    return true;
+}
+
 static int32_t get_column_value_as_token_or_cursor(mdcursor_t* c, uint32_t col_idx, uint32_t out_length, mdToken* tk, mdcursor_t* cursor)
 {
     assert(c != NULL && out_length != 0 && (tk != NULL || cursor != NULL));
@@ -551,7 +596,7 @@ static void const* cursor_to_row_bytes(mdcursor_t* c)
 {
     assert(c != NULL && (CursorRow(c) > 0));
     // Indices into tables begin at 1 - see II.22.
-    return &CursorTable(c)->data.ptr[(CursorRow(c) - 1) * CursorTable(c)->row_size_bytes];
+    return get_table_row_data(CursorTable(c), CursorRow(c) - 1);
 }
 
 static bool find_row_from_cursor(mdcursor_t begin, col_index_t idx, uint32_t* value, mdcursor_t* cursor)
@@ -576,27 +621,21 @@ static bool find_row_from_cursor(mdcursor_t begin, col_index_t idx, uint32_t* va
             return false;
     }
 
-    // Compute the starting row.
-    void const* starting_row = cursor_to_row_bytes(&begin);
     // Add +1 for inclusive count - use binary search if sorted, otherwise linear.
-    void const* row_maybe = (table->is_sorted && !table->is_adding_new_row)
+    uint32_t row_count = (table->row_count - first_row) + 1;
+    uint32_t found_row;
+    bool found = (table->is_sorted && !table->is_adding_new_row)
         ? ((fcxt.data_len == 2)
-            ? md_bsearch_2bytes(value, starting_row, (table->row_count - first_row) + 1, table->row_size_bytes, &fcxt)
-            : md_bsearch_4bytes(value, starting_row, (table->row_count - first_row) + 1, table->row_size_bytes, &fcxt))
+            ? mdtable_bsearch_2bytes(value, table, first_row - 1, row_count, &fcxt, &found_row)
+            : mdtable_bsearch_4bytes(value, table, first_row - 1, row_count, &fcxt, &found_row))
         : ((fcxt.data_len == 2)
-            ? md_lsearch_2bytes(value, starting_row, (table->row_count - first_row) + 1, table->row_size_bytes, &fcxt)
-            : md_lsearch_4bytes(value, starting_row, (table->row_count - first_row) + 1, table->row_size_bytes, &fcxt));
-    if (row_maybe == NULL)
+            ? mdtable_lsearch_2bytes(value, table, first_row - 1, row_count, &fcxt, &found_row)
+            : mdtable_lsearch_4bytes(value, table, first_row - 1, row_count, &fcxt, &found_row));
+    if (!found)
         return false;
 
-    // Compute the found row.
     // Indices into tables begin at 1 - see II.22.
-    assert(starting_row <= row_maybe);
-    uint32_t row = (uint32_t)(((intptr_t)row_maybe - (intptr_t)starting_row) / table->row_size_bytes) + 1;
-    if (row > table->row_count)
-        return false;
-
-    *cursor = create_cursor(table, row);
+    *cursor = create_cursor(table, found_row + 1);
     return true;
 }
 
@@ -670,6 +709,85 @@ md_range_result_t md_find_range_from_cursor(mdcursor_t begin, col_index_t idx, u
     return MD_RANGE_FOUND;
 }
 
+int32_t md_scan_column_equals(mdcursor_t* c, col_index_t idx, uint32_t value, uint32_t out_length, mdcursor_t* matches)
+{
+    if (c == NULL || (out_length != 0 && matches == NULL))
+        return -1;
+
+    mdtable_t* table = CursorTable(c);
+    if (table == NULL)
+        return -1;
+
+    // Indices into tables begin at 1 - see II.22.
+    uint32_t row = CursorRow(c);
+    if (row == 0 || row > table->row_count + 1)
+        return -1;
+
+    find_cxt_t fcxt;
+    if (!create_find_context(table, idx, &fcxt))
+        return -1;
+
+    if (out_length == 0)
+        return 0;
+
+    // Compose the value into the form stored in the column.
+    uint32_t raw = value;
+    bool can_match = true;
+    if (fcxt.col_details & mdtc_idx_coded)
+    {
+        can_match = compose_coded_index(value, fcxt.col_details, &raw);
+    }
+    else if (fcxt.col_details & mdtc_idx_table)
+    {
+        can_match = ExtractTokenType(value) == ExtractTable(fcxt.col_details);
+        raw = RidFromToken(value);
+    }
+
+    if (fcxt.data_len == 2 && raw > UINT16_MAX)
+        can_match = false;
+
+    if (!can_match)
+    {
+        *c = create_cursor(table, table->row_count + 1);
+        return 0;
+    }
+
+    // Lay the key out as it is stored in the table so rows can be compared bytewise.
+    uint8_t key[sizeof(uint32_t)];
+    for (uint32_t i = 0; i < fcxt.data_len; ++i)
+        key[i] = (uint8_t)(raw >> (i * 8));
+
+    uint32_t found = 0;
+    uint32_t row_index = row - 1;
+    size_t const stride = table->row_size_bytes;
+    while (row_index < table->row_count && found < out_length)
+    {
+        // Walk the rows that are stored contiguously with a fixed stride.
+        uint32_t end = get_table_contiguous_rows_end(table, row_index);
+        uint8_t const* col_data = get_table_row_data(table, row_index) + fcxt.col_offset;
+        if (fcxt.data_len == 2)
+        {
+            for (; row_index < end && found < out_length; ++row_index, col_data += stride)
+            {
+                if (col_data[0] == key[0] && col_data[1] == key[1])
+                    matches[found++] = create_cursor(table, row_index + 1);
+            }
+        }
+        else
+        {
+            for (; row_index < end && found < out_length; ++row_index, col_data += stride)
+            {
+                if (memcmp(col_data, key, sizeof(key)) == 0)
+                    matches[found++] = create_cursor(table, row_index + 1);
+            }
+        }
+    }
+
+    // Indices into tables begin at 1 - see II.22.
+    *c = create_cursor(table, row_index + 1);
+    return (int32_t)found;
+}
+
 #ifdef DNMD_DEBUG_FIND_TOKEN_OF_RANGE_ELEMENT
 // This function is used to validate the mapping logic between
 // md_find_token_of_range_element() and md_get_column_value_as_range().
@@ -0,0 +1,322 @@
+#include "internal.h"
+
+// Hash indexes of the TypeRef and AssemblyRef tables - see md_find_type_ref() and md_find_assembly_refs().
+
+#define MIN_REF_INDEX_CAPACITY 16
+
+typedef struct ref_bucket__
+{
+    uint32_t first; // Row id of the first row in the bucket, or 0 if the bucket is empty.
+    uint32_t last;
+} ref_bucket_t;
+
+typedef struct ref_row__
+{
+    uint32_t hash;
+    uint32_t next; // Row id of the next row in the same bucket, or 0.
+} ref_row_t;
+
+// Rows are chained in row order in buckets keyed by the hash of their key columns.
+// Rows added to the end of the table are indexed when they are committed, so references can be
+// added and found in turn without rebuilding the index. Any other edit to the table releases it.
+struct mdref_index__
+{
+    uint32_t row_count;
+    uint32_t row_capacity;
+    uint32_t bucket_mask;
+    ref_bucket_t* buckets;
+    ref_row_t* rows; // Indexed by row id - 1.
+};
+
+// The columns that identify a row of an indexed table.
+typedef struct ref_key__
+{
+    mdToken resolution_scope; // TypeRef resolution scope, nil for AssemblyRef rows.
+    char const* first; // TypeRef namespace or AssemblyRef name.
+    char const* second; // TypeRef name or AssemblyRef culture.
+} ref_key_t;
+
+static mdref_index_t* volatile* get_ref_index_slot(mdcxt_t* cxt, mdtable_id_t table_id)
+{
+    switch (table_id)
+    {
+    case mdtid_TypeRef:
+        return &cxt->type_ref_index;
+    case mdtid_AssemblyRef:
+        return &cxt->assembly_ref_index;
+    default:
+        return NULL;
+    }
+}
+
+static void free_ref_index(mdref_index_t* index)
+{
+    if (index == NULL)
+        return;
+    free(index->buckets);
+    free(index->rows);
+    free(index);
+}
+
+void free_ref_indexes(mdcxt_t* cxt)
+{
+    assert(cxt != NULL);
+    free_ref_index(cxt->type_ref_index);
+    cxt->type_ref_index = NULL;
+    free_ref_index(cxt->assembly_ref_index);
+    cxt->assembly_ref_index = NULL;
+}
+
+static void release_ref_index(mdcxt_t* cxt, mdtable_id_t table_id)
+{
+    mdref_index_t* volatile* slot = get_ref_index_slot(cxt, table_id);
+    if (slot == NULL)
+        return;
+
+    free_ref_index(*slot);
+    *slot = NULL;
+}
+
+static bool get_row_key(mdcursor_t row, ref_key_t* key)
+{
+    switch (CursorTable(&row)->table_id)
+    {
+    case mdtid_TypeRef:
+        return 1 == md_get_column_value_as_token(row, mdtTypeRef_ResolutionScope, 1, &key->resolution_scope)
+            && 1 == md_get_column_value_as_utf8(row, mdtTypeRef_TypeNamespace, 1, &key->first)
+            && 1 == md_get_column_value_as_utf8(row, mdtTypeRef_TypeName, 1, &key->second);
+    case mdtid_AssemblyRef:
+        key->resolution_scope = mdTokenNil;
+        return 1 == md_get_column_value_as_utf8(row, mdtAssemblyRef_Name, 1, &key->first)
+            && 1 == md_get_column_value_as_utf8(row, mdtAssemblyRef_Culture, 1, &key->second);
+    default:
+        assert(!"Unsupported table");
+        return false;
+    }
+}
+
+// FNV-1a
+static uint32_t hash_bytes(uint32_t hash, uint8_t const* data, size_t len)
+{
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t hash_key(ref_key_t const* key)
+{
+    uint32_t hash = hash_bytes(2166136261u, (uint8_t const*)&key->resolution_scope, sizeof(key->resolution_scope));
+    // Include the null terminators so the boundary between the strings is part of the hash.
+    hash = hash_bytes(hash, (uint8_t const*)key->first, strlen(key->first) + 1);
+    return hash_bytes(hash, (uint8_t const*)key->second, strlen(key->second) + 1);
+}
+
+static bool keys_equal(ref_key_t const* lhs, ref_key_t const* rhs)
+{
+    return lhs->resolution_scope == rhs->resolution_scope
+        && strcmp(lhs->first, rhs->first) == 0
+        && strcmp(lhs->second, rhs->second) == 0;
+}
+
+static void link_row(mdref_index_t* index, uint32_t row_id)
+{
+    ref_row_t* row = &index->rows[row_id - 1];
+    ref_bucket_t* bucket = &index->buckets[row->hash & index->bucket_mask];
+    row->next = 0;
+    if (bucket->first == 0)
+        bucket->first = row_id;
+    else
+        index->rows[bucket->last - 1].next = row_id;
+    bucket->last = row_id;
+}
+
+static bool add_row(mdref_index_t* index, uint32_t hash)
+{
+    if (index->row_count == index->row_capacity)
+    {
+        if (index->row_capacity > (UINT32_MAX / 2) / sizeof(ref_row_t))
+            return false;
+
+        uint32_t row_capacity = index->row_capacity * 2;
+        ref_row_t* rows = (ref_row_t*)realloc(index->rows, row_capacity * sizeof(ref_row_t));
+        if (rows == NULL)
+            return false;
+
+        // Keep at most one row per bucket on average.
+        ref_bucket_t* buckets = (ref_bucket_t*)calloc(row_capacity, sizeof(ref_bucket_t));
+        if (buckets == NULL)
+        {
+            index->rows = rows;
+            return false;
+        }
+
+        free(index->buckets);
+        index->buckets = buckets;
+        index->bucket_mask = row_capacity - 1;
+        index->rows = rows;
+        index->row_capacity = row_capacity;
+        for (uint32_t row_id = 1; row_id <= index->row_count; ++row_id)
+            link_row(index, row_id);
+    }
+
+    uint32_t row_id = ++index->row_count;
+    index->rows[row_id - 1].hash = hash;
+    link_row(index, row_id);
+    return true;
+}
+
+static mdref_index_t* create_ref_index(mdtable_t* table)
+{
+    uint32_t row_capacity = MIN_REF_INDEX_CAPACITY;
+    while (row_capacity < table->row_count)
+    {
+        if (row_capacity > (UINT32_MAX / 2) / sizeof(ref_row_t))
+            return NULL;
+        row_capacity <<= 1;
+    }
+
+    mdref_index_t* index = (mdref_index_t*)calloc(1, sizeof(mdref_index_t));
+    if (index == NULL)
+        return NULL;
+
+    index->row_capacity = row_capacity;
+    index->bucket_mask = row_capacity - 1;
+    index->buckets = (ref_bucket_t*)calloc(row_capacity, sizeof(ref_bucket_t));
+    index->rows = (ref_row_t*)malloc(row_capacity * sizeof(ref_row_t));
+    if (index->buckets == NULL || index->rows == NULL)
+    {
+        free_ref_index(index);
+        return NULL;
+    }
+
+    mdcursor_t row = create_cursor(table, 1);
+    for (uint32_t i = 0; i < table->row_count; ++i, (void)md_cursor_next(&row))
+    {
+        ref_key_t key;
+        if (!get_row_key(row, &key) || !add_row(index, hash_key(&key)))
+        {
+            free_ref_index(index);
+            return NULL;
+        }
+    }
+    return index;
+}
+
+static mdref_index_t* get_ref_index(mdcxt_t* cxt, mdtable_id_t table_id)
+{
+    mdref_index_t* volatile* slot = get_ref_index_slot(cxt, table_id);
+    assert(slot != NULL);
+    mdref_index_t* index = (mdref_index_t*)atomic_load_ptr((void* volatile*)slot);
+    if (index != NULL)
+        return index;
+
+    mdref_index_t* new_index = create_ref_index(&cxt->tables[table_id]);
+    if (new_index == NULL)
+        return NULL;
+
+    if (atomic_publish_ptr((void* volatile*)slot, new_index))
+        return new_index;
+
+    // Another thread published an index first.
+    free_ref_index(new_index);
+    return (mdref_index_t*)atomic_load_ptr((void* volatile*)slot);
+}
+
+static void add_found_row(mdcursor_t row, uint32_t* found, uint32_t out_length, mdcursor_t* rows)
+{
+    if (*found < out_length)
+        rows[*found] = row;
+    ++*found;
+}
+
+// Find the rows of an indexed table with the key, in row order.
+static int32_t find_rows(mdcxt_t* cxt, mdtable_id_t table_id, ref_key_t const* key, uint32_t out_length, mdcursor_t* rows)
+{
+    mdtable_t* table = &cxt->tables[table_id];
+    if (table->cxt == NULL)
+        return 0;
+
+    uint32_t found = 0;
+    ref_key_t row_key;
+
+    // A row that is being added may not be fully initialized, so the table is
+    // only indexed once the row is committed. Until then, the table is scanned.
+    mdref_index_t* index = table->is_adding_new_row ? NULL : get_ref_index(cxt, table_id);
+    if (index == NULL)
+    {
+        mdcursor_t row = create_cursor(table, 1);
+        for (uint32_t i = 0; i < table->row_count; ++i, (void)md_cursor_next(&row))
+        {
+            if (get_row_key(row, &row_key) && keys_equal(key, &row_key))
+                add_found_row(row, &found, out_length, rows);
+        }
+    }
+    else
+    {
+        uint32_t hash = hash_key(key);
+        for (uint32_t row_id = index->buckets[hash & index->bucket_mask].first; row_id != 0; row_id = index->rows[row_id - 1].next)
+        {
+            if (index->rows[row_id - 1].hash != hash)
+                continue;
+
+            mdcursor_t row = create_cursor(table, row_id);
+            if (get_row_key(row, &row_key) && keys_equal(key, &row_key))
+                add_found_row(row, &found, out_length, rows);
+        }
+    }
+
+    return found > INT32_MAX ? INT32_MAX : (int32_t)found;
+}
+
+void update_ref_index_for_edited_row(mdtable_t* table, uint32_t row_index)
+{
+    assert(table != NULL && table->cxt != NULL);
+
+    // The row being added to the end of the table is indexed when it is committed.
+    if (table->is_adding_new_row && row_index == table->row_count - 1)
+        return;
+
+    release_ref_index(table->cxt, (mdtable_id_t)table->table_id);
+}
+
+void update_ref_index_for_committed_row(mdcursor_t row)
+{
+    mdtable_t* table = CursorTable(&row);
+    mdref_index_t* volatile* slot = get_ref_index_slot(table->cxt, (mdtable_id_t)table->table_id);
+    if (slot == NULL || *slot == NULL)
+        return;
+
+    // Only rows added to the end of the table can be added to the index.
+    mdref_index_t* index = *slot;
+    ref_key_t key;
+    if (CursorRow(&row) != table->row_count
+        || index->row_count != table->row_count - 1
+        || !get_row_key(row, &key)
+        || !add_row(index, hash_key(&key)))
+    {
+        release_ref_index(table->cxt, (mdtable_id_t)table->table_id);
+    }
+}
+
+bool md_find_type_ref(mdhandle_t handle, mdToken resolution_scope, char const* type_namespace, char const* type_name, mdcursor_t* type_ref)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || type_namespace == NULL || type_name == NULL || type_ref == NULL)
+        return false;
+
+    ref_key_t key = { resolution_scope, type_namespace, type_name };
+    return find_rows(cxt, mdtid_TypeRef, &key, 1, type_ref) > 0;
+}
+
+int32_t md_find_assembly_refs(mdhandle_t handle, char const* name, char const* culture, uint32_t out_length, mdcursor_t* assembly_refs)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || name == NULL || culture == NULL || (out_length != 0 && assembly_refs == NULL))
+        return -1;
+
+    ref_key_t key = { mdTokenNil, name, culture };
+    return find_rows(cxt, mdtid_AssemblyRef, &key, out_length, assembly_refs);
+}
@@ -10,23 +10,27 @@
 #error Must define SEARCH_FUNC_NAME(name) macro
 #endif // SEARCH_FUNC_NAME
 
-// Since MSVC doesn't have a C11 compatible bsearch_s, defining one below.
-// Ideally we would use the one in the standard so the signature is designed
-// to match what should eventually exist.
-static void const* SEARCH_FUNC_NAME(md_bsearch)(
+// Binary search the rows [first_row, first_row + count) of the table, using 0-based row indices.
+// Rows are addressed through the table so tables edited in place can be searched.
+// Returns true and the index of a matching row if one is found.
+static bool SEARCH_FUNC_NAME(mdtable_bsearch)(
     void const* key,
-    void const* base,
-    rsize_t count,
-    rsize_t element_size,
-    void* cxt)
+    mdtable_t* table,
+    uint32_t first_row,
+    uint32_t count,
+    find_cxt_t* fcxt,
+    uint32_t* found_row)
 {
-    assert(key != NULL && base != NULL);
+    assert(key != NULL && table != NULL && found_row != NULL);
     while (count > 0)
     {
-        void const* row = (uint8_t const*)base + (element_size * (count / 2));
-        int32_t res = SEARCH_COMPARE(key, row, cxt);
+        uint32_t row = first_row + (count / 2);
+        int32_t res = SEARCH_COMPARE(key, get_table_row_data(table, row), fcxt);
         if (res == 0)
-            return row;
+        {
+            *found_row = row;
+            return true;
+        }
 
         if (count == 1)
         {
@@ -38,32 +42,32 @@ static void const* SEARCH_FUNC_NAME(md_bsearch)(
         }
         else
         {
-            base = row;
+            first_row = row;
             count -= count / 2;
         }
     }
-    return NULL;
+    return false;
 }
 
-static void const* SEARCH_FUNC_NAME(md_lsearch)(
+static bool SEARCH_FUNC_NAME(mdtable_lsearch)(
     void const* key,
-    void const* base,
-    rsize_t count,
-    rsize_t element_size,
-    void* cxt)
+    mdtable_t* table,
+    uint32_t first_row,
+    uint32_t count,
+    find_cxt_t* fcxt,
+    uint32_t* found_row)
 {
-    assert(key != NULL && base != NULL);
-    void const* row = base;
-    for (rsize_t i = 0; i < count; ++i)
+    assert(key != NULL && table != NULL && found_row != NULL);
+    for (uint32_t row = first_row; row < first_row + count; ++row)
     {
-        int32_t res = SEARCH_COMPARE(key, row, cxt);
+        int32_t res = SEARCH_COMPARE(key, get_table_row_data(table, row), fcxt);
         if (res == 0)
-            return row;
-
-        // Onto the next row.
-        row = (uint8_t const*)row + element_size;
+        {
+            *found_row = row;
+            return true;
+        }
     }
-    return NULL;
+    return false;
 }
 
 // Modeled after C11's bsearch_s. This API performs a binary search
@@ -76,16 +80,15 @@ static int32_t SEARCH_FUNC_NAME(mdtable_bsearch_closest)(
     uint32_t* found_row)
 {
     assert(table != NULL && found_row != NULL);
-    void const* base = table->data.ptr;
-    rsize_t count = table->row_count;
-    rsize_t element_size = table->row_size_bytes;
+    uint32_t first_row = 0;
+    uint32_t count = table->row_count;
 
     int32_t res = 0;
-    void const* row = base;
+    uint32_t row = first_row;
     while (count > 0)
     {
-        row = (uint8_t const*)base + (element_size * (count / 2));
-        res = SEARCH_COMPARE(key, row, fcxt);
+        row = first_row + (count / 2);
+        res = SEARCH_COMPARE(key, get_table_row_data(table, row), fcxt);
         if (res == 0 || count == 1)
             break;
 
@@ -95,14 +98,14 @@ static int32_t SEARCH_FUNC_NAME(mdtable_bsearch_closest)(
         }
         else
         {
-            base = row;
+            first_row = row;
             count -= count / 2;
         }
     }
 
     // Compute the found row.
     // Indices into tables begin at 1 - see II.22.
-    *found_row = (uint32_t)(((intptr_t)row - (intptr_t)table->data.ptr) / element_size) + 1;
+    *found_row = row + 1;
     return res;
 }
 
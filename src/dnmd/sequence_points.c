@@ -0,0 +1,474 @@
+#include "internal.h"
+
+// Sequence point lookup for Portable PDB MethodDebugInformation rows.
+
+// The non-hidden sequence points of a method with absolute values.
+// Offsets in the blob only increase, so the points are sorted by IL offset.
+typedef struct method_sequence_points__
+{
+    uint32_t method_rid;
+    uint32_t count;
+    md_sequence_point_t points[];
+} method_sequence_points_t;
+
+// Stack traces symbolize the same few methods repeatedly, so only a small number of methods are kept.
+// A method is kept in the slot of its row number, replacing the method that was there.
+#define SEQUENCE_POINT_CACHE_SIZE 32
+
+// A reader takes the method out of its slot while it is used and puts it back after,
+// so a method is never freed while another thread uses it.
+struct mdseqpt_cache__
+{
+    method_sequence_points_t* volatile methods[SEQUENCE_POINT_CACHE_SIZE];
+};
+
+// The line range of the sequence points of a method in one document.
+typedef struct method_line_range__
+{
+    uint32_t document_rid;
+    uint32_t method_rid;
+    uint32_t min_line;
+    uint32_t max_line;
+} method_line_range_t;
+
+// Line ranges grouped by document and sorted by their first line.
+// The ranges of document N are [document_offsets[N - 1], document_offsets[N]).
+struct mddocline_index__
+{
+    uint32_t document_count;
+    uint32_t* document_offsets;
+    method_line_range_t* ranges;
+    // The largest max_line of the ranges up to and including the same index in the document.
+    // It only increases, so the first range that can contain a line is found by binary search.
+    uint32_t* max_line_so_far;
+};
+
+static void free_document_line_index(mddocline_index_t* index)
+{
+    if (index == NULL)
+        return;
+
+    free(index->document_offsets);
+    free(index->ranges);
+    free(index->max_line_so_far);
+    free(index);
+}
+
+void free_sequence_point_indexes(mdcxt_t* cxt)
+{
+    assert(cxt != NULL);
+    free_document_line_index(cxt->document_line_index);
+    cxt->document_line_index = NULL;
+
+    mdseqpt_cache_t* cache = cxt->sequence_point_cache;
+    if (cache == NULL)
+        return;
+
+    for (uint32_t i = 0; i < SEQUENCE_POINT_CACHE_SIZE; ++i)
+        free(cache->methods[i]);
+    free(cache);
+    cxt->sequence_point_cache = NULL;
+}
+
+static mdseqpt_cache_t* get_sequence_point_cache(mdcxt_t* cxt)
+{
+    mdseqpt_cache_t* cache = (mdseqpt_cache_t*)atomic_load_ptr((void* volatile*)&cxt->sequence_point_cache);
+    if (cache != NULL)
+        return cache;
+
+    mdseqpt_cache_t* new_cache = (mdseqpt_cache_t*)calloc(1, sizeof(mdseqpt_cache_t));
+    if (new_cache == NULL)
+        return NULL;
+
+    if (atomic_publish_ptr((void* volatile*)&cxt->sequence_point_cache, new_cache))
+        return new_cache;
+
+    // Another thread published a cache first.
+    free(new_cache);
+    return (mdseqpt_cache_t*)atomic_load_ptr((void* volatile*)&cxt->sequence_point_cache);
+}
+
+// The smallest encoding of a non-hidden sequence point record is five one-byte compressed integers.
+#define MIN_SEQUENCE_POINT_RECORD_SIZE 5
+
+static method_sequence_points_t* decode_sequence_points(mdcursor_t method_debug_information, uint32_t method_rid)
+{
+    uint8_t const* blob;
+    uint32_t blob_len;
+    if (1 != md_get_column_value_as_blob(method_debug_information, mdtMethodDebugInformation_SequencePoints, 1, &blob, &blob_len))
+        return NULL;
+
+    // Size the table for the most points the blob could hold, so it is decoded in one pass.
+    size_t max_count = blob_len / MIN_SEQUENCE_POINT_RECORD_SIZE;
+    method_sequence_points_t* method = (method_sequence_points_t*)malloc(sizeof(method_sequence_points_t) + max_count * sizeof(md_sequence_point_t));
+    if (method == NULL)
+        return NULL;
+
+    method->method_rid = method_rid;
+    method->count = 0;
+
+    // Methods without sequence points have an empty blob.
+    if (blob_len == 0)
+        return method;
+
+    md_sequence_point_reader_t reader;
+    if (md_init_sequence_point_reader(method_debug_information, blob, blob_len, &reader) != mdbpr_Success)
+    {
+        free(method);
+        return NULL;
+    }
+
+    md_sequence_point_t point;
+    while (md_read_sequence_point(&reader, &point))
+    {
+        if (point.hidden)
+            continue;
+
+        assert(method->count < max_count);
+        method->points[method->count++] = point;
+    }
+
+    if (reader.invalid)
+    {
+        free(method);
+        return NULL;
+    }
+
+    return method;
+}
+
+static bool find_in_method(method_sequence_points_t const* method, uint32_t il_offset, md_sequence_point_t* point)
+{
+    // Find the first point after the offset. The point before it is the one that covers the offset.
+    uint32_t lo = 0;
+    uint32_t hi = method->count;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (method->points[mid].il_offset <= il_offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == 0)
+        return false;
+
+    *point = method->points[lo - 1];
+    return true;
+}
+
+bool md_find_sequence_point(mdhandle_t handle, mdToken method_def, uint32_t il_offset, md_sequence_point_t* point)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || point == NULL)
+        return false;
+
+    if (ExtractTokenType(method_def) != mdtid_MethodDef)
+        return false;
+
+    // MethodDebugInformation rows correspond one-to-one with MethodDef rows.
+    uint32_t rid = RidFromToken(method_def);
+    mdcursor_t method_debug_information;
+    if (!md_token_to_cursor(handle, TokenFromRid(rid, CreateTokenType(mdtid_MethodDebugInformation)), &method_debug_information))
+        return false;
+
+    mdseqpt_cache_t* cache = get_sequence_point_cache(cxt);
+    if (cache == NULL)
+        return false;
+
+    method_sequence_points_t* volatile* slot = &cache->methods[rid % SEQUENCE_POINT_CACHE_SIZE];
+    method_sequence_points_t* method = (method_sequence_points_t*)atomic_take_ptr((void* volatile*)slot);
+    if (method == NULL || method->method_rid != rid)
+    {
+        free(method);
+        method = decode_sequence_points(method_debug_information, rid);
+        if (method == NULL)
+            return false;
+    }
+
+    bool found = find_in_method(method, il_offset, point);
+
+    // Put the method back, unless another thread filled the slot while it was out.
+    if (!atomic_publish_ptr((void* volatile*)slot, method))
+        free(method);
+
+    return found;
+}
+
+// MethodDebugInformation rows are split into chunks that are decoded in parallel.
+#define LINE_INDEX_CHUNK_ROWS 256
+#define LINE_INDEX_ROWS_PER_WORKER 2048
+
+typedef struct line_index_chunk__
+{
+    mdcxt_t* cxt;
+    uint32_t first_rid;
+    uint32_t row_count;
+    bool failed;
+    uint32_t range_count;
+    uint32_t range_capacity;
+    method_line_range_t* ranges;
+} line_index_chunk_t;
+
+static bool add_point_to_ranges(line_index_chunk_t* chunk, uint32_t method_first_range, uint32_t method_rid, md_sequence_point_t const* point)
+{
+    mdToken document;
+    if (!md_cursor_to_token(point->document, &document))
+        return false;
+
+    // Methods rarely span more than one or two documents, so the ranges of the method are searched linearly.
+    uint32_t document_rid = RidFromToken(document);
+    for (uint32_t i = method_first_range; i < chunk->range_count; ++i)
+    {
+        method_line_range_t* range = &chunk->ranges[i];
+        if (range->document_rid != document_rid)
+            continue;
+        if (point->start_line < range->min_line)
+            range->min_line = point->start_line;
+        if (point->end_line > range->max_line)
+            range->max_line = point->end_line;
+        return true;
+    }
+
+    if (chunk->range_count == chunk->range_capacity)
+    {
+        uint32_t new_capacity = chunk->range_capacity == 0 ? LINE_INDEX_CHUNK_ROWS : chunk->range_capacity * 2;
+        method_line_range_t* new_ranges = (method_line_range_t*)realloc(chunk->ranges, new_capacity * sizeof(method_line_range_t));
+        if (new_ranges == NULL)
+            return false;
+        chunk->ranges = new_ranges;
+        chunk->range_capacity = new_capacity;
+    }
+
+    chunk->ranges[chunk->range_count++] = (method_line_range_t){ document_rid, method_rid, point->start_line, point->end_line };
+    return true;
+}
+
+static void build_line_index_chunk(void* arg, size_t index)
+{
+    line_index_chunk_t* chunk = &((line_index_chunk_t*)arg)[index];
+    mdcursor_t cursor;
+    if (!md_token_to_cursor(chunk->cxt, TokenFromRid(chunk->first_rid, CreateTokenType(mdtid_MethodDebugInformation)), &cursor))
+    {
+        chunk->failed = true;
+        return;
+    }
+
+    for (uint32_t i = 0; i < chunk->row_count; ++i, (void)md_cursor_next(&cursor))
+    {
+        uint8_t const* blob;
+        uint32_t blob_len;
+        if (1 != md_get_column_value_as_blob(cursor, mdtMethodDebugInformation_SequencePoints, 1, &blob, &blob_len))
+        {
+            chunk->failed = true;
+            return;
+        }
+
+        if (blob_len == 0)
+            continue;
+
+        md_sequence_point_reader_t reader;
+        if (md_init_sequence_point_reader(cursor, blob, blob_len, &reader) != mdbpr_Success)
+        {
+            chunk->failed = true;
+            return;
+        }
+
+        uint32_t method_rid = chunk->first_rid + i;
+        uint32_t method_first_range = chunk->range_count;
+        md_sequence_point_t point;
+        while (md_read_sequence_point(&reader, &point))
+        {
+            if (!point.hidden && !add_point_to_ranges(chunk, method_first_range, method_rid, &point))
+            {
+                chunk->failed = true;
+                return;
+            }
+        }
+
+        if (reader.invalid)
+        {
+            chunk->failed = true;
+            return;
+        }
+    }
+}
+
+static int compare_line_range(void const* l, void const* r)
+{
+    method_line_range_t const* left = l;
+    method_line_range_t const* right = r;
+    if (left->document_rid != right->document_rid)
+        return left->document_rid < right->document_rid ? -1 : 1;
+    if (left->min_line != right->min_line)
+        return left->min_line < right->min_line ? -1 : 1;
+    return left->method_rid < right->method_rid ? -1 : (left->method_rid > right->method_rid ? 1 : 0);
+}
+
+static mddocline_index_t* build_document_line_index(mdcxt_t* cxt)
+{
+    uint32_t document_count = cxt->tables[mdtid_Document].row_count;
+    uint32_t method_count = cxt->tables[mdtid_MethodDebugInformation].row_count;
+
+    mddocline_index_t* index = (mddocline_index_t*)calloc(1, sizeof(mddocline_index_t));
+    if (index == NULL)
+        return NULL;
+    index->document_count = document_count;
+    index->document_offsets = (uint32_t*)calloc((size_t)document_count + 1, sizeof(uint32_t));
+    if (index->document_offsets == NULL)
+    {
+        free_document_line_index(index);
+        return NULL;
+    }
+
+    size_t chunk_count = ((size_t)method_count + LINE_INDEX_CHUNK_ROWS - 1) / LINE_INDEX_CHUNK_ROWS;
+    line_index_chunk_t* chunks = (line_index_chunk_t*)calloc(chunk_count != 0 ? chunk_count : 1, sizeof(line_index_chunk_t));
+    if (chunks == NULL)
+    {
+        free_document_line_index(index);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+        chunks[i].cxt = cxt;
+        chunks[i].first_rid = (uint32_t)(i * LINE_INDEX_CHUNK_ROWS) + 1;
+        chunks[i].row_count = method_count - (uint32_t)(i * LINE_INDEX_CHUNK_ROWS);
+        if (chunks[i].row_count > LINE_INDEX_CHUNK_ROWS)
+            chunks[i].row_count = LINE_INDEX_CHUNK_ROWS;
+    }
+
+    // Reading the rows doesn't modify the context, so the chunks can be decoded concurrently.
+    size_t max_workers = method_count / LINE_INDEX_ROWS_PER_WORKER;
+    parallel_for(chunk_count, max_workers > 1 ? max_workers : 1, build_line_index_chunk, chunks);
+
+    bool success = true;
+    size_t range_count = 0;
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+        success = success && !chunks[i].failed;
+        range_count += chunks[i].range_count;
+    }
+
+    if (success && range_count != 0)
+    {
+        index->ranges = (method_line_range_t*)malloc(range_count * sizeof(method_line_range_t));
+        index->max_line_so_far = (uint32_t*)malloc(range_count * sizeof(uint32_t));
+        success = index->ranges != NULL && index->max_line_so_far != NULL;
+    }
+
+    if (success)
+    {
+        size_t offset = 0;
+        for (size_t i = 0; i < chunk_count; ++i)
+        {
+            if (chunks[i].range_count != 0)
+                memcpy(&index->ranges[offset], chunks[i].ranges, chunks[i].range_count * sizeof(method_line_range_t));
+            offset += chunks[i].range_count;
+        }
+
+        if (range_count != 0)
+            qsort(index->ranges, range_count, sizeof(method_line_range_t), compare_line_range);
+
+        uint32_t document_rid = 0;
+        for (size_t i = 0; i < range_count; ++i)
+        {
+            method_line_range_t const* range = &index->ranges[i];
+            // Document references are validated when the points are read.
+            assert(range->document_rid != 0 && range->document_rid <= document_count);
+
+            // Close the documents before this one.
+            for (; document_rid < range->document_rid; ++document_rid)
+                index->document_offsets[document_rid] = (uint32_t)i;
+
+            bool first_in_document = i == 0 || index->ranges[i - 1].document_rid != range->document_rid;
+            index->max_line_so_far[i] = first_in_document || range->max_line > index->max_line_so_far[i - 1]
+                ? range->max_line
+                : index->max_line_so_far[i - 1];
+        }
+        for (; document_rid <= document_count; ++document_rid)
+            index->document_offsets[document_rid] = (uint32_t)range_count;
+    }
+
+    for (size_t i = 0; i < chunk_count; ++i)
+        free(chunks[i].ranges);
+    free(chunks);
+
+    if (!success)
+    {
+        free_document_line_index(index);
+        return NULL;
+    }
+    return index;
+}
+
+static mddocline_index_t* get_document_line_index(mdcxt_t* cxt)
+{
+    mddocline_index_t* index = (mddocline_index_t*)atomic_load_ptr((void* volatile*)&cxt->document_line_index);
+    if (index != NULL)
+        return index;
+
+    mddocline_index_t* new_index = build_document_line_index(cxt);
+    if (new_index == NULL)
+        return NULL;
+
+    if (atomic_publish_ptr((void* volatile*)&cxt->document_line_index, new_index))
+        return new_index;
+
+    // Another thread published an index first.
+    free_document_line_index(new_index);
+    return (mddocline_index_t*)atomic_load_ptr((void* volatile*)&cxt->document_line_index);
+}
+
+bool md_find_methods_for_document_line(mdhandle_t handle, mdcursor_t document, uint32_t line, mdToken* methods, uint32_t* method_count)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || method_count == NULL)
+        return false;
+
+    mdToken document_token;
+    if (!md_cursor_to_token(document, &document_token)
+        || ExtractTokenType(document_token) != mdtid_Document)
+    {
+        return false;
+    }
+
+    mddocline_index_t* index = get_document_line_index(cxt);
+    if (index == NULL)
+        return false;
+
+    uint32_t document_rid = RidFromToken(document_token);
+    if (document_rid == 0 || document_rid > index->document_count)
+        return false;
+
+    uint32_t begin = index->document_offsets[document_rid - 1];
+    uint32_t end = index->document_offsets[document_rid];
+
+    // Skip the ranges that end before the line.
+    uint32_t lo = begin;
+    uint32_t hi = end;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (index->max_line_so_far[mid] < line)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    uint32_t capacity = methods != NULL ? *method_count : 0;
+    uint32_t count = 0;
+    // The ranges are sorted by their first line, so the ones after the line can't contain it.
+    for (uint32_t i = lo; i < end && index->ranges[i].min_line <= line; ++i)
+    {
+        if (index->ranges[i].max_line < line)
+            continue;
+        if (count < capacity)
+            methods[count] = TokenFromRid(index->ranges[i].method_rid, CreateTokenType(mdtid_MethodDef));
+        count++;
+    }
+
+    *method_count = count;
+    return methods == NULL || count <= capacity;
+}
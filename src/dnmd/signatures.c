@@ -0,0 +1,543 @@
+#include "internal.h"
+
+// Decoded signatures - ECMA-335 II.23.2
+
+// Types nested deeper than this are rejected to bound the recursion.
+#define MAX_SIGNATURE_DEPTH 128
+
+// A decoded signature is stored in a single allocation: the entry, followed by
+// the nested method signatures, types, array shapes, sizes and lower bounds.
+typedef struct sig_entry__
+{
+    uint32_t offset;
+    md_signature_t signature;
+} sig_entry_t;
+
+// Decoded signatures are stored in an open addressing table keyed by blob heap offset.
+// The capacity is fixed for the lifetime of the cache as any edit releases it.
+struct mdsig_cache__
+{
+    uint32_t mask;
+    sig_entry_t* volatile entries[];
+};
+
+void free_sig_cache(mdcxt_t* cxt)
+{
+    assert(cxt != NULL);
+    mdsig_cache_t* cache = cxt->sig_cache;
+    if (cache == NULL)
+        return;
+
+    for (uint32_t i = 0; i <= cache->mask; ++i)
+        free(cache->entries[i]);
+    free(cache);
+    cxt->sig_cache = NULL;
+}
+
+// Allocates the parts of a decoded signature, or only counts them if there is no storage.
+typedef struct sig_decoder__
+{
+    md_signature_t* methods;
+    md_signature_type_t* types;
+    md_array_shape_t* shapes;
+    uint32_t* sizes;
+    int32_t* lower_bounds;
+    size_t method_count;
+    size_t type_count;
+    size_t shape_count;
+    size_t size_count;
+    size_t lower_bound_count;
+} sig_decoder_t;
+
+static md_signature_t* alloc_methods(sig_decoder_t* decoder, size_t count)
+{
+    md_signature_t* methods = decoder->methods != NULL ? decoder->methods + decoder->method_count : NULL;
+    decoder->method_count += count;
+    return methods;
+}
+
+static md_signature_type_t* alloc_types(sig_decoder_t* decoder, size_t count)
+{
+    md_signature_type_t* types = decoder->types != NULL ? decoder->types + decoder->type_count : NULL;
+    decoder->type_count += count;
+    return types;
+}
+
+static md_array_shape_t* alloc_shape(sig_decoder_t* decoder)
+{
+    md_array_shape_t* shape = decoder->shapes != NULL ? decoder->shapes + decoder->shape_count : NULL;
+    decoder->shape_count++;
+    return shape;
+}
+
+static bool read_type_def_or_ref(uint8_t const** sig, size_t* sig_len, mdToken* type)
+{
+    uint32_t raw;
+    mdtable_id_t table;
+    uint32_t row;
+    if (!decompress_u32(sig, sig_len, &raw)
+        || !decompose_coded_index(raw, mdtc_idx_coded | InsertCodedIndex(mdci_TypeDefOrRef), &table, &row))
+    {
+        return false;
+    }
+
+    *type = CreateTokenType(table) | row;
+    return true;
+}
+
+static bool decode_method(sig_decoder_t* decoder, uint8_t const** sig, size_t* sig_len, uint32_t depth, bool method_only, md_signature_t* method);
+
+// Decode a Type, including any custom modifiers, BYREF or PINNED - ECMA-335 II.23.2.12
+// If type is NULL, only the parts are counted.
+static bool decode_type(sig_decoder_t* decoder, uint8_t const** sig, size_t* sig_len, uint32_t depth, md_signature_type_t* type)
+{
+    if (depth > MAX_SIGNATURE_DEPTH)
+        return false;
+
+    uint8_t element_type;
+    if (!read_u8(sig, sig_len, &element_type))
+        return false;
+
+    if (type != NULL)
+    {
+        memset(type, 0, sizeof(*type));
+        type->element_type = element_type;
+    }
+
+    switch (element_type)
+    {
+        case ELEMENT_TYPE_VOID:
+        case ELEMENT_TYPE_BOOLEAN:
+        case ELEMENT_TYPE_CHAR:
+        case ELEMENT_TYPE_I1:
+        case ELEMENT_TYPE_U1:
+        case ELEMENT_TYPE_I2:
+        case ELEMENT_TYPE_U2:
+        case ELEMENT_TYPE_I4:
+        case ELEMENT_TYPE_U4:
+        case ELEMENT_TYPE_I8:
+        case ELEMENT_TYPE_U8:
+        case ELEMENT_TYPE_R4:
+        case ELEMENT_TYPE_R8:
+        case ELEMENT_TYPE_STRING:
+        case ELEMENT_TYPE_OBJECT:
+        case ELEMENT_TYPE_TYPEDBYREF:
+        case ELEMENT_TYPE_I:
+        case ELEMENT_TYPE_U:
+            return true;
+
+        case ELEMENT_TYPE_CLASS:
+        case ELEMENT_TYPE_VALUETYPE:
+        {
+            mdToken token;
+            if (!read_type_def_or_ref(sig, sig_len, &token))
+                return false;
+            if (type != NULL)
+                type->data.token = token;
+            return true;
+        }
+
+        case ELEMENT_TYPE_VAR:
+        case ELEMENT_TYPE_MVAR:
+        {
+            uint32_t index;
+            if (!decompress_u32(sig, sig_len, &index))
+                return false;
+            if (type != NULL)
+                type->data.generic_param_index = index;
+            return true;
+        }
+
+        case ELEMENT_TYPE_PTR:
+        case ELEMENT_TYPE_BYREF:
+        case ELEMENT_TYPE_SZARRAY:
+        case ELEMENT_TYPE_PINNED:
+        {
+            md_signature_type_t* inner = alloc_types(decoder, 1);
+            if (type != NULL)
+                type->data.type = inner;
+            return decode_type(decoder, sig, sig_len, depth + 1, inner);
+        }
+
+        case ELEMENT_TYPE_CMOD_REQD:
+        case ELEMENT_TYPE_CMOD_OPT:
+        {
+            mdToken token;
+            if (!read_type_def_or_ref(sig, sig_len, &token))
+                return false;
+
+            md_signature_type_t* inner = alloc_types(decoder, 1);
+            if (type != NULL)
+            {
+                type->data.modifier.token = token;
+                type->data.modifier.type = inner;
+            }
+            return decode_type(decoder, sig, sig_len, depth + 1, inner);
+        }
+
+        case ELEMENT_TYPE_FNPTR:
+        {
+            md_signature_t* method = alloc_methods(decoder, 1);
+            if (type != NULL)
+                type->data.method = method;
+            return decode_method(decoder, sig, sig_len, depth + 1, true, method);
+        }
+
+        case ELEMENT_TYPE_ARRAY:
+        {
+            md_signature_type_t* inner = alloc_types(decoder, 1);
+            if (!decode_type(decoder, sig, sig_len, depth + 1, inner))
+                return false;
+
+            // ArrayShape - II.23.2.13
+            md_array_shape_t* shape = alloc_shape(decoder);
+            uint32_t rank;
+            uint32_t size_count;
+            if (!decompress_u32(sig, sig_len, &rank)
+                || !decompress_u32(sig, sig_len, &size_count)
+                || size_count > *sig_len)
+            {
+                return false;
+            }
+
+            uint32_t* sizes = decoder->sizes != NULL ? decoder->sizes + decoder->size_count : NULL;
+            decoder->size_count += size_count;
+            for (uint32_t i = 0; i < size_count; ++i)
+            {
+                uint32_t size;
+                if (!decompress_u32(sig, sig_len, &size))
+                    return false;
+                if (sizes != NULL)
+                    sizes[i] = size;
+            }
+
+            uint32_t lower_bound_count;
+            if (!decompress_u32(sig, sig_len, &lower_bound_count)
+                || lower_bound_count > *sig_len)
+            {
+                return false;
+            }
+
+            int32_t* lower_bounds = decoder->lower_bounds != NULL ? decoder->lower_bounds + decoder->lower_bound_count : NULL;
+            decoder->lower_bound_count += lower_bound_count;
+            for (uint32_t i = 0; i < lower_bound_count; ++i)
+            {
+                int32_t lower_bound;
+                if (!decompress_i32(sig, sig_len, &lower_bound))
+                    return false;
+                if (lower_bounds != NULL)
+                    lower_bounds[i] = lower_bound;
+            }
+
+            if (type != NULL)
+            {
+                shape->rank = rank;
+                shape->size_count = size_count;
+                shape->sizes = sizes;
+                shape->lower_bound_count = lower_bound_count;
+                shape->lower_bounds = lower_bounds;
+                type->data.array.type = inner;
+                type->data.array.shape = shape;
+            }
+            return true;
+        }
+
+        case ELEMENT_TYPE_GENERICINST:
+        {
+            md_signature_type_t* generic_type = alloc_types(decoder, 1);
+            uint32_t arg_count;
+            if (!decode_type(decoder, sig, sig_len, depth + 1, generic_type)
+                || !decompress_u32(sig, sig_len, &arg_count)
+                || arg_count > *sig_len) // Every argument takes at least a byte.
+            {
+                return false;
+            }
+
+            md_signature_type_t* args = alloc_types(decoder, arg_count);
+            for (uint32_t i = 0; i < arg_count; ++i)
+            {
+                if (!decode_type(decoder, sig, sig_len, depth + 1, args != NULL ? &args[i] : NULL))
+                    return false;
+            }
+
+            if (type != NULL)
+            {
+                type->data.generic_inst.type = generic_type;
+                type->data.generic_inst.arg_count = arg_count;
+                type->data.generic_inst.args = args;
+            }
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+static bool is_method_calling_convention(uint8_t kind)
+{
+    switch (kind)
+    {
+        case IMAGE_CEE_CS_CALLCONV_DEFAULT:
+        case IMAGE_CEE_CS_CALLCONV_C:
+        case IMAGE_CEE_CS_CALLCONV_STDCALL:
+        case IMAGE_CEE_CS_CALLCONV_THISCALL:
+        case IMAGE_CEE_CS_CALLCONV_FASTCALL:
+        case IMAGE_CEE_CS_CALLCONV_VARARG:
+        case IMAGE_CEE_CS_CALLCONV_UNMANAGED:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Decode a signature that starts with a calling convention.
+// Function pointers are restricted to method signatures.
+// If method is NULL, only the parts are counted.
+static bool decode_method(sig_decoder_t* decoder, uint8_t const** sig, size_t* sig_len, uint32_t depth, bool method_only, md_signature_t* method)
+{
+    uint8_t calling_convention;
+    if (!read_u8(sig, sig_len, &calling_convention))
+        return false;
+
+    uint8_t kind = calling_convention & IMAGE_CEE_CS_CALLCONV_MASK;
+    bool is_method = is_method_calling_convention(kind);
+    if (method_only && !is_method)
+        return false;
+
+    uint32_t generic_param_count = 0;
+    uint32_t param_count = 0;
+    md_signature_type_t* return_type = NULL;
+    switch (kind)
+    {
+        case IMAGE_CEE_CS_CALLCONV_FIELD: // FieldSig - II.23.2.4
+            return_type = alloc_types(decoder, 1);
+            if (!decode_type(decoder, sig, sig_len, depth, return_type))
+                return false;
+            break;
+
+        case IMAGE_CEE_CS_CALLCONV_LOCAL_SIG: // LocalVarSig - II.23.2.6
+        case IMAGE_CEE_CS_CALLCONV_GENERICINST: // MethodSpec - II.23.2.15
+            if (!decompress_u32(sig, sig_len, &param_count))
+                return false;
+            break;
+
+        case IMAGE_CEE_CS_CALLCONV_PROPERTY: // PropertySig - II.23.2.5
+            return_type = alloc_types(decoder, 1);
+            if (!decompress_u32(sig, sig_len, &param_count)
+                || !decode_type(decoder, sig, sig_len, depth, return_type))
+            {
+                return false;
+            }
+            break;
+
+        default: // MethodDefSig, MethodRefSig and StandAloneMethodSig - II.23.2.1 to II.23.2.3
+            if (!is_method)
+                return false;
+
+            return_type = alloc_types(decoder, 1);
+            if (((calling_convention & IMAGE_CEE_CS_CALLCONV_GENERIC) && !decompress_u32(sig, sig_len, &generic_param_count))
+                || !decompress_u32(sig, sig_len, &param_count)
+                || !decode_type(decoder, sig, sig_len, depth, return_type))
+            {
+                return false;
+            }
+            break;
+    }
+
+    // Every parameter takes at least a byte in the signature, so this bounds the allocation.
+    if (param_count > *sig_len)
+        return false;
+
+    uint32_t vararg_index = param_count;
+    md_signature_type_t* params = alloc_types(decoder, param_count);
+    for (uint32_t i = 0; i < param_count; ++i)
+    {
+        if (is_method && *sig_len > 0 && **sig == ELEMENT_TYPE_SENTINEL)
+        {
+            if (vararg_index != param_count)
+                return false;
+            vararg_index = i;
+            ++*sig;
+            --*sig_len;
+        }
+
+        if (!decode_type(decoder, sig, sig_len, depth, params != NULL ? &params[i] : NULL))
+            return false;
+    }
+
+    if (method != NULL)
+    {
+        method->calling_convention = calling_convention;
+        method->generic_param_count = generic_param_count;
+        method->param_count = param_count;
+        method->vararg_index = vararg_index;
+        method->return_type = return_type;
+        method->params = param_count > 0 ? params : NULL;
+    }
+    return true;
+}
+
+static md_blob_parse_result_t decode_signature(uint32_t offset, uint8_t const* sig, size_t sig_len, sig_entry_t** decoded)
+{
+    // Count the parts to calculate the size of the allocation.
+    sig_decoder_t decoder = { 0 };
+    uint8_t const* sig_curr = sig;
+    size_t sig_curr_len = sig_len;
+    if (!decode_method(&decoder, &sig_curr, &sig_curr_len, 0, false, NULL))
+        return mdbpr_InvalidBlob;
+
+    // Types that contain pointers are placed first to keep every part aligned.
+    size_t methods_offset = sizeof(sig_entry_t);
+    size_t types_offset = methods_offset + decoder.method_count * sizeof(md_signature_t);
+    size_t shapes_offset = types_offset + decoder.type_count * sizeof(md_signature_type_t);
+    size_t sizes_offset = shapes_offset + decoder.shape_count * sizeof(md_array_shape_t);
+    size_t lower_bounds_offset = sizes_offset + decoder.size_count * sizeof(uint32_t);
+    size_t total_size = lower_bounds_offset + decoder.lower_bound_count * sizeof(int32_t);
+
+    uint8_t* mem = (uint8_t*)calloc(1, total_size);
+    if (mem == NULL)
+        return mdbpr_OutOfMemory;
+
+    sig_entry_t* entry = (sig_entry_t*)mem;
+    entry->offset = offset;
+
+    sig_decoder_t storage = { 0 };
+    storage.methods = (md_signature_t*)(mem + methods_offset);
+    storage.types = (md_signature_type_t*)(mem + types_offset);
+    storage.shapes = (md_array_shape_t*)(mem + shapes_offset);
+    storage.sizes = (uint32_t*)(mem + sizes_offset);
+    storage.lower_bounds = (int32_t*)(mem + lower_bounds_offset);
+    if (!decode_method(&storage, &sig, &sig_len, 0, false, &entry->signature))
+    {
+        free(mem);
+        return mdbpr_InvalidBlob;
+    }
+
+    assert(storage.method_count == decoder.method_count
+        && storage.type_count == decoder.type_count
+        && storage.shape_count == decoder.shape_count
+        && storage.size_count == decoder.size_count
+        && storage.lower_bound_count == decoder.lower_bound_count);
+    *decoded = entry;
+    return mdbpr_Success;
+}
+
+// Find the blob heap offset of a blob from its data.
+static bool get_blob_offset(mdcxt_t* cxt, uint8_t const* sig, size_t sig_len, uint32_t* offset)
+{
+    mdstream_t* heap = &cxt->blob_heap;
+    uintptr_t heap_start = (uintptr_t)heap->ptr;
+    uintptr_t data = (uintptr_t)sig;
+    if (sig_len == 0 || data < heap_start || data - heap_start > heap->size || heap->size - (data - heap_start) < sig_len)
+        return false;
+
+    // The length prefix is the shortest compressed form of the length - II.24.2.4
+    size_t prefix_len = sig_len <= 0x7f ? 1 : sig_len <= 0x3fff ? 2 : 4;
+    if (data - heap_start < prefix_len)
+        return false;
+
+    uint32_t blob_offset = (uint32_t)(data - heap_start - prefix_len);
+    uint8_t const* blob;
+    uint32_t blob_len;
+    if (!try_get_blob(cxt, blob_offset, &blob, &blob_len) || blob != sig || blob_len != sig_len)
+        return false;
+
+    *offset = blob_offset;
+    return true;
+}
+
+static mdsig_cache_t* get_sig_cache(mdcxt_t* cxt)
+{
+    mdsig_cache_t* cache = (mdsig_cache_t*)atomic_load_ptr((void* volatile*)&cxt->sig_cache);
+    if (cache != NULL)
+        return cache;
+
+    // Signatures are deduplicated in the blob heap, so the number of rows with a
+    // signature bounds the number of distinct signatures. Keep the load factor at most a half.
+    static mdtable_id_t const signature_tables[] =
+    {
+        mdtid_Field,
+        mdtid_MethodDef,
+        mdtid_MemberRef,
+        mdtid_StandAloneSig,
+        mdtid_Property,
+        mdtid_MethodSpec,
+    };
+
+    uint64_t signature_count = 0;
+    for (size_t i = 0; i < ARRAY_SIZE(signature_tables); ++i)
+        signature_count += cxt->tables[signature_tables[i]].row_count;
+
+    uint64_t capacity = 16;
+    while (capacity < signature_count * 2)
+        capacity <<= 1;
+
+    if (capacity > (UINT32_MAX / sizeof(sig_entry_t*)))
+        return NULL;
+
+    mdsig_cache_t* new_cache = (mdsig_cache_t*)calloc(1, sizeof(mdsig_cache_t) + (size_t)capacity * sizeof(sig_entry_t*));
+    if (new_cache == NULL)
+        return NULL;
+
+    new_cache->mask = (uint32_t)(capacity - 1);
+    if (atomic_publish_ptr((void* volatile*)&cxt->sig_cache, new_cache))
+        return new_cache;
+
+    // Another thread published a cache first.
+    free(new_cache);
+    return (mdsig_cache_t*)atomic_load_ptr((void* volatile*)&cxt->sig_cache);
+}
+
+md_blob_parse_result_t md_get_signature(mdhandle_t handle, uint8_t const* sig, size_t sig_len, md_signature_t const** signature)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || sig == NULL || signature == NULL)
+        return mdbpr_InvalidArgument;
+
+    uint32_t offset;
+    if (!get_blob_offset(cxt, sig, sig_len, &offset))
+        return mdbpr_InvalidArgument;
+
+    mdsig_cache_t* cache = get_sig_cache(cxt);
+    if (cache == NULL)
+        return mdbpr_OutOfMemory;
+
+    sig_entry_t* decoded = NULL;
+    uint32_t slot = (uint32_t)((offset * UINT64_C(0x9E3779B97F4A7C15)) >> 32);
+    for (uint32_t i = 0; i <= cache->mask; ++i, ++slot)
+    {
+        sig_entry_t* volatile* entry_slot = &cache->entries[slot & cache->mask];
+        sig_entry_t* entry = (sig_entry_t*)atomic_load_ptr((void* volatile*)entry_slot);
+        if (entry == NULL)
+        {
+            if (decoded == NULL)
+            {
+                md_blob_parse_result_t result = decode_signature(offset, sig, sig_len, &decoded);
+                if (result != mdbpr_Success)
+                    return result;
+            }
+
+            if (atomic_publish_ptr((void* volatile*)entry_slot, decoded))
+            {
+                *signature = &decoded->signature;
+                return mdbpr_Success;
+            }
+
+            // Another thread published to the slot first.
+            entry = (sig_entry_t*)atomic_load_ptr((void* volatile*)entry_slot);
+        }
+
+        if (entry->offset == offset)
+        {
+            free(decoded);
+            *signature = &entry->signature;
+            return mdbpr_Success;
+        }
+    }
+
+    // The cache is full, which only happens if there are more
+    // distinct signatures than rows that reference signatures.
+    free(decoded);
+    return mdbpr_OutOfMemory;
+}
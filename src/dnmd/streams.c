@@ -349,6 +349,22 @@ bool try_get_pdb(mdcxt_t* cxt, md_pdb_t* pdb)
 #endif // !DNMD_PORTABLE_PDB
 }
 
+#ifdef DNMD_PORTABLE_PDB
+bool md_get_pdb_entry_point(mdhandle_t handle, mdToken* entry_point)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || entry_point == NULL)
+        return false;
+
+    md_pdb_t pdb;
+    if (!try_get_pdb(cxt, &pdb))
+        return false;
+
+    *entry_point = pdb.entry_point;
+    return true;
+}
+#endif // DNMD_PORTABLE_PDB
+
 mdstream_t* get_heap_by_id(mdcxt_t* cxt, mdtcol_t heap_id)
 {
     assert(cxt != NULL);
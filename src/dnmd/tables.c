@@ -840,4 +840,120 @@ mdtable_id_t get_corresponding_indirection_table(mdtable_id_t table_id)
     default:
         return mdtid_Unused;
     }
-}
\ No newline at end of file
+}
+
+// Get the details of the table. Tables without rows are given the details their first row would have.
+static mdtable_t const* get_table_details(mdcxt_t* cxt, mdtable_id_t table_id, mdtable_t* new_table, mdtcol_t* new_table_columns)
+{
+    assert(cxt != NULL && new_table != NULL && new_table_columns != NULL);
+    mdtable_t const* table = &cxt->tables[table_id];
+    if (table->cxt != NULL)
+        return table;
+
+    memset(new_table, 0, sizeof(*new_table));
+    new_table->column_details = new_table_columns;
+    if (!initialize_new_table_details(cxt, table_id, new_table))
+        return NULL;
+    return new_table;
+}
+
+bool md_get_table_layout(mdhandle_t handle, mdtable_id_t table_id, md_table_layout_t* layout)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || table_id < mdtid_First || table_id >= mdtid_End || layout == NULL)
+        return false;
+
+    memset(layout, 0, sizeof(*layout));
+    layout->key_column = -1;
+
+    // Reserved table IDs have no columns.
+    if (get_table_column_count(table_id) == 0)
+        return true;
+
+    mdtable_t new_table;
+    mdtcol_t new_table_columns[MDTABLE_MAX_COLUMN_COUNT];
+    mdtable_t const* table = get_table_details(cxt, table_id, &new_table, new_table_columns);
+    if (table == NULL)
+        return false;
+
+    layout->row_count = table->row_count;
+    layout->row_size = table->row_size_bytes;
+    layout->column_count = table->column_count;
+
+    md_key_info_t const* keys;
+    if (get_table_keys(table_id, &keys) != 0)
+        layout->key_column = keys[0].index;
+    return true;
+}
+
+bool md_get_column_layout(mdhandle_t handle, mdtable_id_t table_id, col_index_t col_idx, md_column_layout_t* layout)
+{
+    mdcxt_t* cxt = extract_mdcxt(handle);
+    if (cxt == NULL || table_id < mdtid_First || table_id >= mdtid_End || layout == NULL)
+        return false;
+
+    if (get_table_column_count(table_id) == 0)
+        return false;
+
+    mdtable_t new_table;
+    mdtcol_t new_table_columns[MDTABLE_MAX_COLUMN_COUNT];
+    mdtable_t const* table = get_table_details(cxt, table_id, &new_table, new_table_columns);
+    if (table == NULL)
+        return false;
+
+    uint8_t idx = col_to_index(col_idx, table);
+    if (idx >= table->column_count)
+        return false;
+
+    memset(layout, 0, sizeof(*layout));
+    mdtcol_t col = table->column_details[idx];
+    layout->offset = (uint8_t)ExtractOffset(col);
+    layout->size = (col & mdtc_b2) ? 2 : 4;
+    switch (col & mdtc_categorymask)
+    {
+    case mdtc_constant:
+        layout->kind = mdck_Constant;
+        return true;
+    case mdtc_idx_table:
+        layout->kind = mdck_TableIndex;
+        layout->target.table = (mdtable_id_t)ExtractTable(col);
+        return true;
+    case mdtc_idx_coded:
+        layout->kind = mdck_CodedIndex;
+        layout->target.coded_index = ExtractCodedIndex(col);
+        return true;
+    case mdtc_idx_heap:
+        layout->kind = mdck_HeapIndex;
+        switch (ExtractHeapType(col))
+        {
+        case mdtc_hstring:
+            layout->target.heap = mdhid_String;
+            return true;
+        case mdtc_hguid:
+            layout->target.heap = mdhid_Guid;
+            return true;
+        case mdtc_hblob:
+            layout->target.heap = mdhid_Blob;
+            return true;
+        case mdtc_hus:
+            layout->target.heap = mdhid_UserString;
+            return true;
+        default:
+            break;
+        }
+        break;
+    default:
+        break;
+    }
+    assert(!"Unknown column kind");
+    return false;
+}
+
+int32_t md_get_coded_index_tables(uint32_t coded_index, mdtable_id_t const** tables)
+{
+    if (coded_index >= ARRAY_SIZE(coded_index_map) || tables == NULL)
+        return -1;
+
+    *tables = coded_index_map[coded_index].lookup;
+    return coded_index_map[coded_index].lookup_len;
+}
@@ -0,0 +1,525 @@
+#include "internal.h"
+
+// Snapshots of a TypeDef and its members - see md_get_type_def_snapshot().
+
+// The rows of a member list - II.22.37.
+// Lists of metadata with indirection tables are read through the indirection table one row at a time,
+// otherwise the rows are contiguous and each column is read for the whole list at once.
+typedef struct member_list__
+{
+    mdcursor_t first;
+    uint32_t count;
+    bool indirect;
+} member_list_t;
+
+typedef struct snapshot_counts__
+{
+    uint32_t fields;
+    uint32_t methods;
+    uint32_t params;
+    uint32_t generic_params;
+    uint32_t interface_impls;
+} snapshot_counts_t;
+
+// Rows of a table that refer to the type, for example its InterfaceImpl rows.
+// Sorted tables are searched for the range of rows, unsorted tables are scanned.
+typedef struct child_rows__
+{
+    mdcursor_t next;
+    uint32_t remaining;
+    col_index_t col;
+    mdToken parent;
+    bool scan;
+} child_rows_t;
+
+static bool get_member_list(mdcursor_t owner, col_index_t list_col, member_list_t* list)
+{
+    if (!md_get_column_value_as_range(owner, list_col, &list->first, &list->count))
+        return false;
+    list->indirect = list->count != 0 && table_is_indirect_table((mdtable_id_t)CursorTable(&list->first)->table_id);
+    return true;
+}
+
+static bool get_member_row(member_list_t const* list, uint32_t i, mdcursor_t* row)
+{
+    mdcursor_t c = list->first;
+    return md_cursor_move(&c, (int32_t)i)
+        && md_resolve_indirect_cursor(c, row);
+}
+
+static bool read_member_tokens(member_list_t const* list, mdToken* tokens)
+{
+    for (uint32_t i = 0; i < list->count; ++i)
+    {
+        mdcursor_t row;
+        if (!get_member_row(list, i, &row) || !md_cursor_to_token(row, &tokens[i]))
+            return false;
+    }
+    return true;
+}
+
+static bool read_member_constants(member_list_t const* list, col_index_t col, uint32_t* values)
+{
+    if (list->count == 0)
+        return true;
+
+    if (!list->indirect)
+        return md_get_column_value_as_constant(list->first, col, list->count, values) == (int32_t)list->count;
+
+    for (uint32_t i = 0; i < list->count; ++i)
+    {
+        mdcursor_t row;
+        if (!get_member_row(list, i, &row) || 1 != md_get_column_value_as_constant(row, col, 1, &values[i]))
+            return false;
+    }
+    return true;
+}
+
+static bool read_member_names(member_list_t const* list, col_index_t col, char const** names)
+{
+    if (list->count == 0)
+        return true;
+
+    if (!list->indirect)
+        return md_get_column_value_as_utf8(list->first, col, list->count, names) == (int32_t)list->count;
+
+    for (uint32_t i = 0; i < list->count; ++i)
+    {
+        mdcursor_t row;
+        if (!get_member_row(list, i, &row) || 1 != md_get_column_value_as_utf8(row, col, 1, &names[i]))
+            return false;
+    }
+    return true;
+}
+
+static bool read_member_blobs(member_list_t const* list, col_index_t col, uint8_t const** blobs, uint32_t* blob_lens)
+{
+    if (list->count == 0)
+        return true;
+
+    if (!list->indirect)
+        return md_get_column_value_as_blob(list->first, col, list->count, blobs, blob_lens) == (int32_t)list->count;
+
+    for (uint32_t i = 0; i < list->count; ++i)
+    {
+        mdcursor_t row;
+        if (!get_member_row(list, i, &row) || 1 != md_get_column_value_as_blob(row, col, 1, &blobs[i], &blob_lens[i]))
+            return false;
+    }
+    return true;
+}
+
+// Find the first row of the sorted table whose field column refers to the field, or a later field.
+static bool find_first_row_for_field(mdtable_t* table, col_index_t field_col, uint32_t field_row, uint32_t* row)
+{
+    uint32_t low = 1;
+    uint32_t high = table->row_count + 1;
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        mdcursor_t field;
+        if (1 != md_get_column_value_as_cursor(create_cursor(table, mid), field_col, 1, &field))
+            return false;
+
+        if (CursorRow(&field) < field_row)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    *row = low;
+    return true;
+}
+
+// Read a column of a table that extends fields, for example FieldRva, into the entries of the fields that have a row.
+static bool read_field_extension(mdcxt_t* cxt, member_list_t const* fields, mdtable_id_t table_id, col_index_t field_col, col_index_t value_col, uint32_t* values)
+{
+    mdtable_t* table = &cxt->tables[table_id];
+    if (fields->count == 0 || table->cxt == NULL || table->row_count == 0)
+        return true;
+
+    if (fields->indirect || !table->is_sorted || table->is_adding_new_row)
+    {
+        // The fields or the rows that extend them aren't in order, so look up each field.
+        mdcursor_t begin = create_cursor(table, 1);
+        for (uint32_t i = 0; i < fields->count; ++i)
+        {
+            mdcursor_t field;
+            mdcursor_t row;
+            if (!get_member_row(fields, i, &field))
+                return false;
+            if (md_find_row_from_cursor(begin, field_col, CursorRow(&field), &row)
+                && 1 != md_get_column_value_as_constant(row, value_col, 1, &values[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The fields are contiguous, so their rows in the sorted table are too.
+    mdcursor_t first = fields->first;
+    uint32_t first_field = CursorRow(&first);
+    uint32_t row;
+    if (!find_first_row_for_field(table, field_col, first_field, &row))
+        return false;
+
+    for (; row <= table->row_count; ++row)
+    {
+        mdcursor_t c = create_cursor(table, row);
+        mdcursor_t field;
+        if (1 != md_get_column_value_as_cursor(c, field_col, 1, &field))
+            return false;
+
+        uint32_t i = CursorRow(&field) - first_field;
+        if (i >= fields->count)
+            break;
+
+        if (1 != md_get_column_value_as_constant(c, value_col, 1, &values[i]))
+            return false;
+    }
+    return true;
+}
+
+static bool init_child_rows(mdcxt_t* cxt, mdtable_id_t table_id, col_index_t col, mdToken parent, uint32_t sorted_value, child_rows_t* rows)
+{
+    memset(rows, 0, sizeof(*rows));
+    mdtable_t* table = &cxt->tables[table_id];
+    if (table->cxt == NULL || table->row_count == 0)
+        return true;
+
+    mdcursor_t begin = create_cursor(table, 1);
+    switch (md_find_range_from_cursor(begin, col, sorted_value, &rows->next, &rows->remaining))
+    {
+    case MD_RANGE_FOUND:
+        return true;
+    case MD_RANGE_NOT_FOUND:
+        rows->remaining = 0;
+        return true;
+    default:
+        // Unsorted tables are scanned for rows that refer to the parent.
+        rows->next = begin;
+        rows->col = col;
+        rows->parent = parent;
+        rows->scan = true;
+        return true;
+    }
+}
+
+static bool next_child_row(child_rows_t* rows, mdcursor_t* row)
+{
+    if (rows->scan)
+        return 1 == md_scan_column_equals(&rows->next, rows->col, rows->parent, 1, row);
+
+    if (rows->remaining == 0)
+        return false;
+
+    *row = rows->next;
+    (void)md_cursor_next(&rows->next);
+    rows->remaining--;
+    return true;
+}
+
+static uint32_t count_child_rows(child_rows_t rows)
+{
+    uint32_t count = 0;
+    mdcursor_t row;
+    while (next_child_row(&rows, &row))
+        count++;
+    return count;
+}
+
+static bool get_generic_params(mdcxt_t* cxt, mdToken type_def, child_rows_t* rows)
+{
+    // GenericParam.Owner is a coded index, so the value to find is the token.
+    return init_child_rows(cxt, mdtid_GenericParam, mdtGenericParam_Owner, type_def, type_def, rows);
+}
+
+static bool get_interface_impls(mdcxt_t* cxt, mdToken type_def, child_rows_t* rows)
+{
+    return init_child_rows(cxt, mdtid_InterfaceImpl, mdtInterfaceImpl_Class, type_def, RidFromToken(type_def), rows);
+}
+
+static bool count_params(member_list_t const* methods, uint32_t* count)
+{
+    *count = 0;
+    for (uint32_t i = 0; i < methods->count; ++i)
+    {
+        mdcursor_t method;
+        member_list_t params;
+        if (!get_member_row(methods, i, &method) || !get_member_list(method, mdtMethodDef_ParamList, &params))
+            return false;
+        *count += params.count;
+    }
+    return true;
+}
+
+static size_t get_snapshot_size(snapshot_counts_t const* counts)
+{
+    size_t pointer_count = (size_t)counts->fields * 2
+        + (size_t)counts->methods * 2
+        + counts->params
+        + counts->generic_params;
+    size_t uint32_count = (size_t)counts->fields * 5
+        + (size_t)counts->methods * 7
+        + (size_t)counts->params * 3
+        + (size_t)counts->generic_params * 3
+        + (size_t)counts->interface_impls * 2;
+    return sizeof(md_type_def_snapshot_t) + pointer_count * sizeof(void*) + uint32_count * sizeof(uint32_t);
+}
+
+// The pointer arrays follow the snapshot, then the 32-bit arrays, so each array is aligned.
+static void* take_array(uint8_t** next, size_t count, size_t element_size)
+{
+    void* array = *next;
+    *next += count * element_size;
+    return array;
+}
+
+static bool read_methods(member_list_t const* methods, md_type_def_snapshot_t* snapshot, uint8_t** pointers, uint8_t** values)
+{
+    uint32_t count = methods->count;
+    mdToken* tokens = (mdToken*)take_array(values, count, sizeof(mdToken));
+    uint32_t* flags = (uint32_t*)take_array(values, count, sizeof(uint32_t));
+    uint32_t* impl_flags = (uint32_t*)take_array(values, count, sizeof(uint32_t));
+    uint32_t* rvas = (uint32_t*)take_array(values, count, sizeof(uint32_t));
+    char const** names = (char const**)take_array(pointers, count, sizeof(char const*));
+    uint8_t const** signatures = (uint8_t const**)take_array(pointers, count, sizeof(uint8_t const*));
+    uint32_t* signature_lengths = (uint32_t*)take_array(values, count, sizeof(uint32_t));
+    uint32_t* first_params = (uint32_t*)take_array(values, count, sizeof(uint32_t));
+    uint32_t* param_counts = (uint32_t*)take_array(values, count, sizeof(uint32_t));
+
+    if (!read_member_tokens(methods, tokens)
+        || !read_member_constants(methods, mdtMethodDef_Flags, flags)
+        || !read_member_constants(methods, mdtMethodDef_ImplFlags, impl_flags)
+        || !read_member_constants(methods, mdtMethodDef_Rva, rvas)
+        || !read_member_names(methods, mdtMethodDef_Name, names)
+        || !read_member_blobs(methods, mdtMethodDef_Signature, signatures, signature_lengths))
+    {
+        return false;
+    }
+
+    snapshot->method_count = count;
+    snapshot->method_tokens = tokens;
+    snapshot->method_flags = flags;
+    snapshot->method_impl_flags = impl_flags;
+    snapshot->method_rvas = rvas;
+    snapshot->method_names = names;
+    snapshot->method_signatures = signatures;
+    snapshot->method_signature_lengths = signature_lengths;
+    snapshot->method_first_params = first_params;
+    snapshot->method_param_counts = param_counts;
+
+    uint32_t param_count = snapshot->param_count;
+    mdToken* param_tokens = (mdToken*)take_array(values, param_count, sizeof(mdToken));
+    uint32_t* param_flags = (uint32_t*)take_array(values, param_count, sizeof(uint32_t));
+    uint32_t* param_sequences = (uint32_t*)take_array(values, param_count, sizeof(uint32_t));
+    char const** param_names = (char const**)take_array(pointers, param_count, sizeof(char const*));
+
+    uint32_t next_param = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        mdcursor_t method;
+        member_list_t params;
+        if (!get_member_row(methods, i, &method)
+            || !get_member_list(method, mdtMethodDef_ParamList, &params)
+            || params.count > param_count - next_param
+            || !read_member_tokens(&params, &param_tokens[next_param])
+            || !read_member_constants(&params, mdtParam_Flags, &param_flags[next_param])
+            || !read_member_constants(&params, mdtParam_Sequence, &param_sequences[next_param])
+            || !read_member_names(&params, mdtParam_Name, &param_names[next_param]))
+        {
+            return false;
+        }
+        first_params[i] = next_param;
+        param_counts[i] = params.count;
+        next_param += params.count;
+    }
+
+    snapshot->param_tokens = param_tokens;
+    snapshot->param_flags = param_flags;
+    snapshot->param_sequences = param_sequences;
+    snapshot->param_names = param_names;
+    return true;
+}
+
+static bool read_fields(mdcxt_t* cxt, member_list_t const* fields, md_type_def_snapshot_t* snapshot, uint8_t** pointers, uint8_t** values)
+{
+    uint32_t count = fields->count;
+    mdToken* tokens = (mdToken*)take_array(values, count, sizeof(mdToken));
+    uint32_t* flags = (uint32_t*)take_array(values, count, sizeof(uint32_t));
+    char const** names = (char const**)take_array(pointers, count, sizeof(char const*));
+    uint8_t const** signatures = (uint8_t const**)take_array(pointers, count, sizeof(uint8_t const*));
+    uint32_t* signature_lengths = (uint32_t*)take_array(values, count, sizeof(uint32_t));
+    uint32_t* rvas = (uint32_t*)take_array(values, count, sizeof(uint32_t));
+    uint32_t* offsets = (uint32_t*)take_array(values, count, sizeof(uint32_t));
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        rvas[i] = 0;
+        offsets[i] = UINT32_MAX;
+    }
+
+    if (!read_member_tokens(fields, tokens)
+        || !read_member_constants(fields, mdtField_Flags, flags)
+        || !read_member_names(fields, mdtField_Name, names)
+        || !read_member_blobs(fields, mdtField_Signature, signatures, signature_lengths)
+        || !read_field_extension(cxt, fields, mdtid_FieldRva, mdtFieldRva_Field, mdtFieldRva_Rva, rvas)
+        || !read_field_extension(cxt, fields, mdtid_FieldLayout, mdtFieldLayout_Field, mdtFieldLayout_Offset, offsets))
+    {
+        return false;
+    }
+
+    snapshot->field_count = count;
+    snapshot->field_tokens = tokens;
+    snapshot->field_flags = flags;
+    snapshot->field_names = names;
+    snapshot->field_signatures = signatures;
+    snapshot->field_signature_lengths = signature_lengths;
+    snapshot->field_rvas = rvas;
+    snapshot->field_offsets = offsets;
+    return true;
+}
+
+static bool read_generic_params(child_rows_t rows, uint32_t count, md_type_def_snapshot_t* snapshot, uint8_t** pointers, uint8_t** values)
+{
+    mdToken* tokens = (mdToken*)take_array(values, count, sizeof(mdToken));
+    uint32_t* numbers = (uint32_t*)take_array(values, count, sizeof(uint32_t));
+    uint32_t* flags = (uint32_t*)take_array(values, count, sizeof(uint32_t));
+    char const** names = (char const**)take_array(pointers, count, sizeof(char const*));
+
+    mdcursor_t row;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (!next_child_row(&rows, &row)
+            || !md_cursor_to_token(row, &tokens[i])
+            || 1 != md_get_column_value_as_constant(row, mdtGenericParam_Number, 1, &numbers[i])
+            || 1 != md_get_column_value_as_constant(row, mdtGenericParam_Flags, 1, &flags[i])
+            || 1 != md_get_column_value_as_utf8(row, mdtGenericParam_Name, 1, &names[i]))
+        {
+            return false;
+        }
+    }
+
+    snapshot->generic_param_count = count;
+    snapshot->generic_param_tokens = tokens;
+    snapshot->generic_param_numbers = numbers;
+    snapshot->generic_param_flags = flags;
+    snapshot->generic_param_names = names;
+    return true;
+}
+
+static bool read_interface_impls(child_rows_t rows, uint32_t count, md_type_def_snapshot_t* snapshot, uint8_t** values)
+{
+    mdToken* tokens = (mdToken*)take_array(values, count, sizeof(mdToken));
+    mdToken* interfaces = (mdToken*)take_array(values, count, sizeof(mdToken));
+
+    mdcursor_t row;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (!next_child_row(&rows, &row)
+            || !md_cursor_to_token(row, &tokens[i])
+            || 1 != md_get_column_value_as_token(row, mdtInterfaceImpl_Interface, 1, &interfaces[i]))
+        {
+            return false;
+        }
+    }
+
+    snapshot->interface_impl_count = count;
+    snapshot->interface_impl_tokens = tokens;
+    snapshot->interface_impl_interfaces = interfaces;
+    return true;
+}
+
+static bool read_class_layout(mdcxt_t* cxt, mdToken type_def, md_type_def_snapshot_t* snapshot)
+{
+    snapshot->has_class_layout = false;
+    snapshot->packing_size = 0;
+    snapshot->class_size = 0;
+
+    mdtable_t* table = &cxt->tables[mdtid_ClassLayout];
+    if (table->cxt == NULL || table->row_count == 0)
+        return true;
+
+    mdcursor_t row;
+    if (!md_find_row_from_cursor(create_cursor(table, 1), mdtClassLayout_Parent, RidFromToken(type_def), &row))
+        return true;
+
+    snapshot->has_class_layout = true;
+    return 1 == md_get_column_value_as_constant(row, mdtClassLayout_PackingSize, 1, &snapshot->packing_size)
+        && 1 == md_get_column_value_as_constant(row, mdtClassLayout_ClassSize, 1, &snapshot->class_size);
+}
+
+// Returns false if the snapshot can't be read. If the buffer is too small, only the required size is computed.
+static bool get_type_def_snapshot(mdcursor_t type_def, md_type_def_snapshot_t* snapshot, size_t buffer_len, size_t* required_size)
+{
+    mdtable_t* table = CursorTable(&type_def);
+    if (table == NULL || table->table_id != mdtid_TypeDef || CursorNull(&type_def) || CursorEnd(&type_def))
+        return false;
+
+    mdcxt_t* cxt = table->cxt;
+    mdToken token;
+    if (!md_cursor_to_token(type_def, &token))
+        return false;
+
+    member_list_t fields;
+    member_list_t methods;
+    child_rows_t generic_params;
+    child_rows_t interface_impls;
+    snapshot_counts_t counts;
+    if (!get_member_list(type_def, mdtTypeDef_FieldList, &fields)
+        || !get_member_list(type_def, mdtTypeDef_MethodList, &methods)
+        || !count_params(&methods, &counts.params)
+        || !get_generic_params(cxt, token, &generic_params)
+        || !get_interface_impls(cxt, token, &interface_impls))
+    {
+        return false;
+    }
+    counts.fields = fields.count;
+    counts.methods = methods.count;
+    counts.generic_params = count_child_rows(generic_params);
+    counts.interface_impls = count_child_rows(interface_impls);
+
+    *required_size = get_snapshot_size(&counts);
+    if (snapshot == NULL || buffer_len < *required_size)
+        return true;
+
+    size_t pointer_count = (size_t)counts.fields * 2 + (size_t)counts.methods * 2 + counts.params + counts.generic_params;
+    uint8_t* pointers = (uint8_t*)(snapshot + 1);
+    uint8_t* values = pointers + pointer_count * sizeof(void*);
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->type_def = token;
+    snapshot->param_count = counts.params;
+    if (1 != md_get_column_value_as_constant(type_def, mdtTypeDef_Flags, 1, &snapshot->flags)
+        || 1 != md_get_column_value_as_utf8(type_def, mdtTypeDef_TypeNamespace, 1, &snapshot->type_namespace)
+        || 1 != md_get_column_value_as_utf8(type_def, mdtTypeDef_TypeName, 1, &snapshot->type_name)
+        || 1 != md_get_column_value_as_token(type_def, mdtTypeDef_Extends, 1, &snapshot->extends)
+        || !read_class_layout(cxt, token, snapshot)
+        || !read_fields(cxt, &fields, snapshot, &pointers, &values)
+        || !read_methods(&methods, snapshot, &pointers, &values)
+        || !read_generic_params(generic_params, counts.generic_params, snapshot, &pointers, &values)
+        || !read_interface_impls(interface_impls, counts.interface_impls, snapshot, &values))
+    {
+        return false;
+    }
+
+    assert(values == (uint8_t*)snapshot + *required_size);
+    return true;
+}
+
+bool md_get_type_def_snapshot(mdcursor_t type_def, md_type_def_snapshot_t* snapshot, size_t* buffer_len)
+{
+    if (buffer_len == NULL)
+        return false;
+
+    size_t required_size;
+    if (!get_type_def_snapshot(type_def, snapshot, *buffer_len, &required_size))
+    {
+        *buffer_len = 0;
+        return false;
+    }
+
+    bool written = snapshot != NULL && *buffer_len >= required_size;
+    *buffer_len = required_size;
+    return written;
+}
@@ -86,6 +86,8 @@ static int32_t set_column_value_as_token_or_cursor(mdcursor_t c, uint32_t col_id
         }
 
 #ifdef DNMD_PORTABLE_PDB
+        // Only PDB tables size their references to type system tables by the row counts in the #Pdb stream.
+        if (acxt.table->table_id >= mdtid_FirstPdb)
         {
             uint32_t table_row = RidFromToken(token);
             mdtable_id_t table_id = ExtractTokenType(token);
@@ -322,6 +324,19 @@ int32_t set_column_value_as_heap_offset(mdcursor_t c, col_index_t col_idx, uint3
     return written;
 }
 
+// Adding an entry to a heap can widen the columns that refer to the heap, which moves the table's rows.
+// If that happened, map the row being written again so the value lands in the table's current data.
+static bool remap_after_heap_add(mdcursor_t c, col_index_t col_idx, uint32_t in_length, int32_t written, access_cxt_t* acxt)
+{
+    if (acxt->table->row_size_bytes == acxt->next_row_stride + acxt->data_len_col)
+        return true;
+
+    mdcursor_t row = c;
+    if (!md_cursor_move(&row, written))
+        return false;
+    return create_access_context(&row, col_idx, in_length - (uint32_t)written, true, acxt);
+}
+
 int32_t md_set_column_value_as_utf8(mdcursor_t c, col_index_t col_idx, uint32_t in_length, char const* const* str)
 {
     if (in_length == 0)
@@ -348,6 +363,9 @@ int32_t md_set_column_value_as_utf8(mdcursor_t c, col_index_t col_idx, uint32_t
         if (heap_offset == 0 && str[written][0] != '\0')
             return -1;
 
+        if (!remap_after_heap_add(c, col_idx, in_length, written, &acxt))
+            return -1;
+
         if (!write_column_data(&acxt, heap_offset))
             return -1;
         written++;
@@ -381,6 +399,9 @@ int32_t md_set_column_value_as_blob(mdcursor_t c, col_index_t col_idx, uint32_t
         if (heap_offset == 0 && blob_len[written] != 0)
             return -1;
 
+        if (!remap_after_heap_add(c, col_idx, in_length, written, &acxt))
+            return -1;
+
         if (!write_column_data(&acxt, heap_offset))
             return -1;
         written++;
@@ -414,6 +435,9 @@ int32_t md_set_column_value_as_guid(mdcursor_t c, col_index_t col_idx, uint32_t
         if (index == 0 && memcmp(&guid[written], &empty_guid, sizeof(mdguid_t)) != 0)
             return -1;
 
+        if (!remap_after_heap_add(c, col_idx, in_length, written, &acxt))
+            return -1;
+
         if (!write_column_data(&acxt, index))
             return -1;
         written++;
@@ -447,6 +471,9 @@ int32_t md_set_column_value_as_userstring(mdcursor_t c, col_index_t col_idx, uin
         if (index == 0 && userstring[written][0] != 0)
             return -1;
 
+        if (!remap_after_heap_add(c, col_idx, in_length, written, &acxt))
+            return -1;
+
         if (!write_column_data(&acxt, index))
             return -1;
         written++;
@@ -727,6 +754,23 @@ static bool add_new_row_to_list(mdcursor_t list_owner, col_index_t list_col, mdc
             // Otherwise, this element would be associated with the entry before the parent row.
             if (!md_set_column_value_as_cursor(list_owner, list_col, 1, &new_indirection_row))
                 return false;
+
+            // Rows before the parent with empty lists pointed at the same row as the parent.
+            // Inserting the new row moved them one past it, so we need to point them back at it,
+            // otherwise the list will be inconsistent.
+            mdcursor_t parent_row = list_owner;
+            while (md_cursor_move(&parent_row, -1))
+            {
+                mdcursor_t prev_cursor_value;
+                if (1 != md_get_column_value_as_cursor(parent_row, list_col, 1, &prev_cursor_value))
+                    return false;
+
+                if (CursorRow(&prev_cursor_value) != CursorRow(&new_indirection_row) + 1)
+                    break;
+
+                if (1 != md_set_column_value_as_cursor(parent_row, list_col, 1, &new_indirection_row))
+                    return false;
+            }
         }
 
         md_commit_row_add(new_indirection_row);
@@ -792,12 +836,31 @@ static bool add_new_row_to_list(mdcursor_t list_owner, col_index_t list_col, mdc
     // We need to change our "row to insert before" cursor to point at the indirection table.
     // Because we just created the indirection table, then we know that each row in the target table corresponds to the same row index
     // in the indirection table.
-    row_to_insert_before = create_cursor(&target_table->cxt->tables[indirect_table], CursorRow(&range));
+    row_to_insert_before = create_cursor(&target_table->cxt->tables[indirect_table], CursorRow(&row_to_insert_before));
 
     // Now, we can call back into ourselves to do the actual insert.
     return add_new_row_to_list(list_owner, list_col, row_to_insert_before, new_row);
 }
 
+// Allocate the table that a list column points into.
+static bool allocate_new_list_table(mdcursor_t list_owner, col_index_t list_col, mdtable_id_t table_id)
+{
+    mdtable_t* owner_table = CursorTable(&list_owner);
+    if (!allocate_new_table(owner_table->cxt, table_id))
+        return false;
+
+    // The owners were added before the table existed, so their list columns don't point into it.
+    // Their lists are all empty, so point every owner at the end of the new table. Otherwise, adding
+    // to the list of one owner would leave the owners after it with invalid lists.
+    mdcursor_t owner = create_cursor(owner_table, 1);
+    for (uint32_t i = 0; i < owner_table->row_count; ++i, (void)md_cursor_next(&owner))
+    {
+        if (!set_column_as_end_of_table_cursor(owner, list_col))
+            return false;
+    }
+    return true;
+}
+
 bool md_add_new_row_to_list(mdcursor_t list_owner, col_index_t list_col, mdcursor_t* new_row)
 {
     if (!col_points_to_list(&list_owner, list_col))
@@ -813,7 +876,7 @@ bool md_add_new_row_to_list(mdcursor_t list_owner, col_index_t list_col, mdcurso
     if (CursorTable(&existing_range)->cxt == NULL)
     {
         // If we don't have a table to add the row to, create one.
-        if (!allocate_new_table(CursorTable(&list_owner)->cxt, CursorTable(&existing_range)->table_id))
+        if (!allocate_new_list_table(list_owner, list_col, CursorTable(&existing_range)->table_id))
             return false;
 
         // Now that we have a table, we recreate the "existing range" cursor as the one-past-the-end cursor
@@ -844,7 +907,7 @@ bool md_add_new_row_to_sorted_list(mdcursor_t list_owner, col_index_t list_col,
     if (CursorTable(&existing_range)->cxt == NULL)
     {
         // If we don't have a table to add the row to, create one.
-        if (!allocate_new_table(CursorTable(&list_owner)->cxt, CursorTable(&existing_range)->table_id))
+        if (!allocate_new_list_table(list_owner, list_col, CursorTable(&existing_range)->table_id))
             return false;
 
         // Now that we have a table, we recreate the "existing range" cursor as the one-past-the-end cursor
@@ -974,6 +1037,7 @@ void md_commit_row_add(mdcursor_t row)
         table->is_sorted = validate_row_sorted_within_table(row);
     }
 
+    update_ref_index_for_committed_row(row);
     table->is_adding_new_row = false;
 }
 
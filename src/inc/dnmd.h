@@ -56,6 +56,18 @@ mdhandle_t md_create_new_pdb_handle();
 // Apply delta data to the current metadata.
 bool md_apply_delta(mdhandle_t handle, mdhandle_t delta_handle);
 
+// Create a read-only snapshot of the current state of the metadata.
+//
+// The snapshot shares all table and heap memory with the source handle.
+// Later edits to the source handle copy any shared memory before modifying it,
+// so they are not observed through the snapshot. This permits the snapshot to be
+// read on other threads while the source handle is edited.
+// Edits through the snapshot handle fail. A snapshot cannot be created while a row is being added.
+// The snapshot must be destroyed with md_destroy_handle, which may be done before or after
+// the source handle is destroyed. The data the source handle was created with must remain
+// available until the snapshot has been destroyed.
+bool md_snapshot_handle(mdhandle_t handle, mdhandle_t* snapshot);
+
 // Destroy the metadata handle and free all associated memory.
 void md_destroy_handle(mdhandle_t handle);
 
@@ -68,6 +80,11 @@ bool md_dump_tables(mdhandle_t handle, int32_t table_id);
 
 char const* md_get_version_string(mdhandle_t handle);
 
+// Get a value that changes each time the metadata is edited.
+// Data computed from the metadata can be cached alongside the
+// revision it was computed at to detect when it is stale.
+uint64_t md_get_revision(mdhandle_t handle);
+
 //
 // All tables possible in ECMA-335
 //
@@ -139,6 +156,11 @@ typedef enum
 #endif // DNMD_PORTABLE_PDB
 } mdtable_id_t;
 
+// Get a value that changes each time an existing row of the table is edited or moved.
+// Unlike md_get_revision(), appending rows to the table doesn't change it, so data
+// that only depends on the existing rows of a table can be kept while rows are added.
+uint64_t md_get_table_revision(mdhandle_t handle, mdtable_id_t table_id);
+
 // Table cursor definition
 typedef struct mdcursor__
 {
@@ -465,6 +487,69 @@ int32_t md_get_column_value_as_guid(mdcursor_t c, col_index_t col_idx, uint32_t
 // and should be preferred whenever possible.
 bool md_get_column_values_raw(mdcursor_t c, uint32_t values_length, bool* values_to_get, uint32_t* values_raw);
 
+// Physical layout of the tables and heaps - II.24.2.
+// These APIs are intended for tools that read rows in their stored form, for example to dump tables.
+// Edits can change the layout of a table, for example when an index column grows from 2 to 4 bytes,
+// so layouts should be queried again after the metadata is edited - see md_get_revision().
+typedef enum
+{
+    mdhid_String,
+    mdhid_Guid,
+    mdhid_Blob,
+    mdhid_UserString,
+} md_heap_id_t;
+
+typedef enum
+{
+    mdck_Constant,
+    mdck_TableIndex,
+    mdck_CodedIndex,
+    mdck_HeapIndex,
+} md_column_kind_t;
+
+typedef struct md_column_layout__
+{
+    md_column_kind_t kind;
+    uint8_t offset; // Byte offset of the column in the row.
+    uint8_t size; // 2 or 4 bytes.
+    union
+    {
+        mdtable_id_t table; // mdck_TableIndex
+        uint32_t coded_index; // mdck_CodedIndex - see md_get_coded_index_tables().
+        md_heap_id_t heap; // mdck_HeapIndex
+    } target;
+} md_column_layout_t;
+
+typedef struct md_table_layout__
+{
+    uint32_t row_count;
+    uint8_t row_size;
+    uint8_t column_count;
+    int32_t key_column; // The column the table is sorted by, or -1 if the table has no key.
+} md_table_layout_t;
+
+// Get the layout of the table. Tables without rows are described with the layout their first row would have.
+// Table IDs that are reserved by the specification are described as tables without columns.
+bool md_get_table_layout(mdhandle_t handle, mdtable_id_t table_id, md_table_layout_t* layout);
+bool md_get_column_layout(mdhandle_t handle, mdtable_id_t table_id, col_index_t col_idx, md_column_layout_t* layout);
+
+// Get the tables a kind of coded index refers to, ordered by tag - II.24.2.6.
+// Tags that don't refer to a table are mdtid_Unused.
+// Returns the number of tags, or -1 if the kind of coded index is unknown.
+int32_t md_get_coded_index_tables(uint32_t coded_index, mdtable_id_t const** tables);
+
+// Get the stored data of a row (1-based) of the table, laid out as described by md_get_column_layout().
+// Rows of edited tables aren't stored contiguously, so only the supplied row may be read through the pointer.
+bool md_get_row_raw(mdhandle_t handle, mdtable_id_t table_id, uint32_t row, uint8_t const** data);
+
+// Get the data of the heap. Heaps that aren't present are empty.
+bool md_get_heap(mdhandle_t handle, md_heap_id_t heap_id, uint8_t const** data, uint32_t* size);
+
+// Get the metadata, starting at the metadata root (II.24.2.1), that the handle was created with.
+// Returns false if the metadata has been edited, or the handle wasn't created from an image.
+// See md_write_to_buffer() for getting the image of edited metadata.
+bool md_get_original_image(mdhandle_t handle, uint8_t const** data, size_t* data_len);
+
 // Find a row or range of rows where the supplied column has the expected value.
 // These APIs assume the value to look for is the value in the table, typically record IDs (RID)
 // for tokens. An exception is made for coded indices, which are cumbersome to compute.
@@ -481,6 +566,25 @@ typedef enum
 
 md_range_result_t md_find_range_from_cursor(mdcursor_t begin, col_index_t idx, uint32_t value, mdcursor_t* start, uint32_t* count);
 
+// Scan forward from the cursor for rows where the supplied column has the expected value.
+// Unlike the find APIs above, the table does not need to be sorted and the value for
+// any index column (table or coded) is a token. The value is composed into its raw
+// form once and compared directly against the column data.
+// Up to out_length matching cursors are written and the cursor is advanced past the last row
+// examined, so repeated calls continue the scan. Returns the number of matches written,
+// 0 when the end of the table is reached, or -1 on invalid arguments.
+int32_t md_scan_column_equals(mdcursor_t* c, col_index_t idx, uint32_t value, uint32_t out_length, mdcursor_t* matches);
+
+// Find references by the columns that identify them.
+// The table is hash indexed on first use. Rows added to the end of the table are added to the index
+// as they are committed, so adding references and finding them in turn doesn't rebuild the index.
+// Find the first TypeRef row with the supplied resolution scope, namespace and name.
+bool md_find_type_ref(mdhandle_t handle, mdToken resolution_scope, char const* type_namespace, char const* type_name, mdcursor_t* type_ref);
+// Find the AssemblyRef rows with the supplied name and culture, in row order.
+// Up to out_length matching cursors are written. Returns the number of matching rows,
+// which can be larger than out_length, or -1 on invalid arguments.
+int32_t md_find_assembly_refs(mdhandle_t handle, char const* name, char const* culture, uint32_t out_length, mdcursor_t* assembly_refs);
+
 // Given a value into a supported table, find the associated parent token.
 //  - mdtid_Field
 //  - mdtid_MethodDef
@@ -495,6 +599,197 @@ bool md_find_cursor_of_range_element(mdcursor_t element, mdcursor_t* cursor);
 // Returns true if the cursor was not an indirect cursor or if the indirection was resolved, or false if the cursor pointed to an invalid indirection table entry.
 bool md_resolve_indirect_cursor(mdcursor_t c, mdcursor_t* target);
 
+// A TypeDef and its members, read by iterating the member lists and the sorted tables keyed by the type.
+// The members of each kind are described by parallel arrays, in member list order:
+// element i of each of a kind's arrays describes the same member.
+// Names and signatures point into the heaps and are valid until the metadata is edited.
+typedef struct md_type_def_snapshot__
+{
+    mdToken type_def;
+    uint32_t flags;
+    char const* type_namespace;
+    char const* type_name;
+    mdToken extends;
+
+    // II.22.8 - both are 0 if the type has no ClassLayout row.
+    bool has_class_layout;
+    uint32_t packing_size;
+    uint32_t class_size;
+
+    uint32_t field_count;
+    mdToken const* field_tokens;
+    uint32_t const* field_flags;
+    char const* const* field_names;
+    uint8_t const* const* field_signatures;
+    uint32_t const* field_signature_lengths;
+    uint32_t const* field_rvas; // 0 if the field has no FieldRva row.
+    uint32_t const* field_offsets; // UINT32_MAX if the field has no FieldLayout row.
+
+    uint32_t method_count;
+    mdToken const* method_tokens;
+    uint32_t const* method_flags;
+    uint32_t const* method_impl_flags;
+    uint32_t const* method_rvas;
+    char const* const* method_names;
+    uint8_t const* const* method_signatures;
+    uint32_t const* method_signature_lengths;
+    uint32_t const* method_first_params; // Index of the method's first parameter in the param arrays.
+    uint32_t const* method_param_counts;
+
+    // The parameters of all methods, grouped by method.
+    uint32_t param_count;
+    mdToken const* param_tokens;
+    uint32_t const* param_flags;
+    uint32_t const* param_sequences;
+    char const* const* param_names;
+
+    uint32_t generic_param_count;
+    mdToken const* generic_param_tokens;
+    uint32_t const* generic_param_numbers;
+    uint32_t const* generic_param_flags;
+    char const* const* generic_param_names;
+
+    uint32_t interface_impl_count;
+    mdToken const* interface_impl_tokens;
+    mdToken const* interface_impl_interfaces; // TypeDef, TypeRef or TypeSpec
+} md_type_def_snapshot_t;
+
+// Write a snapshot of the TypeDef to the supplied buffer. The arrays are stored in the buffer after the snapshot.
+// If the buffer is too small, false is returned and buffer_len is set to the required size.
+// If the snapshot can't be read for any other reason, false is returned and buffer_len is set to 0.
+bool md_get_type_def_snapshot(mdcursor_t type_def, md_type_def_snapshot_t* snapshot, size_t* buffer_len);
+
+// Methods to parse blob formats, see dnmd_pdb.h for the Portable PDB specific formats.
+typedef enum md_blob_parse_result__
+{
+    mdbpr_Success,
+    mdbpr_InvalidBlob,
+    mdbpr_InvalidArgument,
+    mdbpr_InsufficientBuffer,
+    mdbpr_OutOfMemory,
+    mdbpr_UnresolvedEnum // A custom attribute value has an enum whose underlying type isn't known.
+} md_blob_parse_result_t;
+
+// An argument of a parsed custom attribute value.
+typedef struct md_custom_attribute_arg__
+{
+    enum
+    {
+        mdcak_FixedArgument,
+        mdcak_Field,
+        mdcak_Property,
+        mdcak_ArrayElement
+    } kind;
+    uint8_t type_code; // SERIALIZATION_TYPE_* - see CorSerializationType in corhdr.h
+    uint8_t element_type_code; // For arrays, the SERIALIZATION_TYPE_* of the elements.
+    uint8_t underlying_type_code; // For enums and arrays of enums, the ELEMENT_TYPE_* of the underlying integer type.
+    bool boxed; // The value was serialized as a tagged object.
+    bool is_null; // A null string, System.Type or array.
+
+    char const* name; // Name of a field or property argument.
+    uint32_t name_len;
+
+    mdToken enum_type; // Enum type declared by the constructor signature, otherwise nil.
+    char const* enum_type_name; // Enum type name serialized in the blob, otherwise NULL.
+    uint32_t enum_type_name_len;
+
+    union
+    {
+        uint64_t integer; // Booleans, characters, integers and enums. Signed values are sign-extended.
+        float r4;
+        double r8;
+        struct
+        {
+            char const* str;
+            uint32_t len;
+        } string; // Strings and System.Type names.
+        uint32_t element_count; // Arrays.
+    } value;
+} md_custom_attribute_arg_t;
+
+typedef struct md_custom_attribute_value__
+{
+    uint32_t fixed_arg_count;
+    uint32_t named_arg_count;
+    uint32_t arg_count; // Includes array elements.
+    md_custom_attribute_arg_t args[];
+} md_custom_attribute_value_t;
+
+// Resolve the underlying type of an enum that isn't defined in the metadata, such as one in another assembly.
+// The enum is either the TypeRef in the constructor signature, or nil if it is only named in the blob.
+// Names are in the format of Type.GetType() and are not null-terminated.
+// Returns false if the enum can't be resolved, otherwise underlying_type is set to the ELEMENT_TYPE_* of its integer type.
+typedef bool (*md_enum_resolver_t)(void* context, mdToken enum_type, char const* enum_type_name, uint32_t enum_type_name_len, uint8_t* underlying_type);
+
+// Parse a custom attribute value blob - ECMA-335 II.23.3.
+// The arguments are written to a flat array: the fixed arguments in constructor order, then the named arguments.
+// An array argument is followed by an entry for each of its elements.
+// Strings, System.Type names and enum type names point into the blob and are not null-terminated.
+// The parsed constructor signature is cached on the handle until the metadata is edited.
+// The size of an enum value depends on its underlying type, so enums that aren't defined in the metadata are
+// resolved with the optional enum_resolver. If an enum can't be resolved, mdbpr_UnresolvedEnum is returned.
+md_blob_parse_result_t md_parse_custom_attribute_value(mdhandle_t handle, mdcursor_t ctor, uint8_t const* blob, size_t blob_len, md_enum_resolver_t enum_resolver, void* enum_resolver_context, md_custom_attribute_value_t* value, size_t* buffer_len);
+
+// Decoded signatures - ECMA-335 II.23.2
+typedef struct md_signature__ md_signature_t;
+typedef struct md_signature_type__ md_signature_type_t;
+
+typedef struct md_array_shape__
+{
+    uint32_t rank;
+    uint32_t size_count;
+    uint32_t const* sizes;
+    uint32_t lower_bound_count;
+    int32_t const* lower_bounds;
+} md_array_shape_t;
+
+// A type in a decoded signature.
+// Custom modifiers, BYREF and PINNED are represented as types that wrap the type they apply to.
+struct md_signature_type__
+{
+    uint8_t element_type; // ELEMENT_TYPE_* - see CorElementType in corhdr.h
+    union
+    {
+        mdToken token; // CLASS and VALUETYPE
+        uint32_t generic_param_index; // VAR and MVAR
+        md_signature_type_t const* type; // PTR, BYREF, SZARRAY and PINNED
+        md_signature_t const* method; // FNPTR
+        struct
+        {
+            mdToken token;
+            md_signature_type_t const* type;
+        } modifier; // CMOD_REQD and CMOD_OPT
+        struct
+        {
+            md_signature_type_t const* type;
+            md_array_shape_t const* shape;
+        } array; // ARRAY
+        struct
+        {
+            md_signature_type_t const* type;
+            uint32_t arg_count;
+            md_signature_type_t const* args;
+        } generic_inst; // GENERICINST
+    } data;
+};
+
+// A decoded MethodDefSig, MethodRefSig, StandAloneMethodSig, FieldSig, PropertySig, LocalVarSig or MethodSpec.
+struct md_signature__
+{
+    uint8_t calling_convention; // IMAGE_CEE_CS_CALLCONV_* - see CorCallingConvention in corhdr.h
+    uint32_t generic_param_count;
+    uint32_t param_count; // Parameters, locals or generic arguments.
+    uint32_t vararg_index; // Index of the first parameter after the SENTINEL, otherwise param_count.
+    md_signature_type_t const* return_type; // Return type or field type, otherwise NULL.
+    md_signature_type_t const* params;
+};
+
+// Decode a signature in the blob heap, for example as returned by md_get_column_value_as_blob().
+// Decoded signatures are cached on the handle by blob heap offset until the metadata is edited,
+// so inspecting a signature more than once doesn't decode it again.
+// Signatures that aren't in the handle's blob heap are rejected with mdbpr_InvalidArgument.
+md_blob_parse_result_t md_get_signature(mdhandle_t handle, uint8_t const* sig, size_t sig_len, md_signature_t const** signature);
+
 // Set row's column values
 // The returned number represents the number of rows updated.
 int32_t md_set_column_value_as_token(mdcursor_t c, col_index_t col, uint32_t in_length, mdToken const* tk);
@@ -543,8 +838,14 @@ void md_commit_row_add(mdcursor_t row);
 // Add a user string to the #US heap.
 mduserstringcursor_t md_add_userstring_to_heap(mdhandle_t handle, char16_t const* userstring);
 
+// Compute the layout of the image for the metadata represented by the handle
+// and return the buffer size required to write it.
+// The layout is reused by md_write_to_buffer as long as the metadata isn't modified in between.
+bool md_prepare_write(mdhandle_t handle, size_t* len);
+
 // Write the metadata represented by the handle to the supplied buffer.
 // The metadata is always written with the v2.0 table schema.
+// If the buffer is too small, false is returned and len is set to the required size.
 bool md_write_to_buffer(mdhandle_t handle, uint8_t* buffer, size_t* len);
 #ifdef __cplusplus
 }
@@ -2,6 +2,7 @@
 #define _SRC_INC_DNMD_HPP_
 
 #include "dnmd.h"
+#include "dnmd_pe.h"
 #include <memory>
 
 struct mdhandle_deleter_t final
@@ -16,6 +17,18 @@ struct mdhandle_deleter_t final
 // C++ lifetime wrapper for mdhandle_t type
 using mdhandle_ptr = std::unique_ptr<mdhandle_t, mdhandle_deleter_t>;
 
+struct mdpe_deleter_t final
+{
+    using pointer = mdpe_t;
+    void operator()(mdpe_t pe)
+    {
+        ::md_pe_close(pe);
+    }
+};
+
+// C++ lifetime wrapper for mdpe_t type
+using mdpe_ptr = std::unique_ptr<mdpe_t, mdpe_deleter_t>;
+
 struct md_added_row_t final
 {
 private:
@@ -1,6 +1,9 @@
 #ifndef _INC_DNMD_INTERFACES_HPP_
 #define _INC_DNMD_INTERFACES_HPP_
 
+#include <cstdint>
+#include <cstdio>
+
 #ifndef DNMD_EXPORT
 #define DNMD_EXPORT
 #endif // !DNMD_EXPORT
@@ -21,4 +24,190 @@ HRESULT GetSymBinder(
     REFGUID riid,
     void** ppObj);
 
+// IMetaDataDispenserEx option that selects how objects created with MDThreadSafetyOn
+// synchronize readers with writers. The value is a VT_UI4 DNMDThreadSafetyStrategy.
+//
+//  MetaDataDNMDThreadSafetyStrategy  - {6C5E1F7A-3B8D-4E29-9D0F-52A4C7B1E863}
+EXTERN_GUID(MetaDataDNMDThreadSafetyStrategy, 0x6c5e1f7a, 0x3b8d, 0x4e29, 0x9d, 0x0f, 0x52, 0xa4, 0xc7, 0xb1, 0xe8, 0x63);
+
+enum DNMDThreadSafetyStrategy
+{
+    // Readers and writers share a read-write lock. This is the default.
+    DNMDThreadSafetyLock = 0,
+    // Writers publish read-only snapshots of the metadata that readers use without taking a lock.
+    // Enumerators read from the snapshot that was current when the enumeration started.
+    DNMDThreadSafetySnapshot = 1,
+};
+
+// IMetaDataDispenserEx option that enables per-method statistics on objects created with MDThreadSafetyOn.
+// The value is a VT_UI4 where a non-zero value enables collection. Collection is disabled by default.
+// The statistics are exposed through IDNMDStatistics on the created object.
+//
+//  MetaDataDNMDCollectStatistics  - {3F0B8A62-5C1D-4E7B-A4E9-0D6C2B71F5A8}
+EXTERN_GUID(MetaDataDNMDCollectStatistics, 0x3f0b8a62, 0x5c1d, 0x4e7b, 0xa4, 0xe9, 0x0d, 0x6c, 0x2b, 0x71, 0xf5, 0xa8);
+
+// Histogram buckets are powers of 4 starting at 256 nanoseconds.
+// Bucket i counts durations less than 256 << (2 * i) nanoseconds and the last bucket counts all longer durations.
+#define DNMD_STATISTICS_HISTOGRAM_BUCKETS 8
+
+struct DNMDMethodStatistics
+{
+    // The name of the interface method.
+    char const* Name;
+    uint64_t CallCount;
+    // The number of calls that couldn't take the lock immediately.
+    // For readers, this counts the calls that were blocked by a writer.
+    // With DNMDThreadSafetySnapshot, this counts the reads that had to publish a new snapshot.
+    uint64_t BlockedCount;
+    uint64_t LockWaitNanoseconds;
+    uint64_t LockHoldNanoseconds;
+    uint64_t LockWaitHistogram[DNMD_STATISTICS_HISTOGRAM_BUCKETS];
+    uint64_t LockHoldHistogram[DNMD_STATISTICS_HISTOGRAM_BUCKETS];
+};
+
+//  IDNMDStatistics  - {9A41D3C8-7E26-4B50-8F1A-C35E9D0B6724}
+EXTERN_GUID(IID_IDNMDStatistics, 0x9a41d3c8, 0x7e26, 0x4b50, 0x8f, 0x1a, 0xc3, 0x5e, 0x9d, 0x0b, 0x67, 0x24);
+
+struct IDNMDStatistics : IUnknown
+{
+    // Get the number of methods that statistics are collected for.
+    STDMETHOD_(ULONG, GetMethodCount)() = 0;
+
+    // Get the statistics collected for a method since creation or the last reset.
+    STDMETHOD(GetMethodStatistics)(ULONG index, DNMDMethodStatistics* pStatistics) = 0;
+
+    STDMETHOD(ResetStatistics)() = 0;
+};
+
+// Read-only access to the names in a metadata scope as the UTF-8 strings they are stored as.
+// The methods mirror the IMetaDataImport methods of the same name, but return pointers into the #Strings
+// heap instead of copying names into UTF-16 buffers and find by UTF-8 names, so no strings are converted.
+// Type names are split into the namespace and name they are stored as.
+// The returned strings are valid until the scope is modified or released.
+// Objects created with MDThreadSafetyOn don't support this interface.
+//
+//  IDNMDImportUtf8  - {5B8A2E17-94C3-4F6D-B0A1-7E3D29C6F480}
+EXTERN_GUID(IID_IDNMDImportUtf8, 0x5b8a2e17, 0x94c3, 0x4f6d, 0xb0, 0xa1, 0x7e, 0x3d, 0x29, 0xc6, 0xf4, 0x80);
+
+// See dnmd.h
+typedef struct md_type_def_snapshot__ md_type_def_snapshot_t;
+
+struct IDNMDImportUtf8 : IUnknown
+{
+    STDMETHOD(GetScopeProps)(
+        char const** pszName,
+        GUID* pmvid) = 0;
+
+    STDMETHOD(GetTypeDefProps)(
+        mdTypeDef td,
+        char const** pszNamespace,
+        char const** pszName,
+        DWORD* pdwTypeDefFlags,
+        mdToken* ptkExtends) = 0;
+
+    STDMETHOD(GetTypeRefProps)(
+        mdTypeRef tr,
+        mdToken* ptkResolutionScope,
+        char const** pszNamespace,
+        char const** pszName) = 0;
+
+    STDMETHOD(GetMethodProps)(
+        mdMethodDef mb,
+        mdTypeDef* pClass,
+        char const** pszMethod,
+        DWORD* pdwAttr,
+        PCCOR_SIGNATURE* ppvSigBlob,
+        ULONG* pcbSigBlob,
+        ULONG* pulCodeRVA,
+        DWORD* pdwImplFlags) = 0;
+
+    STDMETHOD(GetFieldProps)(
+        mdFieldDef mb,
+        mdTypeDef* pClass,
+        char const** pszField,
+        DWORD* pdwAttr,
+        PCCOR_SIGNATURE* ppvSigBlob,
+        ULONG* pcbSigBlob,
+        DWORD* pdwCPlusTypeFlag,
+        UVCP_CONSTANT* ppValue,
+        ULONG* pcchValue) = 0;
+
+    STDMETHOD(GetParamProps)(
+        mdParamDef tk,
+        mdMethodDef* pmd,
+        ULONG* pulSequence,
+        char const** pszName,
+        DWORD* pdwAttr,
+        DWORD* pdwCPlusTypeFlag,
+        UVCP_CONSTANT* ppValue,
+        ULONG* pcchValue) = 0;
+
+    STDMETHOD(GetMemberRefProps)(
+        mdMemberRef mr,
+        mdToken* ptk,
+        char const** pszMember,
+        PCCOR_SIGNATURE* ppvSigBlob,
+        ULONG* pbSig) = 0;
+
+    STDMETHOD(GetModuleRefProps)(
+        mdModuleRef mur,
+        char const** pszName) = 0;
+
+    STDMETHOD(FindTypeDefByName)(
+        char const* szNamespace,
+        char const* szName,
+        mdToken tkEnclosingClass,
+        mdTypeDef* ptd) = 0;
+
+    STDMETHOD(FindTypeRef)(
+        mdToken tkResolutionScope,
+        char const* szNamespace,
+        char const* szName,
+        mdTypeRef* ptr) = 0;
+
+    STDMETHOD(FindMethod)(
+        mdTypeDef td,
+        char const* szName,
+        PCCOR_SIGNATURE pvSigBlob,
+        ULONG cbSigBlob,
+        mdMethodDef* pmb) = 0;
+
+    STDMETHOD(FindField)(
+        mdTypeDef td,
+        char const* szName,
+        PCCOR_SIGNATURE pvSigBlob,
+        ULONG cbSigBlob,
+        mdFieldDef* pmb) = 0;
+
+    STDMETHOD(FindMemberRef)(
+        mdToken td,
+        char const* szName,
+        PCCOR_SIGNATURE pvSigBlob,
+        ULONG cbSigBlob,
+        mdMemberRef* pmr) = 0;
+
+    // The name is the full name of the attribute type, with its namespace.
+    STDMETHOD(GetCustomAttributeByName)(
+        mdToken tkObj,
+        char const* szName,
+        void const** ppData,
+        ULONG* pcbData) = 0;
+
+    // Get the type and all of its members in one call - see md_get_type_def_snapshot() in dnmd.h.
+    // The snapshot and its arrays are written to the buffer. If the buffer is too small,
+    // E_NOT_SUFFICIENT_BUFFER is returned and *pcbSnapshot is set to the required size.
+    STDMETHOD(GetTypeDefSnapshot)(
+        mdTypeDef td,
+        md_type_def_snapshot_t* pSnapshot,
+        ULONG cbSnapshot,
+        ULONG* pcbSnapshot) = 0;
+};
+
+// Write the statistics of the methods that have been called to the stream as CSV.
+// The object must support IDNMDStatistics.
+extern "C" DNMD_EXPORT
+HRESULT DumpStatistics(
+    IUnknown* pMetaData,
+    FILE* stream);
+
 #endif // _INC_DNMD_INTERFACES_HPP_
@@ -7,20 +7,26 @@
 extern "C" {
 #endif
 
+// Get the entry point of the #Pdb stream, or 0 if the PDB doesn't define one.
+// Returns false if the handle isn't for a Portable PDB.
+bool md_get_pdb_entry_point(mdhandle_t handle, mdToken* entry_point);
+
 // Methods to parse specialized blob formats defined in the Portable PDB spec.
 // https://github.com/dotnet/runtime/blob/main/docs/design/specs/PortablePdb-Metadata.md
 
-typedef enum md_blob_parse_result__
-{
-    mdbpr_Success,
-    mdbpr_InvalidBlob,
-    mdbpr_InvalidArgument,
-    mdbpr_InsufficientBuffer
-} md_blob_parse_result_t;
-
 // Parse a DocumentName blob into a UTF-8 string.
 md_blob_parse_result_t md_parse_document_name(mdhandle_t handle, uint8_t const* blob, size_t blob_len, char const* name, size_t* name_len);
 
+// Get the decoded name of a Document row.
+// Names are decoded on first use and cached on the handle.
+// The name is valid until the handle is edited or destroyed.
+bool md_get_document_name(mdcursor_t document, char const** name);
+
+// Find the Document row with the given name.
+// All names are decoded and indexed by hash on the first lookup, so later lookups are O(1).
+// If ignore_case is true, ASCII letters are compared case-insensitively and the first matching row is returned.
+bool md_find_document(mdhandle_t handle, char const* name, bool ignore_case, mdcursor_t* document);
+
 // Parse a SequencePoints blob.
 typedef struct md_sequence_points__
 {
@@ -58,6 +64,79 @@ typedef struct md_sequence_points__
 } md_sequence_points_t;
 md_blob_parse_result_t md_parse_sequence_points(mdcursor_t method_debug_information, uint8_t const* blob, size_t blob_len, md_sequence_points_t* sequence_points, size_t* buffer_len);
 
+// The line of hidden sequence points, as reported by System.Reflection.Metadata.
+#define MD_HIDDEN_SEQUENCE_POINT_LINE 0xfeefee
+
+// A sequence point with an absolute IL offset and source span.
+typedef struct md_sequence_point__
+{
+    uint32_t il_offset;
+    mdcursor_t document;
+    // Hidden sequence points have no source span.
+    // Their lines are MD_HIDDEN_SEQUENCE_POINT_LINE and their columns are 0.
+    bool hidden;
+    uint32_t start_line;
+    uint32_t start_column;
+    uint32_t end_line;
+    uint32_t end_column;
+} md_sequence_point_t;
+
+// Read a SequencePoints blob one sequence point at a time, without allocating.
+// The fields are the reader's state and shouldn't be used directly.
+typedef struct md_sequence_point_reader__
+{
+    uint8_t const* blob;
+    size_t blob_len;
+    mdToken signature;
+    mdcursor_t document;
+    uint32_t il_offset;
+    uint32_t start_line;
+    uint32_t start_column;
+    bool first_record;
+    bool seen_non_hidden;
+    bool invalid;
+} md_sequence_point_reader_t;
+md_blob_parse_result_t md_init_sequence_point_reader(mdcursor_t method_debug_information, uint8_t const* blob, size_t blob_len, md_sequence_point_reader_t* reader);
+
+// Read the next sequence point in IL offset order. Document records are applied to the following points.
+// Returns false at the end of the blob or if the blob is malformed, in which case the reader's invalid field is set.
+bool md_read_sequence_point(md_sequence_point_reader_t* reader, md_sequence_point_t* point);
+
+// Find the sequence point of an IL offset in the method with the MethodDef token.
+// This is the last non-hidden sequence point at or before the offset, as used for stack traces.
+// The decoded sequence points of recently used methods are cached with the handle.
+bool md_find_sequence_point(mdhandle_t handle, mdToken method_def, uint32_t il_offset, md_sequence_point_t* point);
+
+// Find the methods whose non-hidden sequence points in a document span a line, for binding breakpoints.
+// A method spans the lines from the first start line to the last end line of its points in the document.
+// The methods are returned as MethodDef tokens, ordered by the first line of their points.
+// The index of the methods in each document is built on first use and kept with the handle.
+// If methods is NULL, method_count is set to the number of methods.
+// If the method_count is too small, method_count is set to the required count and false is returned.
+bool md_find_methods_for_document_line(mdhandle_t handle, mdcursor_t document, uint32_t line, mdToken* methods, uint32_t* method_count);
+
+// A LocalScope row with its variable and constant lists.
+typedef struct md_local_scope__
+{
+    mdcursor_t scope;
+    mdcursor_t import_scope;
+    uint32_t start_offset;
+    uint32_t length;
+    // The LocalVariable and LocalConstant rows of the scope are contiguous from the first row.
+    // The lists of nested scopes are not included.
+    mdcursor_t variables;
+    uint32_t variable_count;
+    mdcursor_t constants;
+    uint32_t constant_count;
+} md_local_scope_t;
+
+// Get the LocalScopes of the method with the MethodDef token that contain an IL offset, from innermost to outermost.
+// The nesting of the scopes is computed on first use and kept with the handle.
+// The LocalScope table must be sorted, which it may not be after edits.
+// If scopes is NULL, scope_count is set to the number of scopes.
+// If the scope_count is too small, scope_count is set to the required count and false is returned.
+bool md_get_local_scopes_at_offset(mdhandle_t handle, mdToken method_def, uint32_t il_offset, md_local_scope_t* scopes, uint32_t* scope_count);
+
 // Parse a LocalConstantSig blob.
 typedef struct md_local_constant_sig__
 {
@@ -0,0 +1,124 @@
+#ifndef _SRC_INC_DNMD_PE_H_
+#define _SRC_INC_DNMD_PE_H_
+
+#include <dnmd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Methods to read the PE envelope of a CLI image - II.25.
+// The image is parsed in place. No part of it is copied and all integers
+// are read as little-endian.
+
+typedef struct mdpe__* mdpe_t;
+
+typedef enum
+{
+    // The image as it is stored on disk. RVAs are translated through the section table.
+    mdpe_layout_flat,
+    // The image as it is mapped by a loader. Sections are at their RVAs.
+    mdpe_layout_mapped,
+} mdpe_layout_t;
+
+// Parse the headers of a PE image.
+//
+// The image is expected to be unmoved and available until the PE and
+// all handles created from it have been destroyed.
+// Images without a CLI header can be opened, but have no metadata.
+bool md_pe_open(void const* image, size_t image_len, mdpe_layout_t layout, mdpe_t* pe);
+
+// Release the PE. Metadata handles created from the PE keep it alive until they are destroyed.
+void md_pe_close(mdpe_t pe);
+
+typedef struct md_pe_info__
+{
+    // IMAGE_FILE_HEADER.Machine - II.25.2.2
+    uint16_t machine;
+    // The optional header is in the PE32+ format - II.25.2.3.
+    bool is_pe32_plus;
+    // The image has a CLI header - II.25.3.3.
+    // The remaining fields are zero if it doesn't.
+    bool has_cli_header;
+    uint16_t major_runtime_version;
+    uint16_t minor_runtime_version;
+    // COMIMAGE_FLAGS_* values.
+    uint32_t cli_flags;
+    mdToken entry_point;
+} md_pe_info_t;
+
+bool md_pe_get_info(mdpe_t pe, md_pe_info_t* info);
+
+// Get an entry of the optional header data directories - II.25.2.3.3.
+// An entry the image doesn't define has an RVA and size of zero.
+bool md_pe_get_directory(mdpe_t pe, uint32_t index, uint32_t* rva, uint32_t* size);
+
+// Translate an RVA into a pointer to the section data at that RVA.
+// Returns NULL if the RVA isn't backed by data in the image, otherwise
+// available is set to the number of bytes that can be read from the pointer.
+// This is O(log n) in the number of sections.
+uint8_t const* md_pe_rva_to_data(mdpe_t pe, uint32_t rva, size_t* available);
+
+// Get the metadata the CLI header points at.
+bool md_pe_get_metadata(mdpe_t pe, void const** data, size_t* data_len);
+
+// Create a metadata handle for the metadata in a PE image.
+// The handle takes a reference on the PE, which can be retrieved with md_get_pe().
+bool md_create_handle_from_pe(mdpe_t pe, mdhandle_t* handle);
+
+// Get the PE the handle was created from, or NULL if it wasn't created from a PE.
+// The PE is owned by the handle and is available until the handle is destroyed.
+mdpe_t md_get_pe(mdhandle_t handle);
+
+// Method bodies - II.25.4
+// All pointers are into the PE image.
+typedef struct md_method_body__
+{
+    mdToken method;
+    uint32_t rva;
+    // CorILMethodFlags of a fat header, or CorILMethod_TinyFormat.
+    uint16_t flags;
+    uint16_t max_stack;
+    // The StandAloneSig of the locals, or 0 if there are none.
+    mdToken local_var_sig;
+    uint8_t const* il;
+    uint32_t il_size;
+    uint32_t exception_clause_count;
+    // Data sections following the IL - II.25.4.5.
+    uint8_t const* sections;
+    size_t sections_len;
+} md_method_body_t;
+
+// Exception handling clause - II.25.4.6
+// Small and fat clauses are both widened to this form.
+typedef struct md_exception_clause__
+{
+    // CorExceptionFlag values.
+    uint32_t flags;
+    uint32_t try_offset;
+    uint32_t try_length;
+    uint32_t handler_offset;
+    uint32_t handler_length;
+    uint32_t class_token_or_filter_offset;
+} md_exception_clause_t;
+
+// Read the body of a method in a handle created from a PE.
+// Returns false if the method has no IL body (its RVA is 0 or it's implemented in native code) or the body is malformed.
+bool md_get_method_body(mdcursor_t method_def, md_method_body_t* body);
+
+// Decode the exception handling clauses of a method body.
+// If clauses is NULL, clause_count is set to the number of clauses.
+// If the clause_count is too small, clause_count is set to the required count and false is returned.
+bool md_get_exception_clauses(md_method_body_t const* body, md_exception_clause_t* clauses, uint32_t* clause_count);
+
+// Read the bodies of all methods in a handle created from a PE, ordered by RVA.
+// Methods without an IL body are skipped. Visiting the bodies in RVA order reads the image sequentially.
+// If bodies is NULL, body_count is set to the number of methods with a body.
+// If the body_count is too small, body_count is set to the required count and false is returned.
+bool md_get_method_bodies(mdhandle_t handle, md_method_body_t* bodies, uint32_t* body_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SRC_INC_DNMD_PE_H_
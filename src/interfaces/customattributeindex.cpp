@@ -0,0 +1,219 @@
+#include "customattributeindex.hpp"
+#include "namehash.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+
+#define RETURN_IF_FAILED(exp) \
+{ \
+    hr = (exp); \
+    if (FAILED(hr)) \
+    { \
+        return hr; \
+    } \
+}
+
+namespace
+{
+    // See TypeSpec definition at II.23.2.14
+    HRESULT ExtractTypeDefRefFromSpec(uint8_t const* specBlob, uint32_t specBlobLen, mdToken& tk)
+    {
+        assert(specBlob != nullptr);
+        if (specBlobLen == 0)
+            return COR_E_BADIMAGEFORMAT;
+
+        PCCOR_SIGNATURE sig = specBlob;
+        PCCOR_SIGNATURE sigEnd = specBlob + specBlobLen;
+
+        ULONG data;
+        sig += CorSigUncompressData(sig, &data);
+
+        while (sig < sigEnd
+            && (CorIsModifierElementType((CorElementType)data)
+                || data == ELEMENT_TYPE_GENERICINST))
+        {
+            sig += CorSigUncompressData(sig, &data);
+        }
+
+        if (sig >= sigEnd)
+            return COR_E_BADIMAGEFORMAT;
+
+        if (data == ELEMENT_TYPE_VALUETYPE || data == ELEMENT_TYPE_CLASS)
+        {
+            if (mdTokenNil == CorSigUncompressToken(sig, &tk))
+                return COR_E_BADIMAGEFORMAT;
+            return S_OK;
+        }
+
+        tk = mdTokenNil;
+        return S_FALSE;
+    }
+
+    HRESULT ResolveTypeDefRefSpecToName(mdcursor_t cursor, char const** nspace, char const** name)
+    {
+        assert(nspace != nullptr && name != nullptr);
+
+        HRESULT hr;
+        mdToken typeTk;
+        if (!md_cursor_to_token(cursor, &typeTk))
+            return E_FAIL;
+
+        uint8_t const* specBlob;
+        uint32_t specBlobLen;
+        uint32_t tokenType = TypeFromToken(typeTk);
+        while (tokenType == mdtTypeSpec)
+        {
+            if (1 != md_get_column_value_as_blob(cursor, mdtTypeSpec_Signature, 1, &specBlob, &specBlobLen))
+                return CLDB_E_FILE_CORRUPT;
+
+            RETURN_IF_FAILED(ExtractTypeDefRefFromSpec(specBlob, specBlobLen, typeTk));
+            if (typeTk == mdTokenNil)
+                return S_FALSE;
+
+            if (!md_token_to_cursor(md_extract_handle_from_cursor(cursor), typeTk, &cursor))
+                return CLDB_E_FILE_CORRUPT;
+            tokenType = TypeFromToken(typeTk);
+        }
+
+        switch (tokenType)
+        {
+        case mdtTypeDef:
+            return (1 == md_get_column_value_as_utf8(cursor, mdtTypeDef_TypeNamespace, 1, nspace)
+                && 1 == md_get_column_value_as_utf8(cursor, mdtTypeDef_TypeName, 1, name))
+                ? S_OK
+                : CLDB_E_FILE_CORRUPT;
+        case mdtTypeRef:
+            return (1 == md_get_column_value_as_utf8(cursor, mdtTypeRef_TypeNamespace, 1, nspace)
+                && 1 == md_get_column_value_as_utf8(cursor, mdtTypeRef_TypeName, 1, name))
+                ? S_OK
+                : CLDB_E_FILE_CORRUPT;
+        default:
+            assert(!"Unexpected token in ResolveTypeDefRefSpecToName");
+            return E_FAIL;
+        }
+    }
+
+    uint32_t HashTypeName(char const* nspace, char const* name)
+    {
+        uint32_t hash = NameHashSeed;
+        if (nspace[0] != '\0')
+        {
+            hash = HashName(hash, nspace);
+            hash = HashName(hash, ".");
+        }
+        return HashName(hash, name);
+    }
+
+    bool EntryLessThan(CustomAttributeIndex::Entry const& lhs, CustomAttributeIndex::Entry const& rhs)
+    {
+        if (lhs.NameHash != rhs.NameHash)
+            return lhs.NameHash < rhs.NameHash;
+        if (lhs.Parent != rhs.Parent)
+            return lhs.Parent < rhs.Parent;
+        return lhs.CustomAttribute < rhs.CustomAttribute;
+    }
+}
+
+HRESULT ResolveCustomAttributeTypeName(mdcursor_t customAttribute, char const** nspace, char const** name)
+{
+    assert(nspace != nullptr && name != nullptr);
+
+    mdcursor_t type;
+    if (1 != md_get_column_value_as_cursor(customAttribute, mdtCustomAttribute_Type, 1, &type))
+        return CLDB_E_FILE_CORRUPT;
+
+    // Cursor was returned so must be valid.
+    mdToken typeTk;
+    (void)md_cursor_to_token(type, &typeTk);
+
+    // Resolve the constructor to its declaring type.
+    mdcursor_t tgtType;
+    switch (TypeFromToken(typeTk))
+    {
+    case mdtMethodDef:
+        if (!md_find_cursor_of_range_element(type, &tgtType))
+            return CLDB_E_FILE_CORRUPT;
+        break;
+    case mdtMemberRef:
+        if (1 != md_get_column_value_as_cursor(type, mdtMemberRef_Class, 1, &tgtType))
+            return CLDB_E_FILE_CORRUPT;
+        break;
+    default:
+        assert(!"Unexpected token in ResolveCustomAttributeTypeName");
+        return COR_E_BADIMAGEFORMAT;
+    }
+
+    return ResolveTypeDefRefSpecToName(tgtType, nspace, name);
+}
+
+bool IsTypeNameMatch(char const* fullName, char const* nspace, char const* name)
+{
+    assert(fullName != nullptr && nspace != nullptr && name != nullptr);
+    if (nspace[0] != '\0')
+    {
+        size_t len = ::strlen(nspace);
+        if (0 != ::strncmp(fullName, nspace, len))
+            return false;
+
+        // The namespace matched, so the full name is at least as long.
+        if (fullName[len] != '.')
+            return false;
+        fullName += len + 1;
+    }
+
+    return 0 == ::strcmp(fullName, name);
+}
+
+HRESULT CustomAttributeIndex::Create(mdhandle_t handle, std::unique_ptr<CustomAttributeIndex>& index)
+{
+    std::unique_ptr<CustomAttributeIndex> newIndex{ new CustomAttributeIndex{} };
+
+    mdcursor_t cursor;
+    uint32_t count;
+    if (!md_create_cursor(handle, mdtid_CustomAttribute, &cursor, &count))
+    {
+        // No custom attributes, so the index is empty.
+        index = std::move(newIndex);
+        return S_OK;
+    }
+
+    HRESULT hr;
+    newIndex->_entries.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Entry entry;
+        if (1 != md_get_column_value_as_token(cursor, mdtCustomAttribute_Parent, 1, &entry.Parent))
+            return CLDB_E_FILE_CORRUPT;
+
+        char const* nspace;
+        char const* name;
+        RETURN_IF_FAILED(ResolveCustomAttributeTypeName(cursor, &nspace, &name));
+
+        // Attributes whose type has no name can never be found by name.
+        if (hr == S_OK)
+        {
+            (void)md_cursor_to_token(cursor, &entry.CustomAttribute);
+            entry.NameHash = HashTypeName(nspace, name);
+            newIndex->_entries.push_back(entry);
+        }
+        (void)md_cursor_next(&cursor);
+    }
+
+    std::sort(newIndex->_entries.begin(), newIndex->_entries.end(), EntryLessThan);
+    index = std::move(newIndex);
+    return S_OK;
+}
+
+span<CustomAttributeIndex::Entry const> CustomAttributeIndex::Find(char const* fullName, mdToken parent) const noexcept
+{
+    assert(fullName != nullptr);
+
+    // Search for the range of entries with the hash and parent.
+    Entry first{ HashName(fullName), parent, 0 };
+    Entry last{ first.NameHash, parent, UINT32_MAX };
+    auto begin = std::lower_bound(_entries.begin(), _entries.end(), first, EntryLessThan);
+    auto end = std::upper_bound(begin, _entries.end(), last, EntryLessThan);
+    return { _entries.data() + (begin - _entries.begin()), (size_t)(end - begin) };
+}
@@ -0,0 +1,47 @@
+#ifndef _SRC_INTERFACES_CUSTOMATTRIBUTEINDEX_HPP_
+#define _SRC_INTERFACES_CUSTOMATTRIBUTEINDEX_HPP_
+
+#include <internal/dnmd_platform.hpp>
+#include <internal/span.hpp>
+
+#include <external/cor.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Resolve the namespace and name of the type that declares a custom attribute's constructor.
+// Returns S_FALSE if the type doesn't have a name, for example a TypeSpec of a non-class type.
+HRESULT ResolveCustomAttributeTypeName(mdcursor_t customAttribute, char const** nspace, char const** name);
+
+// Check if a namespace and name pair match the supplied full type name.
+bool IsTypeNameMatch(char const* fullName, char const* nspace, char const* name);
+
+// Index of the CustomAttribute table keyed by the full name of each attribute's type.
+// The index is built in a single pass over the table and makes finding the
+// attributes of a given type on a given parent a hash lookup.
+class CustomAttributeIndex final
+{
+public:
+    struct Entry final
+    {
+        uint32_t NameHash;
+        mdToken Parent;
+        mdCustomAttribute CustomAttribute;
+    };
+
+private:
+    // Sorted by name hash, then parent, then custom attribute.
+    std::vector<Entry> _entries;
+
+public:
+    static HRESULT Create(mdhandle_t handle, std::unique_ptr<CustomAttributeIndex>& index);
+
+    // Find the custom attributes on the parent whose type's full name has the same hash as the supplied name.
+    // The parent must match exactly, so a nil parent doesn't find the attributes of every parent.
+    // The attributes are returned in token order.
+    // Different names can share a hash, so callers must confirm the name of each attribute.
+    span<Entry const> Find(char const* fullName, mdToken parent) const noexcept;
+};
+
+#endif // _SRC_INTERFACES_CUSTOMATTRIBUTEINDEX_HPP_
@@ -11,6 +11,7 @@
 #include "controllingiunknown.hpp"
 #include "metadataimportro.hpp"
 #include "metadataemit.hpp"
+#include "metadatatables.hpp"
 #include "threadsafe.hpp"
 
 #include <cstring>
@@ -19,12 +20,18 @@ namespace
 {
     class MDDispenser final : public TearOffBase<IMetaDataDispenserEx>
     {
-        bool _threadSafe;
+        bool _threadSafe = false;
+        DNMDThreadSafetyStrategy _threadSafetyStrategy = DNMDThreadSafetyLock;
+        bool _collectStatistics = false;
     private:
         dncp::com_ptr<ControllingIUnknown> CreateExposedObject(dncp::com_ptr<ControllingIUnknown> unknown, DNMDOwner* owner)
         {
             mdhandle_view handle_view{ owner };
             MetadataEmit* emit = unknown->CreateAndAddTearOff<MetadataEmit>(handle_view);
+            // IMetaDataTables returns pointers into the tables and heaps, which can't be guarded by a lock,
+            // so it's only created for objects that aren't thread-safe.
+            if (!_threadSafe)
+                (void)unknown->CreateAndAddTearOff<MetadataTables>(handle_view);
             MetadataImportRO* import = unknown->CreateAndAddTearOff<MetadataImportRO>(std::move(handle_view));
             if (!_threadSafe)
             {
@@ -35,7 +42,10 @@ namespace
             
             // Define an IDNMDOwner* tear-off here so the thread-safe object can be identified as a DNMD object.
             (void)threadSafeUnknown->CreateAndAddTearOff<DelegatingDNMDOwner>(handle_view);
-            (void)threadSafeUnknown->CreateAndAddTearOff<ThreadSafeImportEmit<MetadataImportRO, MetadataEmit>>(std::move(unknown), import, emit);
+            ThreadSafeStatistics* statistics = nullptr;
+            if (_collectStatistics)
+                statistics = threadSafeUnknown->CreateAndAddTearOff<ThreadSafeStatistics>();
+            (void)threadSafeUnknown->CreateAndAddTearOff<ThreadSafeImportEmit<MetadataImportRO, MetadataEmit>>(std::move(unknown), import, emit, _threadSafetyStrategy, statistics);
             // ThreadSafeImportEmit took ownership of owner through unknown.
             return threadSafeUnknown;
         }
@@ -142,9 +152,20 @@ namespace
                 pData = ::memcpy(copiedMem.get(), pData, cbData);
             }
 
+            // The data is either a PE image or the metadata itself.
+            // A handle created from a PE image keeps it, so the PE envelope can be queried.
             mdhandle_t mdhandle;
-            if (!md_create_handle(pData, cbData, &mdhandle))
+            mdpe_t pe;
+            if (md_pe_open(pData, cbData, mdpe_layout_flat, &pe))
+            {
+                mdpe_ptr pe_ptr{ pe };
+                if (!md_create_handle_from_pe(pe, &mdhandle))
+                    return CLDB_E_FILE_CORRUPT;
+            }
+            else if (!md_create_handle(pData, cbData, &mdhandle))
+            {
                 return CLDB_E_FILE_CORRUPT;
+            }
 
             mdhandle_ptr md_ptr{ mdhandle };
 
@@ -161,6 +182,7 @@ namespace
                 if (dwOpenFlags & ofReadOnly)
                 {
                     // If we're read-only, then we don't need to deal with thread safety.
+                    (void)obj->CreateAndAddTearOff<MetadataTables>(handle_view);
                     (void)obj->CreateAndAddTearOff<MetadataImportRO>(std::move(handle_view));
                     return obj->QueryInterface(riid, (void**)ppIUnk);
                 }
@@ -185,6 +207,18 @@ namespace
                 _threadSafe = V_UI4(value) == CorThreadSafetyOptions::MDThreadSafetyOn;
                 return S_OK;
             }
+            if (optionid == MetaDataDNMDThreadSafetyStrategy)
+            {
+                if (V_UI4(value) != DNMDThreadSafetyLock && V_UI4(value) != DNMDThreadSafetySnapshot)
+                    return E_INVALIDARG;
+                _threadSafetyStrategy = (DNMDThreadSafetyStrategy)V_UI4(value);
+                return S_OK;
+            }
+            if (optionid == MetaDataDNMDCollectStatistics)
+            {
+                _collectStatistics = V_UI4(value) != 0;
+                return S_OK;
+            }
             return E_INVALIDARG;
         }
 
@@ -197,6 +231,16 @@ namespace
                 V_UI4(pvalue) = _threadSafe ? CorThreadSafetyOptions::MDThreadSafetyOn : CorThreadSafetyOptions::MDThreadSafetyOff;
                 return S_OK;
             }
+            if (optionid == MetaDataDNMDThreadSafetyStrategy)
+            {
+                V_UI4(pvalue) = _threadSafetyStrategy;
+                return S_OK;
+            }
+            if (optionid == MetaDataDNMDCollectStatistics)
+            {
+                V_UI4(pvalue) = _collectStatistics ? 1 : 0;
+                return S_OK;
+            }
             return E_INVALIDARG;
         }
 
@@ -1,6 +1,7 @@
 #include "hcorenum.hpp"
 #include <cassert>
 #include <cstring>
+#include <new>
 
 #define RETURN_IF_FAILED(exp) \
 { \
@@ -11,6 +12,32 @@
     } \
 }
 
+namespace
+{
+    // Dynamic enumerators returned to a pool keep their heap storage
+    // unless it has grown beyond this many values.
+    constexpr uint32_t MaxRetainedCapacity = 1024;
+}
+
+struct HCORENUMPoolState final
+{
+    std::atomic<HCORENUMImpl*> Slots[8];
+
+    // One reference for the pool and one for each enumerator that isn't in a slot.
+    std::atomic<uint32_t> RefCount;
+
+    // Set when the pool is destroyed, after which enumerators aren't returned.
+    std::atomic<bool> Closed;
+
+    HCORENUMPoolState() noexcept
+        : RefCount{ 1 }
+        , Closed{ false }
+    {
+        for (std::atomic<HCORENUMImpl*>& slot : Slots)
+            slot.store(nullptr, std::memory_order_relaxed);
+    }
+};
+
 HRESULT HCORENUMImpl::CreateTableEnum(_In_ uint32_t count, _Out_ HCORENUMImpl** impl) noexcept
 {
     assert(impl != nullptr && count > 0);
@@ -25,6 +52,9 @@ HRESULT HCORENUMImpl::CreateTableEnum(_In_ uint32_t count, _Out_ HCORENUMImpl**
 
     enumImpl->_type = HCORENUMType::Table;
     enumImpl->_entrySpan = 1;
+    enumImpl->_pool = nullptr;
+    enumImpl->_heap = nullptr;
+    enumImpl->_heapCapacity = 0;
     enumImpl->_curr = &enumImpl->_data;
     enumImpl->_last = enumImpl->_curr;
 
@@ -78,9 +108,12 @@ HRESULT HCORENUMImpl::CreateDynamicEnum(_Out_ HCORENUMImpl** impl, _In_ uint32_t
     *impl = enumImpl;
 
     enumImpl->_type = HCORENUMType::Dynamic;
-    // The page must be a multiple of the entrySpan for reading to be efficient.
-    assert(ARRAY_SIZE(enumImpl->_data.Dynamic.Page) % entrySpan == 0);
+    // The inline storage must be a multiple of the entrySpan so growth keeps entries whole.
+    assert(ARRAY_SIZE(enumImpl->_data.Dynamic.Inline) % entrySpan == 0);
     enumImpl->_entrySpan = entrySpan;
+    enumImpl->_pool = nullptr;
+    enumImpl->_heap = nullptr;
+    enumImpl->_heapCapacity = 0;
     ::memset(&enumImpl->_data, 0, sizeof(enumImpl->_data));
     enumImpl->_curr = &enumImpl->_data;
     enumImpl->_last = enumImpl->_curr;
@@ -91,42 +124,231 @@ HRESULT HCORENUMImpl::AddToDynamicEnum(_Inout_ HCORENUMImpl& impl, uint32_t valu
 {
     assert(impl._type == HCORENUMType::Dynamic);
 
-    // Check if we have exhausted the last page
-    EnumData* currData = impl._last;
-    if (currData->Total >= ARRAY_SIZE(currData->Dynamic.Page))
+    HRESULT hr;
+    EnumData& data = impl._data;
+    if (data.Total >= impl.DynamicCapacity())
+        RETURN_IF_FAILED(impl.GrowDynamicEnum(data.Total + 1));
+
+    impl.DynamicValues()[data.Total] = value;
+    data.Total++;
+    return S_OK;
+}
+
+HRESULT HCORENUMImpl::ReserveDynamicEnum(_Inout_ HCORENUMImpl& impl, _In_ uint32_t count) noexcept
+{
+    assert(impl._type == HCORENUMType::Dynamic);
+    return impl.GrowDynamicEnum(count);
+}
+
+void HCORENUMImpl::Destroy(_In_ HCORENUMImpl* impl) noexcept
+{
+    assert(impl != nullptr);
+    HCORENUMPoolState* pool = impl->_pool;
+    if (pool == nullptr)
+    {
+        Free(impl);
+        return;
+    }
+
+    if (!HCORENUMPool::Return(pool, impl))
+        Free(impl);
+    HCORENUMPool::Release(pool);
+}
+
+void HCORENUMImpl::Free(_In_ HCORENUMImpl* impl) noexcept
+{
+    assert(impl != nullptr);
+    ::free(impl->_heap);
+    ::free(impl);
+}
+
+uint32_t* HCORENUMImpl::DynamicValues() noexcept
+{
+    assert(_type == HCORENUMType::Dynamic);
+    return _heap != nullptr ? _heap : _data.Dynamic.Inline;
+}
+
+uint32_t HCORENUMImpl::DynamicCapacity() const noexcept
+{
+    assert(_type == HCORENUMType::Dynamic);
+    return _heap != nullptr ? _heapCapacity : (uint32_t)ARRAY_SIZE(_data.Dynamic.Inline);
+}
+
+HRESULT HCORENUMImpl::GrowDynamicEnum(_In_ uint32_t capacity) noexcept
+{
+    uint32_t currCapacity = DynamicCapacity();
+    if (capacity <= currCapacity)
+        return S_OK;
+
+    // Grow geometrically so repeated additions are amortized constant time.
+    uint32_t newCapacity = currCapacity * 2 > capacity ? currCapacity * 2 : capacity;
+    if (newCapacity < capacity || newCapacity > UINT32_MAX / sizeof(uint32_t))
+        return E_OUTOFMEMORY;
+
+    uint32_t* newHeap;
+    if (_heap != nullptr)
+    {
+        newHeap = (uint32_t*)::realloc(_heap, newCapacity * sizeof(uint32_t));
+        if (newHeap == nullptr)
+            return E_OUTOFMEMORY;
+    }
+    else
     {
-        EnumData* newData = (EnumData*)::malloc(sizeof(EnumData));
-        if (newData == nullptr)
+        newHeap = (uint32_t*)::malloc(newCapacity * sizeof(uint32_t));
+        if (newHeap == nullptr)
             return E_OUTOFMEMORY;
+        ::memcpy(newHeap, _data.Dynamic.Inline, _data.Total * sizeof(uint32_t));
+    }
+
+    _heap = newHeap;
+    _heapCapacity = newCapacity;
+    return S_OK;
+}
+
+HCORENUMPool::HCORENUMPool() noexcept
+    : _state{ new (std::nothrow) HCORENUMPoolState{} }
+{
+    // If the free list can't be allocated, enumerators just aren't pooled.
+}
+
+HCORENUMPool::~HCORENUMPool()
+{
+    if (_state == nullptr)
+        return;
 
-        ::memset(newData, 0, sizeof(*newData));
-        assert(currData->Next == nullptr);
-        currData->Next = newData;
-        impl._last = newData;
-        currData = impl._last;
+    _state->Closed.store(true, std::memory_order_release);
+    for (std::atomic<HCORENUMImpl*>& slot : _state->Slots)
+    {
+        HCORENUMImpl* impl = slot.exchange(nullptr, std::memory_order_acquire);
+        if (impl != nullptr)
+            HCORENUMImpl::Free(impl);
     }
-    currData->Dynamic.Page[currData->Total] = value;
-    currData->Total++;
+    Release(_state);
+}
+
+HRESULT HCORENUMPool::CreateTableEnum(_In_ uint32_t count, _Out_ HCORENUMImpl** impl) noexcept
+{
+    assert(impl != nullptr && count > 0);
+
+    // Only enumerators with a single table fit in a pooled allocation.
+    if (count != 1)
+        return HCORENUMImpl::CreateTableEnum(count, impl);
+
+    HCORENUMImpl* enumImpl = Take();
+    if (enumImpl == nullptr)
+    {
+        HRESULT hr;
+        RETURN_IF_FAILED(HCORENUMImpl::CreateTableEnum(count, &enumImpl));
+        if (_state != nullptr)
+        {
+            _state->RefCount.fetch_add(1, std::memory_order_relaxed);
+            enumImpl->_pool = _state;
+        }
+        *impl = enumImpl;
+        return S_OK;
+    }
+
+    enumImpl->_type = HCORENUMType::Table;
+    enumImpl->_entrySpan = 1;
+    enumImpl->_data.Next = nullptr;
+    enumImpl->_curr = &enumImpl->_data;
+    enumImpl->_last = enumImpl->_curr;
+    *impl = enumImpl;
     return S_OK;
 }
 
-void HCORENUMImpl::Destroy(_In_ HCORENUMImpl* impl) noexcept
+HRESULT HCORENUMPool::CreateDynamicEnum(_Out_ HCORENUMImpl** impl, _In_ uint32_t entrySpan) noexcept
 {
-    assert(impl != nullptr);
-    if (impl->_type == HCORENUMType::Dynamic)
+    assert(impl != nullptr && entrySpan > 0);
+
+    HCORENUMImpl* enumImpl = Take();
+    if (enumImpl == nullptr)
     {
-        // Delete all allocated pages.
-        EnumData* tmp;
-        EnumData* toDelete = impl->_data.Next;
-        while (toDelete != nullptr)
+        HRESULT hr;
+        RETURN_IF_FAILED(HCORENUMImpl::CreateDynamicEnum(&enumImpl, entrySpan));
+        if (_state != nullptr)
         {
-            tmp = toDelete->Next;
-            ::free(toDelete);
-            toDelete = tmp;
+            _state->RefCount.fetch_add(1, std::memory_order_relaxed);
+            enumImpl->_pool = _state;
         }
+        *impl = enumImpl;
+        return S_OK;
     }
 
-    ::free(impl);
+    // Any retained heap storage is reused as-is.
+    enumImpl->_type = HCORENUMType::Dynamic;
+    assert(ARRAY_SIZE(enumImpl->_data.Dynamic.Inline) % entrySpan == 0);
+    assert(enumImpl->_heap == nullptr || enumImpl->_heapCapacity % entrySpan == 0);
+    enumImpl->_entrySpan = entrySpan;
+    ::memset(&enumImpl->_data, 0, sizeof(enumImpl->_data));
+    enumImpl->_curr = &enumImpl->_data;
+    enumImpl->_last = enumImpl->_curr;
+    *impl = enumImpl;
+    return S_OK;
+}
+
+HCORENUMImpl* HCORENUMPool::Take() noexcept
+{
+    if (_state == nullptr)
+        return nullptr;
+
+    for (std::atomic<HCORENUMImpl*>& slot : _state->Slots)
+    {
+        // Cheap check to avoid contending on empty slots.
+        if (slot.load(std::memory_order_relaxed) == nullptr)
+            continue;
+
+        HCORENUMImpl* impl = slot.exchange(nullptr, std::memory_order_acquire);
+        if (impl != nullptr)
+        {
+            // The enumerator leaves the slot, so it holds a reference again.
+            _state->RefCount.fetch_add(1, std::memory_order_relaxed);
+            return impl;
+        }
+    }
+    return nullptr;
+}
+
+bool HCORENUMPool::Return(_In_ HCORENUMPoolState* state, _In_ HCORENUMImpl* impl) noexcept
+{
+    assert(state != nullptr && impl != nullptr && impl->_pool == state);
+    if (state->Closed.load(std::memory_order_acquire))
+        return false;
+
+    // Don't let a single large enumeration pin its storage.
+    if (impl->_heapCapacity > MaxRetainedCapacity)
+    {
+        ::free(impl->_heap);
+        impl->_heap = nullptr;
+        impl->_heapCapacity = 0;
+    }
+
+    for (std::atomic<HCORENUMImpl*>& slot : state->Slots)
+    {
+        HCORENUMImpl* expected = nullptr;
+        if (slot.load(std::memory_order_relaxed) == nullptr
+            && slot.compare_exchange_strong(expected, impl, std::memory_order_release, std::memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void HCORENUMPool::Release(_In_ HCORENUMPoolState* state) noexcept
+{
+    assert(state != nullptr);
+    if (state->RefCount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+
+    // An enumerator returned while the pool was being destroyed can still be in a slot.
+    for (std::atomic<HCORENUMImpl*>& slot : state->Slots)
+    {
+        HCORENUMImpl* impl = slot.exchange(nullptr, std::memory_order_acquire);
+        if (impl != nullptr)
+            HCORENUMImpl::Free(impl);
+    }
+    delete state;
 }
 
 uint32_t HCORENUMImpl::Count() const noexcept
@@ -178,29 +400,16 @@ HRESULT HCORENUMImpl::ReadTokenPairs(
     assert(rTokens1 != nullptr && rTokens2 != nullptr && pcTokens != nullptr);
     assert(_entrySpan == 2);
 
-    EnumData* currData = _curr;
-    if (currData == nullptr)
-        return S_FALSE;
+    // Dynamic enumerators store all values contiguously.
+    uint32_t const* values = DynamicValues();
+    assert(((_data.Total - _data.ReadIn) % 2) == 0);
 
     uint32_t count = 0;
-    for (uint32_t i = 0; i < cMax; ++i)
+    for (; count < cMax && _data.ReadIn < _data.Total; ++count)
     {
-        // Check if all values have been read.
-        while (currData->ReadIn == currData->Total)
-        {
-            currData = currData->Next;
-            // Check next link in enumerator list
-            if (currData == nullptr)
-                goto Done;
-            _curr = currData;
-        }
-
-        assert(((currData->Total - currData->ReadIn) % 2) == 0);
-        rTokens1[count] = currData->Dynamic.Page[currData->ReadIn++];
-        rTokens2[count] = currData->Dynamic.Page[currData->ReadIn++];
-        count++;
+        rTokens1[count] = values[_data.ReadIn++];
+        rTokens2[count] = values[_data.ReadIn++];
     }
-Done:
     *pcTokens = count;
     return S_OK;
 }
@@ -232,7 +441,7 @@ HRESULT HCORENUMImpl::ReadOneToken(mdToken& rToken, uint32_t& count) noexcept
     }
     else
     {
-        rToken = currData->Dynamic.Page[currData->ReadIn];
+        rToken = DynamicValues()[currData->ReadIn];
     }
 
     currData->ReadIn++;
@@ -290,28 +499,11 @@ HRESULT HCORENUMImpl::ReadDynamicTokens(
     assert(_type == HCORENUMType::Dynamic);
     assert(rTokens != nullptr);
 
-    EnumData* currData = _curr;
-    if (currData == nullptr)
-        return S_FALSE;
-
-    uint32_t count = 0;
-    for (uint32_t i = 0; i < cMax; ++i)
-    {
-        // Check if all values have been read.
-        while (currData->ReadIn == currData->Total)
-        {
-            currData = currData->Next;
-            // Check next link in enumerator list
-            if (currData == nullptr)
-                goto Done;
-            _curr = currData;
-        }
-
-        rTokens[count] = currData->Dynamic.Page[currData->ReadIn];
-        currData->ReadIn++;
-        count++;
-    }
-Done:
+    // Dynamic enumerators store all values contiguously.
+    uint32_t remaining = _data.Total - _data.ReadIn;
+    uint32_t count = cMax < remaining ? cMax : remaining;
+    ::memcpy(rTokens, DynamicValues() + _data.ReadIn, count * sizeof(mdToken));
+    _data.ReadIn += count;
     tokenCount = count;
     return S_OK;
 }
@@ -364,34 +556,7 @@ HRESULT HCORENUMImpl::ResetDynamicEnum(_In_ uint32_t position) noexcept
 {
     assert(_type == HCORENUMType::Dynamic);
 
-    uint32_t newReadIn;
-    bool reset = false;
-    EnumData* currData = &_data;
-    while (currData != nullptr)
-    {
-        if (reset)
-        {
-            // Reset the enumerator state
-            newReadIn = 0;
-        }
-        else if (position < currData->Total)
-        {
-            newReadIn = position;
-            reset = true;
-
-            // Update the current state of the enumerator
-            _curr = currData;
-        }
-        else
-        {
-            // The current enumerator is consumed based on position
-            position -= currData->Total;
-            newReadIn = currData->Total;
-        }
-
-        currData->ReadIn = newReadIn;
-        currData = currData->Next;
-    }
-
+    // Positions past the end leave the enumerator consumed.
+    _data.ReadIn = position < _data.Total ? position : _data.Total;
     return S_OK;
 }
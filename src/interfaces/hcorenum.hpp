@@ -3,16 +3,29 @@
 
 #include <internal/dnmd_platform.hpp>
 
+#include <atomic>
+
 enum class HCORENUMType : uint32_t
 {
     Table = 1, Dynamic
 };
 
+class HCORENUMPool;
+struct HCORENUMPoolState;
+
 // Represents a singly linked list or dynamic uint32_t array enumerator
 class HCORENUMImpl final
 {
+    friend class HCORENUMPool;
+
     HCORENUMType _type;
     uint32_t _entrySpan; // The number of entries equal to a single unit.
+    HCORENUMPoolState* _pool; // The pool to return to on destruction, if any. Holds a reference.
+
+    // Growable storage for dynamic enumerators once the inline
+    // storage is exhausted. Retained when the enumerator is pooled.
+    uint32_t* _heap;
+    uint32_t _heapCapacity;
 
     struct EnumData final
     {
@@ -28,7 +41,7 @@ class HCORENUMImpl final
             // Enumerate for dynamic uint32_t array
             struct
             {
-                uint32_t Page[16];
+                uint32_t Inline[16];
             } Dynamic;
         };
 
@@ -51,6 +64,10 @@ public: // static
     static HRESULT CreateDynamicEnum(_Out_ HCORENUMImpl** impl, _In_ uint32_t entrySpan = 1) noexcept;
     static HRESULT AddToDynamicEnum(_Inout_ HCORENUMImpl& impl, uint32_t value) noexcept;
 
+    // Ensure the dynamic enumerator can hold at least "count" values
+    // without reallocating. Useful when an upper bound is cheap to compute.
+    static HRESULT ReserveDynamicEnum(_Inout_ HCORENUMImpl& impl, _In_ uint32_t count) noexcept;
+
     static void Destroy(_In_ HCORENUMImpl* impl) noexcept;
 
 public: // instance
@@ -73,6 +90,12 @@ public: // instance
     HRESULT Reset(_In_ ULONG position) noexcept;
 
 private:
+    uint32_t* DynamicValues() noexcept;
+    uint32_t DynamicCapacity() const noexcept;
+    HRESULT GrowDynamicEnum(_In_ uint32_t capacity) noexcept;
+
+    static void Free(_In_ HCORENUMImpl* impl) noexcept;
+
     HRESULT ReadOneToken(mdToken& rToken, uint32_t& count) noexcept;
     HRESULT ReadTableTokens(
         mdToken rTokens[],
@@ -87,6 +110,34 @@ private:
     HRESULT ResetDynamicEnum(_In_ uint32_t position) noexcept;
 };
 
+// A small free list of enumerators owned by an import. Enumerators created
+// from a pool are returned to it when destroyed so steady-state enumeration
+// doesn't allocate. The pool is safe to use from concurrent readers.
+// The free list is reference counted by the pool and its enumerators, so an
+// enumerator can be closed after the pool is destroyed, or through another
+// import. It is then freed instead of being returned.
+class HCORENUMPool final
+{
+    HCORENUMPoolState* _state;
+
+public:
+    HCORENUMPool() noexcept;
+    ~HCORENUMPool();
+
+    HCORENUMPool(HCORENUMPool const&) = delete;
+    HCORENUMPool& operator=(HCORENUMPool const&) = delete;
+
+    // See the HCORENUMImpl functions of the same name.
+    HRESULT CreateTableEnum(_In_ uint32_t count, _Out_ HCORENUMImpl** impl) noexcept;
+    HRESULT CreateDynamicEnum(_Out_ HCORENUMImpl** impl, _In_ uint32_t entrySpan = 1) noexcept;
+
+private:
+    friend class HCORENUMImpl;
+    HCORENUMImpl* Take() noexcept;
+    static bool Return(_In_ HCORENUMPoolState* state, _In_ HCORENUMImpl* impl) noexcept;
+    static void Release(_In_ HCORENUMPoolState* state) noexcept;
+};
+
 struct HCORENUMImplDeleter final
 {
     using pointer = HCORENUMImpl*;
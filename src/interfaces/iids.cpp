@@ -16,9 +16,25 @@ MIDL_DEFINE_GUID(IID_IMetaDataAssemblyImport,0xee62470b,0xe94b,0x424e,0x9b,0x7c,
 MIDL_DEFINE_GUID(IID_IMetaDataEmit, 0xba3fee4c, 0xecb9, 0x4e41, 0x83, 0xb7, 0x18, 0x3f, 0xa4, 0x1c, 0xd8, 0x59);
 MIDL_DEFINE_GUID(IID_IMetaDataEmit2, 0xf5dd9950, 0xf693, 0x42e6, 0x83, 0xe, 0x7b, 0x83, 0x3e, 0x81, 0x46, 0xa9);
 MIDL_DEFINE_GUID(IID_IMetaDataAssemblyEmit, 0x211ef15b, 0x5317, 0x4438, 0xb1, 0x96, 0xde, 0xc8, 0x7b, 0x88, 0x76, 0x93);
+MIDL_DEFINE_GUID(IID_IMetaDataTables, 0xd8f579ab, 0x402d, 0x4b8e, 0x82, 0xd9, 0x5d, 0x63, 0xb1, 0x6, 0x5c, 0x68);
+MIDL_DEFINE_GUID(IID_IMetaDataTables2, 0xbadb5f70, 0x58da, 0x43a9, 0xa1, 0xc6, 0xd7, 0x48, 0x19, 0xf1, 0x9b, 0x15);
 
 // Define the ISymUnmanaged* IIDs here - corsym.h provides the declaration.
 MIDL_DEFINE_GUID(IID_ISymUnmanagedBinder, 0xaa544d42, 0x28cb, 0x11d3, 0xbd, 0x22, 0x00, 0x00, 0xf8, 0x08, 0x49, 0xbd);
+MIDL_DEFINE_GUID(IID_ISymUnmanagedReader, 0xb4ce6286, 0x2a6b, 0x3712, 0xa3, 0xb7, 0x1e, 0xe1, 0xda, 0xd4, 0x67, 0xb5);
+MIDL_DEFINE_GUID(IID_ISymUnmanagedDocument, 0x40de4037, 0x7c81, 0x3e1e, 0xb0, 0x22, 0xae, 0x1a, 0xbf, 0xf2, 0xca, 0x08);
+MIDL_DEFINE_GUID(IID_ISymUnmanagedMethod, 0xb62b923c, 0xb500, 0x3158, 0xa5, 0x43, 0x24, 0xf3, 0x07, 0xa8, 0xb7, 0xe1);
+MIDL_DEFINE_GUID(IID_ISymUnmanagedScope, 0x68005d0f, 0xb8e0, 0x3b01, 0x84, 0xd5, 0xa1, 0x1a, 0x94, 0x15, 0x49, 0x42);
+MIDL_DEFINE_GUID(IID_ISymUnmanagedScope2, 0xae932fba, 0x3fd8, 0x4dba, 0x82, 0x32, 0x30, 0xa2, 0x30, 0x9b, 0x02, 0xdb);
+MIDL_DEFINE_GUID(IID_ISymUnmanagedVariable, 0x9f60eebe, 0x2d9a, 0x3f7c, 0xbf, 0x58, 0x80, 0xbc, 0x99, 0x1c, 0x60, 0xbb);
+MIDL_DEFINE_GUID(IID_ISymUnmanagedConstant, 0x48b25ed8, 0x5bad, 0x41bc, 0x9c, 0xee, 0xcd, 0x62, 0xfa, 0xbc, 0x74, 0xe9);
+MIDL_DEFINE_GUID(IID_ISymUnmanagedNamespace, 0x0dff7289, 0x54f8, 0x11d3, 0xbd, 0x28, 0x00, 0x00, 0xf8, 0x08, 0x49, 0xbd);
+
+// Define the CorSym GUIDs the reader returns - corsym.h provides the declaration.
+MIDL_DEFINE_GUID(CorSym_LanguageType_CSharp, 0x3f5162f8, 0x07c6, 0x11d3, 0x90, 0x53, 0x0, 0xc0, 0x4f, 0xa3, 0x02, 0xa1);
+MIDL_DEFINE_GUID(CorSym_LanguageType_Basic, 0x3a12d0b8, 0xc26c, 0x11d0, 0xb4, 0x42, 0x0, 0xa0, 0x24, 0x4a, 0x1d, 0xd2);
+MIDL_DEFINE_GUID(CorSym_LanguageVendor_Microsoft, 0x994b45c4, 0xe6e9, 0x11d2, 0x90, 0x3f, 0x00, 0xc0, 0x4f, 0xa3, 0x02, 0xa1);
+MIDL_DEFINE_GUID(CorSym_DocumentType_Text, 0x5a869d0b, 0x6611, 0x11d3, 0xbd, 0x2a, 0x0, 0x0, 0xf8, 0x8, 0x49, 0xbd);
 
 // Define option IIDs here - cor.h provides the declaration.
 MIDL_DEFINE_GUID(MetaDataThreadSafetyOptions, 0xf7559806, 0xf266, 0x42ea, 0x8c, 0x63, 0xa, 0xdb, 0x45, 0xe8, 0xb2, 0x34);
@@ -26,3 +42,12 @@ MIDL_DEFINE_GUID(CLSID_CLR_v2_MetaData, 0xefea471a, 0x44fd, 0x4862, 0x92, 0x92,
 
 // Define an IID for our own marker interface
 MIDL_DEFINE_GUID(IID_IDNMDOwner, 0x250ebc02, 0x1a92, 0x4638, 0xaa, 0x6c, 0x3d, 0x0f, 0x98, 0xb3, 0xa6, 0xfb);
+MIDL_DEFINE_GUID(IID_IDNMDSymDocument, 0x7d3c91a4, 0x2f6e, 0x4b18, 0x9a, 0x57, 0xc0, 0x8e, 0x41, 0xd2, 0x6b, 0x93);
+
+// Define the IIDs for our own interfaces - dnmd_interfaces.hpp provides the declaration.
+MIDL_DEFINE_GUID(IID_IDNMDStatistics, 0x9a41d3c8, 0x7e26, 0x4b50, 0x8f, 0x1a, 0xc3, 0x5e, 0x9d, 0x0b, 0x67, 0x24);
+MIDL_DEFINE_GUID(IID_IDNMDImportUtf8, 0x5b8a2e17, 0x94c3, 0x4f6d, 0xb0, 0xa1, 0x7e, 0x3d, 0x29, 0xc6, 0xf4, 0x80);
+
+// Define our own option GUIDs - dnmd_interfaces.hpp provides the declaration.
+MIDL_DEFINE_GUID(MetaDataDNMDThreadSafetyStrategy, 0x6c5e1f7a, 0x3b8d, 0x4e29, 0x9d, 0x0f, 0x52, 0xa4, 0xc7, 0xb1, 0xe8, 0x63);
+MIDL_DEFINE_GUID(MetaDataDNMDCollectStatistics, 0x3f0b8a62, 0x5c1d, 0x4e7b, 0xa4, 0xe9, 0x0d, 0x6c, 0x2b, 0x71, 0xf5, 0xa8);
@@ -7,6 +7,8 @@
 #include <array>
 #include <algorithm>
 #include <cstring>
+#include <type_traits>
+#include <vector>
 
 // Macros from wincrypt.h that we need avaliable on all platforms
 // for strong-name parsing.
@@ -214,6 +216,7 @@ namespace
         if (publicKeyBlob.size() == sizeof(StrongNameKeys::EcmaPublicKey)
             && std::memcmp(publicKeyBlob, StrongNameKeys::EcmaPublicKey, sizeof(StrongNameKeys::EcmaPublicKey)) == 0)
         {
+            strongNameTokenBuffer = StrongNameKeys::EcmaToken;
             return S_OK;
         }
 
@@ -248,6 +251,21 @@ namespace
 
         return S_OK;
     }
+
+    static_assert(std::is_same<StrongNameToken, ImportSession::PublicKeyToken>::value, "The session must be able to store strong name tokens");
+
+    HRESULT StrongNameTokenFromPublicKey(ImportSession* session, span<uint8_t const> publicKeyBlob, StrongNameToken& strongNameTokenBuffer)
+    {
+        if (session != nullptr && session->TryGetPublicKeyToken(publicKeyBlob, strongNameTokenBuffer))
+            return S_OK;
+
+        HRESULT hr;
+        RETURN_IF_FAILED(StrongNameTokenFromPublicKey(publicKeyBlob, strongNameTokenBuffer));
+
+        if (session != nullptr)
+            session->AddPublicKeyToken(publicKeyBlob, strongNameTokenBuffer);
+        return S_OK;
+    }
 }
 
 namespace
@@ -365,6 +383,7 @@ namespace
         char const* name,
         char const* culture,
         span<const uint8_t> publicKeyOrToken,
+        ImportSession* session,
         mdcursor_t* assemblyRef)
     {
         HRESULT hr;
@@ -378,34 +397,40 @@ namespace
         }
 
         // Search the assembly ref table for a matching row.
-        mdcursor_t c;
-        uint32_t count;
-        if (!md_create_cursor(targetModule, mdtid_AssemblyRef, &c, &count))
+        // Only the rows with the same name and culture can match, which the AssemblyRef index finds.
+        std::array<mdcursor_t, 8> candidateBuffer;
+        int32_t candidateCount = md_find_assembly_refs(targetModule, name, culture, (uint32_t)candidateBuffer.size(), candidateBuffer.data());
+        if (candidateCount < 0)
             return E_FAIL;
-        
+
+        span<mdcursor_t> candidates{ candidateBuffer.data(), (size_t)candidateCount };
+        std::vector<mdcursor_t> allCandidates;
+        if ((size_t)candidateCount > candidateBuffer.size())
+        {
+            try
+            {
+                allCandidates.resize((size_t)candidateCount);
+            }
+            catch (std::bad_alloc const&)
+            {
+                return E_OUTOFMEMORY;
+            }
+
+            candidateCount = md_find_assembly_refs(targetModule, name, culture, (uint32_t)allCandidates.size(), allCandidates.data());
+            if (candidateCount < 0)
+                return E_FAIL;
+            candidates = { allCandidates.data(), std::min((size_t)candidateCount, allCandidates.size()) };
+        }
+
         AssemblyVersionMatcher const& matcher = GetAssemblyVersionMatcher(name);
-        
-        for (uint32_t i = 0; i < count; i++, md_cursor_next(&c))
+
+        for (mdcursor_t c : candidates)
         {
-            // Search the table linearly by manually reading the columns.
             hr = matcher.Match(c, majorVersion, minorVersion, buildNumber, revisionNumber);
             RETURN_IF_FAILED(hr);
             if (hr == S_FALSE)
                 continue;
-            
-            char const* tempString;
-            if (1 != md_get_column_value_as_utf8(c, mdtAssemblyRef_Name, 1, &tempString))
-                return CLDB_E_FILE_CORRUPT;
-            
-            if (std::strcmp(tempString, name) != 0)
-                continue;
-            
-            if (1 != md_get_column_value_as_utf8(c, mdtAssemblyRef_Culture, 1, &tempString))
-                return CLDB_E_FILE_CORRUPT;
-            
-            if (std::strcmp(tempString, culture) != 0)
-                continue;
-            
+
             uint8_t const* tempBlob;
             uint32_t tempBlobLength;
             if (1 != md_get_column_value_as_blob(c, mdtAssemblyRef_PublicKeyOrToken, 1, &tempBlob, &tempBlobLength))
@@ -430,12 +455,15 @@ namespace
                     // If the source and destination either both have a full key or both have a key token, we can compare them directly.
                     if (tempBlobLength != publicKeyOrToken.size() || !std::equal(publicKeyOrToken.begin(), publicKeyOrToken.end(), tempBlob))
                         continue;
+
+                    *assemblyRef = c;
+                    return S_OK;
                 }
                 else if (IsAfPublicKey(assemblyRefFlags))
                 {
                     // This AssemblyRef row has a full public key and our source has a token.
                     // We need to get the token from the key.
-                    RETURN_IF_FAILED(StrongNameTokenFromPublicKey({ tempBlob, tempBlobLength }, refPublicKeyToken));
+                    RETURN_IF_FAILED(StrongNameTokenFromPublicKey(session, { tempBlob, tempBlobLength }, refPublicKeyToken));
                 }
                 else
                 {
@@ -443,7 +471,7 @@ namespace
                     // We need to get the token from the key.
                     if (!calculatedPublicKeyToken)
                     {
-                        RETURN_IF_FAILED(StrongNameTokenFromPublicKey(publicKeyOrToken, publicKeyToken));
+                        RETURN_IF_FAILED(StrongNameTokenFromPublicKey(session, publicKeyOrToken, publicKeyToken));
                         calculatedPublicKeyToken = true;
                     }
                 }
@@ -469,6 +497,7 @@ namespace
     HRESULT ImportReferenceToAssemblyRef(
         mdcursor_t sourceAssemblyRef,
         mdhandle_t targetModule,
+        ImportSession* session,
         std::function<void(mdcursor_t)> onRowAdded,
         mdcursor_t* targetAssembly
     )
@@ -517,6 +546,7 @@ namespace
             assemblyName,
             assemblyCulture,
             { publicKey, publicKeyLength },
+            session,
             targetAssembly));
 
         if (hr == S_OK)
@@ -539,7 +569,7 @@ namespace
         if (1 != md_set_column_value_as_constant(assemblyRef, mdtAssemblyRef_BuildNumber, 1, &buildNumber))
             return E_FAIL;
 
-        if (md_set_column_value_as_constant(assemblyRef, mdtAssemblyRef_RevisionNumber, 1, &revisionNumber))
+        if (1 != md_set_column_value_as_constant(assemblyRef, mdtAssemblyRef_RevisionNumber, 1, &revisionNumber))
             return E_FAIL;
 
         if (1 != md_set_column_value_as_constant(assemblyRef, mdtAssemblyRef_Flags, 1, &flags))
@@ -565,13 +595,16 @@ namespace
         mdcursor_t sourceAssemblyRef,
         mdhandle_t targetModule,
         mdhandle_t targetAssembly,
+        ImportSession* session,
         std::function<void(mdcursor_t)> onRowAdded,
         mdcursor_t* assemblyRefInTargetModule)
     {
         HRESULT hr;
+        if (session != nullptr && session->TryGetImported(sourceAssemblyRef, assemblyRefInTargetModule))
+            return S_OK;
         
         // Add a reference to the assembly in the target module.
-        RETURN_IF_FAILED(ImportReferenceToAssemblyRef(sourceAssemblyRef, targetModule, onRowAdded, assemblyRefInTargetModule));
+        RETURN_IF_FAILED(ImportReferenceToAssemblyRef(sourceAssemblyRef, targetModule, session, onRowAdded, assemblyRefInTargetModule));
 
         // Also add a reference to the assembly in the target assembly.
         // In most cases, the target module will be the same as the target assembly, so this will be a no-op.
@@ -580,9 +613,11 @@ namespace
         if (targetModule != targetAssembly)
         {
             mdcursor_t ignored;
-            RETURN_IF_FAILED(ImportReferenceToAssemblyRef(sourceAssemblyRef, targetAssembly, onRowAdded, &ignored));
+            RETURN_IF_FAILED(ImportReferenceToAssemblyRef(sourceAssemblyRef, targetAssembly, session, onRowAdded, &ignored));
         }
 
+        if (session != nullptr)
+            session->AddImported(sourceAssemblyRef, *assemblyRefInTargetModule);
         return S_OK;
     }
 
@@ -590,6 +625,7 @@ namespace
         mdcursor_t sourceAssembly,
         span<const uint8_t> sourceAssemblyHash,
         mdhandle_t targetModule,
+        ImportSession* session,
         std::function<void(mdcursor_t)> onRowAdded,
         mdcursor_t* targetAssembly)
     {
@@ -608,7 +644,7 @@ namespace
         {
             assert(IsAfPublicKey(flags));
             flags &= ~afPublicKey;
-            RETURN_IF_FAILED(StrongNameTokenFromPublicKey({ publicKey, publicKeyLength }, publicKeyToken));
+            RETURN_IF_FAILED(StrongNameTokenFromPublicKey(session, { publicKey, publicKeyLength }, publicKeyToken));
         }
         else
         {
@@ -649,6 +685,7 @@ namespace
             assemblyName,
             assemblyCulture,
             { publicKeyToken.data(), publicKeyToken.size() },
+            session,
             targetAssembly));
 
         if (hr == S_OK)
@@ -671,7 +708,7 @@ namespace
         if (1 != md_set_column_value_as_constant(assemblyRef, mdtAssemblyRef_BuildNumber, 1, &buildNumber))
             return E_FAIL;
 
-        if (md_set_column_value_as_constant(assemblyRef, mdtAssemblyRef_RevisionNumber, 1, &revisionNumber))
+        if (1 != md_set_column_value_as_constant(assemblyRef, mdtAssemblyRef_RevisionNumber, 1, &revisionNumber))
             return E_FAIL;
 
         if (1 != md_set_column_value_as_constant(assemblyRef, mdtAssemblyRef_Flags, 1, &flags))
@@ -705,6 +742,7 @@ namespace
         span<const uint8_t> sourceAssemblyHash,
         mdhandle_t targetModule,
         mdhandle_t targetAssembly,
+        ImportSession* session,
         std::function<void(mdcursor_t)> onRowAdded,
         mdcursor_t* assemblyRefInTargetModule)
     {
@@ -712,9 +750,12 @@ namespace
         mdcursor_t importAssembly;
         if (!md_token_to_cursor(sourceAssembly, TokenFromRid(1, mdtAssembly), &importAssembly))
             return E_FAIL;
+
+        if (session != nullptr && session->TryGetImported(importAssembly, assemblyRefInTargetModule))
+            return S_OK;
         
         // Add a reference to the assembly in the target module.
-        RETURN_IF_FAILED(ImportReferenceToAssembly(importAssembly, sourceAssemblyHash, targetModule, onRowAdded, assemblyRefInTargetModule));
+        RETURN_IF_FAILED(ImportReferenceToAssembly(importAssembly, sourceAssemblyHash, targetModule, session, onRowAdded, assemblyRefInTargetModule));
 
         // Also add a reference to the assembly in the target assembly.
         // In most cases, the target module will be the same as the target assembly, so this will be a no-op.
@@ -723,9 +764,11 @@ namespace
         if (targetModule != targetAssembly)
         {
             mdcursor_t ignored;
-            RETURN_IF_FAILED(ImportReferenceToAssembly(importAssembly, sourceAssemblyHash, targetAssembly, onRowAdded, &ignored));
+            RETURN_IF_FAILED(ImportReferenceToAssembly(importAssembly, sourceAssemblyHash, targetAssembly, session, onRowAdded, &ignored));
         }
 
+        if (session != nullptr)
+            session->AddImported(importAssembly, *assemblyRefInTargetModule);
         return S_OK;
     }
 }
@@ -737,6 +780,7 @@ HRESULT ImportReferenceToTypeDef(
     mdhandle_t targetAssembly,
     mdhandle_t targetModule,
     bool alwaysImport,
+    ImportSession* session,
     std::function<void(mdcursor_t)> onRowAdded,
     mdcursor_t* targetTypeDef)
 {
@@ -755,23 +799,27 @@ HRESULT ImportReferenceToTypeDef(
     bool sameModuleMvid = std::memcmp(&targetModuleMvid, &sourceModuleMvid, sizeof(mdguid_t)) == 0;
     bool sameAssemblyMvid = std::memcmp(&targetAssemblyMvid, &sourceAssemblyMvid, sizeof(mdguid_t)) == 0;
 
+    if (sameAssemblyMvid && sameModuleMvid && !alwaysImport)
+    {
+        // If we don't need to always import the TypeDef,
+        // we can resolve it to an existing TypeDef.
+        mdToken token;
+        if (!md_cursor_to_token(sourceTypeDef, &token))
+            return E_FAIL;
+
+        // All images with the same MVID should have the same metadata tables.
+        if (!md_token_to_cursor(targetModule, token, targetTypeDef))
+            return CLDB_E_FILE_CORRUPT;
+        
+        return S_OK;
+    }
+
+    if (session != nullptr && session->TryGetImported(sourceTypeDef, targetTypeDef))
+        return S_OK;
+
     mdcursor_t resolutionScope;
     if (sameAssemblyMvid && sameModuleMvid)
     {
-        if (!alwaysImport)
-        {
-            // If we don't need to always import the TypeDef,
-            // we can resolve it to an existing TypeDef.
-            mdToken token;
-            if (!md_cursor_to_token(sourceTypeDef, &token))
-                return E_FAIL;
-
-            // All images with the same MVID should have the same metadata tables.
-            if (!md_token_to_cursor(targetModule, token, targetTypeDef))
-                return CLDB_E_FILE_CORRUPT;
-            
-            return S_OK;
-        }
         uint32_t count;
         if (!md_create_cursor(targetModule, mdtid_Module, &resolutionScope, &count))
             return E_FAIL;
@@ -807,35 +855,34 @@ HRESULT ImportReferenceToTypeDef(
     }
     else
     {
-        RETURN_IF_FAILED(ImportReferenceToAssembly(sourceAssembly, sourceAssemblyHash, targetModule, targetAssembly, onRowAdded, &resolutionScope));
+        RETURN_IF_FAILED(ImportReferenceToAssembly(sourceAssembly, sourceAssemblyHash, targetModule, targetAssembly, session, onRowAdded, &resolutionScope));
     }
 
     try
     {
         std::stack<mdcursor_t> typesForTypeRefs;
-
-        mdcursor_t importType;
-        if (!md_token_to_cursor(sourceModule, tdImport, &importType))
-            return CLDB_E_FILE_CORRUPT;
-        
-        typesForTypeRefs.push(importType);
+        typesForTypeRefs.push(sourceTypeDef);
         
+        // The NestedClass table is empty if the source has no nested types.
         mdcursor_t nestedClasses;
         uint32_t nestedClassCount;
-        if (!md_create_cursor(sourceModule, mdtid_NestedClass, &nestedClasses, &nestedClassCount))
-            return E_FAIL;
-        
-        mdToken nestedTypeToken = tdImport;
-        mdcursor_t nestedClass;
-        while (md_find_row_from_cursor(nestedClasses, mdtNestedClass_NestedClass, RidFromToken(nestedTypeToken), &nestedClass))
+        if (md_create_cursor(sourceModule, mdtid_NestedClass, &nestedClasses, &nestedClassCount))
         {
-            mdcursor_t enclosingClass;
-            if (1 != md_get_column_value_as_cursor(nestedClass, mdtNestedClass_EnclosingClass, 1, &enclosingClass))
-                return E_FAIL;
-            
-            typesForTypeRefs.push(enclosingClass);
-            if (!md_cursor_to_token(enclosingClass, &nestedTypeToken))
+            mdToken nestedTypeToken;
+            if (!md_cursor_to_token(sourceTypeDef, &nestedTypeToken))
                 return E_FAIL;
+
+            mdcursor_t nestedClass;
+            while (md_find_row_from_cursor(nestedClasses, mdtNestedClass_NestedClass, RidFromToken(nestedTypeToken), &nestedClass))
+            {
+                mdcursor_t enclosingClass;
+                if (1 != md_get_column_value_as_cursor(nestedClass, mdtNestedClass_EnclosingClass, 1, &enclosingClass))
+                    return E_FAIL;
+                
+                typesForTypeRefs.push(enclosingClass);
+                if (!md_cursor_to_token(enclosingClass, &nestedTypeToken))
+                    return E_FAIL;
+            }
         }
 
         for (; !typesForTypeRefs.empty(); typesForTypeRefs.pop())
@@ -873,6 +920,8 @@ HRESULT ImportReferenceToTypeDef(
         return E_OUTOFMEMORY;
     }
 
+    if (session != nullptr)
+        session->AddImported(sourceTypeDef, *targetTypeDef);
     return S_OK;
 }
 
@@ -909,6 +958,7 @@ namespace
         char const* typeNamespace,
         mdhandle_t module,
         mdhandle_t assembly,
+        ImportSession* session,
         std::function<void(mdcursor_t)> onRowAdded,
         mdcursor_t* importedScope
     )
@@ -989,7 +1039,7 @@ namespace
                 // If the ExportedType.Implementation is an AssemblyRef, then we'll use that as the imported scope.
                 // COMPAT-BREAK: CoreCLR does not support this case (it assumes that this ExportedType entry is never a type forwarder).
                 case mdtAssemblyRef:
-                    return ImportReferenceToAssemblyRef(implementation, module, assembly, onRowAdded, importedScope);
+                    return ImportReferenceToAssemblyRef(implementation, module, assembly, session, onRowAdded, importedScope);
 
                 // If the ExportedType.Implementation is an ExportedType, then we're in an error scenario.
                 case mdtExportedType:
@@ -1079,7 +1129,8 @@ namespace
 
     HRESULT AssemblyRefPointsToAssembly(
         mdcursor_t assemblyRef,
-        mdcursor_t assembly)
+        mdcursor_t assembly,
+        ImportSession* session)
     {
         HRESULT hr;
         // Compare version, Name, Locale, and PublicKeyOrToken (possibly creating token from the assembly's key if needed)
@@ -1178,7 +1229,7 @@ namespace
             }
 
             StrongNameToken asmPublicKeyToken;
-            RETURN_IF_FAILED(StrongNameTokenFromPublicKey({ publicKey, publicKeyLength }, asmPublicKeyToken));
+            RETURN_IF_FAILED(StrongNameTokenFromPublicKey(session, { publicKey, publicKeyLength }, asmPublicKeyToken));
 
             if (refPublicKeyOrTokenLength != asmPublicKeyToken.size() || !std::equal(asmPublicKeyToken.begin(), asmPublicKeyToken.end(), refPublicKeyOrToken))
                 return S_FALSE;
@@ -1194,12 +1245,16 @@ namespace
         span<const uint8_t> sourceAssemblyHash,
         mdhandle_t targetAssembly,
         mdhandle_t targetModule,
+        ImportSession* session,
         std::function<void(mdcursor_t)> onRowAdded,
         mdcursor_t* targetTypeRef)
     {
         assert(sourceAssembly != nullptr && targetAssembly != nullptr && targetModule != nullptr);
 
         HRESULT hr;
+        if (session != nullptr && session->TryGetImported(sourceTypeRef, targetTypeRef))
+            return S_OK;
+
         std::stack<mdcursor_t> typesForTypeRefs;
         typesForTypeRefs.push(sourceTypeRef);
         
@@ -1210,8 +1265,10 @@ namespace
             if (1 != md_get_column_value_as_cursor(scope, mdtTypeRef_ResolutionScope, 1, &resolutionScope))
                 return E_FAIL;
             
-            typesForTypeRefs.push(resolutionScope);
+            // The outermost scope isn't a type, so only the enclosing TypeRefs are imported.
             scope = resolutionScope;
+            if (GetTokenTypeFromCursor(scope) == mdtTypeRef)
+                typesForTypeRefs.push(scope);
         }
         
         mdhandle_t sourceModule = md_extract_handle_from_cursor(sourceTypeRef);
@@ -1318,7 +1375,7 @@ namespace
             else if (TypeFromToken(scopeToken) == mdtAssemblyRef)
             {
                 // Copy the AssemblyRef from the source module to the target module.
-                RETURN_IF_FAILED(ImportReferenceToAssemblyRef(scope, targetModule, targetAssembly, onRowAdded, &targetOutermostScope));
+                RETURN_IF_FAILED(ImportReferenceToAssemblyRef(scope, targetModule, targetAssembly, session, onRowAdded, &targetOutermostScope));
             }
             else
             {
@@ -1380,7 +1437,7 @@ namespace
                         case mdtFile:
                         {
                             // This type is from a file in the source assembly, so we need to create an AssemblyRef to the source assembly.
-                            RETURN_IF_FAILED(ImportReferenceToAssembly(sourceAssembly, sourceAssemblyHash, targetModule, targetAssembly, onRowAdded, &targetOutermostScope));
+                            RETURN_IF_FAILED(ImportReferenceToAssembly(sourceAssembly, sourceAssemblyHash, targetModule, targetAssembly, session, onRowAdded, &targetOutermostScope));
                         }
                         case mdtAssemblyRef:
                         {
@@ -1459,7 +1516,7 @@ namespace
                             return E_FAIL;
                         
                         // Add a reference to the assembly in the target module and assembly.
-                        RETURN_IF_FAILED(ImportReferenceToAssembly(sourceAssembly, sourceAssemblyHash, targetModule, targetAssembly, onRowAdded, &targetOutermostScope));
+                        RETURN_IF_FAILED(ImportReferenceToAssembly(sourceAssembly, sourceAssemblyHash, targetModule, targetAssembly, session, onRowAdded, &targetOutermostScope));
                         found = true;
                         break;
                     }
@@ -1471,7 +1528,7 @@ namespace
             else if (TypeFromToken(scopeToken) == mdtModule)
             {
                 // Create an AssemblyRef from the destination assembly to the source assembly.
-                RETURN_IF_FAILED(ImportReferenceToAssembly(sourceAssembly, sourceAssemblyHash, targetModule, targetAssembly, onRowAdded, &targetOutermostScope));
+                RETURN_IF_FAILED(ImportReferenceToAssembly(sourceAssembly, sourceAssemblyHash, targetModule, targetAssembly, session, onRowAdded, &targetOutermostScope));
             }
             
             // The IsNilToken case can resolve to an ExportedType entry whose scope is an AssemblyRef.
@@ -1484,7 +1541,7 @@ namespace
                 if (!md_create_cursor(targetModule, mdtid_Assembly, &targetAssemblyCursor, &count))
                     return E_FAIL;
 
-                RETURN_IF_FAILED(AssemblyRefPointsToAssembly(scope, targetAssemblyCursor));
+                RETURN_IF_FAILED(AssemblyRefPointsToAssembly(scope, targetAssemblyCursor, session));
                 if (hr == S_OK)
                 {
                     // The type is defined in the target assembly, so we need to correctly define its scope.
@@ -1502,6 +1559,7 @@ namespace
                         typeNamespace,
                         targetModule,
                         targetAssembly,
+                        session,
                         onRowAdded,
                         &targetOutermostScope));
                 }
@@ -1509,7 +1567,7 @@ namespace
                 {
                     // The type is defined in another assembly. We need to create an AssemblyRef to that assembly.
                     assert(hr == S_FALSE);
-                    RETURN_IF_FAILED(ImportReferenceToAssemblyRef(scope, targetModule, targetAssembly, onRowAdded, &targetOutermostScope));
+                    RETURN_IF_FAILED(ImportReferenceToAssemblyRef(scope, targetModule, targetAssembly, session, onRowAdded, &targetOutermostScope));
                 }
             }
             else if (TypeFromToken(scopeToken) == mdtModuleRef)
@@ -1518,7 +1576,7 @@ namespace
                 // Since the source assembly and target assembly are different, we can't make a module reference to the type's module
                 // as module references are only within assembly boundaries.
                 // Make an AssemblyRef to the source assembly from the target assembly.
-                RETURN_IF_FAILED(ImportReferenceToAssembly(sourceAssembly, sourceAssemblyHash, targetModule, targetAssembly, onRowAdded, &targetOutermostScope));
+                RETURN_IF_FAILED(ImportReferenceToAssembly(sourceAssembly, sourceAssemblyHash, targetModule, targetAssembly, session, onRowAdded, &targetOutermostScope));
             }
             else
             {
@@ -1615,6 +1673,8 @@ namespace
                 enclosingScope = targetTypeDef;
             }
             *targetTypeRef = enclosingScope;
+            if (session != nullptr)
+                session->AddImported(sourceTypeRef, *targetTypeRef);
             return S_OK;
         }
 
@@ -1649,6 +1709,8 @@ namespace
 
         *targetTypeRef = resolutionScope;
 
+        if (session != nullptr)
+            session->AddImported(sourceTypeRef, *targetTypeRef);
         return S_OK;
     }
 }
@@ -1659,6 +1721,7 @@ HRESULT ImportReferenceToTypeDefOrRefOrSpec(
     span<const uint8_t> sourceAssemblyHash,
     mdhandle_t targetAssembly,
     mdhandle_t targetModule,
+    ImportSession* session,
     std::function<void(mdcursor_t)> onRowAdded,
     mdToken* importedToken)
 {
@@ -1672,7 +1735,7 @@ HRESULT ImportReferenceToTypeDefOrRefOrSpec(
         case mdtTypeDef:
         {
             mdcursor_t targetCursor;
-            RETURN_IF_FAILED(ImportReferenceToTypeDef(sourceCursor, sourceAssembly, sourceAssemblyHash, targetAssembly, targetModule, true, onRowAdded, &targetCursor));
+            RETURN_IF_FAILED(ImportReferenceToTypeDef(sourceCursor, sourceAssembly, sourceAssemblyHash, targetAssembly, targetModule, true, session, onRowAdded, &targetCursor));
             if (!md_cursor_to_token(targetCursor, importedToken))
                 return E_FAIL;
             
@@ -1681,7 +1744,7 @@ HRESULT ImportReferenceToTypeDefOrRefOrSpec(
         case mdtTypeRef:
         {
             mdcursor_t targetCursor;
-            RETURN_IF_FAILED(ImportReferenceToTypeRef(sourceCursor, sourceAssembly, sourceAssemblyHash, targetAssembly, targetModule, onRowAdded, &targetCursor));
+            RETURN_IF_FAILED(ImportReferenceToTypeRef(sourceCursor, sourceAssembly, sourceAssemblyHash, targetAssembly, targetModule, session, onRowAdded, &targetCursor));
             if (!md_cursor_to_token(targetCursor, importedToken))
                 return E_FAIL;
             
@@ -1689,13 +1752,22 @@ HRESULT ImportReferenceToTypeDefOrRefOrSpec(
         }
         case mdtTypeSpec:
         {
+            mdcursor_t targetCursor;
+            if (session != nullptr && session->TryGetImported(sourceCursor, &targetCursor))
+            {
+                if (!md_cursor_to_token(targetCursor, importedToken))
+                    return E_FAIL;
+
+                return S_OK;
+            }
+
             uint8_t const* signature;
             uint32_t signatureLength;
             if (1 != md_get_column_value_as_blob(sourceCursor, mdtTypeSpec_Signature, 1, &signature, &signatureLength))
                 return E_FAIL;
             
             malloc_span<uint8_t> importedSignature;
-            RETURN_IF_FAILED(ImportTypeSpecBlob(sourceAssembly, sourceModule, sourceAssemblyHash, targetAssembly, targetModule, {signature, signatureLength}, onRowAdded, importedSignature));
+            RETURN_IF_FAILED(ImportTypeSpecBlob(sourceAssembly, sourceModule, sourceAssemblyHash, targetAssembly, targetModule, {signature, signatureLength}, session, onRowAdded, importedSignature));
 
             md_added_row_t typeSpec;
             if (!md_append_row(targetModule, mdtid_TypeSpec, &typeSpec))
@@ -1708,6 +1780,10 @@ HRESULT ImportReferenceToTypeDefOrRefOrSpec(
             
             if (!md_cursor_to_token(typeSpec, importedToken))
                 return E_FAIL;
+
+            if (session != nullptr)
+                session->AddImported(sourceCursor, typeSpec);
+            return S_OK;
         }
         default:
             return E_INVALIDARG;
@@ -1817,3 +1893,222 @@ HRESULT DefineImportMember(
     
     return S_OK;
 }
+
+namespace
+{
+    // The tables of a target image that importing a reference reads.
+    // Rows appended to these tables don't change the references already imported.
+    mdtable_id_t const ImportTargetTables[] =
+    {
+        mdtid_Module,
+        mdtid_TypeRef,
+        mdtid_TypeDef,
+        mdtid_TypeSpec,
+        mdtid_ModuleRef,
+        mdtid_NestedClass,
+        mdtid_Assembly,
+        mdtid_AssemblyRef,
+        mdtid_ExportedType,
+    };
+
+    uint64_t GetImportTargetRevision(mdhandle_t target)
+    {
+        // Table revisions only increase, so the sum changes when any of them does.
+        uint64_t revision = 0;
+        for (mdtable_id_t table : ImportTargetTables)
+            revision += md_get_table_revision(target, table);
+        return revision;
+    }
+
+    constexpr size_t MaxImportSessionCount = 8;
+}
+
+ImportSession::ImportSession(
+    mdhandle_t sourceAssembly,
+    mdhandle_t sourceModule,
+    span<uint8_t const> sourceAssemblyHash,
+    mdhandle_t targetAssembly,
+    mdhandle_t targetModule)
+    : _sourceAssembly{ sourceAssembly }
+    , _sourceModule{ sourceModule }
+    , _targetAssembly{ targetAssembly }
+    , _targetModule{ targetModule }
+    , _sourceAssemblyHash{ sourceAssemblyHash.begin(), sourceAssemblyHash.end() }
+    , _mvids{}
+    , _revisions{}
+{
+    Reset();
+}
+
+void ImportSession::GetRevisions(std::array<uint64_t, 4>& revisions) const noexcept
+{
+    // The sources are expected to be read-only, so any edit to them is a change.
+    // The targets are edited by the imports themselves and by the other rows being defined,
+    // so only edits to the existing rows of the tables that imports read are changes.
+    revisions[0] = md_get_revision(_sourceAssembly);
+    revisions[1] = md_get_revision(_sourceModule);
+    revisions[2] = GetImportTargetRevision(_targetAssembly);
+    revisions[3] = GetImportTargetRevision(_targetModule);
+}
+
+void ImportSession::Reset() noexcept
+{
+    _importedTokens.clear();
+
+    mdhandle_t const handles[] = { _sourceAssembly, _sourceModule, _targetAssembly, _targetModule };
+    for (size_t i = 0; i < _mvids.size(); ++i)
+    {
+        if (FAILED(GetMvid(handles[i], &_mvids[i])))
+            _mvids[i] = {};
+    }
+    GetRevisions(_revisions);
+}
+
+void ImportSession::Refresh() noexcept
+{
+    std::array<uint64_t, 4> revisions;
+    GetRevisions(revisions);
+    if (revisions != _revisions)
+    {
+        Reset();
+        return;
+    }
+
+    // A handle may have been freed and reused for another image.
+    mdhandle_t const handles[] = { _sourceAssembly, _sourceModule, _targetAssembly, _targetModule };
+    for (size_t i = 0; i < _mvids.size(); ++i)
+    {
+        mdguid_t mvid;
+        if (FAILED(GetMvid(handles[i], &mvid)) || std::memcmp(&mvid, &_mvids[i], sizeof(mdguid_t)) != 0)
+        {
+            Reset();
+            return;
+        }
+    }
+}
+
+bool ImportSession::IsFor(
+    mdhandle_t sourceAssembly,
+    mdhandle_t sourceModule,
+    span<uint8_t const> sourceAssemblyHash,
+    mdhandle_t targetAssembly,
+    mdhandle_t targetModule) const noexcept
+{
+    // The hash is written to the AssemblyRef rows created for the source assembly.
+    return _sourceAssembly == sourceAssembly
+        && _sourceModule == sourceModule
+        && _targetAssembly == targetAssembly
+        && _targetModule == targetModule
+        && _sourceAssemblyHash.size() == sourceAssemblyHash.size()
+        && std::equal(sourceAssemblyHash.begin(), sourceAssemblyHash.end(), _sourceAssemblyHash.begin());
+}
+
+bool ImportSession::TryGetKey(mdcursor_t source, mdToken* key) const noexcept
+{
+    if (!md_cursor_to_token(source, key))
+        return false;
+
+    // Other rows of the source assembly can have the same tokens as rows of the source module.
+    mdhandle_t handle = md_extract_handle_from_cursor(source);
+    return handle == _sourceModule
+        || (handle == _sourceAssembly && TypeFromToken(*key) == mdtAssembly);
+}
+
+bool ImportSession::TryGetImported(mdcursor_t source, mdcursor_t* target) noexcept
+{
+    mdToken key;
+    if (!TryGetKey(source, &key))
+        return false;
+
+    auto imported = _importedTokens.find(key);
+    return imported != _importedTokens.end()
+        && md_token_to_cursor(_targetModule, imported->second, target);
+}
+
+void ImportSession::AddImported(mdcursor_t source, mdcursor_t target) noexcept
+{
+    mdToken key;
+    mdToken targetToken;
+    if (!TryGetKey(source, &key)
+        || md_extract_handle_from_cursor(target) != _targetModule
+        || !md_cursor_to_token(target, &targetToken))
+    {
+        return;
+    }
+
+    try
+    {
+        _importedTokens[key] = targetToken;
+    }
+    catch (std::bad_alloc const&)
+    {
+        // The session is only an optimization.
+        return;
+    }
+
+    // The import's edits are now reflected in the session.
+    GetRevisions(_revisions);
+}
+
+bool ImportSession::TryGetPublicKeyToken(span<uint8_t const> publicKey, PublicKeyToken& token) const noexcept
+{
+    try
+    {
+        auto found = _publicKeyTokens.find(std::string{ (char const*)(uint8_t const*)publicKey, publicKey.size() });
+        if (found == _publicKeyTokens.end())
+            return false;
+
+        token = found->second;
+        return true;
+    }
+    catch (std::bad_alloc const&)
+    {
+        return false;
+    }
+}
+
+void ImportSession::AddPublicKeyToken(span<uint8_t const> publicKey, PublicKeyToken const& token) noexcept
+{
+    try
+    {
+        _publicKeyTokens.emplace(std::string{ (char const*)(uint8_t const*)publicKey, publicKey.size() }, token);
+    }
+    catch (std::bad_alloc const&)
+    {
+        // The session is only an optimization.
+    }
+}
+
+ImportSession* ImportSessions::Get(
+    mdhandle_t sourceAssembly,
+    mdhandle_t sourceModule,
+    span<uint8_t const> sourceAssemblyHash,
+    mdhandle_t targetAssembly,
+    mdhandle_t targetModule) noexcept
+{
+    auto session = std::find_if(_sessions.begin(), _sessions.end(), [&](std::unique_ptr<ImportSession> const& s)
+    {
+        return s->IsFor(sourceAssembly, sourceModule, sourceAssemblyHash, targetAssembly, targetModule);
+    });
+
+    if (session != _sessions.end())
+    {
+        std::rotate(session, session + 1, _sessions.end());
+        _sessions.back()->Refresh();
+        return _sessions.back().get();
+    }
+
+    try
+    {
+        std::unique_ptr<ImportSession> newSession = std::make_unique<ImportSession>(sourceAssembly, sourceModule, sourceAssemblyHash, targetAssembly, targetModule);
+        if (_sessions.size() == MaxImportSessionCount)
+            _sessions.erase(_sessions.begin());
+
+        _sessions.push_back(std::move(newSession));
+        return _sessions.back().get();
+    }
+    catch (std::bad_alloc const&)
+    {
+        return nullptr;
+    }
+}
@@ -3,7 +3,89 @@
 
 #include <internal/dnmd_platform.hpp>
 #include <internal/span.hpp>
+#include <array>
 #include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Remembers the references imported from one module and assembly pair into another,
+// so that importing the same types again, for example when translating many signatures
+// that refer to them, doesn't resolve them or compute public key tokens again.
+// The imported references are forgotten when a source is edited or when existing rows
+// of a target are edited other than by an import that uses the session.
+class ImportSession final
+{
+public:
+    using PublicKeyToken = std::array<uint8_t, 8>;
+
+private:
+    mdhandle_t _sourceAssembly;
+    mdhandle_t _sourceModule;
+    mdhandle_t _targetAssembly;
+    mdhandle_t _targetModule;
+    std::vector<uint8_t> _sourceAssemblyHash;
+
+    // The MVIDs and revisions of the source assembly, source module, target assembly and target module
+    // when the last reference was imported. The MVIDs detect a handle being reused for a different image.
+    std::array<mdguid_t, 4> _mvids;
+    std::array<uint64_t, 4> _revisions;
+
+    // Keyed by the token of the row in the source module, or the Assembly token for the source assembly.
+    std::unordered_map<mdToken, mdToken> _importedTokens;
+    // Keyed by the public key. The token of a key doesn't depend on the images, so these are always kept.
+    std::unordered_map<std::string, PublicKeyToken> _publicKeyTokens;
+
+    void GetRevisions(std::array<uint64_t, 4>& revisions) const noexcept;
+    void Reset() noexcept;
+    bool TryGetKey(mdcursor_t source, mdToken* key) const noexcept;
+
+public:
+    ImportSession(
+        mdhandle_t sourceAssembly,
+        mdhandle_t sourceModule,
+        span<uint8_t const> sourceAssemblyHash,
+        mdhandle_t targetAssembly,
+        mdhandle_t targetModule);
+
+    bool IsFor(
+        mdhandle_t sourceAssembly,
+        mdhandle_t sourceModule,
+        span<uint8_t const> sourceAssemblyHash,
+        mdhandle_t targetAssembly,
+        mdhandle_t targetModule) const noexcept;
+
+    // Forget the imported references if the images have changed since the last import.
+    // Must be called at the start of each import that uses the session.
+    void Refresh() noexcept;
+
+    // Find the row in the target module previously imported for the source row.
+    bool TryGetImported(mdcursor_t source, mdcursor_t* target) noexcept;
+
+    // Remember the row in the target module imported for the source row.
+    // Must be called after the last edit made by the import.
+    void AddImported(mdcursor_t source, mdcursor_t target) noexcept;
+
+    bool TryGetPublicKeyToken(span<uint8_t const> publicKey, PublicKeyToken& token) const noexcept;
+    void AddPublicKeyToken(span<uint8_t const> publicKey, PublicKeyToken const& token) noexcept;
+};
+
+// The import sessions of a target module, most recently used last.
+class ImportSessions final
+{
+    std::vector<std::unique_ptr<ImportSession>> _sessions;
+
+public:
+    // Get the session for importing from the source module and assembly pair into the target module and assembly pair,
+    // refreshed for a new import. Returns nullptr if a session can't be created, in which case the import can be done without one.
+    ImportSession* Get(
+        mdhandle_t sourceAssembly,
+        mdhandle_t sourceModule,
+        span<uint8_t const> sourceAssemblyHash,
+        mdhandle_t targetAssembly,
+        mdhandle_t targetModule) noexcept;
+};
 
 // Import a reference to a TypeDef row from one module and assembly pair to another.
 HRESULT ImportReferenceToTypeDef(
@@ -13,6 +95,7 @@ HRESULT ImportReferenceToTypeDef(
     mdhandle_t targetAssembly,
     mdhandle_t targetModule,
     bool alwaysImport, // Always import a reference to the TypeDef, even if the source and destination modules are the same.
+    ImportSession* session, // Optional session for the source and target, used to reuse previously imported references.
     std::function<void(mdcursor_t row)> onRowEdited,
     mdcursor_t* targetTypeDef);
 
@@ -24,6 +107,7 @@ HRESULT ImportReferenceToTypeDefOrRefOrSpec(
     span<uint8_t const> sourceAssemblyHash,
     mdhandle_t targetAssembly,
     mdhandle_t targetModule,
+    ImportSession* session,
     std::function<void(mdcursor_t)> onRowAdded,
     mdToken* importedToken);
 
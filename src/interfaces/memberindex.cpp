@@ -0,0 +1,147 @@
+#include "memberindex.hpp"
+#include "namehash.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#define RETURN_IF_FAILED(exp) \
+{ \
+    hr = (exp); \
+    if (FAILED(hr)) \
+    { \
+        return hr; \
+    } \
+}
+
+namespace
+{
+    bool EntryLessThan(MemberIndex::Entry const& lhs, MemberIndex::Entry const& rhs)
+    {
+        if (lhs.NameHash != rhs.NameHash)
+            return lhs.NameHash < rhs.NameHash;
+        return lhs.Parent < rhs.Parent;
+    }
+
+    HRESULT AddEntry(std::vector<MemberIndex::Entry>& entries, mdcursor_t member, mdToken parent, col_index_t nameColumn)
+    {
+        MemberIndex::Entry entry;
+        char const* name;
+        if (1 != md_get_column_value_as_utf8(member, nameColumn, 1, &name)
+            || !md_cursor_to_token(member, &entry.Member))
+        {
+            return CLDB_E_FILE_CORRUPT;
+        }
+
+        entry.NameHash = HashName(name);
+        entry.Parent = parent;
+        entries.push_back(entry);
+        return S_OK;
+    }
+}
+
+HRESULT MemberIndex::InitializeFromMemberList(
+    mdhandle_t handle,
+    col_index_t listColumn,
+    col_index_t flagsColumn,
+    uint32_t accessMask,
+    col_index_t nameColumn)
+{
+    mdcursor_t typedefCursor;
+    uint32_t typedefCount;
+    if (!md_create_cursor(handle, mdtid_TypeDef, &typedefCursor, &typedefCount))
+        return S_OK; // No types, so the index is empty.
+
+    HRESULT hr;
+    for (uint32_t i = 0; i < typedefCount; (void)md_cursor_next(&typedefCursor), ++i)
+    {
+        mdToken parent;
+        mdcursor_t memberCursor;
+        uint32_t memberCount;
+        if (!md_cursor_to_token(typedefCursor, &parent)
+            || !md_get_column_value_as_range(typedefCursor, listColumn, &memberCursor, &memberCount))
+        {
+            return CLDB_E_FILE_CORRUPT;
+        }
+
+        for (uint32_t j = 0; j < memberCount; (void)md_cursor_next(&memberCursor), ++j)
+        {
+            mdcursor_t target;
+            uint32_t flags;
+            if (!md_resolve_indirect_cursor(memberCursor, &target)
+                || 1 != md_get_column_value_as_constant(target, flagsColumn, 1, &flags))
+            {
+                return CLDB_E_FILE_CORRUPT;
+            }
+
+            // PrivateScope members have no access set and can only be referred to by token.
+            if ((flags & accessMask) != 0)
+                RETURN_IF_FAILED(AddEntry(_entries, target, parent, nameColumn));
+        }
+    }
+
+    // Members were added in member order, which a stable sort preserves.
+    std::stable_sort(_entries.begin(), _entries.end(), EntryLessThan);
+    return S_OK;
+}
+
+HRESULT MemberIndex::InitializeFromParentColumn(
+    mdhandle_t handle,
+    mdtable_id_t table,
+    col_index_t parentColumn,
+    col_index_t nameColumn)
+{
+    mdcursor_t cursor;
+    uint32_t count;
+    if (!md_create_cursor(handle, table, &cursor, &count))
+        return S_OK; // No rows, so the index is empty.
+
+    HRESULT hr;
+    _entries.reserve(count);
+    for (uint32_t i = 0; i < count; (void)md_cursor_next(&cursor), ++i)
+    {
+        mdToken parent;
+        if (1 != md_get_column_value_as_token(cursor, parentColumn, 1, &parent))
+            return CLDB_E_FILE_CORRUPT;
+
+        RETURN_IF_FAILED(AddEntry(_entries, cursor, parent, nameColumn));
+    }
+
+    std::stable_sort(_entries.begin(), _entries.end(), EntryLessThan);
+    return S_OK;
+}
+
+span<MemberIndex::Entry const> MemberIndex::Find(mdToken parent, char const* name) const noexcept
+{
+    assert(name != nullptr);
+
+    Entry key{ HashName(name), parent, mdTokenNil };
+    auto range = std::equal_range(_entries.begin(), _entries.end(), key, EntryLessThan);
+    return { _entries.data() + (range.first - _entries.begin()), (size_t)(range.second - range.first) };
+}
+
+HRESULT MethodDefIndex::Create(mdhandle_t handle, std::unique_ptr<MethodDefIndex>& index)
+{
+    std::unique_ptr<MethodDefIndex> newIndex{ new MethodDefIndex{} };
+    HRESULT hr;
+    RETURN_IF_FAILED(newIndex->InitializeFromMemberList(handle, mdtTypeDef_MethodList, mdtMethodDef_Flags, mdMemberAccessMask, mdtMethodDef_Name));
+    index = std::move(newIndex);
+    return S_OK;
+}
+
+HRESULT FieldIndex::Create(mdhandle_t handle, std::unique_ptr<FieldIndex>& index)
+{
+    std::unique_ptr<FieldIndex> newIndex{ new FieldIndex{} };
+    HRESULT hr;
+    RETURN_IF_FAILED(newIndex->InitializeFromMemberList(handle, mdtTypeDef_FieldList, mdtField_Flags, fdFieldAccessMask, mdtField_Name));
+    index = std::move(newIndex);
+    return S_OK;
+}
+
+HRESULT MemberRefIndex::Create(mdhandle_t handle, std::unique_ptr<MemberRefIndex>& index)
+{
+    std::unique_ptr<MemberRefIndex> newIndex{ new MemberRefIndex{} };
+    HRESULT hr;
+    RETURN_IF_FAILED(newIndex->InitializeFromParentColumn(handle, mdtid_MemberRef, mdtMemberRef_Class, mdtMemberRef_Name));
+    index = std::move(newIndex);
+    return S_OK;
+}
@@ -0,0 +1,70 @@
+#ifndef _SRC_INTERFACES_MEMBERINDEX_HPP_
+#define _SRC_INTERFACES_MEMBERINDEX_HPP_
+
+#include <internal/dnmd_platform.hpp>
+#include <internal/span.hpp>
+
+#include <external/cor.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Index of the members of a table keyed by their parent and name.
+// The index is built in a single pass over the table and makes finding
+// a member by parent and name, for example when binding a method, a hash lookup.
+// Members that can only be referred to by token, such as PrivateScope methods, aren't indexed.
+class MemberIndex
+{
+public:
+    struct Entry final
+    {
+        uint32_t NameHash;
+        mdToken Parent;
+        mdToken Member;
+    };
+
+private:
+    // Sorted by name hash, then parent. Entries with the same hash and parent are in member order.
+    std::vector<Entry> _entries;
+
+protected:
+    MemberIndex() = default;
+
+    // Index the members in the list column of each TypeDef, for example the MethodList.
+    HRESULT InitializeFromMemberList(mdhandle_t handle, col_index_t listColumn, col_index_t flagsColumn, uint32_t accessMask, col_index_t nameColumn);
+
+    // Index the rows of a table that has a parent column, for example the MemberRef table.
+    HRESULT InitializeFromParentColumn(mdhandle_t handle, mdtable_id_t table, col_index_t parentColumn, col_index_t nameColumn);
+
+public:
+    // Find the members, in member order, of the parent whose name has the same hash as the supplied name.
+    // Different names can share a hash, so callers must confirm the name of each member.
+    span<Entry const> Find(mdToken parent, char const* name) const noexcept;
+};
+
+class MethodDefIndex final : public MemberIndex
+{
+    MethodDefIndex() = default;
+
+public:
+    static HRESULT Create(mdhandle_t handle, std::unique_ptr<MethodDefIndex>& index);
+};
+
+class FieldIndex final : public MemberIndex
+{
+    FieldIndex() = default;
+
+public:
+    static HRESULT Create(mdhandle_t handle, std::unique_ptr<FieldIndex>& index);
+};
+
+class MemberRefIndex final : public MemberIndex
+{
+    MemberRefIndex() = default;
+
+public:
+    static HRESULT Create(mdhandle_t handle, std::unique_ptr<MemberRefIndex>& index);
+};
+
+#endif // _SRC_INTERFACES_MEMBERINDEX_HPP_
@@ -0,0 +1,125 @@
+#ifndef _SRC_INTERFACES_METADATACACHE_HPP_
+#define _SRC_INTERFACES_METADATACACHE_HPP_
+
+#include <internal/dnmd_platform.hpp>
+#include "pal.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+
+// Lazily computes a value derived from a metadata handle and caches it
+// until the metadata is edited - see md_get_revision().
+// The value type must provide:
+//   static HRESULT Create(mdhandle_t handle, std::unique_ptr<T>& value);
+// Concurrent readers can share the cache. As with the metadata itself,
+// edits must not run concurrently with readers.
+template<typename T>
+class MetadataCache final
+{
+    // Sentinel revision that no handle reports, used until a value is computed.
+    static constexpr uint64_t NoRevision = UINT64_MAX;
+
+    // Number of requests for the same revision after which a stale value is recomputed by GetIfSettled().
+    static constexpr uint32_t SettledRequestCount = 16;
+
+    pal::ReadWriteLock _lock;
+    std::atomic<T*> _value;
+    std::atomic<mdhandle_t> _handle;
+    std::atomic<uint64_t> _revision;
+    std::atomic<uint64_t> _requestedRevision;
+    std::atomic<uint32_t> _requestCount;
+
+public:
+    MetadataCache()
+        : _lock{}
+        , _value{ nullptr }
+        , _handle{ nullptr }
+        , _revision{ NoRevision }
+        , _requestedRevision{ NoRevision }
+        , _requestCount{ 0 }
+    { }
+
+    MetadataCache(MetadataCache const&) = delete;
+    MetadataCache& operator=(MetadataCache const&) = delete;
+
+    ~MetadataCache()
+    {
+        delete _value.load(std::memory_order_relaxed);
+    }
+
+    HRESULT Get(mdhandle_t handle, T const** value) noexcept
+    {
+        assert(value != nullptr);
+
+        // The value is published before its revision, so observing
+        // the current revision means the current value is visible.
+        uint64_t revision = md_get_revision(handle);
+        if (_revision.load(std::memory_order_acquire) == revision
+            && _handle.load(std::memory_order_relaxed) == handle)
+        {
+            *value = _value.load(std::memory_order_relaxed);
+            return S_OK;
+        }
+
+        std::lock_guard<pal::WriteLock> lock{ _lock.GetWriteLock() };
+        if (_revision.load(std::memory_order_acquire) != revision
+            || _handle.load(std::memory_order_relaxed) != handle)
+        {
+            std::unique_ptr<T> newValue;
+            HRESULT hr;
+            try
+            {
+                hr = T::Create(handle, newValue);
+            }
+            catch (std::bad_alloc const&)
+            {
+                hr = E_OUTOFMEMORY;
+            }
+
+            if (FAILED(hr))
+                return hr;
+
+            // Readers of the previous value started before the edit that made it stale,
+            // so they have completed and the previous value can be freed.
+            std::unique_ptr<T> previous{ _value.exchange(newValue.release(), std::memory_order_relaxed) };
+            _handle.store(handle, std::memory_order_relaxed);
+            _revision.store(revision, std::memory_order_release);
+        }
+
+        *value = _value.load(std::memory_order_relaxed);
+        return S_OK;
+    }
+
+    // Get the value like Get(), except that a stale value is only recomputed once the metadata
+    // has stopped changing, that is when the same revision has been requested several times.
+    // Until then S_FALSE is returned without a value, so callers interleaving edits and lookups
+    // can search the metadata directly instead of recomputing the value after every edit.
+    // The first value is computed on the first request.
+    HRESULT GetIfSettled(mdhandle_t handle, T const** value) noexcept
+    {
+        assert(value != nullptr);
+
+        uint64_t revision = md_get_revision(handle);
+        uint64_t cachedRevision = _revision.load(std::memory_order_acquire);
+        if (cachedRevision != NoRevision
+            && (cachedRevision != revision || _handle.load(std::memory_order_relaxed) != handle))
+        {
+            // Concurrent readers may race to count the requests, which only delays or hastens the recompute.
+            if (_requestedRevision.exchange(revision, std::memory_order_relaxed) != revision)
+            {
+                _requestCount.store(1, std::memory_order_relaxed);
+                return S_FALSE;
+            }
+
+            if (_requestCount.fetch_add(1, std::memory_order_relaxed) + 1 < SettledRequestCount)
+                return S_FALSE;
+        }
+
+        return Get(handle, value);
+    }
+};
+
+#endif // _SRC_INTERFACES_METADATACACHE_HPP_
@@ -105,7 +105,8 @@ HRESULT MetadataEmit::Save(
         return E_INVALIDARG;
 
     size_t saveSize;
-    md_write_to_buffer(MetaData(), nullptr, &saveSize);
+    if (!md_prepare_write(MetaData(), &saveSize))
+        return E_FAIL;
     std::unique_ptr<uint8_t[]> buffer { new uint8_t[saveSize] };
     if (!md_write_to_buffer(MetaData(), buffer.get(), &saveSize))
         return E_FAIL;
@@ -144,9 +145,11 @@ HRESULT MetadataEmit::SaveToStream(
         return E_INVALIDARG;
 
     size_t saveSize;
-    md_write_to_buffer(MetaData(), nullptr, &saveSize);
+    if (!md_prepare_write(MetaData(), &saveSize))
+        return E_FAIL;
     std::unique_ptr<uint8_t[]> buffer { new uint8_t[saveSize] };
-    md_write_to_buffer(MetaData(), buffer.get(), &saveSize);
+    if (!md_write_to_buffer(MetaData(), buffer.get(), &saveSize))
+        return E_FAIL;
 
     size_t totalSaved = 0;
     while (totalSaved < saveSize)
@@ -167,7 +170,8 @@ HRESULT MetadataEmit::GetSaveSize(
     // If so, we'll need to handle that here in addition to the ::Save* methods.
     UNREFERENCED_PARAMETER(fSave);
     size_t saveSize;
-    md_write_to_buffer(MetaData(), nullptr, &saveSize);
+    if (!md_prepare_write(MetaData(), &saveSize))
+        return E_FAIL;
     if (saveSize > std::numeric_limits<DWORD>::max())
         return CLDB_E_TOO_BIG;
     *pdwSaveSize = (DWORD)saveSize;
@@ -440,14 +444,17 @@ HRESULT MetadataEmit::DefineImportType(
         return CLDB_E_FILE_CORRUPT;
     
     mdcursor_t importedTypeDef;
+    span<uint8_t const> hash{ reinterpret_cast<uint8_t const*>(pbHashValue), cbHashValue };
+    ImportSession* session = _importSessions.Get(assemImport->MetaData(), import->MetaData(), hash, assemEmit->MetaData(), MetaData());
 
     RETURN_IF_FAILED(ImportReferenceToTypeDef(
         originalTypeDef,
         assemImport->MetaData(),
-        { reinterpret_cast<uint8_t const*>(pbHashValue), cbHashValue },
+        hash,
         assemEmit->MetaData(),
         MetaData(),
         false,
+        session,
         [](mdcursor_t){},
         &importedTypeDef
     ));
@@ -2219,14 +2226,21 @@ HRESULT MetadataEmit::TranslateSigWithScope(
     dncp::com_ptr<IDNMDOwner> moduleEmit{};
     RETURN_IF_FAILED(emit->QueryInterface(IID_IDNMDOwner, (void**)&moduleEmit));
     
+    // The import sessions are only for imports into this module.
+    span<uint8_t const> hash{ reinterpret_cast<uint8_t const*>(pbHashValue), cbHashValue };
+    ImportSession* session = moduleEmit->MetaData() == MetaData()
+        ? _importSessions.Get(assemImport->MetaData(), moduleImport->MetaData(), hash, assemEmit->MetaData(), MetaData())
+        : nullptr;
+
     malloc_span<uint8_t> translatedSig;
     RETURN_IF_FAILED(ImportSignatureIntoModule(
         assemImport->MetaData(),
         moduleImport->MetaData(),
-        { reinterpret_cast<uint8_t const*>(pbHashValue), cbHashValue },
+        hash,
         assemEmit->MetaData(),
         moduleEmit->MetaData(),
         { pbSigBlob, cbSigBlob },
+        session,
         [](mdcursor_t){},
         translatedSig));
     
@@ -5,6 +5,7 @@
 #include "tearoffbase.hpp"
 #include "controllingiunknown.hpp"
 #include "dnmdowner.hpp"
+#include "importhelpers.hpp"
 
 #include <external/cor.h>
 #include <external/corhdr.h>
@@ -15,11 +16,12 @@
 class MetadataEmit final : public TearOffBase<IMetaDataEmit2, IMetaDataAssemblyEmit>
 {
     mdhandle_view _md_ptr;
+    ImportSessions _importSessions;
 
 protected:
     bool TryGetInterfaceOnThis(REFIID riid, void** ppvObject) override
     {
-        if (riid == IID_IMetaDataEmit || riid == IID_IMetaDataEmit)
+        if (riid == IID_IMetaDataEmit || riid == IID_IMetaDataEmit2)
         {
             *ppvObject = static_cast<IMetaDataEmit2*>(this);
             return true;
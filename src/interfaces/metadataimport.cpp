@@ -5,6 +5,7 @@
 #include "hcorenum.hpp"
 #include "signatures.hpp"
 #include <cstring>
+#include <limits>
 
 #define MD_MODULE_TOKEN TokenFromRid(1, mdtModule)
 #define MD_GLOBAL_PARENT_TOKEN TokenFromRid(1, mdtTypeDef)
@@ -54,8 +55,21 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::ResetEnum(HCORENUM hEnum, ULONG ulPo
 
 namespace
 {
+    // Check if a token may be the parent of a row in the table tracked by a presence filter.
+    // If the filter can't be computed, or the metadata is being edited and the filter
+    // isn't rebuilt yet, the token is reported as a possible parent so the caller
+    // falls back to searching the table.
+    template<typename T>
+    bool MayBeParent(MetadataCache<T>& presence, mdhandle_t mdhandle, mdToken parent)
+    {
+        T const* filter;
+        return presence.GetIfSettled(mdhandle, &filter) != S_OK
+            || filter->MayContain(parent);
+    }
+
     HRESULT CreateEnumTokens(
         mdhandle_t mdhandle,
+        HCORENUMPool& pool,
         mdtable_id_t mdtid,
         HCORENUMImpl** pEnumImpl)
     {
@@ -66,7 +80,7 @@ namespace
             return CLDB_E_RECORD_NOTFOUND;
 
         HCORENUMImpl* enumImpl;
-        RETURN_IF_FAILED(HCORENUMImpl::CreateTableEnum(1, &enumImpl));
+        RETURN_IF_FAILED(pool.CreateTableEnum(1, &enumImpl));
         HCORENUMImpl::InitTableEnum(*enumImpl, 0, cursor, rows);
         *pEnumImpl = enumImpl;
         return S_OK;
@@ -80,6 +94,7 @@ namespace
 
     HRESULT CreateEnumTokenRange(
         mdhandle_t mdhandle,
+        HCORENUMPool& pool,
         mdToken token,
         col_index_t column,
         _In_opt_ TokenRangeFilter const* filter,
@@ -98,7 +113,7 @@ namespace
         HCORENUMImpl* enumImpl;
         if (filter == nullptr || filter->Value == nullptr)
         {
-            RETURN_IF_FAILED(HCORENUMImpl::CreateTableEnum(1, &enumImpl));
+            RETURN_IF_FAILED(pool.CreateTableEnum(1, &enumImpl));
             HCORENUMImpl::InitTableEnum(*enumImpl, 0, begin, count);
         }
         else
@@ -110,7 +125,7 @@ namespace
 
             char const* toMatch;
             mdToken matchedTk;
-            RETURN_IF_FAILED(HCORENUMImpl::CreateDynamicEnum(&enumImpl));
+            RETURN_IF_FAILED(pool.CreateDynamicEnum(&enumImpl));
 
             HCORENUMImpl_ptr cleanup{ enumImpl };
 
@@ -140,6 +155,7 @@ namespace
 
     HRESULT CreateEnumTokenRangeForSortedTableKey(
         mdhandle_t mdhandle,
+        HCORENUMPool& pool,
         mdtable_id_t table,
         col_index_t keyColumn,
         mdToken token,
@@ -157,12 +173,12 @@ namespace
 
         if (result == MD_RANGE_NOT_FOUND)
         {
-            return HCORENUMImpl::CreateDynamicEnum(pEnumImpl);
+            return pool.CreateDynamicEnum(pEnumImpl);
         }
         else if (result == MD_RANGE_FOUND)
         {
             HCORENUMImpl* enumImpl;
-            RETURN_IF_FAILED(HCORENUMImpl::CreateTableEnum(1, &enumImpl));
+            RETURN_IF_FAILED(pool.CreateTableEnum(1, &enumImpl));
             HCORENUMImpl::InitTableEnum(*enumImpl, 0, begin, count);
             *pEnumImpl = enumImpl;
             return S_OK;
@@ -171,34 +187,25 @@ namespace
         {
             // Unsorted so we need to search across the entire table
             HCORENUMImpl* enumImpl;
-            RETURN_IF_FAILED(HCORENUMImpl::CreateDynamicEnum(&enumImpl));
+            RETURN_IF_FAILED(pool.CreateDynamicEnum(&enumImpl));
             HCORENUMImpl_ptr cleanup{ enumImpl };
             mdcursor_t curr = cursor;
-            uint32_t currCount = tableCount;
 
-            // Read in for matching in bulk
-            mdToken matchedGroup[64];
-            uint32_t i = 0;
-            while (i < currCount)
+            // Scan for matching rows in bulk
+            mdcursor_t matched[64];
+            int32_t read;
+            while ((read = md_scan_column_equals(&curr, keyColumn, token, ARRAY_SIZE(matched), matched)) > 0)
             {
-                int32_t read = md_get_column_value_as_token(curr, keyColumn, ARRAY_SIZE(matchedGroup), matchedGroup);
-                if (read == 0)
-                    break;
-
-                assert(read > 0);
                 for (int32_t j = 0; j < read; ++j)
                 {
-                    if (matchedGroup[j] == token)
-                    {
-                        mdToken matchedTk;
-                        if (!md_cursor_to_token(curr, &matchedTk))
-                            return CLDB_E_FILE_CORRUPT;
-                        RETURN_IF_FAILED(HCORENUMImpl::AddToDynamicEnum(*enumImpl, matchedTk));
-                    }
-                    (void)md_cursor_next(&curr);
+                    mdToken matchedTk;
+                    if (!md_cursor_to_token(matched[j], &matchedTk))
+                        return CLDB_E_FILE_CORRUPT;
+                    RETURN_IF_FAILED(HCORENUMImpl::AddToDynamicEnum(*enumImpl, matchedTk));
                 }
-                i += read;
             }
+            if (read < 0)
+                return CLDB_E_FILE_CORRUPT;
 
             *pEnumImpl = cleanup.release();
             return S_OK;
@@ -303,7 +310,6 @@ namespace
     template<typename T>
     void EnumTableRange(
         mdcursor_t begin,
-        uint32_t count,
         col_index_t lookupRange,
         mdToken lookupTk,
         T& op)
@@ -325,28 +331,17 @@ namespace
         {
             // Cannot get a range on this table so we need to search across the entire table
             curr = begin;
-            currCount = count;
 
-            // Read in for matching in bulk
-            mdToken matchedGroup[64];
-            uint32_t i = 0;
-            while (i < currCount)
+            // Scan for matching rows in bulk
+            mdcursor_t matched[64];
+            int32_t read;
+            while ((read = md_scan_column_equals(&curr, lookupRange, lookupTk, ARRAY_SIZE(matched), matched)) > 0)
             {
-                int32_t read = md_get_column_value_as_token(curr, lookupRange, ARRAY_SIZE(matchedGroup), matchedGroup);
-                if (read == 0)
-                    break;
-
-                assert(read > 0);
                 for (int32_t j = 0; j < read; ++j)
                 {
-                    if (matchedGroup[j] == lookupTk)
-                    {
-                        if (op(curr))
-                            return;
-                    }
-                    (void)md_cursor_next(&curr);
+                    if (op(matched[j]))
+                        return;
                 }
-                i += read;
             }
         }
     }
@@ -374,7 +369,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumTypeDefs(
         rows--;
         (void)md_cursor_next(&cursor);
 
-        RETURN_IF_FAILED(HCORENUMImpl::CreateTableEnum(1, &enumImpl));
+        RETURN_IF_FAILED(_enumPool.CreateTableEnum(1, &enumImpl));
         HCORENUMImpl::InitTableEnum(*enumImpl, 0, cursor, rows);
         *phEnum = enumImpl;
     }
@@ -397,7 +392,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumInterfaceImpls(
         if (!md_create_cursor(_md_ptr.get(), mdtid_InterfaceImpl, &cursor, &rows))
             return CLDB_E_RECORD_NOTFOUND;
 
-        RETURN_IF_FAILED(CreateEnumTokenRangeForSortedTableKey(_md_ptr.get(), mdtid_InterfaceImpl, mdtInterfaceImpl_Class, td, &enumImpl));
+        RETURN_IF_FAILED(CreateEnumTokenRangeForSortedTableKey(_md_ptr.get(), _enumPool, mdtid_InterfaceImpl, mdtInterfaceImpl_Class, td, &enumImpl));
         *phEnum = enumImpl;
     }
     return enumImpl->ReadTokens(rImpls, cMax, pcImpls);
@@ -413,7 +408,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumTypeRefs(
     HCORENUMImpl* enumImpl = ToHCORENUMImpl(*phEnum);
     if (enumImpl == nullptr)
     {
-        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), mdtid_TypeRef, &enumImpl));
+        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), _enumPool, mdtid_TypeRef, &enumImpl));
         *phEnum = enumImpl;
     }
     return enumImpl->ReadTokens(rTypeRefs, cMax, pcTypeRefs);
@@ -525,11 +520,12 @@ namespace
 }
 
 HRESULT STDMETHODCALLTYPE MetadataImportRO::FindTypeDefByName(
-    LPCWSTR     szTypeDef,
+    char const* szNamespace,
+    char const* szName,
     mdToken     tkEnclosingClass,
     mdTypeDef* ptd)
 {
-    if (szTypeDef == nullptr || ptd == nullptr)
+    if (szNamespace == nullptr || szName == nullptr || ptd == nullptr)
         return E_INVALIDARG;
 
     // Check the enclosing token is either valid or nil.
@@ -546,6 +542,17 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::FindTypeDefByName(
         tkEnclosingClass = mdTokenNil;
     }
 
+    return ::FindTypeDefByName(this, szNamespace, szName, tkEnclosingClass, ptd);
+}
+
+HRESULT STDMETHODCALLTYPE MetadataImportRO::FindTypeDefByName(
+    LPCWSTR     szTypeDef,
+    mdToken     tkEnclosingClass,
+    mdTypeDef* ptd)
+{
+    if (szTypeDef == nullptr || ptd == nullptr)
+        return E_INVALIDARG;
+
     pal::StringConvert<WCHAR, char> cvt{ szTypeDef };
     if (!cvt.Success())
         return E_INVALIDARG;
@@ -553,14 +560,11 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::FindTypeDefByName(
     char const* nspace;
     char const* name;
     SplitTypeName(cvt, &nspace, &name);
-    return ::FindTypeDefByName(this, nspace, name, tkEnclosingClass, ptd);
+    return FindTypeDefByName(nspace, name, tkEnclosingClass, ptd);
 }
 
 HRESULT STDMETHODCALLTYPE MetadataImportRO::GetScopeProps(
-    _Out_writes_to_opt_(cchName, *pchName)
-    LPWSTR      szName,
-    ULONG       cchName,
-    ULONG* pchName,
+    char const** pszName,
     GUID* pmvid)
 {
     mdcursor_t cursor;
@@ -575,6 +579,20 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetScopeProps(
     char const* name;
     if (1 != md_get_column_value_as_utf8(cursor, mdtModule_Name, 1, &name))
         return CLDB_E_FILE_CORRUPT;
+    *pszName = name;
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE MetadataImportRO::GetScopeProps(
+    _Out_writes_to_opt_(cchName, *pchName)
+    LPWSTR      szName,
+    ULONG       cchName,
+    ULONG* pchName,
+    GUID* pmvid)
+{
+    HRESULT hr;
+    char const* name;
+    RETURN_IF_FAILED(GetScopeProps(&name, pmvid));
     return ConvertAndReturnStringOutput(name, szName, cchName, pchName);
 }
 
@@ -590,10 +608,8 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetModuleFromScope(
 
 HRESULT STDMETHODCALLTYPE MetadataImportRO::GetTypeDefProps(
     mdTypeDef   td,
-    _Out_writes_to_opt_(cchTypeDef, *pchTypeDef)
-    LPWSTR      szTypeDef,
-    ULONG       cchTypeDef,
-    ULONG* pchTypeDef,
+    char const** pszNamespace,
+    char const** pszName,
     DWORD* pdwTypeDefFlags,
     mdToken* ptkExtends)
 {
@@ -623,8 +639,25 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetTypeDefProps(
     {
         return CLDB_E_FILE_CORRUPT;
     }
+    *pszNamespace = nspace;
+    *pszName = name;
+    return S_OK;
+}
 
+HRESULT STDMETHODCALLTYPE MetadataImportRO::GetTypeDefProps(
+    mdTypeDef   td,
+    _Out_writes_to_opt_(cchTypeDef, *pchTypeDef)
+    LPWSTR      szTypeDef,
+    ULONG       cchTypeDef,
+    ULONG* pchTypeDef,
+    DWORD* pdwTypeDefFlags,
+    mdToken* ptkExtends)
+{
     HRESULT hr;
+    char const* nspace;
+    char const* name;
+    RETURN_IF_FAILED(GetTypeDefProps(td, &nspace, &name, pdwTypeDefFlags, ptkExtends));
+
     malloc_ptr<char> mem;
     RETURN_IF_FAILED(ConstructTypeName(nspace, name, mem));
     return ConvertAndReturnStringOutput(mem.get(), szTypeDef, cchTypeDef, pchTypeDef);
@@ -658,10 +691,8 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetInterfaceImplProps(
 HRESULT STDMETHODCALLTYPE MetadataImportRO::GetTypeRefProps(
     mdTypeRef   tr,
     mdToken* ptkResolutionScope,
-    _Out_writes_to_opt_(cchName, *pchName)
-    LPWSTR      szName,
-    ULONG       cchName,
-    ULONG* pchName)
+    char const** pszNamespace,
+    char const** pszName)
 {
     if (TypeFromToken(tr) != mdtTypeRef)
         return E_INVALIDARG;
@@ -682,8 +713,24 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetTypeRefProps(
     {
         return CLDB_E_FILE_CORRUPT;
     }
+    *pszNamespace = nspace;
+    *pszName = name;
+    return S_OK;
+}
 
+HRESULT STDMETHODCALLTYPE MetadataImportRO::GetTypeRefProps(
+    mdTypeRef   tr,
+    mdToken* ptkResolutionScope,
+    _Out_writes_to_opt_(cchName, *pchName)
+    LPWSTR      szName,
+    ULONG       cchName,
+    ULONG* pchName)
+{
     HRESULT hr;
+    char const* nspace;
+    char const* name;
+    RETURN_IF_FAILED(GetTypeRefProps(tr, ptkResolutionScope, &nspace, &name));
+
     malloc_ptr<char> mem;
     RETURN_IF_FAILED(ConstructTypeName(nspace, name, mem));
     return ConvertAndReturnStringOutput(mem.get(), szName, cchName, pchName);
@@ -728,7 +775,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumMembers(
             return CLDB_E_FILE_CORRUPT;
         }
 
-        RETURN_IF_FAILED(HCORENUMImpl::CreateTableEnum(2, &enumImpl));
+        RETURN_IF_FAILED(_enumPool.CreateTableEnum(2, &enumImpl));
         HCORENUMImpl::InitTableEnum(*enumImpl, 0, methodList, methodListCount);
         HCORENUMImpl::InitTableEnum(*enumImpl, 1, fieldList, fieldListCount);
         *phEnum = enumImpl;
@@ -776,7 +823,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumMembersWithName(
 
         char const* toMatch;
         mdToken matchedTk;
-        RETURN_IF_FAILED(HCORENUMImpl::CreateDynamicEnum(&enumImpl));
+        RETURN_IF_FAILED(_enumPool.CreateDynamicEnum(&enumImpl));
 
         HCORENUMImpl_ptr cleanup{ enumImpl };
 
@@ -845,7 +892,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumMethodsWithName(
             return E_INVALIDARG;
 
         TokenRangeFilter filter{ mdtMethodDef_Name, szName };
-        RETURN_IF_FAILED(CreateEnumTokenRange(_md_ptr.get(), cl, mdtTypeDef_MethodList, &filter, &enumImpl));
+        RETURN_IF_FAILED(CreateEnumTokenRange(_md_ptr.get(), _enumPool, cl, mdtTypeDef_MethodList, &filter, &enumImpl));
         *phEnum = enumImpl;
     }
     return enumImpl->ReadTokens(rMethods, cMax, pcTokens);
@@ -877,7 +924,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumFieldsWithName(
             return E_INVALIDARG;
 
         TokenRangeFilter filter{ mdtField_Name, szName };
-        RETURN_IF_FAILED(CreateEnumTokenRange(_md_ptr.get(), cl, mdtTypeDef_FieldList, &filter, &enumImpl));
+        RETURN_IF_FAILED(CreateEnumTokenRange(_md_ptr.get(), _enumPool, cl, mdtTypeDef_FieldList, &filter, &enumImpl));
         *phEnum = enumImpl;
     }
     return enumImpl->ReadTokens(rFields, cMax, pcTokens);
@@ -897,7 +944,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumParams(
         if (TypeFromToken(mb) != mdtMethodDef)
             return E_INVALIDARG;
 
-        RETURN_IF_FAILED(CreateEnumTokenRange(_md_ptr.get(), mb, mdtMethodDef_ParamList, nullptr, &enumImpl));
+        RETURN_IF_FAILED(CreateEnumTokenRange(_md_ptr.get(), _enumPool, mb, mdtMethodDef_ParamList, nullptr, &enumImpl));
         *phEnum = enumImpl;
     }
     return enumImpl->ReadTokens(rParams, cMax, pcTokens);
@@ -919,31 +966,21 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumMemberRefs(
         if (!md_create_cursor(_md_ptr.get(), mdtid_MemberRef, &cursor, &count))
             return CLDB_E_RECORD_NOTFOUND;
 
-        RETURN_IF_FAILED(HCORENUMImpl::CreateDynamicEnum(&enumImpl));
+        RETURN_IF_FAILED(_enumPool.CreateDynamicEnum(&enumImpl));
 
         HCORENUMImpl_ptr cleanup{ enumImpl };
 
-        // Read in for matching in bulk
-        mdToken toMatch[64];
+        // Scan for matching rows in bulk
+        mdcursor_t matched[64];
         mdToken matchedTk;
-        uint32_t i = 0;
-        while (i < count)
+        int32_t read;
+        while ((read = md_scan_column_equals(&cursor, mdtMemberRef_Class, tkParent, ARRAY_SIZE(matched), matched)) > 0)
         {
-            int32_t read = md_get_column_value_as_token(cursor, mdtMemberRef_Class, ARRAY_SIZE(toMatch), toMatch);
-            if (read == 0)
-                break;
-
-            assert(read > 0);
             for (int32_t j = 0; j < read; ++j)
             {
-                if (toMatch[j] == tkParent)
-                {
-                    (void)md_cursor_to_token(cursor, &matchedTk);
-                    RETURN_IF_FAILED(HCORENUMImpl::AddToDynamicEnum(*enumImpl, matchedTk));
-                }
-                (void)md_cursor_next(&cursor);
+                (void)md_cursor_to_token(matched[j], &matchedTk);
+                RETURN_IF_FAILED(HCORENUMImpl::AddToDynamicEnum(*enumImpl, matchedTk));
             }
-            i += read;
         }
         *phEnum = cleanup.release();
     }
@@ -970,7 +1007,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumMethodImpls(
         if (!md_create_cursor(_md_ptr.get(), mdtid_MethodImpl, &cursor, &count))
             return CLDB_E_RECORD_NOTFOUND;
 
-        RETURN_IF_FAILED(HCORENUMImpl::CreateDynamicEnum(&enumImpl, 2));
+        RETURN_IF_FAILED(_enumPool.CreateDynamicEnum(&enumImpl, 2));
         HCORENUMImpl_ptr cleanup{ enumImpl };
 
         struct _Finder
@@ -1001,7 +1038,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumMethodImpls(
             }
         } finder{ *enumImpl, mdTokenNil, mdTokenNil, S_OK, S_OK };
 
-        EnumTableRange(cursor, count, mdtMethodImpl_Class, td, finder);
+        EnumTableRange(cursor, mdtMethodImpl_Class, td, finder);
         RETURN_IF_FAILED(finder.Result);
 
         *phEnum = cleanup.release();
@@ -1037,13 +1074,16 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumPermissionSets(
 
         if (!IsNilToken(tk))
         {
-            if (md_find_range_from_cursor(cursor, mdtDeclSecurity_Parent, tk, &cursor, &count) == MD_RANGE_NOT_FOUND)
+            if (!MayBeParent(_declSecurityPresence, _md_ptr.get(), tk)
+                || md_find_range_from_cursor(cursor, mdtDeclSecurity_Parent, tk, &cursor, &count) == MD_RANGE_NOT_FOUND)
+            {
                 return CLDB_E_RECORD_NOTFOUND;
+            }
         }
 
         if (IsNilToken(tk) && IsDclActionNil(dwActions))
         {
-            RETURN_IF_FAILED(HCORENUMImpl::CreateTableEnum(1, &enumImpl));
+            RETURN_IF_FAILED(_enumPool.CreateTableEnum(1, &enumImpl));
             HCORENUMImpl::InitTableEnum(*enumImpl, 0, cursor, count);
         }
         else
@@ -1051,9 +1091,14 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumPermissionSets(
             uint32_t action;
             mdToken parent;
             mdToken toAdd;
-            RETURN_IF_FAILED(HCORENUMImpl::CreateDynamicEnum(&enumImpl));
+            RETURN_IF_FAILED(_enumPool.CreateDynamicEnum(&enumImpl));
 
             HCORENUMImpl_ptr cleanup{ enumImpl };
+
+            // A parent's range bounds the matches, so size for it up front.
+            if (!IsNilToken(tk))
+                RETURN_IF_FAILED(HCORENUMImpl::ReserveDynamicEnum(*enumImpl, count));
+
             for (uint32_t i = 0; i < count; ++i)
             {
                 if ((IsDclActionNil(dwActions)
@@ -1077,6 +1122,160 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumPermissionSets(
     return enumImpl->ReadTokens(rPermission, cMax, pcTokens);
 }
 
+namespace
+{
+    // Check if a member has the supplied name and, if one is supplied, signature.
+    // Returns S_FALSE if the member doesn't match.
+    HRESULT IsMemberMatch(
+        mdcursor_t member,
+        col_index_t nameColumn,
+        char const* name,
+        col_index_t sigColumn,
+        uint8_t const* sig,
+        uint32_t sigLen)
+    {
+        char const* memberName;
+        if (1 != md_get_column_value_as_utf8(member, nameColumn, 1, &memberName))
+            return CLDB_E_FILE_CORRUPT;
+        if (::strcmp(memberName, name) != 0)
+            return S_FALSE;
+
+        if (sig != nullptr)
+        {
+            uint8_t const* memberSig;
+            uint32_t memberSigLen;
+            if (1 != md_get_column_value_as_blob(member, sigColumn, 1, &memberSig, &memberSigLen))
+                return CLDB_E_FILE_CORRUPT;
+            if (sigLen != memberSigLen
+                || ::memcmp(sig, memberSig, sigLen) != 0)
+            {
+                return S_FALSE;
+            }
+        }
+        return S_OK;
+    }
+
+    // Find the first member in the TypeDef's member list with the supplied name and signature, without an index.
+    HRESULT FindListedMember(
+        mdhandle_t handle,
+        mdToken parent,
+        col_index_t listColumn,
+        col_index_t flagsColumn,
+        uint32_t accessMask,
+        col_index_t nameColumn,
+        char const* name,
+        col_index_t sigColumn,
+        uint8_t const* sig,
+        uint32_t sigLen,
+        mdToken* member)
+    {
+        mdcursor_t typedefCursor;
+        mdcursor_t memberCursor;
+        uint32_t count;
+        if (!md_token_to_cursor(handle, parent, &typedefCursor)
+            || !md_get_column_value_as_range(typedefCursor, listColumn, &memberCursor, &count))
+        {
+            return CLDB_E_FILE_CORRUPT;
+        }
+
+        HRESULT hr;
+        for (uint32_t i = 0; i < count; (void)md_cursor_next(&memberCursor), ++i)
+        {
+            mdcursor_t target;
+            uint32_t flags;
+            if (!md_resolve_indirect_cursor(memberCursor, &target)
+                || 1 != md_get_column_value_as_constant(target, flagsColumn, 1, &flags))
+            {
+                return CLDB_E_FILE_CORRUPT;
+            }
+
+            // PrivateScope members have no access set and can only be referred to by token.
+            if ((flags & accessMask) == 0)
+                continue;
+
+            RETURN_IF_FAILED(IsMemberMatch(target, nameColumn, name, sigColumn, sig, sigLen));
+            if (hr == S_OK)
+                return md_cursor_to_token(target, member) ? S_OK : CLDB_E_FILE_CORRUPT;
+        }
+        return CLDB_E_RECORD_NOTFOUND;
+    }
+
+    // Find the first row of the table with the supplied parent, name and signature, without an index.
+    HRESULT FindChildMember(
+        mdhandle_t handle,
+        mdtable_id_t table,
+        col_index_t parentColumn,
+        mdToken parent,
+        col_index_t nameColumn,
+        char const* name,
+        col_index_t sigColumn,
+        uint8_t const* sig,
+        uint32_t sigLen,
+        mdToken* member)
+    {
+        mdcursor_t cursor;
+        uint32_t count;
+        if (!md_create_cursor(handle, table, &cursor, &count))
+            return CLDB_E_RECORD_NOTFOUND;
+
+        HRESULT hr;
+        for (uint32_t i = 0; i < count; (void)md_cursor_next(&cursor), ++i)
+        {
+            mdToken rowParent;
+            if (1 != md_get_column_value_as_token(cursor, parentColumn, 1, &rowParent))
+                return CLDB_E_FILE_CORRUPT;
+            if (rowParent != parent)
+                continue;
+
+            RETURN_IF_FAILED(IsMemberMatch(cursor, nameColumn, name, sigColumn, sig, sigLen));
+            if (hr == S_OK)
+                return md_cursor_to_token(cursor, member) ? S_OK : CLDB_E_FILE_CORRUPT;
+        }
+        return CLDB_E_RECORD_NOTFOUND;
+    }
+
+    // Find the first member of the parent, in member order, with the supplied name and signature.
+    // While the metadata is being edited, the index isn't rebuilt after every edit. Instead, the
+    // supplied search, with the signature of FindListedMember or FindChildMember bound to the
+    // member's table, is used until the metadata settles - see MetadataCache::GetIfSettled().
+    template<typename T, typename TSearch>
+    HRESULT FindIndexedMember(
+        MetadataCache<T>& cache,
+        mdhandle_t handle,
+        mdToken parent,
+        col_index_t nameColumn,
+        char const* name,
+        col_index_t sigColumn,
+        uint8_t const* sig,
+        uint32_t sigLen,
+        mdToken* member,
+        TSearch search)
+    {
+        HRESULT hr;
+        T const* index;
+        RETURN_IF_FAILED(cache.GetIfSettled(handle, &index));
+        if (hr == S_FALSE)
+            return search(handle, parent, nameColumn, name, sigColumn, sig, sigLen, member);
+
+        // The index narrows the search to the parent's members whose name has the same hash,
+        // so only those need their name and signature compared.
+        for (MemberIndex::Entry const& entry : index->Find(parent, name))
+        {
+            mdcursor_t cursor;
+            if (!md_token_to_cursor(handle, entry.Member, &cursor))
+                return CLDB_E_FILE_CORRUPT;
+
+            RETURN_IF_FAILED(IsMemberMatch(cursor, nameColumn, name, sigColumn, sig, sigLen));
+            if (hr == S_OK)
+            {
+                *member = entry.Member;
+                return S_OK;
+            }
+        }
+        return CLDB_E_RECORD_NOTFOUND;
+    }
+}
+
 HRESULT STDMETHODCALLTYPE MetadataImportRO::FindMember(
     mdTypeDef   td,
     LPCWSTR     szName,
@@ -1092,7 +1291,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::FindMember(
 
 HRESULT STDMETHODCALLTYPE MetadataImportRO::FindMethod(
     mdTypeDef   td,
-    LPCWSTR     szName,
+    char const* szName,
     PCCOR_SIGNATURE pvSigBlob,
     ULONG       cbSigBlob,
     mdMethodDef* pmb)
@@ -1100,6 +1299,9 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::FindMethod(
     if (TypeFromToken(td) != mdtTypeDef && td != mdTokenNil)
         return E_INVALIDARG;
 
+    if (szName == nullptr || pmb == nullptr)
+        return E_INVALIDARG;
+
     if (td == mdTypeDefNil || td == mdTokenNil)
         td = MD_GLOBAL_PARENT_TOKEN;
 
@@ -1107,11 +1309,6 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::FindMethod(
     if (!md_token_to_cursor(_md_ptr.get(), td, &typedefCursor))
         return CLDB_E_INDEX_NOTFOUND;
 
-    mdcursor_t methodCursor;
-    uint32_t count;
-    if (!md_get_column_value_as_range(typedefCursor, mdtTypeDef_MethodList, &methodCursor, &count))
-        return CLDB_E_FILE_CORRUPT;
-
     malloc_span<uint8_t> methodDefSig;
     try
     {
@@ -1122,52 +1319,42 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::FindMethod(
         return E_INVALIDARG;
     }
 
+    return FindIndexedMember(
+        _methodDefIndex,
+        _md_ptr.get(),
+        td,
+        mdtMethodDef_Name,
+        szName,
+        mdtMethodDef_Signature,
+        pvSigBlob != nullptr ? (uint8_t const*)methodDefSig : nullptr,
+        (uint32_t)methodDefSig.size(),
+        pmb,
+        [](mdhandle_t handle, mdToken parent, col_index_t nameColumn, char const* name, col_index_t sigColumn, uint8_t const* sig, uint32_t sigLen, mdToken* member)
+        {
+            return FindListedMember(handle, parent, mdtTypeDef_MethodList, mdtMethodDef_Flags, mdMemberAccessMask, nameColumn, name, sigColumn, sig, sigLen, member);
+        });
+}
+
+HRESULT STDMETHODCALLTYPE MetadataImportRO::FindMethod(
+    mdTypeDef   td,
+    LPCWSTR     szName,
+    PCCOR_SIGNATURE pvSigBlob,
+    ULONG       cbSigBlob,
+    mdMethodDef* pmb)
+{
+    if (szName == nullptr)
+        return E_INVALIDARG;
+
     pal::StringConvert<WCHAR, char> cvt{ szName };
     if (!cvt.Success())
         return E_INVALIDARG;
 
-    for (uint32_t i = 0; i < count; (void)md_cursor_next(&methodCursor), ++i)
-    {
-        mdcursor_t target;
-        if (!md_resolve_indirect_cursor(methodCursor, &target))
-            return CLDB_E_FILE_CORRUPT;
-        uint32_t flags;
-        if (1 != md_get_column_value_as_constant(target, mdtMethodDef_Flags, 1, &flags))
-            return CLDB_E_FILE_CORRUPT;
-
-        // Ignore PrivateScope methods. By the spec, they can only be referred to by a MethodDef token
-        // and cannot be discovered in any other way.
-        if (IsMdPrivateScope(flags))
-            continue;
-
-        char const* methodName;
-        if (1 != md_get_column_value_as_utf8(target, mdtMethodDef_Name, 1, &methodName))
-            return CLDB_E_FILE_CORRUPT;
-        if (::strncmp(methodName, cvt, cvt.Length()) != 0)
-            continue;
-
-        if (pvSigBlob != nullptr)
-        {
-            uint8_t const* sig;
-            uint32_t sigLen;
-            if (1 != md_get_column_value_as_blob(target, mdtMethodDef_Signature, 1, &sig, &sigLen))
-                return CLDB_E_FILE_CORRUPT;
-            if (sigLen != methodDefSig.size()
-                || ::memcmp(methodDefSig, sig, sigLen) != 0)
-            {
-                continue;
-            }
-        }
-        if (!md_cursor_to_token(target, pmb))
-            return CLDB_E_FILE_CORRUPT;
-        return S_OK;
-    }
-    return CLDB_E_RECORD_NOTFOUND;
+    return FindMethod(td, cvt, pvSigBlob, cbSigBlob, pmb);
 }
 
 HRESULT STDMETHODCALLTYPE MetadataImportRO::FindField(
     mdTypeDef   td,
-    LPCWSTR     szName,
+    char const* szName,
     PCCOR_SIGNATURE pvSigBlob,
     ULONG       cbSigBlob,
     mdFieldDef* pmb)
@@ -1175,6 +1362,9 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::FindField(
     if (TypeFromToken(td) != mdtTypeDef && td != mdTokenNil)
         return E_INVALIDARG;
 
+    if (szName == nullptr || pmb == nullptr)
+        return E_INVALIDARG;
+
     if (td == mdTypeDefNil || td == mdTokenNil)
         td = MD_GLOBAL_PARENT_TOKEN;
 
@@ -1182,57 +1372,42 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::FindField(
     if (!md_token_to_cursor(_md_ptr.get(), td, &typedefCursor))
         return CLDB_E_INDEX_NOTFOUND;
 
-    mdcursor_t fieldCursor;
-    uint32_t count;
-    if (!md_get_column_value_as_range(typedefCursor, mdtTypeDef_FieldList, &fieldCursor, &count))
-        return CLDB_E_FILE_CORRUPT;
+    return FindIndexedMember(
+        _fieldIndex,
+        _md_ptr.get(),
+        td,
+        mdtField_Name,
+        szName,
+        mdtField_Signature,
+        pvSigBlob,
+        cbSigBlob,
+        pmb,
+        [](mdhandle_t handle, mdToken parent, col_index_t nameColumn, char const* name, col_index_t sigColumn, uint8_t const* sig, uint32_t sigLen, mdToken* member)
+        {
+            return FindListedMember(handle, parent, mdtTypeDef_FieldList, mdtField_Flags, fdFieldAccessMask, nameColumn, name, sigColumn, sig, sigLen, member);
+        });
+}
+
+HRESULT STDMETHODCALLTYPE MetadataImportRO::FindField(
+    mdTypeDef   td,
+    LPCWSTR     szName,
+    PCCOR_SIGNATURE pvSigBlob,
+    ULONG       cbSigBlob,
+    mdFieldDef* pmb)
+{
+    if (szName == nullptr)
+        return E_INVALIDARG;
 
     pal::StringConvert<WCHAR, char> cvt{ szName };
     if (!cvt.Success())
         return E_INVALIDARG;
 
-    for (uint32_t i = 0; i < count; (void)md_cursor_next(&fieldCursor), ++i)
-    {
-        mdcursor_t target;
-        if (!md_resolve_indirect_cursor(fieldCursor, &target))
-            return CLDB_E_FILE_CORRUPT;
-        uint32_t flags;
-        if (1 != md_get_column_value_as_constant(target, mdtField_Flags, 1, &flags))
-            return CLDB_E_FILE_CORRUPT;
-
-        // Ignore PrivateScope fields. By the spec, they can only be referred to by a FieldDef token
-        // and cannot be discovered in any other way.
-        if (IsFdPrivateScope(flags))
-            continue;
-
-        char const* name;
-        if (1 != md_get_column_value_as_utf8(target, mdtField_Name, 1, &name))
-            return CLDB_E_FILE_CORRUPT;
-        if (::strncmp(name, cvt, cvt.Length()) != 0)
-            continue;
-
-        if (pvSigBlob != nullptr)
-        {
-            uint8_t const* sig;
-            uint32_t sigLen;
-            if (1 != md_get_column_value_as_blob(target, mdtField_Signature, 1, &sig, &sigLen))
-                return CLDB_E_FILE_CORRUPT;
-            if (cbSigBlob != sigLen
-                || ::memcmp(pvSigBlob, sig, sigLen) != 0)
-            {
-                continue;
-            }
-        }
-        if (!md_cursor_to_token(target, pmb))
-            return CLDB_E_FILE_CORRUPT;
-        return S_OK;
-    }
-    return CLDB_E_RECORD_NOTFOUND;
+    return FindField(td, cvt, pvSigBlob, cbSigBlob, pmb);
 }
 
 HRESULT STDMETHODCALLTYPE MetadataImportRO::FindMemberRef(
-    mdTypeRef   td,
-    LPCWSTR     szName,
+    mdToken     td,
+    char const* szName,
     PCCOR_SIGNATURE pvSigBlob,
     ULONG       cbSigBlob,
     mdMemberRef* pmr)
@@ -1252,58 +1427,43 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::FindMemberRef(
     if (IsNilToken(td))
         td = MD_GLOBAL_PARENT_TOKEN;
 
-    mdcursor_t cursor;
-    uint32_t count;
-    if (!md_create_cursor(_md_ptr.get(), mdtid_MemberRef, &cursor, &count))
-        return CLDB_E_FILE_CORRUPT;
-
-    for (uint32_t i = 0; i < count; (void)md_cursor_next(&cursor), ++i)
-    {
-        mdToken refParent;
-        if (1 != md_get_column_value_as_token(cursor, mdtMemberRef_Class, 1, &refParent))
-            return CLDB_E_FILE_CORRUPT;
+    return FindIndexedMember(
+        _memberRefIndex,
+        _md_ptr.get(),
+        td,
+        mdtMemberRef_Name,
+        szName,
+        mdtMemberRef_Signature,
+        pvSigBlob,
+        cbSigBlob,
+        pmr,
+        [](mdhandle_t handle, mdToken parent, col_index_t nameColumn, char const* name, col_index_t sigColumn, uint8_t const* sig, uint32_t sigLen, mdToken* member)
+        {
+            return FindChildMember(handle, mdtid_MemberRef, mdtMemberRef_Class, parent, nameColumn, name, sigColumn, sig, sigLen, member);
+        });
+}
 
-        if (refParent != td)
-            continue;
+HRESULT STDMETHODCALLTYPE MetadataImportRO::FindMemberRef(
+    mdTypeRef   td,
+    LPCWSTR     szName,
+    PCCOR_SIGNATURE pvSigBlob,
+    ULONG       cbSigBlob,
+    mdMemberRef* pmr)
+{
+    if (szName == nullptr)
+        return FindMemberRef(td, static_cast<char const*>(nullptr), pvSigBlob, cbSigBlob, pmr);
 
-        if (szName != nullptr)
-        {
-            char const* name;
-            if (1 != md_get_column_value_as_utf8(cursor, mdtMemberRef_Name, 1, &name))
-                return CLDB_E_FILE_CORRUPT;
-            pal::StringConvert<WCHAR, char> cvt{ szName };
-            if (!cvt.Success())
-                return E_INVALIDARG;
-            if (::strncmp(name, cvt, cvt.Length()) != 0)
-                continue;
-        }
+    pal::StringConvert<WCHAR, char> cvt{ szName };
+    if (!cvt.Success())
+        return E_INVALIDARG;
 
-        if (pvSigBlob != nullptr)
-        {
-            uint8_t const* sig;
-            uint32_t sigLen;
-            if (1 != md_get_column_value_as_blob(cursor, mdtMemberRef_Signature, 1, &sig, &sigLen))
-                return CLDB_E_FILE_CORRUPT;
-            if (cbSigBlob != sigLen
-                || ::memcmp(pvSigBlob, sig, sigLen) != 0)
-            {
-                continue;
-            }
-        }
-        if (!md_cursor_to_token(cursor, pmr))
-            return CLDB_E_FILE_CORRUPT;
-        return S_OK;
-    }
-    return CLDB_E_RECORD_NOTFOUND;
+    return FindMemberRef(td, cvt, pvSigBlob, cbSigBlob, pmr);
 }
 
 HRESULT STDMETHODCALLTYPE MetadataImportRO::GetMethodProps(
     mdMethodDef mb,
     mdTypeDef* pClass,
-    _Out_writes_to_opt_(cchMethod, *pchMethod)
-    LPWSTR      szMethod,
-    ULONG       cchMethod,
-    ULONG* pchMethod,
+    char const** pszMethod,
     DWORD* pdwAttr,
     PCCOR_SIGNATURE* ppvSigBlob,
     ULONG* pcbSigBlob,
@@ -1347,16 +1507,33 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetMethodProps(
     char const* name;
     if (1 != md_get_column_value_as_utf8(cursor, mdtMethodDef_Name, 1, &name))
         return CLDB_E_FILE_CORRUPT;
+    *pszMethod = name;
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE MetadataImportRO::GetMethodProps(
+    mdMethodDef mb,
+    mdTypeDef* pClass,
+    _Out_writes_to_opt_(cchMethod, *pchMethod)
+    LPWSTR      szMethod,
+    ULONG       cchMethod,
+    ULONG* pchMethod,
+    DWORD* pdwAttr,
+    PCCOR_SIGNATURE* ppvSigBlob,
+    ULONG* pcbSigBlob,
+    ULONG* pulCodeRVA,
+    DWORD* pdwImplFlags)
+{
+    HRESULT hr;
+    char const* name;
+    RETURN_IF_FAILED(GetMethodProps(mb, pClass, &name, pdwAttr, ppvSigBlob, pcbSigBlob, pulCodeRVA, pdwImplFlags));
     return ConvertAndReturnStringOutput(name, szMethod, cchMethod, pchMethod);
 }
 
 HRESULT STDMETHODCALLTYPE MetadataImportRO::GetMemberRefProps(
     mdMemberRef mr,
     mdToken* ptk,
-    _Out_writes_to_opt_(cchMember, *pchMember)
-    LPWSTR      szMember,
-    ULONG       cchMember,
-    ULONG* pchMember,
+    char const** pszMember,
     PCCOR_SIGNATURE* ppvSigBlob,
     ULONG* pbSig)
 {
@@ -1384,6 +1561,23 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetMemberRefProps(
     char const* name;
     if (1 != md_get_column_value_as_utf8(cursor, mdtMemberRef_Name, 1, &name))
         return CLDB_E_FILE_CORRUPT;
+    *pszMember = name;
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE MetadataImportRO::GetMemberRefProps(
+    mdMemberRef mr,
+    mdToken* ptk,
+    _Out_writes_to_opt_(cchMember, *pchMember)
+    LPWSTR      szMember,
+    ULONG       cchMember,
+    ULONG* pchMember,
+    PCCOR_SIGNATURE* ppvSigBlob,
+    ULONG* pbSig)
+{
+    HRESULT hr;
+    char const* name;
+    RETURN_IF_FAILED(GetMemberRefProps(mr, ptk, &name, ppvSigBlob, pbSig));
     return ConvertAndReturnStringOutput(name, szMember, cchMember, pchMember);
 }
 
@@ -1418,7 +1612,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumProperties(
             return CLDB_E_FILE_CORRUPT;
         }
 
-        RETURN_IF_FAILED(HCORENUMImpl::CreateTableEnum(1, &enumImpl));
+        RETURN_IF_FAILED(_enumPool.CreateTableEnum(1, &enumImpl));
         HCORENUMImpl::InitTableEnum(*enumImpl, 0, propertyList, propertyListCount);
         *phEnum = enumImpl;
     }
@@ -1456,7 +1650,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumEvents(
             return CLDB_E_FILE_CORRUPT;
         }
 
-        RETURN_IF_FAILED(HCORENUMImpl::CreateTableEnum(1, &enumImpl));
+        RETURN_IF_FAILED(_enumPool.CreateTableEnum(1, &enumImpl));
         HCORENUMImpl::InitTableEnum(*enumImpl, 0, eventList, eventListCount);
         *phEnum = enumImpl;
     }
@@ -1546,7 +1740,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetEventProps(
         }
     } finder{ mdMethodDefNil, mdMethodDefNil, mdMethodDefNil, rmdOtherMethod, cMax, 0, S_OK };
 
-    EnumTableRange(methodSemCursor, methodSemCount, mdtMethodSemantics_Association, ev, finder);
+    EnumTableRange(methodSemCursor, mdtMethodSemantics_Association, ev, finder);
 
     HRESULT hr;
     RETURN_IF_FAILED(finder.Result);
@@ -1583,32 +1777,22 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumMethodSemantics(
         if (!md_create_cursor(_md_ptr.get(), mdtid_MethodSemantics, &cursor, &count))
             return CLDB_E_RECORD_NOTFOUND;
 
-        RETURN_IF_FAILED(HCORENUMImpl::CreateDynamicEnum(&enumImpl));
+        RETURN_IF_FAILED(_enumPool.CreateDynamicEnum(&enumImpl));
 
         HCORENUMImpl_ptr cleanup{ enumImpl };
 
-        // Read in for matching in bulk
-        mdToken toMatch[64];
+        // Scan for matching rows in bulk
+        mdcursor_t matched[64];
         mdToken matchedTk;
-        uint32_t i = 0;
-        while (i < count)
+        int32_t read;
+        while ((read = md_scan_column_equals(&cursor, mdtMethodSemantics_Method, mb, ARRAY_SIZE(matched), matched)) > 0)
         {
-            int32_t read = md_get_column_value_as_token(cursor, mdtMethodSemantics_Method, ARRAY_SIZE(toMatch), toMatch);
-            if (read == 0)
-                break;
-
-            assert(read > 0);
             for (int32_t j = 0; j < read; ++j)
             {
-                if (toMatch[j] == mb)
-                {
-                    if (1 != md_get_column_value_as_token(cursor, mdtMethodSemantics_Association, 1, &matchedTk))
-                        return CLDB_E_FILE_CORRUPT;
-                    RETURN_IF_FAILED(HCORENUMImpl::AddToDynamicEnum(*enumImpl, matchedTk));
-                }
-                (void)md_cursor_next(&cursor);
+                if (1 != md_get_column_value_as_token(matched[j], mdtMethodSemantics_Association, 1, &matchedTk))
+                    return CLDB_E_FILE_CORRUPT;
+                RETURN_IF_FAILED(HCORENUMImpl::AddToDynamicEnum(*enumImpl, matchedTk));
             }
-            i += read;
         }
         *phEnum = cleanup.release();
     }
@@ -1650,7 +1834,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetMethodSemantics(
         }
     } finder{ mb, 0, CLDB_E_RECORD_NOTFOUND };
 
-    EnumTableRange(cursor, count, mdtMethodSemantics_Association, tkEventProp, finder);
+    EnumTableRange(cursor, mdtMethodSemantics_Association, tkEventProp, finder);
 
     HRESULT hr;
     RETURN_IF_FAILED(finder.Result);
@@ -1758,7 +1942,8 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetFieldMarshal(
     mdcursor_t cursor;
     uint32_t count;
     mdcursor_t fieldMarshalRow;
-    if (!md_create_cursor(_md_ptr.get(), mdtid_FieldMarshal, &cursor, &count)
+    if (!MayBeParent(_fieldMarshalPresence, _md_ptr.get(), tk)
+        || !md_create_cursor(_md_ptr.get(), mdtid_FieldMarshal, &cursor, &count)
         || !md_find_row_from_cursor(cursor, mdtFieldMarshal_Parent, tk, &fieldMarshalRow))
     {
         return CLDB_E_RECORD_NOTFOUND;
@@ -1872,10 +2057,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetSigFromToken(
 
 HRESULT STDMETHODCALLTYPE MetadataImportRO::GetModuleRefProps(
     mdModuleRef mur,
-    _Out_writes_to_opt_(cchName, *pchName)
-    LPWSTR      szName,
-    ULONG       cchName,
-    ULONG* pchName)
+    char const** pszName)
 {
     if (TypeFromToken(mur) != mdtModuleRef)
         return E_INVALIDARG;
@@ -1887,6 +2069,20 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetModuleRefProps(
     char const* name;
     if (1 != md_get_column_value_as_utf8(cursor, mdtModuleRef_Name, 1, &name))
         return CLDB_E_FILE_CORRUPT;
+    *pszName = name;
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE MetadataImportRO::GetModuleRefProps(
+    mdModuleRef mur,
+    _Out_writes_to_opt_(cchName, *pchName)
+    LPWSTR      szName,
+    ULONG       cchName,
+    ULONG* pchName)
+{
+    HRESULT hr;
+    char const* name;
+    RETURN_IF_FAILED(GetModuleRefProps(mur, &name));
     return ConvertAndReturnStringOutput(name, szName, cchName, pchName);
 }
 
@@ -1900,7 +2096,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumModuleRefs(
     HCORENUMImpl* enumImpl = ToHCORENUMImpl(*phEnum);
     if (enumImpl == nullptr)
     {
-        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), mdtid_ModuleRef, &enumImpl));
+        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), _enumPool, mdtid_ModuleRef, &enumImpl));
         *phEnum = enumImpl;
     }
     return enumImpl->ReadTokens(rModuleRefs, cMax, pcModuleRefs);
@@ -2045,7 +2241,8 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetPinvokeMap(
     mdcursor_t cursor;
     uint32_t count;
     mdcursor_t implRow;
-    if (!md_create_cursor(_md_ptr.get(), mdtid_ImplMap, &cursor, &count)
+    if (!MayBeParent(_implMapPresence, _md_ptr.get(), tk)
+        || !md_create_cursor(_md_ptr.get(), mdtid_ImplMap, &cursor, &count)
         || !md_find_row_from_cursor(cursor, mdtImplMap_MemberForwarded, tk, &implRow))
     {
         return CLDB_E_RECORD_NOTFOUND;
@@ -2077,7 +2274,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumSignatures(
     HCORENUMImpl* enumImpl = ToHCORENUMImpl(*phEnum);
     if (enumImpl == nullptr)
     {
-        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), mdtid_StandAloneSig, &enumImpl));
+        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), _enumPool, mdtid_StandAloneSig, &enumImpl));
         *phEnum = enumImpl;
     }
     return enumImpl->ReadTokens(rSignatures, cMax, pcSignatures);
@@ -2093,7 +2290,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumTypeSpecs(
     HCORENUMImpl* enumImpl = ToHCORENUMImpl(*phEnum);
     if (enumImpl == nullptr)
     {
-        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), mdtid_TypeSpec, &enumImpl));
+        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), _enumPool, mdtid_TypeSpec, &enumImpl));
         *phEnum = enumImpl;
     }
     return enumImpl->ReadTokens(rTypeSpecs, cMax, pcTypeSpecs);
@@ -2109,7 +2306,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumUserStrings(
     HCORENUMImpl* enumImpl = ToHCORENUMImpl(*phEnum);
     if (enumImpl == nullptr)
     {
-        RETURN_IF_FAILED(HCORENUMImpl::CreateDynamicEnum(&enumImpl));
+        RETURN_IF_FAILED(_enumPool.CreateDynamicEnum(&enumImpl));
 
         HCORENUMImpl_ptr cleanup{ enumImpl };
         mduserstring_t us;
@@ -2199,9 +2396,14 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumCustomAttributes(
         {
             // Caller is looking across all attributes
             assert(IsNilToken(tkType)); // Ignoring type filter
-            RETURN_IF_FAILED(HCORENUMImpl::CreateTableEnum(1, &enumImpl));
+            RETURN_IF_FAILED(_enumPool.CreateTableEnum(1, &enumImpl));
             HCORENUMImpl::InitTableEnum(*enumImpl, 0, cursor, count);
         }
+        else if (!MayBeParent(_customAttributePresence, _md_ptr.get(), tk))
+        {
+            // The parent has no attributes, so create an empty enumeration.
+            RETURN_IF_FAILED(_enumPool.CreateDynamicEnum(&enumImpl));
+        }
         else
         {
             md_range_result_t result = md_find_range_from_cursor(cursor, mdtCustomAttribute_Parent, tk, &curr, &currCount);
@@ -2210,47 +2412,55 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumCustomAttributes(
                 // Caller is looking for all associated attributes and we got a table range.
                 if (result == MD_RANGE_FOUND)
                 {
-                    RETURN_IF_FAILED(HCORENUMImpl::CreateTableEnum(1, &enumImpl));
+                    RETURN_IF_FAILED(_enumPool.CreateTableEnum(1, &enumImpl));
                     HCORENUMImpl::InitTableEnum(*enumImpl, 0, curr, currCount);
                 }
                 else if (result == MD_RANGE_NOT_FOUND)
                 {
                     // If there are no tokens found, create an empty enumeration.
-                    RETURN_IF_FAILED(HCORENUMImpl::CreateDynamicEnum(&enumImpl));
+                    RETURN_IF_FAILED(_enumPool.CreateDynamicEnum(&enumImpl));
                 }
             }
             else
             {
-                RETURN_IF_FAILED(HCORENUMImpl::CreateDynamicEnum(&enumImpl));
+                RETURN_IF_FAILED(_enumPool.CreateDynamicEnum(&enumImpl));
 
                 HCORENUMImpl_ptr cleanup{ enumImpl };
 
-                // We need to search across the entire table as we couldn't get a range.
-                curr = cursor;
-                currCount = count;
-
-                // Read in for matching in bulk
-                mdToken toMatch[64];
-                mdToken matchedTk;
-                uint32_t i = 0;
-                while (i < currCount)
+                // Collect the parent's attributes, filtered by type if requested.
+                // The parent's range is used if available, otherwise the table is scanned.
+                struct _Finder
                 {
-                    int32_t read = md_get_column_value_as_token(curr, mdtCustomAttribute_Parent, ARRAY_SIZE(toMatch), toMatch);
-                    if (read == 0)
-                        break;
+                    HCORENUMImpl& EnumImpl;
+                    mdToken Type;
+                    HRESULT Result; // Result of the operation
 
-                    assert(read > 0);
-                    for (int32_t j = 0; j < read; ++j)
+                    bool operator()(mdcursor_t c)
                     {
-                        if (toMatch[j] == tkType)
+                        mdToken type;
+                        if (!IsNilToken(Type))
                         {
-                            (void)md_cursor_to_token(curr, &matchedTk);
-                            RETURN_IF_FAILED(HCORENUMImpl::AddToDynamicEnum(*enumImpl, matchedTk));
+                            if (1 != md_get_column_value_as_token(c, mdtCustomAttribute_Type, 1, &type))
+                            {
+                                Result = CLDB_E_FILE_CORRUPT;
+                                return true;
+                            }
+                            if (type != Type)
+                                return false;
                         }
-                        (void)md_cursor_next(&curr);
+
+                        mdToken matchedTk;
+                        (void)md_cursor_to_token(c, &matchedTk);
+                        if (FAILED(Result = HCORENUMImpl::AddToDynamicEnum(EnumImpl, matchedTk)))
+                            return true;
+
+                        return false;
                     }
-                    i += read;
-                }
+                } finder{ *enumImpl, tkType, S_OK };
+
+                EnumTableRange(cursor, mdtCustomAttribute_Parent, tk, finder);
+                RETURN_IF_FAILED(finder.Result);
+
                 enumImpl = cleanup.release();
             }
         }
@@ -2295,14 +2505,30 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetCustomAttributeProps(
 
 HRESULT STDMETHODCALLTYPE MetadataImportRO::FindTypeRef(
     mdToken     tkResolutionScope,
-    LPCWSTR     szName,
+    char const* szNamespace,
+    char const* szName,
     mdTypeRef* ptr)
 {
+    if (szNamespace == nullptr || szName == nullptr || ptr == nullptr)
+        return E_INVALIDARG;
+
+    // The resolution scope must match exactly, including a nil scope.
     mdcursor_t cursor;
-    uint32_t count;
-    if (!md_create_cursor(_md_ptr.get(), mdtid_TypeRef, &cursor, &count))
+    if (!md_find_type_ref(_md_ptr.get(), tkResolutionScope, szNamespace, szName, &cursor))
         return CLDB_E_RECORD_NOTFOUND;
 
+    (void)md_cursor_to_token(cursor, ptr);
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE MetadataImportRO::FindTypeRef(
+    mdToken     tkResolutionScope,
+    LPCWSTR     szName,
+    mdTypeRef* ptr)
+{
+    if (szName == nullptr)
+        return E_INVALIDARG;
+
     pal::StringConvert<WCHAR, char> cvt{ szName };
     if (!cvt.Success())
         return E_INVALIDARG;
@@ -2310,40 +2536,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::FindTypeRef(
     char const* nspace;
     char const* name;
     SplitTypeName(cvt, &nspace, &name);
-
-    bool scopeIsSet = !IsNilToken(tkResolutionScope);
-    mdToken resMaybe;
-    char const* str;
-    for (uint32_t i = 0; i < count; (void)md_cursor_next(&cursor), ++i)
-    {
-        if (1 != md_get_column_value_as_token(cursor, mdtTypeRef_ResolutionScope, 1, &resMaybe))
-            return CLDB_E_FILE_CORRUPT;
-
-        // See if the Resolution scopes match.
-        if ((IsNilToken(resMaybe) && scopeIsSet)    // User didn't state scope.
-            || resMaybe != tkResolutionScope)       // Match user scope.
-        {
-            continue;
-        }
-
-        if (1 != md_get_column_value_as_utf8(cursor, mdtTypeRef_TypeNamespace, 1, &str))
-            return CLDB_E_FILE_CORRUPT;
-
-        if (0 != ::strcmp(nspace, str))
-            continue;
-
-        if (1 != md_get_column_value_as_utf8(cursor, mdtTypeRef_TypeName, 1, &str))
-            return CLDB_E_FILE_CORRUPT;
-
-        if (0 == ::strcmp(name, str))
-        {
-            (void)md_cursor_to_token(cursor, ptr);
-            return S_OK;
-        }
-    }
-
-    // Not found.
-    return CLDB_E_RECORD_NOTFOUND;
+    return FindTypeRef(tkResolutionScope, nspace, name, ptr);
 }
 
 HRESULT STDMETHODCALLTYPE MetadataImportRO::GetMemberProps(
@@ -2400,6 +2593,7 @@ namespace
 {
     HRESULT FindConstant(
         mdhandle_view ptr,
+        MetadataCache<ConstantPresence>& presence,
         uint32_t lookupValue,
         DWORD& cnstCorType,
         UVCP_CONSTANT& cnst,
@@ -2413,7 +2607,8 @@ namespace
         uint32_t corType;
         uint8_t const* defaultValue;
         uint32_t defaultValueLen;
-        if (!md_create_cursor(ptr.get(), mdtid_Constant, &constantCursor, &constantCount)
+        if (!MayBeParent(presence, ptr.get(), lookupValue)
+            || !md_create_cursor(ptr.get(), mdtid_Constant, &constantCursor, &constantCount)
             || !md_find_row_from_cursor(constantCursor, mdtConstant_Parent, lookupValue, &constantPropCursor))
         {
             corType = ELEMENT_TYPE_VOID;
@@ -2440,10 +2635,7 @@ namespace
 HRESULT STDMETHODCALLTYPE MetadataImportRO::GetFieldProps(
     mdFieldDef  mb,
     mdTypeDef* pClass,
-    _Out_writes_to_opt_(cchField, *pchField)
-    LPWSTR      szField,
-    ULONG       cchField,
-    ULONG* pchField,
+    char const** pszField,
     DWORD* pdwAttr,
     PCCOR_SIGNATURE* ppvSigBlob,
     ULONG* pcbSigBlob,
@@ -2476,11 +2668,32 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetFieldProps(
     *pcbSigBlob = sigLen;
 
     HRESULT hr;
-    RETURN_IF_FAILED(FindConstant(_md_ptr, mb, *pdwCPlusTypeFlag, *ppValue, *pcchValue));
+    RETURN_IF_FAILED(FindConstant(_md_ptr, _constantPresence, mb, *pdwCPlusTypeFlag, *ppValue, *pcchValue));
 
     char const* name;
     if (1 != md_get_column_value_as_utf8(cursor, mdtField_Name, 1, &name))
         return CLDB_E_FILE_CORRUPT;
+    *pszField = name;
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE MetadataImportRO::GetFieldProps(
+    mdFieldDef  mb,
+    mdTypeDef* pClass,
+    _Out_writes_to_opt_(cchField, *pchField)
+    LPWSTR      szField,
+    ULONG       cchField,
+    ULONG* pchField,
+    DWORD* pdwAttr,
+    PCCOR_SIGNATURE* ppvSigBlob,
+    ULONG* pcbSigBlob,
+    DWORD* pdwCPlusTypeFlag,
+    UVCP_CONSTANT* ppValue,
+    ULONG* pcchValue)
+{
+    HRESULT hr;
+    char const* name;
+    RETURN_IF_FAILED(GetFieldProps(mb, pClass, &name, pdwAttr, ppvSigBlob, pcbSigBlob, pdwCPlusTypeFlag, ppValue, pcchValue));
     return ConvertAndReturnStringOutput(name, szField, cchField, pchField);
 }
 
@@ -2528,7 +2741,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetPropertyProps(
     *pbSig = sigLen;
 
     HRESULT hr;
-    RETURN_IF_FAILED(FindConstant(_md_ptr, prop, *pdwCPlusTypeFlag, *ppDefaultValue, *pcchDefaultValue));
+    RETURN_IF_FAILED(FindConstant(_md_ptr, _constantPresence, prop, *pdwCPlusTypeFlag, *ppDefaultValue, *pcchDefaultValue));
 
     mdcursor_t methodSemCursor;
     uint32_t methodSemCount;
@@ -2572,7 +2785,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetPropertyProps(
         }
     } finder{ mdMethodDefNil, mdMethodDefNil, rmdOtherMethod, cMax, 0, S_OK };
 
-    EnumTableRange(methodSemCursor, methodSemCount, mdtMethodSemantics_Association, prop, finder);
+    EnumTableRange(methodSemCursor, mdtMethodSemantics_Association, prop, finder);
 
     RETURN_IF_FAILED(finder.Result);
 
@@ -2593,10 +2806,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetParamProps(
     mdParamDef  tk,
     mdMethodDef* pmd,
     ULONG* pulSequence,
-    _Out_writes_to_opt_(cchName, *pchName)
-    LPWSTR      szName,
-    ULONG       cchName,
-    ULONG* pchName,
+    char const** pszName,
     DWORD* pdwAttr,
     DWORD* pdwCPlusTypeFlag,
     UVCP_CONSTANT* ppValue,
@@ -2625,93 +2835,103 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetParamProps(
     *pdwAttr = flags;
 
     HRESULT hr;
-    RETURN_IF_FAILED(FindConstant(_md_ptr, tk, *pdwCPlusTypeFlag, *ppValue, *pcchValue));
+    RETURN_IF_FAILED(FindConstant(_md_ptr, _constantPresence, tk, *pdwCPlusTypeFlag, *ppValue, *pcchValue));
 
     char const* name;
     if (1 != md_get_column_value_as_utf8(cursor, mdtParam_Name, 1, &name))
         return CLDB_E_FILE_CORRUPT;
-    return ConvertAndReturnStringOutput(name, szName, cchName, pchName);
+    *pszName = name;
+    return S_OK;
 }
 
-namespace
+HRESULT STDMETHODCALLTYPE MetadataImportRO::GetParamProps(
+    mdParamDef  tk,
+    mdMethodDef* pmd,
+    ULONG* pulSequence,
+    _Out_writes_to_opt_(cchName, *pchName)
+    LPWSTR      szName,
+    ULONG       cchName,
+    ULONG* pchName,
+    DWORD* pdwAttr,
+    DWORD* pdwCPlusTypeFlag,
+    UVCP_CONSTANT* ppValue,
+    ULONG* pcchValue)
 {
-    // See TypeSpec definition at II.23.2.14
-    HRESULT ExtractTypeDefRefFromSpec(uint8_t const* specBlob, uint32_t specBlobLen, mdToken& tk)
-    {
-        assert(specBlob != nullptr);
-        if (specBlobLen == 0)
-            return COR_E_BADIMAGEFORMAT;
-
-        PCCOR_SIGNATURE sig = specBlob;
-        PCCOR_SIGNATURE sigEnd = specBlob + specBlobLen;
-
-        ULONG data;
-        sig += CorSigUncompressData(sig, &data);
+    HRESULT hr;
+    char const* name;
+    RETURN_IF_FAILED(GetParamProps(tk, pmd, pulSequence, &name, pdwAttr, pdwCPlusTypeFlag, ppValue, pcchValue));
+    return ConvertAndReturnStringOutput(name, szName, cchName, pchName);
+}
 
-        while (sig < sigEnd
-            && (CorIsModifierElementType((CorElementType)data)
-                || data == ELEMENT_TYPE_GENERICINST))
-        {
-            sig += CorSigUncompressData(sig, &data);
-        }
+HRESULT STDMETHODCALLTYPE MetadataImportRO::GetCustomAttributeByName(
+    mdToken     tkObj,
+    char const* szName,
+    void const** ppData,
+    ULONG* pcbData)
+{
+    if (szName == nullptr || ppData == nullptr || pcbData == nullptr)
+        return E_INVALIDARG;
 
-        if (sig >= sigEnd)
-            return COR_E_BADIMAGEFORMAT;
+    *ppData = nullptr;
+    *pcbData = 0;
 
-        if (data == ELEMENT_TYPE_VALUETYPE || data == ELEMENT_TYPE_CLASS)
-        {
-            if (mdTokenNil == CorSigUncompressToken(sig, &tk))
-                return COR_E_BADIMAGEFORMAT;
-            return S_OK;
-        }
+    mdcursor_t cursor;
+    uint32_t count;
+    if (!md_create_cursor(_md_ptr.get(), mdtid_CustomAttribute, &cursor, &count))
+        return S_FALSE; // If no custom attributes are defined, treat it the same as if the attribute is not found.
 
-        tk = mdTokenNil;
+    if (!IsNilToken(tkObj) && !MayBeParent(_customAttributePresence, _md_ptr.get(), tkObj))
         return S_FALSE;
-    }
 
-    HRESULT ResolveTypeDefRefSpecToName(mdcursor_t cursor, char const** nspace, char const** name)
+    // Returns S_OK and the attribute's value if its type has the requested name.
+    auto matchAttribute = [&](mdcursor_t custAttrCurr) -> HRESULT
     {
-        assert(nspace != nullptr && name != nullptr);
-
         HRESULT hr;
-        mdToken typeTk;
-        if (!md_cursor_to_token(cursor, &typeTk))
-            return E_FAIL;
-
-        uint8_t const* specBlob;
-        uint32_t specBlobLen;
-        uint32_t tokenType = TypeFromToken(typeTk);
-        while (tokenType == mdtTypeSpec)
-        {
-            if (1 != md_get_column_value_as_blob(cursor, mdtTypeSpec_Signature, 1, &specBlob, &specBlobLen))
-                return CLDB_E_FILE_CORRUPT;
-
-            RETURN_IF_FAILED(ExtractTypeDefRefFromSpec(specBlob, specBlobLen, typeTk));
-            if (typeTk == mdTokenNil)
-                return S_FALSE;
+        char const* nspace;
+        char const* name;
+        RETURN_IF_FAILED(ResolveCustomAttributeTypeName(custAttrCurr, &nspace, &name));
+        if (hr != S_OK || !IsTypeNameMatch(szName, nspace, name))
+            return S_FALSE;
 
-            if (!md_token_to_cursor(md_extract_handle_from_cursor(cursor), typeTk, &cursor))
-                return CLDB_E_FILE_CORRUPT;
-            tokenType = TypeFromToken(typeTk);
-        }
+        uint8_t const* data;
+        uint32_t dataLen;
+        if (1 != md_get_column_value_as_blob(custAttrCurr, mdtCustomAttribute_Value, 1, &data, &dataLen))
+            return CLDB_E_FILE_CORRUPT;
+        *ppData = data;
+        *pcbData = dataLen;
+        return S_OK;
+    };
 
-        switch (tokenType)
+    HRESULT hr;
+    CustomAttributeIndex const* index;
+    RETURN_IF_FAILED(_customAttributeIndex.GetIfSettled(_md_ptr.get(), &index));
+    if (hr == S_FALSE)
+    {
+        // The metadata is being edited, so search the parent's attributes
+        // directly instead of rebuilding the index after every edit.
+        HRESULT result = S_FALSE;
+        auto finder = [&](mdcursor_t custAttrCurr)
         {
-        case mdtTypeDef:
-            return (1 == md_get_column_value_as_utf8(cursor, mdtTypeDef_TypeNamespace, 1, nspace)
-                && 1 == md_get_column_value_as_utf8(cursor, mdtTypeDef_TypeName, 1, name))
-                ? S_OK
-                : CLDB_E_FILE_CORRUPT;
-        case mdtTypeRef:
-            return (1 == md_get_column_value_as_utf8(cursor, mdtTypeRef_TypeNamespace, 1, nspace)
-                && 1 == md_get_column_value_as_utf8(cursor, mdtTypeRef_TypeName, 1, name))
-                ? S_OK
-                : CLDB_E_FILE_CORRUPT;
-        default:
-            assert(!"Unexpected token in ResolveTypeDefRefSpecToName");
-            return E_FAIL;
-        }
+            result = matchAttribute(custAttrCurr);
+            return result != S_FALSE;
+        };
+        EnumTableRange(cursor, mdtCustomAttribute_Parent, tkObj, finder);
+        return result;
+    }
+
+    // The index narrows the search to attributes whose type name has the same hash,
+    // so only those need their type name resolved and compared.
+    for (CustomAttributeIndex::Entry const& entry : index->Find(szName, tkObj))
+    {
+        mdcursor_t custAttrCurr;
+        if (!md_token_to_cursor(_md_ptr.get(), entry.CustomAttribute, &custAttrCurr))
+            return CLDB_E_FILE_CORRUPT;
+
+        RETURN_IF_FAILED(matchAttribute(custAttrCurr));
+        if (hr == S_OK)
+            return S_OK;
     }
+    return S_FALSE;
 }
 
 HRESULT STDMETHODCALLTYPE MetadataImportRO::GetCustomAttributeByName(
@@ -2723,116 +2943,36 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetCustomAttributeByName(
     if (szName == nullptr || ppData == nullptr || pcbData == nullptr)
         return E_INVALIDARG;
 
-    mdcursor_t cursor;
-    uint32_t count;
-    if (!md_create_cursor(_md_ptr.get(), mdtid_CustomAttribute, &cursor, &count))
-        return S_FALSE; // If no custom attributes are defined, treat it the same as if the attribute is not found.
-
     char buffer[1024];
     pal::StringConvert<WCHAR, char> cvt{ szName, buffer };
     if (!cvt.Success())
         return E_INVALIDARG;
 
-    struct
-    {
-        HRESULT hr;
-        void const** ppData;
-        ULONG* pcbData;
-        pal::StringConvert<WCHAR, char> const& cvt;
-
-        bool operator()(mdcursor_t custAttrCurr)
-        {
-            char const* nspace;
-            char const* name;
-
-            mdcursor_t type;
-            mdcursor_t tgtType;
-            mdToken typeTk;
-            size_t len;
-            char const* curr;
-
-            if (1 != md_get_column_value_as_cursor(custAttrCurr, mdtCustomAttribute_Type, 1, &type))
-            {
-                hr = CLDB_E_FILE_CORRUPT;
-                return true;
-            }
-
-            // Cursor was returned so must be valid.
-            (void)md_cursor_to_token(type, &typeTk);
-
-            // Resolve the cursor based on its type.
-            switch (TypeFromToken(typeTk))
-            {
-            case mdtMethodDef:
-                if (!md_find_cursor_of_range_element(type, &tgtType))
-                {
-                    hr = CLDB_E_FILE_CORRUPT;
-                    return true;
-                }
-                break;
-            case mdtMemberRef:
-                if (1 != md_get_column_value_as_cursor(type, mdtMemberRef_Class, 1, &tgtType))
-                {
-                    hr = CLDB_E_FILE_CORRUPT;
-                    return true;
-                }
-                break;
-            default:
-                assert(!"Unexpected token in GetCustomAttributeByName");
-                {
-                    hr = COR_E_BADIMAGEFORMAT;
-                    return true;
-                }
-            }
-
-            if (FAILED(hr = ResolveTypeDefRefSpecToName(tgtType, &nspace, &name)))
-            {
-                return true;
-            }
-            else
-            {
-                hr = S_FALSE;
-                curr = cvt;
-                if (nspace[0] != '\0')
-                {
-                    len = ::strlen(nspace);
-                    if (0 != ::strncmp(cvt, nspace, len))
-                        return false;
-                    curr += len;
+    return GetCustomAttributeByName(tkObj, cvt, ppData, pcbData);
+}
 
-                    // Check for overrun and next character
-                    if (cvt.Length() <= len || curr[0] != '.')
-                        return false;
-                    curr += 1;
-                }
+HRESULT STDMETHODCALLTYPE MetadataImportRO::GetTypeDefSnapshot(
+    mdTypeDef   td,
+    md_type_def_snapshot_t* pSnapshot,
+    ULONG       cbSnapshot,
+    ULONG* pcbSnapshot)
+{
+    if (TypeFromToken(td) != mdtTypeDef || pcbSnapshot == nullptr)
+        return E_INVALIDARG;
 
-                if (0 == ::strcmp(curr, name))
-                {
-                    uint8_t const* data;
-                    uint32_t dataLen;
-                    if (1 != md_get_column_value_as_blob(custAttrCurr, mdtCustomAttribute_Value, 1, &data, &dataLen))
-                    {
-                        hr = CLDB_E_FILE_CORRUPT;
-                        return true;
-                    }
-                    *ppData = data;
-                    *pcbData = dataLen;
-                    hr = S_OK;
-                    return true;
-                }
-            }
-            return false;
-        }
-    } finder {S_FALSE, ppData, pcbData, cvt};
+    mdcursor_t cursor;
+    if (!md_token_to_cursor(_md_ptr.get(), td, &cursor))
+        return CLDB_E_RECORD_NOTFOUND;
 
-    EnumTableRange(cursor, count, mdtCustomAttribute_Parent, tkObj, finder);
+    size_t snapshotLen = cbSnapshot;
+    bool written = md_get_type_def_snapshot(cursor, pSnapshot, &snapshotLen);
+    if (snapshotLen == 0)
+        return CLDB_E_FILE_CORRUPT;
+    if (snapshotLen > std::numeric_limits<ULONG>::max())
+        return CLDB_E_TOO_BIG;
 
-    if (finder.hr != S_OK)
-    {
-        *ppData = nullptr;
-        *pcbData = 0;
-    }
-    return finder.hr;
+    *pcbSnapshot = (ULONG)snapshotLen;
+    return written ? S_OK : E_NOT_SUFFICIENT_BUFFER;
 }
 
 BOOL STDMETHODCALLTYPE MetadataImportRO::IsValidToken(
@@ -2880,22 +3020,21 @@ namespace
         CorPinvokeMap PinvokeCallConv;
     };
 
-    // II.23.2.8 TypeDefOrRefOrSpecEncoded as potential calling convention
-    uint32_t ReadTypeDefOrRefOrSpecEncodedAsCallConv(PCCOR_SIGNATURE sig, ReadSigContext& cxt)
+    // Check if the type of a custom modifier is a calling convention.
+    // Returns S_FALSE if the type isn't a calling convention.
+    HRESULT GetCallConvFromModifier(mdhandle_t handle, mdToken tk, CorPinvokeMap* callConv)
     {
-        mdToken tk;
-        uint32_t readIn = CorSigUncompressToken(sig, &tk);
         if (IsNilToken(tk) || TypeFromToken(tk) == mdtTypeSpec)
-            return readIn;
+            return S_FALSE;
 
         // See if this token is a calling convention.
         uint32_t tkType = TypeFromToken(tk);
         if (tkType != mdtTypeRef && tkType != mdtTypeDef)
-            return readIn;
+            return S_FALSE;
 
         mdcursor_t cursor;
-        if (!md_token_to_cursor(cxt.Handle, tk, &cursor))
-            return InvalidReadCount;
+        if (!md_token_to_cursor(handle, tk, &cursor))
+            return CORSEC_E_INVALID_IMAGE_FORMAT;
 
         col_index_t colNspace;
         col_index_t colName;
@@ -2913,36 +3052,90 @@ namespace
 
         char const* nspace;
         if (1 != md_get_column_value_as_utf8(cursor, colNspace, 1, &nspace))
-            return InvalidReadCount;
+            return CORSEC_E_INVALID_IMAGE_FORMAT;
 
         if (0 == ::strcmp(nspace, CMOD_CALLCONV_NAMESPACE) || 0 == ::strcmp(nspace, CMOD_CALLCONV_NAMESPACE_OLD))
         {
             char const* name;
             if (1 != md_get_column_value_as_utf8(cursor, colName, 1, &name))
-                return InvalidReadCount;
+                return CORSEC_E_INVALID_IMAGE_FORMAT;
 
             if (0 == ::strcmp(name, CMOD_CALLCONV_NAME_CDECL))
             {
-                cxt.PinvokeCallConv = pmCallConvCdecl;
-                return FoundValue;
+                *callConv = pmCallConvCdecl;
+                return S_OK;
             }
             if (0 == ::strcmp(name, CMOD_CALLCONV_NAME_STDCALL))
             {
-                cxt.PinvokeCallConv = pmCallConvStdcall;
-                return FoundValue;
+                *callConv = pmCallConvStdcall;
+                return S_OK;
             }
             if (0 == ::strcmp(name, CMOD_CALLCONV_NAME_THISCALL))
             {
-                cxt.PinvokeCallConv = pmCallConvThiscall;
-                return FoundValue;
+                *callConv = pmCallConvThiscall;
+                return S_OK;
             }
             if (0 == ::strcmp(name, CMOD_CALLCONV_NAME_FASTCALL))
             {
-                cxt.PinvokeCallConv = pmCallConvFastcall;
-                return FoundValue;
+                *callConv = pmCallConvFastcall;
+                return S_OK;
             }
         }
-        return readIn;
+        return S_FALSE;
+    }
+
+    // II.23.2.8 TypeDefOrRefOrSpecEncoded as potential calling convention
+    uint32_t ReadTypeDefOrRefOrSpecEncodedAsCallConv(PCCOR_SIGNATURE sig, ReadSigContext& cxt)
+    {
+        mdToken tk;
+        uint32_t readIn = CorSigUncompressToken(sig, &tk);
+        HRESULT hr = GetCallConvFromModifier(cxt.Handle, tk, &cxt.PinvokeCallConv);
+        if (FAILED(hr))
+            return InvalidReadCount;
+        return hr == S_OK ? FoundValue : readIn;
+    }
+
+    HRESULT FindCallConvModifier(mdhandle_t handle, md_signature_t const* sig, CorPinvokeMap* callConv);
+
+    // Find the first calling convention modifier in a decoded type, in signature order.
+    // Returns S_FALSE if there is no calling convention modifier.
+    HRESULT FindCallConvModifier(mdhandle_t handle, md_signature_type_t const* type, CorPinvokeMap* callConv)
+    {
+        HRESULT hr;
+        switch (type->element_type)
+        {
+        case ELEMENT_TYPE_CMOD_REQD:
+        case ELEMENT_TYPE_CMOD_OPT:
+            hr = GetCallConvFromModifier(handle, type->data.modifier.token, callConv);
+            if (hr != S_FALSE)
+                return hr;
+            return FindCallConvModifier(handle, type->data.modifier.type, callConv);
+        case ELEMENT_TYPE_PTR:
+        case ELEMENT_TYPE_BYREF:
+        case ELEMENT_TYPE_SZARRAY:
+        case ELEMENT_TYPE_PINNED:
+            return FindCallConvModifier(handle, type->data.type, callConv);
+        case ELEMENT_TYPE_ARRAY:
+            return FindCallConvModifier(handle, type->data.array.type, callConv);
+        case ELEMENT_TYPE_GENERICINST:
+            hr = FindCallConvModifier(handle, type->data.generic_inst.type, callConv);
+            for (uint32_t i = 0; hr == S_FALSE && i < type->data.generic_inst.arg_count; ++i)
+                hr = FindCallConvModifier(handle, &type->data.generic_inst.args[i], callConv);
+            return hr;
+        case ELEMENT_TYPE_FNPTR:
+            return FindCallConvModifier(handle, type->data.method, callConv);
+        default:
+            return S_FALSE;
+        }
+    }
+
+    // Find the first calling convention modifier in a decoded method signature, starting with the return type.
+    HRESULT FindCallConvModifier(mdhandle_t handle, md_signature_t const* sig, CorPinvokeMap* callConv)
+    {
+        HRESULT hr = FindCallConvModifier(handle, sig->return_type, callConv);
+        for (uint32_t i = 0; hr == S_FALSE && i < sig->param_count; ++i)
+            hr = FindCallConvModifier(handle, &sig->params[i], callConv);
+        return hr;
     }
 
     // Handles processing the following metadata signature rules.
@@ -3068,6 +3261,21 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetNativeCallConvFromSig(
     if (cbSig == 0 || pCallConv == nullptr)
         return E_INVALIDARG;
 
+    // Signatures from this metadata are decoded once and cached.
+    md_signature_t const* decoded;
+    if (mdbpr_Success == md_get_signature(_md_ptr.get(), (uint8_t const*)pvSig, cbSig, &decoded)
+        && decoded->return_type != nullptr
+        && (decoded->calling_convention & IMAGE_CEE_CS_CALLCONV_MASK) != IMAGE_CEE_CS_CALLCONV_FIELD
+        && (decoded->calling_convention & IMAGE_CEE_CS_CALLCONV_MASK) != IMAGE_CEE_CS_CALLCONV_PROPERTY)
+    {
+        CorPinvokeMap pinvokeCallConv = pmCallConvWinapi;
+        if (FAILED(FindCallConvModifier(_md_ptr.get(), decoded, &pinvokeCallConv)))
+            return CORSEC_E_INVALID_IMAGE_FORMAT;
+
+        *pCallConv = pinvokeCallConv;
+        return S_OK;
+    }
+
     PCCOR_SIGNATURE sig = (PCCOR_SIGNATURE)pvSig;
     PCCOR_SIGNATURE sigEnd = sig + cbSig;
     ULONG callConv; // Metadata callconv position value, not the expected return type.
@@ -3186,7 +3394,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumGenericParams(
         if (!md_create_cursor(_md_ptr.get(), mdtid_GenericParam, &cursor, &count))
             return CLDB_E_RECORD_NOTFOUND;
 
-        RETURN_IF_FAILED(HCORENUMImpl::CreateDynamicEnum(&enumImpl));
+        RETURN_IF_FAILED(_enumPool.CreateDynamicEnum(&enumImpl));
         HCORENUMImpl_ptr cleanup{ enumImpl };
 
         struct _Finder
@@ -3209,7 +3417,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumGenericParams(
             }
         } finder{ *enumImpl, mdTokenNil, S_OK, S_OK };
 
-        EnumTableRange(cursor, count, mdtGenericParam_Owner, tk, finder);
+        EnumTableRange(cursor, mdtGenericParam_Owner, tk, finder);
         RETURN_IF_FAILED(finder.Result);
 
         *phEnum = cleanup.release();
@@ -3293,7 +3501,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumGenericParamConstraints(
         if (!md_create_cursor(_md_ptr.get(), mdtid_GenericParamConstraint, &cursor, &count))
             return CLDB_E_RECORD_NOTFOUND;
 
-        RETURN_IF_FAILED(HCORENUMImpl::CreateDynamicEnum(&enumImpl));
+        RETURN_IF_FAILED(_enumPool.CreateDynamicEnum(&enumImpl));
         HCORENUMImpl_ptr cleanup{ enumImpl };
 
         struct _Finder
@@ -3316,7 +3524,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumGenericParamConstraints(
             }
         } finder{ *enumImpl, mdTokenNil, S_OK, S_OK };
 
-        EnumTableRange(cursor, count, mdtGenericParamConstraint_Owner, tk, finder);
+        EnumTableRange(cursor, mdtGenericParamConstraint_Owner, tk, finder);
         RETURN_IF_FAILED(finder.Result);
 
         *phEnum = cleanup.release();
@@ -3346,13 +3554,44 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::GetPEKind(
     DWORD* pdwPEKind,
     DWORD* pdwMAchine)
 {
-    UNREFERENCED_PARAMETER(pdwPEKind);
-    UNREFERENCED_PARAMETER(pdwMAchine);
-
     // Requires PE data to be available.
-    // This implementation only has the metadata tables.
-    // It does not have any information about the PE envelope.
-    return E_NOTIMPL;
+    // Scopes opened on the metadata alone have no information about the PE envelope.
+    mdpe_t pe = md_get_pe(_md_ptr.get());
+    if (pe == nullptr)
+        return E_NOTIMPL;
+
+    md_pe_info_t info;
+    if (!md_pe_get_info(pe, &info))
+        return E_FAIL;
+
+    DWORD kind = 0;
+    if (info.is_pe32_plus)
+        kind |= pe32Plus;
+
+    if (info.has_cli_header)
+    {
+        if (info.cli_flags & COMIMAGE_FLAGS_ILONLY)
+            kind |= peILonly;
+
+        if (COR_IS_32BIT_REQUIRED(info.cli_flags))
+            kind |= pe32BitRequired;
+        else if (COR_IS_32BIT_PREFERRED(info.cli_flags))
+            kind |= pe32BitPreferred;
+
+        // Mixed-mode images that aren't PE32+ are treated as x86-only.
+        if (kind == 0)
+            kind = pe32BitRequired;
+    }
+    else
+    {
+        kind |= pe32Unmanaged;
+    }
+
+    if (pdwPEKind != nullptr)
+        *pdwPEKind = kind;
+    if (pdwMAchine != nullptr)
+        *pdwMAchine = info.machine;
+    return S_OK;
 }
 
 HRESULT STDMETHODCALLTYPE MetadataImportRO::GetVersionString(
@@ -3383,7 +3622,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumMethodSpecs(
         if (!md_create_cursor(_md_ptr.get(), mdtid_MethodSpec, &cursor, &count))
             return CLDB_E_RECORD_NOTFOUND;
 
-        RETURN_IF_FAILED(HCORENUMImpl::CreateDynamicEnum(&enumImpl));
+        RETURN_IF_FAILED(_enumPool.CreateDynamicEnum(&enumImpl));
         HCORENUMImpl_ptr cleanup{ enumImpl };
 
         struct _Finder
@@ -3406,7 +3645,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumMethodSpecs(
             }
         } finder{ *enumImpl, mdTokenNil, S_OK, S_OK };
 
-        EnumTableRange(cursor, count, mdtMethodSpec_Method, tk, finder);
+        EnumTableRange(cursor, mdtMethodSpec_Method, tk, finder);
         RETURN_IF_FAILED(finder.Result);
 
         *phEnum = cleanup.release();
@@ -3767,7 +4006,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumAssemblyRefs(
     HCORENUMImpl* enumImpl = ToHCORENUMImpl(*phEnum);
     if (enumImpl == nullptr)
     {
-        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), mdtid_AssemblyRef, &enumImpl));
+        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), _enumPool, mdtid_AssemblyRef, &enumImpl));
         *phEnum = enumImpl;
     }
     return enumImpl->ReadTokens(rAssemblyRefs, cMax, pcTokens);
@@ -3783,7 +4022,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumFiles(
     HCORENUMImpl* enumImpl = ToHCORENUMImpl(*phEnum);
     if (enumImpl == nullptr)
     {
-        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), mdtid_File, &enumImpl));
+        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), _enumPool, mdtid_File, &enumImpl));
         *phEnum = enumImpl;
     }
     return enumImpl->ReadTokens(rFiles, cMax, pcTokens);
@@ -3799,7 +4038,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumExportedTypes(
     HCORENUMImpl* enumImpl = ToHCORENUMImpl(*phEnum);
     if (enumImpl == nullptr)
     {
-        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), mdtid_ExportedType, &enumImpl));
+        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), _enumPool, mdtid_ExportedType, &enumImpl));
         *phEnum = enumImpl;
     }
     return enumImpl->ReadTokens(rExportedTypes, cMax, pcTokens);
@@ -3815,7 +4054,7 @@ HRESULT STDMETHODCALLTYPE MetadataImportRO::EnumManifestResources(
     HCORENUMImpl* enumImpl = ToHCORENUMImpl(*phEnum);
     if (enumImpl == nullptr)
     {
-        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), mdtid_ManifestResource, &enumImpl));
+        RETURN_IF_FAILED(CreateEnumTokens(_md_ptr.get(), _enumPool, mdtid_ManifestResource, &enumImpl));
         *phEnum = enumImpl;
     }
     return enumImpl->ReadTokens(rManifestResources, cMax, pcTokens);
@@ -2,18 +2,34 @@
 #define _SRC_INTERFACES_METADATAIMPORTRO_HPP_
 
 #include <internal/dnmd_platform.hpp>
+#include <dnmd_interfaces.hpp>
 #include "tearoffbase.hpp"
 #include "controllingiunknown.hpp"
 #include "dnmdowner.hpp"
+#include "hcorenum.hpp"
+#include "customattributeindex.hpp"
+#include "memberindex.hpp"
+#include "metadatacache.hpp"
+#include "presencefilter.hpp"
 
 #include <external/cor.h>
 #include <external/corhdr.h>
 
 #include <cstdint>
 
-class MetadataImportRO final : public TearOffBase<IMetaDataImport2, IMetaDataAssemblyImport>
+class MetadataImportRO final : public TearOffBase<IMetaDataImport2, IMetaDataAssemblyImport, IDNMDImportUtf8>
 {
     mdhandle_view _md_ptr;
+    HCORENUMPool _enumPool;
+    MetadataCache<CustomAttributeIndex> _customAttributeIndex;
+    MetadataCache<CustomAttributePresence> _customAttributePresence;
+    MetadataCache<ConstantPresence> _constantPresence;
+    MetadataCache<FieldMarshalPresence> _fieldMarshalPresence;
+    MetadataCache<DeclSecurityPresence> _declSecurityPresence;
+    MetadataCache<ImplMapPresence> _implMapPresence;
+    MetadataCache<MethodDefIndex> _methodDefIndex;
+    MetadataCache<FieldIndex> _fieldIndex;
+    MetadataCache<MemberRefIndex> _memberRefIndex;
 
 protected:
     virtual bool TryGetInterfaceOnThis(REFIID riid, void** ppvObject) override
@@ -29,6 +45,11 @@ protected:
             *ppvObject = static_cast<IMetaDataAssemblyImport*>(this);
             return true;
         }
+        if (riid == IID_IDNMDImportUtf8)
+        {
+            *ppvObject = static_cast<IDNMDImportUtf8*>(this);
+            return true;
+        }
         return false;
     }
 
@@ -36,6 +57,13 @@ public:
     MetadataImportRO(IUnknown* controllingUnknown, mdhandle_view md_ptr)
         : TearOffBase(controllingUnknown)
         , _md_ptr{ md_ptr }
+        , _enumPool{ }
+        , _customAttributeIndex{ }
+        , _customAttributePresence{ }
+        , _constantPresence{ }
+        , _fieldMarshalPresence{ }
+        , _declSecurityPresence{ }
+        , _implMapPresence{ }
     { }
 
     virtual ~MetadataImportRO() = default;
@@ -608,6 +636,111 @@ public: // IMetaDataAssemblyImport
         IUnknown* ppIUnk[],
         ULONG    cMax,
         ULONG* pcAssemblies) override;
+
+public: // IDNMDImportUtf8
+    STDMETHOD(GetScopeProps)(
+        char const** pszName,
+        GUID* pmvid) override;
+
+    STDMETHOD(GetTypeDefProps)(
+        mdTypeDef td,
+        char const** pszNamespace,
+        char const** pszName,
+        DWORD* pdwTypeDefFlags,
+        mdToken* ptkExtends) override;
+
+    STDMETHOD(GetTypeRefProps)(
+        mdTypeRef tr,
+        mdToken* ptkResolutionScope,
+        char const** pszNamespace,
+        char const** pszName) override;
+
+    STDMETHOD(GetMethodProps)(
+        mdMethodDef mb,
+        mdTypeDef* pClass,
+        char const** pszMethod,
+        DWORD* pdwAttr,
+        PCCOR_SIGNATURE* ppvSigBlob,
+        ULONG* pcbSigBlob,
+        ULONG* pulCodeRVA,
+        DWORD* pdwImplFlags) override;
+
+    STDMETHOD(GetFieldProps)(
+        mdFieldDef mb,
+        mdTypeDef* pClass,
+        char const** pszField,
+        DWORD* pdwAttr,
+        PCCOR_SIGNATURE* ppvSigBlob,
+        ULONG* pcbSigBlob,
+        DWORD* pdwCPlusTypeFlag,
+        UVCP_CONSTANT* ppValue,
+        ULONG* pcchValue) override;
+
+    STDMETHOD(GetParamProps)(
+        mdParamDef tk,
+        mdMethodDef* pmd,
+        ULONG* pulSequence,
+        char const** pszName,
+        DWORD* pdwAttr,
+        DWORD* pdwCPlusTypeFlag,
+        UVCP_CONSTANT* ppValue,
+        ULONG* pcchValue) override;
+
+    STDMETHOD(GetMemberRefProps)(
+        mdMemberRef mr,
+        mdToken* ptk,
+        char const** pszMember,
+        PCCOR_SIGNATURE* ppvSigBlob,
+        ULONG* pbSig) override;
+
+    STDMETHOD(GetModuleRefProps)(
+        mdModuleRef mur,
+        char const** pszName) override;
+
+    STDMETHOD(FindTypeDefByName)(
+        char const* szNamespace,
+        char const* szName,
+        mdToken tkEnclosingClass,
+        mdTypeDef* ptd) override;
+
+    STDMETHOD(FindTypeRef)(
+        mdToken tkResolutionScope,
+        char const* szNamespace,
+        char const* szName,
+        mdTypeRef* ptr) override;
+
+    STDMETHOD(FindMethod)(
+        mdTypeDef td,
+        char const* szName,
+        PCCOR_SIGNATURE pvSigBlob,
+        ULONG cbSigBlob,
+        mdMethodDef* pmb) override;
+
+    STDMETHOD(FindField)(
+        mdTypeDef td,
+        char const* szName,
+        PCCOR_SIGNATURE pvSigBlob,
+        ULONG cbSigBlob,
+        mdFieldDef* pmb) override;
+
+    STDMETHOD(FindMemberRef)(
+        mdToken td,
+        char const* szName,
+        PCCOR_SIGNATURE pvSigBlob,
+        ULONG cbSigBlob,
+        mdMemberRef* pmr) override;
+
+    STDMETHOD(GetCustomAttributeByName)(
+        mdToken tkObj,
+        char const* szName,
+        void const** ppData,
+        ULONG* pcbData) override;
+
+    STDMETHOD(GetTypeDefSnapshot)(
+        mdTypeDef td,
+        md_type_def_snapshot_t* pSnapshot,
+        ULONG cbSnapshot,
+        ULONG* pcbSnapshot) override;
 };
 
 #endif // _SRC_INTERFACES_METADATAIMPORTRO_HPP_
\ No newline at end of file
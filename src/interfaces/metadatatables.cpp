@@ -0,0 +1,806 @@
+// Defines the column type constants (iRidMax, iCodedToken, ...) in cor.h.
+#define _DEFINE_META_DATA_META_CONSTANTS
+
+#include "metadatatables.hpp"
+
+#ifdef DNMD_PORTABLE_PDB
+#include <dnmd_pdb.h>
+#endif // DNMD_PORTABLE_PDB
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+#define RETURN_IF_FAILED(exp) \
+{ \
+    hr = (exp); \
+    if (FAILED(hr)) \
+    { \
+        return hr; \
+    } \
+}
+
+namespace
+{
+    struct TableNames final
+    {
+        char const* Name;
+        char const* Columns[TableLayouts::MaxColumnCount];
+    };
+
+    // Indexed by table ID - see II.22.
+    TableNames const TableNameMap[] =
+    {
+        { "Module", { "Generation", "Name", "Mvid", "EncId", "EncBaseId" } },
+        { "TypeRef", { "ResolutionScope", "TypeName", "TypeNamespace" } },
+        { "TypeDef", { "Flags", "TypeName", "TypeNamespace", "Extends", "FieldList", "MethodList" } },
+        { "FieldPtr", { "Field" } },
+        { "Field", { "Flags", "Name", "Signature" } },
+        { "MethodPtr", { "Method" } },
+        { "MethodDef", { "Rva", "ImplFlags", "Flags", "Name", "Signature", "ParamList" } },
+        { "ParamPtr", { "Param" } },
+        { "Param", { "Flags", "Sequence", "Name" } },
+        { "InterfaceImpl", { "Class", "Interface" } },
+        { "MemberRef", { "Class", "Name", "Signature" } },
+        { "Constant", { "Type", "Parent", "Value" } },
+        { "CustomAttribute", { "Parent", "Type", "Value" } },
+        { "FieldMarshal", { "Parent", "NativeType" } },
+        { "DeclSecurity", { "Action", "Parent", "PermissionSet" } },
+        { "ClassLayout", { "PackingSize", "ClassSize", "Parent" } },
+        { "FieldLayout", { "Offset", "Field" } },
+        { "StandAloneSig", { "Signature" } },
+        { "EventMap", { "Parent", "EventList" } },
+        { "EventPtr", { "Event" } },
+        { "Event", { "EventFlags", "Name", "EventType" } },
+        { "PropertyMap", { "Parent", "PropertyList" } },
+        { "PropertyPtr", { "Property" } },
+        { "Property", { "Flags", "Name", "Type" } },
+        { "MethodSemantics", { "Semantics", "Method", "Association" } },
+        { "MethodImpl", { "Class", "MethodBody", "MethodDeclaration" } },
+        { "ModuleRef", { "Name" } },
+        { "TypeSpec", { "Signature" } },
+        { "ImplMap", { "MappingFlags", "MemberForwarded", "ImportName", "ImportScope" } },
+        { "FieldRva", { "Rva", "Field" } },
+        { "ENCLog", { "Token", "Op" } },
+        { "ENCMap", { "Token" } },
+        { "Assembly", { "HashAlgId", "MajorVersion", "MinorVersion", "BuildNumber", "RevisionNumber", "Flags", "PublicKey", "Name", "Culture" } },
+        { "AssemblyProcessor", { "Processor" } },
+        { "AssemblyOS", { "OSPlatformID", "OSMajorVersion", "OSMinorVersion" } },
+        { "AssemblyRef", { "MajorVersion", "MinorVersion", "BuildNumber", "RevisionNumber", "Flags", "PublicKeyOrToken", "Name", "Culture", "HashValue" } },
+        { "AssemblyRefProcessor", { "Processor", "AssemblyRef" } },
+        { "AssemblyRefOS", { "OSPlatformId", "OSMajorVersion", "OSMinorVersion", "AssemblyRef" } },
+        { "File", { "Flags", "Name", "HashValue" } },
+        { "ExportedType", { "Flags", "TypeDefId", "TypeName", "TypeNamespace", "Implementation" } },
+        { "ManifestResource", { "Offset", "Flags", "Name", "Implementation" } },
+        { "NestedClass", { "NestedClass", "EnclosingClass" } },
+        { "GenericParam", { "Number", "Flags", "Owner", "Name" } },
+        { "MethodSpec", { "Method", "Instantiation" } },
+        { "GenericParamConstraint", { "Owner", "Constraint" } },
+#ifdef DNMD_PORTABLE_PDB
+        // Reserved table IDs.
+        { "", { } },
+        { "", { } },
+        { "", { } },
+        // https://github.com/dotnet/runtime/blob/main/docs/design/specs/PortablePdb-Metadata.md
+        { "Document", { "Name", "HashAlgorithm", "Hash", "Language" } },
+        { "MethodDebugInformation", { "Document", "SequencePoints" } },
+        { "LocalScope", { "Method", "ImportScope", "VariableList", "ConstantList", "StartOffset", "Length" } },
+        { "LocalVariable", { "Attributes", "Index", "Name" } },
+        { "LocalConstant", { "Name", "Signature" } },
+        { "ImportScope", { "Parent", "Imports" } },
+        { "StateMachineMethod", { "MoveNextMethod", "KickoffMethod" } },
+        { "CustomDebugInformation", { "Parent", "Kind", "Value" } },
+#endif // DNMD_PORTABLE_PDB
+    };
+    static_assert(ARRAY_SIZE(TableNameMap) == mdtid_End, "Every table must be named");
+
+    // Ordered as the kinds of coded index returned by md_get_column_layout() - see II.24.2.6.
+    char const* const CodedTokenNames[] =
+    {
+        "TypeDefOrRef",
+        "HasConstant",
+        "HasCustomAttribute",
+        "HasFieldMarshal",
+        "HasDeclSecurity",
+        "MemberRefParent",
+        "HasSemantic",
+        "MethodDefOrRef",
+        "MemberForwarded",
+        "Implementation",
+        "CustomAttributeType",
+        "ResolutionScope",
+        "TypeOrMethodDef",
+#ifdef DNMD_PORTABLE_PDB
+        "HasCustomDebugInformation",
+#endif // DNMD_PORTABLE_PDB
+    };
+
+    struct CodedToken final
+    {
+        // Coded indexes use at most 5 bits for the tag.
+        ULONG TokenTypes[32];
+        ULONG Count;
+        uint32_t TagBits;
+    };
+
+    struct CodedTokens final
+    {
+        CodedToken Kinds[ARRAY_SIZE(CodedTokenNames)];
+    };
+
+    CodedTokens const& GetCodedTokens() noexcept
+    {
+        static CodedTokens const codedTokens = []()
+        {
+            CodedTokens tokens{};
+            for (uint32_t i = 0; i < ARRAY_SIZE(tokens.Kinds); ++i)
+            {
+                CodedToken& kind = tokens.Kinds[i];
+                mdtable_id_t const* tables;
+                int32_t count = md_get_coded_index_tables(i, &tables);
+                assert(count > 0 && (size_t)count <= ARRAY_SIZE(kind.TokenTypes));
+                kind.Count = (ULONG)count;
+                while ((1u << kind.TagBits) < kind.Count)
+                    kind.TagBits++;
+
+                // Tags that don't refer to a table are reported as mdtString,
+                // which isn't the token type of any table a coded index can refer to.
+                for (ULONG tag = 0; tag < kind.Count; ++tag)
+                    kind.TokenTypes[tag] = tables[tag] == mdtid_Unused ? (ULONG)mdtString : (ULONG)tables[tag] << 24;
+            }
+            return tokens;
+        }();
+        return codedTokens;
+    }
+
+    uint32_t ReadColumnValue(uint8_t const* row, md_column_layout_t const& column) noexcept
+    {
+        // Cells are stored in little-endian order - II.24.2.6.
+        uint8_t const* cell = row + column.offset;
+        uint32_t value = (uint32_t)cell[0] | ((uint32_t)cell[1] << 8);
+        if (column.size == 4)
+            value |= ((uint32_t)cell[2] << 16) | ((uint32_t)cell[3] << 24);
+        return value;
+    }
+
+    ULONG GetColumnType(md_column_layout_t const& column) noexcept
+    {
+        switch (column.kind)
+        {
+        case mdck_TableIndex:
+            return (ULONG)column.target.table;
+        case mdck_CodedIndex:
+            return iCodedToken + column.target.coded_index;
+        case mdck_HeapIndex:
+            switch (column.target.heap)
+            {
+            case mdhid_String:
+                return iSTRING;
+            case mdhid_Guid:
+                return iGUID;
+            default:
+                return iBLOB;
+            }
+        default:
+            return column.size == 2 ? iUSHORT : iULONG;
+        }
+    }
+
+    // Read the length prefix of an entry in the blob or user string heap - II.24.2.4.
+    // Returns false if the entry doesn't fit in the heap.
+    bool ReadBlobEntry(uint8_t const* heap, uint32_t heapSize, uint32_t offset, uint32_t* prefixSize, uint32_t* length) noexcept
+    {
+        if (offset >= heapSize)
+            return false;
+
+        uint8_t const* entry = heap + offset;
+        uint32_t remaining = heapSize - offset;
+        if ((entry[0] & 0x80) == 0)
+        {
+            *prefixSize = 1;
+            *length = entry[0];
+        }
+        else if ((entry[0] & 0xC0) == 0x80 && remaining >= 2)
+        {
+            *prefixSize = 2;
+            *length = ((uint32_t)(entry[0] & 0x3F) << 8) | entry[1];
+        }
+        else if ((entry[0] & 0xE0) == 0xC0 && remaining >= 4)
+        {
+            *prefixSize = 4;
+            *length = ((uint32_t)(entry[0] & 0x1F) << 24) | ((uint32_t)entry[1] << 16) | ((uint32_t)entry[2] << 8) | entry[3];
+        }
+        else
+        {
+            return false;
+        }
+
+        return *length <= remaining - *prefixSize;
+    }
+
+    uint32_t ReadUInt32(uint8_t const* data) noexcept
+    {
+        return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    }
+
+    uint16_t ReadUInt16(uint8_t const* data) noexcept
+    {
+        return (uint16_t)(data[0] | (data[1] << 8));
+    }
+}
+
+HRESULT TableLayouts::Create(mdhandle_t handle, std::unique_ptr<TableLayouts>& layouts)
+{
+    std::unique_ptr<TableLayouts> newLayouts{ new TableLayouts() };
+    newLayouts->_tableCount = (ULONG)mdtid_GenericParamConstraint + 1;
+#ifdef DNMD_PORTABLE_PDB
+    mdToken entryPoint;
+    if (md_get_pdb_entry_point(handle, &entryPoint))
+        newLayouts->_tableCount = (ULONG)mdtid_End;
+#endif // DNMD_PORTABLE_PDB
+
+    for (uint32_t i = 0; i < newLayouts->_tableCount; ++i)
+    {
+        Table& table = newLayouts->_tables[i];
+        if (!md_get_table_layout(handle, (mdtable_id_t)i, &table.Layout))
+            return E_FAIL;
+
+        assert(table.Layout.column_count <= ARRAY_SIZE(table.Columns));
+        for (uint8_t col = 0; col < table.Layout.column_count; ++col)
+        {
+            if (!md_get_column_layout(handle, (mdtable_id_t)i, (col_index_t)col, &table.Columns[col]))
+                return E_FAIL;
+        }
+    }
+
+    layouts = std::move(newLayouts);
+    return S_OK;
+}
+
+HRESULT MetadataImage::Create(mdhandle_t handle, std::unique_ptr<MetadataImage>& image)
+{
+    std::unique_ptr<MetadataImage> newImage{ new MetadataImage() };
+
+    uint8_t const* data;
+    size_t dataLen;
+    if (!md_get_original_image(handle, &data, &dataLen))
+    {
+        // The metadata has been edited, so report the image it would be saved as.
+        if (!md_prepare_write(handle, &dataLen))
+            return E_FAIL;
+        newImage->_written.reset(new uint8_t[dataLen]);
+        if (!md_write_to_buffer(handle, newImage->_written.get(), &dataLen))
+            return E_FAIL;
+        data = newImage->_written.get();
+    }
+
+    if (dataLen > std::numeric_limits<uint32_t>::max())
+        return CLDB_E_TOO_BIG;
+    newImage->_data = data;
+    newImage->_size = (uint32_t)dataLen;
+
+    // Find the stream headers that follow the version string - II.24.2.1.
+    uint32_t const size = newImage->_size;
+    if (size < 16)
+        return CLDB_E_FILE_CORRUPT;
+    uint32_t versionLength = ReadUInt32(data + 12);
+    if (versionLength > size - 16 || size - 16 - versionLength < 4)
+        return CLDB_E_FILE_CORRUPT;
+    uint32_t offset = 16 + versionLength + sizeof(uint16_t); // Skip the flags.
+    uint32_t streamCount = ReadUInt16(data + offset);
+    offset += sizeof(uint16_t);
+
+    newImage->_streams.reset(new Stream[streamCount]);
+    for (uint32_t i = 0; i < streamCount; ++i)
+    {
+        // Stream header - II.24.2.2.
+        if (size - offset < 8)
+            return CLDB_E_FILE_CORRUPT;
+        Stream& stream = newImage->_streams[i];
+        uint32_t streamOffset = ReadUInt32(data + offset);
+        stream.Size = ReadUInt32(data + offset + 4);
+        if (streamOffset > size || stream.Size > size - streamOffset)
+            return CLDB_E_FILE_CORRUPT;
+        stream.Data = data + streamOffset;
+        offset += 8;
+
+        // The name is null-terminated and padded to a 4-byte boundary.
+        stream.Name = (char const*)(data + offset);
+        void const* nameEnd = std::memchr(stream.Name, '\0', size - offset);
+        if (nameEnd == nullptr)
+            return CLDB_E_FILE_CORRUPT;
+        uint32_t nameSize = (uint32_t)((char const*)nameEnd - stream.Name) + 1;
+        nameSize = (nameSize + 3) & ~3u;
+        if (nameSize > size - offset)
+            return CLDB_E_FILE_CORRUPT;
+        offset += nameSize;
+    }
+    newImage->_streamCount = streamCount;
+
+    image = std::move(newImage);
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetHeap(md_heap_id_t heapId, uint8_t const** data, uint32_t* size)
+{
+    return md_get_heap(_md_ptr.get(), heapId, data, size) ? S_OK : E_FAIL;
+}
+
+HRESULT MetadataTables::GetStringHeapSize(ULONG* pcbStrings)
+{
+    if (pcbStrings == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    uint8_t const* data;
+    uint32_t size;
+    RETURN_IF_FAILED(GetHeap(mdhid_String, &data, &size));
+    *pcbStrings = size;
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetBlobHeapSize(ULONG* pcbBlobs)
+{
+    if (pcbBlobs == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    uint8_t const* data;
+    uint32_t size;
+    RETURN_IF_FAILED(GetHeap(mdhid_Blob, &data, &size));
+    *pcbBlobs = size;
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetGuidHeapSize(ULONG* pcbGuids)
+{
+    if (pcbGuids == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    uint8_t const* data;
+    uint32_t size;
+    RETURN_IF_FAILED(GetHeap(mdhid_Guid, &data, &size));
+    *pcbGuids = size;
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetUserStringHeapSize(ULONG* pcbBlobs)
+{
+    if (pcbBlobs == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    uint8_t const* data;
+    uint32_t size;
+    RETURN_IF_FAILED(GetHeap(mdhid_UserString, &data, &size));
+    *pcbBlobs = size;
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetNumTables(ULONG* pcTables)
+{
+    if (pcTables == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    TableLayouts const* layouts;
+    RETURN_IF_FAILED(_layouts.Get(_md_ptr.get(), &layouts));
+
+    *pcTables = layouts->GetTableCount();
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetTableIndex(ULONG token, ULONG* pixTbl)
+{
+    if (pixTbl == nullptr)
+        return E_INVALIDARG;
+
+    // Token types that don't refer to a table, like mdtString, have no index.
+    ULONG ixTbl = token >> 24;
+    *pixTbl = ixTbl < (ULONG)mdtid_End ? ixTbl : (ULONG)-1;
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetTableInfo(
+    ULONG   ixTbl,
+    ULONG   *pcbRow,
+    ULONG   *pcRows,
+    ULONG   *pcCols,
+    ULONG   *piKey,
+    const char **ppName)
+{
+    HRESULT hr;
+    TableLayouts const* layouts;
+    RETURN_IF_FAILED(_layouts.Get(_md_ptr.get(), &layouts));
+
+    TableLayouts::Table const* table = layouts->GetTable(ixTbl);
+    if (table == nullptr)
+        return E_INVALIDARG;
+
+    if (pcbRow != nullptr)
+        *pcbRow = table->Layout.row_size;
+    if (pcRows != nullptr)
+        *pcRows = table->Layout.row_count;
+    if (pcCols != nullptr)
+        *pcCols = table->Layout.column_count;
+    if (piKey != nullptr)
+        *piKey = (ULONG)table->Layout.key_column;
+    if (ppName != nullptr)
+        *ppName = TableNameMap[ixTbl].Name;
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetColumnInfo(
+    ULONG   ixTbl,
+    ULONG   ixCol,
+    ULONG   *poCol,
+    ULONG   *pcbCol,
+    ULONG   *pType,
+    const char **ppName)
+{
+    HRESULT hr;
+    TableLayouts const* layouts;
+    RETURN_IF_FAILED(_layouts.Get(_md_ptr.get(), &layouts));
+
+    TableLayouts::Table const* table = layouts->GetTable(ixTbl);
+    if (table == nullptr || ixCol >= table->Layout.column_count)
+        return E_INVALIDARG;
+
+    md_column_layout_t const& column = table->Columns[ixCol];
+    if (poCol != nullptr)
+        *poCol = column.offset;
+    if (pcbCol != nullptr)
+        *pcbCol = column.size;
+    if (pType != nullptr)
+        *pType = GetColumnType(column);
+    if (ppName != nullptr)
+        *ppName = TableNameMap[ixTbl].Columns[ixCol];
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetCodedTokenInfo(
+    ULONG   ixCdTkn,
+    ULONG   *pcTokens,
+    ULONG   **ppTokens,
+    const char **ppName)
+{
+    if (ixCdTkn >= ARRAY_SIZE(CodedTokenNames))
+        return E_INVALIDARG;
+
+    CodedToken const& kind = GetCodedTokens().Kinds[ixCdTkn];
+    if (pcTokens != nullptr)
+        *pcTokens = kind.Count;
+    if (ppTokens != nullptr)
+        *ppTokens = const_cast<ULONG*>(kind.TokenTypes);
+    if (ppName != nullptr)
+        *ppName = CodedTokenNames[ixCdTkn];
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetRow(
+    ULONG   ixTbl,
+    ULONG   rid,
+    void    **ppRow)
+{
+    if (ppRow == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    TableLayouts const* layouts;
+    RETURN_IF_FAILED(_layouts.Get(_md_ptr.get(), &layouts));
+    if (layouts->GetTable(ixTbl) == nullptr)
+        return E_INVALIDARG;
+
+    uint8_t const* row;
+    if (!md_get_row_raw(_md_ptr.get(), (mdtable_id_t)ixTbl, rid, &row))
+        return CLDB_E_INDEX_NOTFOUND;
+
+    *ppRow = const_cast<uint8_t*>(row);
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetColumn(
+    ULONG   ixTbl,
+    ULONG   ixCol,
+    ULONG   rid,
+    ULONG   *pVal)
+{
+    if (pVal == nullptr)
+        return E_INVALIDARG;
+
+    // Tools that dump metadata call this for every cell, so the value is read
+    // from the row with the cached layout rather than through a cursor.
+    HRESULT hr;
+    TableLayouts const* layouts;
+    RETURN_IF_FAILED(_layouts.Get(_md_ptr.get(), &layouts));
+
+    TableLayouts::Table const* table = layouts->GetTable(ixTbl);
+    if (table == nullptr || ixCol >= table->Layout.column_count)
+        return E_INVALIDARG;
+
+    uint8_t const* row;
+    if (!md_get_row_raw(_md_ptr.get(), (mdtable_id_t)ixTbl, rid, &row))
+        return CLDB_E_INDEX_NOTFOUND;
+
+    md_column_layout_t const& column = table->Columns[ixCol];
+    uint32_t value = ReadColumnValue(row, column);
+    switch (column.kind)
+    {
+    case mdck_TableIndex:
+        *pVal = TokenFromRid(value, (ULONG)column.target.table << 24);
+        break;
+    case mdck_CodedIndex:
+    {
+        // See II.24.2.6
+        CodedToken const& kind = GetCodedTokens().Kinds[column.target.coded_index];
+        uint32_t tag = value & ((1u << kind.TagBits) - 1);
+        if (tag >= kind.Count || kind.TokenTypes[tag] == (ULONG)mdtString)
+            return CLDB_E_FILE_CORRUPT;
+        *pVal = TokenFromRid(value >> kind.TagBits, kind.TokenTypes[tag]);
+        break;
+    }
+    default:
+        *pVal = value;
+        break;
+    }
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetString(
+    ULONG   ixString,
+    const char **ppString)
+{
+    if (ppString == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    uint8_t const* data;
+    uint32_t size;
+    RETURN_IF_FAILED(GetHeap(mdhid_String, &data, &size));
+
+    // The empty string is at index 0, even if the heap isn't present.
+    if (ixString == 0 && size == 0)
+    {
+        *ppString = "";
+        return S_OK;
+    }
+
+    if (ixString >= size)
+        return CLDB_E_INDEX_NOTFOUND;
+
+    *ppString = (char const*)data + ixString;
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetBlob(
+    ULONG   ixBlob,
+    ULONG   *pcbData,
+    const void **ppData)
+{
+    if (pcbData == nullptr || ppData == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    uint8_t const* data;
+    uint32_t size;
+    RETURN_IF_FAILED(GetHeap(mdhid_Blob, &data, &size));
+
+    // The empty blob is at index 0, even if the heap isn't present.
+    if (ixBlob == 0 && size == 0)
+    {
+        *pcbData = 0;
+        *ppData = data;
+        return S_OK;
+    }
+
+    uint32_t prefixSize;
+    uint32_t length;
+    if (!ReadBlobEntry(data, size, ixBlob, &prefixSize, &length))
+        return ixBlob >= size ? CLDB_E_INDEX_NOTFOUND : CLDB_E_FILE_CORRUPT;
+
+    *pcbData = length;
+    *ppData = data + ixBlob + prefixSize;
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetGuid(
+    ULONG   ixGuid,
+    const GUID **ppGUID)
+{
+    if (ppGUID == nullptr)
+        return E_INVALIDARG;
+
+    // Index 0 is the nil GUID - II.24.2.5.
+    static GUID const NilGuid = {};
+    if (ixGuid == 0)
+    {
+        *ppGUID = &NilGuid;
+        return S_OK;
+    }
+
+    HRESULT hr;
+    uint8_t const* data;
+    uint32_t size;
+    RETURN_IF_FAILED(GetHeap(mdhid_Guid, &data, &size));
+
+    if (ixGuid > size / sizeof(GUID))
+        return CLDB_E_INDEX_NOTFOUND;
+
+    *ppGUID = (GUID const*)(data + (ixGuid - 1) * sizeof(GUID));
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetUserString(
+    ULONG   ixUserString,
+    ULONG   *pcbData,
+    const void **ppData)
+{
+    if (pcbData == nullptr || ppData == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    uint8_t const* data;
+    uint32_t size;
+    RETURN_IF_FAILED(GetHeap(mdhid_UserString, &data, &size));
+
+    uint32_t prefixSize;
+    uint32_t length;
+    if (!ReadBlobEntry(data, size, ixUserString, &prefixSize, &length))
+        return ixUserString >= size ? CLDB_E_INDEX_NOTFOUND : CLDB_E_FILE_CORRUPT;
+
+    *pcbData = length;
+    *ppData = data + ixUserString + prefixSize;
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetNextString(
+    ULONG   ixString,
+    ULONG   *pNext)
+{
+    if (pNext == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    uint8_t const* data;
+    uint32_t size;
+    RETURN_IF_FAILED(GetHeap(mdhid_String, &data, &size));
+
+    if (ixString >= size)
+        return CLDB_E_INDEX_NOTFOUND;
+
+    void const* end = std::memchr(data + ixString, '\0', size - ixString);
+    if (end == nullptr)
+        return CLDB_E_FILE_CORRUPT;
+
+    ULONG next = (ULONG)((uint8_t const*)end - data) + 1;
+    if (next >= size)
+    {
+        *pNext = 0;
+        return S_FALSE;
+    }
+
+    *pNext = next;
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetNextBlob(
+    ULONG   ixBlob,
+    ULONG   *pNext)
+{
+    if (pNext == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    uint8_t const* data;
+    uint32_t size;
+    RETURN_IF_FAILED(GetHeap(mdhid_Blob, &data, &size));
+
+    uint32_t prefixSize;
+    uint32_t length;
+    if (!ReadBlobEntry(data, size, ixBlob, &prefixSize, &length))
+        return ixBlob >= size ? CLDB_E_INDEX_NOTFOUND : CLDB_E_FILE_CORRUPT;
+
+    ULONG next = ixBlob + prefixSize + length;
+    if (next >= size)
+    {
+        *pNext = 0;
+        return S_FALSE;
+    }
+
+    *pNext = next;
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetNextGuid(
+    ULONG   ixGuid,
+    ULONG   *pNext)
+{
+    if (pNext == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    uint8_t const* data;
+    uint32_t size;
+    RETURN_IF_FAILED(GetHeap(mdhid_Guid, &data, &size));
+
+    ULONG count = size / sizeof(GUID);
+    if (ixGuid > count)
+        return CLDB_E_INDEX_NOTFOUND;
+
+    if (ixGuid == count)
+    {
+        *pNext = 0;
+        return S_FALSE;
+    }
+
+    *pNext = ixGuid + 1;
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetNextUserString(
+    ULONG   ixUserString,
+    ULONG   *pNext)
+{
+    if (pNext == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    uint8_t const* data;
+    uint32_t size;
+    RETURN_IF_FAILED(GetHeap(mdhid_UserString, &data, &size));
+
+    uint32_t prefixSize;
+    uint32_t length;
+    if (!ReadBlobEntry(data, size, ixUserString, &prefixSize, &length))
+        return ixUserString >= size ? CLDB_E_INDEX_NOTFOUND : CLDB_E_FILE_CORRUPT;
+
+    ULONG next = ixUserString + prefixSize + length;
+    if (next >= size)
+    {
+        *pNext = 0;
+        return S_FALSE;
+    }
+
+    *pNext = next;
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetMetaDataStorage(
+    const void **ppvMd,
+    ULONG   *pcbMd)
+{
+    if (ppvMd == nullptr || pcbMd == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    MetadataImage const* image;
+    RETURN_IF_FAILED(_image.Get(_md_ptr.get(), &image));
+
+    *ppvMd = image->Data();
+    *pcbMd = image->Size();
+    return S_OK;
+}
+
+HRESULT MetadataTables::GetMetaDataStreamInfo(
+    ULONG   ix,
+    const char **ppchName,
+    const void **ppv,
+    ULONG   *pcb)
+{
+    HRESULT hr;
+    MetadataImage const* image;
+    RETURN_IF_FAILED(_image.Get(_md_ptr.get(), &image));
+
+    MetadataImage::Stream const* stream = image->GetStream(ix);
+    if (stream == nullptr)
+        return S_FALSE;
+
+    if (ppchName != nullptr)
+        *ppchName = stream->Name;
+    if (ppv != nullptr)
+        *ppv = stream->Data;
+    if (pcb != nullptr)
+        *pcb = stream->Size;
+    return S_OK;
+}
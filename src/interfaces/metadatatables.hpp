@@ -0,0 +1,208 @@
+#ifndef _SRC_INTERFACES_METADATATABLES_HPP_
+#define _SRC_INTERFACES_METADATATABLES_HPP_
+
+#include <internal/dnmd_platform.hpp>
+#include "tearoffbase.hpp"
+#include "controllingiunknown.hpp"
+#include "dnmdowner.hpp"
+#include "metadatacache.hpp"
+
+#include <external/cor.h>
+
+#include <cstdint>
+#include <memory>
+
+// Layouts of all tables, so cells can be read without creating a cursor for each one.
+class TableLayouts final
+{
+public:
+    // The Assembly and AssemblyRef tables have the most columns.
+    static constexpr uint32_t MaxColumnCount = 9;
+
+    struct Table final
+    {
+        md_table_layout_t Layout;
+        md_column_layout_t Columns[MaxColumnCount];
+    };
+
+private:
+    Table _tables[mdtid_End];
+    ULONG _tableCount;
+
+public:
+    static HRESULT Create(mdhandle_t handle, std::unique_ptr<TableLayouts>& layouts);
+
+    // The Portable PDB tables are only reported for Portable PDBs,
+    // so other images have the ECMA-335 table count that CoreCLR reports.
+    ULONG GetTableCount() const noexcept
+    {
+        return _tableCount;
+    }
+
+    // Returns null if the table index is out of range.
+    Table const* GetTable(ULONG ixTbl) const noexcept
+    {
+        return ixTbl < _tableCount ? &_tables[ixTbl] : nullptr;
+    }
+};
+
+// The metadata image and its streams - II.24.2.1.
+// Edited metadata is written out to a new image.
+class MetadataImage final
+{
+public:
+    struct Stream final
+    {
+        char const* Name;
+        uint8_t const* Data;
+        uint32_t Size;
+    };
+
+private:
+    std::unique_ptr<uint8_t[]> _written;
+    uint8_t const* _data;
+    uint32_t _size;
+    std::unique_ptr<Stream[]> _streams;
+    uint32_t _streamCount;
+
+public:
+    static HRESULT Create(mdhandle_t handle, std::unique_ptr<MetadataImage>& image);
+
+    uint8_t const* Data() const noexcept { return _data; }
+    uint32_t Size() const noexcept { return _size; }
+
+    // Returns null if the index is past the last stream.
+    Stream const* GetStream(ULONG ix) const noexcept
+    {
+        return ix < _streamCount ? &_streams[ix] : nullptr;
+    }
+};
+
+class MetadataTables final : public TearOffBase<IMetaDataTables2>
+{
+    mdhandle_view _md_ptr;
+    MetadataCache<TableLayouts> _layouts;
+    MetadataCache<MetadataImage> _image;
+
+    HRESULT GetHeap(md_heap_id_t heapId, uint8_t const** data, uint32_t* size);
+
+protected:
+    virtual bool TryGetInterfaceOnThis(REFIID riid, void** ppvObject) override
+    {
+        assert(riid != IID_IUnknown);
+        if (riid == IID_IMetaDataTables || riid == IID_IMetaDataTables2)
+        {
+            *ppvObject = static_cast<IMetaDataTables2*>(this);
+            return true;
+        }
+        return false;
+    }
+
+public:
+    MetadataTables(IUnknown* controllingUnknown, mdhandle_view md_ptr)
+        : TearOffBase(controllingUnknown)
+        , _md_ptr{ md_ptr }
+    { }
+
+    virtual ~MetadataTables() = default;
+
+public: // IMetaDataTables
+    STDMETHOD(GetStringHeapSize)(
+        ULONG   *pcbStrings) override;
+
+    STDMETHOD(GetBlobHeapSize)(
+        ULONG   *pcbBlobs) override;
+
+    STDMETHOD(GetGuidHeapSize)(
+        ULONG   *pcbGuids) override;
+
+    STDMETHOD(GetUserStringHeapSize)(
+        ULONG   *pcbBlobs) override;
+
+    STDMETHOD(GetNumTables)(
+        ULONG   *pcTables) override;
+
+    STDMETHOD(GetTableIndex)(
+        ULONG   token,
+        ULONG   *pixTbl) override;
+
+    STDMETHOD(GetTableInfo)(
+        ULONG   ixTbl,
+        ULONG   *pcbRow,
+        ULONG   *pcRows,
+        ULONG   *pcCols,
+        ULONG   *piKey,
+        const char **ppName) override;
+
+    STDMETHOD(GetColumnInfo)(
+        ULONG   ixTbl,
+        ULONG   ixCol,
+        ULONG   *poCol,
+        ULONG   *pcbCol,
+        ULONG   *pType,
+        const char **ppName) override;
+
+    STDMETHOD(GetCodedTokenInfo)(
+        ULONG   ixCdTkn,
+        ULONG   *pcTokens,
+        ULONG   **ppTokens,
+        const char **ppName) override;
+
+    STDMETHOD(GetRow)(
+        ULONG   ixTbl,
+        ULONG   rid,
+        void    **ppRow) override;
+
+    STDMETHOD(GetColumn)(
+        ULONG   ixTbl,
+        ULONG   ixCol,
+        ULONG   rid,
+        ULONG   *pVal) override;
+
+    STDMETHOD(GetString)(
+        ULONG   ixString,
+        const char **ppString) override;
+
+    STDMETHOD(GetBlob)(
+        ULONG   ixBlob,
+        ULONG   *pcbData,
+        const void **ppData) override;
+
+    STDMETHOD(GetGuid)(
+        ULONG   ixGuid,
+        const GUID **ppGUID) override;
+
+    STDMETHOD(GetUserString)(
+        ULONG   ixUserString,
+        ULONG   *pcbData,
+        const void **ppData) override;
+
+    STDMETHOD(GetNextString)(
+        ULONG   ixString,
+        ULONG   *pNext) override;
+
+    STDMETHOD(GetNextBlob)(
+        ULONG   ixBlob,
+        ULONG   *pNext) override;
+
+    STDMETHOD(GetNextGuid)(
+        ULONG   ixGuid,
+        ULONG   *pNext) override;
+
+    STDMETHOD(GetNextUserString)(
+        ULONG   ixUserString,
+        ULONG   *pNext) override;
+
+public: // IMetaDataTables2
+    STDMETHOD(GetMetaDataStorage)(
+        const void **ppvMd,
+        ULONG   *pcbMd) override;
+
+    STDMETHOD(GetMetaDataStreamInfo)(
+        ULONG   ix,
+        const char **ppchName,
+        const void **ppv,
+        ULONG   *pcb) override;
+};
+
+#endif // _SRC_INTERFACES_METADATATABLES_HPP_
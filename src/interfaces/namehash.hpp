@@ -0,0 +1,25 @@
+#ifndef _SRC_INTERFACES_NAMEHASH_HPP_
+#define _SRC_INTERFACES_NAMEHASH_HPP_
+
+#include <cstdint>
+
+// FNV-1a hash of the names used as index keys.
+// The hash can be computed incrementally over the parts of a name.
+constexpr uint32_t NameHashSeed = 2166136261u;
+
+inline uint32_t HashName(uint32_t hash, char const* name)
+{
+    for (; *name != '\0'; ++name)
+    {
+        hash ^= (uint8_t)*name;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+inline uint32_t HashName(char const* name)
+{
+    return HashName(NameHashSeed, name);
+}
+
+#endif // _SRC_INTERFACES_NAMEHASH_HPP_
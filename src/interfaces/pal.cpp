@@ -1,7 +1,12 @@
 #include "pal.hpp"
 #include <cstring>
 #include <cassert>
+#include <algorithm>
+#include <string>
 #include <functional>
+#include <atomic>
+#include <mutex>
+#include <new>
 
 #if defined(BUILD_MACOS) || defined(BUILD_UNIX)
 #include <unicode/ustring.h>
@@ -19,123 +24,322 @@
 #include <windows.h>
 #else
 #include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/membarrier.h>)
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#define HAS_MEMBARRIER
+#endif
+#endif
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ASCII_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define ASCII_NEON
 #endif
 
 // String conversion functions
-HRESULT pal::ConvertUtf16ToUtf8(
-    WCHAR const* str,
-    char* buffer,
-    uint32_t bufferLength,
-    _Out_opt_ uint32_t* writtenOrNeeded)
+namespace
 {
-    assert(str != nullptr);
+    // Metadata strings are almost always ASCII, which is converted by widening or narrowing each
+    // code unit. Only the part of a string from its first non-ASCII character is converted by the platform.
+    // SSE2 and NEON are part of the baseline of the 64-bit targets, so they are selected at compile time.
+    constexpr size_t AsciiBlockLength = 16;
 
-    int32_t length;
-#ifdef BUILD_WINDOWS
-    length = ::WideCharToMultiByte(CP_UTF8, 0, str, -1, buffer, bufferLength, nullptr, nullptr);
-    if (length <= 0)
+    // Convert the block if it's all ASCII.
+    bool TryWidenAsciiBlock(uint8_t const* src, uint16_t* dest)
     {
-        if (::GetLastError() == ERROR_INSUFFICIENT_BUFFER)
+#if defined(ASCII_SSE2)
+        __m128i block = _mm_loadu_si128((__m128i const*)src);
+        if (_mm_movemask_epi8(block) != 0)
+            return false;
+
+        __m128i zero = _mm_setzero_si128();
+        _mm_storeu_si128((__m128i*)dest, _mm_unpacklo_epi8(block, zero));
+        _mm_storeu_si128((__m128i*)(dest + 8), _mm_unpackhi_epi8(block, zero));
+        return true;
+#elif defined(ASCII_NEON)
+        uint8x16_t block = vld1q_u8(src);
+        if (vmaxvq_u8(block) >= 0x80)
+            return false;
+
+        vst1q_u16(dest, vmovl_u8(vget_low_u8(block)));
+        vst1q_u16(dest + 8, vmovl_high_u8(block));
+        return true;
+#else
+        uint64_t block[2];
+        std::memcpy(block, src, sizeof(block));
+        if (((block[0] | block[1]) & UINT64_C(0x8080808080808080)) != 0)
+            return false;
+
+        for (size_t i = 0; i < AsciiBlockLength; ++i)
+            dest[i] = src[i];
+        return true;
+#endif
+    }
+
+    // Convert the block if it's all ASCII.
+    bool TryNarrowAsciiBlock(uint16_t const* src, uint8_t* dest)
+    {
+#if defined(ASCII_SSE2)
+        __m128i low = _mm_loadu_si128((__m128i const*)src);
+        __m128i high = _mm_loadu_si128((__m128i const*)(src + 8));
+        __m128i nonAscii = _mm_and_si128(_mm_or_si128(low, high), _mm_set1_epi16((int16_t)0xff80));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonAscii, _mm_setzero_si128())) != 0xffff)
+            return false;
+
+        _mm_storeu_si128((__m128i*)dest, _mm_packus_epi16(low, high));
+        return true;
+#elif defined(ASCII_NEON)
+        uint16x8_t low = vld1q_u16(src);
+        uint16x8_t high = vld1q_u16(src + 8);
+        if (vmaxvq_u16(vorrq_u16(low, high)) >= 0x80)
+            return false;
+
+        vst1q_u8(dest, vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+        return true;
+#else
+        uint16_t nonAscii = 0;
+        for (size_t i = 0; i < AsciiBlockLength; ++i)
+            nonAscii |= src[i];
+        if (nonAscii >= 0x80)
+            return false;
+
+        for (size_t i = 0; i < AsciiBlockLength; ++i)
+            dest[i] = (uint8_t)src[i];
+        return true;
+#endif
+    }
+
+    // Returns the number of leading ASCII characters in the source.
+    // The characters that fit in the destination are converted.
+    template<typename A, typename B, bool(*TryConvertBlock)(A const*, B*)>
+    size_t ConvertAsciiPrefix(A const* src, size_t srcLength, B* dest, size_t destLength)
+    {
+        size_t i = 0;
+        size_t blockLimit = std::min(srcLength, destLength);
+        for (; i + AsciiBlockLength <= blockLimit; i += AsciiBlockLength)
         {
-            if (writtenOrNeeded != nullptr)
-                *writtenOrNeeded = ::WideCharToMultiByte(CP_UTF8, 0, str, -1, nullptr, 0, nullptr, nullptr);
-            return E_NOT_SUFFICIENT_BUFFER;
+            if (!TryConvertBlock(src + i, dest + i))
+                break;
         }
-        return E_FAIL;
+
+        for (; i < srcLength && src[i] < 0x80; ++i)
+        {
+            if (i < destLength)
+                dest[i] = (B)src[i];
+        }
+        return i;
     }
-#elif defined(BUILD_MACOS) || defined(BUILD_UNIX)
-    // Buffer lengths assume null terminator
-    if (bufferLength > 0)
-        bufferLength -= 1;
 
-    UErrorCode err = U_ZERO_ERROR;
-    (void)::u_strToUTF8(buffer, bufferLength, &length, (UChar const*)str, -1, &err);
-    if (U_FAILURE(err))
+    // Convert the string after its ASCII prefix has been converted.
+    template<typename A, typename B>
+    HRESULT ConvertRemainder(
+        HRESULT(*convert)(A const*, B*, uint32_t, uint32_t*),
+        A const* str,
+        size_t strLength,
+        size_t asciiLength,
+        B* buffer,
+        uint32_t bufferLength,
+        uint32_t* writtenOrNeeded)
     {
-        if (err != U_BUFFER_OVERFLOW_ERROR)
+        HRESULT hr;
+        uint32_t length;
+        if (asciiLength == strLength)
+        {
+            // The whole string is ASCII.
+            length = (uint32_t)strLength + 1; // Add null terminator
+            if (bufferLength != 0)
+            {
+                if (bufferLength < length)
+                {
+                    hr = E_NOT_SUFFICIENT_BUFFER;
+                }
+                else
+                {
+                    buffer[strLength] = (B)0;
+                    hr = S_OK;
+                }
+            }
+            else
+            {
+                hr = S_OK;
+            }
+        }
+        else
+        {
+            // Convert the rest of the string into the rest of the buffer, or only compute its length if the buffer is full.
+            uint32_t remainingLength = bufferLength > asciiLength ? bufferLength - (uint32_t)asciiLength : 0;
+            uint32_t convertedLength = 0;
+            hr = convert(str + asciiLength, remainingLength != 0 ? buffer + asciiLength : nullptr, remainingLength, &convertedLength);
+            if (FAILED(hr) && hr != E_NOT_SUFFICIENT_BUFFER)
+                return hr;
+
+            length = (uint32_t)asciiLength + convertedLength;
+            if (bufferLength != 0 && bufferLength < length)
+                hr = E_NOT_SUFFICIENT_BUFFER;
+        }
+
+        if (writtenOrNeeded != nullptr)
+            *writtenOrNeeded = length;
+        return hr;
+    }
+
+    HRESULT ConvertUtf16ToUtf8Platform(
+        WCHAR const* str,
+        char* buffer,
+        uint32_t bufferLength,
+        _Out_opt_ uint32_t* writtenOrNeeded)
+    {
+        assert(str != nullptr);
+
+        int32_t length;
+#ifdef BUILD_WINDOWS
+        length = ::WideCharToMultiByte(CP_UTF8, 0, str, -1, buffer, bufferLength, nullptr, nullptr);
+        if (length <= 0)
+        {
+            if (::GetLastError() == ERROR_INSUFFICIENT_BUFFER)
+            {
+                if (writtenOrNeeded != nullptr)
+                    *writtenOrNeeded = ::WideCharToMultiByte(CP_UTF8, 0, str, -1, nullptr, 0, nullptr, nullptr);
+                return E_NOT_SUFFICIENT_BUFFER;
+            }
             return E_FAIL;
+        }
+#elif defined(BUILD_MACOS) || defined(BUILD_UNIX)
+        // Buffer lengths assume null terminator
+        int32_t capacity = bufferLength > 0 ? (int32_t)(bufferLength - 1) : 0;
 
-        if (bufferLength != 0)
+        UErrorCode err = U_ZERO_ERROR;
+        (void)::u_strToUTF8(buffer, capacity, &length, (UChar const*)str, -1, &err);
+        if (U_FAILURE(err))
         {
-            if (writtenOrNeeded != nullptr)
-                *writtenOrNeeded = (uint32_t)length + 1; // Add null terminator
-            return E_NOT_SUFFICIENT_BUFFER;
+            if (err != U_BUFFER_OVERFLOW_ERROR)
+                return E_FAIL;
+
+            if (bufferLength != 0)
+            {
+                if (writtenOrNeeded != nullptr)
+                    *writtenOrNeeded = (uint32_t)length + 1; // Add null terminator
+                return E_NOT_SUFFICIENT_BUFFER;
+            }
         }
-    }
-    if (buffer != nullptr)
-        buffer[length] = '\0';
-    length += 1; // Add null terminator
+        if (bufferLength != 0)
+            buffer[length] = '\0';
+        length += 1; // Add null terminator
 #else
 #error Missing implementation
 #endif // !BUILD_WINDOWS
 
-    if (writtenOrNeeded != nullptr)
-        *writtenOrNeeded = (uint32_t)length;
-    return S_OK;
-}
+        if (writtenOrNeeded != nullptr)
+            *writtenOrNeeded = (uint32_t)length;
+        return S_OK;
+    }
 
-HRESULT pal::ConvertUtf8ToUtf16(
-    char const* str,
-    WCHAR* buffer,
-    uint32_t bufferLength,
-    _Out_opt_ uint32_t* writtenOrNeeded)
-{
-    assert(str != nullptr);
+    HRESULT ConvertUtf8ToUtf16Platform(
+        char const* str,
+        WCHAR* buffer,
+        uint32_t bufferLength,
+        _Out_opt_ uint32_t* writtenOrNeeded)
+    {
+        assert(str != nullptr);
 
-    int32_t length;
+        int32_t length;
 #ifdef BUILD_WINDOWS
-    length = ::MultiByteToWideChar(CP_UTF8, 0, str, -1, buffer, bufferLength);
-    if (length <= 0)
-    {
-        if (::GetLastError() == ERROR_INSUFFICIENT_BUFFER)
+        length = ::MultiByteToWideChar(CP_UTF8, 0, str, -1, buffer, bufferLength);
+        if (length <= 0)
         {
-            if (writtenOrNeeded != nullptr)
-                *writtenOrNeeded = ::MultiByteToWideChar(CP_UTF8, 0, str, -1, nullptr, 0);
-            return E_NOT_SUFFICIENT_BUFFER;
+            if (::GetLastError() == ERROR_INSUFFICIENT_BUFFER)
+            {
+                if (writtenOrNeeded != nullptr)
+                    *writtenOrNeeded = ::MultiByteToWideChar(CP_UTF8, 0, str, -1, nullptr, 0);
+                return E_NOT_SUFFICIENT_BUFFER;
+            }
+            return E_FAIL;
         }
-        return E_FAIL;
-    }
 #elif defined(BUILD_MACOS) || defined(BUILD_UNIX)
-    // Buffer lengths assume null terminator
-    if (bufferLength > 0)
-        bufferLength -= 1;
-
-    UErrorCode err = U_ZERO_ERROR;
-    (void)::u_strFromUTF8((UChar*)buffer, bufferLength, &length, str, -1, &err);
-    if (U_FAILURE(err))
-    {
-        if (err != U_BUFFER_OVERFLOW_ERROR)
-            return E_FAIL;
+        // Buffer lengths assume null terminator
+        int32_t capacity = bufferLength > 0 ? (int32_t)(bufferLength - 1) : 0;
 
-        if (bufferLength != 0)
+        UErrorCode err = U_ZERO_ERROR;
+        (void)::u_strFromUTF8((UChar*)buffer, capacity, &length, str, -1, &err);
+        if (U_FAILURE(err))
         {
-            if (writtenOrNeeded != nullptr)
-                *writtenOrNeeded = (uint32_t)length + 1; // Add null terminator
-            return E_NOT_SUFFICIENT_BUFFER;
+            if (err != U_BUFFER_OVERFLOW_ERROR)
+                return E_FAIL;
+
+            if (bufferLength != 0)
+            {
+                if (writtenOrNeeded != nullptr)
+                    *writtenOrNeeded = (uint32_t)length + 1; // Add null terminator
+                return E_NOT_SUFFICIENT_BUFFER;
+            }
         }
-    }
-    if (buffer != nullptr)
-        buffer[length] = W('\0');
-    length += 1; // Add null terminator
+        if (bufferLength != 0)
+            buffer[length] = W('\0');
+        length += 1; // Add null terminator
 #else
 #error Missing implementation
 #endif // !BUILD_WINDOWS
 
-    if (writtenOrNeeded != nullptr)
-        *writtenOrNeeded = (uint32_t)length;
-    return S_OK;
+        if (writtenOrNeeded != nullptr)
+            *writtenOrNeeded = (uint32_t)length;
+        return S_OK;
+    }
+}
+
+HRESULT pal::ConvertUtf16ToUtf8(
+    WCHAR const* str,
+    char* buffer,
+    uint32_t bufferLength,
+    _Out_opt_ uint32_t* writtenOrNeeded)
+{
+    assert(str != nullptr);
+    if (buffer == nullptr)
+        bufferLength = 0;
+
+    size_t length = std::char_traits<WCHAR>::length(str);
+    if (length >= UINT32_MAX)
+        return E_INVALIDARG;
+
+    size_t asciiLength = ConvertAsciiPrefix<uint16_t, uint8_t, TryNarrowAsciiBlock>((uint16_t const*)str, length, (uint8_t*)buffer, bufferLength);
+    return ConvertRemainder(ConvertUtf16ToUtf8Platform, str, length, asciiLength, buffer, bufferLength, writtenOrNeeded);
+}
+
+HRESULT pal::ConvertUtf8ToUtf16(
+    char const* str,
+    WCHAR* buffer,
+    uint32_t bufferLength,
+    _Out_opt_ uint32_t* writtenOrNeeded)
+{
+    assert(str != nullptr);
+    if (buffer == nullptr)
+        bufferLength = 0;
+
+    size_t length = ::strlen(str);
+    if (length >= UINT32_MAX)
+        return E_INVALIDARG;
+
+    size_t asciiLength = ConvertAsciiPrefix<uint8_t, uint16_t, TryWidenAsciiBlock>((uint8_t const*)str, length, (uint16_t*)buffer, bufferLength);
+    return ConvertRemainder(ConvertUtf8ToUtf16Platform, str, length, asciiLength, buffer, bufferLength, writtenOrNeeded);
 }
 
 template<>
-HRESULT pal::StringConvert<WCHAR, char>::ConvertWorker(WCHAR const* c, char* buffer, uint32_t& bufferLength)
+HRESULT pal::StringConvert<WCHAR, char>::ConvertWorker(WCHAR const* c, char* buffer, uint32_t bufferLength, uint32_t& writtenOrNeeded)
 {
-    return ConvertUtf16ToUtf8(c, buffer, bufferLength, &bufferLength);
+    return ConvertUtf16ToUtf8(c, buffer, bufferLength, &writtenOrNeeded);
 }
 
 template<>
-HRESULT pal::StringConvert<char, WCHAR>::ConvertWorker(char const* c, WCHAR* buffer, uint32_t& bufferLength)
+HRESULT pal::StringConvert<char, WCHAR>::ConvertWorker(char const* c, WCHAR* buffer, uint32_t bufferLength, uint32_t& writtenOrNeeded)
 {
-    return ConvertUtf8ToUtf16(c, buffer, bufferLength, &bufferLength);
+    return ConvertUtf8ToUtf16(c, buffer, bufferLength, &writtenOrNeeded);
 }
 
 #if !defined(__STDC_LIB_EXT1__) && !defined(BUILD_WINDOWS)
@@ -235,6 +439,11 @@ namespace pal
             ::AcquireSRWLockShared(&_lock);
         }
 
+        bool try_lock_shared() noexcept
+        {
+            return ::TryAcquireSRWLockShared(&_lock) != FALSE;
+        }
+
         void unlock_shared() noexcept
         {
             ::ReleaseSRWLockShared(&_lock);
@@ -245,6 +454,11 @@ namespace pal
             ::AcquireSRWLockExclusive(&_lock);
         }
 
+        bool try_lock() noexcept
+        {
+            return ::TryAcquireSRWLockExclusive(&_lock) != FALSE;
+        }
+
         void unlock() noexcept
         {
             ::ReleaseSRWLockExclusive(&_lock);
@@ -268,6 +482,11 @@ namespace pal
             ::pthread_rwlock_rdlock(&_lock);
         }
 
+        bool try_lock_shared() noexcept
+        {
+            return ::pthread_rwlock_tryrdlock(&_lock) == 0;
+        }
+
         void unlock_shared() noexcept
         {
             ::pthread_rwlock_unlock(&_lock);
@@ -278,6 +497,11 @@ namespace pal
             ::pthread_rwlock_wrlock(&_lock);
         }
 
+        bool try_lock() noexcept
+        {
+            return ::pthread_rwlock_trywrlock(&_lock) == 0;
+        }
+
         void unlock() noexcept
         {
             ::pthread_rwlock_unlock(&_lock);
@@ -306,6 +530,11 @@ void pal::ReadLock::lock() noexcept
     _lock._impl->lock_shared();
 }
 
+bool pal::ReadLock::try_lock() noexcept
+{
+    return _lock._impl->try_lock_shared();
+}
+
 void pal::ReadLock::unlock() noexcept
 {
     _lock._impl->unlock_shared();
@@ -321,7 +550,262 @@ void pal::WriteLock::lock() noexcept
     _lock._impl->lock();
 }
 
+bool pal::WriteLock::try_lock() noexcept
+{
+    return _lock._impl->try_lock();
+}
+
 void pal::WriteLock::unlock() noexcept
 {
     _lock._impl->unlock();
 }
+
+// Memory-mapped file implementation
+#if defined(BUILD_WINDOWS)
+HRESULT pal::MappedFile::Open(WCHAR const* path, std::unique_ptr<MappedFile>& file)
+{
+    if (path == nullptr)
+        return E_INVALIDARG;
+
+    HANDLE handle = ::CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return HRESULT_FROM_WIN32(::GetLastError());
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(handle, &size))
+    {
+        HRESULT hr = HRESULT_FROM_WIN32(::GetLastError());
+        ::CloseHandle(handle);
+        return hr;
+    }
+
+    // An empty file can't be mapped.
+    void* data = nullptr;
+    if (size.QuadPart != 0)
+    {
+        HANDLE mapping = ::CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr)
+        {
+            // The view keeps the mapping alive.
+            data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            ::CloseHandle(mapping);
+        }
+
+        if (data == nullptr)
+        {
+            HRESULT hr = HRESULT_FROM_WIN32(::GetLastError());
+            ::CloseHandle(handle);
+            return hr;
+        }
+    }
+    ::CloseHandle(handle);
+
+    file.reset(new (std::nothrow) MappedFile{ data, (size_t)size.QuadPart });
+    if (file == nullptr)
+    {
+        if (data != nullptr)
+            ::UnmapViewOfFile(data);
+        return E_OUTOFMEMORY;
+    }
+    return S_OK;
+}
+
+pal::MappedFile::~MappedFile()
+{
+    if (_data != nullptr)
+        ::UnmapViewOfFile(_data);
+}
+#else
+HRESULT pal::MappedFile::Open(WCHAR const* path, std::unique_ptr<MappedFile>& file)
+{
+    if (path == nullptr)
+        return E_INVALIDARG;
+
+    pal::StringConvert<WCHAR, char> pathUtf8{ path };
+    if (!pathUtf8.Success())
+        return E_INVALIDARG;
+
+    int fd = ::open(pathUtf8, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return E_FAIL;
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        return E_FAIL;
+    }
+
+    // An empty file can't be mapped.
+    void* data = nullptr;
+    size_t size = (size_t)info.st_size;
+    if (size != 0)
+    {
+        data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            ::close(fd);
+            return E_FAIL;
+        }
+    }
+
+    // The mapping keeps the file open.
+    ::close(fd);
+
+    file.reset(new (std::nothrow) MappedFile{ data, size });
+    if (file == nullptr)
+    {
+        if (data != nullptr)
+            ::munmap(data, size);
+        return E_OUTOFMEMORY;
+    }
+    return S_OK;
+}
+
+pal::MappedFile::~MappedFile()
+{
+    if (_data != nullptr)
+        ::munmap(_data, _size);
+}
+#endif // !BUILD_WINDOWS
+
+// Epoch-based reclamation implementation
+namespace
+{
+    // An epoch of 0 indicates that a thread doesn't hold a guard.
+    std::atomic<uint64_t> g_epoch{ 1 };
+
+    struct EpochSlot final
+    {
+        std::atomic<uint64_t> Epoch{ 0 };
+        uint32_t Depth{ 0 };
+        bool Registered{ false };
+        EpochSlot* Prev{ nullptr };
+        EpochSlot* Next{ nullptr };
+
+        ~EpochSlot();
+    };
+
+    // The slots of all threads that have used a guard.
+    // The lock is only taken when a thread first uses a guard, when it exits and by writers.
+    std::mutex g_epochSlotsLock;
+    EpochSlot* g_epochSlots;
+
+    EpochSlot::~EpochSlot()
+    {
+        if (!Registered)
+            return;
+
+        std::lock_guard<std::mutex> lock{ g_epochSlotsLock };
+        if (Prev != nullptr)
+            Prev->Next = Next;
+        else
+            g_epochSlots = Next;
+
+        if (Next != nullptr)
+            Next->Prev = Prev;
+    }
+
+    thread_local EpochSlot t_epochSlot;
+
+    // Entering a guard is on every read path, while writers only check for quiescence when
+    // they retire an object. Where the OS can issue a memory barrier on every running thread
+    // of the process, writers do that and readers only need to stop compiler reordering.
+    // Otherwise, readers pay for a full fence on entering an outermost guard.
+#if defined(BUILD_WINDOWS)
+    bool InitializeProcessBarrier() noexcept
+    {
+        return true;
+    }
+
+    void ProcessBarrier() noexcept
+    {
+        ::FlushProcessWriteBuffers();
+    }
+#elif defined(HAS_MEMBARRIER)
+    bool InitializeProcessBarrier() noexcept
+    {
+        long commands = ::syscall(__NR_membarrier, MEMBARRIER_CMD_QUERY, 0);
+        if (commands < 0 || (commands & MEMBARRIER_CMD_PRIVATE_EXPEDITED) == 0)
+            return false;
+        return ::syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0;
+    }
+
+    void ProcessBarrier() noexcept
+    {
+        long result = ::syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+        assert(result == 0);
+        (void)result;
+    }
+#else
+    bool InitializeProcessBarrier() noexcept
+    {
+        return false;
+    }
+
+    void ProcessBarrier() noexcept
+    {
+    }
+#endif
+
+    bool HasProcessBarrier() noexcept
+    {
+        static bool const hasProcessBarrier = InitializeProcessBarrier();
+        return hasProcessBarrier;
+    }
+}
+
+pal::EpochGuard::EpochGuard() noexcept
+{
+    EpochSlot& slot = t_epochSlot;
+    if (!slot.Registered)
+    {
+        std::lock_guard<std::mutex> lock{ g_epochSlotsLock };
+        slot.Next = g_epochSlots;
+        if (g_epochSlots != nullptr)
+            g_epochSlots->Prev = &slot;
+        g_epochSlots = &slot;
+        slot.Registered = true;
+    }
+
+    if (slot.Depth++ == 0)
+    {
+        // Read the epoch before any published object, so a reader that sees an old object
+        // can't record the epoch that was advanced when the object was retired.
+        slot.Epoch.store(g_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+        // Make the epoch visible to writers before any published object is read.
+        // Pairs with the process-wide barrier or the fence in IsEpochQuiescent.
+        if (HasProcessBarrier())
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        else
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+pal::EpochGuard::~EpochGuard() noexcept
+{
+    EpochSlot& slot = t_epochSlot;
+    assert(slot.Depth > 0);
+    if (--slot.Depth == 0)
+        slot.Epoch.store(0, std::memory_order_release);
+}
+
+uint64_t pal::AdvanceEpoch() noexcept
+{
+    return g_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+}
+
+bool pal::IsEpochQuiescent(uint64_t epoch) noexcept
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (HasProcessBarrier())
+        ProcessBarrier();
+    std::lock_guard<std::mutex> lock{ g_epochSlotsLock };
+    for (EpochSlot* slot = g_epochSlots; slot != nullptr; slot = slot->Next)
+    {
+        uint64_t slotEpoch = slot->Epoch.load(std::memory_order_acquire);
+        if (slotEpoch != 0 && slotEpoch < epoch)
+            return false;
+    }
+    return true;
+}
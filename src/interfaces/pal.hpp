@@ -12,6 +12,7 @@ namespace pal
     // Convert the UTF-16 string into UTF-8
     // Buffer length should include null terminator.
     // Written length includes null terminator.
+    // If the buffer is too small, it's filled with the start of the string and the needed length is returned.
     HRESULT ConvertUtf16ToUtf8(
         WCHAR const* str,
         char* buffer,
@@ -21,6 +22,7 @@ namespace pal
     // Convert the UTF-8 string into UTF-16
     // Buffer length should include null terminator.
     // Written length includes null terminator.
+    // If the buffer is too small, it's filled with the start of the string and the needed length is returned.
     HRESULT ConvertUtf8ToUtf16(
         char const* str,
         WCHAR* buffer,
@@ -31,43 +33,50 @@ namespace pal
     template<typename A, typename B>
     class StringConvert
     {
+        // Most strings fit in the inline buffer, so they are converted in a single pass without allocating.
+        static constexpr uint32_t InlineBufferLength = 128;
+
+        B _inlineBuffer[InlineBufferLength];
         B* _ptr;
         malloc_ptr<void> _owner;
         uint32_t _charLength;
         bool _converted;
-        HRESULT ConvertWorker(A const* c, B* buffer, uint32_t& bufferLength);
+        HRESULT ConvertWorker(A const* c, B* buffer, uint32_t bufferLength, uint32_t& writtenOrNeeded);
 
     public:
         StringConvert(A const* c, B* buffer, uint32_t bufferLength) noexcept
-            : _owner{}
+            : _ptr{}
+            , _owner{}
             , _charLength{}
             , _converted{}
         {
-            uint32_t neededLength = bufferLength;
-            // Compute needed size for conversion and/or rely on the user supplied buffer.
-            HRESULT hr = ConvertWorker(c, buffer, neededLength);
-            if (hr == S_OK)
+            if (buffer == nullptr || bufferLength == 0)
             {
-                if (bufferLength < neededLength)
-                {
-                    buffer = (B*)::malloc(sizeof(*buffer) * neededLength);
-                    _owner.reset(buffer);
-                    bufferLength = neededLength;
-                }
+                buffer = _inlineBuffer;
+                bufferLength = InlineBufferLength;
+            }
 
-                // Do conversion
-                hr = ConvertWorker(c, buffer, bufferLength);
-                _converted = SUCCEEDED(hr);
-                if (_converted)
+            // Convert into the buffer and only allocate if the conversion didn't fit.
+            uint32_t neededLength;
+            HRESULT hr = ConvertWorker(c, buffer, bufferLength, neededLength);
+            if (hr == E_NOT_SUFFICIENT_BUFFER)
+            {
+                buffer = (B*)::malloc(sizeof(*buffer) * neededLength);
+                if (buffer == nullptr)
                 {
-                    _ptr = buffer;
-                    _charLength = bufferLength;
+                    // Failed to convert. Set the needed length so the caller can possibly use it.
+                    _charLength = neededLength;
+                    return;
                 }
+
+                _owner.reset(buffer);
+                hr = ConvertWorker(c, buffer, neededLength, neededLength);
             }
-            else if (neededLength != bufferLength)
+
+            _converted = SUCCEEDED(hr);
+            if (_converted)
             {
-                // Failed to convert. If the needed length was updated
-                // then set that so the caller can possibly use it.
+                _ptr = buffer;
                 _charLength = neededLength;
             }
         }
@@ -114,7 +123,7 @@ namespace pal
 
     bool ComputeSha1Hash(span<uint8_t const> data, std::array<uint8_t, SHA1_HASH_SIZE>& hashDestination);
     
-    // A simple read-write lock that provides accessors to meet the C++11 BasicLockable requirements.
+    // A simple read-write lock that provides accessors to meet the C++11 Lockable requirements.
     class ReadWriteLock;
 
     class ReadLock final
@@ -125,6 +134,7 @@ namespace pal
             ReadLock(ReadLock const&) = delete;
             ReadLock(ReadLock&&) = delete;
             void lock() noexcept;
+            bool try_lock() noexcept;
             void unlock() noexcept;
     };
 
@@ -136,6 +146,7 @@ namespace pal
             WriteLock(WriteLock const&) = delete;
             WriteLock(WriteLock&&) = delete;
             void lock() noexcept;
+            bool try_lock() noexcept;
             void unlock() noexcept;
     };
 
@@ -159,6 +170,61 @@ namespace pal
             return _writeLock;
         }
     };
+
+    // A read-only view of a whole file.
+    // Pages are only read from the file when they are first accessed.
+    class MappedFile final
+    {
+        void* _data;
+        size_t _size;
+
+        MappedFile(void* data, size_t size) noexcept
+            : _data{ data }
+            , _size{ size }
+        { }
+
+    public:
+        static HRESULT Open(WCHAR const* path, std::unique_ptr<MappedFile>& file);
+
+        ~MappedFile();
+
+        MappedFile(MappedFile const&) = delete;
+        MappedFile& operator=(MappedFile const&) = delete;
+
+        uint8_t const* Data() const noexcept
+        {
+            return (uint8_t const*)_data;
+        }
+
+        size_t Size() const noexcept
+        {
+            return _size;
+        }
+    };
+
+    // Epoch-based reclamation for objects that readers use without taking a lock.
+    // A reader holds an EpochGuard while it uses a published object. A writer that
+    // replaces a published object calls AdvanceEpoch() and can destroy the replaced
+    // object once IsEpochQuiescent() returns true for the returned epoch.
+    // Entering and leaving a guard only writes to memory owned by the calling thread.
+    // Where the OS supports it (FlushProcessWriteBuffers, Linux membarrier), entering a guard
+    // only needs an acquire load of the epoch instead of a full fence, and IsEpochQuiescent()
+    // issues a barrier on every thread of the process.
+    class EpochGuard final
+    {
+    public:
+        EpochGuard() noexcept;
+        ~EpochGuard() noexcept;
+        EpochGuard(EpochGuard const&) = delete;
+        EpochGuard(EpochGuard&&) = delete;
+        EpochGuard& operator=(EpochGuard const&) = delete;
+        EpochGuard& operator=(EpochGuard&&) = delete;
+    };
+
+    uint64_t AdvanceEpoch() noexcept;
+
+    // Returns true when no thread holds an EpochGuard that was entered before the epoch.
+    bool IsEpochQuiescent(uint64_t epoch) noexcept;
 }
 
 // Implementations for missing bounds checking APIs.
@@ -0,0 +1,142 @@
+#include "presencefilter.hpp"
+
+#include <cassert>
+
+namespace
+{
+    // Parent tables with at most this many rows are always tracked with an exact bitmap.
+    constexpr uint32_t ExactRowLimit = 1 << 16;
+
+    // Bloom filters use at least this many bits per referencing row, rounded up
+    // to a power of 2, and this many probes for a false positive rate near 1%.
+    constexpr uint32_t BloomBitsPerEntry = 10;
+    constexpr uint32_t BloomProbeCount = 3;
+
+    constexpr uint32_t BitsPerWord = 64;
+
+    uint32_t GetWordCount(uint32_t bitCount)
+    {
+        return (bitCount + BitsPerWord - 1) / BitsPerWord;
+    }
+
+    uint32_t RoundUpToPowerOf2(uint32_t value)
+    {
+        uint32_t result = BitsPerWord;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+
+    uint32_t GetTableId(mdToken tk)
+    {
+        return TypeFromToken(tk) >> 24;
+    }
+
+    // Derive the first probe and the distance between probes from a row.
+    void GetBloomProbes(uint32_t row, uint32_t& probe, uint32_t& step)
+    {
+        uint64_t hash = row * UINT64_C(0x9E3779B97F4A7C15);
+        probe = (uint32_t)(hash >> 32);
+        step = (uint32_t)(hash >> 16) | 1;
+    }
+
+    void SetBit(uint64_t* words, uint32_t bit)
+    {
+        words[bit / BitsPerWord] |= UINT64_C(1) << (bit % BitsPerWord);
+    }
+
+    bool IsBitSet(uint64_t const* words, uint32_t bit)
+    {
+        return (words[bit / BitsPerWord] & (UINT64_C(1) << (bit % BitsPerWord))) != 0;
+    }
+}
+
+HRESULT PresenceFilter::Initialize(mdhandle_t handle, mdtable_id_t table, col_index_t parentColumn)
+{
+    for (TableFilter& filter : _tables)
+        filter = {};
+
+    mdcursor_t cursor;
+    uint32_t count;
+    if (!md_create_cursor(handle, table, &cursor, &count) || count == 0)
+        return S_OK; // No rows, so no token is a parent.
+
+    // Read the parent column in a single pass.
+    std::vector<mdToken> parents(count);
+    if ((int32_t)count != md_get_column_value_as_token(cursor, parentColumn, count, parents.data()))
+        return CLDB_E_FILE_CORRUPT;
+
+    uint32_t entryCounts[mdtid_End] = {};
+    uint32_t rowLimits[mdtid_End] = {};
+    for (mdToken parent : parents)
+    {
+        uint32_t tableId = GetTableId(parent);
+        assert(tableId < mdtid_End);
+        entryCounts[tableId]++;
+        if (RidFromToken(parent) >= rowLimits[tableId])
+            rowLimits[tableId] = RidFromToken(parent) + 1;
+    }
+
+    // Use a bitmap when it is no larger than a Bloom filter for the same table.
+    uint32_t wordCount = 0;
+    for (uint32_t i = 0; i < mdtid_End; ++i)
+    {
+        if (entryCounts[i] == 0)
+            continue;
+
+        uint64_t bloomBitCount = (uint64_t)entryCounts[i] * BloomBitsPerEntry;
+        TableFilter& filter = _tables[i];
+        filter.Offset = wordCount;
+        filter.Exact = rowLimits[i] <= ExactRowLimit || rowLimits[i] <= bloomBitCount;
+        filter.BitCount = filter.Exact
+            ? rowLimits[i]
+            : RoundUpToPowerOf2((uint32_t)bloomBitCount);
+        wordCount += GetWordCount(filter.BitCount);
+    }
+
+    _words.assign(wordCount, 0);
+    for (mdToken parent : parents)
+    {
+        TableFilter const& filter = _tables[GetTableId(parent)];
+        uint64_t* words = _words.data() + filter.Offset;
+        uint32_t row = RidFromToken(parent);
+        if (filter.Exact)
+        {
+            SetBit(words, row);
+            continue;
+        }
+
+        uint32_t probe;
+        uint32_t step;
+        GetBloomProbes(row, probe, step);
+        for (uint32_t i = 0; i < BloomProbeCount; ++i, probe += step)
+            SetBit(words, probe & (filter.BitCount - 1));
+    }
+    return S_OK;
+}
+
+bool PresenceFilter::MayContain(mdToken parent) const noexcept
+{
+    uint32_t tableId = GetTableId(parent);
+    if (tableId >= mdtid_End)
+        return false;
+
+    TableFilter const& filter = _tables[tableId];
+    if (filter.BitCount == 0)
+        return false;
+
+    uint64_t const* words = _words.data() + filter.Offset;
+    uint32_t row = RidFromToken(parent);
+    if (filter.Exact)
+        return row < filter.BitCount && IsBitSet(words, row);
+
+    uint32_t probe;
+    uint32_t step;
+    GetBloomProbes(row, probe, step);
+    for (uint32_t i = 0; i < BloomProbeCount; ++i, probe += step)
+    {
+        if (!IsBitSet(words, probe & (filter.BitCount - 1)))
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef _SRC_INTERFACES_PRESENCEFILTER_HPP_
+#define _SRC_INTERFACES_PRESENCEFILTER_HPP_
+
+#include <internal/dnmd_platform.hpp>
+
+#include <external/cor.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Answers whether a token may be the parent of a row in a table keyed by a parent column,
+// for example whether a token may have custom attributes.
+// A negative answer is exact; a positive answer must be confirmed by a lookup in the table.
+// Parent tables with few rows are tracked with an exact bitmap of their rows,
+// larger tables that are sparsely referenced are tracked with a Bloom filter.
+class PresenceFilter
+{
+    struct TableFilter final
+    {
+        uint32_t Offset; // Offset of the filter's first word
+        uint32_t BitCount; // Zero if the table has no rows referenced
+        bool Exact;
+    };
+
+    TableFilter _tables[mdtid_End];
+    std::vector<uint64_t> _words;
+
+protected:
+    PresenceFilter() = default;
+
+    HRESULT Initialize(mdhandle_t handle, mdtable_id_t table, col_index_t parentColumn);
+
+public:
+    bool MayContain(mdToken parent) const noexcept;
+};
+
+template<mdtable_id_t Table, col_index_t ParentColumn>
+class TablePresenceFilter final : public PresenceFilter
+{
+    TablePresenceFilter() = default;
+
+public:
+    static HRESULT Create(mdhandle_t handle, std::unique_ptr<TablePresenceFilter>& filter)
+    {
+        std::unique_ptr<TablePresenceFilter> newFilter{ new TablePresenceFilter{} };
+        HRESULT hr = newFilter->Initialize(handle, Table, ParentColumn);
+        if (FAILED(hr))
+            return hr;
+
+        filter = std::move(newFilter);
+        return S_OK;
+    }
+};
+
+using CustomAttributePresence = TablePresenceFilter<mdtid_CustomAttribute, mdtCustomAttribute_Parent>;
+using ConstantPresence = TablePresenceFilter<mdtid_Constant, mdtConstant_Parent>;
+using FieldMarshalPresence = TablePresenceFilter<mdtid_FieldMarshal, mdtFieldMarshal_Parent>;
+using DeclSecurityPresence = TablePresenceFilter<mdtid_DeclSecurity, mdtDeclSecurity_Parent>;
+using ImplMapPresence = TablePresenceFilter<mdtid_ImplMap, mdtImplMap_MemberForwarded>;
+
+#endif // _SRC_INTERFACES_PRESENCEFILTER_HPP_
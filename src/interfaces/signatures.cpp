@@ -334,6 +334,7 @@ HRESULT ImportSignatureIntoModule(
     mdhandle_t destinationAssembly,
     mdhandle_t destinationModule,
     span<const uint8_t> signature,
+    ImportSession* session,
     std::function<void(mdcursor_t)> onRowAdded,
     malloc_span<uint8_t>& importedSignature)
 {
@@ -369,6 +370,7 @@ HRESULT ImportSignatureIntoModule(
                 sourceAssemblyHash,
                 destinationAssembly,
                 destinationModule,
+                session,
                 onRowAdded,
                 &token);
             
@@ -452,6 +454,7 @@ HRESULT ImportTypeSpecBlob(
     mdhandle_t destinationAssembly,
     mdhandle_t destinationModule,
     span<const uint8_t> typeSpecBlob,
+    ImportSession* session,
     std::function<void(mdcursor_t)> onRowAdded,
     malloc_span<uint8_t>& importedTypeSpecBlob)
 {
@@ -487,6 +490,7 @@ HRESULT ImportTypeSpecBlob(
                 sourceAssemblyHash,
                 destinationAssembly,
                 destinationModule,
+                session,
                 onRowAdded,
                 &token);
             
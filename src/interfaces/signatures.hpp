@@ -9,6 +9,8 @@
 #include <cstdint>
 #include <functional>
 
+class ImportSession;
+
 malloc_span<uint8_t> GetMethodDefSigFromMethodRefSig(span<uint8_t> methodRefSig);
 
 // Import a signature from one set of module and assembly metadata into another set of module and assembly metadata.
@@ -21,6 +23,7 @@ malloc_span<uint8_t> GetMethodDefSigFromMethodRefSig(span<uint8_t> methodRefSig)
 // - PropertySig (II.23.2.5)
 // - LocalVarSig (II.23.2.6)
 // - MethodSpec (II.23.2.15)
+// The optional session is used to reuse references imported by previous imports from the same source.
 HRESULT ImportSignatureIntoModule(
     mdhandle_t sourceAssembly,
     mdhandle_t sourceModule,
@@ -28,6 +31,7 @@ HRESULT ImportSignatureIntoModule(
     mdhandle_t destinationAssembly,
     mdhandle_t destinationModule,
     span<const uint8_t> signature,
+    ImportSession* session,
     std::function<void(mdcursor_t)> onRowAdded,
     malloc_span<uint8_t>& importedSignature);
 
@@ -39,6 +43,7 @@ HRESULT ImportTypeSpecBlob(
     mdhandle_t destinationAssembly,
     mdhandle_t destinationModule,
     span<const uint8_t> typeSpecBlob,
+    ImportSession* session,
     std::function<void(mdcursor_t)> onRowAdded,
     malloc_span<uint8_t>& importedTypeSpecBlob);
 
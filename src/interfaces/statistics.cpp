@@ -0,0 +1,187 @@
+#ifdef DNMD_BUILD_SHARED
+#ifdef _MSC_VER
+#define DNMD_EXPORT __declspec(dllexport)
+#else
+#define DNMD_EXPORT __attribute__((__visibility__("default")))
+#endif // !_MSC_VER
+#endif // DNMD_BUILD_SHARED
+
+#include "statistics.hpp"
+
+#include <cinttypes>
+#include <cstring>
+
+namespace
+{
+    // The number of shards that threads record into.
+    constexpr uint32_t ShardCount = 8;
+
+    char const* const MethodNames[] =
+    {
+#define DEFINE_METHOD_NAME(name) #name,
+        DNMD_THREADSAFE_METHODS(DEFINE_METHOD_NAME)
+#undef DEFINE_METHOD_NAME
+    };
+
+    static_assert(ARRAY_SIZE(MethodNames) == (size_t)ThreadSafeMethod::Count, "Method names must match the method IDs");
+
+    // Threads are assigned shards round-robin the first time they record.
+    std::atomic<uint32_t> g_nextShard{ 0 };
+    thread_local uint32_t t_shard = g_nextShard.fetch_add(1, std::memory_order_relaxed) % ShardCount;
+
+    uint32_t GetHistogramBucket(uint64_t nanoseconds)
+    {
+        uint32_t bucket = 0;
+        for (uint64_t limit = 256; bucket < DNMD_STATISTICS_HISTOGRAM_BUCKETS - 1 && nanoseconds >= limit; limit <<= 2)
+            bucket++;
+        return bucket;
+    }
+
+    void Add(std::atomic<uint64_t>& counter, uint64_t value)
+    {
+        (void)counter.fetch_add(value, std::memory_order_relaxed);
+    }
+}
+
+ThreadSafeStatistics::ThreadSafeStatistics(IUnknown* controllingUnknown)
+    : TearOffBase(controllingUnknown)
+    , _shards{ new Shard[ShardCount] }
+{
+    (void)ResetStatistics();
+}
+
+void ThreadSafeStatistics::Record(ThreadSafeMethod method, bool blocked, Clock::duration wait, Clock::duration hold) noexcept
+{
+    assert(method < ThreadSafeMethod::Count);
+    uint64_t waitNanoseconds = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count();
+    uint64_t holdNanoseconds = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(hold).count();
+
+    Counters& counters = _shards[t_shard].Methods[(uint32_t)method];
+    Add(counters.CallCount, 1);
+    if (blocked)
+        Add(counters.BlockedCount, 1);
+    Add(counters.LockWaitNanoseconds, waitNanoseconds);
+    Add(counters.LockHoldNanoseconds, holdNanoseconds);
+    Add(counters.LockWaitHistogram[GetHistogramBucket(waitNanoseconds)], 1);
+    Add(counters.LockHoldHistogram[GetHistogramBucket(holdNanoseconds)], 1);
+}
+
+ULONG STDMETHODCALLTYPE ThreadSafeStatistics::GetMethodCount()
+{
+    return (ULONG)ThreadSafeMethod::Count;
+}
+
+HRESULT STDMETHODCALLTYPE ThreadSafeStatistics::GetMethodStatistics(ULONG index, DNMDMethodStatistics* pStatistics)
+{
+    if (index >= (ULONG)ThreadSafeMethod::Count || pStatistics == nullptr)
+        return E_INVALIDARG;
+
+    // The shards are read while other threads may still be recording,
+    // so the totals are only consistent once the object is idle.
+    ::memset(pStatistics, 0, sizeof(*pStatistics));
+    pStatistics->Name = MethodNames[index];
+    for (uint32_t i = 0; i < ShardCount; ++i)
+    {
+        Counters const& counters = _shards[i].Methods[index];
+        pStatistics->CallCount += counters.CallCount.load(std::memory_order_relaxed);
+        pStatistics->BlockedCount += counters.BlockedCount.load(std::memory_order_relaxed);
+        pStatistics->LockWaitNanoseconds += counters.LockWaitNanoseconds.load(std::memory_order_relaxed);
+        pStatistics->LockHoldNanoseconds += counters.LockHoldNanoseconds.load(std::memory_order_relaxed);
+        for (uint32_t j = 0; j < DNMD_STATISTICS_HISTOGRAM_BUCKETS; ++j)
+        {
+            pStatistics->LockWaitHistogram[j] += counters.LockWaitHistogram[j].load(std::memory_order_relaxed);
+            pStatistics->LockHoldHistogram[j] += counters.LockHoldHistogram[j].load(std::memory_order_relaxed);
+        }
+    }
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE ThreadSafeStatistics::ResetStatistics()
+{
+    for (uint32_t i = 0; i < ShardCount; ++i)
+    {
+        for (Counters& counters : _shards[i].Methods)
+        {
+            counters.CallCount.store(0, std::memory_order_relaxed);
+            counters.BlockedCount.store(0, std::memory_order_relaxed);
+            counters.LockWaitNanoseconds.store(0, std::memory_order_relaxed);
+            counters.LockHoldNanoseconds.store(0, std::memory_order_relaxed);
+            for (uint32_t j = 0; j < DNMD_STATISTICS_HISTOGRAM_BUCKETS; ++j)
+            {
+                counters.LockWaitHistogram[j].store(0, std::memory_order_relaxed);
+                counters.LockHoldHistogram[j].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+    return S_OK;
+}
+
+HRESULT DumpStatistics(
+    IUnknown* pMetaData,
+    FILE* stream)
+{
+    if (pMetaData == nullptr || stream == nullptr)
+        return E_INVALIDARG;
+
+    dncp::com_ptr<IDNMDStatistics> statistics;
+    HRESULT hr = pMetaData->QueryInterface(IID_IDNMDStatistics, (void**)&statistics);
+    if (FAILED(hr))
+        return hr;
+
+    if (::fprintf(stream, "Method,CallCount,BlockedCount,LockWaitNanoseconds,LockHoldNanoseconds") < 0)
+        return E_FAIL;
+
+    for (uint32_t j = 0; j < DNMD_STATISTICS_HISTOGRAM_BUCKETS; ++j)
+    {
+        if (::fprintf(stream, ",LockWait%" PRIu32, j) < 0)
+            return E_FAIL;
+    }
+
+    for (uint32_t j = 0; j < DNMD_STATISTICS_HISTOGRAM_BUCKETS; ++j)
+    {
+        if (::fprintf(stream, ",LockHold%" PRIu32, j) < 0)
+            return E_FAIL;
+    }
+
+    if (::fprintf(stream, "\n") < 0)
+        return E_FAIL;
+
+    ULONG count = statistics->GetMethodCount();
+    for (ULONG i = 0; i < count; ++i)
+    {
+        DNMDMethodStatistics methodStatistics;
+        hr = statistics->GetMethodStatistics(i, &methodStatistics);
+        if (FAILED(hr))
+            return hr;
+
+        // Skip methods that haven't been called to keep the output readable.
+        if (methodStatistics.CallCount == 0)
+            continue;
+
+        if (::fprintf(stream, "%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64,
+            methodStatistics.Name,
+            methodStatistics.CallCount,
+            methodStatistics.BlockedCount,
+            methodStatistics.LockWaitNanoseconds,
+            methodStatistics.LockHoldNanoseconds) < 0)
+        {
+            return E_FAIL;
+        }
+
+        for (uint32_t j = 0; j < DNMD_STATISTICS_HISTOGRAM_BUCKETS; ++j)
+        {
+            if (::fprintf(stream, ",%" PRIu64, methodStatistics.LockWaitHistogram[j]) < 0)
+                return E_FAIL;
+        }
+
+        for (uint32_t j = 0; j < DNMD_STATISTICS_HISTOGRAM_BUCKETS; ++j)
+        {
+            if (::fprintf(stream, ",%" PRIu64, methodStatistics.LockHoldHistogram[j]) < 0)
+                return E_FAIL;
+        }
+
+        if (::fprintf(stream, "\n") < 0)
+            return E_FAIL;
+    }
+    return S_OK;
+}
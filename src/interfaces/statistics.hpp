@@ -0,0 +1,228 @@
+#ifndef _SRC_INTERFACES_STATISTICS_HPP_
+#define _SRC_INTERFACES_STATISTICS_HPP_
+
+#include "internal/dnmd_platform.hpp"
+#include "dnmd_interfaces.hpp"
+#include "tearoffbase.hpp"
+
+#include <external/cor.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+// The interface methods that statistics are collected for.
+#define DNMD_THREADSAFE_METHODS(X) \
+    X(CloseEnum) \
+    X(CountEnum) \
+    X(ResetEnum) \
+    X(EnumTypeDefs) \
+    X(EnumInterfaceImpls) \
+    X(EnumTypeRefs) \
+    X(FindTypeDefByName) \
+    X(GetScopeProps) \
+    X(GetModuleFromScope) \
+    X(GetTypeDefProps) \
+    X(GetInterfaceImplProps) \
+    X(GetTypeRefProps) \
+    X(ResolveTypeRef) \
+    X(EnumMembers) \
+    X(EnumMembersWithName) \
+    X(EnumMethods) \
+    X(EnumMethodsWithName) \
+    X(EnumFields) \
+    X(EnumFieldsWithName) \
+    X(EnumParams) \
+    X(EnumMemberRefs) \
+    X(EnumMethodImpls) \
+    X(EnumPermissionSets) \
+    X(FindMember) \
+    X(FindMethod) \
+    X(FindField) \
+    X(FindMemberRef) \
+    X(GetMethodProps) \
+    X(GetMemberRefProps) \
+    X(EnumProperties) \
+    X(EnumEvents) \
+    X(GetEventProps) \
+    X(EnumMethodSemantics) \
+    X(GetMethodSemantics) \
+    X(GetClassLayout) \
+    X(GetFieldMarshal) \
+    X(GetRVA) \
+    X(GetPermissionSetProps) \
+    X(GetSigFromToken) \
+    X(GetModuleRefProps) \
+    X(EnumModuleRefs) \
+    X(GetTypeSpecFromToken) \
+    X(GetNameFromToken) \
+    X(EnumUnresolvedMethods) \
+    X(GetUserString) \
+    X(GetPinvokeMap) \
+    X(EnumSignatures) \
+    X(EnumTypeSpecs) \
+    X(EnumUserStrings) \
+    X(GetParamForMethodIndex) \
+    X(EnumCustomAttributes) \
+    X(GetCustomAttributeProps) \
+    X(FindTypeRef) \
+    X(GetMemberProps) \
+    X(GetFieldProps) \
+    X(GetPropertyProps) \
+    X(GetParamProps) \
+    X(GetCustomAttributeByName) \
+    X(IsValidToken) \
+    X(GetNestedClassProps) \
+    X(GetNativeCallConvFromSig) \
+    X(IsGlobal) \
+    X(EnumGenericParams) \
+    X(GetGenericParamProps) \
+    X(GetMethodSpecProps) \
+    X(EnumGenericParamConstraints) \
+    X(GetGenericParamConstraintProps) \
+    X(GetPEKind) \
+    X(GetVersionString) \
+    X(EnumMethodSpecs) \
+    X(GetAssemblyProps) \
+    X(GetAssemblyRefProps) \
+    X(GetFileProps) \
+    X(GetExportedTypeProps) \
+    X(GetManifestResourceProps) \
+    X(EnumAssemblyRefs) \
+    X(EnumFiles) \
+    X(EnumExportedTypes) \
+    X(EnumManifestResources) \
+    X(GetAssemblyFromScope) \
+    X(FindExportedTypeByName) \
+    X(FindManifestResourceByName) \
+    X(FindAssembliesByName) \
+    X(SetModuleProps) \
+    X(Save) \
+    X(SaveToStream) \
+    X(GetSaveSize) \
+    X(DefineTypeDef) \
+    X(DefineNestedType) \
+    X(SetHandler) \
+    X(DefineMethod) \
+    X(DefineMethodImpl) \
+    X(DefineTypeRefByName) \
+    X(DefineImportType) \
+    X(DefineMemberRef) \
+    X(DefineEvent) \
+    X(SetClassLayout) \
+    X(DeleteClassLayout) \
+    X(SetFieldMarshal) \
+    X(DeleteFieldMarshal) \
+    X(DefinePermissionSet) \
+    X(SetRVA) \
+    X(GetTokenFromSig) \
+    X(DefineModuleRef) \
+    X(SetParent) \
+    X(GetTokenFromTypeSpec) \
+    X(SaveToMemory) \
+    X(DefineUserString) \
+    X(DeleteToken) \
+    X(SetMethodProps) \
+    X(SetTypeDefProps) \
+    X(SetEventProps) \
+    X(SetPermissionSetProps) \
+    X(DefinePinvokeMap) \
+    X(SetPinvokeMap) \
+    X(DeletePinvokeMap) \
+    X(DefineCustomAttribute) \
+    X(SetCustomAttributeValue) \
+    X(DefineField) \
+    X(DefineProperty) \
+    X(DefineParam) \
+    X(SetFieldProps) \
+    X(SetPropertyProps) \
+    X(SetParamProps) \
+    X(DefineSecurityAttributeSet) \
+    X(ApplyEditAndContinue) \
+    X(TranslateSigWithScope) \
+    X(SetMethodImplFlags) \
+    X(SetFieldRVA) \
+    X(Merge) \
+    X(MergeEnd) \
+    X(DefineMethodSpec) \
+    X(GetDeltaSaveSize) \
+    X(SaveDelta) \
+    X(SaveDeltaToStream) \
+    X(SaveDeltaToMemory) \
+    X(DefineGenericParam) \
+    X(SetGenericParamProps) \
+    X(ResetENCLog) \
+    X(DefineAssembly) \
+    X(DefineAssemblyRef) \
+    X(DefineFile) \
+    X(DefineExportedType) \
+    X(DefineManifestResource) \
+    X(SetAssemblyProps) \
+    X(SetAssemblyRefProps) \
+    X(SetFileProps) \
+    X(SetExportedTypeProps) \
+    X(SetManifestResourceProps)
+
+enum class ThreadSafeMethod : uint32_t
+{
+#define DEFINE_METHOD_ID(name) name,
+    DNMD_THREADSAFE_METHODS(DEFINE_METHOD_ID)
+#undef DEFINE_METHOD_ID
+    Count
+};
+
+// Per-method call counts and lock timings for a thread-safe object.
+// Threads record into one of a fixed set of shards so that
+// concurrent calls rarely update the same counters.
+class ThreadSafeStatistics final : public TearOffBase<IDNMDStatistics>
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    struct Counters final
+    {
+        std::atomic<uint64_t> CallCount;
+        std::atomic<uint64_t> BlockedCount;
+        std::atomic<uint64_t> LockWaitNanoseconds;
+        std::atomic<uint64_t> LockHoldNanoseconds;
+        std::atomic<uint64_t> LockWaitHistogram[DNMD_STATISTICS_HISTOGRAM_BUCKETS];
+        std::atomic<uint64_t> LockHoldHistogram[DNMD_STATISTICS_HISTOGRAM_BUCKETS];
+    };
+
+    struct Shard final
+    {
+        Counters Methods[(uint32_t)ThreadSafeMethod::Count];
+    };
+
+    std::unique_ptr<Shard[]> _shards;
+
+protected:
+    virtual bool TryGetInterfaceOnThis(REFIID riid, void** ppvObject) override
+    {
+        assert(riid != IID_IUnknown);
+        if (riid == IID_IDNMDStatistics)
+        {
+            *ppvObject = static_cast<IDNMDStatistics*>(this);
+            return true;
+        }
+        return false;
+    }
+
+public:
+    ThreadSafeStatistics(IUnknown* controllingUnknown);
+
+    virtual ~ThreadSafeStatistics() = default;
+
+    void Record(ThreadSafeMethod method, bool blocked, Clock::duration wait, Clock::duration hold) noexcept;
+
+public: // IDNMDStatistics
+    STDMETHOD_(ULONG, GetMethodCount)() override;
+
+    STDMETHOD(GetMethodStatistics)(ULONG index, DNMDMethodStatistics* pStatistics) override;
+
+    STDMETHOD(ResetStatistics)() override;
+};
+
+#endif // !_SRC_INTERFACES_STATISTICS_HPP_
\ No newline at end of file
@@ -8,6 +8,7 @@
 
 #include <internal/dnmd_platform.hpp>
 #include "dnmd_interfaces.hpp"
+#include "symreader.hpp"
 
 #include <external/cor.h>
 #include <external/corhdr.h>
@@ -19,6 +20,39 @@ namespace
 {
     class SymUnmanagedBinderStateless final : ISymUnmanagedBinder
     {
+        static HRESULT CreateReader(
+            IUnknown* importer,
+            WCHAR const* fileName,
+            WCHAR const* searchPath,
+            IStream* stream,
+            ISymUnmanagedReader** pRetVal)
+        {
+            if (pRetVal == nullptr)
+                return E_POINTER;
+
+            *pRetVal = nullptr;
+            if (fileName == nullptr && stream == nullptr)
+                return E_INVALIDARG;
+
+            dncp::com_ptr<ControllingIUnknown> obj;
+            SymReader* reader;
+            try
+            {
+                obj.Attach(new ControllingIUnknown());
+                reader = obj->CreateAndAddTearOff<SymReader>();
+            }
+            catch (std::bad_alloc const&)
+            {
+                return E_OUTOFMEMORY;
+            }
+
+            HRESULT hr = reader->Initialize(importer, fileName, searchPath, stream);
+            if (FAILED(hr))
+                return hr;
+
+            return obj->QueryInterface(IID_ISymUnmanagedReader, (void**)pRetVal);
+        }
+
     public: // ISymUnmanagedBinder
         STDMETHOD(GetReaderForFile)(
             /* [in] */ __RPC__in_opt IUnknown *importer,
@@ -26,11 +60,7 @@ namespace
             /* [in] */ __RPC__in WCHAR const *searchPath,
             /* [retval][out] */ __RPC__deref_out_opt ISymUnmanagedReader **pRetVal)
         {
-            UNREFERENCED_PARAMETER(importer);
-            UNREFERENCED_PARAMETER(fileName);
-            UNREFERENCED_PARAMETER(searchPath);
-            UNREFERENCED_PARAMETER(pRetVal);
-            return E_NOTIMPL;
+            return CreateReader(importer, fileName, searchPath, nullptr, pRetVal);
         }
 
         STDMETHOD(GetReaderFromStream)(
@@ -38,10 +68,7 @@ namespace
             /* [in] */ __RPC__in_opt IStream *pstream,
             /* [retval][out] */ __RPC__deref_out_opt ISymUnmanagedReader **pRetVal)
         {
-            UNREFERENCED_PARAMETER(importer);
-            UNREFERENCED_PARAMETER(pstream);
-            UNREFERENCED_PARAMETER(pRetVal);
-            return E_NOTIMPL;
+            return CreateReader(importer, nullptr, nullptr, pstream, pRetVal);
         }
 
     public: // IUnknown
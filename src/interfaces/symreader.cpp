@@ -0,0 +1,1721 @@
+#include "symreader.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#define RETURN_IF_FAILED(exp) \
+{ \
+    hr = (exp); \
+    if (FAILED(hr)) \
+    { \
+        return hr; \
+    } \
+}
+
+namespace
+{
+    static_assert(sizeof(GUID) == sizeof(mdguid_t), "Metadata GUIDs are returned as COM GUIDs");
+
+    // Portable PDB tables don't have token types in cor.h.
+    mdToken PdbToken(mdtable_id_t table_id, uint32_t rid)
+    {
+        return TokenFromRid(rid, (mdToken)table_id << 24);
+    }
+
+    template<typename T, typename I, typename... Ts>
+    HRESULT CreateSymObject(I** ppObj, Ts&&... args)
+    {
+        dncp::com_ptr<ControllingIUnknown> obj;
+        obj.Attach(new (std::nothrow) ControllingIUnknown());
+        if (obj == nullptr)
+            return E_OUTOFMEMORY;
+
+        try
+        {
+            *ppObj = obj->CreateAndAddTearOff<T>(std::forward<Ts>(args)...);
+        }
+        catch (std::bad_alloc const&)
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        // The caller takes the reference of the new object.
+        (void)obj.Detach();
+        return S_OK;
+    }
+
+    // Release the objects written to an output array before a failure.
+    template<typename I>
+    void ReleaseObjects(I* objects[], ULONG32 count)
+    {
+        for (ULONG32 i = 0; i < count; ++i)
+        {
+            objects[i]->Release();
+            objects[i] = nullptr;
+        }
+    }
+
+    // The needed length includes the null terminator. Strings that don't fit are truncated.
+    HRESULT ReturnStringOutput(
+        char const* str,
+        ULONG32 cchBuffer,
+        ULONG32* pcchBuffer,
+        WCHAR* szBuffer)
+    {
+        if (szBuffer == nullptr)
+            cchBuffer = 0;
+
+        uint32_t needed;
+        HRESULT hr = pal::ConvertUtf8ToUtf16(str, szBuffer, cchBuffer, &needed);
+        if (hr == E_NOT_SUFFICIENT_BUFFER)
+        {
+            szBuffer[cchBuffer - 1] = W('\0');
+            hr = CLDB_S_TRUNCATION;
+        }
+        else if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        if (pcchBuffer != nullptr)
+            *pcchBuffer = needed;
+        return hr;
+    }
+
+    HRESULT ReturnBlobOutput(
+        uint8_t const* blob,
+        uint32_t blobLength,
+        ULONG32 cBuffer,
+        ULONG32* pcBuffer,
+        BYTE* buffer)
+    {
+        if (pcBuffer == nullptr)
+            return E_INVALIDARG;
+
+        *pcBuffer = blobLength;
+        if (buffer == nullptr || cBuffer == 0)
+            return S_OK;
+
+        if (cBuffer < blobLength)
+        {
+            ::memcpy(buffer, blob, cBuffer);
+            return CLDB_S_TRUNCATION;
+        }
+
+        ::memcpy(buffer, blob, blobLength);
+        return S_OK;
+    }
+
+    // Find the Document row of a document handed out by a reader of the same PDB.
+    HRESULT GetDocumentCursor(mdhandle_t handle, ISymUnmanagedDocument* document, mdcursor_t* cursor)
+    {
+        if (document == nullptr)
+            return E_INVALIDARG;
+
+        HRESULT hr;
+        dncp::com_ptr<IDNMDSymDocument> symDocument{};
+        RETURN_IF_FAILED(document->QueryInterface(IID_IDNMDSymDocument, (void**)&symDocument));
+        if (symDocument->MetaData() != handle)
+            return E_INVALIDARG;
+
+        *cursor = symDocument->Document();
+        return S_OK;
+    }
+
+    // Prepare to read the sequence points of a method.
+    // A method without sequence points has an empty blob, from which a zeroed reader reads nothing.
+    HRESULT InitSequencePointReader(mdhandle_t handle, mdMethodDef method, md_sequence_point_reader_t* reader)
+    {
+        mdcursor_t debugInformation;
+        if (!md_token_to_cursor(handle, PdbToken(mdtid_MethodDebugInformation, RidFromToken(method)), &debugInformation))
+            return E_INVALIDARG;
+
+        uint8_t const* blob;
+        uint32_t blobLength;
+        if (1 != md_get_column_value_as_blob(debugInformation, mdtMethodDebugInformation_SequencePoints, 1, &blob, &blobLength))
+            return CLDB_E_FILE_CORRUPT;
+
+        if (blobLength == 0)
+        {
+            ::memset(reader, 0, sizeof(*reader));
+            return S_OK;
+        }
+
+        return md_init_sequence_point_reader(debugInformation, blob, blobLength, reader) == mdbpr_Success
+            ? S_OK
+            : CLDB_E_FILE_CORRUPT;
+    }
+
+    // Read all sequence points of a method in IL offset order.
+    HRESULT ReadSequencePoints(mdhandle_t handle, mdMethodDef method, std::vector<md_sequence_point_t>& points)
+    {
+        HRESULT hr;
+        md_sequence_point_reader_t reader;
+        RETURN_IF_FAILED(InitSequencePointReader(handle, method, &reader));
+
+        md_sequence_point_t point;
+        while (md_read_sequence_point(&reader, &point))
+            points.push_back(point);
+
+        return reader.invalid ? CLDB_E_FILE_CORRUPT : S_OK;
+    }
+
+    bool IsInDocument(md_sequence_point_t const& point, mdToken document)
+    {
+        mdToken pointDocument;
+        return !point.hidden
+            && md_cursor_to_token(point.document, &pointDocument)
+            && pointDocument == document;
+    }
+
+    // The LocalScope rows of a method are contiguous and ordered by start offset, then outermost first.
+    bool IsScopeOfMethod(mdcursor_t scope, mdMethodDef method)
+    {
+        mdToken scopeMethod;
+        return 1 == md_get_column_value_as_token(scope, mdtLocalScope_Method, 1, &scopeMethod)
+            && scopeMethod == method;
+    }
+
+    HRESULT GetScopeRange(mdcursor_t scope, uint32_t* startOffset, uint32_t* endOffset)
+    {
+        uint32_t length;
+        if (1 != md_get_column_value_as_constant(scope, mdtLocalScope_StartOffset, 1, startOffset)
+            || 1 != md_get_column_value_as_constant(scope, mdtLocalScope_Length, 1, &length)
+            || length > UINT32_MAX - *startOffset)
+        {
+            return CLDB_E_FILE_CORRUPT;
+        }
+
+        *endOffset = *startOffset + length;
+        return S_OK;
+    }
+
+    template<typename T>
+    bool TryReadValue(uint8_t const* value, size_t valueLength, T& result)
+    {
+        if (valueLength != sizeof(T))
+            return false;
+
+        ::memcpy(&result, value, sizeof(T));
+        return true;
+    }
+
+    // Values of primitive and enum constants - see the LocalConstantSig blob in the Portable PDB spec.
+    HRESULT ReadConstantValue(uint8_t typeCode, uint8_t const* value, size_t valueLength, VARIANT* pValue)
+    {
+        bool read;
+        switch (typeCode)
+        {
+        case ELEMENT_TYPE_BOOLEAN:
+        {
+            uint8_t b;
+            read = TryReadValue(value, valueLength, b);
+            V_VT(pValue) = VT_BOOL;
+            V_BOOL(pValue) = b != 0 ? VARIANT_TRUE : VARIANT_FALSE;
+            break;
+        }
+        case ELEMENT_TYPE_CHAR:
+        case ELEMENT_TYPE_U2:
+            V_VT(pValue) = VT_UI2;
+            read = TryReadValue(value, valueLength, V_UI2(pValue));
+            break;
+        case ELEMENT_TYPE_I1:
+            V_VT(pValue) = VT_I1;
+            read = TryReadValue(value, valueLength, V_I1(pValue));
+            break;
+        case ELEMENT_TYPE_U1:
+            V_VT(pValue) = VT_UI1;
+            read = TryReadValue(value, valueLength, V_UI1(pValue));
+            break;
+        case ELEMENT_TYPE_I2:
+            V_VT(pValue) = VT_I2;
+            read = TryReadValue(value, valueLength, V_I2(pValue));
+            break;
+        case ELEMENT_TYPE_I4:
+            V_VT(pValue) = VT_I4;
+            read = TryReadValue(value, valueLength, V_I4(pValue));
+            break;
+        case ELEMENT_TYPE_U4:
+            V_VT(pValue) = VT_UI4;
+            read = TryReadValue(value, valueLength, V_UI4(pValue));
+            break;
+        case ELEMENT_TYPE_I8:
+            V_VT(pValue) = VT_I8;
+            read = TryReadValue(value, valueLength, V_I8(pValue));
+            break;
+        case ELEMENT_TYPE_U8:
+            V_VT(pValue) = VT_UI8;
+            read = TryReadValue(value, valueLength, V_UI8(pValue));
+            break;
+        case ELEMENT_TYPE_R4:
+            V_VT(pValue) = VT_R4;
+            read = TryReadValue(value, valueLength, V_R4(pValue));
+            break;
+        case ELEMENT_TYPE_R8:
+            V_VT(pValue) = VT_R8;
+            read = TryReadValue(value, valueLength, V_R8(pValue));
+            break;
+        case ELEMENT_TYPE_STRING:
+        {
+            // A null string is stored as a single 0xff byte, otherwise the value is UTF-16.
+            if (valueLength == 1 && value[0] == 0xff)
+            {
+                V_VT(pValue) = VT_NULL;
+                return S_OK;
+            }
+
+            if (valueLength % sizeof(WCHAR) != 0)
+                return CLDB_E_FILE_CORRUPT;
+
+            // The value may not be aligned, so copy it into the string.
+            BSTR str = ::SysAllocStringLen(nullptr, (UINT)(valueLength / sizeof(WCHAR)));
+            if (str == nullptr)
+                return E_OUTOFMEMORY;
+
+            ::memcpy(str, value, valueLength);
+            V_VT(pValue) = VT_BSTR;
+            V_BSTR(pValue) = str;
+            return S_OK;
+        }
+        default:
+            return CLDB_E_FILE_CORRUPT;
+        }
+
+        if (!read)
+        {
+            V_VT(pValue) = VT_EMPTY;
+            return CLDB_E_FILE_CORRUPT;
+        }
+        return S_OK;
+    }
+
+    // Only System.Decimal and System.DateTime constants have a GeneralValue - see the LocalConstantSig blob in the Portable PDB spec.
+    // Their types are in the module's metadata, which the reader doesn't have, but their values have different sizes.
+    HRESULT ReadGeneralConstantValue(md_local_constant_sig_t const& signature, VARIANT* pValue)
+    {
+        uint8_t const* value = signature.value_blob;
+        size_t valueLength = signature.value_len;
+        if (signature.general.kind != decltype(signature.general)::mdgc_ValueType)
+        {
+            // Constants of reference types are null.
+            if (valueLength != 0)
+                return CLDB_E_FILE_CORRUPT;
+
+            V_VT(pValue) = VT_NULL;
+            return S_OK;
+        }
+
+        // The sign is the highest bit of the first byte and the scale is the other bits,
+        // followed by the low, middle and high 32 bits of the 96-bit integer.
+        uint8_t signAndScale;
+        uint32_t parts[3];
+        if (valueLength == sizeof(signAndScale) + sizeof(parts))
+        {
+            signAndScale = value[0];
+            ::memcpy(parts, value + 1, sizeof(parts));
+            uint8_t scale = signAndScale & 0x7f;
+            if (scale > 28)
+                return CLDB_E_FILE_CORRUPT;
+
+            // The DECIMAL overlaps the VARIANT's type, so it is set first.
+            DECIMAL decimal = {};
+            decimal.scale = scale;
+            decimal.sign = (signAndScale & 0x80) != 0 ? DECIMAL_NEG : 0;
+            decimal.Lo32 = parts[0];
+            decimal.Mid32 = parts[1];
+            decimal.Hi32 = parts[2];
+            V_DECIMAL(pValue) = decimal;
+            V_VT(pValue) = VT_DECIMAL;
+            return S_OK;
+        }
+
+        // The ticks of the DateTime, which is converted to an OLE Automation date as DateTime.ToOADate does.
+        int64_t ticks;
+        if (TryReadValue(value, valueLength, ticks))
+        {
+            int64_t const TicksPerMillisecond = 10000;
+            int64_t const TicksPerDay = TicksPerMillisecond * 1000 * 60 * 60 * 24;
+            int64_t const MillisPerDay = TicksPerDay / TicksPerMillisecond;
+            // The ticks of 1899-12-30, which is day 0 of OLE Automation dates, and of 0100-01-01, the earliest date they can represent.
+            int64_t const OADateEpochTicks = 599264352000000000;
+            int64_t const OADateMinTicks = 31241376000000000;
+            if (ticks < 0)
+                return CLDB_E_FILE_CORRUPT;
+
+            double date = 0;
+            if (ticks != 0)
+            {
+                // Times without a date are on day 0.
+                if (ticks < TicksPerDay)
+                    ticks += OADateEpochTicks;
+                if (ticks < OADateMinTicks)
+                    return E_NOTIMPL;
+
+                // Before day 0, the days are negative but the time of day is still positive.
+                int64_t millis = (ticks - OADateEpochTicks) / TicksPerMillisecond;
+                if (millis < 0)
+                {
+                    int64_t timeOfDay = millis % MillisPerDay;
+                    if (timeOfDay != 0)
+                        millis -= (MillisPerDay + timeOfDay) * 2;
+                }
+                date = (double)millis / MillisPerDay;
+            }
+
+            V_VT(pValue) = VT_DATE;
+            V_DATE(pValue) = date;
+            return S_OK;
+        }
+
+        // Other value types have no value that can be represented.
+        return valueLength == 0 ? E_NOTIMPL : CLDB_E_FILE_CORRUPT;
+    }
+}
+
+HRESULT PortablePdb::OpenFile(WCHAR const* fileName, std::shared_ptr<PortablePdb>& pdb)
+{
+    if (fileName == nullptr)
+        return E_INVALIDARG;
+
+    // Binders are usually given the path of the module, so look for the PDB next to it.
+    std::basic_string<WCHAR> path{ fileName };
+    size_t separator = path.find_last_of(W("/\\"));
+    size_t extension = path.find_last_of(W('.'));
+    if (extension == std::basic_string<WCHAR>::npos
+        || (separator != std::basic_string<WCHAR>::npos && extension < separator))
+    {
+        extension = path.size();
+    }
+
+    WCHAR const pdbExtension[] = W(".pdb");
+    bool isPdb = path.size() - extension == ARRAY_SIZE(pdbExtension) - 1;
+    for (size_t i = 0; isPdb && i < ARRAY_SIZE(pdbExtension) - 1; ++i)
+    {
+        WCHAR c = path[extension + i];
+        isPdb = (c >= W('A') && c <= W('Z') ? c - W('A') + W('a') : c) == pdbExtension[i];
+    }
+
+    if (!isPdb)
+    {
+        path.resize(extension);
+        path.append(pdbExtension);
+    }
+
+    HRESULT hr;
+    std::unique_ptr<pal::MappedFile> file;
+    RETURN_IF_FAILED(pal::MappedFile::Open(path.c_str(), file));
+
+    mdhandle_t handle;
+    mdToken entryPoint;
+    if (!md_create_handle(file->Data(), file->Size(), &handle))
+        return CLDB_E_FILE_CORRUPT;
+
+    mdhandle_ptr md_ptr{ handle };
+    if (!md_get_pdb_entry_point(handle, &entryPoint))
+        return CLDB_E_FILE_CORRUPT;
+
+    pdb.reset(new (std::nothrow) PortablePdb{ std::move(file), nullptr, std::move(md_ptr), std::move(path) });
+    return pdb != nullptr ? S_OK : E_OUTOFMEMORY;
+}
+
+HRESULT PortablePdb::OpenStream(IStream* stream, std::shared_ptr<PortablePdb>& pdb)
+{
+    if (stream == nullptr)
+        return E_INVALIDARG;
+
+    // The size of the stream isn't known, so read it in chunks until it ends.
+    size_t capacity = 64 * 1024;
+    size_t size = 0;
+    malloc_ptr<void> data{ ::malloc(capacity) };
+    if (data == nullptr)
+        return E_OUTOFMEMORY;
+
+    for (;;)
+    {
+        if (size == capacity)
+        {
+            void* grown = ::realloc(data.get(), capacity * 2);
+            if (grown == nullptr)
+                return E_OUTOFMEMORY;
+
+            (void)data.release();
+            data.reset(grown);
+            capacity *= 2;
+        }
+
+        ULONG read = 0;
+        ULONG toRead = (ULONG)std::min<size_t>(capacity - size, UINT32_MAX);
+        HRESULT hr = stream->Read((uint8_t*)data.get() + size, toRead, &read);
+        if (FAILED(hr))
+            return hr;
+
+        size += read;
+        if (hr == S_FALSE || read == 0)
+            break;
+    }
+
+    mdhandle_t handle;
+    mdToken entryPoint;
+    if (!md_create_handle(data.get(), size, &handle))
+        return CLDB_E_FILE_CORRUPT;
+
+    mdhandle_ptr md_ptr{ handle };
+    if (!md_get_pdb_entry_point(handle, &entryPoint))
+        return CLDB_E_FILE_CORRUPT;
+
+    pdb.reset(new (std::nothrow) PortablePdb{ nullptr, std::move(data), std::move(md_ptr), {} });
+    return pdb != nullptr ? S_OK : E_OUTOFMEMORY;
+}
+
+HRESULT SymReader::GetDocument(
+    WCHAR* url,
+    GUID language,
+    GUID languageVendor,
+    GUID documentType,
+    ISymUnmanagedDocument** pRetVal)
+{
+    // Portable PDBs only have one document per path, so the other properties aren't needed.
+    UNREFERENCED_PARAMETER(language);
+    UNREFERENCED_PARAMETER(languageVendor);
+    UNREFERENCED_PARAMETER(documentType);
+
+    if (_pdb == nullptr)
+        return E_UNEXPECTED;
+
+    if (url == nullptr || pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    *pRetVal = nullptr;
+    pal::StringConvert<WCHAR, char> cvt{ url };
+    if (!cvt.Success())
+        return E_INVALIDARG;
+
+    mdcursor_t document;
+    if (!md_find_document(_pdb->MetaData(), cvt, false, &document))
+        return S_FALSE;
+
+    return CreateSymObject<SymDocument>(pRetVal, _pdb, document);
+}
+
+HRESULT SymReader::GetDocuments(
+    ULONG32 cDocs,
+    ULONG32* pcDocs,
+    ISymUnmanagedDocument* pDocs[])
+{
+    if (_pdb == nullptr)
+        return E_UNEXPECTED;
+
+    if (pcDocs == nullptr)
+        return E_INVALIDARG;
+
+    mdcursor_t document;
+    uint32_t count;
+    if (!md_create_cursor(_pdb->MetaData(), mdtid_Document, &document, &count))
+        count = 0;
+
+    if (pDocs == nullptr || cDocs == 0)
+    {
+        *pcDocs = count;
+        return S_OK;
+    }
+
+    HRESULT hr;
+    ULONG32 written = 0;
+    for (; written < count && written < cDocs; ++written, (void)md_cursor_next(&document))
+    {
+        hr = CreateSymObject<SymDocument>(&pDocs[written], _pdb, document);
+        if (FAILED(hr))
+        {
+            ReleaseObjects(pDocs, written);
+            return hr;
+        }
+    }
+
+    *pcDocs = written;
+    return S_OK;
+}
+
+HRESULT SymReader::GetUserEntryPoint(
+    mdMethodDef* pToken)
+{
+    if (_pdb == nullptr)
+        return E_UNEXPECTED;
+
+    if (pToken == nullptr)
+        return E_INVALIDARG;
+
+    mdToken entryPoint;
+    if (!md_get_pdb_entry_point(_pdb->MetaData(), &entryPoint))
+        return CLDB_E_FILE_CORRUPT;
+
+    if (RidFromToken(entryPoint) == 0)
+        return E_FAIL;
+
+    *pToken = entryPoint;
+    return S_OK;
+}
+
+HRESULT SymReader::GetMethod(
+    mdMethodDef token,
+    ISymUnmanagedMethod** pRetVal)
+{
+    if (_pdb == nullptr)
+        return E_UNEXPECTED;
+
+    if (pRetVal == nullptr || TypeFromToken(token) != mdtMethodDef)
+        return E_INVALIDARG;
+
+    *pRetVal = nullptr;
+    mdhandle_t handle = _pdb->MetaData();
+
+    // Methods have symbols if they have sequence points or scopes.
+    mdcursor_t debugInformation;
+    uint8_t const* blob;
+    uint32_t blobLength;
+    if (!md_token_to_cursor(handle, PdbToken(mdtid_MethodDebugInformation, RidFromToken(token)), &debugInformation)
+        || 1 != md_get_column_value_as_blob(debugInformation, mdtMethodDebugInformation_SequencePoints, 1, &blob, &blobLength))
+    {
+        return E_FAIL;
+    }
+
+    if (blobLength == 0)
+    {
+        mdcursor_t scopes;
+        uint32_t scopeCount;
+        mdcursor_t scope;
+        if (!md_create_cursor(handle, mdtid_LocalScope, &scopes, &scopeCount)
+            || md_find_range_from_cursor(scopes, mdtLocalScope_Method, RidFromToken(token), &scope, &scopeCount) != MD_RANGE_FOUND)
+        {
+            return E_FAIL;
+        }
+    }
+
+    return CreateSymObject<SymMethod>(pRetVal, _pdb, token);
+}
+
+HRESULT SymReader::GetMethodByVersion(
+    mdMethodDef token,
+    int version,
+    ISymUnmanagedMethod** pRetVal)
+{
+    // Portable PDBs don't record edits, so there is only the first version.
+    if (version != 1)
+        return E_INVALIDARG;
+
+    return GetMethod(token, pRetVal);
+}
+
+HRESULT SymReader::GetVariables(
+    mdToken parent,
+    ULONG32 cVars,
+    ULONG32* pcVars,
+    ISymUnmanagedVariable* pVars[])
+{
+    UNREFERENCED_PARAMETER(parent);
+    UNREFERENCED_PARAMETER(cVars);
+    UNREFERENCED_PARAMETER(pcVars);
+    UNREFERENCED_PARAMETER(pVars);
+    return E_NOTIMPL;
+}
+
+HRESULT SymReader::GetGlobalVariables(
+    ULONG32 cVars,
+    ULONG32* pcVars,
+    ISymUnmanagedVariable* pVars[])
+{
+    UNREFERENCED_PARAMETER(cVars);
+    UNREFERENCED_PARAMETER(pcVars);
+    UNREFERENCED_PARAMETER(pVars);
+    return E_NOTIMPL;
+}
+
+HRESULT SymReader::GetMethodFromDocumentPosition(
+    ISymUnmanagedDocument* document,
+    ULONG32 line,
+    ULONG32 column,
+    ISymUnmanagedMethod** pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    *pRetVal = nullptr;
+    HRESULT hr;
+    ULONG32 count;
+    RETURN_IF_FAILED(GetMethodsFromDocumentPosition(document, line, column, 1, &count, pRetVal));
+    return count != 0 ? S_OK : E_FAIL;
+}
+
+HRESULT SymReader::GetSymAttribute(
+    mdToken parent,
+    WCHAR* name,
+    ULONG32 cBuffer,
+    ULONG32* pcBuffer,
+    BYTE buffer[])
+{
+    UNREFERENCED_PARAMETER(parent);
+    UNREFERENCED_PARAMETER(name);
+    UNREFERENCED_PARAMETER(cBuffer);
+    UNREFERENCED_PARAMETER(pcBuffer);
+    UNREFERENCED_PARAMETER(buffer);
+    return E_NOTIMPL;
+}
+
+HRESULT SymReader::GetNamespaces(
+    ULONG32 cNameSpaces,
+    ULONG32* pcNameSpaces,
+    ISymUnmanagedNamespace* namespaces[])
+{
+    UNREFERENCED_PARAMETER(cNameSpaces);
+    UNREFERENCED_PARAMETER(pcNameSpaces);
+    UNREFERENCED_PARAMETER(namespaces);
+    return E_NOTIMPL;
+}
+
+HRESULT SymReader::Initialize(
+    IUnknown* importer,
+    WCHAR const* filename,
+    WCHAR const* searchPath,
+    IStream* pIStream)
+{
+    // The PDB is found next to the module, so the importer and search path aren't needed.
+    UNREFERENCED_PARAMETER(importer);
+    UNREFERENCED_PARAMETER(searchPath);
+
+    if (_pdb != nullptr)
+        return E_UNEXPECTED;
+
+    if (pIStream != nullptr)
+        return PortablePdb::OpenStream(pIStream, _pdb);
+
+    return PortablePdb::OpenFile(filename, _pdb);
+}
+
+HRESULT SymReader::UpdateSymbolStore(
+    WCHAR const* filename,
+    IStream* pIStream)
+{
+    UNREFERENCED_PARAMETER(filename);
+    UNREFERENCED_PARAMETER(pIStream);
+    return E_NOTIMPL;
+}
+
+HRESULT SymReader::ReplaceSymbolStore(
+    WCHAR const* filename,
+    IStream* pIStream)
+{
+    UNREFERENCED_PARAMETER(filename);
+    UNREFERENCED_PARAMETER(pIStream);
+    return E_NOTIMPL;
+}
+
+HRESULT SymReader::GetSymbolStoreFileName(
+    ULONG32 cchName,
+    ULONG32* pcchName,
+    WCHAR szName[])
+{
+    if (_pdb == nullptr)
+        return E_UNEXPECTED;
+
+    if (pcchName == nullptr)
+        return E_INVALIDARG;
+
+    std::basic_string<WCHAR> const& fileName = _pdb->FileName();
+    *pcchName = (ULONG32)fileName.size() + 1;
+    if (szName == nullptr || cchName == 0)
+        return S_OK;
+
+    if (cchName < *pcchName)
+    {
+        ::memcpy(szName, fileName.c_str(), (cchName - 1) * sizeof(WCHAR));
+        szName[cchName - 1] = W('\0');
+        return CLDB_S_TRUNCATION;
+    }
+
+    ::memcpy(szName, fileName.c_str(), *pcchName * sizeof(WCHAR));
+    return S_OK;
+}
+
+HRESULT SymReader::GetMethodsFromDocumentPosition(
+    ISymUnmanagedDocument* document,
+    ULONG32 line,
+    ULONG32 column,
+    ULONG32 cMethod,
+    ULONG32* pcMethod,
+    ISymUnmanagedMethod* pRetVal[])
+{
+    // Methods are found by line only.
+    UNREFERENCED_PARAMETER(column);
+
+    if (_pdb == nullptr)
+        return E_UNEXPECTED;
+
+    if (pcMethod == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    mdhandle_t handle = _pdb->MetaData();
+    mdcursor_t documentCursor;
+    RETURN_IF_FAILED(GetDocumentCursor(handle, document, &documentCursor));
+
+    uint32_t count;
+    if (!md_find_methods_for_document_line(handle, documentCursor, line, nullptr, &count))
+        return CLDB_E_FILE_CORRUPT;
+
+    if (pRetVal == nullptr || cMethod == 0)
+    {
+        *pcMethod = count;
+        return S_OK;
+    }
+
+    std::vector<mdToken> methods(count);
+    if (count != 0 && !md_find_methods_for_document_line(handle, documentCursor, line, methods.data(), &count))
+        return CLDB_E_FILE_CORRUPT;
+
+    ULONG32 written = 0;
+    for (; written < count && written < cMethod; ++written)
+    {
+        hr = CreateSymObject<SymMethod>(&pRetVal[written], _pdb, methods[written]);
+        if (FAILED(hr))
+        {
+            ReleaseObjects(pRetVal, written);
+            return hr;
+        }
+    }
+
+    *pcMethod = written;
+    return S_OK;
+}
+
+HRESULT SymReader::GetDocumentVersion(
+    ISymUnmanagedDocument* pDoc,
+    int* version,
+    BOOL* pbCurrent)
+{
+    if (pDoc == nullptr || version == nullptr || pbCurrent == nullptr)
+        return E_INVALIDARG;
+
+    *version = 1;
+    *pbCurrent = TRUE;
+    return S_OK;
+}
+
+HRESULT SymReader::GetMethodVersion(
+    ISymUnmanagedMethod* pMethod,
+    int* version)
+{
+    if (pMethod == nullptr || version == nullptr)
+        return E_INVALIDARG;
+
+    *version = 1;
+    return S_OK;
+}
+
+HRESULT SymDocument::GetURL(
+    ULONG32 cchUrl,
+    ULONG32* pcchUrl,
+    WCHAR szUrl[])
+{
+    char const* name;
+    if (!md_get_document_name(_document, &name))
+        return CLDB_E_FILE_CORRUPT;
+
+    return ReturnStringOutput(name, cchUrl, pcchUrl, szUrl);
+}
+
+HRESULT SymDocument::GetDocumentType(
+    GUID* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    *pRetVal = CorSym_DocumentType_Text;
+    return S_OK;
+}
+
+HRESULT SymDocument::GetLanguage(
+    GUID* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    mdguid_t language;
+    if (1 != md_get_column_value_as_guid(_document, mdtDocument_Language, 1, &language))
+        return CLDB_E_FILE_CORRUPT;
+
+    ::memcpy(pRetVal, &language, sizeof(*pRetVal));
+    return S_OK;
+}
+
+HRESULT SymDocument::GetLanguageVendor(
+    GUID* pRetVal)
+{
+    HRESULT hr;
+    GUID language;
+    RETURN_IF_FAILED(GetLanguage(&language));
+
+    // Portable PDBs don't record the vendor, so it's derived from the language.
+    if (language == CorSym_LanguageType_CSharp || language == CorSym_LanguageType_Basic)
+        *pRetVal = CorSym_LanguageVendor_Microsoft;
+    else
+        ::memset(pRetVal, 0, sizeof(*pRetVal));
+    return S_OK;
+}
+
+HRESULT SymDocument::GetCheckSumAlgorithmId(
+    GUID* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    mdguid_t algorithm;
+    if (1 != md_get_column_value_as_guid(_document, mdtDocument_HashAlgorithm, 1, &algorithm))
+        return CLDB_E_FILE_CORRUPT;
+
+    ::memcpy(pRetVal, &algorithm, sizeof(*pRetVal));
+    return S_OK;
+}
+
+HRESULT SymDocument::GetCheckSum(
+    ULONG32 cData,
+    ULONG32* pcData,
+    BYTE data[])
+{
+    uint8_t const* hash;
+    uint32_t hashLength;
+    if (1 != md_get_column_value_as_blob(_document, mdtDocument_Hash, 1, &hash, &hashLength))
+        return CLDB_E_FILE_CORRUPT;
+
+    return ReturnBlobOutput(hash, hashLength, cData, pcData, data);
+}
+
+HRESULT SymDocument::FindClosestLine(
+    ULONG32 line,
+    ULONG32* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    mdhandle_t handle = _pdb->MetaData();
+    mdToken document;
+    if (!md_cursor_to_token(_document, &document))
+        return E_UNEXPECTED;
+
+    // The closest line is usually in a method that spans the line, which the document index finds.
+    // If the line isn't in a method, all methods have to be searched.
+    uint32_t count;
+    if (!md_find_methods_for_document_line(handle, _document, line, nullptr, &count))
+        return CLDB_E_FILE_CORRUPT;
+
+    std::vector<mdToken> methods(count);
+    if (count != 0 && !md_find_methods_for_document_line(handle, _document, line, methods.data(), &count))
+        return CLDB_E_FILE_CORRUPT;
+
+    uint32_t methodCount;
+    mdcursor_t debugInformation;
+    if (methods.empty() && md_create_cursor(handle, mdtid_MethodDebugInformation, &debugInformation, &methodCount))
+    {
+        methods.resize(methodCount);
+        for (uint32_t i = 0; i < methodCount; ++i)
+            methods[i] = TokenFromRid(i + 1, mdtMethodDef);
+    }
+
+    ULONG32 closest = UINT32_MAX;
+    std::vector<md_sequence_point_t> points;
+    for (mdToken method : methods)
+    {
+        points.clear();
+        RETURN_IF_FAILED(ReadSequencePoints(handle, method, points));
+        for (md_sequence_point_t const& point : points)
+        {
+            if (IsInDocument(point, document) && point.start_line >= line && point.start_line < closest)
+                closest = point.start_line;
+        }
+    }
+
+    if (closest == UINT32_MAX)
+        return E_FAIL;
+
+    *pRetVal = closest;
+    return S_OK;
+}
+
+HRESULT SymDocument::HasEmbeddedSource(
+    BOOL* pRetVal)
+{
+    UNREFERENCED_PARAMETER(pRetVal);
+    return E_NOTIMPL;
+}
+
+HRESULT SymDocument::GetSourceLength(
+    ULONG32* pRetVal)
+{
+    UNREFERENCED_PARAMETER(pRetVal);
+    return E_NOTIMPL;
+}
+
+HRESULT SymDocument::GetSourceRange(
+    ULONG32 startLine,
+    ULONG32 startColumn,
+    ULONG32 endLine,
+    ULONG32 endColumn,
+    ULONG32 cSourceBytes,
+    ULONG32* pcSourceBytes,
+    BYTE source[])
+{
+    UNREFERENCED_PARAMETER(startLine);
+    UNREFERENCED_PARAMETER(startColumn);
+    UNREFERENCED_PARAMETER(endLine);
+    UNREFERENCED_PARAMETER(endColumn);
+    UNREFERENCED_PARAMETER(cSourceBytes);
+    UNREFERENCED_PARAMETER(pcSourceBytes);
+    UNREFERENCED_PARAMETER(source);
+    return E_NOTIMPL;
+}
+
+HRESULT SymMethod::GetToken(
+    mdMethodDef* pToken)
+{
+    if (pToken == nullptr)
+        return E_INVALIDARG;
+
+    *pToken = _method;
+    return S_OK;
+}
+
+HRESULT SymMethod::GetSequencePointCount(
+    ULONG32* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    md_sequence_point_reader_t reader;
+    RETURN_IF_FAILED(InitSequencePointReader(_pdb->MetaData(), _method, &reader));
+
+    ULONG32 count = 0;
+    md_sequence_point_t point;
+    while (md_read_sequence_point(&reader, &point))
+        count++;
+
+    if (reader.invalid)
+        return CLDB_E_FILE_CORRUPT;
+
+    *pRetVal = count;
+    return S_OK;
+}
+
+HRESULT SymMethod::GetRootScope(
+    ISymUnmanagedScope** pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    *pRetVal = nullptr;
+    mdcursor_t scopes;
+    uint32_t count;
+    mdcursor_t scope;
+    if (!md_create_cursor(_pdb->MetaData(), mdtid_LocalScope, &scopes, &count))
+        return E_FAIL;
+
+    switch (md_find_range_from_cursor(scopes, mdtLocalScope_Method, RidFromToken(_method), &scope, &count))
+    {
+    case MD_RANGE_FOUND:
+        // The outermost scope is first.
+        return CreateSymObject<SymScope>(pRetVal, _pdb, _method, scope);
+    case MD_RANGE_NOT_FOUND:
+        return E_FAIL;
+    default:
+        // The table isn't sorted.
+        return CLDB_E_FILE_CORRUPT;
+    }
+}
+
+HRESULT SymMethod::GetScopeFromOffset(
+    ULONG32 offset,
+    ISymUnmanagedScope** pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    *pRetVal = nullptr;
+    uint32_t count;
+    if (!md_get_local_scopes_at_offset(_pdb->MetaData(), _method, offset, nullptr, &count))
+        return CLDB_E_FILE_CORRUPT;
+
+    if (count == 0)
+        return E_FAIL;
+
+    // The innermost scope is first.
+    std::vector<md_local_scope_t> scopes(count);
+    if (!md_get_local_scopes_at_offset(_pdb->MetaData(), _method, offset, scopes.data(), &count))
+        return CLDB_E_FILE_CORRUPT;
+
+    return CreateSymObject<SymScope>(pRetVal, _pdb, _method, scopes[0].scope);
+}
+
+HRESULT SymMethod::GetOffset(
+    ISymUnmanagedDocument* document,
+    ULONG32 line,
+    ULONG32 column,
+    ULONG32* pRetVal)
+{
+    // Sequence points are found by line only.
+    UNREFERENCED_PARAMETER(column);
+
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    mdhandle_t handle = _pdb->MetaData();
+    mdcursor_t documentCursor;
+    mdToken documentToken;
+    RETURN_IF_FAILED(GetDocumentCursor(handle, document, &documentCursor));
+    if (!md_cursor_to_token(documentCursor, &documentToken))
+        return E_INVALIDARG;
+
+    md_sequence_point_reader_t reader;
+    RETURN_IF_FAILED(InitSequencePointReader(handle, _method, &reader));
+
+    // The points are in IL offset order, so the first that spans the line has the lowest offset.
+    md_sequence_point_t point;
+    while (md_read_sequence_point(&reader, &point))
+    {
+        if (IsInDocument(point, documentToken) && point.start_line <= line && line <= point.end_line)
+        {
+            *pRetVal = point.il_offset;
+            return S_OK;
+        }
+    }
+
+    return reader.invalid ? CLDB_E_FILE_CORRUPT : E_FAIL;
+}
+
+HRESULT SymMethod::GetRanges(
+    ISymUnmanagedDocument* document,
+    ULONG32 line,
+    ULONG32 column,
+    ULONG32 cRanges,
+    ULONG32* pcRanges,
+    ULONG32 ranges[])
+{
+    // Sequence points are found by line only.
+    UNREFERENCED_PARAMETER(column);
+
+    if (pcRanges == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    mdhandle_t handle = _pdb->MetaData();
+    mdcursor_t documentCursor;
+    mdToken documentToken;
+    RETURN_IF_FAILED(GetDocumentCursor(handle, document, &documentCursor));
+    if (!md_cursor_to_token(documentCursor, &documentToken))
+        return E_INVALIDARG;
+
+    std::vector<md_sequence_point_t> points;
+    RETURN_IF_FAILED(ReadSequencePoints(handle, _method, points));
+
+    // Each range is a start and end IL offset. A point's code ends where the next point's starts.
+    // The PDB doesn't record the size of the method, so the last point's range is unbounded.
+    if (ranges == nullptr)
+        cRanges = 0;
+
+    ULONG32 needed = 0;
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        md_sequence_point_t const& point = points[i];
+        if (!IsInDocument(point, documentToken) || line < point.start_line || point.end_line < line)
+            continue;
+
+        if (needed + 2 <= cRanges)
+        {
+            ranges[needed] = point.il_offset;
+            ranges[needed + 1] = i + 1 < points.size() ? points[i + 1].il_offset : UINT32_MAX;
+        }
+        needed += 2;
+    }
+
+    *pcRanges = needed;
+    return S_OK;
+}
+
+HRESULT SymMethod::GetParameters(
+    ULONG32 cParams,
+    ULONG32* pcParams,
+    ISymUnmanagedVariable* params[])
+{
+    UNREFERENCED_PARAMETER(cParams);
+    UNREFERENCED_PARAMETER(params);
+
+    if (pcParams == nullptr)
+        return E_INVALIDARG;
+
+    // Portable PDBs don't record parameters. Their names are in the module's metadata.
+    *pcParams = 0;
+    return S_OK;
+}
+
+HRESULT SymMethod::GetNamespace(
+    ISymUnmanagedNamespace** pRetVal)
+{
+    UNREFERENCED_PARAMETER(pRetVal);
+    return E_NOTIMPL;
+}
+
+HRESULT SymMethod::GetSourceStartEnd(
+    ISymUnmanagedDocument* docs[2],
+    ULONG32 lines[2],
+    ULONG32 columns[2],
+    BOOL* pRetVal)
+{
+    UNREFERENCED_PARAMETER(docs);
+    UNREFERENCED_PARAMETER(lines);
+    UNREFERENCED_PARAMETER(columns);
+    UNREFERENCED_PARAMETER(pRetVal);
+    return E_NOTIMPL;
+}
+
+HRESULT SymMethod::GetSequencePoints(
+    ULONG32 cPoints,
+    ULONG32* pcPoints,
+    ULONG32 offsets[],
+    ISymUnmanagedDocument* documents[],
+    ULONG32 lines[],
+    ULONG32 columns[],
+    ULONG32 endLines[],
+    ULONG32 endColumns[])
+{
+    if (pcPoints == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    md_sequence_point_reader_t reader;
+    RETURN_IF_FAILED(InitSequencePointReader(_pdb->MetaData(), _method, &reader));
+
+    // Only count the points if there are no arrays to fill.
+    bool fill = cPoints != 0
+        && (offsets != nullptr || documents != nullptr || lines != nullptr
+            || columns != nullptr || endLines != nullptr || endColumns != nullptr);
+
+    ULONG32 count = 0;
+    md_sequence_point_t point;
+    while ((!fill || count < cPoints) && md_read_sequence_point(&reader, &point))
+    {
+        if (fill)
+        {
+            if (documents != nullptr)
+            {
+                hr = CreateSymObject<SymDocument>(&documents[count], _pdb, point.document);
+                if (FAILED(hr))
+                {
+                    ReleaseObjects(documents, count);
+                    return hr;
+                }
+            }
+            if (offsets != nullptr)
+                offsets[count] = point.il_offset;
+            if (lines != nullptr)
+                lines[count] = point.start_line;
+            if (columns != nullptr)
+                columns[count] = point.start_column;
+            if (endLines != nullptr)
+                endLines[count] = point.end_line;
+            if (endColumns != nullptr)
+                endColumns[count] = point.end_column;
+        }
+        count++;
+    }
+
+    if (reader.invalid)
+    {
+        if (fill && documents != nullptr)
+            ReleaseObjects(documents, count);
+        return CLDB_E_FILE_CORRUPT;
+    }
+
+    *pcPoints = count;
+    return S_OK;
+}
+
+HRESULT SymScope::GetMethod(
+    ISymUnmanagedMethod** pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    return CreateSymObject<SymMethod>(pRetVal, _pdb, _method);
+}
+
+HRESULT SymScope::GetParent(
+    ISymUnmanagedScope** pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    *pRetVal = nullptr;
+    HRESULT hr;
+    uint32_t startOffset;
+    uint32_t endOffset;
+    RETURN_IF_FAILED(GetScopeRange(_scope, &startOffset, &endOffset));
+
+    // Scopes come before the scopes they contain, so the parent is
+    // the closest preceding scope of the method that contains this one.
+    mdcursor_t scope = _scope;
+    while (md_cursor_move(&scope, -1) && IsScopeOfMethod(scope, _method))
+    {
+        uint32_t parentStartOffset;
+        uint32_t parentEndOffset;
+        RETURN_IF_FAILED(GetScopeRange(scope, &parentStartOffset, &parentEndOffset));
+        if (parentStartOffset <= startOffset && endOffset <= parentEndOffset)
+            return CreateSymObject<SymScope>(pRetVal, _pdb, _method, scope);
+    }
+
+    // The root scope has no parent.
+    return S_OK;
+}
+
+HRESULT SymScope::GetChildren(
+    ULONG32 cChildren,
+    ULONG32* pcChildren,
+    ISymUnmanagedScope* children[])
+{
+    if (pcChildren == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    uint32_t startOffset;
+    uint32_t endOffset;
+    RETURN_IF_FAILED(GetScopeRange(_scope, &startOffset, &endOffset));
+
+    if (children == nullptr)
+        cChildren = 0;
+
+    // The scopes this one contains follow it. The direct children are
+    // the ones that aren't contained by a preceding child.
+    ULONG32 count = 0;
+    bool hasChild = false;
+    uint32_t childEndOffset = 0;
+    mdcursor_t scope = _scope;
+    while (md_cursor_next(&scope) && IsScopeOfMethod(scope, _method))
+    {
+        uint32_t nestedStartOffset;
+        uint32_t nestedEndOffset;
+        RETURN_IF_FAILED(GetScopeRange(scope, &nestedStartOffset, &nestedEndOffset));
+        if (nestedStartOffset >= endOffset)
+            break;
+
+        if (nestedEndOffset > endOffset || (hasChild && nestedStartOffset < childEndOffset))
+            continue;
+
+        if (count < cChildren)
+        {
+            hr = CreateSymObject<SymScope>(&children[count], _pdb, _method, scope);
+            if (FAILED(hr))
+            {
+                ReleaseObjects(children, count);
+                return hr;
+            }
+        }
+        count++;
+        hasChild = true;
+        childEndOffset = nestedEndOffset;
+    }
+
+    *pcChildren = cChildren != 0 && count > cChildren ? cChildren : count;
+    return S_OK;
+}
+
+HRESULT SymScope::GetStartOffset(
+    ULONG32* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    uint32_t endOffset;
+    return GetScopeRange(_scope, pRetVal, &endOffset);
+}
+
+HRESULT SymScope::GetEndOffset(
+    ULONG32* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    uint32_t startOffset;
+    return GetScopeRange(_scope, &startOffset, pRetVal);
+}
+
+HRESULT SymScope::GetLocalCount(
+    ULONG32* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    mdcursor_t variables;
+    if (!md_get_column_value_as_range(_scope, mdtLocalScope_VariableList, &variables, pRetVal))
+        return CLDB_E_FILE_CORRUPT;
+    return S_OK;
+}
+
+HRESULT SymScope::GetLocals(
+    ULONG32 cLocals,
+    ULONG32* pcLocals,
+    ISymUnmanagedVariable* locals[])
+{
+    if (pcLocals == nullptr)
+        return E_INVALIDARG;
+
+    HRESULT hr;
+    uint32_t startOffset;
+    uint32_t endOffset;
+    RETURN_IF_FAILED(GetScopeRange(_scope, &startOffset, &endOffset));
+
+    mdcursor_t variable;
+    uint32_t count;
+    if (!md_get_column_value_as_range(_scope, mdtLocalScope_VariableList, &variable, &count))
+        return CLDB_E_FILE_CORRUPT;
+
+    if (locals == nullptr || cLocals == 0)
+    {
+        *pcLocals = count;
+        return S_OK;
+    }
+
+    ULONG32 written = 0;
+    for (; written < count && written < cLocals; ++written, (void)md_cursor_next(&variable))
+    {
+        hr = CreateSymObject<SymVariable>(&locals[written], _pdb, variable, startOffset, endOffset);
+        if (FAILED(hr))
+        {
+            ReleaseObjects(locals, written);
+            return hr;
+        }
+    }
+
+    *pcLocals = written;
+    return S_OK;
+}
+
+HRESULT SymScope::GetNamespaces(
+    ULONG32 cNameSpaces,
+    ULONG32* pcNameSpaces,
+    ISymUnmanagedNamespace* namespaces[])
+{
+    if (pcNameSpaces == nullptr)
+        return E_INVALIDARG;
+
+    if (namespaces == nullptr)
+        cNameSpaces = 0;
+
+    mdcursor_t importScope;
+    mdToken importScopeToken;
+    if (1 != md_get_column_value_as_cursor(_scope, mdtLocalScope_ImportScope, 1, &importScope)
+        || !md_cursor_to_token(importScope, &importScopeToken))
+    {
+        return CLDB_E_FILE_CORRUPT;
+    }
+
+    if (RidFromToken(importScopeToken) == 0)
+    {
+        *pcNameSpaces = 0;
+        return S_OK;
+    }
+
+    uint8_t const* blob;
+    uint32_t blobLength;
+    if (1 != md_get_column_value_as_blob(importScope, mdtImportScope_Imports, 1, &blob, &blobLength))
+        return CLDB_E_FILE_CORRUPT;
+
+    mdhandle_t handle = _pdb->MetaData();
+    size_t bufferLength = 0;
+    md_blob_parse_result_t result = md_parse_imports(handle, blob, blobLength, nullptr, &bufferLength);
+    if (result != mdbpr_InsufficientBuffer)
+        return CLDB_E_FILE_CORRUPT;
+
+    malloc_ptr<md_imports_t> imports{ (md_imports_t*)::malloc(bufferLength) };
+    if (imports == nullptr)
+        return E_OUTOFMEMORY;
+
+    if (md_parse_imports(handle, blob, blobLength, imports.get(), &bufferLength) != mdbpr_Success)
+        return CLDB_E_FILE_CORRUPT;
+
+    // Only imports of a whole namespace are namespaces.
+    HRESULT hr;
+    ULONG32 count = 0;
+    for (uint32_t i = 0; i < imports->count; ++i)
+    {
+        auto const& import = imports->imports[i];
+        if (import.target_namespace == nullptr)
+            continue;
+
+        if (count < cNameSpaces)
+        {
+            try
+            {
+                hr = CreateSymObject<SymNamespace>(&namespaces[count], std::string{ import.target_namespace, import.target_namespace_len });
+            }
+            catch (std::bad_alloc const&)
+            {
+                hr = E_OUTOFMEMORY;
+            }
+
+            if (FAILED(hr))
+            {
+                ReleaseObjects(namespaces, count);
+                return hr;
+            }
+        }
+        count++;
+    }
+
+    *pcNameSpaces = cNameSpaces != 0 && count > cNameSpaces ? cNameSpaces : count;
+    return S_OK;
+}
+
+HRESULT SymScope::GetConstantCount(
+    ULONG32* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    mdcursor_t constants;
+    if (!md_get_column_value_as_range(_scope, mdtLocalScope_ConstantList, &constants, pRetVal))
+        return CLDB_E_FILE_CORRUPT;
+    return S_OK;
+}
+
+HRESULT SymScope::GetConstants(
+    ULONG32 cConstants,
+    ULONG32* pcConstants,
+    ISymUnmanagedConstant* constants[])
+{
+    if (pcConstants == nullptr)
+        return E_INVALIDARG;
+
+    mdcursor_t constant;
+    uint32_t count;
+    if (!md_get_column_value_as_range(_scope, mdtLocalScope_ConstantList, &constant, &count))
+        return CLDB_E_FILE_CORRUPT;
+
+    if (constants == nullptr || cConstants == 0)
+    {
+        *pcConstants = count;
+        return S_OK;
+    }
+
+    HRESULT hr;
+    ULONG32 written = 0;
+    for (; written < count && written < cConstants; ++written, (void)md_cursor_next(&constant))
+    {
+        hr = CreateSymObject<SymConstant>(&constants[written], _pdb, constant);
+        if (FAILED(hr))
+        {
+            ReleaseObjects(constants, written);
+            return hr;
+        }
+    }
+
+    *pcConstants = written;
+    return S_OK;
+}
+
+HRESULT SymVariable::GetName(
+    ULONG32 cchName,
+    ULONG32* pcchName,
+    WCHAR szName[])
+{
+    char const* name;
+    if (1 != md_get_column_value_as_utf8(_variable, mdtLocalVariable_Name, 1, &name))
+        return CLDB_E_FILE_CORRUPT;
+
+    return ReturnStringOutput(name, cchName, pcchName, szName);
+}
+
+HRESULT SymVariable::GetAttributes(
+    ULONG32* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    if (1 != md_get_column_value_as_constant(_variable, mdtLocalVariable_Attributes, 1, pRetVal))
+        return CLDB_E_FILE_CORRUPT;
+    return S_OK;
+}
+
+HRESULT SymVariable::GetSignature(
+    ULONG32 cSig,
+    ULONG32* pcSig,
+    BYTE sig[])
+{
+    // The types of locals are in the local signature of the method body, not in the PDB.
+    UNREFERENCED_PARAMETER(cSig);
+    UNREFERENCED_PARAMETER(pcSig);
+    UNREFERENCED_PARAMETER(sig);
+    return E_NOTIMPL;
+}
+
+HRESULT SymVariable::GetAddressKind(
+    ULONG32* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    *pRetVal = ADDR_IL_OFFSET;
+    return S_OK;
+}
+
+HRESULT SymVariable::GetAddressField1(
+    ULONG32* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    // The slot of the local in the method's local signature.
+    if (1 != md_get_column_value_as_constant(_variable, mdtLocalVariable_Index, 1, pRetVal))
+        return CLDB_E_FILE_CORRUPT;
+    return S_OK;
+}
+
+HRESULT SymVariable::GetAddressField2(
+    ULONG32* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    *pRetVal = 0;
+    return S_OK;
+}
+
+HRESULT SymVariable::GetAddressField3(
+    ULONG32* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    *pRetVal = 0;
+    return S_OK;
+}
+
+HRESULT SymVariable::GetStartOffset(
+    ULONG32* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    *pRetVal = _startOffset;
+    return S_OK;
+}
+
+HRESULT SymVariable::GetEndOffset(
+    ULONG32* pRetVal)
+{
+    if (pRetVal == nullptr)
+        return E_INVALIDARG;
+
+    *pRetVal = _endOffset;
+    return S_OK;
+}
+
+HRESULT SymConstant::GetName(
+    ULONG32 cchName,
+    ULONG32* pcchName,
+    WCHAR szName[])
+{
+    char const* name;
+    if (1 != md_get_column_value_as_utf8(_constant, mdtLocalConstant_Name, 1, &name))
+        return CLDB_E_FILE_CORRUPT;
+
+    return ReturnStringOutput(name, cchName, pcchName, szName);
+}
+
+HRESULT SymConstant::GetValue(
+    VARIANT* pValue)
+{
+    if (pValue == nullptr)
+        return E_INVALIDARG;
+
+    V_VT(pValue) = VT_EMPTY;
+    uint8_t const* blob;
+    uint32_t blobLength;
+    if (1 != md_get_column_value_as_blob(_constant, mdtLocalConstant_Signature, 1, &blob, &blobLength))
+        return CLDB_E_FILE_CORRUPT;
+
+    mdhandle_t handle = _pdb->MetaData();
+    size_t bufferLength = 0;
+    if (md_parse_local_constant_sig(handle, blob, blobLength, nullptr, &bufferLength) != mdbpr_InsufficientBuffer)
+        return CLDB_E_FILE_CORRUPT;
+
+    malloc_ptr<md_local_constant_sig_t> signature{ (md_local_constant_sig_t*)::malloc(bufferLength) };
+    if (signature == nullptr)
+        return E_OUTOFMEMORY;
+
+    if (md_parse_local_constant_sig(handle, blob, blobLength, signature.get(), &bufferLength) != mdbpr_Success)
+        return CLDB_E_FILE_CORRUPT;
+
+    switch (signature->constant_kind)
+    {
+    case md_local_constant_sig_t::mdck_PrimitiveConstant:
+        return ReadConstantValue(signature->primitive.type_code, signature->value_blob, signature->value_len, pValue);
+    case md_local_constant_sig_t::mdck_EnumConstant:
+        return ReadConstantValue(signature->enum_constant.type_code, signature->value_blob, signature->value_len, pValue);
+    case md_local_constant_sig_t::mdck_GeneralConstant:
+        return ReadGeneralConstantValue(*signature, pValue);
+    default:
+        return CLDB_E_FILE_CORRUPT;
+    }
+}
+
+HRESULT SymConstant::GetSignature(
+    ULONG32 cSig,
+    ULONG32* pcSig,
+    BYTE sig[])
+{
+    // The LocalConstantSig blob, which includes the value.
+    uint8_t const* blob;
+    uint32_t blobLength;
+    if (1 != md_get_column_value_as_blob(_constant, mdtLocalConstant_Signature, 1, &blob, &blobLength))
+        return CLDB_E_FILE_CORRUPT;
+
+    return ReturnBlobOutput(blob, blobLength, cSig, pcSig, sig);
+}
+
+HRESULT SymNamespace::GetName(
+    ULONG32 cchName,
+    ULONG32* pcchName,
+    WCHAR szName[])
+{
+    return ReturnStringOutput(_name.c_str(), cchName, pcchName, szName);
+}
+
+HRESULT SymNamespace::GetNamespaces(
+    ULONG32 cNameSpaces,
+    ULONG32* pcNameSpaces,
+    ISymUnmanagedNamespace* namespaces[])
+{
+    UNREFERENCED_PARAMETER(cNameSpaces);
+    UNREFERENCED_PARAMETER(namespaces);
+
+    if (pcNameSpaces == nullptr)
+        return E_INVALIDARG;
+
+    *pcNameSpaces = 0;
+    return S_OK;
+}
+
+HRESULT SymNamespace::GetVariables(
+    ULONG32 cVars,
+    ULONG32* pcVars,
+    ISymUnmanagedVariable* pVars[])
+{
+    UNREFERENCED_PARAMETER(cVars);
+    UNREFERENCED_PARAMETER(pVars);
+
+    if (pcVars == nullptr)
+        return E_INVALIDARG;
+
+    *pcVars = 0;
+    return S_OK;
+}
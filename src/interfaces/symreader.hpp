@@ -0,0 +1,568 @@
+#ifndef _SRC_INTERFACES_SYMREADER_HPP_
+#define _SRC_INTERFACES_SYMREADER_HPP_
+
+#include <internal/dnmd_platform.hpp>
+#include "tearoffbase.hpp"
+#include "controllingiunknown.hpp"
+#include "pal.hpp"
+
+#include <dnmd_pdb.h>
+#include <external/cor.h>
+#include <external/corsym.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+EXTERN_GUID(IID_ISymUnmanagedReader, 0xb4ce6286, 0x2a6b, 0x3712, 0xa3, 0xb7, 0x1e, 0xe1, 0xda, 0xd4, 0x67, 0xb5);
+EXTERN_GUID(IID_ISymUnmanagedDocument, 0x40de4037, 0x7c81, 0x3e1e, 0xb0, 0x22, 0xae, 0x1a, 0xbf, 0xf2, 0xca, 0x08);
+EXTERN_GUID(IID_ISymUnmanagedMethod, 0xb62b923c, 0xb500, 0x3158, 0xa5, 0x43, 0x24, 0xf3, 0x07, 0xa8, 0xb7, 0xe1);
+EXTERN_GUID(IID_ISymUnmanagedScope, 0x68005d0f, 0xb8e0, 0x3b01, 0x84, 0xd5, 0xa1, 0x1a, 0x94, 0x15, 0x49, 0x42);
+EXTERN_GUID(IID_ISymUnmanagedScope2, 0xae932fba, 0x3fd8, 0x4dba, 0x82, 0x32, 0x30, 0xa2, 0x30, 0x9b, 0x02, 0xdb);
+EXTERN_GUID(IID_ISymUnmanagedVariable, 0x9f60eebe, 0x2d9a, 0x3f7c, 0xbf, 0x58, 0x80, 0xbc, 0x99, 0x1c, 0x60, 0xbb);
+EXTERN_GUID(IID_ISymUnmanagedConstant, 0x48b25ed8, 0x5bad, 0x41bc, 0x9c, 0xee, 0xcd, 0x62, 0xfa, 0xbc, 0x74, 0xe9);
+EXTERN_GUID(IID_ISymUnmanagedNamespace, 0x0dff7289, 0x54f8, 0x11d3, 0xbd, 0x28, 0x00, 0x00, 0xf8, 0x08, 0x49, 0xbd);
+
+EXTERN_GUID(IID_IDNMDSymDocument, 0x7d3c91a4, 0x2f6e, 0x4b18, 0x9a, 0x57, 0xc0, 0x8e, 0x41, 0xd2, 0x6b, 0x93);
+
+// Implemented by the documents a reader hands out, so the Document row of a
+// document passed back to the reader can be found.
+struct IDNMDSymDocument : IUnknown
+{
+    virtual mdhandle_t MetaData() = 0;
+    virtual mdcursor_t Document() = 0;
+};
+
+// The symbols of a Portable PDB, shared by a reader and all objects it hands out.
+// Opening a PDB only maps it. The sequence point, document line and local scope
+// lookups are built by the handle on first use and are safe to use from several threads.
+class PortablePdb final
+{
+    std::unique_ptr<pal::MappedFile> _file;
+    malloc_ptr<void> _data;
+    mdhandle_ptr _md_ptr;
+    std::basic_string<WCHAR> _fileName;
+
+public:
+    PortablePdb(std::unique_ptr<pal::MappedFile> file, malloc_ptr<void> data, mdhandle_ptr md_ptr, std::basic_string<WCHAR> fileName)
+        : _file{ std::move(file) }
+        , _data{ std::move(data) }
+        , _md_ptr{ std::move(md_ptr) }
+        , _fileName{ std::move(fileName) }
+    { }
+
+    // Open the PDB file, or the PDB next to a module file.
+    static HRESULT OpenFile(WCHAR const* fileName, std::shared_ptr<PortablePdb>& pdb);
+
+    // Read the PDB from the current position to the end of the stream.
+    static HRESULT OpenStream(IStream* stream, std::shared_ptr<PortablePdb>& pdb);
+
+    mdhandle_t MetaData() const noexcept
+    {
+        return _md_ptr.get();
+    }
+
+    // Empty for PDBs read from a stream.
+    std::basic_string<WCHAR> const& FileName() const noexcept
+    {
+        return _fileName;
+    }
+};
+
+class SymReader final : public TearOffBase<ISymUnmanagedReader>
+{
+    // Set once by Initialize().
+    std::shared_ptr<PortablePdb> _pdb;
+
+protected:
+    virtual bool TryGetInterfaceOnThis(REFIID riid, void** ppvObject) override
+    {
+        assert(riid != IID_IUnknown);
+        if (riid == IID_ISymUnmanagedReader)
+        {
+            *ppvObject = static_cast<ISymUnmanagedReader*>(this);
+            return true;
+        }
+        return false;
+    }
+
+public:
+    SymReader(IUnknown* controllingUnknown)
+        : TearOffBase(controllingUnknown)
+        , _pdb{}
+    { }
+
+    virtual ~SymReader() = default;
+
+public: // ISymUnmanagedReader
+    STDMETHOD(GetDocument)(
+        WCHAR* url,
+        GUID language,
+        GUID languageVendor,
+        GUID documentType,
+        ISymUnmanagedDocument** pRetVal) override;
+
+    STDMETHOD(GetDocuments)(
+        ULONG32 cDocs,
+        ULONG32* pcDocs,
+        ISymUnmanagedDocument* pDocs[]) override;
+
+    STDMETHOD(GetUserEntryPoint)(
+        mdMethodDef* pToken) override;
+
+    STDMETHOD(GetMethod)(
+        mdMethodDef token,
+        ISymUnmanagedMethod** pRetVal) override;
+
+    STDMETHOD(GetMethodByVersion)(
+        mdMethodDef token,
+        int version,
+        ISymUnmanagedMethod** pRetVal) override;
+
+    STDMETHOD(GetVariables)(
+        mdToken parent,
+        ULONG32 cVars,
+        ULONG32* pcVars,
+        ISymUnmanagedVariable* pVars[]) override;
+
+    STDMETHOD(GetGlobalVariables)(
+        ULONG32 cVars,
+        ULONG32* pcVars,
+        ISymUnmanagedVariable* pVars[]) override;
+
+    STDMETHOD(GetMethodFromDocumentPosition)(
+        ISymUnmanagedDocument* document,
+        ULONG32 line,
+        ULONG32 column,
+        ISymUnmanagedMethod** pRetVal) override;
+
+    STDMETHOD(GetSymAttribute)(
+        mdToken parent,
+        WCHAR* name,
+        ULONG32 cBuffer,
+        ULONG32* pcBuffer,
+        BYTE buffer[]) override;
+
+    STDMETHOD(GetNamespaces)(
+        ULONG32 cNameSpaces,
+        ULONG32* pcNameSpaces,
+        ISymUnmanagedNamespace* namespaces[]) override;
+
+    STDMETHOD(Initialize)(
+        IUnknown* importer,
+        WCHAR const* filename,
+        WCHAR const* searchPath,
+        IStream* pIStream) override;
+
+    STDMETHOD(UpdateSymbolStore)(
+        WCHAR const* filename,
+        IStream* pIStream) override;
+
+    STDMETHOD(ReplaceSymbolStore)(
+        WCHAR const* filename,
+        IStream* pIStream) override;
+
+    STDMETHOD(GetSymbolStoreFileName)(
+        ULONG32 cchName,
+        ULONG32* pcchName,
+        WCHAR szName[]) override;
+
+    STDMETHOD(GetMethodsFromDocumentPosition)(
+        ISymUnmanagedDocument* document,
+        ULONG32 line,
+        ULONG32 column,
+        ULONG32 cMethod,
+        ULONG32* pcMethod,
+        ISymUnmanagedMethod* pRetVal[]) override;
+
+    STDMETHOD(GetDocumentVersion)(
+        ISymUnmanagedDocument* pDoc,
+        int* version,
+        BOOL* pbCurrent) override;
+
+    STDMETHOD(GetMethodVersion)(
+        ISymUnmanagedMethod* pMethod,
+        int* version) override;
+};
+
+class SymDocument final : public TearOffBase<ISymUnmanagedDocument, IDNMDSymDocument>
+{
+    std::shared_ptr<PortablePdb> _pdb;
+    mdcursor_t _document;
+
+protected:
+    virtual bool TryGetInterfaceOnThis(REFIID riid, void** ppvObject) override
+    {
+        assert(riid != IID_IUnknown);
+        if (riid == IID_ISymUnmanagedDocument)
+        {
+            *ppvObject = static_cast<ISymUnmanagedDocument*>(this);
+            return true;
+        }
+        if (riid == IID_IDNMDSymDocument)
+        {
+            *ppvObject = static_cast<IDNMDSymDocument*>(this);
+            return true;
+        }
+        return false;
+    }
+
+public:
+    SymDocument(IUnknown* controllingUnknown, std::shared_ptr<PortablePdb> pdb, mdcursor_t document)
+        : TearOffBase(controllingUnknown)
+        , _pdb{ std::move(pdb) }
+        , _document{ document }
+    { }
+
+    virtual ~SymDocument() = default;
+
+public: // IDNMDSymDocument
+    mdhandle_t MetaData() override
+    {
+        return _pdb->MetaData();
+    }
+
+    mdcursor_t Document() override
+    {
+        return _document;
+    }
+
+public: // ISymUnmanagedDocument
+    STDMETHOD(GetURL)(
+        ULONG32 cchUrl,
+        ULONG32* pcchUrl,
+        WCHAR szUrl[]) override;
+
+    STDMETHOD(GetDocumentType)(
+        GUID* pRetVal) override;
+
+    STDMETHOD(GetLanguage)(
+        GUID* pRetVal) override;
+
+    STDMETHOD(GetLanguageVendor)(
+        GUID* pRetVal) override;
+
+    STDMETHOD(GetCheckSumAlgorithmId)(
+        GUID* pRetVal) override;
+
+    STDMETHOD(GetCheckSum)(
+        ULONG32 cData,
+        ULONG32* pcData,
+        BYTE data[]) override;
+
+    STDMETHOD(FindClosestLine)(
+        ULONG32 line,
+        ULONG32* pRetVal) override;
+
+    STDMETHOD(HasEmbeddedSource)(
+        BOOL* pRetVal) override;
+
+    STDMETHOD(GetSourceLength)(
+        ULONG32* pRetVal) override;
+
+    STDMETHOD(GetSourceRange)(
+        ULONG32 startLine,
+        ULONG32 startColumn,
+        ULONG32 endLine,
+        ULONG32 endColumn,
+        ULONG32 cSourceBytes,
+        ULONG32* pcSourceBytes,
+        BYTE source[]) override;
+};
+
+class SymMethod final : public TearOffBase<ISymUnmanagedMethod>
+{
+    std::shared_ptr<PortablePdb> _pdb;
+    mdMethodDef _method;
+
+protected:
+    virtual bool TryGetInterfaceOnThis(REFIID riid, void** ppvObject) override
+    {
+        assert(riid != IID_IUnknown);
+        if (riid == IID_ISymUnmanagedMethod)
+        {
+            *ppvObject = static_cast<ISymUnmanagedMethod*>(this);
+            return true;
+        }
+        return false;
+    }
+
+public:
+    SymMethod(IUnknown* controllingUnknown, std::shared_ptr<PortablePdb> pdb, mdMethodDef method)
+        : TearOffBase(controllingUnknown)
+        , _pdb{ std::move(pdb) }
+        , _method{ method }
+    { }
+
+    virtual ~SymMethod() = default;
+
+public: // ISymUnmanagedMethod
+    STDMETHOD(GetToken)(
+        mdMethodDef* pToken) override;
+
+    STDMETHOD(GetSequencePointCount)(
+        ULONG32* pRetVal) override;
+
+    STDMETHOD(GetRootScope)(
+        ISymUnmanagedScope** pRetVal) override;
+
+    STDMETHOD(GetScopeFromOffset)(
+        ULONG32 offset,
+        ISymUnmanagedScope** pRetVal) override;
+
+    STDMETHOD(GetOffset)(
+        ISymUnmanagedDocument* document,
+        ULONG32 line,
+        ULONG32 column,
+        ULONG32* pRetVal) override;
+
+    STDMETHOD(GetRanges)(
+        ISymUnmanagedDocument* document,
+        ULONG32 line,
+        ULONG32 column,
+        ULONG32 cRanges,
+        ULONG32* pcRanges,
+        ULONG32 ranges[]) override;
+
+    STDMETHOD(GetParameters)(
+        ULONG32 cParams,
+        ULONG32* pcParams,
+        ISymUnmanagedVariable* params[]) override;
+
+    STDMETHOD(GetNamespace)(
+        ISymUnmanagedNamespace** pRetVal) override;
+
+    STDMETHOD(GetSourceStartEnd)(
+        ISymUnmanagedDocument* docs[2],
+        ULONG32 lines[2],
+        ULONG32 columns[2],
+        BOOL* pRetVal) override;
+
+    STDMETHOD(GetSequencePoints)(
+        ULONG32 cPoints,
+        ULONG32* pcPoints,
+        ULONG32 offsets[],
+        ISymUnmanagedDocument* documents[],
+        ULONG32 lines[],
+        ULONG32 columns[],
+        ULONG32 endLines[],
+        ULONG32 endColumns[]) override;
+};
+
+class SymScope final : public TearOffBase<ISymUnmanagedScope2>
+{
+    std::shared_ptr<PortablePdb> _pdb;
+    mdMethodDef _method;
+    mdcursor_t _scope;
+
+protected:
+    virtual bool TryGetInterfaceOnThis(REFIID riid, void** ppvObject) override
+    {
+        assert(riid != IID_IUnknown);
+        if (riid == IID_ISymUnmanagedScope || riid == IID_ISymUnmanagedScope2)
+        {
+            *ppvObject = static_cast<ISymUnmanagedScope2*>(this);
+            return true;
+        }
+        return false;
+    }
+
+public:
+    SymScope(IUnknown* controllingUnknown, std::shared_ptr<PortablePdb> pdb, mdMethodDef method, mdcursor_t scope)
+        : TearOffBase(controllingUnknown)
+        , _pdb{ std::move(pdb) }
+        , _method{ method }
+        , _scope{ scope }
+    { }
+
+    virtual ~SymScope() = default;
+
+public: // ISymUnmanagedScope
+    STDMETHOD(GetMethod)(
+        ISymUnmanagedMethod** pRetVal) override;
+
+    STDMETHOD(GetParent)(
+        ISymUnmanagedScope** pRetVal) override;
+
+    STDMETHOD(GetChildren)(
+        ULONG32 cChildren,
+        ULONG32* pcChildren,
+        ISymUnmanagedScope* children[]) override;
+
+    STDMETHOD(GetStartOffset)(
+        ULONG32* pRetVal) override;
+
+    STDMETHOD(GetEndOffset)(
+        ULONG32* pRetVal) override;
+
+    STDMETHOD(GetLocalCount)(
+        ULONG32* pRetVal) override;
+
+    STDMETHOD(GetLocals)(
+        ULONG32 cLocals,
+        ULONG32* pcLocals,
+        ISymUnmanagedVariable* locals[]) override;
+
+    STDMETHOD(GetNamespaces)(
+        ULONG32 cNameSpaces,
+        ULONG32* pcNameSpaces,
+        ISymUnmanagedNamespace* namespaces[]) override;
+
+public: // ISymUnmanagedScope2
+    STDMETHOD(GetConstantCount)(
+        ULONG32* pRetVal) override;
+
+    STDMETHOD(GetConstants)(
+        ULONG32 cConstants,
+        ULONG32* pcConstants,
+        ISymUnmanagedConstant* constants[]) override;
+};
+
+class SymVariable final : public TearOffBase<ISymUnmanagedVariable>
+{
+    std::shared_ptr<PortablePdb> _pdb;
+    mdcursor_t _variable;
+    // The IL range of the scope that declares the variable.
+    uint32_t _startOffset;
+    uint32_t _endOffset;
+
+protected:
+    virtual bool TryGetInterfaceOnThis(REFIID riid, void** ppvObject) override
+    {
+        assert(riid != IID_IUnknown);
+        if (riid == IID_ISymUnmanagedVariable)
+        {
+            *ppvObject = static_cast<ISymUnmanagedVariable*>(this);
+            return true;
+        }
+        return false;
+    }
+
+public:
+    SymVariable(IUnknown* controllingUnknown, std::shared_ptr<PortablePdb> pdb, mdcursor_t variable, uint32_t startOffset, uint32_t endOffset)
+        : TearOffBase(controllingUnknown)
+        , _pdb{ std::move(pdb) }
+        , _variable{ variable }
+        , _startOffset{ startOffset }
+        , _endOffset{ endOffset }
+    { }
+
+    virtual ~SymVariable() = default;
+
+public: // ISymUnmanagedVariable
+    STDMETHOD(GetName)(
+        ULONG32 cchName,
+        ULONG32* pcchName,
+        WCHAR szName[]) override;
+
+    STDMETHOD(GetAttributes)(
+        ULONG32* pRetVal) override;
+
+    STDMETHOD(GetSignature)(
+        ULONG32 cSig,
+        ULONG32* pcSig,
+        BYTE sig[]) override;
+
+    STDMETHOD(GetAddressKind)(
+        ULONG32* pRetVal) override;
+
+    STDMETHOD(GetAddressField1)(
+        ULONG32* pRetVal) override;
+
+    STDMETHOD(GetAddressField2)(
+        ULONG32* pRetVal) override;
+
+    STDMETHOD(GetAddressField3)(
+        ULONG32* pRetVal) override;
+
+    STDMETHOD(GetStartOffset)(
+        ULONG32* pRetVal) override;
+
+    STDMETHOD(GetEndOffset)(
+        ULONG32* pRetVal) override;
+};
+
+class SymConstant final : public TearOffBase<ISymUnmanagedConstant>
+{
+    std::shared_ptr<PortablePdb> _pdb;
+    mdcursor_t _constant;
+
+protected:
+    virtual bool TryGetInterfaceOnThis(REFIID riid, void** ppvObject) override
+    {
+        assert(riid != IID_IUnknown);
+        if (riid == IID_ISymUnmanagedConstant)
+        {
+            *ppvObject = static_cast<ISymUnmanagedConstant*>(this);
+            return true;
+        }
+        return false;
+    }
+
+public:
+    SymConstant(IUnknown* controllingUnknown, std::shared_ptr<PortablePdb> pdb, mdcursor_t constant)
+        : TearOffBase(controllingUnknown)
+        , _pdb{ std::move(pdb) }
+        , _constant{ constant }
+    { }
+
+    virtual ~SymConstant() = default;
+
+public: // ISymUnmanagedConstant
+    STDMETHOD(GetName)(
+        ULONG32 cchName,
+        ULONG32* pcchName,
+        WCHAR szName[]) override;
+
+    STDMETHOD(GetValue)(
+        VARIANT* pValue) override;
+
+    STDMETHOD(GetSignature)(
+        ULONG32 cSig,
+        ULONG32* pcSig,
+        BYTE sig[]) override;
+};
+
+// An imported namespace of a scope.
+class SymNamespace final : public TearOffBase<ISymUnmanagedNamespace>
+{
+    std::string _name;
+
+protected:
+    virtual bool TryGetInterfaceOnThis(REFIID riid, void** ppvObject) override
+    {
+        assert(riid != IID_IUnknown);
+        if (riid == IID_ISymUnmanagedNamespace)
+        {
+            *ppvObject = static_cast<ISymUnmanagedNamespace*>(this);
+            return true;
+        }
+        return false;
+    }
+
+public:
+    SymNamespace(IUnknown* controllingUnknown, std::string name)
+        : TearOffBase(controllingUnknown)
+        , _name{ std::move(name) }
+    { }
+
+    virtual ~SymNamespace() = default;
+
+public: // ISymUnmanagedNamespace
+    STDMETHOD(GetName)(
+        ULONG32 cchName,
+        ULONG32* pcchName,
+        WCHAR szName[]) override;
+
+    STDMETHOD(GetNamespaces)(
+        ULONG32 cNameSpaces,
+        ULONG32* pcNameSpaces,
+        ISymUnmanagedNamespace* namespaces[]) override;
+
+    STDMETHOD(GetVariables)(
+        ULONG32 cVars,
+        ULONG32* pcVars,
+        ISymUnmanagedVariable* pVars[]) override;
+};
+
+#endif // _SRC_INTERFACES_SYMREADER_HPP_
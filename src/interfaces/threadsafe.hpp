@@ -2,17 +2,25 @@
 #define _SRC_INTERFACES_THREADSAFE_HPP_
 
 #include "internal/dnmd_platform.hpp"
+#include "dnmd_interfaces.hpp"
 #include "tearoffbase.hpp"
 #include "controllingiunknown.hpp"
 #include "dnmdowner.hpp"
 #include "pal.hpp"
 #include "importhelpers.hpp"
+#include "statistics.hpp"
 
 #include <external/cor.h>
 #include <external/corhdr.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
 
 // A tear-off that re-exposes an mdhandle_view as an IDNMDOwner*.
 class DelegatingDNMDOwner final : public TearOffBase<IDNMDOwner>
@@ -47,12 +55,40 @@ public:
 template<typename TImport, typename TEmit>
 class ThreadSafeImportEmit : public TearOffBase<IMetaDataImport2, IMetaDataEmit2, IMetaDataAssemblyImport, IMetaDataAssemblyEmit>
 {
+    // A read-only snapshot of the metadata and an import implementation that reads from it.
+    struct Snapshot final
+    {
+        dncp::com_ptr<ControllingIUnknown> Owner;
+        TImport* Import;
+    };
+
+    // The HCORENUM handed out for enumerations started on a snapshot.
+    // The enumerator keeps its snapshot alive so it can be used after newer snapshots are published.
+    struct SnapshotEnum final
+    {
+        HCORENUM Inner;
+        IUnknown* Owner;
+        TImport* Import;
+    };
+
+    DNMDThreadSafetyStrategy _strategy;
     pal::ReadWriteLock _lock;
     // owning reference to the thread-unsafe object that provides the underlying implementation.
     dncp::com_ptr<ControllingIUnknown> _threadUnsafe;
     // non-owning reference to the concrete non-locking implementations
     TImport* _import;
     TEmit* _emit;
+    // non-owning reference to the statistics tear-off, if statistics are collected.
+    ThreadSafeStatistics* _statistics;
+
+    // State for the snapshot strategy.
+    // Writers mark the published snapshot as stale and the next reader publishes a new snapshot,
+    // so a burst of writes only creates a single snapshot.
+    std::atomic<Snapshot*> _snapshot;
+    std::atomic<bool> _snapshotStale;
+    // Replaced snapshots that may still be in use by readers, with the epoch they were retired in.
+    // Guarded by the write lock.
+    std::vector<std::pair<uint64_t, std::unique_ptr<Snapshot>>> _retiredSnapshots;
 
 protected:
     virtual bool TryGetInterfaceOnThis(REFIID riid, void** ppvObject) override
@@ -81,60 +117,261 @@ protected:
         return false;
     }
 
+private:
+    // Publish a snapshot of the current metadata. The write lock must be held.
+    HRESULT PublishSnapshot()
+    {
+        mdhandle_t snapshotHandle;
+        if (!md_snapshot_handle(_import->MetaData(), &snapshotHandle))
+            return E_OUTOFMEMORY;
+
+        mdhandle_ptr snapshotPtr{ snapshotHandle };
+        try
+        {
+            dncp::com_ptr<ControllingIUnknown> snapshotUnknown;
+            snapshotUnknown.Attach(new ControllingIUnknown());
+            DNMDOwner* owner = snapshotUnknown->CreateAndAddTearOff<DNMDOwner>(std::move(snapshotPtr));
+            TImport* import = snapshotUnknown->CreateAndAddTearOff<TImport>(mdhandle_view{ owner });
+
+            std::unique_ptr<Snapshot> snapshot{ new Snapshot{ std::move(snapshotUnknown), import } };
+
+            // Make room to retire the current snapshot before publishing so retiring can't fail.
+            _retiredSnapshots.reserve(_retiredSnapshots.size() + 1);
+            std::unique_ptr<Snapshot> previous{ _snapshot.exchange(snapshot.release()) };
+            _snapshotStale.store(false, std::memory_order_release);
+            if (previous != nullptr)
+                _retiredSnapshots.emplace_back(pal::AdvanceEpoch(), std::move(previous));
+        }
+        catch (std::bad_alloc const&)
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        // Destroy the retired snapshots that no reader can still be using.
+        auto firstInUse = std::remove_if(_retiredSnapshots.begin(), _retiredSnapshots.end(),
+            [](std::pair<uint64_t, std::unique_ptr<Snapshot>> const& retired)
+            {
+                return pal::IsEpochQuiescent(retired.first);
+            });
+        _retiredSnapshots.erase(firstInUse, _retiredSnapshots.end());
+        return S_OK;
+    }
+
+    // Returns S_FALSE if the published snapshot is current.
+    HRESULT PublishSnapshotIfStale()
+    {
+        if (!_snapshotStale.load(std::memory_order_acquire))
+            return S_FALSE;
+
+        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
+        if (!_snapshotStale.load(std::memory_order_relaxed))
+            return S_FALSE;
+        return PublishSnapshot();
+    }
+
+    // Call under the lock and record the time spent waiting for and holding the lock.
+    template<typename TLock, typename TCall>
+    HRESULT CallWithStatistics(ThreadSafeMethod method, TLock& lock, TCall call)
+    {
+        ThreadSafeStatistics::Clock::time_point start = ThreadSafeStatistics::Clock::now();
+        std::unique_lock<TLock> guard{ lock, std::try_to_lock };
+        bool blocked = !guard.owns_lock();
+        if (blocked)
+            guard.lock();
+
+        ThreadSafeStatistics::Clock::time_point acquired = blocked ? ThreadSafeStatistics::Clock::now() : start;
+        HRESULT hr = call();
+        ThreadSafeStatistics::Clock::time_point released = ThreadSafeStatistics::Clock::now();
+        guard.unlock();
+
+        _statistics->Record(method, blocked, acquired - start, released - acquired);
+        return hr;
+    }
+
+    template<typename TRead>
+    HRESULT Read(ThreadSafeMethod method, TRead read)
+    {
+        if (_strategy == DNMDThreadSafetyLock)
+        {
+            if (_statistics != nullptr)
+                return CallWithStatistics(method, this->_lock.GetReadLock(), [&]() { return read(_import); });
+
+            std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
+            return read(_import);
+        }
+
+        return ReadSnapshot(method, [&](Snapshot* snapshot) { return read(snapshot->Import); });
+    }
+
+    // Call with the current snapshot. Publishing a new snapshot is recorded as waiting for the lock.
+    template<typename TRead>
+    HRESULT ReadSnapshot(ThreadSafeMethod method, TRead read)
+    {
+        ThreadSafeStatistics::Clock::time_point start{};
+        if (_statistics != nullptr)
+            start = ThreadSafeStatistics::Clock::now();
+
+        HRESULT hr = PublishSnapshotIfStale();
+        if (FAILED(hr))
+            return hr;
+        bool published = hr == S_OK;
+
+        ThreadSafeStatistics::Clock::time_point acquired{};
+        if (_statistics != nullptr)
+            acquired = published ? ThreadSafeStatistics::Clock::now() : start;
+
+        {
+            pal::EpochGuard guard;
+            hr = read(_snapshot.load(std::memory_order_acquire));
+        }
+
+        if (_statistics != nullptr)
+            _statistics->Record(method, published, acquired - start, ThreadSafeStatistics::Clock::now() - acquired);
+        return hr;
+    }
+
+    // Call without a lock on an object that isn't shared between threads.
+    template<typename TCall>
+    HRESULT CallUnlocked(ThreadSafeMethod method, TCall call)
+    {
+        if (_statistics == nullptr)
+            return call();
+
+        ThreadSafeStatistics::Clock::time_point start = ThreadSafeStatistics::Clock::now();
+        HRESULT hr = call();
+        _statistics->Record(method, false, ThreadSafeStatistics::Clock::duration::zero(), ThreadSafeStatistics::Clock::now() - start);
+        return hr;
+    }
+
+    template<typename TEnumerate>
+    HRESULT ReadEnum(ThreadSafeMethod method, HCORENUM* phEnum, TEnumerate enumerate)
+    {
+        if (_strategy == DNMDThreadSafetyLock || phEnum == nullptr)
+            return Read(method, [&](TImport* import) { return enumerate(import, phEnum); });
+
+        // Continue an enumeration on the snapshot it was started on.
+        SnapshotEnum* snapshotEnum = static_cast<SnapshotEnum*>(*phEnum);
+        if (snapshotEnum != nullptr)
+            return CallUnlocked(method, [&]() { return enumerate(snapshotEnum->Import, &snapshotEnum->Inner); });
+
+        return ReadSnapshot(method, [&](Snapshot* snapshot)
+        {
+            HCORENUM inner = nullptr;
+            HRESULT hr = enumerate(snapshot->Import, &inner);
+            if (inner != nullptr)
+            {
+                SnapshotEnum* newEnum = new (std::nothrow) SnapshotEnum{ inner, snapshot->Owner.p, snapshot->Import };
+                if (newEnum == nullptr)
+                {
+                    snapshot->Import->CloseEnum(inner);
+                    return E_OUTOFMEMORY;
+                }
+                (void)newEnum->Owner->AddRef();
+                *phEnum = newEnum;
+            }
+            return hr;
+        });
+    }
+
+    template<typename TWrite>
+    HRESULT Write(ThreadSafeMethod method, TWrite write)
+    {
+        if (_statistics != nullptr)
+            return CallWithStatistics(method, this->_lock.GetWriteLock(), [&]() { return WriteLocked(write); });
+
+        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
+        return WriteLocked(write);
+    }
+
+    template<typename TWrite>
+    HRESULT WriteLocked(TWrite write)
+    {
+        HRESULT hr = write(_emit);
+        if (_strategy == DNMDThreadSafetySnapshot)
+            _snapshotStale.store(true, std::memory_order_release);
+        return hr;
+    }
+
 public:
-    ThreadSafeImportEmit(IUnknown* controllingUnknown, dncp::com_ptr<ControllingIUnknown>&& threadUnsafe, TImport* import, TEmit* emit)
+    ThreadSafeImportEmit(IUnknown* controllingUnknown, dncp::com_ptr<ControllingIUnknown>&& threadUnsafe, TImport* import, TEmit* emit, DNMDThreadSafetyStrategy strategy, ThreadSafeStatistics* statistics)
         : TearOffBase(controllingUnknown)
+        , _strategy{ strategy }
         , _lock { }
         , _threadUnsafe{ std::move(threadUnsafe) }
         , _import{ import }
         , _emit{ emit }
+        , _statistics{ statistics }
+        , _snapshot{ nullptr }
+        , _snapshotStale{ true }
+        , _retiredSnapshots{ }
     {
         assert(_threadUnsafe.p != nullptr);
         assert(_import != nullptr);
         assert(_emit != nullptr);
     }
 
-    virtual ~ThreadSafeImportEmit() = default;
+    virtual ~ThreadSafeImportEmit()
+    {
+        // There are no readers left, so all snapshots can be destroyed.
+        // Enumerators that are still open keep their own snapshot alive.
+        delete _snapshot.load();
+    }
 
 public: // IMetaDataImport
     STDMETHOD_(void, CloseEnum)(HCORENUM hEnum) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->CloseEnum(hEnum);
+        if (_strategy == DNMDThreadSafetyLock)
+        {
+            (void)Read(ThreadSafeMethod::CloseEnum, [&](TImport* importImpl) { importImpl->CloseEnum(hEnum); return S_OK; });
+            return;
+        }
+
+        SnapshotEnum* snapshotEnum = static_cast<SnapshotEnum*>(hEnum);
+        if (snapshotEnum == nullptr)
+            return;
+
+        (void)CallUnlocked(ThreadSafeMethod::CloseEnum, [&]() { snapshotEnum->Import->CloseEnum(snapshotEnum->Inner); return S_OK; });
+        (void)snapshotEnum->Owner->Release();
+        delete snapshotEnum;
     }
 
     STDMETHOD(CountEnum)(HCORENUM hEnum, ULONG *pulCount) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->CountEnum(hEnum, pulCount);
+        if (_strategy == DNMDThreadSafetySnapshot && hEnum != nullptr)
+        {
+            SnapshotEnum* snapshotEnum = static_cast<SnapshotEnum*>(hEnum);
+            return CallUnlocked(ThreadSafeMethod::CountEnum, [&]() { return snapshotEnum->Import->CountEnum(snapshotEnum->Inner, pulCount); });
+        }
+        return Read(ThreadSafeMethod::CountEnum, [&](TImport* importImpl) { return importImpl->CountEnum(hEnum, pulCount); });
     }
 
     STDMETHOD(ResetEnum)(HCORENUM hEnum, ULONG ulPos) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->ResetEnum(hEnum, ulPos);
+        if (_strategy == DNMDThreadSafetySnapshot && hEnum != nullptr)
+        {
+            SnapshotEnum* snapshotEnum = static_cast<SnapshotEnum*>(hEnum);
+            return CallUnlocked(ThreadSafeMethod::ResetEnum, [&]() { return snapshotEnum->Import->ResetEnum(snapshotEnum->Inner, ulPos); });
+        }
+        return Read(ThreadSafeMethod::ResetEnum, [&](TImport* importImpl) { return importImpl->ResetEnum(hEnum, ulPos); });
     }
 
     STDMETHOD(EnumTypeDefs)(HCORENUM *phEnum, mdTypeDef rTypeDefs[],
                             ULONG cMax, ULONG *pcTypeDefs) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumTypeDefs(phEnum, rTypeDefs, cMax, pcTypeDefs);
+        return ReadEnum(ThreadSafeMethod::EnumTypeDefs, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumTypeDefs(phInnerEnum, rTypeDefs, cMax, pcTypeDefs); });
     }
 
     STDMETHOD(EnumInterfaceImpls)(HCORENUM *phEnum, mdTypeDef td,
                             mdInterfaceImpl rImpls[], ULONG cMax,
                             ULONG* pcImpls) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumInterfaceImpls(phEnum, td, rImpls, cMax, pcImpls);
+        return ReadEnum(ThreadSafeMethod::EnumInterfaceImpls, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumInterfaceImpls(phInnerEnum, td, rImpls, cMax, pcImpls); });
     }
 
     STDMETHOD(EnumTypeRefs)(HCORENUM *phEnum, mdTypeRef rTypeRefs[],
                             ULONG cMax, ULONG* pcTypeRefs) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumTypeRefs(phEnum, rTypeRefs, cMax, pcTypeRefs);
+        return ReadEnum(ThreadSafeMethod::EnumTypeRefs, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumTypeRefs(phInnerEnum, rTypeRefs, cMax, pcTypeRefs); });
     }
 
     STDMETHOD(FindTypeDefByName)(
@@ -142,8 +379,7 @@ public: // IMetaDataImport
         mdToken     tkEnclosingClass,
         mdTypeDef   *ptd) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->FindTypeDefByName(szTypeDef, tkEnclosingClass, ptd);
+        return Read(ThreadSafeMethod::FindTypeDefByName, [&](TImport* importImpl) { return importImpl->FindTypeDefByName(szTypeDef, tkEnclosingClass, ptd); });
     }
 
     STDMETHOD(GetScopeProps)(
@@ -153,15 +389,13 @@ public: // IMetaDataImport
         ULONG       *pchName,
         GUID        *pmvid) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetScopeProps(szName, cchName, pchName, pmvid);
+        return Read(ThreadSafeMethod::GetScopeProps, [&](TImport* importImpl) { return importImpl->GetScopeProps(szName, cchName, pchName, pmvid); });
     }
 
     STDMETHOD(GetModuleFromScope)(
         mdModule    *pmd) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetModuleFromScope(pmd);
+        return Read(ThreadSafeMethod::GetModuleFromScope, [&](TImport* importImpl) { return importImpl->GetModuleFromScope(pmd); });
     }
 
     STDMETHOD(GetTypeDefProps)(
@@ -173,8 +407,7 @@ public: // IMetaDataImport
         DWORD       *pdwTypeDefFlags,
         mdToken     *ptkExtends) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetTypeDefProps(td, szTypeDef, cchTypeDef, pchTypeDef, pdwTypeDefFlags, ptkExtends);
+        return Read(ThreadSafeMethod::GetTypeDefProps, [&](TImport* importImpl) { return importImpl->GetTypeDefProps(td, szTypeDef, cchTypeDef, pchTypeDef, pdwTypeDefFlags, ptkExtends); });
     }
 
     STDMETHOD(GetInterfaceImplProps)(
@@ -182,8 +415,7 @@ public: // IMetaDataImport
         mdTypeDef   *pClass,
         mdToken     *ptkIface) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetInterfaceImplProps(iiImpl, pClass, ptkIface);
+        return Read(ThreadSafeMethod::GetInterfaceImplProps, [&](TImport* importImpl) { return importImpl->GetInterfaceImplProps(iiImpl, pClass, ptkIface); });
     }
 
     STDMETHOD(GetTypeRefProps)(
@@ -194,14 +426,12 @@ public: // IMetaDataImport
         ULONG       cchName,
         ULONG       *pchName) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetTypeRefProps(tr, ptkResolutionScope, szName, cchName, pchName);
+        return Read(ThreadSafeMethod::GetTypeRefProps, [&](TImport* importImpl) { return importImpl->GetTypeRefProps(tr, ptkResolutionScope, szName, cchName, pchName); });
     }
 
     STDMETHOD(ResolveTypeRef)(mdTypeRef tr, REFIID riid, IUnknown **ppIScope, mdTypeDef *ptd) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->ResolveTypeRef(tr, riid, ppIScope, ptd);
+        return Read(ThreadSafeMethod::ResolveTypeRef, [&](TImport* importImpl) { return importImpl->ResolveTypeRef(tr, riid, ppIScope, ptd); });
     }
 
     STDMETHOD(EnumMembers)(
@@ -211,8 +441,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumMembers(phEnum, cl, rMembers, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumMembers, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumMembers(phInnerEnum, cl, rMembers, cMax, pcTokens); });
     }
 
     STDMETHOD(EnumMembersWithName)(
@@ -223,8 +452,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumMembersWithName(phEnum, cl, szName, rMembers, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumMembersWithName, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumMembersWithName(phInnerEnum, cl, szName, rMembers, cMax, pcTokens); });
     }
 
     STDMETHOD(EnumMethods)(
@@ -234,8 +462,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumMethods(phEnum, cl, rMethods, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumMethods, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumMethods(phInnerEnum, cl, rMethods, cMax, pcTokens); });
     }
 
     STDMETHOD(EnumMethodsWithName)(
@@ -246,8 +473,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumMethodsWithName(phEnum, cl, szName, rMethods, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumMethodsWithName, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumMethodsWithName(phInnerEnum, cl, szName, rMethods, cMax, pcTokens); });
     }
 
     STDMETHOD(EnumFields)(
@@ -257,8 +483,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumFields(phEnum, cl, rFields, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumFields, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumFields(phInnerEnum, cl, rFields, cMax, pcTokens); });
     }
 
     STDMETHOD(EnumFieldsWithName)(
@@ -269,8 +494,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumFieldsWithName(phEnum, cl, szName, rFields, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumFieldsWithName, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumFieldsWithName(phInnerEnum, cl, szName, rFields, cMax, pcTokens); });
     }
 
     STDMETHOD(EnumParams)(
@@ -280,8 +504,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumParams(phEnum, mb, rParams, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumParams, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumParams(phInnerEnum, mb, rParams, cMax, pcTokens); });
     }
 
     STDMETHOD(EnumMemberRefs)(
@@ -291,8 +514,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumMemberRefs(phEnum, tkParent, rMemberRefs, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumMemberRefs, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumMemberRefs(phInnerEnum, tkParent, rMemberRefs, cMax, pcTokens); });
     }
 
     STDMETHOD(EnumMethodImpls)(
@@ -303,8 +525,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumMethodImpls(phEnum, td, rMethodBody, rMethodDecl, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumMethodImpls, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumMethodImpls(phInnerEnum, td, rMethodBody, rMethodDecl, cMax, pcTokens); });
     }
 
     STDMETHOD(EnumPermissionSets)(
@@ -315,8 +536,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumPermissionSets(phEnum, tk, dwActions, rPermission, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumPermissionSets, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumPermissionSets(phInnerEnum, tk, dwActions, rPermission, cMax, pcTokens); });
     }
 
     STDMETHOD(FindMember)(
@@ -326,8 +546,7 @@ public: // IMetaDataImport
         ULONG       cbSigBlob,
         mdToken     *pmb) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->FindMember(td, szName, pvSigBlob, cbSigBlob, pmb);
+        return Read(ThreadSafeMethod::FindMember, [&](TImport* importImpl) { return importImpl->FindMember(td, szName, pvSigBlob, cbSigBlob, pmb); });
     }
 
     STDMETHOD(FindMethod)(
@@ -337,8 +556,7 @@ public: // IMetaDataImport
         ULONG       cbSigBlob,
         mdMethodDef *pmb) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->FindMethod(td, szName, pvSigBlob, cbSigBlob, pmb);
+        return Read(ThreadSafeMethod::FindMethod, [&](TImport* importImpl) { return importImpl->FindMethod(td, szName, pvSigBlob, cbSigBlob, pmb); });
     }
 
     STDMETHOD(FindField)(
@@ -348,8 +566,7 @@ public: // IMetaDataImport
         ULONG       cbSigBlob,
         mdFieldDef  *pmb) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->FindField(td, szName, pvSigBlob, cbSigBlob, pmb);
+        return Read(ThreadSafeMethod::FindField, [&](TImport* importImpl) { return importImpl->FindField(td, szName, pvSigBlob, cbSigBlob, pmb); });
     }
 
     STDMETHOD(FindMemberRef)(
@@ -359,8 +576,7 @@ public: // IMetaDataImport
         ULONG       cbSigBlob,
         mdMemberRef *pmr) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->FindMemberRef(td, szName, pvSigBlob, cbSigBlob, pmr);
+        return Read(ThreadSafeMethod::FindMemberRef, [&](TImport* importImpl) { return importImpl->FindMemberRef(td, szName, pvSigBlob, cbSigBlob, pmr); });
     }
 
     STDMETHOD (GetMethodProps)(
@@ -376,8 +592,7 @@ public: // IMetaDataImport
         ULONG       *pulCodeRVA,
         DWORD       *pdwImplFlags) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetMethodProps(mb, pClass, szMethod, cchMethod, pchMethod, pdwAttr, ppvSigBlob, pcbSigBlob, pulCodeRVA, pdwImplFlags);
+        return Read(ThreadSafeMethod::GetMethodProps, [&](TImport* importImpl) { return importImpl->GetMethodProps(mb, pClass, szMethod, cchMethod, pchMethod, pdwAttr, ppvSigBlob, pcbSigBlob, pulCodeRVA, pdwImplFlags); });
     }
 
     STDMETHOD(GetMemberRefProps)(
@@ -390,8 +605,7 @@ public: // IMetaDataImport
         PCCOR_SIGNATURE *ppvSigBlob,
         ULONG       *pbSig) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetMemberRefProps(mr, ptk, szMember, cchMember, pchMember, ppvSigBlob, pbSig);
+        return Read(ThreadSafeMethod::GetMemberRefProps, [&](TImport* importImpl) { return importImpl->GetMemberRefProps(mr, ptk, szMember, cchMember, pchMember, ppvSigBlob, pbSig); });
     }
 
     STDMETHOD(EnumProperties)(
@@ -401,8 +615,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcProperties) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumProperties(phEnum, td, rProperties, cMax, pcProperties);
+        return ReadEnum(ThreadSafeMethod::EnumProperties, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumProperties(phInnerEnum, td, rProperties, cMax, pcProperties); });
     }
 
     STDMETHOD(EnumEvents)(
@@ -412,8 +625,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcEvents) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumEvents(phEnum, td, rEvents, cMax, pcEvents);
+        return ReadEnum(ThreadSafeMethod::EnumEvents, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumEvents(phInnerEnum, td, rEvents, cMax, pcEvents); });
     }
 
     STDMETHOD(GetEventProps)(
@@ -431,8 +643,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcOtherMethod) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetEventProps(ev, pClass, szEvent, cchEvent, pchEvent, pdwEventFlags, ptkEventType, pmdAddOn, pmdRemoveOn, pmdFire, rmdOtherMethod, cMax, pcOtherMethod);
+        return Read(ThreadSafeMethod::GetEventProps, [&](TImport* importImpl) { return importImpl->GetEventProps(ev, pClass, szEvent, cchEvent, pchEvent, pdwEventFlags, ptkEventType, pmdAddOn, pmdRemoveOn, pmdFire, rmdOtherMethod, cMax, pcOtherMethod); });
     }
 
     STDMETHOD(EnumMethodSemantics)(
@@ -442,8 +653,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcEventProp) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumMethodSemantics(phEnum, mb, rEventProp, cMax, pcEventProp);
+        return ReadEnum(ThreadSafeMethod::EnumMethodSemantics, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumMethodSemantics(phInnerEnum, mb, rEventProp, cMax, pcEventProp); });
     }
 
     STDMETHOD(GetMethodSemantics)(
@@ -451,8 +661,7 @@ public: // IMetaDataImport
         mdToken     tkEventProp,
         DWORD       *pdwSemanticsFlags) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetMethodSemantics(mb, tkEventProp, pdwSemanticsFlags);
+        return Read(ThreadSafeMethod::GetMethodSemantics, [&](TImport* importImpl) { return importImpl->GetMethodSemantics(mb, tkEventProp, pdwSemanticsFlags); });
     }
 
     STDMETHOD(GetClassLayout) (
@@ -463,8 +672,7 @@ public: // IMetaDataImport
         ULONG       *pcFieldOffset,
         ULONG       *pulClassSize) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetClassLayout(td, pdwPackSize, rFieldOffset, cMax, pcFieldOffset, pulClassSize);
+        return Read(ThreadSafeMethod::GetClassLayout, [&](TImport* importImpl) { return importImpl->GetClassLayout(td, pdwPackSize, rFieldOffset, cMax, pcFieldOffset, pulClassSize); });
     }
 
     STDMETHOD(GetFieldMarshal) (
@@ -472,8 +680,7 @@ public: // IMetaDataImport
         PCCOR_SIGNATURE *ppvNativeType,
         ULONG       *pcbNativeType) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetFieldMarshal(tk, ppvNativeType, pcbNativeType);
+        return Read(ThreadSafeMethod::GetFieldMarshal, [&](TImport* importImpl) { return importImpl->GetFieldMarshal(tk, ppvNativeType, pcbNativeType); });
     }
 
     STDMETHOD(GetRVA)(
@@ -481,8 +688,7 @@ public: // IMetaDataImport
         ULONG       *pulCodeRVA,
         DWORD       *pdwImplFlags) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetRVA(tk, pulCodeRVA, pdwImplFlags);
+        return Read(ThreadSafeMethod::GetRVA, [&](TImport* importImpl) { return importImpl->GetRVA(tk, pulCodeRVA, pdwImplFlags); });
     }
 
     STDMETHOD(GetPermissionSetProps) (
@@ -491,8 +697,7 @@ public: // IMetaDataImport
         void const  **ppvPermission,
         ULONG       *pcbPermission) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetPermissionSetProps(pm, pdwAction, ppvPermission, pcbPermission);
+        return Read(ThreadSafeMethod::GetPermissionSetProps, [&](TImport* importImpl) { return importImpl->GetPermissionSetProps(pm, pdwAction, ppvPermission, pcbPermission); });
     }
 
     STDMETHOD(GetSigFromToken)(
@@ -500,8 +705,7 @@ public: // IMetaDataImport
         PCCOR_SIGNATURE *ppvSig,
         ULONG       *pcbSig) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetSigFromToken(mdSig, ppvSig, pcbSig);
+        return Read(ThreadSafeMethod::GetSigFromToken, [&](TImport* importImpl) { return importImpl->GetSigFromToken(mdSig, ppvSig, pcbSig); });
     }
 
     STDMETHOD(GetModuleRefProps)(
@@ -511,8 +715,7 @@ public: // IMetaDataImport
         ULONG       cchName,
         ULONG       *pchName) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetModuleRefProps(mur, szName, cchName, pchName);
+        return Read(ThreadSafeMethod::GetModuleRefProps, [&](TImport* importImpl) { return importImpl->GetModuleRefProps(mur, szName, cchName, pchName); });
     }
 
     STDMETHOD(EnumModuleRefs)(
@@ -521,8 +724,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcModuleRefs) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumModuleRefs(phEnum, rModuleRefs, cMax, pcModuleRefs);
+        return ReadEnum(ThreadSafeMethod::EnumModuleRefs, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumModuleRefs(phInnerEnum, rModuleRefs, cMax, pcModuleRefs); });
     }
 
     STDMETHOD(GetTypeSpecFromToken)(
@@ -530,16 +732,14 @@ public: // IMetaDataImport
         PCCOR_SIGNATURE *ppvSig,
         ULONG       *pcbSig) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetTypeSpecFromToken(typespec, ppvSig, pcbSig);
+        return Read(ThreadSafeMethod::GetTypeSpecFromToken, [&](TImport* importImpl) { return importImpl->GetTypeSpecFromToken(typespec, ppvSig, pcbSig); });
     }
 
     STDMETHOD(GetNameFromToken)(            // Not Recommended! May be removed!
         mdToken     tk,
         MDUTF8CSTR  *pszUtf8NamePtr) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetNameFromToken(tk, pszUtf8NamePtr);
+        return Read(ThreadSafeMethod::GetNameFromToken, [&](TImport* importImpl) { return importImpl->GetNameFromToken(tk, pszUtf8NamePtr); });
     }
 
     STDMETHOD(EnumUnresolvedMethods)(
@@ -548,8 +748,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumUnresolvedMethods(phEnum, rMethods, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumUnresolvedMethods, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumUnresolvedMethods(phInnerEnum, rMethods, cMax, pcTokens); });
     }
 
     STDMETHOD(GetUserString)(
@@ -559,8 +758,7 @@ public: // IMetaDataImport
         ULONG       cchString,
         ULONG       *pchString) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetUserString(stk, szString, cchString, pchString);
+        return Read(ThreadSafeMethod::GetUserString, [&](TImport* importImpl) { return importImpl->GetUserString(stk, szString, cchString, pchString); });
     }
 
     STDMETHOD(GetPinvokeMap)(
@@ -572,8 +770,7 @@ public: // IMetaDataImport
         ULONG       *pchImportName,
         mdModuleRef *pmrImportDLL) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetPinvokeMap(tk, pdwMappingFlags, szImportName, cchImportName, pchImportName, pmrImportDLL);
+        return Read(ThreadSafeMethod::GetPinvokeMap, [&](TImport* importImpl) { return importImpl->GetPinvokeMap(tk, pdwMappingFlags, szImportName, cchImportName, pchImportName, pmrImportDLL); });
     }
 
     STDMETHOD(EnumSignatures)(
@@ -582,8 +779,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcSignatures) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumSignatures(phEnum, rSignatures, cMax, pcSignatures);
+        return ReadEnum(ThreadSafeMethod::EnumSignatures, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumSignatures(phInnerEnum, rSignatures, cMax, pcSignatures); });
     }
 
     STDMETHOD(EnumTypeSpecs)(
@@ -592,8 +788,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcTypeSpecs) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumTypeSpecs(phEnum, rTypeSpecs, cMax, pcTypeSpecs);
+        return ReadEnum(ThreadSafeMethod::EnumTypeSpecs, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumTypeSpecs(phInnerEnum, rTypeSpecs, cMax, pcTypeSpecs); });
     }
 
     STDMETHOD(EnumUserStrings)(
@@ -602,8 +797,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcStrings) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumUserStrings(phEnum, rStrings, cMax, pcStrings);
+        return ReadEnum(ThreadSafeMethod::EnumUserStrings, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumUserStrings(phInnerEnum, rStrings, cMax, pcStrings); });
     }
 
     STDMETHOD(GetParamForMethodIndex)(
@@ -611,8 +805,7 @@ public: // IMetaDataImport
         ULONG       ulParamSeq,
         mdParamDef  *ppd) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetParamForMethodIndex(md, ulParamSeq, ppd);
+        return Read(ThreadSafeMethod::GetParamForMethodIndex, [&](TImport* importImpl) { return importImpl->GetParamForMethodIndex(md, ulParamSeq, ppd); });
     }
 
     STDMETHOD(EnumCustomAttributes)(
@@ -623,8 +816,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcCustomAttributes) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumCustomAttributes(phEnum, tk, tkType, rCustomAttributes, cMax, pcCustomAttributes);
+        return ReadEnum(ThreadSafeMethod::EnumCustomAttributes, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumCustomAttributes(phInnerEnum, tk, tkType, rCustomAttributes, cMax, pcCustomAttributes); });
     }
 
     STDMETHOD(GetCustomAttributeProps)(
@@ -634,8 +826,7 @@ public: // IMetaDataImport
         void const  **ppBlob,
         ULONG       *pcbSize) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetCustomAttributeProps(cv, ptkObj, ptkType, ppBlob, pcbSize);
+        return Read(ThreadSafeMethod::GetCustomAttributeProps, [&](TImport* importImpl) { return importImpl->GetCustomAttributeProps(cv, ptkObj, ptkType, ppBlob, pcbSize); });
     }
 
     STDMETHOD(FindTypeRef)(
@@ -643,8 +834,7 @@ public: // IMetaDataImport
         LPCWSTR     szName,
         mdTypeRef   *ptr) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->FindTypeRef(tkResolutionScope, szName, ptr);
+        return Read(ThreadSafeMethod::FindTypeRef, [&](TImport* importImpl) { return importImpl->FindTypeRef(tkResolutionScope, szName, ptr); });
     }
 
     STDMETHOD(GetMemberProps)(
@@ -663,8 +853,7 @@ public: // IMetaDataImport
         UVCP_CONSTANT *ppValue,
         ULONG       *pcchValue) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetMemberProps(mb, pClass, szMember, cchMember, pchMember, pdwAttr, ppvSigBlob, pcbSigBlob, pulCodeRVA, pdwImplFlags, pdwCPlusTypeFlag, ppValue, pcchValue);
+        return Read(ThreadSafeMethod::GetMemberProps, [&](TImport* importImpl) { return importImpl->GetMemberProps(mb, pClass, szMember, cchMember, pchMember, pdwAttr, ppvSigBlob, pcbSigBlob, pulCodeRVA, pdwImplFlags, pdwCPlusTypeFlag, ppValue, pcchValue); });
     }
 
     STDMETHOD(GetFieldProps)(
@@ -681,8 +870,7 @@ public: // IMetaDataImport
         UVCP_CONSTANT *ppValue,
         ULONG       *pcchValue) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetFieldProps(mb, pClass, szField, cchField, pchField, pdwAttr, ppvSigBlob, pcbSigBlob, pdwCPlusTypeFlag, ppValue, pcchValue);
+        return Read(ThreadSafeMethod::GetFieldProps, [&](TImport* importImpl) { return importImpl->GetFieldProps(mb, pClass, szField, cchField, pchField, pdwAttr, ppvSigBlob, pcbSigBlob, pdwCPlusTypeFlag, ppValue, pcchValue); });
     }
 
     STDMETHOD(GetPropertyProps)(
@@ -703,8 +891,7 @@ public: // IMetaDataImport
         ULONG       cMax,
         ULONG       *pcOtherMethod) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetPropertyProps(prop, pClass, szProperty, cchProperty, pchProperty, pdwPropFlags, ppvSig, pbSig, pdwCPlusTypeFlag, ppDefaultValue, pcchDefaultValue, pmdSetter, pmdGetter, rmdOtherMethod, cMax, pcOtherMethod);
+        return Read(ThreadSafeMethod::GetPropertyProps, [&](TImport* importImpl) { return importImpl->GetPropertyProps(prop, pClass, szProperty, cchProperty, pchProperty, pdwPropFlags, ppvSig, pbSig, pdwCPlusTypeFlag, ppDefaultValue, pcchDefaultValue, pmdSetter, pmdGetter, rmdOtherMethod, cMax, pcOtherMethod); });
     }
 
     STDMETHOD(GetParamProps)(
@@ -720,8 +907,7 @@ public: // IMetaDataImport
         UVCP_CONSTANT *ppValue,
         ULONG       *pcchValue) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetParamProps(tk, pmd, pulSequence, szName, cchName, pchName, pdwAttr, pdwCPlusTypeFlag, ppValue, pcchValue);
+        return Read(ThreadSafeMethod::GetParamProps, [&](TImport* importImpl) { return importImpl->GetParamProps(tk, pmd, pulSequence, szName, cchName, pchName, pdwAttr, pdwCPlusTypeFlag, ppValue, pcchValue); });
     }
 
     STDMETHOD(GetCustomAttributeByName)(
@@ -730,23 +916,23 @@ public: // IMetaDataImport
         void const**  ppData,
         ULONG       *pcbData) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetCustomAttributeByName(tkObj, szName, ppData, pcbData);
+        return Read(ThreadSafeMethod::GetCustomAttributeByName, [&](TImport* importImpl) { return importImpl->GetCustomAttributeByName(tkObj, szName, ppData, pcbData); });
     }
 
     STDMETHOD_(BOOL, IsValidToken)(
         mdToken     tk) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->IsValidToken(tk);
+        // A token can't be validated if the snapshot can't be published, so it is treated as invalid.
+        BOOL isValid = FALSE;
+        (void)Read(ThreadSafeMethod::IsValidToken, [&](TImport* importImpl) { isValid = importImpl->IsValidToken(tk); return S_OK; });
+        return isValid;
     }
 
     STDMETHOD(GetNestedClassProps)(
         mdTypeDef   tdNestedClass,
         mdTypeDef   *ptdEnclosingClass) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetNestedClassProps(tdNestedClass, ptdEnclosingClass);
+        return Read(ThreadSafeMethod::GetNestedClassProps, [&](TImport* importImpl) { return importImpl->GetNestedClassProps(tdNestedClass, ptdEnclosingClass); });
     }
 
     STDMETHOD(GetNativeCallConvFromSig)(
@@ -754,16 +940,14 @@ public: // IMetaDataImport
         ULONG       cbSig,
         ULONG       *pCallConv) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetNativeCallConvFromSig(pvSig, cbSig, pCallConv);
+        return Read(ThreadSafeMethod::GetNativeCallConvFromSig, [&](TImport* importImpl) { return importImpl->GetNativeCallConvFromSig(pvSig, cbSig, pCallConv); });
     }
 
     STDMETHOD(IsGlobal)(
         mdToken     pd,
         int         *pbGlobal) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->IsGlobal(pd, pbGlobal);
+        return Read(ThreadSafeMethod::IsGlobal, [&](TImport* importImpl) { return importImpl->IsGlobal(pd, pbGlobal); });
     }
 
 public: // IMetaDataImport2
@@ -774,8 +958,7 @@ public: // IMetaDataImport2
         ULONG       cMax,
         ULONG       *pcGenericParams) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumGenericParams(phEnum, tk, rGenericParams, cMax, pcGenericParams);
+        return ReadEnum(ThreadSafeMethod::EnumGenericParams, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumGenericParams(phInnerEnum, tk, rGenericParams, cMax, pcGenericParams); });
     }
 
     STDMETHOD(GetGenericParamProps)(
@@ -789,8 +972,7 @@ public: // IMetaDataImport2
         ULONG        cchName,
         ULONG        *pchName) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetGenericParamProps(gp, pulParamSeq, pdwParamFlags, ptOwner, reserved, wzname, cchName, pchName);
+        return Read(ThreadSafeMethod::GetGenericParamProps, [&](TImport* importImpl) { return importImpl->GetGenericParamProps(gp, pulParamSeq, pdwParamFlags, ptOwner, reserved, wzname, cchName, pchName); });
     }
 
     STDMETHOD(GetMethodSpecProps)(
@@ -799,8 +981,7 @@ public: // IMetaDataImport2
         PCCOR_SIGNATURE *ppvSigBlob,
         ULONG       *pcbSigBlob) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetMethodSpecProps(mi, tkParent, ppvSigBlob, pcbSigBlob);
+        return Read(ThreadSafeMethod::GetMethodSpecProps, [&](TImport* importImpl) { return importImpl->GetMethodSpecProps(mi, tkParent, ppvSigBlob, pcbSigBlob); });
     }
 
     STDMETHOD(EnumGenericParamConstraints)(
@@ -810,8 +991,7 @@ public: // IMetaDataImport2
         ULONG       cMax,
         ULONG       *pcGenericParamConstraints) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumGenericParamConstraints(phEnum, tk, rGenericParamConstraints, cMax, pcGenericParamConstraints);
+        return ReadEnum(ThreadSafeMethod::EnumGenericParamConstraints, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumGenericParamConstraints(phInnerEnum, tk, rGenericParamConstraints, cMax, pcGenericParamConstraints); });
     }
 
     STDMETHOD(GetGenericParamConstraintProps)(
@@ -819,16 +999,14 @@ public: // IMetaDataImport2
         mdGenericParam *ptGenericParam,
         mdToken      *ptkConstraintType) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetGenericParamConstraintProps(gpc, ptGenericParam, ptkConstraintType);
+        return Read(ThreadSafeMethod::GetGenericParamConstraintProps, [&](TImport* importImpl) { return importImpl->GetGenericParamConstraintProps(gpc, ptGenericParam, ptkConstraintType); });
     }
 
     STDMETHOD(GetPEKind)(
         DWORD* pdwPEKind,
         DWORD* pdwMAchine) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetPEKind(pdwPEKind, pdwMAchine);
+        return Read(ThreadSafeMethod::GetPEKind, [&](TImport* importImpl) { return importImpl->GetPEKind(pdwPEKind, pdwMAchine); });
     }
 
     STDMETHOD(GetVersionString)(
@@ -837,8 +1015,7 @@ public: // IMetaDataImport2
         DWORD       ccBufSize,
         DWORD       *pccBufSize) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetVersionString(pwzBuf, ccBufSize, pccBufSize);
+        return Read(ThreadSafeMethod::GetVersionString, [&](TImport* importImpl) { return importImpl->GetVersionString(pwzBuf, ccBufSize, pccBufSize); });
     }
 
     STDMETHOD(EnumMethodSpecs)(
@@ -848,8 +1025,7 @@ public: // IMetaDataImport2
         ULONG       cMax,
         ULONG       *pcMethodSpecs) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumMethodSpecs(phEnum, tk, rMethodSpecs, cMax, pcMethodSpecs);
+        return ReadEnum(ThreadSafeMethod::EnumMethodSpecs, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumMethodSpecs(phInnerEnum, tk, rMethodSpecs, cMax, pcMethodSpecs); });
     }
 
 public: // IMetaDataAssemblyImport
@@ -864,8 +1040,7 @@ public: // IMetaDataAssemblyImport
         ASSEMBLYMETADATA* pMetaData,
         DWORD* pdwAssemblyFlags) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetAssemblyProps(mda, ppbPublicKey, pcbPublicKey, pulHashAlgId, szName, cchName, pchName, pMetaData, pdwAssemblyFlags);
+        return Read(ThreadSafeMethod::GetAssemblyProps, [&](TImport* importImpl) { return importImpl->GetAssemblyProps(mda, ppbPublicKey, pcbPublicKey, pulHashAlgId, szName, cchName, pchName, pMetaData, pdwAssemblyFlags); });
     }
 
     STDMETHOD(GetAssemblyRefProps)(
@@ -880,8 +1055,7 @@ public: // IMetaDataAssemblyImport
         ULONG* pcbHashValue,
         DWORD* pdwAssemblyRefFlags) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetAssemblyRefProps(mdar, ppbPublicKeyOrToken, pcbPublicKeyOrToken, szName, cchName, pchName, pMetaData, ppbHashValue, pcbHashValue, pdwAssemblyRefFlags);
+        return Read(ThreadSafeMethod::GetAssemblyRefProps, [&](TImport* importImpl) { return importImpl->GetAssemblyRefProps(mdar, ppbPublicKeyOrToken, pcbPublicKeyOrToken, szName, cchName, pchName, pMetaData, ppbHashValue, pcbHashValue, pdwAssemblyRefFlags); });
     }
 
     STDMETHOD(GetFileProps)(
@@ -893,8 +1067,7 @@ public: // IMetaDataAssemblyImport
         ULONG* pcbHashValue,
         DWORD* pdwFileFlags) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetFileProps(mdf, szName, cchName, pchName, ppbHashValue, pcbHashValue, pdwFileFlags);
+        return Read(ThreadSafeMethod::GetFileProps, [&](TImport* importImpl) { return importImpl->GetFileProps(mdf, szName, cchName, pchName, ppbHashValue, pcbHashValue, pdwFileFlags); });
     }
 
     STDMETHOD(GetExportedTypeProps)(
@@ -906,8 +1079,7 @@ public: // IMetaDataAssemblyImport
         mdTypeDef* ptkTypeDef,
         DWORD* pdwExportedTypeFlags) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetExportedTypeProps(mdct, szName, cchName, pchName, ptkImplementation, ptkTypeDef, pdwExportedTypeFlags);
+        return Read(ThreadSafeMethod::GetExportedTypeProps, [&](TImport* importImpl) { return importImpl->GetExportedTypeProps(mdct, szName, cchName, pchName, ptkImplementation, ptkTypeDef, pdwExportedTypeFlags); });
     }
 
     STDMETHOD(GetManifestResourceProps)(
@@ -919,8 +1091,7 @@ public: // IMetaDataAssemblyImport
         DWORD* pdwOffset,
         DWORD* pdwResourceFlags) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetManifestResourceProps(mdmr, szName, cchName, pchName, ptkImplementation, pdwOffset, pdwResourceFlags);
+        return Read(ThreadSafeMethod::GetManifestResourceProps, [&](TImport* importImpl) { return importImpl->GetManifestResourceProps(mdmr, szName, cchName, pchName, ptkImplementation, pdwOffset, pdwResourceFlags); });
     }
 
     STDMETHOD(EnumAssemblyRefs)(
@@ -929,8 +1100,7 @@ public: // IMetaDataAssemblyImport
         ULONG       cMax,
         ULONG* pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumAssemblyRefs(phEnum, rAssemblyRefs, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumAssemblyRefs, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumAssemblyRefs(phInnerEnum, rAssemblyRefs, cMax, pcTokens); });
     }
 
     STDMETHOD(EnumFiles)(
@@ -939,8 +1109,7 @@ public: // IMetaDataAssemblyImport
         ULONG       cMax,
         ULONG* pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumFiles(phEnum, rFiles, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumFiles, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumFiles(phInnerEnum, rFiles, cMax, pcTokens); });
     }
 
     STDMETHOD(EnumExportedTypes)(
@@ -949,8 +1118,7 @@ public: // IMetaDataAssemblyImport
         ULONG       cMax,
         ULONG* pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumExportedTypes(phEnum, rExportedTypes, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumExportedTypes, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumExportedTypes(phInnerEnum, rExportedTypes, cMax, pcTokens); });
     }
 
     STDMETHOD(EnumManifestResources)(
@@ -959,15 +1127,13 @@ public: // IMetaDataAssemblyImport
         ULONG       cMax,
         ULONG* pcTokens) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->EnumManifestResources(phEnum, rManifestResources, cMax, pcTokens);
+        return ReadEnum(ThreadSafeMethod::EnumManifestResources, phEnum, [&](TImport* importImpl, HCORENUM* phInnerEnum) { return importImpl->EnumManifestResources(phInnerEnum, rManifestResources, cMax, pcTokens); });
     }
 
     STDMETHOD(GetAssemblyFromScope)(
         mdAssembly* ptkAssembly) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->GetAssemblyFromScope(ptkAssembly);
+        return Read(ThreadSafeMethod::GetAssemblyFromScope, [&](TImport* importImpl) { return importImpl->GetAssemblyFromScope(ptkAssembly); });
     }
 
     STDMETHOD(FindExportedTypeByName)(
@@ -975,16 +1141,14 @@ public: // IMetaDataAssemblyImport
         mdToken     mdtExportedType,
         mdExportedType* ptkExportedType) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->FindExportedTypeByName(szName, mdtExportedType, ptkExportedType);
+        return Read(ThreadSafeMethod::FindExportedTypeByName, [&](TImport* importImpl) { return importImpl->FindExportedTypeByName(szName, mdtExportedType, ptkExportedType); });
     }
 
     STDMETHOD(FindManifestResourceByName)(
         LPCWSTR     szName,
         mdManifestResource* ptkManifestResource) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->FindManifestResourceByName(szName, ptkManifestResource);
+        return Read(ThreadSafeMethod::FindManifestResourceByName, [&](TImport* importImpl) { return importImpl->FindManifestResourceByName(szName, ptkManifestResource); });
     
     }
 
@@ -996,32 +1160,28 @@ public: // IMetaDataAssemblyImport
         ULONG    cMax,
         ULONG* pcAssemblies) override
     {
-        std::lock_guard<pal::ReadLock> lock { this->_lock.GetReadLock() };
-        return _import->FindAssembliesByName(szAppBase, szPrivateBin, szAssemblyName, ppIUnk, cMax, pcAssemblies);
+        return Read(ThreadSafeMethod::FindAssembliesByName, [&](TImport* importImpl) { return importImpl->FindAssembliesByName(szAppBase, szPrivateBin, szAssemblyName, ppIUnk, cMax, pcAssemblies); });
     }
 
 public: // IMetaDataEmit
     STDMETHOD(SetModuleProps)(
         LPCWSTR     szName) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetModuleProps(szName);
+        return Write(ThreadSafeMethod::SetModuleProps, [&](TEmit* emitImpl) { return emitImpl->SetModuleProps(szName); });
     }
 
     STDMETHOD(Save)(
         LPCWSTR     szFile,
         DWORD       dwSaveFlags) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->Save(szFile, dwSaveFlags);
+        return Write(ThreadSafeMethod::Save, [&](TEmit* emitImpl) { return emitImpl->Save(szFile, dwSaveFlags); });
     }
 
     STDMETHOD(SaveToStream)(
         IStream     *pIStream,
         DWORD       dwSaveFlags) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SaveToStream(pIStream, dwSaveFlags);
+        return Write(ThreadSafeMethod::SaveToStream, [&](TEmit* emitImpl) { return emitImpl->SaveToStream(pIStream, dwSaveFlags); });
     
     }
 
@@ -1029,8 +1189,7 @@ public: // IMetaDataEmit
         CorSaveSize fSave,
         DWORD       *pdwSaveSize) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->GetSaveSize(fSave, pdwSaveSize);
+        return Write(ThreadSafeMethod::GetSaveSize, [&](TEmit* emitImpl) { return emitImpl->GetSaveSize(fSave, pdwSaveSize); });
     }
 
     STDMETHOD(DefineTypeDef)(
@@ -1040,8 +1199,7 @@ public: // IMetaDataEmit
         mdToken     rtkImplements[],
         mdTypeDef   *ptd) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineTypeDef(szTypeDef, dwTypeDefFlags, tkExtends, rtkImplements, ptd);
+        return Write(ThreadSafeMethod::DefineTypeDef, [&](TEmit* emitImpl) { return emitImpl->DefineTypeDef(szTypeDef, dwTypeDefFlags, tkExtends, rtkImplements, ptd); });
     }
 
     STDMETHOD(DefineNestedType)(
@@ -1052,15 +1210,13 @@ public: // IMetaDataEmit
         mdTypeDef   tdEncloser,
         mdTypeDef   *ptd) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineNestedType(szTypeDef, dwTypeDefFlags, tkExtends, rtkImplements, tdEncloser, ptd);
+        return Write(ThreadSafeMethod::DefineNestedType, [&](TEmit* emitImpl) { return emitImpl->DefineNestedType(szTypeDef, dwTypeDefFlags, tkExtends, rtkImplements, tdEncloser, ptd); });
     }
 
     STDMETHOD(SetHandler)(
         IUnknown    *pUnk) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetHandler(pUnk);
+        return Write(ThreadSafeMethod::SetHandler, [&](TEmit* emitImpl) { return emitImpl->SetHandler(pUnk); });
     }
 
     STDMETHOD(DefineMethod)(
@@ -1073,8 +1229,7 @@ public: // IMetaDataEmit
         DWORD       dwImplFlags,
         mdMethodDef *pmd) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineMethod(td, szName, dwMethodFlags, pvSigBlob, cbSigBlob, ulCodeRVA, dwImplFlags, pmd);
+        return Write(ThreadSafeMethod::DefineMethod, [&](TEmit* emitImpl) { return emitImpl->DefineMethod(td, szName, dwMethodFlags, pvSigBlob, cbSigBlob, ulCodeRVA, dwImplFlags, pmd); });
     }
 
     STDMETHOD(DefineMethodImpl)(
@@ -1082,8 +1237,7 @@ public: // IMetaDataEmit
         mdToken     tkBody,
         mdToken     tkDecl) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineMethodImpl(td, tkBody, tkDecl);
+        return Write(ThreadSafeMethod::DefineMethodImpl, [&](TEmit* emitImpl) { return emitImpl->DefineMethodImpl(td, tkBody, tkDecl); });
     }
 
     STDMETHOD(DefineTypeRefByName)(
@@ -1091,8 +1245,7 @@ public: // IMetaDataEmit
         LPCWSTR     szName,
         mdTypeRef   *ptr) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineTypeRefByName(tkResolutionScope, szName, ptr);
+        return Write(ThreadSafeMethod::DefineTypeRefByName, [&](TEmit* emitImpl) { return emitImpl->DefineTypeRefByName(tkResolutionScope, szName, ptr); });
     }
 
     STDMETHOD(DefineImportType)(
@@ -1104,8 +1257,7 @@ public: // IMetaDataEmit
         IMetaDataAssemblyEmit *pAssemEmit,
         mdTypeRef   *ptr) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineImportType(pAssemImport, pbHashValue, cbHashValue, pImport, tdImport, pAssemEmit, ptr);
+        return Write(ThreadSafeMethod::DefineImportType, [&](TEmit* emitImpl) { return emitImpl->DefineImportType(pAssemImport, pbHashValue, cbHashValue, pImport, tdImport, pAssemEmit, ptr); });
     }
 
     STDMETHOD(DefineMemberRef)(
@@ -1115,8 +1267,7 @@ public: // IMetaDataEmit
         ULONG       cbSigBlob,
         mdMemberRef *pmr) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineMemberRef(tkImport, szName, pvSigBlob, cbSigBlob, pmr);
+        return Write(ThreadSafeMethod::DefineMemberRef, [&](TEmit* emitImpl) { return emitImpl->DefineMemberRef(tkImport, szName, pvSigBlob, cbSigBlob, pmr); });
     }
 
     STDMETHOD(DefineImportMember)(
@@ -1144,8 +1295,7 @@ public: // IMetaDataEmit
         mdMethodDef rmdOtherMethods[],
         mdEvent     *pmdEvent) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineEvent(td, szEvent, dwEventFlags, tkEventType, mdAddOn, mdRemoveOn, mdFire, rmdOtherMethods, pmdEvent);
+        return Write(ThreadSafeMethod::DefineEvent, [&](TEmit* emitImpl) { return emitImpl->DefineEvent(td, szEvent, dwEventFlags, tkEventType, mdAddOn, mdRemoveOn, mdFire, rmdOtherMethods, pmdEvent); });
     }
 
     STDMETHOD(SetClassLayout) (
@@ -1154,15 +1304,13 @@ public: // IMetaDataEmit
         COR_FIELD_OFFSET rFieldOffsets[],
         ULONG       ulClassSize) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetClassLayout(td, dwPackSize, rFieldOffsets, ulClassSize);
+        return Write(ThreadSafeMethod::SetClassLayout, [&](TEmit* emitImpl) { return emitImpl->SetClassLayout(td, dwPackSize, rFieldOffsets, ulClassSize); });
     }
 
     STDMETHOD(DeleteClassLayout) (
         mdTypeDef   td) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DeleteClassLayout(td);
+        return Write(ThreadSafeMethod::DeleteClassLayout, [&](TEmit* emitImpl) { return emitImpl->DeleteClassLayout(td); });
     }
 
     STDMETHOD(SetFieldMarshal) (
@@ -1170,15 +1318,13 @@ public: // IMetaDataEmit
         PCCOR_SIGNATURE pvNativeType,
         ULONG       cbNativeType) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetFieldMarshal(tk, pvNativeType, cbNativeType);
+        return Write(ThreadSafeMethod::SetFieldMarshal, [&](TEmit* emitImpl) { return emitImpl->SetFieldMarshal(tk, pvNativeType, cbNativeType); });
     }
 
     STDMETHOD(DeleteFieldMarshal) (
         mdToken     tk) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DeleteFieldMarshal(tk);
+        return Write(ThreadSafeMethod::DeleteFieldMarshal, [&](TEmit* emitImpl) { return emitImpl->DeleteFieldMarshal(tk); });
     }
 
     STDMETHOD(DefinePermissionSet) (
@@ -1188,16 +1334,14 @@ public: // IMetaDataEmit
         ULONG       cbPermission,
         mdPermission *ppm) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefinePermissionSet(tk, dwAction, pvPermission, cbPermission, ppm);
+        return Write(ThreadSafeMethod::DefinePermissionSet, [&](TEmit* emitImpl) { return emitImpl->DefinePermissionSet(tk, dwAction, pvPermission, cbPermission, ppm); });
     }
 
     STDMETHOD(SetRVA)(
         mdMethodDef md,
         ULONG       ulRVA) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetRVA(md, ulRVA);
+        return Write(ThreadSafeMethod::SetRVA, [&](TEmit* emitImpl) { return emitImpl->SetRVA(md, ulRVA); });
     }
 
     STDMETHOD(GetTokenFromSig)(
@@ -1205,24 +1349,21 @@ public: // IMetaDataEmit
         ULONG       cbSig,
         mdSignature *pmsig) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->GetTokenFromSig(pvSig, cbSig, pmsig);
+        return Write(ThreadSafeMethod::GetTokenFromSig, [&](TEmit* emitImpl) { return emitImpl->GetTokenFromSig(pvSig, cbSig, pmsig); });
     }
 
     STDMETHOD(DefineModuleRef)(
         LPCWSTR     szName,
         mdModuleRef *pmur) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineModuleRef(szName, pmur);
+        return Write(ThreadSafeMethod::DefineModuleRef, [&](TEmit* emitImpl) { return emitImpl->DefineModuleRef(szName, pmur); });
     }
 
     STDMETHOD(SetParent)(
         mdMemberRef mr,
         mdToken     tk) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetParent(mr, tk);
+        return Write(ThreadSafeMethod::SetParent, [&](TEmit* emitImpl) { return emitImpl->SetParent(mr, tk); });
     }
 
     STDMETHOD(GetTokenFromTypeSpec)(
@@ -1230,16 +1371,14 @@ public: // IMetaDataEmit
         ULONG       cbSig,
         mdTypeSpec *ptypespec) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->GetTokenFromTypeSpec(pvSig, cbSig, ptypespec);
+        return Write(ThreadSafeMethod::GetTokenFromTypeSpec, [&](TEmit* emitImpl) { return emitImpl->GetTokenFromTypeSpec(pvSig, cbSig, ptypespec); });
     }
 
     STDMETHOD(SaveToMemory)(
         void        *pbData,
         ULONG       cbData) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SaveToMemory(pbData, cbData);
+        return Write(ThreadSafeMethod::SaveToMemory, [&](TEmit* emitImpl) { return emitImpl->SaveToMemory(pbData, cbData); });
     }
 
     STDMETHOD(DefineUserString)(
@@ -1247,15 +1386,13 @@ public: // IMetaDataEmit
         ULONG       cchString,
         mdString    *pstk) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineUserString(szString, cchString, pstk);
+        return Write(ThreadSafeMethod::DefineUserString, [&](TEmit* emitImpl) { return emitImpl->DefineUserString(szString, cchString, pstk); });
     }
 
     STDMETHOD(DeleteToken)(
         mdToken     tkObj) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DeleteToken(tkObj);
+        return Write(ThreadSafeMethod::DeleteToken, [&](TEmit* emitImpl) { return emitImpl->DeleteToken(tkObj); });
     }
 
     STDMETHOD(SetMethodProps)(
@@ -1264,8 +1401,7 @@ public: // IMetaDataEmit
         ULONG       ulCodeRVA,
         DWORD       dwImplFlags) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetMethodProps(md, dwMethodFlags, ulCodeRVA, dwImplFlags);
+        return Write(ThreadSafeMethod::SetMethodProps, [&](TEmit* emitImpl) { return emitImpl->SetMethodProps(md, dwMethodFlags, ulCodeRVA, dwImplFlags); });
     }
 
     STDMETHOD(SetTypeDefProps)(
@@ -1274,8 +1410,7 @@ public: // IMetaDataEmit
         mdToken     tkExtends,
         mdToken     rtkImplements[]) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetTypeDefProps(td, dwTypeDefFlags, tkExtends, rtkImplements);
+        return Write(ThreadSafeMethod::SetTypeDefProps, [&](TEmit* emitImpl) { return emitImpl->SetTypeDefProps(td, dwTypeDefFlags, tkExtends, rtkImplements); });
     }
 
     STDMETHOD(SetEventProps)(
@@ -1287,8 +1422,7 @@ public: // IMetaDataEmit
         mdMethodDef mdFire,
         mdMethodDef rmdOtherMethods[]) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetEventProps(ev, dwEventFlags, tkEventType, mdAddOn, mdRemoveOn, mdFire, rmdOtherMethods);
+        return Write(ThreadSafeMethod::SetEventProps, [&](TEmit* emitImpl) { return emitImpl->SetEventProps(ev, dwEventFlags, tkEventType, mdAddOn, mdRemoveOn, mdFire, rmdOtherMethods); });
     }
 
     STDMETHOD(SetPermissionSetProps)(
@@ -1298,8 +1432,7 @@ public: // IMetaDataEmit
         ULONG       cbPermission,
         mdPermission *ppm) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetPermissionSetProps(tk, dwAction, pvPermission, cbPermission, ppm);
+        return Write(ThreadSafeMethod::SetPermissionSetProps, [&](TEmit* emitImpl) { return emitImpl->SetPermissionSetProps(tk, dwAction, pvPermission, cbPermission, ppm); });
     }
 
     STDMETHOD(DefinePinvokeMap)(
@@ -1308,8 +1441,7 @@ public: // IMetaDataEmit
         LPCWSTR     szImportName,
         mdModuleRef mrImportDLL) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefinePinvokeMap(tk, dwMappingFlags, szImportName, mrImportDLL);
+        return Write(ThreadSafeMethod::DefinePinvokeMap, [&](TEmit* emitImpl) { return emitImpl->DefinePinvokeMap(tk, dwMappingFlags, szImportName, mrImportDLL); });
     }
 
     STDMETHOD(SetPinvokeMap)(
@@ -1318,15 +1450,13 @@ public: // IMetaDataEmit
         LPCWSTR     szImportName,
         mdModuleRef mrImportDLL) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetPinvokeMap(tk, dwMappingFlags, szImportName, mrImportDLL);
+        return Write(ThreadSafeMethod::SetPinvokeMap, [&](TEmit* emitImpl) { return emitImpl->SetPinvokeMap(tk, dwMappingFlags, szImportName, mrImportDLL); });
     }
 
     STDMETHOD(DeletePinvokeMap)(
         mdToken     tk) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DeletePinvokeMap(tk);
+        return Write(ThreadSafeMethod::DeletePinvokeMap, [&](TEmit* emitImpl) { return emitImpl->DeletePinvokeMap(tk); });
     }
 
 
@@ -1337,8 +1467,7 @@ public: // IMetaDataEmit
         ULONG       cbCustomAttribute,
         mdCustomAttribute *pcv) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineCustomAttribute(tkOwner, tkCtor, pCustomAttribute, cbCustomAttribute, pcv);
+        return Write(ThreadSafeMethod::DefineCustomAttribute, [&](TEmit* emitImpl) { return emitImpl->DefineCustomAttribute(tkOwner, tkCtor, pCustomAttribute, cbCustomAttribute, pcv); });
     }
 
     STDMETHOD(SetCustomAttributeValue)(
@@ -1346,8 +1475,7 @@ public: // IMetaDataEmit
         void const  *pCustomAttribute,
         ULONG       cbCustomAttribute) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetCustomAttributeValue(pcv, pCustomAttribute, cbCustomAttribute);
+        return Write(ThreadSafeMethod::SetCustomAttributeValue, [&](TEmit* emitImpl) { return emitImpl->SetCustomAttributeValue(pcv, pCustomAttribute, cbCustomAttribute); });
     }
 
     STDMETHOD(DefineField)(
@@ -1361,8 +1489,7 @@ public: // IMetaDataEmit
         ULONG       cchValue,
         mdFieldDef  *pmd) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineField(td, szName, dwFieldFlags, pvSigBlob, cbSigBlob, dwCPlusTypeFlag, pValue, cchValue, pmd);
+        return Write(ThreadSafeMethod::DefineField, [&](TEmit* emitImpl) { return emitImpl->DefineField(td, szName, dwFieldFlags, pvSigBlob, cbSigBlob, dwCPlusTypeFlag, pValue, cchValue, pmd); });
     }
 
     STDMETHOD(DefineProperty)(
@@ -1379,8 +1506,7 @@ public: // IMetaDataEmit
         mdMethodDef rmdOtherMethods[],
         mdProperty  *pmdProp) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineProperty(td, szProperty, dwPropFlags, pvSig, cbSig, dwCPlusTypeFlag, pValue, cchValue, mdSetter, mdGetter, rmdOtherMethods, pmdProp);
+        return Write(ThreadSafeMethod::DefineProperty, [&](TEmit* emitImpl) { return emitImpl->DefineProperty(td, szProperty, dwPropFlags, pvSig, cbSig, dwCPlusTypeFlag, pValue, cchValue, mdSetter, mdGetter, rmdOtherMethods, pmdProp); });
     }
 
     STDMETHOD(DefineParam)(
@@ -1393,8 +1519,7 @@ public: // IMetaDataEmit
         ULONG       cchValue,
         mdParamDef  *ppd) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineParam(md, ulParamSeq, szName, dwParamFlags, dwCPlusTypeFlag, pValue, cchValue, ppd);
+        return Write(ThreadSafeMethod::DefineParam, [&](TEmit* emitImpl) { return emitImpl->DefineParam(md, ulParamSeq, szName, dwParamFlags, dwCPlusTypeFlag, pValue, cchValue, ppd); });
     }
 
     STDMETHOD(SetFieldProps)(
@@ -1404,8 +1529,7 @@ public: // IMetaDataEmit
         void const  *pValue,
         ULONG       cchValue) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetFieldProps(fd, dwFieldFlags, dwCPlusTypeFlag, pValue, cchValue);
+        return Write(ThreadSafeMethod::SetFieldProps, [&](TEmit* emitImpl) { return emitImpl->SetFieldProps(fd, dwFieldFlags, dwCPlusTypeFlag, pValue, cchValue); });
     }
 
     STDMETHOD(SetPropertyProps)(
@@ -1418,8 +1542,7 @@ public: // IMetaDataEmit
         mdMethodDef mdGetter,
         mdMethodDef rmdOtherMethods[]) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetPropertyProps(pr, dwPropFlags, dwCPlusTypeFlag, pValue, cchValue, mdSetter, mdGetter, rmdOtherMethods);
+        return Write(ThreadSafeMethod::SetPropertyProps, [&](TEmit* emitImpl) { return emitImpl->SetPropertyProps(pr, dwPropFlags, dwCPlusTypeFlag, pValue, cchValue, mdSetter, mdGetter, rmdOtherMethods); });
     }
 
     STDMETHOD(SetParamProps)(
@@ -1430,8 +1553,7 @@ public: // IMetaDataEmit
         void const  *pValue,
         ULONG       cchValue) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetParamProps(pd, szName, dwParamFlags, dwCPlusTypeFlag, pValue, cchValue);
+        return Write(ThreadSafeMethod::SetParamProps, [&](TEmit* emitImpl) { return emitImpl->SetParamProps(pd, szName, dwParamFlags, dwCPlusTypeFlag, pValue, cchValue); });
     }
 
 
@@ -1441,15 +1563,13 @@ public: // IMetaDataEmit
         ULONG       cSecAttrs,
         ULONG       *pulErrorAttr) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineSecurityAttributeSet(tkObj, rSecAttrs, cSecAttrs, pulErrorAttr);
+        return Write(ThreadSafeMethod::DefineSecurityAttributeSet, [&](TEmit* emitImpl) { return emitImpl->DefineSecurityAttributeSet(tkObj, rSecAttrs, cSecAttrs, pulErrorAttr); });
     }
 
     STDMETHOD(ApplyEditAndContinue)(
         IUnknown    *pImport) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->ApplyEditAndContinue(pImport);
+        return Write(ThreadSafeMethod::ApplyEditAndContinue, [&](TEmit* emitImpl) { return emitImpl->ApplyEditAndContinue(pImport); });
     }
 
     STDMETHOD(TranslateSigWithScope)(
@@ -1465,24 +1585,21 @@ public: // IMetaDataEmit
         ULONG       cbTranslatedSigMax,
         ULONG       *pcbTranslatedSig) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->TranslateSigWithScope(pAssemImport, pbHashValue, cbHashValue, import, pbSigBlob, cbSigBlob, pAssemEmit, emit, pvTranslatedSig, cbTranslatedSigMax, pcbTranslatedSig);
+        return Write(ThreadSafeMethod::TranslateSigWithScope, [&](TEmit* emitImpl) { return emitImpl->TranslateSigWithScope(pAssemImport, pbHashValue, cbHashValue, import, pbSigBlob, cbSigBlob, pAssemEmit, emit, pvTranslatedSig, cbTranslatedSigMax, pcbTranslatedSig); });
     }
 
     STDMETHOD(SetMethodImplFlags)(
         mdMethodDef md,
         DWORD       dwImplFlags) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetMethodImplFlags(md, dwImplFlags);
+        return Write(ThreadSafeMethod::SetMethodImplFlags, [&](TEmit* emitImpl) { return emitImpl->SetMethodImplFlags(md, dwImplFlags); });
     }
 
     STDMETHOD(SetFieldRVA)(
         mdFieldDef  fd,
         ULONG       ulRVA) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetFieldRVA(fd, ulRVA);
+        return Write(ThreadSafeMethod::SetFieldRVA, [&](TEmit* emitImpl) { return emitImpl->SetFieldRVA(fd, ulRVA); });
     }
 
     STDMETHOD(Merge)(
@@ -1490,14 +1607,12 @@ public: // IMetaDataEmit
         IMapToken   *pHostMapToken,
         IUnknown    *pHandler) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->Merge(pImport, pHostMapToken, pHandler);
+        return Write(ThreadSafeMethod::Merge, [&](TEmit* emitImpl) { return emitImpl->Merge(pImport, pHostMapToken, pHandler); });
     }
 
     STDMETHOD(MergeEnd)() override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->MergeEnd();
+        return Write(ThreadSafeMethod::MergeEnd, [&](TEmit* emitImpl) { return emitImpl->MergeEnd(); });
     }
 
 public: // IMetaDataEmit2
@@ -1507,40 +1622,35 @@ public: // IMetaDataEmit2
         ULONG       cbSigBlob,
         mdMethodSpec *pmi) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineMethodSpec(tkParent, pvSigBlob, cbSigBlob, pmi);
+        return Write(ThreadSafeMethod::DefineMethodSpec, [&](TEmit* emitImpl) { return emitImpl->DefineMethodSpec(tkParent, pvSigBlob, cbSigBlob, pmi); });
     }
 
     STDMETHOD(GetDeltaSaveSize)(
         CorSaveSize fSave,
         DWORD       *pdwSaveSize) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->GetDeltaSaveSize(fSave, pdwSaveSize);
+        return Write(ThreadSafeMethod::GetDeltaSaveSize, [&](TEmit* emitImpl) { return emitImpl->GetDeltaSaveSize(fSave, pdwSaveSize); });
     }
 
     STDMETHOD(SaveDelta)(
         LPCWSTR     szFile,
         DWORD       dwSaveFlags) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SaveDelta(szFile, dwSaveFlags);
+        return Write(ThreadSafeMethod::SaveDelta, [&](TEmit* emitImpl) { return emitImpl->SaveDelta(szFile, dwSaveFlags); });
     }
 
     STDMETHOD(SaveDeltaToStream)(
         IStream     *pIStream,
         DWORD       dwSaveFlags) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SaveDeltaToStream(pIStream, dwSaveFlags);
+        return Write(ThreadSafeMethod::SaveDeltaToStream, [&](TEmit* emitImpl) { return emitImpl->SaveDeltaToStream(pIStream, dwSaveFlags); });
     }
 
     STDMETHOD(SaveDeltaToMemory)(
         void        *pbData,
         ULONG       cbData) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SaveDeltaToMemory(pbData, cbData);
+        return Write(ThreadSafeMethod::SaveDeltaToMemory, [&](TEmit* emitImpl) { return emitImpl->SaveDeltaToMemory(pbData, cbData); });
     }
 
     STDMETHOD(DefineGenericParam)(
@@ -1552,8 +1662,7 @@ public: // IMetaDataEmit2
         mdToken      rtkConstraints[],
         mdGenericParam *pgp) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineGenericParam(tk, ulParamSeq, dwParamFlags, szname, reserved, rtkConstraints, pgp);
+        return Write(ThreadSafeMethod::DefineGenericParam, [&](TEmit* emitImpl) { return emitImpl->DefineGenericParam(tk, ulParamSeq, dwParamFlags, szname, reserved, rtkConstraints, pgp); });
     }
 
     STDMETHOD(SetGenericParamProps)(
@@ -1563,14 +1672,12 @@ public: // IMetaDataEmit2
         DWORD        reserved,
         mdToken      rtkConstraints[]) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetGenericParamProps(gp, dwParamFlags, szName, reserved, rtkConstraints);
+        return Write(ThreadSafeMethod::SetGenericParamProps, [&](TEmit* emitImpl) { return emitImpl->SetGenericParamProps(gp, dwParamFlags, szName, reserved, rtkConstraints); });
     }
 
     STDMETHOD(ResetENCLog)() override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->ResetENCLog();
+        return Write(ThreadSafeMethod::ResetENCLog, [&](TEmit* emitImpl) { return emitImpl->ResetENCLog(); });
     }
 
 public: // IMetaDataAssemblyEmit
@@ -1583,8 +1690,7 @@ public: // IMetaDataAssemblyEmit
         DWORD       dwAssemblyFlags,
         mdAssembly  *pma) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineAssembly(pbPublicKey, cbPublicKey, ulHashAlgId, szName, pMetaData, dwAssemblyFlags, pma);
+        return Write(ThreadSafeMethod::DefineAssembly, [&](TEmit* emitImpl) { return emitImpl->DefineAssembly(pbPublicKey, cbPublicKey, ulHashAlgId, szName, pMetaData, dwAssemblyFlags, pma); });
     }
 
     STDMETHOD(DefineAssemblyRef)(
@@ -1597,8 +1703,7 @@ public: // IMetaDataAssemblyEmit
         DWORD       dwAssemblyRefFlags,
         mdAssemblyRef *pmdar) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineAssemblyRef(pbPublicKeyOrToken, cbPublicKeyOrToken, szName, pMetaData, pbHashValue, cbHashValue, dwAssemblyRefFlags, pmdar);
+        return Write(ThreadSafeMethod::DefineAssemblyRef, [&](TEmit* emitImpl) { return emitImpl->DefineAssemblyRef(pbPublicKeyOrToken, cbPublicKeyOrToken, szName, pMetaData, pbHashValue, cbHashValue, dwAssemblyRefFlags, pmdar); });
     }
 
     STDMETHOD(DefineFile)(
@@ -1608,8 +1713,7 @@ public: // IMetaDataAssemblyEmit
         DWORD       dwFileFlags,
         mdFile      *pmdf) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineFile(szName, pbHashValue, cbHashValue, dwFileFlags, pmdf);
+        return Write(ThreadSafeMethod::DefineFile, [&](TEmit* emitImpl) { return emitImpl->DefineFile(szName, pbHashValue, cbHashValue, dwFileFlags, pmdf); });
     }
 
     STDMETHOD(DefineExportedType)(
@@ -1619,8 +1723,7 @@ public: // IMetaDataAssemblyEmit
         DWORD       dwExportedTypeFlags,
         mdExportedType   *pmdct) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineExportedType(szName, tkImplementation, tkTypeDef, dwExportedTypeFlags, pmdct);
+        return Write(ThreadSafeMethod::DefineExportedType, [&](TEmit* emitImpl) { return emitImpl->DefineExportedType(szName, tkImplementation, tkTypeDef, dwExportedTypeFlags, pmdct); });
     }
 
     STDMETHOD(DefineManifestResource)(
@@ -1630,8 +1733,7 @@ public: // IMetaDataAssemblyEmit
         DWORD       dwResourceFlags,
         mdManifestResource  *pmdmr) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->DefineManifestResource(szName, tkImplementation, dwOffset, dwResourceFlags, pmdmr);
+        return Write(ThreadSafeMethod::DefineManifestResource, [&](TEmit* emitImpl) { return emitImpl->DefineManifestResource(szName, tkImplementation, dwOffset, dwResourceFlags, pmdmr); });
     }
 
     STDMETHOD(SetAssemblyProps)(
@@ -1643,8 +1745,7 @@ public: // IMetaDataAssemblyEmit
         ASSEMBLYMETADATA const *pMetaData,
         DWORD       dwAssemblyFlags) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetAssemblyProps(pma, pbPublicKey, cbPublicKey, ulHashAlgId, szName, pMetaData, dwAssemblyFlags);
+        return Write(ThreadSafeMethod::SetAssemblyProps, [&](TEmit* emitImpl) { return emitImpl->SetAssemblyProps(pma, pbPublicKey, cbPublicKey, ulHashAlgId, szName, pMetaData, dwAssemblyFlags); });
     }
 
     STDMETHOD(SetAssemblyRefProps)(
@@ -1657,8 +1758,7 @@ public: // IMetaDataAssemblyEmit
         ULONG       cbHashValue,
         DWORD       dwAssemblyRefFlags) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetAssemblyRefProps(ar, pbPublicKeyOrToken, cbPublicKeyOrToken, szName, pMetaData, pbHashValue, cbHashValue, dwAssemblyRefFlags);
+        return Write(ThreadSafeMethod::SetAssemblyRefProps, [&](TEmit* emitImpl) { return emitImpl->SetAssemblyRefProps(ar, pbPublicKeyOrToken, cbPublicKeyOrToken, szName, pMetaData, pbHashValue, cbHashValue, dwAssemblyRefFlags); });
     }
 
     STDMETHOD(SetFileProps)(
@@ -1667,8 +1767,7 @@ public: // IMetaDataAssemblyEmit
         ULONG       cbHashValue,
         DWORD       dwFileFlags) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetFileProps(file, pbHashValue, cbHashValue, dwFileFlags);
+        return Write(ThreadSafeMethod::SetFileProps, [&](TEmit* emitImpl) { return emitImpl->SetFileProps(file, pbHashValue, cbHashValue, dwFileFlags); });
     }
 
     STDMETHOD(SetExportedTypeProps)(
@@ -1677,8 +1776,7 @@ public: // IMetaDataAssemblyEmit
         mdTypeDef   tkTypeDef,
         DWORD       dwExportedTypeFlags) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetExportedTypeProps(ct, tkImplementation, tkTypeDef, dwExportedTypeFlags);
+        return Write(ThreadSafeMethod::SetExportedTypeProps, [&](TEmit* emitImpl) { return emitImpl->SetExportedTypeProps(ct, tkImplementation, tkTypeDef, dwExportedTypeFlags); });
     }
 
     STDMETHOD(SetManifestResourceProps)(
@@ -1687,8 +1785,7 @@ public: // IMetaDataAssemblyEmit
         DWORD       dwOffset,
         DWORD       dwResourceFlags) override
     {
-        std::lock_guard<pal::WriteLock> lock { this->_lock.GetWriteLock() };
-        return _emit->SetManifestResourceProps(mr, tkImplementation, dwOffset, dwResourceFlags);
+        return Write(ThreadSafeMethod::SetManifestResourceProps, [&](TEmit* emitImpl) { return emitImpl->SetManifestResourceProps(mr, tkImplementation, dwOffset, dwResourceFlags); });
     }
 };
 
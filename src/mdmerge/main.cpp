@@ -80,7 +80,11 @@ void merge(merge_config_t cfg)
     }
 
     size_t save_size;
-    md_write_to_buffer(handle.get(), nullptr, &save_size);
+    if (!md_prepare_write(handle.get(), &save_size))
+    {
+        std::fprintf(stderr, "Failed to compute image size.\n");
+        return;
+    }
     malloc_span<uint8_t> out_buffer { (uint8_t*)malloc(save_size), save_size };
     if (!md_write_to_buffer(handle.get(), out_buffer, &save_size))
     {
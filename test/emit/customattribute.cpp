@@ -0,0 +1,724 @@
+#include "emit.hpp"
+#include <dnmd.hpp>
+
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    // A scope with the types that attribute constructors in the tests use.
+    struct AttributeScope
+    {
+        dncp::com_ptr<IMetaDataEmit> emit;
+        mdTypeDef attribute;
+        mdTypeRef type; // System.Type
+        mdTypeRef keywords; // System.Diagnostics.Tracing.EventKeywords, a 64-bit enum in another assembly.
+        mdTypeDef color; // Test.Color, an enum in the scope with a 16-bit underlying type.
+
+        std::vector<uint8_t> image;
+        mdhandle_ptr handle;
+    };
+
+    // Compress a TypeDefOrRef token for a signature with a small row - ECMA-335 II.23.2.8
+    uint8_t TypeDefOrRef(mdToken token)
+    {
+        uint8_t tag = TypeFromToken(token) == mdtTypeDef ? 0 : TypeFromToken(token) == mdtTypeRef ? 1 : 2;
+        return (uint8_t)(RidFromToken(token) << 2 | tag);
+    }
+
+    void CreateScope(AttributeScope& scope)
+    {
+        dncp::com_ptr<IMetaDataAssemblyEmit> assemblyEmit;
+        ASSERT_NO_FATAL_FAILURE(CreateEmit(assemblyEmit));
+        ASSEMBLYMETADATA metadata = {};
+        metadata.szLocale = const_cast<LPWSTR>(W(""));
+        mdAssemblyRef runtime;
+        ASSERT_EQ(S_OK, assemblyEmit->DefineAssemblyRef(nullptr, 0, W("System.Runtime"), &metadata, nullptr, 0, 0, &runtime));
+        ASSERT_EQ(S_OK, assemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&scope.emit));
+
+        IMetaDataEmit* emit = scope.emit;
+        mdTypeRef attributeBase;
+        ASSERT_EQ(S_OK, emit->DefineTypeRefByName(runtime, W("System.Attribute"), &attributeBase));
+        ASSERT_EQ(S_OK, emit->DefineTypeRefByName(runtime, W("System.Type"), &scope.type));
+        ASSERT_EQ(S_OK, emit->DefineTypeRefByName(runtime, W("System.Diagnostics.Tracing.EventKeywords"), &scope.keywords));
+        mdTypeRef enumBase;
+        ASSERT_EQ(S_OK, emit->DefineTypeRefByName(runtime, W("System.Enum"), &enumBase));
+
+        ASSERT_EQ(S_OK, emit->DefineTypeDef(W("Test.TestAttribute"), tdPublic, attributeBase, nullptr, &scope.attribute));
+
+        // The underlying type of an enum is the type of its instance field - ECMA-335 II.14.3
+        ASSERT_EQ(S_OK, emit->DefineTypeDef(W("Test.Color"), tdPublic | tdSealed, enumBase, nullptr, &scope.color));
+        std::array<uint8_t, 2> valueSig = { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_U2 };
+        mdFieldDef value;
+        ASSERT_EQ(S_OK, emit->DefineField(scope.color, W("value__"), fdPublic | fdSpecialName | fdRTSpecialName, valueSig.data(), (ULONG)valueSig.size(), ELEMENT_TYPE_VOID, nullptr, 0, &value));
+    }
+
+    // Define a constructor of the attribute with the parameter types.
+    void DefineCtor(AttributeScope& scope, std::vector<uint8_t> const& paramTypes, uint32_t paramCount, mdMethodDef* ctor)
+    {
+        std::vector<uint8_t> sig = { IMAGE_CEE_CS_CALLCONV_HASTHIS, (uint8_t)paramCount, ELEMENT_TYPE_VOID };
+        sig.insert(sig.end(), paramTypes.begin(), paramTypes.end());
+        ASSERT_EQ(S_OK, scope.emit->DefineMethod(scope.attribute, W(".ctor"), mdPublic | mdSpecialName | mdRTSpecialName, sig.data(), (ULONG)sig.size(), 0, 0, ctor));
+    }
+
+    // Save the scope, so it can be read with the C API.
+    void OpenScope(AttributeScope& scope)
+    {
+        DWORD saveSize;
+        ASSERT_EQ(S_OK, scope.emit->GetSaveSize(cssAccurate, &saveSize));
+        scope.image.resize(saveSize);
+        ASSERT_EQ(S_OK, scope.emit->SaveToMemory(scope.image.data(), (ULONG)scope.image.size()));
+        mdhandle_t handle;
+        ASSERT_TRUE(md_create_handle(scope.image.data(), scope.image.size(), &handle));
+        scope.handle.reset(handle);
+    }
+
+    using ArgKind = decltype(md_custom_attribute_arg_t::kind);
+
+    // The parsed value of a custom attribute.
+    struct ParsedValue
+    {
+        std::vector<uint64_t> buffer;
+
+        md_custom_attribute_value_t const* operator->() const
+        {
+            return (md_custom_attribute_value_t const*)buffer.data();
+        }
+    };
+
+    md_blob_parse_result_t Parse(
+        AttributeScope& scope,
+        mdMethodDef ctor,
+        std::vector<uint8_t> const& blob,
+        ParsedValue& value,
+        md_enum_resolver_t resolver = nullptr,
+        void* context = nullptr)
+    {
+        mdcursor_t cursor;
+        EXPECT_TRUE(md_token_to_cursor(scope.handle.get(), ctor, &cursor));
+        size_t bufferLen = 0;
+        md_blob_parse_result_t result = md_parse_custom_attribute_value(scope.handle.get(), cursor, blob.data(), blob.size(), resolver, context, nullptr, &bufferLen);
+        if (result != mdbpr_InsufficientBuffer)
+            return result;
+
+        value.buffer.resize((bufferLen + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+        return md_parse_custom_attribute_value(scope.handle.get(), cursor, blob.data(), blob.size(), resolver, context, (md_custom_attribute_value_t*)value.buffer.data(), &bufferLen);
+    }
+
+    // Append a SerString - ECMA-335 II.23.3
+    void AppendString(std::vector<uint8_t>& blob, char const* str)
+    {
+        size_t len = std::strlen(str);
+        blob.push_back((uint8_t)len);
+        blob.insert(blob.end(), str, str + len);
+    }
+
+    template<typename T>
+    void AppendValue(std::vector<uint8_t>& blob, T value)
+    {
+        uint8_t bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        blob.insert(blob.end(), bytes, bytes + sizeof(T));
+    }
+
+    std::string ToString(char const* str, uint32_t len)
+    {
+        return std::string{ str, len };
+    }
+
+    // Resolves EventKeywords to a 64-bit integer and counts the enums it is asked for.
+    struct KeywordsResolver
+    {
+        mdTypeRef keywords;
+        uint32_t calls;
+        mdToken lastType;
+        std::string lastName;
+
+        static bool Resolve(void* context, mdToken enumType, char const* enumTypeName, uint32_t enumTypeNameLen, uint8_t* underlyingType)
+        {
+            KeywordsResolver* resolver = (KeywordsResolver*)context;
+            resolver->calls++;
+            resolver->lastType = enumType;
+            resolver->lastName = enumTypeName != nullptr ? ToString(enumTypeName, enumTypeNameLen) : "";
+            if (enumType != resolver->keywords && resolver->lastName != "System.Diagnostics.Tracing.EventKeywords, System.Runtime")
+                return false;
+
+            *underlyingType = ELEMENT_TYPE_I8;
+            return true;
+        }
+    };
+
+    // Define typeCount types, with a ctorA attribute on every 7th type, then a
+    // ctorB attribute on every 11th type in reverse. The Parent column is left unsorted.
+    void DefineAttributedTypes(AttributeScope& scope, mdMethodDef ctorA, mdMethodDef ctorB, uint32_t typeCount, std::vector<mdTypeDef>& types)
+    {
+        for (uint32_t i = 0; i < typeCount; ++i)
+        {
+            std::string typeName = "Test.Type" + std::to_string(i);
+            WSTR_string wideTypeName{ typeName.begin(), typeName.end() };
+            mdTypeDef type;
+            ASSERT_EQ(S_OK, scope.emit->DefineTypeDef(wideTypeName.c_str(), tdPublic, mdTypeDefNil, nullptr, &type));
+            types.push_back(type);
+        }
+
+        std::array<uint8_t, 4> blob = { 0x01, 0x00, 0x00, 0x00 };
+        mdCustomAttribute attribute;
+        for (uint32_t i = 0; i < typeCount; i += 7)
+            ASSERT_EQ(S_OK, scope.emit->DefineCustomAttribute(types[i], ctorA, blob.data(), (ULONG)blob.size(), &attribute));
+        for (int32_t i = (int32_t)(typeCount - 1) / 11 * 11; i >= 0; i -= 11)
+            ASSERT_EQ(S_OK, scope.emit->DefineCustomAttribute(types[i], ctorB, blob.data(), (ULONG)blob.size(), &attribute));
+    }
+
+    // Scan the CustomAttribute table for the value, outLength rows at a time,
+    // and compare with the rows found by reading each row's column.
+    void ExpectScanMatches(mdhandle_t handle, col_index_t col, mdToken value, uint32_t outLength)
+    {
+        mdcursor_t begin;
+        uint32_t count;
+        ASSERT_TRUE(md_create_cursor(handle, mdtid_CustomAttribute, &begin, &count));
+
+        std::vector<mdToken> expected;
+        mdcursor_t curr = begin;
+        for (uint32_t i = 0; i < count; ++i, (void)md_cursor_next(&curr))
+        {
+            mdToken tk;
+            ASSERT_EQ(1, md_get_column_value_as_token(curr, col, 1, &tk));
+            if (tk != value)
+                continue;
+            mdToken row;
+            ASSERT_TRUE(md_cursor_to_token(curr, &row));
+            expected.push_back(row);
+        }
+
+        std::vector<mdToken> actual;
+        std::vector<mdcursor_t> matches(outLength);
+        int32_t read;
+        curr = begin;
+        while ((read = md_scan_column_equals(&curr, col, value, outLength, matches.data())) > 0)
+        {
+            ASSERT_LE((uint32_t)read, outLength);
+            for (int32_t i = 0; i < read; ++i)
+            {
+                mdToken row;
+                ASSERT_TRUE(md_cursor_to_token(matches[i], &row));
+                actual.push_back(row);
+            }
+        }
+        EXPECT_EQ(0, read);
+        EXPECT_EQ(expected, actual);
+    }
+
+    void ExpectScansMatch(uint32_t typeCount)
+    {
+        AttributeScope scope;
+        ASSERT_NO_FATAL_FAILURE(CreateScope(scope));
+        mdMethodDef ctorA;
+        ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, {}, 0, &ctorA));
+        mdMethodDef ctorB;
+        ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, { ELEMENT_TYPE_I4 }, 1, &ctorB));
+        std::vector<mdTypeDef> types;
+        ASSERT_NO_FATAL_FAILURE(DefineAttributedTypes(scope, ctorA, ctorB, typeCount, types));
+        ASSERT_NO_FATAL_FAILURE(OpenScope(scope));
+        mdhandle_t handle = scope.handle.get();
+
+        // Parents with both attributes, one, or none - including the last types.
+        uint32_t last = typeCount - 1;
+        for (uint32_t i : { 0u, 7u, 11u, 2u, 77u, last / 7 * 7, last / 11 * 11, last })
+        {
+            for (uint32_t outLength : { 1u, 64u })
+                ASSERT_NO_FATAL_FAILURE(ExpectScanMatches(handle, mdtCustomAttribute_Parent, types[i], outLength));
+        }
+
+        // Constructors match many rows, so small buffers resume the scan across many calls.
+        for (uint32_t outLength : { 1u, 3u, 64u })
+        {
+            ASSERT_NO_FATAL_FAILURE(ExpectScanMatches(handle, mdtCustomAttribute_Type, ctorA, outLength));
+            ASSERT_NO_FATAL_FAILURE(ExpectScanMatches(handle, mdtCustomAttribute_Type, ctorB, outLength));
+        }
+
+        // A token from a table the column can't reference finds nothing and ends the scan.
+        mdcursor_t curr;
+        uint32_t count;
+        ASSERT_TRUE(md_create_cursor(handle, mdtid_CustomAttribute, &curr, &count));
+        mdcursor_t match;
+        EXPECT_EQ(0, md_scan_column_equals(&curr, mdtCustomAttribute_Type, types[0], 1, &match));
+        EXPECT_EQ(0, md_scan_column_equals(&curr, mdtCustomAttribute_Parent, types[0], 1, &match));
+    }
+}
+
+TEST(CustomAttributeValue, FixedArguments)
+{
+    AttributeScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope(scope));
+    mdMethodDef ctor;
+    ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, { ELEMENT_TYPE_I4, ELEMENT_TYPE_STRING, ELEMENT_TYPE_STRING, ELEMENT_TYPE_R8, ELEMENT_TYPE_BOOLEAN }, 5, &ctor));
+    ASSERT_NO_FATAL_FAILURE(OpenScope(scope));
+
+    std::vector<uint8_t> blob = { 0x01, 0x00 };
+    AppendValue<int32_t>(blob, -42);
+    AppendString(blob, "abc");
+    blob.push_back(0xff); // null string
+    AppendValue<double>(blob, 1.5);
+    blob.push_back(1);
+    AppendValue<uint16_t>(blob, 0);
+
+    ParsedValue value;
+    ASSERT_EQ(mdbpr_Success, Parse(scope, ctor, blob, value));
+    EXPECT_EQ(5u, value->fixed_arg_count);
+    EXPECT_EQ(0u, value->named_arg_count);
+    ASSERT_EQ(5u, value->arg_count);
+    for (uint32_t i = 0; i < value->arg_count; ++i)
+    {
+        EXPECT_EQ(ArgKind::mdcak_FixedArgument, value->args[i].kind);
+        EXPECT_FALSE(value->args[i].boxed);
+    }
+
+    EXPECT_EQ(SERIALIZATION_TYPE_I4, value->args[0].type_code);
+    EXPECT_EQ((uint64_t)(int64_t)-42, value->args[0].value.integer);
+    EXPECT_EQ(SERIALIZATION_TYPE_STRING, value->args[1].type_code);
+    EXPECT_FALSE(value->args[1].is_null);
+    EXPECT_EQ("abc", ToString(value->args[1].value.string.str, value->args[1].value.string.len));
+    EXPECT_EQ(SERIALIZATION_TYPE_STRING, value->args[2].type_code);
+    EXPECT_TRUE(value->args[2].is_null);
+    EXPECT_EQ(SERIALIZATION_TYPE_R8, value->args[3].type_code);
+    EXPECT_EQ(1.5, value->args[3].value.r8);
+    EXPECT_EQ(SERIALIZATION_TYPE_BOOLEAN, value->args[4].type_code);
+    EXPECT_EQ(1u, value->args[4].value.integer);
+
+    // The blob must start with the prolog and contain every argument.
+    std::vector<uint8_t> badProlog = blob;
+    badProlog[0] = 0x02;
+    EXPECT_EQ(mdbpr_InvalidBlob, Parse(scope, ctor, badProlog, value));
+    std::vector<uint8_t> truncated{ blob.begin(), blob.end() - 3 };
+    EXPECT_EQ(mdbpr_InvalidBlob, Parse(scope, ctor, truncated, value));
+}
+
+TEST(CustomAttributeValue, NamedArguments)
+{
+    AttributeScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope(scope));
+    mdMethodDef ctor;
+    ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, {}, 0, &ctor));
+    ASSERT_NO_FATAL_FAILURE(OpenScope(scope));
+
+    std::vector<uint8_t> blob = { 0x01, 0x00 };
+    AppendValue<uint16_t>(blob, 2);
+    blob.push_back(SERIALIZATION_TYPE_FIELD);
+    blob.push_back(SERIALIZATION_TYPE_I4);
+    AppendString(blob, "Count");
+    AppendValue<int32_t>(blob, 7);
+    blob.push_back(SERIALIZATION_TYPE_PROPERTY);
+    blob.push_back(SERIALIZATION_TYPE_STRING);
+    AppendString(blob, "Name");
+    AppendString(blob, "x");
+
+    ParsedValue value;
+    ASSERT_EQ(mdbpr_Success, Parse(scope, ctor, blob, value));
+    EXPECT_EQ(0u, value->fixed_arg_count);
+    EXPECT_EQ(2u, value->named_arg_count);
+    ASSERT_EQ(2u, value->arg_count);
+
+    EXPECT_EQ(ArgKind::mdcak_Field, value->args[0].kind);
+    EXPECT_EQ("Count", ToString(value->args[0].name, value->args[0].name_len));
+    EXPECT_EQ(SERIALIZATION_TYPE_I4, value->args[0].type_code);
+    EXPECT_EQ(7u, value->args[0].value.integer);
+    EXPECT_EQ(ArgKind::mdcak_Property, value->args[1].kind);
+    EXPECT_EQ("Name", ToString(value->args[1].name, value->args[1].name_len));
+    EXPECT_EQ(SERIALIZATION_TYPE_STRING, value->args[1].type_code);
+    EXPECT_EQ("x", ToString(value->args[1].value.string.str, value->args[1].value.string.len));
+
+    // Named arguments must be fields or properties.
+    std::vector<uint8_t> badKind = blob;
+    badKind[4] = SERIALIZATION_TYPE_I4;
+    EXPECT_EQ(mdbpr_InvalidBlob, Parse(scope, ctor, badKind, value));
+}
+
+TEST(CustomAttributeValue, ArrayArguments)
+{
+    AttributeScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope(scope));
+    mdMethodDef ctor;
+    ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, { ELEMENT_TYPE_SZARRAY, ELEMENT_TYPE_I4 }, 1, &ctor));
+    ASSERT_NO_FATAL_FAILURE(OpenScope(scope));
+
+    std::vector<uint8_t> blob = { 0x01, 0x00 };
+    AppendValue<uint32_t>(blob, 3);
+    AppendValue<int32_t>(blob, 1);
+    AppendValue<int32_t>(blob, 2);
+    AppendValue<int32_t>(blob, 3);
+    AppendValue<uint16_t>(blob, 1);
+    blob.push_back(SERIALIZATION_TYPE_PROPERTY);
+    blob.push_back(SERIALIZATION_TYPE_SZARRAY);
+    blob.push_back(SERIALIZATION_TYPE_STRING);
+    AppendString(blob, "Names");
+    AppendValue<uint32_t>(blob, UINT32_MAX); // null array
+
+    // The elements follow their array.
+    ParsedValue value;
+    ASSERT_EQ(mdbpr_Success, Parse(scope, ctor, blob, value));
+    EXPECT_EQ(1u, value->fixed_arg_count);
+    EXPECT_EQ(1u, value->named_arg_count);
+    ASSERT_EQ(5u, value->arg_count);
+
+    EXPECT_EQ(ArgKind::mdcak_FixedArgument, value->args[0].kind);
+    EXPECT_EQ(SERIALIZATION_TYPE_SZARRAY, value->args[0].type_code);
+    EXPECT_EQ(SERIALIZATION_TYPE_I4, value->args[0].element_type_code);
+    EXPECT_FALSE(value->args[0].is_null);
+    EXPECT_EQ(3u, value->args[0].value.element_count);
+    for (uint32_t i = 1; i <= 3; ++i)
+    {
+        EXPECT_EQ(ArgKind::mdcak_ArrayElement, value->args[i].kind);
+        EXPECT_EQ(SERIALIZATION_TYPE_I4, value->args[i].type_code);
+        EXPECT_EQ(i, value->args[i].value.integer);
+    }
+
+    EXPECT_EQ(ArgKind::mdcak_Property, value->args[4].kind);
+    EXPECT_EQ(SERIALIZATION_TYPE_SZARRAY, value->args[4].type_code);
+    EXPECT_EQ(SERIALIZATION_TYPE_STRING, value->args[4].element_type_code);
+    EXPECT_TRUE(value->args[4].is_null);
+
+    // The element count can't exceed the rest of the blob.
+    std::vector<uint8_t> tooMany = blob;
+    tooMany[2] = 0xff;
+    EXPECT_EQ(mdbpr_InvalidBlob, Parse(scope, ctor, tooMany, value));
+}
+
+TEST(CustomAttributeValue, BoxedObjectArguments)
+{
+    AttributeScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope(scope));
+    mdMethodDef ctor;
+    ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, { ELEMENT_TYPE_OBJECT, ELEMENT_TYPE_OBJECT, ELEMENT_TYPE_OBJECT, ELEMENT_TYPE_OBJECT }, 4, &ctor));
+    mdMethodDef arrayCtor;
+    ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, { ELEMENT_TYPE_SZARRAY, ELEMENT_TYPE_OBJECT }, 1, &arrayCtor));
+    ASSERT_NO_FATAL_FAILURE(OpenScope(scope));
+
+    // Boxed values are prefixed by their type.
+    std::vector<uint8_t> blob = { 0x01, 0x00 };
+    blob.push_back(SERIALIZATION_TYPE_I8);
+    AppendValue<int64_t>(blob, 0x100000000);
+    blob.push_back(SERIALIZATION_TYPE_SZARRAY);
+    blob.push_back(SERIALIZATION_TYPE_I2);
+    AppendValue<uint32_t>(blob, 2);
+    AppendValue<int16_t>(blob, -1);
+    AppendValue<int16_t>(blob, 2);
+    blob.push_back(SERIALIZATION_TYPE_STRING);
+    blob.push_back(0xff);
+    blob.push_back(SERIALIZATION_TYPE_ENUM);
+    AppendString(blob, "Test.Color");
+    AppendValue<uint16_t>(blob, 3);
+    AppendValue<uint16_t>(blob, 0);
+
+    ParsedValue value;
+    ASSERT_EQ(mdbpr_Success, Parse(scope, ctor, blob, value));
+    EXPECT_EQ(4u, value->fixed_arg_count);
+    ASSERT_EQ(6u, value->arg_count);
+
+    EXPECT_TRUE(value->args[0].boxed);
+    EXPECT_EQ(SERIALIZATION_TYPE_I8, value->args[0].type_code);
+    EXPECT_EQ(0x100000000u, value->args[0].value.integer);
+
+    EXPECT_TRUE(value->args[1].boxed);
+    EXPECT_EQ(SERIALIZATION_TYPE_SZARRAY, value->args[1].type_code);
+    EXPECT_EQ(SERIALIZATION_TYPE_I2, value->args[1].element_type_code);
+    EXPECT_EQ(2u, value->args[1].value.element_count);
+    EXPECT_FALSE(value->args[2].boxed);
+    EXPECT_EQ((uint64_t)(int64_t)-1, value->args[2].value.integer);
+    EXPECT_EQ(2u, value->args[3].value.integer);
+
+    EXPECT_TRUE(value->args[4].boxed);
+    EXPECT_EQ(SERIALIZATION_TYPE_STRING, value->args[4].type_code);
+    EXPECT_TRUE(value->args[4].is_null);
+
+    // Boxed enums are named, and enums in the scope are sized from their definition.
+    EXPECT_TRUE(value->args[5].boxed);
+    EXPECT_EQ(SERIALIZATION_TYPE_ENUM, value->args[5].type_code);
+    EXPECT_EQ("Test.Color", ToString(value->args[5].enum_type_name, value->args[5].enum_type_name_len));
+    EXPECT_EQ(ELEMENT_TYPE_U2, value->args[5].underlying_type_code);
+    EXPECT_EQ(3u, value->args[5].value.integer);
+
+    // The elements of a boxed array can't be arrays.
+    std::vector<uint8_t> nested = { 0x01, 0x00 };
+    AppendValue<uint32_t>(nested, 1);
+    nested.push_back(SERIALIZATION_TYPE_SZARRAY);
+    nested.push_back(SERIALIZATION_TYPE_I4);
+    AppendValue<uint32_t>(nested, 0);
+    AppendValue<uint16_t>(nested, 0);
+    EXPECT_EQ(mdbpr_InvalidBlob, Parse(scope, arrayCtor, nested, value));
+}
+
+TEST(CustomAttributeValue, EnumArguments)
+{
+    AttributeScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope(scope));
+    mdMethodDef ctor;
+    ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, { ELEMENT_TYPE_VALUETYPE, TypeDefOrRef(scope.color), ELEMENT_TYPE_VALUETYPE, TypeDefOrRef(scope.keywords) }, 2, &ctor));
+    mdMethodDef colorCtor;
+    ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, { ELEMENT_TYPE_VALUETYPE, TypeDefOrRef(scope.color) }, 1, &colorCtor));
+    mdMethodDef arrayCtor;
+    ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, { ELEMENT_TYPE_SZARRAY, ELEMENT_TYPE_VALUETYPE, TypeDefOrRef(scope.keywords) }, 1, &arrayCtor));
+    ASSERT_NO_FATAL_FAILURE(OpenScope(scope));
+
+    // Enums in the scope don't need to be resolved by the caller.
+    std::vector<uint8_t> colorBlob = { 0x01, 0x00 };
+    AppendValue<uint16_t>(colorBlob, 0x102);
+    AppendValue<uint16_t>(colorBlob, 1);
+    colorBlob.push_back(SERIALIZATION_TYPE_FIELD);
+    colorBlob.push_back(SERIALIZATION_TYPE_ENUM);
+    AppendString(colorBlob, "Test.Color");
+    AppendString(colorBlob, "Shade");
+    AppendValue<uint16_t>(colorBlob, 0xffff);
+
+    ParsedValue value;
+    ASSERT_EQ(mdbpr_Success, Parse(scope, colorCtor, colorBlob, value));
+    ASSERT_EQ(2u, value->arg_count);
+    EXPECT_EQ(SERIALIZATION_TYPE_ENUM, value->args[0].type_code);
+    EXPECT_EQ(scope.color, value->args[0].enum_type);
+    EXPECT_EQ(ELEMENT_TYPE_U2, value->args[0].underlying_type_code);
+    EXPECT_EQ(0x102u, value->args[0].value.integer);
+    EXPECT_EQ(mdTokenNil, value->args[1].enum_type);
+    EXPECT_EQ(ELEMENT_TYPE_U2, value->args[1].underlying_type_code);
+    EXPECT_EQ(0xffffu, value->args[1].value.integer);
+
+    // EventKeywords is 64-bit, so it can only be read once the caller resolves it.
+    std::vector<uint8_t> blob = { 0x01, 0x00 };
+    AppendValue<uint16_t>(blob, 2);
+    AppendValue<uint64_t>(blob, 0xf00000000000);
+    AppendValue<uint16_t>(blob, 1);
+    blob.push_back(SERIALIZATION_TYPE_PROPERTY);
+    blob.push_back(SERIALIZATION_TYPE_ENUM);
+    AppendString(blob, "System.Diagnostics.Tracing.EventKeywords, System.Runtime");
+    AppendString(blob, "Keywords");
+    AppendValue<uint64_t>(blob, 0x8000000000000000);
+    EXPECT_EQ(mdbpr_UnresolvedEnum, Parse(scope, ctor, blob, value));
+
+    KeywordsResolver resolver = { scope.keywords, 0, mdTokenNil, {} };
+    ASSERT_EQ(mdbpr_Success, Parse(scope, ctor, blob, value, &KeywordsResolver::Resolve, &resolver));
+    ASSERT_EQ(3u, value->arg_count);
+    EXPECT_EQ(2u, value->args[0].value.integer);
+    EXPECT_EQ(scope.keywords, value->args[1].enum_type);
+    EXPECT_EQ(ELEMENT_TYPE_I8, value->args[1].underlying_type_code);
+    EXPECT_EQ(0xf00000000000u, value->args[1].value.integer);
+
+    // Named enums are resolved by their name.
+    EXPECT_EQ(ArgKind::mdcak_Property, value->args[2].kind);
+    EXPECT_EQ(ELEMENT_TYPE_I8, value->args[2].underlying_type_code);
+    EXPECT_EQ(0x8000000000000000u, value->args[2].value.integer);
+    EXPECT_EQ(mdTokenNil, resolver.lastType);
+    EXPECT_EQ("System.Diagnostics.Tracing.EventKeywords, System.Runtime", resolver.lastName);
+
+    // The enum of an array is resolved once for all of its elements.
+    std::vector<uint8_t> arrayBlob = { 0x01, 0x00 };
+    AppendValue<uint32_t>(arrayBlob, 3);
+    AppendValue<uint64_t>(arrayBlob, 1);
+    AppendValue<uint64_t>(arrayBlob, 2);
+    AppendValue<uint64_t>(arrayBlob, 4);
+    AppendValue<uint16_t>(arrayBlob, 0);
+    resolver.calls = 0;
+    ASSERT_EQ(mdbpr_Success, Parse(scope, arrayCtor, arrayBlob, value, &KeywordsResolver::Resolve, &resolver));
+    ASSERT_EQ(4u, value->arg_count);
+    EXPECT_EQ(ELEMENT_TYPE_I8, value->args[0].underlying_type_code);
+    EXPECT_EQ(4u, value->args[3].value.integer);
+    EXPECT_EQ(ELEMENT_TYPE_I8, value->args[3].underlying_type_code);
+    // Once to size the buffer, then once to write the arguments.
+    EXPECT_EQ(2u, resolver.calls);
+
+    // A buffer that's already large enough is filled by decoding the blob once.
+    mdcursor_t arrayCursor;
+    ASSERT_TRUE(md_token_to_cursor(scope.handle.get(), arrayCtor, &arrayCursor));
+    size_t bufferLen = value.buffer.size() * sizeof(value.buffer[0]);
+    resolver.calls = 0;
+    ASSERT_EQ(mdbpr_Success, md_parse_custom_attribute_value(scope.handle.get(), arrayCursor, arrayBlob.data(), arrayBlob.size(), &KeywordsResolver::Resolve, &resolver, (md_custom_attribute_value_t*)value.buffer.data(), &bufferLen));
+    EXPECT_EQ(1u, resolver.calls);
+    EXPECT_EQ(4u, value->args[3].value.integer);
+
+    // A buffer with room for only some of the arguments gets the required size.
+    bufferLen = sizeof(md_custom_attribute_value_t) + 2 * sizeof(md_custom_attribute_arg_t);
+    EXPECT_EQ(mdbpr_InsufficientBuffer, md_parse_custom_attribute_value(scope.handle.get(), arrayCursor, arrayBlob.data(), arrayBlob.size(), &KeywordsResolver::Resolve, &resolver, (md_custom_attribute_value_t*)value.buffer.data(), &bufferLen));
+    EXPECT_EQ(sizeof(md_custom_attribute_value_t) + 4 * sizeof(md_custom_attribute_arg_t), bufferLen);
+
+    // Enums the resolver doesn't know are still unresolved.
+    std::vector<uint8_t> unknown = { 0x01, 0x00 };
+    AppendValue<uint16_t>(unknown, 0);
+    AppendValue<uint16_t>(unknown, 1);
+    unknown.push_back(SERIALIZATION_TYPE_FIELD);
+    unknown.push_back(SERIALIZATION_TYPE_ENUM);
+    AppendString(unknown, "Other.Enum, Other");
+    AppendString(unknown, "Value");
+    AppendValue<int32_t>(unknown, 0);
+    EXPECT_EQ(mdbpr_UnresolvedEnum, Parse(scope, colorCtor, unknown, value, &KeywordsResolver::Resolve, &resolver));
+    EXPECT_EQ("Other.Enum, Other", resolver.lastName);
+}
+
+TEST(CustomAttributeValue, TypeArguments)
+{
+    AttributeScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope(scope));
+    mdMethodDef ctor;
+    ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, { ELEMENT_TYPE_CLASS, TypeDefOrRef(scope.type), ELEMENT_TYPE_CLASS, TypeDefOrRef(scope.type) }, 2, &ctor));
+    // Classes other than System.Type, System.String and System.Object can't be arguments.
+    mdMethodDef badCtor;
+    ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, { ELEMENT_TYPE_CLASS, TypeDefOrRef(scope.attribute) }, 1, &badCtor));
+    ASSERT_NO_FATAL_FAILURE(OpenScope(scope));
+
+    std::vector<uint8_t> blob = { 0x01, 0x00 };
+    AppendString(blob, "System.String, System.Runtime");
+    blob.push_back(0xff); // null type
+    AppendValue<uint16_t>(blob, 1);
+    blob.push_back(SERIALIZATION_TYPE_FIELD);
+    blob.push_back(SERIALIZATION_TYPE_TYPE);
+    AppendString(blob, "Target");
+    AppendString(blob, "Test.Color");
+
+    ParsedValue value;
+    ASSERT_EQ(mdbpr_Success, Parse(scope, ctor, blob, value));
+    ASSERT_EQ(3u, value->arg_count);
+    EXPECT_EQ(SERIALIZATION_TYPE_TYPE, value->args[0].type_code);
+    EXPECT_EQ("System.String, System.Runtime", ToString(value->args[0].value.string.str, value->args[0].value.string.len));
+    EXPECT_EQ(SERIALIZATION_TYPE_TYPE, value->args[1].type_code);
+    EXPECT_TRUE(value->args[1].is_null);
+    EXPECT_EQ(ArgKind::mdcak_Field, value->args[2].kind);
+    EXPECT_EQ(SERIALIZATION_TYPE_TYPE, value->args[2].type_code);
+    EXPECT_EQ("Test.Color", ToString(value->args[2].value.string.str, value->args[2].value.string.len));
+
+    std::vector<uint8_t> empty = { 0x01, 0x00, 0x00, 0x00 };
+    EXPECT_EQ(mdbpr_InvalidBlob, Parse(scope, badCtor, empty, value));
+}
+
+TEST(CustomAttributeByName, MatchesParentExactly)
+{
+    AttributeScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope(scope));
+    mdMethodDef ctor;
+    ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, {}, 0, &ctor));
+
+    std::array<uint8_t, 4> blob = { 0x01, 0x00, 0x00, 0x00 };
+    mdCustomAttribute onColor;
+    ASSERT_EQ(S_OK, scope.emit->DefineCustomAttribute(scope.color, ctor, blob.data(), (ULONG)blob.size(), &onColor));
+    mdCustomAttribute onModule;
+    ASSERT_EQ(S_OK, scope.emit->DefineCustomAttribute(TokenFromRid(1, mdtModule), ctor, blob.data(), (ULONG)blob.size(), &onModule));
+
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, scope.emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    void const* data;
+    ULONG dataLen;
+    EXPECT_EQ(S_OK, import->GetCustomAttributeByName(scope.color, W("Test.TestAttribute"), &data, &dataLen));
+    EXPECT_EQ(blob.size(), dataLen);
+    EXPECT_EQ(S_OK, import->GetCustomAttributeByName(TokenFromRid(1, mdtModule), W("Test.TestAttribute"), &data, &dataLen));
+    EXPECT_EQ(S_FALSE, import->GetCustomAttributeByName(scope.attribute, W("Test.TestAttribute"), &data, &dataLen));
+    EXPECT_EQ(S_FALSE, import->GetCustomAttributeByName(scope.color, W("Test.OtherAttribute"), &data, &dataLen));
+
+    // A nil parent isn't a wildcard for the attributes on every parent.
+    EXPECT_EQ(S_FALSE, import->GetCustomAttributeByName(mdTokenNil, W("Test.TestAttribute"), &data, &dataLen));
+    EXPECT_EQ(nullptr, data);
+    EXPECT_EQ(0u, dataLen);
+}
+
+TEST(CustomAttributeByName, FindWhileDefining)
+{
+    AttributeScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope(scope));
+    mdMethodDef ctor;
+    ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, { ELEMENT_TYPE_I4 }, 1, &ctor));
+
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, scope.emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    // Lookups between definitions search the table until the metadata stops changing.
+    std::vector<mdTypeDef> parents;
+    for (int32_t i = 0; i < 40; ++i)
+    {
+        std::string typeName = "Test.Type" + std::to_string(i);
+        WSTR_string wideTypeName{ typeName.begin(), typeName.end() };
+        mdTypeDef parent;
+        ASSERT_EQ(S_OK, scope.emit->DefineTypeDef(wideTypeName.c_str(), tdPublic, mdTypeDefNil, nullptr, &parent));
+        parents.push_back(parent);
+
+        std::vector<uint8_t> blob = { 0x01, 0x00 };
+        AppendValue<int32_t>(blob, i);
+        AppendValue<uint16_t>(blob, 0);
+        mdCustomAttribute attribute;
+        ASSERT_EQ(S_OK, scope.emit->DefineCustomAttribute(parent, ctor, blob.data(), (ULONG)blob.size(), &attribute));
+
+        void const* data;
+        ULONG dataLen;
+        ASSERT_EQ(S_OK, import->GetCustomAttributeByName(parent, W("Test.TestAttribute"), &data, &dataLen));
+        ASSERT_EQ(blob.size(), dataLen);
+        EXPECT_EQ(0, std::memcmp(blob.data(), data, dataLen));
+        EXPECT_EQ(S_FALSE, import->GetCustomAttributeByName(parent, W("Test.OtherAttribute"), &data, &dataLen));
+        EXPECT_EQ(S_FALSE, import->GetCustomAttributeByName(scope.color, W("Test.TestAttribute"), &data, &dataLen));
+    }
+
+    // Repeated lookups without edits use the index, and find the same attributes.
+    for (int32_t i = 0; i < 40; ++i)
+    {
+        void const* data;
+        ULONG dataLen;
+        ASSERT_EQ(S_OK, import->GetCustomAttributeByName(parents[i], W("Test.TestAttribute"), &data, &dataLen));
+        ASSERT_EQ(8u, dataLen);
+        int32_t value;
+        std::memcpy(&value, (uint8_t const*)data + 2, sizeof(value));
+        EXPECT_EQ(i, value);
+    }
+}
+
+TEST(CustomAttributeEnum, FilterByTypeOnEditedScope)
+{
+    AttributeScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope(scope));
+    mdMethodDef ctorA;
+    ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, {}, 0, &ctorA));
+    mdMethodDef ctorB;
+    ASSERT_NO_FATAL_FAILURE(DefineCtor(scope, { ELEMENT_TYPE_I4 }, 1, &ctorB));
+    std::vector<mdTypeDef> types;
+    ASSERT_NO_FATAL_FAILURE(DefineAttributedTypes(scope, ctorA, ctorB, 80, types));
+
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, scope.emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    for (uint32_t i = 0; i < types.size(); ++i)
+    {
+        for (mdToken type : { (mdToken)mdTokenNil, ctorA, ctorB })
+        {
+            uint32_t expected = 0;
+            if ((type != ctorB) && i % 7 == 0)
+                expected++;
+            if ((type != ctorA) && i % 11 == 0)
+                expected++;
+
+            // Read one attribute per call to resume the enumeration.
+            HCORENUM hEnum = nullptr;
+            mdCustomAttribute attribute;
+            ULONG count;
+            uint32_t found = 0;
+            while (import->EnumCustomAttributes(&hEnum, types[i], type, &attribute, 1, &count) == S_OK && count != 0)
+            {
+                found++;
+                mdToken parent;
+                mdToken attributeType;
+                void const* blob;
+                ULONG blobLen;
+                ASSERT_EQ(S_OK, import->GetCustomAttributeProps(attribute, &parent, &attributeType, &blob, &blobLen));
+                EXPECT_EQ(types[i], parent);
+                if (!IsNilToken(type))
+                    EXPECT_EQ(type, attributeType);
+            }
+            import->CloseEnum(hEnum);
+            EXPECT_EQ(expected, found) << "Type" << i;
+        }
+    }
+}
+
+TEST(CustomAttributeScan, TwoByteCodedColumns)
+{
+    // Every referenced table is small, so both coded index columns are 2 bytes.
+    ASSERT_NO_FATAL_FAILURE(ExpectScansMatch(100));
+}
+
+TEST(CustomAttributeScan, FourByteCodedColumn)
+{
+    // Over 2^11 TypeDef rows widens the HasCustomAttribute column (5 tag bits) to 4 bytes - ECMA-335 II.24.2.6
+    // The CustomAttributeType column stays at 2 bytes.
+    ASSERT_NO_FATAL_FAILURE(ExpectScansMatch(2100));
+}
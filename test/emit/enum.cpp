@@ -0,0 +1,129 @@
+#include "emit.hpp"
+#include <vector>
+
+namespace
+{
+    void DefineUserStrings(IMetaDataEmit* emit, uint32_t count, std::vector<mdString>& strings)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            std::string name = "String" + std::to_string(i);
+            WSTR_string wideName{ name.begin(), name.end() };
+            mdString str;
+            ASSERT_EQ(S_OK, emit->DefineUserString(wideName.c_str(), (ULONG)wideName.size(), &str));
+            strings.push_back(str);
+        }
+    }
+
+    void ReadUserStrings(IMetaDataImport* import, HCORENUM* hEnum, std::vector<mdString>& strings)
+    {
+        mdString buffer[7];
+        ULONG count;
+        while (import->EnumUserStrings(hEnum, buffer, (ULONG)std::size(buffer), &count) == S_OK && count != 0)
+            strings.insert(strings.end(), buffer, buffer + count);
+    }
+}
+
+TEST(Enum, ReuseAfterClose)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    std::vector<mdString> strings;
+    ASSERT_NO_FATAL_FAILURE(DefineUserStrings(emit, 3, strings));
+
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    HCORENUM hEnum = nullptr;
+    std::vector<mdString> read;
+    ASSERT_NO_FATAL_FAILURE(ReadUserStrings(import, &hEnum, read));
+    EXPECT_EQ(strings, read);
+    HCORENUM first = hEnum;
+    import->CloseEnum(hEnum);
+
+    // The closed enumerator is handed out again.
+    hEnum = nullptr;
+    read.clear();
+    ASSERT_NO_FATAL_FAILURE(ReadUserStrings(import, &hEnum, read));
+    EXPECT_EQ(strings, read);
+    EXPECT_EQ(first, hEnum);
+    import->CloseEnum(hEnum);
+}
+
+TEST(Enum, GrowPastInlineStorage)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    std::vector<mdString> strings;
+    ASSERT_NO_FATAL_FAILURE(DefineUserStrings(emit, 40, strings));
+
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    HCORENUM hEnum = nullptr;
+    std::vector<mdString> read;
+    ASSERT_NO_FATAL_FAILURE(ReadUserStrings(import, &hEnum, read));
+    EXPECT_EQ(strings, read);
+
+    ULONG count;
+    ASSERT_EQ(S_OK, import->CountEnum(hEnum, &count));
+    EXPECT_EQ(40u, count);
+    import->CloseEnum(hEnum);
+}
+
+TEST(Enum, ReuseAfterLargeEnumeration)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    std::vector<mdString> strings;
+    ASSERT_NO_FATAL_FAILURE(DefineUserStrings(emit, 2000, strings));
+
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    HCORENUM hEnum = nullptr;
+    std::vector<mdString> read;
+    ASSERT_NO_FATAL_FAILURE(ReadUserStrings(import, &hEnum, read));
+    EXPECT_EQ(strings, read);
+    import->CloseEnum(hEnum);
+
+    // The pooled enumerator dropped its large storage and has to grow again.
+    hEnum = nullptr;
+    read.clear();
+    ASSERT_NO_FATAL_FAILURE(ReadUserStrings(import, &hEnum, read));
+    EXPECT_EQ(strings, read);
+    import->CloseEnum(hEnum);
+}
+
+TEST(Enum, CloseAfterImportReleased)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    std::vector<mdString> strings;
+    ASSERT_NO_FATAL_FAILURE(DefineUserStrings(emit, 20, strings));
+
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    HCORENUM hEnum = nullptr;
+    mdString first;
+    ULONG count;
+    ASSERT_EQ(S_OK, import->EnumUserStrings(&hEnum, &first, 1, &count));
+    EXPECT_EQ(strings[0], first);
+
+    // Release the scope that created the enumerator, then close it through another one.
+    import.Detach()->Release();
+    emit.Detach()->Release();
+
+    dncp::com_ptr<IMetaDataEmit> otherEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(otherEmit));
+    dncp::com_ptr<IMetaDataImport> otherImport;
+    ASSERT_EQ(S_OK, otherEmit->QueryInterface(IID_IMetaDataImport, (void**)&otherImport));
+    otherImport->CloseEnum(hEnum);
+
+    // The other scope's pool is unaffected.
+    hEnum = nullptr;
+    ASSERT_EQ(S_FALSE, otherImport->EnumUserStrings(&hEnum, &first, 1, &count));
+    EXPECT_EQ(0u, count);
+    otherImport->CloseEnum(hEnum);
+}
@@ -59,4 +59,34 @@ TEST(MemberRef, SetParent)
     EXPECT_EQ(W("Foo"), readName.substr(0, readNameLength - 1));
     EXPECT_EQ(TokenFromRid(2, mdtTypeRef), parent);
     EXPECT_THAT(std::vector(sigBlob, sigBlob + sigBlobLength), testing::ContainerEq(std::vector(signature.begin(), signature.end())));
-}
\ No newline at end of file
+}
+TEST(MemberRef, FindWhileDefining)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    // Alternate edits and finds, then find the references again once the metadata stops changing.
+    std::array<uint8_t, 3> signature = { IMAGE_CEE_CS_CALLCONV_DEFAULT, 0, ELEMENT_TYPE_VOID };
+    std::array<WSTR_string, 3> names = { W("Foo"), W("Bar"), W("Baz") };
+    std::vector<mdMemberRef> memberRefs;
+    mdMemberRef memberRef;
+    for (WSTR_string const& name : names)
+    {
+        ASSERT_EQ(S_OK, emit->DefineMemberRef(TokenFromRid(1, mdtTypeDef), name.c_str(), signature.data(), (ULONG)signature.size(), &memberRef));
+        memberRefs.push_back(memberRef);
+        EXPECT_EQ(S_OK, import->FindMemberRef(TokenFromRid(1, mdtTypeDef), name.c_str(), signature.data(), (ULONG)signature.size(), &memberRef));
+        EXPECT_EQ(memberRefs.back(), memberRef);
+        EXPECT_EQ(CLDB_E_RECORD_NOTFOUND, import->FindMemberRef(TokenFromRid(1, mdtTypeRef), name.c_str(), signature.data(), (ULONG)signature.size(), &memberRef));
+    }
+
+    for (uint32_t round = 0; round < 8; ++round)
+    {
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            EXPECT_EQ(S_OK, import->FindMemberRef(TokenFromRid(1, mdtTypeDef), names[i].c_str(), nullptr, 0, &memberRef));
+            EXPECT_EQ(memberRefs[i], memberRef);
+        }
+    }
+}
@@ -115,3 +115,98 @@ TEST(MethodDef, SetProps)
     EXPECT_EQ(miForwardRef, implFlags);
     EXPECT_THAT(std::vector(sigBlob, sigBlob + sigBlobLength), testing::ContainerEq(std::vector(sig.begin(), sig.end())));
 }
+
+TEST(MethodDef, DefineOnEarlierType)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    mdToken implements = mdTokenNil;
+    mdTypeDef first;
+    ASSERT_EQ(S_OK, emit->DefineTypeDef(W("First"), 0, mdTypeDefNil, &implements, &first));
+    mdTypeDef second;
+    ASSERT_EQ(S_OK, emit->DefineTypeDef(W("Second"), 0, mdTypeDefNil, &implements, &second));
+
+    // Defining a method on the first type after the second type has one
+    // inserts the method before the second type's methods.
+    std::array sig = { (uint8_t)IMAGE_CEE_CS_CALLCONV_DEFAULT, (uint8_t)0, (uint8_t)ELEMENT_TYPE_VOID };
+    mdMethodDef secondMethod;
+    ASSERT_EQ(S_OK, emit->DefineMethod(second, W("Foo"), mdPublic, sig.data(), (ULONG)sig.size(), 0, 0, &secondMethod));
+    mdMethodDef firstMethod;
+    ASSERT_EQ(S_OK, emit->DefineMethod(first, W("Foo"), mdPublic, sig.data(), (ULONG)sig.size(), 0, 0, &firstMethod));
+
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    // TypeDef,1 is the <Module> type, which still has no methods.
+    HCORENUM hEnum = nullptr;
+    mdMethodDef method;
+    ULONG count;
+    EXPECT_EQ(S_FALSE, import->EnumMethods(&hEnum, TokenFromRid(1, mdtTypeDef), &method, 1, &count));
+    import->CloseEnum(hEnum);
+
+    EXPECT_EQ(S_OK, import->FindMethod(first, W("Foo"), sig.data(), (ULONG)sig.size(), &method));
+    EXPECT_EQ(firstMethod, method);
+    EXPECT_EQ(S_OK, import->FindMethod(second, W("Foo"), sig.data(), (ULONG)sig.size(), &method));
+    EXPECT_EQ(secondMethod, method);
+}
+
+TEST(MethodDef, FindWhileDefining)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    mdToken implements = mdTokenNil;
+    std::array<mdTypeDef, 2> types;
+    ASSERT_EQ(S_OK, emit->DefineTypeDef(W("First"), 0, mdTypeDefNil, &implements, &types[0]));
+    ASSERT_EQ(S_OK, emit->DefineTypeDef(W("Second"), 0, mdTypeDefNil, &implements, &types[1]));
+
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    // Each find follows an edit, so finds search the type's methods instead of the stale index.
+    std::array sig = { (uint8_t)IMAGE_CEE_CS_CALLCONV_DEFAULT, (uint8_t)0, (uint8_t)ELEMENT_TYPE_VOID };
+    std::vector<WSTR_string> names;
+    std::vector<mdMethodDef> methods;
+    mdMethodDef method;
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        names.push_back(W("Method") + WSTR_string(1, (WCHAR)(W('0') + i)));
+        ASSERT_EQ(S_OK, emit->DefineMethod(types[i % 2], names[i].c_str(), mdPublic, sig.data(), (ULONG)sig.size(), 0, 0, &method));
+        methods.push_back(method);
+
+        EXPECT_EQ(S_OK, import->FindMethod(types[i % 2], names[i].c_str(), sig.data(), (ULONG)sig.size(), &method));
+        EXPECT_EQ(methods[i], method);
+        EXPECT_EQ(CLDB_E_RECORD_NOTFOUND, import->FindMethod(types[(i + 1) % 2], names[i].c_str(), sig.data(), (ULONG)sig.size(), &method));
+    }
+
+    // PrivateScope methods can't be found by name, with or without the index.
+    mdMethodDef privateScope;
+    ASSERT_EQ(S_OK, emit->DefineMethod(types[0], W("Hidden"), mdPrivateScope, sig.data(), (ULONG)sig.size(), 0, 0, &privateScope));
+    EXPECT_EQ(CLDB_E_RECORD_NOTFOUND, import->FindMethod(types[0], W("Hidden"), sig.data(), (ULONG)sig.size(), &method));
+
+    // Once the metadata stops changing, the finds use the rebuilt index.
+    for (uint32_t round = 0; round < 4; ++round)
+    {
+        for (uint32_t i = 0; i < methods.size(); ++i)
+        {
+            EXPECT_EQ(S_OK, import->FindMethod(types[i % 2], names[i].c_str(), sig.data(), (ULONG)sig.size(), &method));
+            EXPECT_EQ(methods[i], method);
+        }
+        EXPECT_EQ(CLDB_E_RECORD_NOTFOUND, import->FindMethod(types[0], W("Hidden"), sig.data(), (ULONG)sig.size(), &method));
+    }
+
+    mdMethodDef added;
+    ASSERT_EQ(S_OK, emit->DefineMethod(types[0], W("Added"), mdPublic, sig.data(), (ULONG)sig.size(), 0, 0, &added));
+    EXPECT_EQ(S_OK, import->FindMethod(types[0], W("Added"), sig.data(), (ULONG)sig.size(), &method));
+    EXPECT_EQ(added, method);
+    EXPECT_EQ(S_OK, import->FindMethod(types[1], names[1].c_str(), sig.data(), (ULONG)sig.size(), &method));
+    EXPECT_EQ(methods[1], method);
+
+    // Methods defined on an earlier type are added to the end of its list.
+    HCORENUM hEnum = nullptr;
+    std::array<mdMethodDef, 8> enumerated;
+    ULONG count;
+    EXPECT_EQ(S_OK, import->EnumMethods(&hEnum, types[0], enumerated.data(), (ULONG)enumerated.size(), &count));
+    import->CloseEnum(hEnum);
+    EXPECT_THAT(std::vector(enumerated.begin(), enumerated.begin() + count),
+        testing::ElementsAre(methods[0], methods[2], methods[4], methods[6], privateScope, added));
+}
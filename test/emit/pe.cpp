@@ -0,0 +1,358 @@
+#include "emit.hpp"
+#include <dnmd.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t FileAlignment = 0x200;
+    constexpr uint32_t TextRva = 0x2000;
+    constexpr uint32_t DataRva = 0x8000;
+    constexpr uint32_t DataVirtualSize = 0x100;
+    constexpr uint32_t DataRawSize = 0x80;
+    constexpr uint32_t CliHeaderSize = 72;
+    constexpr uint32_t CodeRva = TextRva + CliHeaderSize;
+
+    // III.3.51 and III.3.59
+    constexpr uint8_t CEE_NOP = 0x00;
+    constexpr uint8_t CEE_RET = 0x2a;
+
+    void WriteU16(std::vector<uint8_t>& image, size_t offset, uint16_t value)
+    {
+        image[offset] = (uint8_t)value;
+        image[offset + 1] = (uint8_t)(value >> 8);
+    }
+
+    void WriteU32(std::vector<uint8_t>& image, size_t offset, uint32_t value)
+    {
+        WriteU16(image, offset, (uint16_t)value);
+        WriteU16(image, offset + 2, (uint16_t)(value >> 16));
+    }
+
+    uint32_t AlignUp(uint32_t value)
+    {
+        return (value + FileAlignment - 1) & ~(FileAlignment - 1);
+    }
+
+    void SaveMetadata(std::vector<uint8_t>& metadata, mdTypeRef* typeRef)
+    {
+        dncp::com_ptr<IMetaDataEmit> emit;
+        ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+        ASSERT_EQ(S_OK, emit->DefineTypeRefByName(TokenFromRid(1, mdtModule), W("System.Object"), typeRef));
+
+        DWORD saveSize;
+        ASSERT_EQ(S_OK, emit->GetSaveSize(cssAccurate, &saveSize));
+        metadata.resize(saveSize);
+        ASSERT_EQ(S_OK, emit->SaveToMemory(metadata.data(), (ULONG)metadata.size()));
+    }
+
+    // Create a file image with a .text section holding the CLI header, code at CodeRva and metadata,
+    // and a .data section with less raw data than its virtual size - II.25.
+    std::vector<uint8_t> CreatePEImage(std::vector<uint8_t> const& metadata, bool pe32Plus, uint16_t machine, uint32_t cliFlags, std::vector<uint8_t> const& code = {})
+    {
+        uint32_t const metadataOffset = CliHeaderSize + (((uint32_t)code.size() + 3) & ~3u);
+        uint32_t const lfanew = 0x80;
+        uint32_t const optionalHeader = lfanew + 4 + 20;
+        uint16_t const optionalHeaderSize = pe32Plus ? 240 : 224;
+        uint32_t const sectionHeaders = optionalHeader + optionalHeaderSize;
+        uint32_t const textFileOffset = AlignUp(sectionHeaders + 2 * 40);
+        uint32_t const textSize = AlignUp(metadataOffset + (uint32_t)metadata.size());
+        uint32_t const dataFileOffset = textFileOffset + textSize;
+
+        std::vector<uint8_t> image(dataFileOffset + FileAlignment);
+        WriteU16(image, 0, 0x5A4D);
+        WriteU32(image, 0x3c, lfanew);
+
+        WriteU32(image, lfanew, 0x00004550);
+        WriteU16(image, lfanew + 4, machine);
+        WriteU16(image, lfanew + 6, 2);
+        WriteU16(image, lfanew + 20, optionalHeaderSize);
+
+        WriteU16(image, optionalHeader, pe32Plus ? 0x20b : 0x10b);
+        uint32_t const directories = optionalHeader + (pe32Plus ? 112 : 96);
+        WriteU32(image, directories - 4, 16);
+        WriteU32(image, directories + 14 * 8, TextRva);
+        WriteU32(image, directories + 14 * 8 + 4, CliHeaderSize);
+
+        WriteU32(image, sectionHeaders + 8, textSize);
+        WriteU32(image, sectionHeaders + 12, TextRva);
+        WriteU32(image, sectionHeaders + 16, textSize);
+        WriteU32(image, sectionHeaders + 20, textFileOffset);
+        WriteU32(image, sectionHeaders + 40 + 8, DataVirtualSize);
+        WriteU32(image, sectionHeaders + 40 + 12, DataRva);
+        WriteU32(image, sectionHeaders + 40 + 16, DataRawSize);
+        WriteU32(image, sectionHeaders + 40 + 20, dataFileOffset);
+
+        WriteU32(image, textFileOffset, CliHeaderSize);
+        WriteU16(image, textFileOffset + 4, 2);
+        WriteU16(image, textFileOffset + 6, 5);
+        WriteU32(image, textFileOffset + 8, TextRva + metadataOffset);
+        WriteU32(image, textFileOffset + 12, (uint32_t)metadata.size());
+        WriteU32(image, textFileOffset + 16, cliFlags);
+        std::copy(code.begin(), code.end(), image.begin() + textFileOffset + CliHeaderSize);
+        std::memcpy(&image[textFileOffset + metadataOffset], metadata.data(), metadata.size());
+
+        image[dataFileOffset] = 0xa5;
+        return image;
+    }
+}
+
+TEST(PE, OpenScopeOnImage)
+{
+    std::vector<uint8_t> metadata;
+    mdTypeRef typeRef;
+    ASSERT_NO_FATAL_FAILURE(SaveMetadata(metadata, &typeRef));
+    std::vector<uint8_t> image = CreatePEImage(metadata, true, 0x8664, COMIMAGE_FLAGS_ILONLY);
+
+    dncp::com_ptr<IMetaDataDispenser> dispenser;
+    ASSERT_EQ(S_OK, GetDispenser(IID_IMetaDataDispenser, (void**)&dispenser));
+    dncp::com_ptr<IMetaDataImport2> import;
+    ASSERT_EQ(S_OK, dispenser->OpenScopeOnMemory(image.data(), (ULONG)image.size(), ofReadOnly, IID_IMetaDataImport2, (IUnknown**)&import));
+
+    DWORD peKind;
+    DWORD machine;
+    ASSERT_EQ(S_OK, import->GetPEKind(&peKind, &machine));
+    EXPECT_EQ((DWORD)(peILonly | pe32Plus), peKind);
+    EXPECT_EQ(0x8664u, machine);
+
+    // The metadata is read from the image.
+    mdToken resolutionScope;
+    ASSERT_EQ(S_OK, import->GetTypeRefProps(typeRef, &resolutionScope, nullptr, 0, nullptr));
+    EXPECT_EQ(TokenFromRid(1, mdtModule), resolutionScope);
+}
+
+TEST(PE, PEKind)
+{
+    std::vector<uint8_t> metadata;
+    mdTypeRef typeRef;
+    ASSERT_NO_FATAL_FAILURE(SaveMetadata(metadata, &typeRef));
+
+    dncp::com_ptr<IMetaDataDispenser> dispenser;
+    ASSERT_EQ(S_OK, GetDispenser(IID_IMetaDataDispenser, (void**)&dispenser));
+
+    std::vector<uint8_t> image = CreatePEImage(metadata, false, 0x14c, COMIMAGE_FLAGS_ILONLY | COMIMAGE_FLAGS_32BITREQUIRED | COMIMAGE_FLAGS_32BITPREFERRED);
+    dncp::com_ptr<IMetaDataImport2> import;
+    ASSERT_EQ(S_OK, dispenser->OpenScopeOnMemory(image.data(), (ULONG)image.size(), ofReadOnly, IID_IMetaDataImport2, (IUnknown**)&import));
+    DWORD peKind;
+    DWORD machine;
+    ASSERT_EQ(S_OK, import->GetPEKind(&peKind, &machine));
+    EXPECT_EQ((DWORD)(peILonly | pe32BitPreferred), peKind);
+    EXPECT_EQ(0x14cu, machine);
+
+    // Images that aren't IL-only are 32-bit.
+    image = CreatePEImage(metadata, false, 0x14c, 0);
+    ASSERT_EQ(S_OK, dispenser->OpenScopeOnMemory(image.data(), (ULONG)image.size(), ofReadOnly, IID_IMetaDataImport2, (IUnknown**)&import));
+    ASSERT_EQ(S_OK, import->GetPEKind(&peKind, &machine));
+    EXPECT_EQ((DWORD)pe32BitRequired, peKind);
+
+    // Scopes opened on the metadata alone have no PE envelope.
+    ASSERT_EQ(S_OK, dispenser->OpenScopeOnMemory(metadata.data(), (ULONG)metadata.size(), ofReadOnly, IID_IMetaDataImport2, (IUnknown**)&import));
+    EXPECT_EQ(E_NOTIMPL, import->GetPEKind(&peKind, &machine));
+}
+
+TEST(PE, RvaToData)
+{
+    std::vector<uint8_t> metadata;
+    mdTypeRef typeRef;
+    ASSERT_NO_FATAL_FAILURE(SaveMetadata(metadata, &typeRef));
+    std::vector<uint8_t> image = CreatePEImage(metadata, true, 0x8664, COMIMAGE_FLAGS_ILONLY);
+
+    mdpe_t pe;
+    ASSERT_TRUE(md_pe_open(image.data(), image.size(), mdpe_layout_flat, &pe));
+
+    md_pe_info_t info;
+    ASSERT_TRUE(md_pe_get_info(pe, &info));
+    EXPECT_TRUE(info.is_pe32_plus);
+    EXPECT_TRUE(info.has_cli_header);
+    EXPECT_EQ(2, info.major_runtime_version);
+    EXPECT_EQ(5, info.minor_runtime_version);
+
+    uint32_t rva;
+    uint32_t size;
+    ASSERT_TRUE(md_pe_get_directory(pe, 14, &rva, &size));
+    EXPECT_EQ(TextRva, rva);
+    EXPECT_EQ(CliHeaderSize, size);
+
+    // Data is found through the section table.
+    size_t available;
+    uint8_t const* data = md_pe_rva_to_data(pe, DataRva, &available);
+    ASSERT_NE(nullptr, data);
+    EXPECT_EQ(0xa5, *data);
+    EXPECT_EQ(DataRawSize, available);
+    data = md_pe_rva_to_data(pe, DataRva + 0x10, &available);
+    ASSERT_NE(nullptr, data);
+    EXPECT_EQ(DataRawSize - 0x10, available);
+
+    // Uninitialized data and RVAs outside of sections aren't in the file.
+    EXPECT_EQ(nullptr, md_pe_rva_to_data(pe, DataRva + DataRawSize, &available));
+    EXPECT_EQ(nullptr, md_pe_rva_to_data(pe, DataRva + DataVirtualSize, &available));
+    EXPECT_EQ(nullptr, md_pe_rva_to_data(pe, TextRva - 1, &available));
+
+    void const* peMetadata;
+    size_t peMetadataLen;
+    ASSERT_TRUE(md_pe_get_metadata(pe, &peMetadata, &peMetadataLen));
+    ASSERT_EQ(metadata.size(), peMetadataLen);
+    EXPECT_EQ(0, std::memcmp(metadata.data(), peMetadata, peMetadataLen));
+
+    // The handle keeps the PE alive.
+    mdhandle_t handle;
+    ASSERT_TRUE(md_create_handle_from_pe(pe, &handle));
+    md_pe_close(pe);
+    mdpe_t handlePE = md_get_pe(handle);
+    ASSERT_NE(nullptr, handlePE);
+    EXPECT_NE(nullptr, md_pe_rva_to_data(handlePE, DataRva, &available));
+    md_destroy_handle(handle);
+
+    // The image is truncated before the section headers.
+    EXPECT_FALSE(md_pe_open(image.data(), 0x100, mdpe_layout_flat, &pe));
+}
+
+TEST(PE, MappedLayout)
+{
+    std::vector<uint8_t> metadata;
+    mdTypeRef typeRef;
+    ASSERT_NO_FATAL_FAILURE(SaveMetadata(metadata, &typeRef));
+    std::vector<uint8_t> file = CreatePEImage(metadata, true, 0x8664, COMIMAGE_FLAGS_ILONLY);
+
+    // Map the headers and sections at their RVAs.
+    mdpe_t pe;
+    ASSERT_TRUE(md_pe_open(file.data(), file.size(), mdpe_layout_flat, &pe));
+    std::vector<uint8_t> mapped(DataRva + DataVirtualSize);
+    std::memcpy(mapped.data(), file.data(), FileAlignment);
+    size_t available;
+    uint8_t const* text = md_pe_rva_to_data(pe, TextRva, &available);
+    ASSERT_NE(nullptr, text);
+    std::memcpy(&mapped[TextRva], text, available);
+    uint8_t const* data = md_pe_rva_to_data(pe, DataRva, &available);
+    ASSERT_NE(nullptr, data);
+    std::memcpy(&mapped[DataRva], data, available);
+    md_pe_close(pe);
+
+    ASSERT_TRUE(md_pe_open(mapped.data(), mapped.size(), mdpe_layout_mapped, &pe));
+    EXPECT_EQ(&mapped[DataRva + DataRawSize], md_pe_rva_to_data(pe, DataRva + DataRawSize, &available));
+    EXPECT_EQ(DataVirtualSize - DataRawSize, available);
+
+    mdhandle_t handle;
+    ASSERT_TRUE(md_create_handle_from_pe(pe, &handle));
+    md_pe_close(pe);
+
+    mdcursor_t cursor;
+    ASSERT_TRUE(md_token_to_cursor(handle, typeRef, &cursor));
+    char const* name;
+    ASSERT_EQ(1, md_get_column_value_as_utf8(cursor, mdtTypeRef_TypeName, 1, &name));
+    EXPECT_STREQ("Object", name);
+    md_destroy_handle(handle);
+}
+
+TEST(PE, MethodBodies)
+{
+    // A tiny body followed by a fat body with a small and a fat exception section - II.25.4.
+    std::vector<uint8_t> code =
+    {
+        (3 << 2) | CorILMethod_TinyFormat, CEE_NOP, CEE_NOP, CEE_RET,
+        0x1b, 0x30, 0x02, 0x00, 0x05, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x11,
+        CEE_NOP, CEE_NOP, CEE_NOP, CEE_NOP, CEE_RET, 0x00, 0x00, 0x00,
+        CorILMethod_Sect_EHTable | CorILMethod_Sect_MoreSects, 16, 0x00, 0x00,
+        0x02, 0x00, 0x00, 0x00, 0x02, 0x02, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00,
+        CorILMethod_Sect_EHTable | CorILMethod_Sect_FatFormat, 28, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+        0x01, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01,
+    };
+    uint32_t const tinyRva = CodeRva;
+    uint32_t const fatRva = CodeRva + 4;
+
+    // Machine code of a native method in a mixed-mode image, which isn't a valid IL header.
+    uint32_t const nativeRva = CodeRva + (uint32_t)code.size();
+    code.insert(code.end(), { 0x48, 0x31, 0xc0, 0xc3 });
+
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    mdTypeDef typeDef;
+    mdToken implements = mdTokenNil;
+    ASSERT_EQ(S_OK, emit->DefineTypeDef(W("Foo"), tdPublic, mdTypeDefNil, &implements, &typeDef));
+    std::array<uint8_t, 3> signature = { IMAGE_CEE_CS_CALLCONV_DEFAULT, 0, ELEMENT_TYPE_VOID };
+    mdMethodDef fatMethod;
+    mdMethodDef tinyMethod;
+    mdMethodDef abstractMethod;
+    ASSERT_EQ(S_OK, emit->DefineMethod(typeDef, W("Fat"), mdPublic | mdStatic, signature.data(), (ULONG)signature.size(), fatRva, 0, &fatMethod));
+    ASSERT_EQ(S_OK, emit->DefineMethod(typeDef, W("Tiny"), mdPublic | mdStatic, signature.data(), (ULONG)signature.size(), tinyRva, 0, &tinyMethod));
+    ASSERT_EQ(S_OK, emit->DefineMethod(typeDef, W("Abstract"), mdPublic | mdAbstract | mdVirtual, signature.data(), (ULONG)signature.size(), 0, 0, &abstractMethod));
+    mdMethodDef nativeMethod;
+    ASSERT_EQ(S_OK, emit->DefineMethod(typeDef, W("Native"), mdPublic | mdStatic, signature.data(), (ULONG)signature.size(), nativeRva, miNative | miUnmanaged, &nativeMethod));
+
+    DWORD saveSize;
+    ASSERT_EQ(S_OK, emit->GetSaveSize(cssAccurate, &saveSize));
+    std::vector<uint8_t> metadata(saveSize);
+    ASSERT_EQ(S_OK, emit->SaveToMemory(metadata.data(), (ULONG)metadata.size()));
+    std::vector<uint8_t> image = CreatePEImage(metadata, true, 0x8664, COMIMAGE_FLAGS_ILONLY, code);
+
+    mdpe_t pe;
+    ASSERT_TRUE(md_pe_open(image.data(), image.size(), mdpe_layout_flat, &pe));
+    mdhandle_t handle;
+    ASSERT_TRUE(md_create_handle_from_pe(pe, &handle));
+    md_pe_close(pe);
+    mdhandle_ptr handlePtr{ handle };
+
+    mdcursor_t cursor;
+    md_method_body_t body;
+    ASSERT_TRUE(md_token_to_cursor(handle, tinyMethod, &cursor));
+    ASSERT_TRUE(md_get_method_body(cursor, &body));
+    EXPECT_EQ(tinyMethod, body.method);
+    EXPECT_EQ((uint16_t)CorILMethod_TinyFormat, body.flags);
+    EXPECT_EQ(8, body.max_stack);
+    EXPECT_EQ(0u, body.local_var_sig);
+    ASSERT_EQ(3u, body.il_size);
+    EXPECT_EQ(CEE_RET, body.il[2]);
+    EXPECT_EQ(0u, body.exception_clause_count);
+
+    ASSERT_TRUE(md_token_to_cursor(handle, fatMethod, &cursor));
+    ASSERT_TRUE(md_get_method_body(cursor, &body));
+    EXPECT_EQ((uint16_t)(CorILMethod_FatFormat | CorILMethod_MoreSects | CorILMethod_InitLocals), body.flags);
+    EXPECT_EQ(2, body.max_stack);
+    EXPECT_EQ(TokenFromRid(1, mdtSignature), body.local_var_sig);
+    ASSERT_EQ(5u, body.il_size);
+    EXPECT_EQ(CEE_RET, body.il[4]);
+    ASSERT_EQ(2u, body.exception_clause_count);
+
+    // The buffer is too small.
+    std::array<md_exception_clause_t, 2> clauses;
+    uint32_t clauseCount = 1;
+    EXPECT_FALSE(md_get_exception_clauses(&body, clauses.data(), &clauseCount));
+    EXPECT_EQ(2u, clauseCount);
+
+    ASSERT_TRUE(md_get_exception_clauses(&body, clauses.data(), &clauseCount));
+    EXPECT_EQ((uint32_t)COR_ILEXCEPTION_CLAUSE_FINALLY, clauses[0].flags);
+    EXPECT_EQ(0u, clauses[0].try_offset);
+    EXPECT_EQ(2u, clauses[0].try_length);
+    EXPECT_EQ(2u, clauses[0].handler_offset);
+    EXPECT_EQ(3u, clauses[0].handler_length);
+    EXPECT_EQ((uint32_t)COR_ILEXCEPTION_CLAUSE_NONE, clauses[1].flags);
+    EXPECT_EQ(1u, clauses[1].try_length);
+    EXPECT_EQ(1u, clauses[1].handler_offset);
+    EXPECT_EQ(4u, clauses[1].handler_length);
+    EXPECT_EQ(TokenFromRid(1, mdtTypeRef), clauses[1].class_token_or_filter_offset);
+
+    ASSERT_TRUE(md_token_to_cursor(handle, abstractMethod, &cursor));
+    EXPECT_FALSE(md_get_method_body(cursor, &body));
+    ASSERT_TRUE(md_token_to_cursor(handle, nativeMethod, &cursor));
+    EXPECT_FALSE(md_get_method_body(cursor, &body));
+
+    // All IL bodies are returned in RVA order.
+    uint32_t bodyCount;
+    ASSERT_TRUE(md_get_method_bodies(handle, nullptr, &bodyCount));
+    ASSERT_EQ(2u, bodyCount);
+    std::array<md_method_body_t, 2> bodies;
+    ASSERT_TRUE(md_get_method_bodies(handle, bodies.data(), &bodyCount));
+    EXPECT_EQ(tinyMethod, bodies[0].method);
+    EXPECT_EQ(tinyRva, bodies[0].rva);
+    EXPECT_EQ(fatMethod, bodies[1].method);
+    EXPECT_EQ(2u, bodies[1].exception_clause_count);
+
+    // Handles without a PE have no bodies.
+    mdhandle_t metadataHandle;
+    ASSERT_TRUE(md_create_handle(metadata.data(), metadata.size(), &metadataHandle));
+    mdhandle_ptr metadataHandlePtr{ metadataHandle };
+    ASSERT_TRUE(md_token_to_cursor(metadataHandle, tinyMethod, &cursor));
+    EXPECT_FALSE(md_get_method_body(cursor, &body));
+}
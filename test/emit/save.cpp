@@ -0,0 +1,261 @@
+#include "emit.hpp"
+#include <dnmd.hpp>
+#include <cstring>
+#include <string>
+#include <vector>
+
+TEST(Save, SizeMatchesSavedImage)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    mdTypeRef typeRef;
+    WSTR_string name = W("System.Object");
+    ASSERT_EQ(S_OK, emit->DefineTypeRefByName(TokenFromRid(1, mdtModule), name.c_str(), &typeRef));
+
+    DWORD saveSize;
+    ASSERT_EQ(S_OK, emit->GetSaveSize(cssAccurate, &saveSize));
+    std::vector<uint8_t> image(saveSize);
+    ASSERT_EQ(S_OK, emit->SaveToMemory(image.data(), (ULONG)image.size()));
+
+    // Saving into a buffer that's too small should fail.
+    std::vector<uint8_t> smallImage(saveSize - 1);
+    EXPECT_NE(S_OK, emit->SaveToMemory(smallImage.data(), (ULONG)smallImage.size()));
+
+    dncp::com_ptr<IMetaDataDispenser> dispenser;
+    ASSERT_EQ(S_OK, GetDispenser(IID_IMetaDataDispenser, (void**)&dispenser));
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, dispenser->OpenScopeOnMemory(image.data(), (ULONG)image.size(), ofReadOnly, IID_IMetaDataImport, (IUnknown**)&import));
+
+    mdToken resolutionScope;
+    WSTR_string readName;
+    readName.resize(name.capacity() + 1);
+    ULONG readNameLength;
+    ASSERT_EQ(S_OK, import->GetTypeRefProps(typeRef, &resolutionScope, readName.data(), (ULONG)readName.size(), &readNameLength));
+    EXPECT_EQ(TokenFromRid(1, mdtModule), resolutionScope);
+    EXPECT_EQ(name, readName.substr(0, readNameLength - 1));
+}
+
+TEST(Save, SizeUpdatedAfterEdit)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+
+    DWORD initialSize;
+    ASSERT_EQ(S_OK, emit->GetSaveSize(cssAccurate, &initialSize));
+
+    mdTypeRef typeRef;
+    ASSERT_EQ(S_OK, emit->DefineTypeRefByName(TokenFromRid(1, mdtModule), W("System.Object"), &typeRef));
+
+    DWORD updatedSize;
+    ASSERT_EQ(S_OK, emit->GetSaveSize(cssAccurate, &updatedSize));
+    EXPECT_LT(initialSize, updatedSize);
+
+    std::vector<uint8_t> image(updatedSize);
+    ASSERT_EQ(S_OK, emit->SaveToMemory(image.data(), (ULONG)image.size()));
+}
+
+namespace
+{
+    // Check the name and resolution scope of every TypeRef by walking the table with a cursor.
+    void VerifyTypeRefs(mdhandle_t handle, std::vector<std::string> const& names, std::vector<mdToken> const& scopes)
+    {
+        mdcursor_t cursor;
+        uint32_t count;
+        ASSERT_TRUE(md_create_cursor(handle, mdtid_TypeRef, &cursor, &count));
+        ASSERT_EQ(names.size(), count);
+        for (uint32_t i = 0; i < count; ++i, md_cursor_next(&cursor))
+        {
+            char const* name;
+            mdToken scope;
+            ASSERT_EQ(1, md_get_column_value_as_utf8(cursor, mdtTypeRef_TypeName, 1, &name));
+            ASSERT_EQ(1, md_get_column_value_as_token(cursor, mdtTypeRef_ResolutionScope, 1, &scope));
+            EXPECT_EQ(names[i], name) << "TypeRef " << (i + 1);
+            EXPECT_EQ(scopes[i], scope) << "TypeRef " << (i + 1);
+        }
+    }
+}
+
+TEST(Save, EditRowsAcrossTableSegments)
+{
+    // Tables over 4KB are copied on write in segments of about 4KB, so 3000 TypeRefs span several segments.
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    uint32_t const typeRefCount = 3000;
+    std::vector<std::string> names;
+    std::vector<mdToken> scopes(typeRefCount, TokenFromRid(1, mdtModule));
+    for (uint32_t i = 0; i < typeRefCount; ++i)
+    {
+        names.push_back("Type" + std::to_string(i + 1));
+        WSTR_string name{ names.back().begin(), names.back().end() };
+        mdTypeRef typeRef;
+        ASSERT_EQ(S_OK, emit->DefineTypeRefByName(TokenFromRid(1, mdtModule), name.c_str(), &typeRef));
+    }
+
+    DWORD saveSize;
+    ASSERT_EQ(S_OK, emit->GetSaveSize(cssAccurate, &saveSize));
+    std::vector<uint8_t> image(saveSize);
+    ASSERT_EQ(S_OK, emit->SaveToMemory(image.data(), (ULONG)image.size()));
+    std::vector<uint8_t> const original = image;
+
+    mdhandle_t handle;
+    ASSERT_TRUE(md_create_handle(image.data(), image.size(), &handle));
+    mdhandle_ptr handlePtr{ handle };
+
+    md_table_layout_t layout;
+    ASSERT_TRUE(md_get_table_layout(handle, mdtid_TypeRef, &layout));
+    ASSERT_GT((size_t)layout.row_size * layout.row_count, (size_t)4 * 4096);
+
+    // Edit rows at the start and end of the table, in the middle, and twice in one segment.
+    for (uint32_t rid : { 1u, 700u, 701u, 1500u, 2400u, typeRefCount })
+    {
+        mdcursor_t cursor;
+        ASSERT_TRUE(md_token_to_cursor(handle, TokenFromRid(rid, mdtTypeRef), &cursor));
+        names[rid - 1] = "Edited" + std::to_string(rid);
+        char const* name = names[rid - 1].c_str();
+        ASSERT_EQ(1, md_set_column_value_as_utf8(cursor, mdtTypeRef_TypeName, 1, &name));
+        if (rid % 2 == 0)
+        {
+            scopes[rid - 1] = TokenFromRid(1, mdtTypeRef);
+            ASSERT_EQ(1, md_set_column_value_as_token(cursor, mdtTypeRef_ResolutionScope, 1, &scopes[rid - 1]));
+        }
+    }
+
+    // The edits are visible through cursors, and the image the handle was created from is unchanged.
+    ASSERT_NO_FATAL_FAILURE(VerifyTypeRefs(handle, names, scopes));
+    EXPECT_TRUE(image == original);
+
+    size_t editedSize = 0;
+    ASSERT_FALSE(md_write_to_buffer(handle, nullptr, &editedSize));
+    std::vector<uint8_t> edited(editedSize);
+    ASSERT_TRUE(md_write_to_buffer(handle, edited.data(), &editedSize));
+
+    mdhandle_t reopened;
+    ASSERT_TRUE(md_create_handle(edited.data(), edited.size(), &reopened));
+    mdhandle_ptr reopenedPtr{ reopened };
+    ASSERT_NO_FATAL_FAILURE(VerifyTypeRefs(reopened, names, scopes));
+}
+
+namespace
+{
+    void VerifySignatures(mdhandle_t handle, std::vector<std::vector<uint8_t>> const& signatures)
+    {
+        mdcursor_t cursor;
+        uint32_t count;
+        ASSERT_TRUE(md_create_cursor(handle, mdtid_StandAloneSig, &cursor, &count));
+        ASSERT_EQ(signatures.size(), count);
+        for (uint32_t i = 0; i < count; ++i, md_cursor_next(&cursor))
+        {
+            uint8_t const* blob;
+            uint32_t blobLength;
+            ASSERT_EQ(1, md_get_column_value_as_blob(cursor, mdtStandAloneSig_Signature, 1, &blob, &blobLength));
+            ASSERT_EQ(signatures[i].size(), blobLength) << "StandAloneSig " << (i + 1);
+            EXPECT_EQ(0, memcmp(signatures[i].data(), blob, blobLength)) << "StandAloneSig " << (i + 1);
+        }
+    }
+
+    // Check that the written image holds the same heaps and rows as the handle it was written from.
+    void VerifySameContents(mdhandle_t expected, mdhandle_t actual)
+    {
+        for (md_heap_id_t heap : { mdhid_String, mdhid_Guid, mdhid_Blob, mdhid_UserString })
+        {
+            uint8_t const* expectedData;
+            uint32_t expectedSize;
+            uint8_t const* actualData;
+            uint32_t actualSize;
+            ASSERT_TRUE(md_get_heap(expected, heap, &expectedData, &expectedSize));
+            ASSERT_TRUE(md_get_heap(actual, heap, &actualData, &actualSize));
+            ASSERT_EQ(expectedSize, actualSize) << "Heap " << heap;
+            EXPECT_EQ(0, memcmp(expectedData, actualData, expectedSize)) << "Heap " << heap;
+        }
+
+        for (uint32_t table = mdtid_First; table < mdtid_End; ++table)
+        {
+            md_table_layout_t expectedLayout;
+            md_table_layout_t actualLayout;
+            ASSERT_TRUE(md_get_table_layout(expected, (mdtable_id_t)table, &expectedLayout));
+            ASSERT_TRUE(md_get_table_layout(actual, (mdtable_id_t)table, &actualLayout));
+            ASSERT_EQ(expectedLayout.row_count, actualLayout.row_count) << "Table " << table;
+            ASSERT_EQ(expectedLayout.row_size, actualLayout.row_size) << "Table " << table;
+            for (uint32_t row = 1; row <= expectedLayout.row_count; ++row)
+            {
+                uint8_t const* expectedRow;
+                uint8_t const* actualRow;
+                ASSERT_TRUE(md_get_row_raw(expected, (mdtable_id_t)table, row, &expectedRow));
+                ASSERT_TRUE(md_get_row_raw(actual, (mdtable_id_t)table, row, &actualRow));
+                ASSERT_EQ(0, memcmp(expectedRow, actualRow, expectedLayout.row_size)) << "Table " << table << " row " << row;
+            }
+        }
+    }
+}
+
+TEST(Save, LargeImageCopiedInParallel)
+{
+    // Images of 4MB or more are copied by several worker threads in 256KB chunks.
+    // The stream headers are written on the calling thread either way, so the image matches the
+    // one the serial path would write as long as every heap and row matches the handle's own data.
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    uint32_t const typeRefCount = 3000;
+    std::vector<std::string> names;
+    std::vector<mdToken> scopes(typeRefCount, TokenFromRid(1, mdtModule));
+    for (uint32_t i = 0; i < typeRefCount; ++i)
+    {
+        names.push_back("Type" + std::to_string(i + 1));
+        WSTR_string name{ names.back().begin(), names.back().end() };
+        mdTypeRef typeRef;
+        ASSERT_EQ(S_OK, emit->DefineTypeRefByName(TokenFromRid(1, mdtModule), name.c_str(), &typeRef));
+    }
+
+    // Fill the #Blob heap with distinct signatures so it spans many chunks.
+    std::vector<std::vector<uint8_t>> signatures;
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        std::vector<uint8_t> signature(48 * 1024);
+        for (size_t j = 0; j < signature.size(); ++j)
+            signature[j] = (uint8_t)(i * 31 + j * 7);
+        mdSignature token;
+        ASSERT_EQ(S_OK, emit->GetTokenFromSig(signature.data(), (ULONG)signature.size(), &token));
+        ASSERT_EQ(TokenFromRid(i + 1, mdtSignature), token);
+        signatures.push_back(std::move(signature));
+    }
+
+    DWORD saveSize;
+    ASSERT_EQ(S_OK, emit->GetSaveSize(cssAccurate, &saveSize));
+    ASSERT_GE(saveSize, 4u * 1024 * 1024);
+    std::vector<uint8_t> image(saveSize);
+    ASSERT_EQ(S_OK, emit->SaveToMemory(image.data(), (ULONG)image.size()));
+
+    mdhandle_t handle;
+    ASSERT_TRUE(md_create_handle(image.data(), image.size(), &handle));
+    mdhandle_ptr handlePtr{ handle };
+    ASSERT_NO_FATAL_FAILURE(VerifyTypeRefs(handle, names, scopes));
+    ASSERT_NO_FATAL_FAILURE(VerifySignatures(handle, signatures));
+
+    // Edit rows in different copy-on-write segments so the copies read from both the segments and the image.
+    for (uint32_t rid : { 1u, 1500u, typeRefCount })
+    {
+        mdcursor_t cursor;
+        ASSERT_TRUE(md_token_to_cursor(handle, TokenFromRid(rid, mdtTypeRef), &cursor));
+        names[rid - 1] = "Edited" + std::to_string(rid);
+        char const* name = names[rid - 1].c_str();
+        ASSERT_EQ(1, md_set_column_value_as_utf8(cursor, mdtTypeRef_TypeName, 1, &name));
+    }
+
+    size_t editedSize = 0;
+    ASSERT_FALSE(md_write_to_buffer(handle, nullptr, &editedSize));
+    ASSERT_GE(editedSize, (size_t)4 * 1024 * 1024);
+    std::vector<uint8_t> edited(editedSize);
+    ASSERT_TRUE(md_write_to_buffer(handle, edited.data(), &editedSize));
+
+    mdhandle_t reopened;
+    ASSERT_TRUE(md_create_handle(edited.data(), edited.size(), &reopened));
+    mdhandle_ptr reopenedPtr{ reopened };
+    ASSERT_NO_FATAL_FAILURE(VerifyTypeRefs(reopened, names, scopes));
+    ASSERT_NO_FATAL_FAILURE(VerifySignatures(reopened, signatures));
+    ASSERT_NO_FATAL_FAILURE(VerifySameContents(handle, reopened));
+
+    // Writing again gives the same bytes.
+    std::vector<uint8_t> rewritten(editedSize);
+    ASSERT_TRUE(md_write_to_buffer(handle, rewritten.data(), &editedSize));
+    EXPECT_TRUE(edited == rewritten);
+}
@@ -0,0 +1,320 @@
+#include "emit.hpp"
+#include <dnmd.hpp>
+
+#include <vector>
+
+namespace
+{
+    // A saved scope with each signature in a StandAloneSig row.
+    struct SignatureScope
+    {
+        std::vector<uint8_t> image;
+        mdhandle_ptr handle;
+        std::vector<mdSignature> tokens;
+    };
+
+    void CreateScope(std::vector<std::vector<uint8_t>> const& sigs, SignatureScope& scope)
+    {
+        dncp::com_ptr<IMetaDataEmit> emit;
+        ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+        for (std::vector<uint8_t> const& sig : sigs)
+        {
+            mdSignature token;
+            ASSERT_EQ(S_OK, emit->GetTokenFromSig(sig.data(), (ULONG)sig.size(), &token));
+            scope.tokens.push_back(token);
+        }
+
+        DWORD saveSize;
+        ASSERT_EQ(S_OK, emit->GetSaveSize(cssAccurate, &saveSize));
+        scope.image.resize(saveSize);
+        ASSERT_EQ(S_OK, emit->SaveToMemory(scope.image.data(), (ULONG)scope.image.size()));
+        mdhandle_t handle;
+        ASSERT_TRUE(md_create_handle(scope.image.data(), scope.image.size(), &handle));
+        scope.handle.reset(handle);
+    }
+
+    // Decode the signature of a StandAloneSig row from the blob heap.
+    md_blob_parse_result_t GetSignature(SignatureScope const& scope, size_t index, md_signature_t const** signature)
+    {
+        mdcursor_t cursor;
+        uint8_t const* sig;
+        uint32_t sigLen;
+        EXPECT_TRUE(md_token_to_cursor(scope.handle.get(), scope.tokens[index], &cursor));
+        EXPECT_EQ(1, md_get_column_value_as_blob(cursor, mdtStandAloneSig_Signature, 1, &sig, &sigLen));
+        return md_get_signature(scope.handle.get(), sig, sigLen, signature);
+    }
+
+    // Compressed TypeDefOrRef coded indexes - ECMA-335 II.23.2.8
+    uint8_t const TypeDef2 = 2 << 2 | 0;
+    uint8_t const TypeRef1 = 1 << 2 | 1;
+    uint8_t const TypeRef2 = 2 << 2 | 1;
+    uint8_t const TypeSpec1 = 1 << 2 | 2;
+}
+
+TEST(Signature, GenericInstantiations)
+{
+    SignatureScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope({
+        // Field of type TypeRef1<int32, TypeDef2<!0>>
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_GENERICINST, ELEMENT_TYPE_CLASS, TypeRef1, 2,
+            ELEMENT_TYPE_I4,
+            ELEMENT_TYPE_GENERICINST, ELEMENT_TYPE_VALUETYPE, TypeDef2, 1, ELEMENT_TYPE_VAR, 0 },
+        // Instance generic method: !!0 M<T1, T2>(!1)
+        { IMAGE_CEE_CS_CALLCONV_HASTHIS | IMAGE_CEE_CS_CALLCONV_GENERIC, 2, 1, ELEMENT_TYPE_MVAR, 0, ELEMENT_TYPE_VAR, 1 },
+        // MethodSpec instantiation: <!!1, string>
+        { IMAGE_CEE_CS_CALLCONV_GENERICINST, 2, ELEMENT_TYPE_MVAR, 1, ELEMENT_TYPE_STRING },
+    }, scope));
+
+    md_signature_t const* field;
+    ASSERT_EQ(mdbpr_Success, GetSignature(scope, 0, &field));
+    EXPECT_EQ(IMAGE_CEE_CS_CALLCONV_FIELD, field->calling_convention);
+    EXPECT_EQ(0u, field->param_count);
+    EXPECT_EQ(nullptr, field->params);
+    md_signature_type_t const* inst = field->return_type;
+    ASSERT_EQ(ELEMENT_TYPE_GENERICINST, inst->element_type);
+    EXPECT_EQ(ELEMENT_TYPE_CLASS, inst->data.generic_inst.type->element_type);
+    EXPECT_EQ(TokenFromRid(1, mdtTypeRef), inst->data.generic_inst.type->data.token);
+    ASSERT_EQ(2u, inst->data.generic_inst.arg_count);
+    EXPECT_EQ(ELEMENT_TYPE_I4, inst->data.generic_inst.args[0].element_type);
+    md_signature_type_t const* nested = &inst->data.generic_inst.args[1];
+    ASSERT_EQ(ELEMENT_TYPE_GENERICINST, nested->element_type);
+    EXPECT_EQ(ELEMENT_TYPE_VALUETYPE, nested->data.generic_inst.type->element_type);
+    EXPECT_EQ(TokenFromRid(2, mdtTypeDef), nested->data.generic_inst.type->data.token);
+    ASSERT_EQ(1u, nested->data.generic_inst.arg_count);
+    EXPECT_EQ(ELEMENT_TYPE_VAR, nested->data.generic_inst.args[0].element_type);
+    EXPECT_EQ(0u, nested->data.generic_inst.args[0].data.generic_param_index);
+
+    md_signature_t const* method;
+    ASSERT_EQ(mdbpr_Success, GetSignature(scope, 1, &method));
+    EXPECT_EQ(IMAGE_CEE_CS_CALLCONV_HASTHIS | IMAGE_CEE_CS_CALLCONV_GENERIC, method->calling_convention);
+    EXPECT_EQ(2u, method->generic_param_count);
+    ASSERT_EQ(1u, method->param_count);
+    EXPECT_EQ(1u, method->vararg_index);
+    EXPECT_EQ(ELEMENT_TYPE_MVAR, method->return_type->element_type);
+    EXPECT_EQ(0u, method->return_type->data.generic_param_index);
+    EXPECT_EQ(ELEMENT_TYPE_VAR, method->params[0].element_type);
+    EXPECT_EQ(1u, method->params[0].data.generic_param_index);
+
+    md_signature_t const* methodSpec;
+    ASSERT_EQ(mdbpr_Success, GetSignature(scope, 2, &methodSpec));
+    EXPECT_EQ(IMAGE_CEE_CS_CALLCONV_GENERICINST, methodSpec->calling_convention);
+    EXPECT_EQ(nullptr, methodSpec->return_type);
+    ASSERT_EQ(2u, methodSpec->param_count);
+    EXPECT_EQ(ELEMENT_TYPE_MVAR, methodSpec->params[0].element_type);
+    EXPECT_EQ(1u, methodSpec->params[0].data.generic_param_index);
+    EXPECT_EQ(ELEMENT_TYPE_STRING, methodSpec->params[1].element_type);
+}
+
+TEST(Signature, Arrays)
+{
+    SignatureScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope({
+        // int32[][]
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_SZARRAY, ELEMENT_TYPE_SZARRAY, ELEMENT_TYPE_I4 },
+        // int32[0...2, -1...2] - the lower bounds are signed, so -1 is compressed to 0x7f.
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_ARRAY, ELEMENT_TYPE_I4, 2, 2, 3, 4, 2, 0, 0x7f },
+        // TypeSpec1[,,] without sizes or lower bounds
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_ARRAY, ELEMENT_TYPE_CLASS, TypeSpec1, 3, 0, 0 },
+    }, scope));
+
+    md_signature_t const* jagged;
+    ASSERT_EQ(mdbpr_Success, GetSignature(scope, 0, &jagged));
+    ASSERT_EQ(ELEMENT_TYPE_SZARRAY, jagged->return_type->element_type);
+    ASSERT_EQ(ELEMENT_TYPE_SZARRAY, jagged->return_type->data.type->element_type);
+    EXPECT_EQ(ELEMENT_TYPE_I4, jagged->return_type->data.type->data.type->element_type);
+
+    md_signature_t const* bounded;
+    ASSERT_EQ(mdbpr_Success, GetSignature(scope, 1, &bounded));
+    md_signature_type_t const* array = bounded->return_type;
+    ASSERT_EQ(ELEMENT_TYPE_ARRAY, array->element_type);
+    EXPECT_EQ(ELEMENT_TYPE_I4, array->data.array.type->element_type);
+    md_array_shape_t const* shape = array->data.array.shape;
+    EXPECT_EQ(2u, shape->rank);
+    ASSERT_EQ(2u, shape->size_count);
+    EXPECT_EQ(3u, shape->sizes[0]);
+    EXPECT_EQ(4u, shape->sizes[1]);
+    ASSERT_EQ(2u, shape->lower_bound_count);
+    EXPECT_EQ(0, shape->lower_bounds[0]);
+    EXPECT_EQ(-1, shape->lower_bounds[1]);
+
+    md_signature_t const* unbounded;
+    ASSERT_EQ(mdbpr_Success, GetSignature(scope, 2, &unbounded));
+    array = unbounded->return_type;
+    ASSERT_EQ(ELEMENT_TYPE_ARRAY, array->element_type);
+    EXPECT_EQ(ELEMENT_TYPE_CLASS, array->data.array.type->element_type);
+    EXPECT_EQ(TokenFromRid(1, mdtTypeSpec), array->data.array.type->data.token);
+    EXPECT_EQ(3u, array->data.array.shape->rank);
+    EXPECT_EQ(0u, array->data.array.shape->size_count);
+    EXPECT_EQ(0u, array->data.array.shape->lower_bound_count);
+}
+
+TEST(Signature, CustomModifiers)
+{
+    SignatureScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope({
+        // int32 modreq(TypeRef1) - a volatile field
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_CMOD_REQD, TypeRef1, ELEMENT_TYPE_I4 },
+        // void (int32& modreq(TypeRef1) modopt(TypeRef2)) - an 'in' parameter
+        { IMAGE_CEE_CS_CALLCONV_DEFAULT, 1, ELEMENT_TYPE_VOID,
+            ELEMENT_TYPE_CMOD_OPT, TypeRef2, ELEMENT_TYPE_CMOD_REQD, TypeRef1, ELEMENT_TYPE_BYREF, ELEMENT_TYPE_I4 },
+        // Locals: pinned int32&, typedref
+        { IMAGE_CEE_CS_CALLCONV_LOCAL_SIG, 2, ELEMENT_TYPE_PINNED, ELEMENT_TYPE_BYREF, ELEMENT_TYPE_I4, ELEMENT_TYPE_TYPEDBYREF },
+    }, scope));
+
+    md_signature_t const* field;
+    ASSERT_EQ(mdbpr_Success, GetSignature(scope, 0, &field));
+    md_signature_type_t const* modifier = field->return_type;
+    ASSERT_EQ(ELEMENT_TYPE_CMOD_REQD, modifier->element_type);
+    EXPECT_EQ(TokenFromRid(1, mdtTypeRef), modifier->data.modifier.token);
+    EXPECT_EQ(ELEMENT_TYPE_I4, modifier->data.modifier.type->element_type);
+
+    // Modifiers wrap the type they apply to, in signature order.
+    md_signature_t const* method;
+    ASSERT_EQ(mdbpr_Success, GetSignature(scope, 1, &method));
+    ASSERT_EQ(1u, method->param_count);
+    modifier = &method->params[0];
+    ASSERT_EQ(ELEMENT_TYPE_CMOD_OPT, modifier->element_type);
+    EXPECT_EQ(TokenFromRid(2, mdtTypeRef), modifier->data.modifier.token);
+    modifier = modifier->data.modifier.type;
+    ASSERT_EQ(ELEMENT_TYPE_CMOD_REQD, modifier->element_type);
+    EXPECT_EQ(TokenFromRid(1, mdtTypeRef), modifier->data.modifier.token);
+    md_signature_type_t const* byref = modifier->data.modifier.type;
+    ASSERT_EQ(ELEMENT_TYPE_BYREF, byref->element_type);
+    EXPECT_EQ(ELEMENT_TYPE_I4, byref->data.type->element_type);
+
+    md_signature_t const* locals;
+    ASSERT_EQ(mdbpr_Success, GetSignature(scope, 2, &locals));
+    EXPECT_EQ(IMAGE_CEE_CS_CALLCONV_LOCAL_SIG, locals->calling_convention);
+    EXPECT_EQ(nullptr, locals->return_type);
+    ASSERT_EQ(2u, locals->param_count);
+    ASSERT_EQ(ELEMENT_TYPE_PINNED, locals->params[0].element_type);
+    EXPECT_EQ(ELEMENT_TYPE_BYREF, locals->params[0].data.type->element_type);
+    EXPECT_EQ(ELEMENT_TYPE_TYPEDBYREF, locals->params[1].element_type);
+}
+
+TEST(Signature, FunctionPointers)
+{
+    SignatureScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope({
+        // int32 (*)(int32, uint8*) with the unmanaged cdecl calling convention
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_FNPTR, IMAGE_CEE_CS_CALLCONV_C, 2, ELEMENT_TYPE_I4, ELEMENT_TYPE_I4, ELEMENT_TYPE_PTR, ELEMENT_TYPE_U1 },
+        // vararg void (int32, ..., string)
+        { IMAGE_CEE_CS_CALLCONV_VARARG, 2, ELEMENT_TYPE_VOID, ELEMENT_TYPE_I4, ELEMENT_TYPE_SENTINEL, ELEMENT_TYPE_STRING },
+        // Function pointers must have a method signature.
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_FNPTR, IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_I4 },
+        // Only one sentinel is allowed.
+        { IMAGE_CEE_CS_CALLCONV_VARARG, 2, ELEMENT_TYPE_VOID, ELEMENT_TYPE_SENTINEL, ELEMENT_TYPE_I4, ELEMENT_TYPE_SENTINEL, ELEMENT_TYPE_STRING },
+    }, scope));
+
+    md_signature_t const* field;
+    ASSERT_EQ(mdbpr_Success, GetSignature(scope, 0, &field));
+    ASSERT_EQ(ELEMENT_TYPE_FNPTR, field->return_type->element_type);
+    md_signature_t const* fnptr = field->return_type->data.method;
+    EXPECT_EQ(IMAGE_CEE_CS_CALLCONV_C, fnptr->calling_convention);
+    EXPECT_EQ(ELEMENT_TYPE_I4, fnptr->return_type->element_type);
+    ASSERT_EQ(2u, fnptr->param_count);
+    EXPECT_EQ(ELEMENT_TYPE_I4, fnptr->params[0].element_type);
+    ASSERT_EQ(ELEMENT_TYPE_PTR, fnptr->params[1].element_type);
+    EXPECT_EQ(ELEMENT_TYPE_U1, fnptr->params[1].data.type->element_type);
+
+    md_signature_t const* vararg;
+    ASSERT_EQ(mdbpr_Success, GetSignature(scope, 1, &vararg));
+    EXPECT_EQ(IMAGE_CEE_CS_CALLCONV_VARARG, vararg->calling_convention);
+    ASSERT_EQ(2u, vararg->param_count);
+    EXPECT_EQ(1u, vararg->vararg_index);
+    EXPECT_EQ(ELEMENT_TYPE_STRING, vararg->params[1].element_type);
+
+    md_signature_t const* invalid;
+    EXPECT_EQ(mdbpr_InvalidBlob, GetSignature(scope, 2, &invalid));
+    EXPECT_EQ(mdbpr_InvalidBlob, GetSignature(scope, 3, &invalid));
+}
+
+TEST(Signature, TruncatedSignatures)
+{
+    std::vector<std::vector<uint8_t>> valid = {
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_GENERICINST, ELEMENT_TYPE_CLASS, TypeRef1, 2, ELEMENT_TYPE_I4, ELEMENT_TYPE_VAR, 0 },
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_ARRAY, ELEMENT_TYPE_I4, 2, 2, 3, 4, 2, 0, 0x7f },
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_FNPTR, IMAGE_CEE_CS_CALLCONV_DEFAULT, 1, ELEMENT_TYPE_VOID, ELEMENT_TYPE_CMOD_OPT, TypeRef2, ELEMENT_TYPE_I4 },
+        { IMAGE_CEE_CS_CALLCONV_HASTHIS | IMAGE_CEE_CS_CALLCONV_GENERIC, 1, 2, ELEMENT_TYPE_VOID, ELEMENT_TYPE_MVAR, 0, ELEMENT_TYPE_SZARRAY, ELEMENT_TYPE_STRING },
+        { IMAGE_CEE_CS_CALLCONV_PROPERTY | IMAGE_CEE_CS_CALLCONV_HASTHIS, 1, ELEMENT_TYPE_I4, ELEMENT_TYPE_STRING },
+    };
+
+    // Every prefix of a valid signature is missing part of it.
+    std::vector<std::vector<uint8_t>> sigs;
+    for (std::vector<uint8_t> const& sig : valid)
+    {
+        for (size_t len = 1; len < sig.size(); ++len)
+            sigs.emplace_back(sig.begin(), sig.begin() + len);
+    }
+
+    SignatureScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope(sigs, scope));
+    for (size_t i = 0; i < sigs.size(); ++i)
+    {
+        md_signature_t const* signature;
+        EXPECT_EQ(mdbpr_InvalidBlob, GetSignature(scope, i, &signature)) << "Signature " << i;
+    }
+}
+
+TEST(Signature, CorruptSignatures)
+{
+    // A type nested deeper than the decoder allows.
+    std::vector<uint8_t> deep(200, ELEMENT_TYPE_SZARRAY);
+    deep.insert(deep.begin(), IMAGE_CEE_CS_CALLCONV_FIELD);
+    deep.push_back(ELEMENT_TYPE_I4);
+
+    SignatureScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope({
+        // Unknown element type
+        { IMAGE_CEE_CS_CALLCONV_FIELD, 0x40 },
+        // Sentinels are only valid between parameters
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_SENTINEL },
+        // Unknown calling convention
+        { 0x0f, 0, ELEMENT_TYPE_VOID },
+        // More parameters than bytes in the signature
+        { IMAGE_CEE_CS_CALLCONV_DEFAULT, 0x7f, ELEMENT_TYPE_VOID, ELEMENT_TYPE_I4 },
+        // More generic arguments than bytes in the signature
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_GENERICINST, ELEMENT_TYPE_CLASS, TypeRef1, 0x7f, ELEMENT_TYPE_I4 },
+        // More array sizes than bytes in the signature
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_ARRAY, ELEMENT_TYPE_I4, 1, 0x7f, 1 },
+        // TypeDefOrRef coded index with an unused tag
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_CLASS, 1 << 2 | 3 },
+        // Invalid compressed integer
+        { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_VAR, 0xff },
+        deep,
+    }, scope));
+
+    for (size_t i = 0; i < scope.tokens.size(); ++i)
+    {
+        md_signature_t const* signature;
+        EXPECT_EQ(mdbpr_InvalidBlob, GetSignature(scope, i, &signature)) << "Signature " << i;
+    }
+}
+
+TEST(Signature, CachedAndInvalidArguments)
+{
+    std::vector<uint8_t> sig = { IMAGE_CEE_CS_CALLCONV_DEFAULT, 1, ELEMENT_TYPE_I4, ELEMENT_TYPE_STRING };
+    SignatureScope scope;
+    ASSERT_NO_FATAL_FAILURE(CreateScope({ sig }, scope));
+
+    // Decoding a signature again returns the cached signature.
+    md_signature_t const* first;
+    ASSERT_EQ(mdbpr_Success, GetSignature(scope, 0, &first));
+    md_signature_t const* second;
+    ASSERT_EQ(mdbpr_Success, GetSignature(scope, 0, &second));
+    EXPECT_EQ(first, second);
+
+    // Only signatures in the blob heap can be decoded.
+    md_signature_t const* signature;
+    EXPECT_EQ(mdbpr_InvalidArgument, md_get_signature(scope.handle.get(), sig.data(), sig.size(), &signature));
+    EXPECT_EQ(mdbpr_InvalidArgument, md_get_signature(scope.handle.get(), nullptr, 0, &signature));
+    EXPECT_EQ(mdbpr_InvalidArgument, md_get_signature(nullptr, sig.data(), sig.size(), &signature));
+
+    mdcursor_t cursor;
+    uint8_t const* blob;
+    uint32_t blobLen;
+    ASSERT_TRUE(md_token_to_cursor(scope.handle.get(), scope.tokens[0], &cursor));
+    ASSERT_EQ(1, md_get_column_value_as_blob(cursor, mdtStandAloneSig_Signature, 1, &blob, &blobLen));
+    EXPECT_EQ(mdbpr_InvalidArgument, md_get_signature(scope.handle.get(), blob + 1, blobLen - 1, &signature));
+    EXPECT_EQ(mdbpr_InvalidArgument, md_get_signature(scope.handle.get(), blob, blobLen, nullptr));
+}
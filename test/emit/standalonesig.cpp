@@ -20,4 +20,30 @@ TEST(StandaloneSig, Define)
     ULONG sigBlobLength;
     ASSERT_EQ(S_OK, import->GetSigFromToken(sig, &sigBlob, &sigBlobLength));
     EXPECT_THAT(std::vector(sigBlob, sigBlob + sigBlobLength), testing::ContainerEq(std::vector(signature.begin(), signature.end())));
-}
\ No newline at end of file
+}
+
+TEST(StandaloneSig, DefinePastSmallBlobHeap)
+{
+    // The second signature takes the #Blob heap past 64KB, which widens the column it's being written to.
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    std::vector<std::vector<uint8_t>> signatures;
+    std::vector<mdSignature> tokens;
+    for (uint8_t i = 1; i <= 3; ++i)
+    {
+        signatures.emplace_back(48 * 1024, i);
+        mdSignature sig;
+        ASSERT_EQ(S_OK, emit->GetTokenFromSig(signatures.back().data(), (ULONG)signatures.back().size(), &sig));
+        tokens.push_back(sig);
+    }
+
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+    for (size_t i = 0; i < tokens.size(); ++i)
+    {
+        PCCOR_SIGNATURE sigBlob;
+        ULONG sigBlobLength;
+        ASSERT_EQ(S_OK, import->GetSigFromToken(tokens[i], &sigBlob, &sigBlobLength));
+        EXPECT_THAT(std::vector(sigBlob, sigBlob + sigBlobLength), testing::ContainerEq(signatures[i]));
+    }
+}
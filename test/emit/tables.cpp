@@ -0,0 +1,210 @@
+// Defines the column type constants (iCodedToken, iSTRING, ...) in cor.h.
+#define _DEFINE_META_DATA_META_CONSTANTS
+#include "emit.hpp"
+
+#include <cstring>
+
+namespace
+{
+    // Table indexes - II.22.
+    constexpr ULONG TypeRefTable = 0x01;
+    constexpr ULONG TypeDefTable = 0x02;
+    constexpr ULONG TypeDefOrRefCodedToken = 0;
+}
+
+TEST(Tables, TableAndColumnInfo)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    dncp::com_ptr<IMetaDataTables2> tables;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataTables2, (void**)&tables));
+
+    // Only Portable PDBs report the PDB tables.
+    ULONG tableCount;
+    ASSERT_EQ(S_OK, tables->GetNumTables(&tableCount));
+    EXPECT_EQ(0x2d, tableCount);
+
+    ULONG tableIndex;
+    ASSERT_EQ(S_OK, tables->GetTableIndex(TokenFromRid(1, mdtTypeDef), &tableIndex));
+    EXPECT_EQ(TypeDefTable, tableIndex);
+    ASSERT_EQ(S_OK, tables->GetTableIndex(TokenFromRid(1, mdtString), &tableIndex));
+    EXPECT_EQ((ULONG)-1, tableIndex);
+
+    // The scope only contains the <Module> type.
+    ULONG rowSize;
+    ULONG rowCount;
+    ULONG columnCount;
+    ULONG keyColumn;
+    char const* name;
+    ASSERT_EQ(S_OK, tables->GetTableInfo(TypeDefTable, &rowSize, &rowCount, &columnCount, &keyColumn, &name));
+    EXPECT_EQ(1, rowCount);
+    EXPECT_EQ(6, columnCount);
+    EXPECT_EQ((ULONG)-1, keyColumn);
+    EXPECT_STREQ("TypeDef", name);
+
+    // Edits are observed.
+    mdTypeDef typeDef;
+    mdToken implements = mdTokenNil;
+    ASSERT_EQ(S_OK, emit->DefineTypeDef(W("Foo"), 0, mdTypeDefNil, &implements, &typeDef));
+    ASSERT_EQ(S_OK, tables->GetTableInfo(TypeDefTable, nullptr, &rowCount, nullptr, nullptr, nullptr));
+    EXPECT_EQ(2, rowCount);
+
+    ULONG offset;
+    ULONG size;
+    ULONG type;
+    ASSERT_EQ(S_OK, tables->GetColumnInfo(TypeDefTable, 0, &offset, &size, &type, &name));
+    EXPECT_EQ(0, offset);
+    EXPECT_EQ(4, size);
+    EXPECT_EQ(iULONG, type);
+    EXPECT_STREQ("Flags", name);
+
+    ASSERT_EQ(S_OK, tables->GetColumnInfo(TypeDefTable, 1, &offset, &size, &type, &name));
+    EXPECT_EQ(iSTRING, type);
+    EXPECT_STREQ("TypeName", name);
+
+    ASSERT_EQ(S_OK, tables->GetColumnInfo(TypeDefTable, 3, &offset, &size, &type, &name));
+    EXPECT_EQ(iCodedToken + TypeDefOrRefCodedToken, type);
+    EXPECT_STREQ("Extends", name);
+
+    ASSERT_EQ(S_OK, tables->GetColumnInfo(TypeDefTable, 4, &offset, &size, &type, &name));
+    EXPECT_EQ(mdtFieldDef >> 24, type);
+    EXPECT_STREQ("FieldList", name);
+
+    EXPECT_EQ(E_INVALIDARG, tables->GetColumnInfo(TypeDefTable, 6, &offset, &size, &type, &name));
+    EXPECT_EQ(E_INVALIDARG, tables->GetTableInfo(tableCount, &rowSize, &rowCount, &columnCount, &keyColumn, &name));
+    void* row;
+    EXPECT_EQ(E_INVALIDARG, tables->GetRow(tableCount, 1, &row));
+
+    ULONG tokenCount;
+    ULONG* tokens;
+    ASSERT_EQ(S_OK, tables->GetCodedTokenInfo(TypeDefOrRefCodedToken, &tokenCount, &tokens, &name));
+    ASSERT_EQ(3, tokenCount);
+    EXPECT_EQ((ULONG)mdtTypeDef, tokens[0]);
+    EXPECT_EQ((ULONG)mdtTypeRef, tokens[1]);
+    EXPECT_EQ((ULONG)mdtTypeSpec, tokens[2]);
+    EXPECT_STREQ("TypeDefOrRef", name);
+}
+
+TEST(Tables, Columns)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    dncp::com_ptr<IMetaDataTables> tables;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataTables, (void**)&tables));
+
+    mdTypeRef typeRef;
+    ASSERT_EQ(S_OK, emit->DefineTypeRefByName(TokenFromRid(1, mdtModule), W("System.Object"), &typeRef));
+    mdTypeDef typeDef;
+    mdToken implements = mdTokenNil;
+    ASSERT_EQ(S_OK, emit->DefineTypeDef(W("Foo"), tdPublic, typeRef, &implements, &typeDef));
+
+    ULONG value;
+    ASSERT_EQ(S_OK, tables->GetColumn(TypeDefTable, 0, RidFromToken(typeDef), &value));
+    EXPECT_EQ((ULONG)tdPublic, value);
+
+    ASSERT_EQ(S_OK, tables->GetColumn(TypeDefTable, 1, RidFromToken(typeDef), &value));
+    char const* str;
+    ASSERT_EQ(S_OK, tables->GetString(value, &str));
+    EXPECT_STREQ("Foo", str);
+
+    // Coded indexes and table indexes are returned as tokens.
+    ASSERT_EQ(S_OK, tables->GetColumn(TypeDefTable, 3, RidFromToken(typeDef), &value));
+    EXPECT_EQ(typeRef, value);
+    ASSERT_EQ(S_OK, tables->GetColumn(TypeRefTable, 0, RidFromToken(typeRef), &value));
+    EXPECT_EQ(TokenFromRid(1, mdtModule), value);
+    ASSERT_EQ(S_OK, tables->GetColumn(TypeDefTable, 5, RidFromToken(typeDef), &value));
+    EXPECT_EQ(mdtMethodDef, TypeFromToken(value));
+
+    ASSERT_EQ(S_OK, tables->GetColumn(TypeRefTable, 2, RidFromToken(typeRef), &value));
+    ASSERT_EQ(S_OK, tables->GetString(value, &str));
+    EXPECT_STREQ("System", str);
+
+    EXPECT_EQ(CLDB_E_INDEX_NOTFOUND, tables->GetColumn(TypeDefTable, 0, RidFromToken(typeDef) + 1, &value));
+    EXPECT_EQ(CLDB_E_INDEX_NOTFOUND, tables->GetColumn(TypeDefTable, 0, 0, &value));
+
+    void* row;
+    ASSERT_EQ(S_OK, tables->GetRow(TypeDefTable, RidFromToken(typeDef), &row));
+    uint32_t flags;
+    std::memcpy(&flags, row, sizeof(flags));
+    EXPECT_EQ((uint32_t)tdPublic, flags);
+}
+
+TEST(Tables, Heaps)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    dncp::com_ptr<IMetaDataTables> tables;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataTables, (void**)&tables));
+
+    mdString userString;
+    ASSERT_EQ(S_OK, emit->DefineUserString(W("Bar"), 3, &userString));
+
+    ULONG size;
+    void const* data;
+    ASSERT_EQ(S_OK, tables->GetUserString(RidFromToken(userString), &size, &data));
+    // UTF-16 characters and the trailing byte - II.24.2.4.
+    EXPECT_EQ(7, size);
+
+    ULONG next;
+    EXPECT_EQ(S_FALSE, tables->GetNextUserString(RidFromToken(userString), &next));
+    EXPECT_EQ(0, next);
+
+    // The module's MVID is the first GUID.
+    GUID const* guid;
+    ASSERT_EQ(S_OK, tables->GetGuid(1, &guid));
+    ULONG guidHeapSize;
+    ASSERT_EQ(S_OK, tables->GetGuidHeapSize(&guidHeapSize));
+    EXPECT_EQ(0, guidHeapSize % sizeof(GUID));
+    EXPECT_EQ(CLDB_E_INDEX_NOTFOUND, tables->GetGuid(guidHeapSize / sizeof(GUID) + 1, &guid));
+
+    ULONG stringHeapSize;
+    ASSERT_EQ(S_OK, tables->GetStringHeapSize(&stringHeapSize));
+    ULONG stringCount = 0;
+    for (ULONG ix = 0; tables->GetNextString(ix, &next) == S_OK; ix = next)
+    {
+        ASSERT_LT(ix, next);
+        ++stringCount;
+    }
+    EXPECT_LT(0, stringCount);
+    EXPECT_EQ(CLDB_E_INDEX_NOTFOUND, tables->GetNextString(stringHeapSize, &next));
+}
+
+TEST(Tables, Storage)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    dncp::com_ptr<IMetaDataTables2> tables;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataTables2, (void**)&tables));
+
+    void const* storage;
+    ULONG storageSize;
+    ASSERT_EQ(S_OK, tables->GetMetaDataStorage(&storage, &storageSize));
+    ASSERT_LT(4, storageSize);
+    EXPECT_EQ(0, std::memcmp("BSJB", storage, 4));
+
+    bool foundStrings = false;
+    char const* name;
+    void const* stream;
+    ULONG streamSize;
+    ULONG ix = 0;
+    for (; tables->GetMetaDataStreamInfo(ix, &name, &stream, &streamSize) == S_OK; ++ix)
+    {
+        EXPECT_LE((uint8_t const*)storage, (uint8_t const*)stream);
+        EXPECT_LE((uint8_t const*)stream + streamSize, (uint8_t const*)storage + storageSize);
+        foundStrings |= std::strcmp("#Strings", name) == 0;
+    }
+    EXPECT_LT(0, ix);
+    EXPECT_TRUE(foundStrings);
+
+    // Open the saved image read-only, so the storage is the image itself.
+    dncp::com_ptr<IMetaDataDispenser> dispenser;
+    ASSERT_EQ(S_OK, GetDispenser(IID_IMetaDataDispenser, (void**)&dispenser));
+    dncp::com_ptr<IMetaDataTables2> readTables;
+    ASSERT_EQ(S_OK, dispenser->OpenScopeOnMemory(storage, storageSize, ofReadOnly, IID_IMetaDataTables2, (IUnknown**)&readTables));
+
+    void const* readStorage;
+    ULONG readStorageSize;
+    ASSERT_EQ(S_OK, readTables->GetMetaDataStorage(&readStorage, &readStorageSize));
+    EXPECT_EQ(storageSize, readStorageSize);
+    EXPECT_EQ(0, std::memcmp(storage, readStorage, storageSize));
+}
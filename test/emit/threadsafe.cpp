@@ -0,0 +1,180 @@
+#include "emit.hpp"
+
+namespace
+{
+    void CreateThreadSafeEmit(DNMDThreadSafetyStrategy strategy, dncp::com_ptr<IMetaDataEmit>& emit)
+    {
+        dncp::com_ptr<IMetaDataDispenserEx> dispenser;
+        ASSERT_EQ(S_OK, GetDispenser(IID_IMetaDataDispenserEx, (void**)&dispenser));
+
+        VARIANT value;
+        V_VT(&value) = VT_UI4;
+        V_UI4(&value) = MDThreadSafetyOn;
+        ASSERT_EQ(S_OK, dispenser->SetOption(MetaDataThreadSafetyOptions, &value));
+        V_UI4(&value) = strategy;
+        ASSERT_EQ(S_OK, dispenser->SetOption(MetaDataDNMDThreadSafetyStrategy, &value));
+        ASSERT_EQ(S_OK, dispenser->DefineScope(CLSID_CorMetaDataRuntime, 0, IID_IMetaDataEmit, (IUnknown**)&emit));
+    }
+}
+
+TEST(ThreadSafe, StrategyOption)
+{
+    dncp::com_ptr<IMetaDataDispenserEx> dispenser;
+    ASSERT_EQ(S_OK, GetDispenser(IID_IMetaDataDispenserEx, (void**)&dispenser));
+
+    VARIANT value;
+    ASSERT_EQ(S_OK, dispenser->GetOption(MetaDataDNMDThreadSafetyStrategy, &value));
+    EXPECT_EQ((ULONG)DNMDThreadSafetyLock, V_UI4(&value));
+
+    V_VT(&value) = VT_UI4;
+    V_UI4(&value) = DNMDThreadSafetySnapshot;
+    ASSERT_EQ(S_OK, dispenser->SetOption(MetaDataDNMDThreadSafetyStrategy, &value));
+    ASSERT_EQ(S_OK, dispenser->GetOption(MetaDataDNMDThreadSafetyStrategy, &value));
+    EXPECT_EQ((ULONG)DNMDThreadSafetySnapshot, V_UI4(&value));
+
+    V_UI4(&value) = 42;
+    EXPECT_EQ(E_INVALIDARG, dispenser->SetOption(MetaDataDNMDThreadSafetyStrategy, &value));
+}
+
+TEST(ThreadSafe, SnapshotReadsObserveWrites)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateThreadSafeEmit(DNMDThreadSafetySnapshot, emit));
+
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    WSTR_string name = W("Foo");
+    mdToken implements = mdTokenNil;
+    mdTypeDef typeDef;
+    ASSERT_EQ(S_OK, emit->DefineTypeDef(name.c_str(), 0, mdTypeDefNil, &implements, &typeDef));
+
+    WSTR_string readName;
+    readName.resize(name.capacity() + 1);
+    ULONG readNameLength;
+    DWORD typeDefFlags;
+    mdToken extends;
+    ASSERT_EQ(S_OK, import->GetTypeDefProps(typeDef, readName.data(), (ULONG)readName.capacity(), &readNameLength, &typeDefFlags, &extends));
+    EXPECT_EQ(name, readName.substr(0, readNameLength - 1));
+
+    mdTypeDef secondTypeDef;
+    ASSERT_EQ(S_OK, emit->DefineTypeDef(W("Bar"), 0, mdTypeDefNil, &implements, &secondTypeDef));
+    EXPECT_EQ(S_OK, import->GetTypeDefProps(secondTypeDef, readName.data(), (ULONG)readName.capacity(), &readNameLength, &typeDefFlags, &extends));
+}
+
+TEST(ThreadSafe, SnapshotEnumKeepsView)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateThreadSafeEmit(DNMDThreadSafetySnapshot, emit));
+
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    mdToken implements = mdTokenNil;
+    mdTypeDef typeDef;
+    ASSERT_EQ(S_OK, emit->DefineTypeDef(W("Foo"), 0, mdTypeDefNil, &implements, &typeDef));
+
+    HCORENUM hEnum = nullptr;
+    mdTypeDef typeDefs[4];
+    ULONG count;
+    ASSERT_EQ(S_OK, import->EnumTypeDefs(&hEnum, typeDefs, 1, &count));
+    EXPECT_EQ(1u, count);
+
+    // Types defined after the enumeration started aren't observed by it.
+    ASSERT_EQ(S_OK, emit->DefineTypeDef(W("Bar"), 0, mdTypeDefNil, &implements, &typeDef));
+    ASSERT_EQ(S_OK, import->CountEnum(hEnum, &count));
+    EXPECT_EQ(1u, count);
+    EXPECT_TRUE(SUCCEEDED(import->EnumTypeDefs(&hEnum, typeDefs, 4, &count)));
+    EXPECT_EQ(0u, count);
+    import->CloseEnum(hEnum);
+
+    hEnum = nullptr;
+    ASSERT_EQ(S_OK, import->EnumTypeDefs(&hEnum, typeDefs, 4, &count));
+    EXPECT_EQ(2u, count);
+    import->CloseEnum(hEnum);
+}
+
+TEST(ThreadSafe, Statistics)
+{
+    dncp::com_ptr<IMetaDataDispenserEx> dispenser;
+    ASSERT_EQ(S_OK, GetDispenser(IID_IMetaDataDispenserEx, (void**)&dispenser));
+
+    VARIANT value;
+    V_VT(&value) = VT_UI4;
+    V_UI4(&value) = MDThreadSafetyOn;
+    ASSERT_EQ(S_OK, dispenser->SetOption(MetaDataThreadSafetyOptions, &value));
+    V_UI4(&value) = 1;
+    ASSERT_EQ(S_OK, dispenser->SetOption(MetaDataDNMDCollectStatistics, &value));
+
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_EQ(S_OK, dispenser->DefineScope(CLSID_CorMetaDataRuntime, 0, IID_IMetaDataEmit, (IUnknown**)&emit));
+
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    mdToken implements = mdTokenNil;
+    mdTypeDef typeDef;
+    ASSERT_EQ(S_OK, emit->DefineTypeDef(W("Foo"), 0, mdTypeDefNil, &implements, &typeDef));
+    WCHAR name[16];
+    ULONG nameLength;
+    DWORD typeDefFlags;
+    mdToken extends;
+    ASSERT_EQ(S_OK, import->GetTypeDefProps(typeDef, name, 16, &nameLength, &typeDefFlags, &extends));
+    ASSERT_EQ(S_OK, import->GetTypeDefProps(typeDef, name, 16, &nameLength, &typeDefFlags, &extends));
+
+    dncp::com_ptr<IDNMDStatistics> statistics;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IDNMDStatistics, (void**)&statistics));
+
+    uint64_t defineTypeDefCalls = 0;
+    uint64_t getTypeDefPropsCalls = 0;
+    uint64_t totalCalls = 0;
+    for (ULONG i = 0; i < statistics->GetMethodCount(); ++i)
+    {
+        DNMDMethodStatistics methodStatistics;
+        ASSERT_EQ(S_OK, statistics->GetMethodStatistics(i, &methodStatistics));
+        if (std::string{ methodStatistics.Name } == "DefineTypeDef")
+            defineTypeDefCalls = methodStatistics.CallCount;
+        else if (std::string{ methodStatistics.Name } == "GetTypeDefProps")
+            getTypeDefPropsCalls = methodStatistics.CallCount;
+        totalCalls += methodStatistics.CallCount;
+
+        uint64_t histogramCalls = 0;
+        for (uint64_t bucket : methodStatistics.LockHoldHistogram)
+            histogramCalls += bucket;
+        EXPECT_EQ(methodStatistics.CallCount, histogramCalls);
+    }
+    EXPECT_EQ(1u, defineTypeDefCalls);
+    EXPECT_EQ(2u, getTypeDefPropsCalls);
+    EXPECT_EQ(3u, totalCalls);
+
+    FILE* stream = tmpfile();
+    ASSERT_NE(nullptr, stream);
+    EXPECT_EQ(S_OK, DumpStatistics(emit, stream));
+    fclose(stream);
+
+    ASSERT_EQ(S_OK, statistics->ResetStatistics());
+    DNMDMethodStatistics methodStatistics;
+    ASSERT_EQ(S_OK, statistics->GetMethodStatistics((ULONG)0, &methodStatistics));
+    EXPECT_EQ(0u, methodStatistics.CallCount);
+    EXPECT_EQ(E_INVALIDARG, statistics->GetMethodStatistics(statistics->GetMethodCount(), &methodStatistics));
+}
+
+TEST(ThreadSafe, NoUtf8Import)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateThreadSafeEmit(DNMDThreadSafetyLock, emit));
+
+    // The strings returned by the UTF-8 interface point into the heaps, which other threads may replace.
+    dncp::com_ptr<IDNMDImportUtf8> import;
+    EXPECT_EQ(E_NOINTERFACE, emit->QueryInterface(IID_IDNMDImportUtf8, (void**)&import));
+}
+
+TEST(ThreadSafe, NoMetaDataTables)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateThreadSafeEmit(DNMDThreadSafetyLock, emit));
+
+    // Rows and heap entries are returned as pointers into the metadata, which other threads may replace.
+    dncp::com_ptr<IMetaDataTables> tables;
+    EXPECT_EQ(E_NOINTERFACE, emit->QueryInterface(IID_IMetaDataTables, (void**)&tables));
+}
@@ -1,4 +1,8 @@
 #include "emit.hpp"
+#include <dnmd.h>
+
+#include <cstring>
+#include <vector>
 
 TEST(TypeDef, Define)
 {
@@ -201,3 +205,202 @@ TEST(TypeDef, SetProps)
     EXPECT_EQ(typeDef, classType);
     EXPECT_EQ(implements[0], interfaceType);
 }
+
+TEST(TypeDef, NameConversion)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    // ASCII names, names longer than the conversion buffers and names with non-ASCII characters
+    // after an ASCII prefix of different lengths.
+    WSTR_string longName(300, W('a'));
+    WSTR_string const names[] =
+    {
+        W("Foo"),
+        W("System.Collections.Generic.Dictionary`2"),
+        W("Namespace.") + longName,
+        W("Café"),
+        W("System.Collections.Generic.Änderung中"),
+        W("Namespace.") + longName + W("\U0001F600") + longName,
+    };
+
+    for (WSTR_string const& name : names)
+    {
+        mdTypeDef typeDef;
+        mdToken implements = mdTokenNil;
+        ASSERT_EQ(S_OK, emit->DefineTypeDef(name.c_str(), 0, mdTypeDefNil, &implements, &typeDef));
+
+        ULONG readNameLength;
+        DWORD typeDefFlags;
+        mdToken extends;
+        ASSERT_EQ(S_OK, import->GetTypeDefProps(typeDef, nullptr, 0, &readNameLength, &typeDefFlags, &extends));
+        EXPECT_EQ(name.size() + 1, readNameLength);
+
+        WSTR_string readName;
+        readName.resize(readNameLength);
+        ASSERT_EQ(S_OK, import->GetTypeDefProps(typeDef, &readName[0], (ULONG)readName.size(), &readNameLength, &typeDefFlags, &extends));
+        EXPECT_EQ(name, readName.substr(0, readNameLength - 1));
+
+        // A buffer that is too small receives the start of the name.
+        WCHAR truncatedName[3];
+        ASSERT_EQ(CLDB_S_TRUNCATION, import->GetTypeDefProps(typeDef, truncatedName, 3, &readNameLength, &typeDefFlags, &extends));
+        EXPECT_EQ(name.size() + 1, readNameLength);
+        EXPECT_EQ(name.substr(0, 2), WSTR_string(truncatedName));
+
+        mdTypeDef found;
+        ASSERT_EQ(S_OK, import->FindTypeDefByName(name.c_str(), mdTokenNil, &found));
+        EXPECT_EQ(typeDef, found);
+    }
+}
+
+TEST(TypeDef, Utf8Import)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    dncp::com_ptr<IDNMDImportUtf8> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IDNMDImportUtf8, (void**)&import));
+
+    mdTypeDef typeDef;
+    mdToken implements = mdTokenNil;
+    ASSERT_EQ(S_OK, emit->DefineTypeDef(W("Namespace.Café"), tdPublic, mdTypeDefNil, &implements, &typeDef));
+
+    std::array<uint8_t, 3> sig = { IMAGE_CEE_CS_CALLCONV_DEFAULT, 0, ELEMENT_TYPE_VOID };
+    mdMethodDef methodDef;
+    ASSERT_EQ(S_OK, emit->DefineMethod(typeDef, W("Método"), mdPublic | mdStatic, sig.data(), (ULONG)sig.size(), 0, 0, &methodDef));
+
+    char const* nspace;
+    char const* name;
+    DWORD typeDefFlags;
+    mdToken extends;
+    ASSERT_EQ(S_OK, import->GetTypeDefProps(typeDef, &nspace, &name, &typeDefFlags, &extends));
+    EXPECT_STREQ("Namespace", nspace);
+    EXPECT_STREQ("Caf\xc3\xa9", name);
+    EXPECT_EQ((DWORD)tdPublic, typeDefFlags);
+
+    mdTypeDef parent;
+    char const* methodName;
+    DWORD methodFlags;
+    PCCOR_SIGNATURE readSig;
+    ULONG readSigLength;
+    ULONG rva;
+    DWORD implFlags;
+    ASSERT_EQ(S_OK, import->GetMethodProps(methodDef, &parent, &methodName, &methodFlags, &readSig, &readSigLength, &rva, &implFlags));
+    EXPECT_EQ(typeDef, parent);
+    EXPECT_STREQ("M\xc3\xa9todo", methodName);
+
+    mdTypeDef foundTypeDef;
+    ASSERT_EQ(S_OK, import->FindTypeDefByName("Namespace", "Caf\xc3\xa9", mdTokenNil, &foundTypeDef));
+    EXPECT_EQ(typeDef, foundTypeDef);
+    EXPECT_EQ(CLDB_E_RECORD_NOTFOUND, import->FindTypeDefByName("", "Caf\xc3\xa9", mdTokenNil, &foundTypeDef));
+
+    mdMethodDef foundMethodDef;
+    ASSERT_EQ(S_OK, import->FindMethod(typeDef, "M\xc3\xa9todo", sig.data(), (ULONG)sig.size(), &foundMethodDef));
+    EXPECT_EQ(methodDef, foundMethodDef);
+}
+
+TEST(TypeDef, Snapshot)
+{
+    dncp::com_ptr<IMetaDataEmit2> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    dncp::com_ptr<IDNMDImportUtf8> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IDNMDImportUtf8, (void**)&import));
+
+    mdTypeRef baseType;
+    ASSERT_EQ(S_OK, emit->DefineTypeRefByName(TokenFromRid(1, mdtModule), W("System.ValueType"), &baseType));
+    mdTypeRef interfaceType;
+    ASSERT_EQ(S_OK, emit->DefineTypeRefByName(TokenFromRid(1, mdtModule), W("System.IDisposable"), &interfaceType));
+
+    mdTypeDef typeDef;
+    mdToken implements[] = { interfaceType, mdTokenNil };
+    ASSERT_EQ(S_OK, emit->DefineTypeDef(W("Namespace.Foo"), tdPublic | tdExplicitLayout, baseType, implements, &typeDef));
+
+    std::array<uint8_t, 2> fieldSig = { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_I4 };
+    mdFieldDef fields[2];
+    ASSERT_EQ(S_OK, emit->DefineField(typeDef, W("A"), fdPublic, fieldSig.data(), (ULONG)fieldSig.size(), 0, nullptr, 0, &fields[0]));
+    ASSERT_EQ(S_OK, emit->DefineField(typeDef, W("B"), fdPublic | fdStatic | fdHasFieldRVA, fieldSig.data(), (ULONG)fieldSig.size(), 0, nullptr, 0, &fields[1]));
+    ASSERT_EQ(S_OK, emit->SetFieldRVA(fields[1], 0x2048));
+    COR_FIELD_OFFSET offsets[] = { { fields[0], 4 }, { mdFieldDefNil, 0 } };
+    ASSERT_EQ(S_OK, emit->SetClassLayout(typeDef, 8, offsets, 16));
+
+    std::array<uint8_t, 5> methodSig = { IMAGE_CEE_CS_CALLCONV_HASTHIS, 2, ELEMENT_TYPE_VOID, ELEMENT_TYPE_I4, ELEMENT_TYPE_I4 };
+    mdMethodDef methods[2];
+    ASSERT_EQ(S_OK, emit->DefineMethod(typeDef, W("M"), mdPublic, methodSig.data(), (ULONG)methodSig.size(), 0x2050, 0, &methods[0]));
+    ASSERT_EQ(S_OK, emit->DefineMethod(typeDef, W("N"), mdPublic, methodSig.data(), (ULONG)methodSig.size(), 0, 0, &methods[1]));
+    mdParamDef params[2];
+    ASSERT_EQ(S_OK, emit->DefineParam(methods[0], 1, W("x"), pdIn, ELEMENT_TYPE_VOID, nullptr, 0, &params[0]));
+    ASSERT_EQ(S_OK, emit->DefineParam(methods[0], 2, W("y"), pdOut, ELEMENT_TYPE_VOID, nullptr, 0, &params[1]));
+
+    mdGenericParam genericParam;
+    ASSERT_EQ(S_OK, emit->DefineGenericParam(typeDef, 0, gpCovariant, W("T"), 0, nullptr, &genericParam));
+
+    ULONG snapshotLen;
+    ASSERT_EQ(E_NOT_SUFFICIENT_BUFFER, import->GetTypeDefSnapshot(typeDef, nullptr, 0, &snapshotLen));
+    std::vector<void*> buffer((snapshotLen + sizeof(void*) - 1) / sizeof(void*));
+    md_type_def_snapshot_t* snapshot = (md_type_def_snapshot_t*)buffer.data();
+    ASSERT_EQ(S_OK, import->GetTypeDefSnapshot(typeDef, snapshot, snapshotLen, &snapshotLen));
+
+    EXPECT_EQ(typeDef, snapshot->type_def);
+    EXPECT_EQ((uint32_t)(tdPublic | tdExplicitLayout), snapshot->flags);
+    EXPECT_STREQ("Namespace", snapshot->type_namespace);
+    EXPECT_STREQ("Foo", snapshot->type_name);
+    EXPECT_EQ(baseType, snapshot->extends);
+    EXPECT_TRUE(snapshot->has_class_layout);
+    EXPECT_EQ(8, snapshot->packing_size);
+    EXPECT_EQ(16, snapshot->class_size);
+
+    ASSERT_EQ(2, snapshot->field_count);
+    EXPECT_EQ(fields[0], snapshot->field_tokens[0]);
+    EXPECT_EQ(fields[1], snapshot->field_tokens[1]);
+    EXPECT_STREQ("A", snapshot->field_names[0]);
+    EXPECT_STREQ("B", snapshot->field_names[1]);
+    EXPECT_EQ((uint32_t)fdPublic, snapshot->field_flags[0]);
+    ASSERT_EQ(fieldSig.size(), snapshot->field_signature_lengths[0]);
+    EXPECT_EQ(0, std::memcmp(fieldSig.data(), snapshot->field_signatures[0], fieldSig.size()));
+    EXPECT_EQ(0, snapshot->field_rvas[0]);
+    EXPECT_EQ(0x2048, snapshot->field_rvas[1]);
+    EXPECT_EQ(4, snapshot->field_offsets[0]);
+    EXPECT_EQ(UINT32_MAX, snapshot->field_offsets[1]);
+
+    ASSERT_EQ(2, snapshot->method_count);
+    EXPECT_EQ(methods[0], snapshot->method_tokens[0]);
+    EXPECT_EQ(methods[1], snapshot->method_tokens[1]);
+    EXPECT_STREQ("M", snapshot->method_names[0]);
+    EXPECT_STREQ("N", snapshot->method_names[1]);
+    EXPECT_EQ(0x2050, snapshot->method_rvas[0]);
+    ASSERT_EQ(methodSig.size(), snapshot->method_signature_lengths[1]);
+    EXPECT_EQ(0, std::memcmp(methodSig.data(), snapshot->method_signatures[1], methodSig.size()));
+    EXPECT_EQ(0, snapshot->method_first_params[0]);
+    EXPECT_EQ(2, snapshot->method_param_counts[0]);
+    EXPECT_EQ(0, snapshot->method_param_counts[1]);
+
+    ASSERT_EQ(2, snapshot->param_count);
+    // Params are in list order, which need not be the order they were defined in.
+    uint32_t ix = snapshot->param_tokens[0] == params[0] ? 0 : 1;
+    EXPECT_EQ(params[0], snapshot->param_tokens[ix]);
+    EXPECT_EQ(params[1], snapshot->param_tokens[1 - ix]);
+    EXPECT_STREQ("x", snapshot->param_names[ix]);
+    EXPECT_STREQ("y", snapshot->param_names[1 - ix]);
+    EXPECT_EQ(1, snapshot->param_sequences[ix]);
+    EXPECT_EQ(2, snapshot->param_sequences[1 - ix]);
+    EXPECT_EQ((uint32_t)pdOut, snapshot->param_flags[1 - ix]);
+
+    ASSERT_EQ(1, snapshot->generic_param_count);
+    EXPECT_EQ(genericParam, snapshot->generic_param_tokens[0]);
+    EXPECT_EQ(0, snapshot->generic_param_numbers[0]);
+    EXPECT_EQ((uint32_t)gpCovariant, snapshot->generic_param_flags[0]);
+    EXPECT_STREQ("T", snapshot->generic_param_names[0]);
+
+    ASSERT_EQ(1, snapshot->interface_impl_count);
+    EXPECT_EQ(mdtInterfaceImpl, TypeFromToken(snapshot->interface_impl_tokens[0]));
+    EXPECT_EQ(interfaceType, snapshot->interface_impl_interfaces[0]);
+
+    // The <Module> type has no members.
+    ASSERT_EQ(S_OK, import->GetTypeDefSnapshot(TokenFromRid(1, mdtTypeDef), snapshot, snapshotLen, &snapshotLen));
+    EXPECT_EQ(0, snapshot->field_count);
+    EXPECT_EQ(0, snapshot->method_count);
+    EXPECT_FALSE(snapshot->has_class_layout);
+
+    EXPECT_EQ(CLDB_E_RECORD_NOTFOUND, import->GetTypeDefSnapshot(TokenFromRid(10, mdtTypeDef), snapshot, snapshotLen, &snapshotLen));
+}
@@ -1,4 +1,5 @@
 #include "emit.hpp"
+#include <vector>
 
 TEST(TypeRef, ValidScopeAndDottedName)
 {
@@ -50,4 +51,472 @@ TEST(TypeRef, ValidScopeAndNonDottedName)
     EXPECT_EQ(TokenFromRid(1, mdtModule), resolutionScope);
     EXPECT_EQ(readNameLength, name.size() + 1);
     EXPECT_EQ(name, readName.substr(0, readNameLength - 1));
-}
\ No newline at end of file
+}
+TEST(TypeRef, FindAfterDefine)
+{
+    dncp::com_ptr<IMetaDataEmit> emit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(emit));
+    dncp::com_ptr<IMetaDataImport> import;
+    ASSERT_EQ(S_OK, emit->QueryInterface(IID_IMetaDataImport, (void**)&import));
+
+    // Find each TypeRef as it's defined, so the TypeRefs defined earlier are already indexed.
+    mdToken scope = TokenFromRid(1, mdtModule);
+    std::vector<mdTypeRef> typeRefs;
+    WSTR_string const names[] = { W("System.Object"), W("System.String"), W("Bar"), W("System.Collections.Generic.List`1") };
+    for (WSTR_string const& name : names)
+    {
+        mdTypeRef found;
+        EXPECT_EQ(CLDB_E_RECORD_NOTFOUND, import->FindTypeRef(scope, name.c_str(), &found));
+
+        mdTypeRef typeRef;
+        ASSERT_EQ(S_OK, emit->DefineTypeRefByName(scope, name.c_str(), &typeRef));
+        ASSERT_EQ(S_OK, import->FindTypeRef(scope, name.c_str(), &found));
+        EXPECT_EQ(typeRef, found);
+        typeRefs.push_back(typeRef);
+    }
+
+    for (size_t i = 0; i < typeRefs.size(); ++i)
+    {
+        mdTypeRef found;
+        ASSERT_EQ(S_OK, import->FindTypeRef(scope, names[i].c_str(), &found));
+        EXPECT_EQ(typeRefs[i], found);
+    }
+
+    // The resolution scope is part of the match.
+    mdTypeRef found;
+    EXPECT_EQ(CLDB_E_RECORD_NOTFOUND, import->FindTypeRef(mdTokenNil, W("System.Object"), &found));
+}
+
+namespace
+{
+    void DefineAssembly(IMetaDataAssemblyEmit* emit, WCHAR const* name, std::vector<uint8_t> const& publicKey = {})
+    {
+        ASSEMBLYMETADATA assemblyMetadata = {};
+        assemblyMetadata.usMajorVersion = 1;
+        assemblyMetadata.usMinorVersion = 2;
+        assemblyMetadata.usBuildNumber = 3;
+        assemblyMetadata.usRevisionNumber = 4;
+        assemblyMetadata.szLocale = const_cast<LPWSTR>(W(""));
+        mdAssembly assembly;
+        ASSERT_EQ(S_OK, emit->DefineAssembly(publicKey.empty() ? nullptr : publicKey.data(), (ULONG)publicKey.size(), 0, name, &assemblyMetadata, 0, &assembly));
+    }
+
+    void GetTypeRefName(IMetaDataImport* import, mdTypeRef typeRef, WSTR_string& name, mdToken* resolutionScope)
+    {
+        std::array<WCHAR, 64> buffer;
+        ULONG length;
+        ASSERT_EQ(S_OK, import->GetTypeRefProps(typeRef, resolutionScope, buffer.data(), (ULONG)buffer.size(), &length));
+        name = buffer.data();
+    }
+}
+
+TEST(TypeRef, ImportNestedTypeFromModuleOfSameAssembly)
+{
+    dncp::com_ptr<IMetaDataAssemblyEmit> targetAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(targetAssemblyEmit));
+    ASSERT_NO_FATAL_FAILURE(DefineAssembly(targetAssemblyEmit, W("Target")));
+    dncp::com_ptr<IMetaDataAssemblyImport> targetAssemblyImport;
+    ASSERT_EQ(S_OK, targetAssemblyEmit->QueryInterface(IID_IMetaDataAssemblyImport, (void**)&targetAssemblyImport));
+    dncp::com_ptr<IMetaDataEmit> targetEmit;
+    ASSERT_EQ(S_OK, targetAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&targetEmit));
+
+    // The source is another module of the target assembly.
+    dncp::com_ptr<IMetaDataEmit> sourceEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(sourceEmit));
+    ASSERT_EQ(S_OK, sourceEmit->SetModuleProps(W("Source.netmodule")));
+    mdToken implements = mdTokenNil;
+    mdTypeDef outer;
+    ASSERT_EQ(S_OK, sourceEmit->DefineTypeDef(W("Source.Outer"), tdPublic, mdTypeDefNil, &implements, &outer));
+    mdTypeDef nested;
+    ASSERT_EQ(S_OK, sourceEmit->DefineNestedType(W("Nested"), 0, mdTypeDefNil, &implements, outer, &nested));
+    dncp::com_ptr<IMetaDataImport> sourceImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataImport, (void**)&sourceImport));
+
+    mdTypeRef typeRef;
+    ASSERT_EQ(S_OK, targetEmit->DefineImportType(targetAssemblyImport, nullptr, 0, sourceImport, nested, targetAssemblyEmit, &typeRef));
+
+    // The nested type is referenced through its enclosing type in the source module.
+    dncp::com_ptr<IMetaDataImport> targetImport;
+    ASSERT_EQ(S_OK, targetEmit->QueryInterface(IID_IMetaDataImport, (void**)&targetImport));
+    WSTR_string name;
+    mdToken resolutionScope;
+    ASSERT_NO_FATAL_FAILURE(GetTypeRefName(targetImport, typeRef, name, &resolutionScope));
+    EXPECT_EQ(WSTR_string(W("Nested")), name);
+    ASSERT_EQ(mdtTypeRef, TypeFromToken(resolutionScope));
+    ASSERT_NO_FATAL_FAILURE(GetTypeRefName(targetImport, resolutionScope, name, &resolutionScope));
+    EXPECT_EQ(WSTR_string(W("Source.Outer")), name);
+    ASSERT_EQ(mdtModuleRef, TypeFromToken(resolutionScope));
+
+    std::array<WCHAR, 64> moduleName;
+    ULONG moduleNameLength;
+    ASSERT_EQ(S_OK, targetImport->GetModuleRefProps(resolutionScope, moduleName.data(), (ULONG)moduleName.size(), &moduleNameLength));
+    EXPECT_EQ(WSTR_string(W("Source.netmodule")), WSTR_string(moduleName.data()));
+}
+
+TEST(TypeRef, ImportTypeFromModuleWithoutNestedTypes)
+{
+    dncp::com_ptr<IMetaDataAssemblyEmit> targetAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(targetAssemblyEmit));
+    ASSERT_NO_FATAL_FAILURE(DefineAssembly(targetAssemblyEmit, W("Target")));
+    dncp::com_ptr<IMetaDataAssemblyImport> targetAssemblyImport;
+    ASSERT_EQ(S_OK, targetAssemblyEmit->QueryInterface(IID_IMetaDataAssemblyImport, (void**)&targetAssemblyImport));
+    dncp::com_ptr<IMetaDataEmit> targetEmit;
+    ASSERT_EQ(S_OK, targetAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&targetEmit));
+
+    // The source module has no NestedClass rows.
+    dncp::com_ptr<IMetaDataEmit> sourceEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(sourceEmit));
+    ASSERT_EQ(S_OK, sourceEmit->SetModuleProps(W("Source.netmodule")));
+    mdToken implements = mdTokenNil;
+    mdTypeDef sourceTypeDef;
+    ASSERT_EQ(S_OK, sourceEmit->DefineTypeDef(W("Source.Type"), tdPublic, mdTypeDefNil, &implements, &sourceTypeDef));
+    dncp::com_ptr<IMetaDataImport> sourceImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataImport, (void**)&sourceImport));
+
+    mdTypeRef typeRef;
+    ASSERT_EQ(S_OK, targetEmit->DefineImportType(targetAssemblyImport, nullptr, 0, sourceImport, sourceTypeDef, targetAssemblyEmit, &typeRef));
+
+    dncp::com_ptr<IMetaDataImport> targetImport;
+    ASSERT_EQ(S_OK, targetEmit->QueryInterface(IID_IMetaDataImport, (void**)&targetImport));
+    WSTR_string name;
+    mdToken resolutionScope;
+    ASSERT_NO_FATAL_FAILURE(GetTypeRefName(targetImport, typeRef, name, &resolutionScope));
+    EXPECT_EQ(WSTR_string(W("Source.Type")), name);
+    EXPECT_EQ(mdtModuleRef, TypeFromToken(resolutionScope));
+}
+
+TEST(TypeRef, ImportTypeFromOtherAssemblyCopiesVersion)
+{
+    dncp::com_ptr<IMetaDataAssemblyEmit> sourceAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(sourceAssemblyEmit));
+    ASSERT_NO_FATAL_FAILURE(DefineAssembly(sourceAssemblyEmit, W("Source")));
+    dncp::com_ptr<IMetaDataEmit> sourceEmit;
+    ASSERT_EQ(S_OK, sourceAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&sourceEmit));
+    mdToken implements = mdTokenNil;
+    mdTypeDef sourceTypeDef;
+    ASSERT_EQ(S_OK, sourceEmit->DefineTypeDef(W("Source.Type"), tdPublic, mdTypeDefNil, &implements, &sourceTypeDef));
+    dncp::com_ptr<IMetaDataAssemblyImport> sourceAssemblyImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataAssemblyImport, (void**)&sourceAssemblyImport));
+    dncp::com_ptr<IMetaDataImport> sourceImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataImport, (void**)&sourceImport));
+
+    dncp::com_ptr<IMetaDataAssemblyEmit> targetAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(targetAssemblyEmit));
+    ASSERT_NO_FATAL_FAILURE(DefineAssembly(targetAssemblyEmit, W("Target")));
+    ASSEMBLYMETADATA otherMetadata = {};
+    otherMetadata.szLocale = const_cast<LPWSTR>(W(""));
+    mdAssemblyRef otherAssemblyRef;
+    ASSERT_EQ(S_OK, targetAssemblyEmit->DefineAssemblyRef(nullptr, 0, W("Other"), &otherMetadata, nullptr, 0, 0, &otherAssemblyRef));
+    dncp::com_ptr<IMetaDataEmit> targetEmit;
+    ASSERT_EQ(S_OK, targetAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&targetEmit));
+
+    mdTypeRef typeRef;
+    ASSERT_EQ(S_OK, targetEmit->DefineImportType(sourceAssemblyImport, nullptr, 0, sourceImport, sourceTypeDef, targetAssemblyEmit, &typeRef));
+
+    dncp::com_ptr<IMetaDataImport> targetImport;
+    ASSERT_EQ(S_OK, targetEmit->QueryInterface(IID_IMetaDataImport, (void**)&targetImport));
+    WSTR_string name;
+    mdToken resolutionScope;
+    ASSERT_NO_FATAL_FAILURE(GetTypeRefName(targetImport, typeRef, name, &resolutionScope));
+    EXPECT_EQ(WSTR_string(W("Source.Type")), name);
+    ASSERT_EQ(mdtAssemblyRef, TypeFromToken(resolutionScope));
+    EXPECT_NE(otherAssemblyRef, resolutionScope);
+
+    dncp::com_ptr<IMetaDataAssemblyImport> targetAssemblyImport;
+    ASSERT_EQ(S_OK, targetEmit->QueryInterface(IID_IMetaDataAssemblyImport, (void**)&targetAssemblyImport));
+    ASSEMBLYMETADATA metadata = {};
+    std::array<WCHAR, 64> assemblyName;
+    ULONG assemblyNameLength;
+    ASSERT_EQ(S_OK, targetAssemblyImport->GetAssemblyRefProps(resolutionScope, nullptr, nullptr, assemblyName.data(), (ULONG)assemblyName.size(), &assemblyNameLength, &metadata, nullptr, nullptr, nullptr));
+    EXPECT_EQ(WSTR_string(W("Source")), WSTR_string(assemblyName.data()));
+    EXPECT_EQ(1, metadata.usMajorVersion);
+    EXPECT_EQ(2, metadata.usMinorVersion);
+    EXPECT_EQ(3, metadata.usBuildNumber);
+    EXPECT_EQ(4, metadata.usRevisionNumber);
+}
+
+TEST(TypeRef, ImportTypeIntoModuleWithoutAssemblyRefs)
+{
+    dncp::com_ptr<IMetaDataAssemblyEmit> sourceAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(sourceAssemblyEmit));
+    ASSERT_NO_FATAL_FAILURE(DefineAssembly(sourceAssemblyEmit, W("Source")));
+    dncp::com_ptr<IMetaDataEmit> sourceEmit;
+    ASSERT_EQ(S_OK, sourceAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&sourceEmit));
+    mdToken implements = mdTokenNil;
+    mdTypeDef sourceTypeDef;
+    ASSERT_EQ(S_OK, sourceEmit->DefineTypeDef(W("Source.Type"), tdPublic, mdTypeDefNil, &implements, &sourceTypeDef));
+    dncp::com_ptr<IMetaDataAssemblyImport> sourceAssemblyImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataAssemblyImport, (void**)&sourceAssemblyImport));
+    dncp::com_ptr<IMetaDataImport> sourceImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataImport, (void**)&sourceImport));
+
+    // The target has an empty AssemblyRef table.
+    dncp::com_ptr<IMetaDataAssemblyEmit> targetAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(targetAssemblyEmit));
+    ASSERT_NO_FATAL_FAILURE(DefineAssembly(targetAssemblyEmit, W("Target")));
+    dncp::com_ptr<IMetaDataEmit> targetEmit;
+    ASSERT_EQ(S_OK, targetAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&targetEmit));
+
+    mdTypeRef typeRef;
+    ASSERT_EQ(S_OK, targetEmit->DefineImportType(sourceAssemblyImport, nullptr, 0, sourceImport, sourceTypeDef, targetAssemblyEmit, &typeRef));
+
+    dncp::com_ptr<IMetaDataImport> targetImport;
+    ASSERT_EQ(S_OK, targetEmit->QueryInterface(IID_IMetaDataImport, (void**)&targetImport));
+    WSTR_string name;
+    mdToken resolutionScope;
+    ASSERT_NO_FATAL_FAILURE(GetTypeRefName(targetImport, typeRef, name, &resolutionScope));
+    EXPECT_EQ(WSTR_string(W("Source.Type")), name);
+    EXPECT_EQ(TokenFromRid(1, mdtAssemblyRef), resolutionScope);
+}
+
+TEST(TypeRef, ImportTypesFromStrongNamedAssemblyShareAssemblyRef)
+{
+    // A public key blob with an RSA signature algorithm, SHA1 hash algorithm and a PUBLICKEYBLOB key.
+    std::vector<uint8_t> publicKey = { 0x00, 0x24, 0x00, 0x00, 0x04, 0x80, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x06 };
+    for (uint8_t i = 1; i < 0x14; ++i)
+        publicKey.push_back(i);
+
+    dncp::com_ptr<IMetaDataAssemblyEmit> sourceAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(sourceAssemblyEmit));
+    ASSERT_NO_FATAL_FAILURE(DefineAssembly(sourceAssemblyEmit, W("Source"), publicKey));
+    dncp::com_ptr<IMetaDataEmit> sourceEmit;
+    ASSERT_EQ(S_OK, sourceAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&sourceEmit));
+    mdToken implements = mdTokenNil;
+    mdTypeDef sourceTypeDef1;
+    ASSERT_EQ(S_OK, sourceEmit->DefineTypeDef(W("Source.Type1"), tdPublic, mdTypeDefNil, &implements, &sourceTypeDef1));
+    mdTypeDef sourceTypeDef2;
+    ASSERT_EQ(S_OK, sourceEmit->DefineTypeDef(W("Source.Type2"), tdPublic, mdTypeDefNil, &implements, &sourceTypeDef2));
+    dncp::com_ptr<IMetaDataAssemblyImport> sourceAssemblyImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataAssemblyImport, (void**)&sourceAssemblyImport));
+    dncp::com_ptr<IMetaDataImport> sourceImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataImport, (void**)&sourceImport));
+
+    dncp::com_ptr<IMetaDataAssemblyEmit> targetAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(targetAssemblyEmit));
+    ASSERT_NO_FATAL_FAILURE(DefineAssembly(targetAssemblyEmit, W("Target")));
+    dncp::com_ptr<IMetaDataEmit> targetEmit;
+    ASSERT_EQ(S_OK, targetAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&targetEmit));
+
+    mdTypeRef typeRef1;
+    ASSERT_EQ(S_OK, targetEmit->DefineImportType(sourceAssemblyImport, nullptr, 0, sourceImport, sourceTypeDef1, targetAssemblyEmit, &typeRef1));
+    mdTypeRef typeRef2;
+    ASSERT_EQ(S_OK, targetEmit->DefineImportType(sourceAssemblyImport, nullptr, 0, sourceImport, sourceTypeDef2, targetAssemblyEmit, &typeRef2));
+
+    // The second import finds the AssemblyRef that the first import created by its public key token.
+    dncp::com_ptr<IMetaDataImport> targetImport;
+    ASSERT_EQ(S_OK, targetEmit->QueryInterface(IID_IMetaDataImport, (void**)&targetImport));
+    WSTR_string name;
+    mdToken resolutionScope1;
+    ASSERT_NO_FATAL_FAILURE(GetTypeRefName(targetImport, typeRef1, name, &resolutionScope1));
+    mdToken resolutionScope2;
+    ASSERT_NO_FATAL_FAILURE(GetTypeRefName(targetImport, typeRef2, name, &resolutionScope2));
+    EXPECT_EQ(TokenFromRid(1, mdtAssemblyRef), resolutionScope1);
+    EXPECT_EQ(resolutionScope1, resolutionScope2);
+
+    dncp::com_ptr<IMetaDataAssemblyImport> targetAssemblyImport;
+    ASSERT_EQ(S_OK, targetEmit->QueryInterface(IID_IMetaDataAssemblyImport, (void**)&targetAssemblyImport));
+    HCORENUM assemblyRefEnum = nullptr;
+    std::array<mdAssemblyRef, 4> assemblyRefs;
+    ULONG assemblyRefCount;
+    ASSERT_EQ(S_OK, targetAssemblyImport->EnumAssemblyRefs(&assemblyRefEnum, assemblyRefs.data(), (ULONG)assemblyRefs.size(), &assemblyRefCount));
+    targetAssemblyImport->CloseEnum(assemblyRefEnum);
+    EXPECT_EQ(1u, assemblyRefCount);
+}
+
+TEST(TypeRef, ImportTypeFromAssemblyWithEcmaKey)
+{
+    std::vector<uint8_t> const ecmaPublicKey = { 0, 0, 0, 0, 0, 0, 0, 0, 4, 0, 0, 0, 0, 0, 0, 0 };
+    std::array<uint8_t, 8> const ecmaToken = { 0xb7, 0x7a, 0x5c, 0x56, 0x19, 0x34, 0xe0, 0x89 };
+
+    dncp::com_ptr<IMetaDataAssemblyEmit> sourceAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(sourceAssemblyEmit));
+    ASSERT_NO_FATAL_FAILURE(DefineAssembly(sourceAssemblyEmit, W("System.Private.CoreLib"), ecmaPublicKey));
+    dncp::com_ptr<IMetaDataEmit> sourceEmit;
+    ASSERT_EQ(S_OK, sourceAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&sourceEmit));
+    mdToken implements = mdTokenNil;
+    mdTypeDef sourceTypeDef;
+    ASSERT_EQ(S_OK, sourceEmit->DefineTypeDef(W("System.Object"), tdPublic, mdTypeDefNil, &implements, &sourceTypeDef));
+    dncp::com_ptr<IMetaDataAssemblyImport> sourceAssemblyImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataAssemblyImport, (void**)&sourceAssemblyImport));
+    dncp::com_ptr<IMetaDataImport> sourceImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataImport, (void**)&sourceImport));
+
+    dncp::com_ptr<IMetaDataAssemblyEmit> targetAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(targetAssemblyEmit));
+    ASSERT_NO_FATAL_FAILURE(DefineAssembly(targetAssemblyEmit, W("Target")));
+    dncp::com_ptr<IMetaDataEmit> targetEmit;
+    ASSERT_EQ(S_OK, targetAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&targetEmit));
+
+    mdTypeRef typeRef;
+    ASSERT_EQ(S_OK, targetEmit->DefineImportType(sourceAssemblyImport, nullptr, 0, sourceImport, sourceTypeDef, targetAssemblyEmit, &typeRef));
+
+    dncp::com_ptr<IMetaDataImport> targetImport;
+    ASSERT_EQ(S_OK, targetEmit->QueryInterface(IID_IMetaDataImport, (void**)&targetImport));
+    WSTR_string name;
+    mdToken resolutionScope;
+    ASSERT_NO_FATAL_FAILURE(GetTypeRefName(targetImport, typeRef, name, &resolutionScope));
+    ASSERT_EQ(mdtAssemblyRef, TypeFromToken(resolutionScope));
+
+    // The AssemblyRef has the well-known token of the ECMA key.
+    dncp::com_ptr<IMetaDataAssemblyImport> targetAssemblyImport;
+    ASSERT_EQ(S_OK, targetEmit->QueryInterface(IID_IMetaDataAssemblyImport, (void**)&targetAssemblyImport));
+    void const* publicKeyOrToken;
+    ULONG publicKeyOrTokenLength;
+    DWORD flags;
+    ASSERT_EQ(S_OK, targetAssemblyImport->GetAssemblyRefProps(resolutionScope, &publicKeyOrToken, &publicKeyOrTokenLength, nullptr, 0, nullptr, nullptr, nullptr, nullptr, &flags));
+    EXPECT_FALSE(IsAfPublicKey(flags));
+    ASSERT_EQ(ecmaToken.size(), publicKeyOrTokenLength);
+    EXPECT_TRUE(std::equal(ecmaToken.begin(), ecmaToken.end(), (uint8_t const*)publicKeyOrToken));
+}
+
+TEST(TypeRef, TranslateSigImportsTypeRefToOtherAssembly)
+{
+    dncp::com_ptr<IMetaDataAssemblyEmit> sourceAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(sourceAssemblyEmit));
+    ASSERT_NO_FATAL_FAILURE(DefineAssembly(sourceAssemblyEmit, W("Source")));
+    ASSEMBLYMETADATA runtimeMetadata = {};
+    runtimeMetadata.usMajorVersion = 8;
+    runtimeMetadata.szLocale = const_cast<LPWSTR>(W(""));
+    mdAssemblyRef runtimeAssemblyRef;
+    ASSERT_EQ(S_OK, sourceAssemblyEmit->DefineAssemblyRef(nullptr, 0, W("System.Runtime"), &runtimeMetadata, nullptr, 0, 0, &runtimeAssemblyRef));
+    dncp::com_ptr<IMetaDataEmit> sourceEmit;
+    ASSERT_EQ(S_OK, sourceAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&sourceEmit));
+    mdTypeRef sourceTypeRef;
+    ASSERT_EQ(S_OK, sourceEmit->DefineTypeRefByName(runtimeAssemblyRef, W("System.Object"), &sourceTypeRef));
+    dncp::com_ptr<IMetaDataAssemblyImport> sourceAssemblyImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataAssemblyImport, (void**)&sourceAssemblyImport));
+    dncp::com_ptr<IMetaDataImport> sourceImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataImport, (void**)&sourceImport));
+
+    dncp::com_ptr<IMetaDataAssemblyEmit> targetAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(targetAssemblyEmit));
+    ASSERT_NO_FATAL_FAILURE(DefineAssembly(targetAssemblyEmit, W("Target")));
+    dncp::com_ptr<IMetaDataEmit> targetEmit;
+    ASSERT_EQ(S_OK, targetAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&targetEmit));
+
+    uint8_t sig[] = { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_CLASS, 0, 0, 0, 0 };
+    ULONG sigLength = 2 + CorSigCompressToken(sourceTypeRef, &sig[2]);
+    std::array<uint8_t, 8> translatedSig;
+    ULONG translatedSigLength;
+    ASSERT_EQ(S_OK, targetEmit->TranslateSigWithScope(sourceAssemblyImport, nullptr, 0, sourceImport, sig, sigLength, targetAssemblyEmit, targetEmit, translatedSig.data(), (ULONG)translatedSig.size(), &translatedSigLength));
+    ASSERT_LE(3u, translatedSigLength);
+    PCCOR_SIGNATURE translatedToken = &translatedSig[2];
+    mdTypeRef typeRef = CorSigUncompressToken(translatedToken);
+
+    // The TypeRef is scoped to a copy of the source's AssemblyRef.
+    dncp::com_ptr<IMetaDataImport> targetImport;
+    ASSERT_EQ(S_OK, targetEmit->QueryInterface(IID_IMetaDataImport, (void**)&targetImport));
+    WSTR_string name;
+    mdToken resolutionScope;
+    ASSERT_NO_FATAL_FAILURE(GetTypeRefName(targetImport, typeRef, name, &resolutionScope));
+    EXPECT_EQ(WSTR_string(W("System.Object")), name);
+    ASSERT_EQ(mdtAssemblyRef, TypeFromToken(resolutionScope));
+
+    dncp::com_ptr<IMetaDataAssemblyImport> targetAssemblyImport;
+    ASSERT_EQ(S_OK, targetEmit->QueryInterface(IID_IMetaDataAssemblyImport, (void**)&targetAssemblyImport));
+    ASSEMBLYMETADATA metadata = {};
+    std::array<WCHAR, 64> assemblyName;
+    ULONG assemblyNameLength;
+    ASSERT_EQ(S_OK, targetAssemblyImport->GetAssemblyRefProps(resolutionScope, nullptr, nullptr, assemblyName.data(), (ULONG)assemblyName.size(), &assemblyNameLength, &metadata, nullptr, nullptr, nullptr));
+    EXPECT_EQ(WSTR_string(W("System.Runtime")), WSTR_string(assemblyName.data()));
+    EXPECT_EQ(8, metadata.usMajorVersion);
+}
+
+TEST(TypeRef, TranslateSigImportsTypeSpec)
+{
+    dncp::com_ptr<IMetaDataAssemblyEmit> sourceAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(sourceAssemblyEmit));
+    ASSERT_NO_FATAL_FAILURE(DefineAssembly(sourceAssemblyEmit, W("Source")));
+    dncp::com_ptr<IMetaDataEmit> sourceEmit;
+    ASSERT_EQ(S_OK, sourceAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&sourceEmit));
+    uint8_t const typeSpecSig[] = { ELEMENT_TYPE_SZARRAY, ELEMENT_TYPE_I4 };
+    mdTypeSpec sourceTypeSpec;
+    ASSERT_EQ(S_OK, sourceEmit->GetTokenFromTypeSpec(typeSpecSig, sizeof(typeSpecSig), &sourceTypeSpec));
+    dncp::com_ptr<IMetaDataAssemblyImport> sourceAssemblyImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataAssemblyImport, (void**)&sourceAssemblyImport));
+    dncp::com_ptr<IMetaDataImport> sourceImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataImport, (void**)&sourceImport));
+
+    dncp::com_ptr<IMetaDataAssemblyEmit> targetAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(targetAssemblyEmit));
+    ASSERT_NO_FATAL_FAILURE(DefineAssembly(targetAssemblyEmit, W("Target")));
+    dncp::com_ptr<IMetaDataEmit> targetEmit;
+    ASSERT_EQ(S_OK, targetAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&targetEmit));
+
+    uint8_t sig[] = { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_CLASS, 0, 0, 0, 0 };
+    ULONG sigLength = 2 + CorSigCompressToken(sourceTypeSpec, &sig[2]);
+    std::array<uint8_t, 8> translatedSig;
+    ULONG translatedSigLength;
+    ASSERT_EQ(S_OK, targetEmit->TranslateSigWithScope(sourceAssemblyImport, nullptr, 0, sourceImport, sig, sigLength, targetAssemblyEmit, targetEmit, translatedSig.data(), (ULONG)translatedSig.size(), &translatedSigLength));
+    ASSERT_LE(3u, translatedSigLength);
+    PCCOR_SIGNATURE translatedToken = &translatedSig[2];
+    mdTypeSpec typeSpec = CorSigUncompressToken(translatedToken);
+    ASSERT_EQ(mdtTypeSpec, TypeFromToken(typeSpec));
+
+    dncp::com_ptr<IMetaDataImport> targetImport;
+    ASSERT_EQ(S_OK, targetEmit->QueryInterface(IID_IMetaDataImport, (void**)&targetImport));
+    PCCOR_SIGNATURE importedSig;
+    ULONG importedSigLength;
+    ASSERT_EQ(S_OK, targetImport->GetTypeSpecFromToken(typeSpec, &importedSig, &importedSigLength));
+    ASSERT_EQ(sizeof(typeSpecSig), importedSigLength);
+    EXPECT_TRUE(std::equal(std::begin(typeSpecSig), std::end(typeSpecSig), importedSig));
+}
+
+TEST(TypeRef, ImportTypeReusesReference)
+{
+    dncp::com_ptr<IMetaDataAssemblyEmit> sourceAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(sourceAssemblyEmit));
+    ASSEMBLYMETADATA assemblyMetadata = {};
+    assemblyMetadata.szLocale = const_cast<LPWSTR>(W(""));
+    mdAssembly assembly;
+    ASSERT_EQ(S_OK, sourceAssemblyEmit->DefineAssembly(nullptr, 0, 0, W("Source"), &assemblyMetadata, 0, &assembly));
+    dncp::com_ptr<IMetaDataEmit> sourceEmit;
+    ASSERT_EQ(S_OK, sourceAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&sourceEmit));
+    mdTypeDef sourceTypeDef;
+    mdToken implements = mdTokenNil;
+    ASSERT_EQ(S_OK, sourceEmit->DefineTypeDef(W("Source.Type"), tdPublic, mdTypeDefNil, &implements, &sourceTypeDef));
+
+    dncp::com_ptr<IMetaDataAssemblyImport> sourceAssemblyImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataAssemblyImport, (void**)&sourceAssemblyImport));
+    dncp::com_ptr<IMetaDataImport> sourceImport;
+    ASSERT_EQ(S_OK, sourceEmit->QueryInterface(IID_IMetaDataImport, (void**)&sourceImport));
+
+    dncp::com_ptr<IMetaDataAssemblyEmit> targetAssemblyEmit;
+    ASSERT_NO_FATAL_FAILURE(CreateEmit(targetAssemblyEmit));
+    ASSERT_EQ(S_OK, targetAssemblyEmit->DefineAssembly(nullptr, 0, 0, W("Target"), &assemblyMetadata, 0, &assembly));
+    dncp::com_ptr<IMetaDataEmit> targetEmit;
+    ASSERT_EQ(S_OK, targetAssemblyEmit->QueryInterface(IID_IMetaDataEmit, (void**)&targetEmit));
+
+    mdTypeRef typeRef;
+    ASSERT_EQ(S_OK, targetEmit->DefineImportType(sourceAssemblyImport, nullptr, 0, sourceImport, sourceTypeDef, targetAssemblyEmit, &typeRef));
+    ASSERT_EQ(mdtTypeRef, TypeFromToken(typeRef));
+
+    // Definitions added to the target between imports don't change the imported reference.
+    mdTypeRef otherTypeRef;
+    ASSERT_EQ(S_OK, targetEmit->DefineTypeRefByName(TokenFromRid(1, mdtModule), W("System.Object"), &otherTypeRef));
+
+    mdTypeRef reimportedTypeRef;
+    ASSERT_EQ(S_OK, targetEmit->DefineImportType(sourceAssemblyImport, nullptr, 0, sourceImport, sourceTypeDef, targetAssemblyEmit, &reimportedTypeRef));
+    EXPECT_EQ(typeRef, reimportedTypeRef);
+
+    // Signatures imported from the same source refer to the same TypeRef.
+    uint8_t sig[] = { IMAGE_CEE_CS_CALLCONV_FIELD, ELEMENT_TYPE_CLASS, 0, 0, 0, 0 };
+    ULONG sigLength = 2 + CorSigCompressToken(sourceTypeDef, &sig[2]);
+    std::array<uint8_t, 8> translatedSig;
+    ULONG translatedSigLength;
+    ASSERT_EQ(S_OK, targetEmit->TranslateSigWithScope(sourceAssemblyImport, nullptr, 0, sourceImport, sig, sigLength, targetAssemblyEmit, targetEmit, translatedSig.data(), (ULONG)translatedSig.size(), &translatedSigLength));
+    ASSERT_LE(3u, translatedSigLength);
+    EXPECT_EQ(IMAGE_CEE_CS_CALLCONV_FIELD, translatedSig[0]);
+    EXPECT_EQ(ELEMENT_TYPE_CLASS, translatedSig[1]);
+    PCCOR_SIGNATURE translatedToken = &translatedSig[2];
+    EXPECT_EQ(typeRef, CorSigUncompressToken(translatedToken));
+
+    dncp::com_ptr<IMetaDataImport> targetImport;
+    ASSERT_EQ(S_OK, targetEmit->QueryInterface(IID_IMetaDataImport, (void**)&targetImport));
+    mdToken resolutionScope;
+    std::array<WCHAR, 64> name;
+    ULONG nameLength;
+    ASSERT_EQ(S_OK, targetImport->GetTypeRefProps(typeRef, &resolutionScope, name.data(), (ULONG)name.size(), &nameLength));
+    EXPECT_EQ(mdtAssemblyRef, TypeFromToken(resolutionScope));
+    EXPECT_EQ(WSTR_string(W("Source.Type")), WSTR_string(name.data()));
+}
@@ -0,0 +1,53 @@
+// The source of Subject.pdb. Rebuild it from this directory with:
+//   csc -target:library -debug:portable -optimize- -deterministic -pathmap:$PWD=/src -out:Subject.dll Subject.cs
+// The tests check the lines and IL offsets of this file, so update them when it changes.
+using System;
+
+namespace Pdb
+{
+    public static class Subject
+    {
+        public static int Scopes(int x)
+        {
+            const int K = 42;
+            const string S = "text";
+            int a = x + K;
+            for (int i = 0; i < 3; i++)
+            {
+                int square = i * i;
+                a += square;
+            }
+            return a + S.Length;
+        }
+
+        public static int Hidden(int x)
+        {
+            int y = x + 1;
+#line hidden
+            y *= 2;
+#line default
+            return y;
+        }
+
+        public static Func<int, int> Lambda(int x)
+        {
+            return y =>
+            {
+                return x + y;
+            };
+        }
+
+#line 1 "Other.cs"
+        public static int Other(int x)
+        {
+            return x * 3;
+        }
+
+#line 1 "OTHER.CS"
+        public static int Shouting(int x)
+        {
+            return x * 4;
+        }
+#line default
+    }
+}
@@ -0,0 +1,91 @@
+#include "pdb.hpp"
+
+namespace
+{
+    mdToken FindDocument(mdhandle_t handle, char const* name, bool ignoreCase)
+    {
+        mdcursor_t document;
+        if (!md_find_document(handle, name, ignoreCase, &document))
+            return 0;
+        mdToken token = 0;
+        EXPECT_TRUE(md_cursor_to_token(document, &token));
+        return token;
+    }
+}
+
+TEST(Documents, GetName)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    mdcursor_t document;
+    ASSERT_TRUE(md_token_to_cursor(handle.get(), SubjectDocument, &document));
+    char const* name;
+    ASSERT_TRUE(md_get_document_name(document, &name));
+    EXPECT_STREQ("/src/Subject.cs", name);
+
+    // Names are cached, so the same string is returned.
+    char const* cached;
+    ASSERT_TRUE(md_get_document_name(document, &cached));
+    EXPECT_EQ(name, cached);
+
+    ASSERT_TRUE(md_cursor_next(&document));
+    ASSERT_TRUE(md_get_document_name(document, &name));
+    EXPECT_STREQ("/src/Other.cs", name);
+    ASSERT_TRUE(md_cursor_next(&document));
+    ASSERT_TRUE(md_get_document_name(document, &name));
+    EXPECT_STREQ("/src/OTHER.CS", name);
+
+    // The cursor must be for a Document row.
+    mdcursor_t scope;
+    ASSERT_TRUE(md_token_to_cursor(handle.get(), mdtid_LocalScope << 24 | 1, &scope));
+    EXPECT_FALSE(md_get_document_name(scope, &name));
+    EXPECT_FALSE(md_get_document_name(document, nullptr));
+}
+
+TEST(Documents, FindByName)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    EXPECT_EQ(SubjectDocument, FindDocument(handle.get(), "/src/Subject.cs", false));
+    EXPECT_EQ(OtherDocument, FindDocument(handle.get(), "/src/Other.cs", false));
+    EXPECT_EQ(ShoutingDocument, FindDocument(handle.get(), "/src/OTHER.CS", false));
+
+    EXPECT_EQ(0u, FindDocument(handle.get(), "/src/other.cs", false));
+    EXPECT_EQ(0u, FindDocument(handle.get(), "/src/Subject.c", false));
+    EXPECT_EQ(0u, FindDocument(handle.get(), "Subject.cs", false));
+    EXPECT_EQ(0u, FindDocument(handle.get(), "", false));
+}
+
+TEST(Documents, FindByNameIgnoringCase)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    EXPECT_EQ(SubjectDocument, FindDocument(handle.get(), "/SRC/subject.CS", true));
+
+    // The first of the names that only differ in case is found.
+    EXPECT_EQ(OtherDocument, FindDocument(handle.get(), "/src/other.cs", true));
+    EXPECT_EQ(OtherDocument, FindDocument(handle.get(), "/src/OTHER.CS", true));
+
+    // An exact lookup still finds the later row.
+    EXPECT_EQ(ShoutingDocument, FindDocument(handle.get(), "/src/OTHER.CS", false));
+
+    EXPECT_EQ(0u, FindDocument(handle.get(), "/src/missing.cs", true));
+}
+
+TEST(Documents, FindInvalidArguments)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    mdcursor_t document;
+    EXPECT_FALSE(md_find_document(handle.get(), nullptr, false, &document));
+    EXPECT_FALSE(md_find_document(handle.get(), "/src/Subject.cs", false, nullptr));
+    EXPECT_FALSE(md_find_document(nullptr, "/src/Subject.cs", false, &document));
+}
@@ -0,0 +1,137 @@
+#include "pdb.hpp"
+
+namespace
+{
+    void GetScopes(mdhandle_t handle, mdToken method, uint32_t ilOffset, std::vector<md_local_scope_t>& scopes)
+    {
+        uint32_t count;
+        ASSERT_TRUE(md_get_local_scopes_at_offset(handle, method, ilOffset, nullptr, &count));
+        scopes.resize(count);
+        ASSERT_TRUE(md_get_local_scopes_at_offset(handle, method, ilOffset, scopes.data(), &count));
+        ASSERT_EQ(scopes.size(), count);
+    }
+
+    // Get the names of a list of LocalVariable or LocalConstant rows.
+    std::vector<std::string> GetNames(mdcursor_t first, uint32_t count, col_index_t nameColumn)
+    {
+        std::vector<std::string> names;
+        mdcursor_t cursor = first;
+        for (uint32_t i = 0; i < count; ++i, md_cursor_next(&cursor))
+        {
+            char const* name;
+            EXPECT_EQ(1, md_get_column_value_as_utf8(cursor, nameColumn, 1, &name));
+            names.push_back(name);
+        }
+        return names;
+    }
+
+    // The start and end offsets of each scope.
+    using Ranges = std::vector<std::pair<uint32_t, uint32_t>>;
+
+    Ranges GetRanges(std::vector<md_local_scope_t> const& scopes)
+    {
+        Ranges ranges;
+        for (md_local_scope_t const& scope : scopes)
+            ranges.emplace_back(scope.start_offset, scope.start_offset + scope.length);
+        return ranges;
+    }
+}
+
+TEST(LocalScopes, NestedScopes)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    // The method, the for loop and the loop's body - innermost first.
+    std::vector<md_local_scope_t> scopes;
+    ASSERT_NO_FATAL_FAILURE(GetScopes(handle.get(), SubjectScopes, 12, scopes));
+    EXPECT_EQ((Ranges{ { 10, 20 }, { 6, 32 }, { 0, 51 } }), GetRanges(scopes));
+
+    EXPECT_EQ((std::vector<std::string>{ "square" }), GetNames(scopes[0].variables, scopes[0].variable_count, mdtLocalVariable_Name));
+    EXPECT_EQ(0u, scopes[0].constant_count);
+    EXPECT_EQ((std::vector<std::string>{ "i" }), GetNames(scopes[1].variables, scopes[1].variable_count, mdtLocalVariable_Name));
+    EXPECT_EQ(0u, scopes[1].constant_count);
+    EXPECT_EQ((std::vector<std::string>{ "a" }), GetNames(scopes[2].variables, scopes[2].variable_count, mdtLocalVariable_Name));
+    EXPECT_EQ((std::vector<std::string>{ "K", "S" }), GetNames(scopes[2].constants, scopes[2].constant_count, mdtLocalConstant_Name));
+
+    // The scopes are sorted by method and start offset, so the outermost scope is the first row.
+    mdToken token;
+    ASSERT_TRUE(md_cursor_to_token(scopes[0].scope, &token));
+    EXPECT_EQ(mdtid_LocalScope << 24 | 3u, token);
+    ASSERT_TRUE(md_cursor_to_token(scopes[2].scope, &token));
+    EXPECT_EQ(mdtid_LocalScope << 24 | 1u, token);
+
+    // All of the method's scopes use the file's imports.
+    for (md_local_scope_t const& scope : scopes)
+    {
+        ASSERT_TRUE(md_cursor_to_token(scope.import_scope, &token));
+        EXPECT_EQ(mdtid_ImportScope, token >> 24);
+    }
+}
+
+TEST(LocalScopes, OffsetsAtScopeBoundaries)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    // Scopes include their start offset and exclude their end offset.
+    std::vector<md_local_scope_t> scopes;
+    ASSERT_NO_FATAL_FAILURE(GetScopes(handle.get(), SubjectScopes, 0, scopes));
+    EXPECT_EQ((Ranges{ { 0, 51 } }), GetRanges(scopes));
+    ASSERT_NO_FATAL_FAILURE(GetScopes(handle.get(), SubjectScopes, 6, scopes));
+    EXPECT_EQ((Ranges{ { 6, 32 }, { 0, 51 } }), GetRanges(scopes));
+    ASSERT_NO_FATAL_FAILURE(GetScopes(handle.get(), SubjectScopes, 10, scopes));
+    EXPECT_EQ((Ranges{ { 10, 20 }, { 6, 32 }, { 0, 51 } }), GetRanges(scopes));
+    ASSERT_NO_FATAL_FAILURE(GetScopes(handle.get(), SubjectScopes, 19, scopes));
+    EXPECT_EQ((Ranges{ { 10, 20 }, { 6, 32 }, { 0, 51 } }), GetRanges(scopes));
+    ASSERT_NO_FATAL_FAILURE(GetScopes(handle.get(), SubjectScopes, 20, scopes));
+    EXPECT_EQ((Ranges{ { 6, 32 }, { 0, 51 } }), GetRanges(scopes));
+    ASSERT_NO_FATAL_FAILURE(GetScopes(handle.get(), SubjectScopes, 32, scopes));
+    EXPECT_EQ((Ranges{ { 0, 51 } }), GetRanges(scopes));
+    ASSERT_NO_FATAL_FAILURE(GetScopes(handle.get(), SubjectScopes, 50, scopes));
+    EXPECT_EQ((Ranges{ { 0, 51 } }), GetRanges(scopes));
+    ASSERT_NO_FATAL_FAILURE(GetScopes(handle.get(), SubjectScopes, 51, scopes));
+    EXPECT_TRUE(scopes.empty());
+}
+
+TEST(LocalScopes, ScopesOfOtherMethods)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    std::vector<md_local_scope_t> scopes;
+    ASSERT_NO_FATAL_FAILURE(GetScopes(handle.get(), SubjectHidden, 5, scopes));
+    EXPECT_EQ((Ranges{ { 0, 15 } }), GetRanges(scopes));
+    EXPECT_EQ((std::vector<std::string>{ "y" }), GetNames(scopes[0].variables, scopes[0].variable_count, mdtLocalVariable_Name));
+
+    // A scope without variables or constants.
+    ASSERT_NO_FATAL_FAILURE(GetScopes(handle.get(), SubjectOther, 0, scopes));
+    EXPECT_EQ((Ranges{ { 0, 9 } }), GetRanges(scopes));
+    EXPECT_EQ(0u, scopes[0].variable_count);
+    EXPECT_EQ(0u, scopes[0].constant_count);
+
+    // Methods without scopes, including ones past the end of the table.
+    ASSERT_NO_FATAL_FAILURE(GetScopes(handle.get(), SubjectClosureCtor, 0, scopes));
+    EXPECT_TRUE(scopes.empty());
+    ASSERT_NO_FATAL_FAILURE(GetScopes(handle.get(), 0x06000064, 0, scopes));
+    EXPECT_TRUE(scopes.empty());
+}
+
+TEST(LocalScopes, InvalidArguments)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    // A buffer that's too small gets the required count.
+    md_local_scope_t scope;
+    uint32_t count = 1;
+    EXPECT_FALSE(md_get_local_scopes_at_offset(handle.get(), SubjectScopes, 10, &scope, &count));
+    EXPECT_EQ(3u, count);
+
+    EXPECT_FALSE(md_get_local_scopes_at_offset(handle.get(), SubjectDocument, 0, nullptr, &count));
+    EXPECT_FALSE(md_get_local_scopes_at_offset(handle.get(), SubjectScopes, 0, nullptr, nullptr));
+}
@@ -0,0 +1,46 @@
+#ifndef DNMD_TEST_PDB_PDB_HPP
+#define DNMD_TEST_PDB_PDB_HPP
+
+#include <dnmd.hpp>
+#include <dnmd_pdb.h>
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Read a file from the assets directory.
+inline void ReadAsset(char const* name, std::vector<uint8_t>& data)
+{
+    std::ifstream file{ std::string{ PDB_ASSET_DIR } + "/" + name, std::ios::binary };
+    ASSERT_TRUE(file.is_open()) << name;
+    data.assign(std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{});
+}
+
+// Open one of the Portable PDBs in the assets directory.
+// The data must outlive the handle.
+inline void OpenPdb(char const* name, std::vector<uint8_t>& data, mdhandle_ptr& handle)
+{
+    ASSERT_NO_FATAL_FAILURE(ReadAsset(name, data));
+    mdhandle_t raw;
+    ASSERT_TRUE(md_create_handle(data.data(), data.size(), &raw));
+    handle.reset(raw);
+}
+
+// The tokens of the methods in Subject.cs, in declaration order.
+constexpr mdToken SubjectScopes = 0x06000001;
+constexpr mdToken SubjectHidden = 0x06000002;
+constexpr mdToken SubjectLambda = 0x06000003;
+constexpr mdToken SubjectOther = 0x06000004;
+constexpr mdToken SubjectShouting = 0x06000005;
+// The constructor of the lambda's closure class has no sequence points.
+constexpr mdToken SubjectClosureCtor = 0x06000006;
+constexpr mdToken SubjectLambdaBody = 0x06000007;
+
+// The Document rows of Subject.pdb.
+constexpr mdToken SubjectDocument = 0x30000001;
+constexpr mdToken OtherDocument = 0x30000002;
+constexpr mdToken ShoutingDocument = 0x30000003;
+
+#endif // DNMD_TEST_PDB_PDB_HPP
@@ -0,0 +1,311 @@
+#include "pdb.hpp"
+
+namespace
+{
+    // Read the SequencePoints blob of a method, without the given number of trailing bytes.
+    void InitReader(mdhandle_t handle, mdToken method, std::vector<uint8_t>& blob, md_sequence_point_reader_t& reader, size_t trim = 0)
+    {
+        // MethodDebugInformation rows correspond one-to-one with MethodDef rows.
+        mdcursor_t debugInfo;
+        ASSERT_TRUE(md_token_to_cursor(handle, (method & 0x00ffffff) | (mdtid_MethodDebugInformation << 24), &debugInfo));
+        uint8_t const* data;
+        uint32_t dataLen;
+        ASSERT_EQ(1, md_get_column_value_as_blob(debugInfo, mdtMethodDebugInformation_SequencePoints, 1, &data, &dataLen));
+
+        ASSERT_LE(trim, dataLen);
+        blob.assign(data, data + dataLen - trim);
+        ASSERT_EQ(mdbpr_Success, md_init_sequence_point_reader(debugInfo, blob.data(), blob.size(), &reader));
+    }
+
+    void ReadAll(md_sequence_point_reader_t& reader, std::vector<md_sequence_point_t>& points)
+    {
+        md_sequence_point_t point;
+        while (md_read_sequence_point(&reader, &point))
+            points.push_back(point);
+        ASSERT_FALSE(reader.invalid);
+    }
+
+    void ExpectSpan(md_sequence_point_t const& point, uint32_t startLine, uint32_t startColumn, uint32_t endLine, uint32_t endColumn)
+    {
+        EXPECT_FALSE(point.hidden);
+        EXPECT_EQ(startLine, point.start_line);
+        EXPECT_EQ(startColumn, point.start_column);
+        EXPECT_EQ(endLine, point.end_line);
+        EXPECT_EQ(endColumn, point.end_column);
+    }
+
+    void ExpectHidden(md_sequence_point_t const& point)
+    {
+        EXPECT_TRUE(point.hidden);
+        EXPECT_EQ((uint32_t)MD_HIDDEN_SEQUENCE_POINT_LINE, point.start_line);
+        EXPECT_EQ(0u, point.start_column);
+        EXPECT_EQ((uint32_t)MD_HIDDEN_SEQUENCE_POINT_LINE, point.end_line);
+        EXPECT_EQ(0u, point.end_column);
+    }
+
+    mdToken DocumentOf(md_sequence_point_t const& point)
+    {
+        mdToken document = 0;
+        EXPECT_TRUE(md_cursor_to_token(point.document, &document));
+        return document;
+    }
+}
+
+TEST(SequencePoints, ReadInOffsetOrder)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    std::vector<uint8_t> blob;
+    md_sequence_point_reader_t reader;
+    ASSERT_NO_FATAL_FAILURE(InitReader(handle.get(), SubjectScopes, blob, reader));
+    std::vector<md_sequence_point_t> points;
+    ASSERT_NO_FATAL_FAILURE(ReadAll(reader, points));
+
+    ASSERT_EQ(13u, points.size());
+    std::vector<uint32_t> offsets;
+    for (md_sequence_point_t const& point : points)
+    {
+        offsets.push_back(point.il_offset);
+        EXPECT_EQ(SubjectDocument, DocumentOf(point));
+    }
+    EXPECT_EQ((std::vector<uint32_t>{ 0, 1, 6, 8, 10, 11, 15, 19, 20, 24, 29, 32, 48 }), offsets);
+
+    ExpectSpan(points[0], 11, 9, 11, 10);
+    ExpectSpan(points[1], 14, 13, 14, 27);
+    ExpectSpan(points[2], 15, 18, 15, 27);
+    ExpectHidden(points[3]);
+    // The increment and condition of the for loop come after its body.
+    ExpectSpan(points[8], 15, 36, 15, 39);
+    ExpectSpan(points[9], 15, 29, 15, 34);
+    ExpectHidden(points[10]);
+    ExpectSpan(points[12], 21, 9, 21, 10);
+}
+
+TEST(SequencePoints, ReadHiddenAndMultiLinePoints)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    std::vector<uint8_t> blob;
+    md_sequence_point_reader_t reader;
+    ASSERT_NO_FATAL_FAILURE(InitReader(handle.get(), SubjectLambda, blob, reader));
+    std::vector<md_sequence_point_t> points;
+    ASSERT_NO_FATAL_FAILURE(ReadAll(reader, points));
+
+    // The first point is hidden, so the start of the second point is absolute.
+    ASSERT_EQ(4u, points.size());
+    EXPECT_EQ(0u, points[0].il_offset);
+    ExpectHidden(points[0]);
+    EXPECT_EQ(13u, points[1].il_offset);
+    ExpectSpan(points[1], 33, 9, 33, 10);
+    EXPECT_EQ(14u, points[2].il_offset);
+    ExpectSpan(points[2], 34, 13, 37, 15);
+    EXPECT_EQ(29u, points[3].il_offset);
+    ExpectSpan(points[3], 38, 9, 38, 10);
+}
+
+TEST(SequencePoints, ReadPointsInOtherDocument)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    // The document of a method with points in a single document is in its MethodDebugInformation row.
+    std::vector<uint8_t> blob;
+    md_sequence_point_reader_t reader;
+    ASSERT_NO_FATAL_FAILURE(InitReader(handle.get(), SubjectOther, blob, reader));
+    std::vector<md_sequence_point_t> points;
+    ASSERT_NO_FATAL_FAILURE(ReadAll(reader, points));
+
+    ASSERT_EQ(3u, points.size());
+    for (md_sequence_point_t const& point : points)
+        EXPECT_EQ(OtherDocument, DocumentOf(point));
+    ExpectSpan(points[1], 3, 13, 3, 26);
+}
+
+TEST(SequencePoints, ReadTruncatedBlob)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    std::vector<uint8_t> blob;
+    md_sequence_point_reader_t reader;
+    ASSERT_NO_FATAL_FAILURE(InitReader(handle.get(), SubjectScopes, blob, reader));
+    std::vector<md_sequence_point_t> points;
+    ASSERT_NO_FATAL_FAILURE(ReadAll(reader, points));
+
+    // Drop the last byte of the final record.
+    ASSERT_NO_FATAL_FAILURE(InitReader(handle.get(), SubjectScopes, blob, reader, 1));
+    md_sequence_point_t point;
+    size_t count = 0;
+    while (md_read_sequence_point(&reader, &point))
+        count++;
+    EXPECT_TRUE(reader.invalid);
+    EXPECT_EQ(points.size() - 1, count);
+
+    // The reader stays at the malformed record.
+    EXPECT_FALSE(md_read_sequence_point(&reader, &point));
+}
+
+TEST(SequencePoints, FindPointForOffset)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    md_sequence_point_t point;
+    ASSERT_TRUE(md_find_sequence_point(handle.get(), SubjectScopes, 0, &point));
+    EXPECT_EQ(0u, point.il_offset);
+    ExpectSpan(point, 11, 9, 11, 10);
+    EXPECT_EQ(SubjectDocument, DocumentOf(point));
+
+    // Offsets between points map to the point before them.
+    ASSERT_TRUE(md_find_sequence_point(handle.get(), SubjectScopes, 17, &point));
+    EXPECT_EQ(15u, point.il_offset);
+    ExpectSpan(point, 18, 17, 18, 29);
+
+    // Offsets past the last point map to the last point.
+    ASSERT_TRUE(md_find_sequence_point(handle.get(), SubjectScopes, 0x1000, &point));
+    EXPECT_EQ(48u, point.il_offset);
+
+    // Methods are cached by row, so a second method is decoded correctly.
+    ASSERT_TRUE(md_find_sequence_point(handle.get(), SubjectShouting, 1, &point));
+    EXPECT_EQ(ShoutingDocument, DocumentOf(point));
+    ExpectSpan(point, 3, 13, 3, 26);
+    ASSERT_TRUE(md_find_sequence_point(handle.get(), SubjectScopes, 1, &point));
+    ExpectSpan(point, 14, 13, 14, 27);
+}
+
+TEST(SequencePoints, FindPointSkipsHiddenPoints)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    // Offsets covered by a hidden point map to the last visible point before it.
+    md_sequence_point_t point;
+    ASSERT_TRUE(md_find_sequence_point(handle.get(), SubjectHidden, 5, &point));
+    EXPECT_EQ(1u, point.il_offset);
+    ExpectSpan(point, 25, 13, 25, 27);
+    ASSERT_TRUE(md_find_sequence_point(handle.get(), SubjectHidden, 9, &point));
+    ExpectSpan(point, 29, 13, 29, 22);
+
+    ASSERT_TRUE(md_find_sequence_point(handle.get(), SubjectScopes, 8, &point));
+    EXPECT_EQ(6u, point.il_offset);
+    ASSERT_TRUE(md_find_sequence_point(handle.get(), SubjectScopes, 30, &point));
+    EXPECT_EQ(24u, point.il_offset);
+
+    // There is no visible point before the hidden prologue of the lambda's closure.
+    EXPECT_FALSE(md_find_sequence_point(handle.get(), SubjectLambda, 0, &point));
+    EXPECT_FALSE(md_find_sequence_point(handle.get(), SubjectLambda, 12, &point));
+    ASSERT_TRUE(md_find_sequence_point(handle.get(), SubjectLambda, 13, &point));
+    ExpectSpan(point, 33, 9, 33, 10);
+}
+
+TEST(SequencePoints, FindPointInvalidArguments)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    md_sequence_point_t point;
+    // Methods without sequence points have an empty blob.
+    EXPECT_FALSE(md_find_sequence_point(handle.get(), SubjectClosureCtor, 0, &point));
+    EXPECT_FALSE(md_find_sequence_point(handle.get(), 0x06000064, 0, &point));
+    EXPECT_FALSE(md_find_sequence_point(handle.get(), SubjectDocument, 0, &point));
+    EXPECT_FALSE(md_find_sequence_point(handle.get(), SubjectScopes, 0, nullptr));
+}
+
+namespace
+{
+    void FindMethodsForLine(mdhandle_t handle, mdToken document, uint32_t line, std::vector<mdToken>& methods)
+    {
+        mdcursor_t cursor;
+        ASSERT_TRUE(md_token_to_cursor(handle, document, &cursor));
+        uint32_t count;
+        ASSERT_TRUE(md_find_methods_for_document_line(handle, cursor, line, nullptr, &count));
+        methods.resize(count);
+        ASSERT_TRUE(md_find_methods_for_document_line(handle, cursor, line, methods.data(), &count));
+        ASSERT_EQ(methods.size(), count);
+    }
+}
+
+TEST(SequencePoints, FindMethodsForLine)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    std::vector<mdToken> methods;
+    ASSERT_NO_FATAL_FAILURE(FindMethodsForLine(handle.get(), SubjectDocument, 11, methods));
+    EXPECT_EQ((std::vector<mdToken>{ SubjectScopes }), methods);
+    ASSERT_NO_FATAL_FAILURE(FindMethodsForLine(handle.get(), SubjectDocument, 21, methods));
+    EXPECT_EQ((std::vector<mdToken>{ SubjectScopes }), methods);
+
+    // Lines between methods and outside of the document's methods aren't in any method.
+    ASSERT_NO_FATAL_FAILURE(FindMethodsForLine(handle.get(), SubjectDocument, 22, methods));
+    EXPECT_TRUE(methods.empty());
+    ASSERT_NO_FATAL_FAILURE(FindMethodsForLine(handle.get(), SubjectDocument, 1, methods));
+    EXPECT_TRUE(methods.empty());
+    ASSERT_NO_FATAL_FAILURE(FindMethodsForLine(handle.get(), SubjectDocument, 39, methods));
+    EXPECT_TRUE(methods.empty());
+
+    // The span of a method covers the lines of its hidden points.
+    ASSERT_NO_FATAL_FAILURE(FindMethodsForLine(handle.get(), SubjectDocument, 27, methods));
+    EXPECT_EQ((std::vector<mdToken>{ SubjectHidden }), methods);
+
+    // Methods in other documents are only found in their document.
+    ASSERT_NO_FATAL_FAILURE(FindMethodsForLine(handle.get(), SubjectDocument, 3, methods));
+    EXPECT_TRUE(methods.empty());
+    ASSERT_NO_FATAL_FAILURE(FindMethodsForLine(handle.get(), OtherDocument, 3, methods));
+    EXPECT_EQ((std::vector<mdToken>{ SubjectOther }), methods);
+    ASSERT_NO_FATAL_FAILURE(FindMethodsForLine(handle.get(), ShoutingDocument, 3, methods));
+    EXPECT_EQ((std::vector<mdToken>{ SubjectShouting }), methods);
+}
+
+TEST(SequencePoints, FindMethodsForLineSpanningMethods)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    // The body of the lambda is inside the method that creates it.
+    // The methods are ordered by their first line.
+    std::vector<mdToken> methods;
+    ASSERT_NO_FATAL_FAILURE(FindMethodsForLine(handle.get(), SubjectDocument, 36, methods));
+    EXPECT_EQ((std::vector<mdToken>{ SubjectLambda, SubjectLambdaBody }), methods);
+    ASSERT_NO_FATAL_FAILURE(FindMethodsForLine(handle.get(), SubjectDocument, 34, methods));
+    EXPECT_EQ((std::vector<mdToken>{ SubjectLambda }), methods);
+    ASSERT_NO_FATAL_FAILURE(FindMethodsForLine(handle.get(), SubjectDocument, 38, methods));
+    EXPECT_EQ((std::vector<mdToken>{ SubjectLambda }), methods);
+
+    // A buffer that's too small gets the required count.
+    mdcursor_t document;
+    ASSERT_TRUE(md_token_to_cursor(handle.get(), SubjectDocument, &document));
+    mdToken method = 0;
+    uint32_t count = 1;
+    EXPECT_FALSE(md_find_methods_for_document_line(handle.get(), document, 36, &method, &count));
+    EXPECT_EQ(2u, count);
+    EXPECT_EQ(SubjectLambda, method);
+}
+
+TEST(SequencePoints, FindMethodsForLineInvalidArguments)
+{
+    std::vector<uint8_t> data;
+    mdhandle_ptr handle;
+    ASSERT_NO_FATAL_FAILURE(OpenPdb("Subject.pdb", data, handle));
+
+    // The cursor must be for a Document row.
+    mdcursor_t scope;
+    ASSERT_TRUE(md_token_to_cursor(handle.get(), mdtid_LocalScope << 24 | 1, &scope));
+    uint32_t count;
+    EXPECT_FALSE(md_find_methods_for_document_line(handle.get(), scope, 11, nullptr, &count));
+
+    mdcursor_t document;
+    ASSERT_TRUE(md_token_to_cursor(handle.get(), SubjectDocument, &document));
+    EXPECT_FALSE(md_find_methods_for_document_line(handle.get(), document, 11, nullptr, nullptr));
+}
@@ -0,0 +1,398 @@
+#include <internal/dnmd_platform.hpp>
+#include <external/corsym.h>
+#include <dnmd_interfaces.hpp>
+#include "pdb.hpp"
+#include <algorithm>
+#include <cstdio>
+
+using WSTR_string = std::basic_string<WCHAR>;
+
+namespace
+{
+    // The test paths are ASCII, so they can be widened by each character.
+    WSTR_string Widen(std::string const& str)
+    {
+        return WSTR_string{ str.begin(), str.end() };
+    }
+
+    void GetReader(std::string const& path, dncp::com_ptr<ISymUnmanagedReader>& reader)
+    {
+        dncp::com_ptr<ISymUnmanagedBinder> binder;
+        ASSERT_EQ(S_OK, GetSymBinder(IID_ISymUnmanagedBinder, (void**)&binder));
+        ASSERT_EQ(S_OK, binder->GetReaderForFile(nullptr, Widen(path).c_str(), nullptr, &reader));
+    }
+
+    void GetAssetReader(char const* name, dncp::com_ptr<ISymUnmanagedReader>& reader)
+    {
+        ASSERT_NO_FATAL_FAILURE(GetReader(std::string{ PDB_ASSET_DIR } + "/" + name, reader));
+    }
+
+    void GetRootScope(ISymUnmanagedReader* reader, mdToken methodToken, dncp::com_ptr<ISymUnmanagedScope2>& scope)
+    {
+        dncp::com_ptr<ISymUnmanagedMethod> method;
+        ASSERT_EQ(S_OK, reader->GetMethod(methodToken, &method));
+        dncp::com_ptr<ISymUnmanagedScope> root;
+        ASSERT_EQ(S_OK, method->GetRootScope(&root));
+        ASSERT_EQ(S_OK, root->QueryInterface(IID_ISymUnmanagedScope2, (void**)&scope));
+    }
+
+    void GetConstant(ISymUnmanagedScope2* scope, WCHAR const* name, dncp::com_ptr<ISymUnmanagedConstant>& constant)
+    {
+        ULONG32 count;
+        ASSERT_EQ(S_OK, scope->GetConstants(0, &count, nullptr));
+        std::vector<ISymUnmanagedConstant*> constants(count);
+        ASSERT_EQ(S_OK, scope->GetConstants(count, &count, constants.data()));
+        for (ISymUnmanagedConstant* candidate : constants)
+        {
+            WCHAR candidateName[64];
+            ULONG32 nameLength;
+            EXPECT_EQ(S_OK, candidate->GetName(ARRAY_SIZE(candidateName), &nameLength, candidateName));
+            if (WSTR_string{ candidateName } == name)
+                constant.Attach(candidate);
+            else
+                candidate->Release();
+        }
+        ASSERT_NE(nullptr, constant);
+    }
+
+    // The constants of Constants.Values in Constants.vb.
+    constexpr mdToken ConstantsValues = 0x06000002;
+}
+
+TEST(SymReader, GeneralConstantValues)
+{
+    dncp::com_ptr<ISymUnmanagedReader> reader;
+    ASSERT_NO_FATAL_FAILURE(GetAssetReader("Constants.pdb", reader));
+    dncp::com_ptr<ISymUnmanagedScope2> scope;
+    ASSERT_NO_FATAL_FAILURE(GetRootScope(reader, ConstantsValues, scope));
+
+    VARIANT value;
+    dncp::com_ptr<ISymUnmanagedConstant> decimal;
+    ASSERT_NO_FATAL_FAILURE(GetConstant(scope, W("M"), decimal));
+    ASSERT_EQ(S_OK, decimal->GetValue(&value));
+    ASSERT_EQ(VT_DECIMAL, V_VT(&value));
+    EXPECT_EQ(DECIMAL_NEG, V_DECIMAL(&value).sign);
+    EXPECT_EQ(3, V_DECIMAL(&value).scale);
+    EXPECT_EQ(12345u, V_DECIMAL(&value).Lo32);
+    EXPECT_EQ(0u, V_DECIMAL(&value).Mid32);
+    EXPECT_EQ(0u, V_DECIMAL(&value).Hi32);
+
+    // 2000-02-29 12:30 is half a day and half an hour after the start of day 36585.
+    dncp::com_ptr<ISymUnmanagedConstant> date;
+    ASSERT_NO_FATAL_FAILURE(GetConstant(scope, W("D"), date));
+    ASSERT_EQ(S_OK, date->GetValue(&value));
+    ASSERT_EQ(VT_DATE, V_VT(&value));
+    EXPECT_DOUBLE_EQ(36585 + 12.5 / 24, V_DATE(&value));
+
+    dncp::com_ptr<ISymUnmanagedConstant> object;
+    ASSERT_NO_FATAL_FAILURE(GetConstant(scope, W("O"), object));
+    ASSERT_EQ(S_OK, object->GetValue(&value));
+    EXPECT_EQ(VT_NULL, V_VT(&value));
+}
+
+TEST(SymReader, GeneralConstantValuesOutOfRange)
+{
+    std::vector<uint8_t> data;
+    ASSERT_NO_FATAL_FAILURE(ReadAsset("Constants.pdb", data));
+
+    // Move the date to 0001-01-02, before the earliest OLE Automation date.
+    uint8_t const dateSignature[] = { 0x11, 0x19, 0x00, 0x94, 0x5a, 0xd4, 0xc7, 0x50, 0xc1, 0x08 };
+    auto dateValue = std::search(data.begin(), data.end(), std::begin(dateSignature), std::end(dateSignature));
+    ASSERT_NE(data.end(), dateValue);
+    uint8_t const dayTicks[] = { 0x00, 0xc0, 0x69, 0x2a, 0xc9, 0x00, 0x00, 0x00 };
+    std::copy(std::begin(dayTicks), std::end(dayTicks), dateValue + 2);
+
+    // Give the decimal a scale larger than 28.
+    uint8_t const decimalSignature[] = { 0x11, 0x1d, 0x83, 0x39, 0x30 };
+    auto decimalValue = std::search(data.begin(), data.end(), std::begin(decimalSignature), std::end(decimalSignature));
+    ASSERT_NE(data.end(), decimalValue);
+    decimalValue[2] = 0x9d;
+
+    std::string path = ::testing::TempDir() + "OutOfRange.pdb";
+    std::unique_ptr<FILE, int(*)(FILE*)> file{ std::fopen(path.c_str(), "wb"), &std::fclose };
+    ASSERT_NE(nullptr, file);
+    ASSERT_EQ(data.size(), std::fwrite(data.data(), 1, data.size(), file.get()));
+    file.reset();
+
+    // The reader maps the file, so it is released before the file is removed.
+    {
+        dncp::com_ptr<ISymUnmanagedReader> reader;
+        ASSERT_NO_FATAL_FAILURE(GetReader(path, reader));
+        dncp::com_ptr<ISymUnmanagedScope2> scope;
+        ASSERT_NO_FATAL_FAILURE(GetRootScope(reader, ConstantsValues, scope));
+
+        VARIANT value;
+        dncp::com_ptr<ISymUnmanagedConstant> date;
+        ASSERT_NO_FATAL_FAILURE(GetConstant(scope, W("D"), date));
+        EXPECT_EQ(E_NOTIMPL, date->GetValue(&value));
+        EXPECT_EQ(VT_EMPTY, V_VT(&value));
+
+        dncp::com_ptr<ISymUnmanagedConstant> decimal;
+        ASSERT_NO_FATAL_FAILURE(GetConstant(scope, W("M"), decimal));
+        EXPECT_EQ(CLDB_E_FILE_CORRUPT, decimal->GetValue(&value));
+        EXPECT_EQ(VT_EMPTY, V_VT(&value));
+    }
+    std::remove(path.c_str());
+}
+
+namespace
+{
+    // Take ownership of the objects returned in an array.
+    template<typename T>
+    std::vector<dncp::com_ptr<T>> Own(std::vector<T*> const& objects)
+    {
+        std::vector<dncp::com_ptr<T>> owned(objects.size());
+        for (size_t i = 0; i < objects.size(); ++i)
+            owned[i].Attach(objects[i]);
+        return owned;
+    }
+
+    std::string GetUrl(ISymUnmanagedDocument* document)
+    {
+        WCHAR url[64];
+        ULONG32 length;
+        EXPECT_EQ(S_OK, document->GetURL(ARRAY_SIZE(url), &length, url));
+        // The test paths are ASCII.
+        WSTR_string wideUrl{ url };
+        return std::string{ wideUrl.begin(), wideUrl.end() };
+    }
+
+    std::pair<ULONG32, ULONG32> GetRange(ISymUnmanagedScope* scope)
+    {
+        ULONG32 start = 0;
+        ULONG32 end = 0;
+        EXPECT_EQ(S_OK, scope->GetStartOffset(&start));
+        EXPECT_EQ(S_OK, scope->GetEndOffset(&end));
+        return { start, end };
+    }
+
+    void GetChildren(ISymUnmanagedScope* scope, std::vector<dncp::com_ptr<ISymUnmanagedScope>>& children)
+    {
+        ULONG32 count;
+        ASSERT_EQ(S_OK, scope->GetChildren(0, &count, nullptr));
+        std::vector<ISymUnmanagedScope*> raw(count);
+        ASSERT_EQ(S_OK, scope->GetChildren(count, &count, raw.data()));
+        ASSERT_EQ(raw.size(), count);
+        children = Own(raw);
+    }
+
+    // The names and slots of locals.
+    using Locals = std::vector<std::pair<std::string, ULONG32>>;
+
+    Locals GetLocals(ISymUnmanagedScope* scope)
+    {
+        ULONG32 count = 0;
+        EXPECT_EQ(S_OK, scope->GetLocals(0, &count, nullptr));
+        std::vector<ISymUnmanagedVariable*> raw(count);
+        EXPECT_EQ(S_OK, scope->GetLocals(count, &count, raw.data()));
+        Locals locals;
+        for (dncp::com_ptr<ISymUnmanagedVariable> const& local : Own(raw))
+        {
+            WCHAR name[64];
+            ULONG32 nameLength;
+            EXPECT_EQ(S_OK, local->GetName(ARRAY_SIZE(name), &nameLength, name));
+            ULONG32 slot = 0;
+            EXPECT_EQ(S_OK, local->GetAddressField1(&slot));
+            WSTR_string wideName{ name };
+            locals.emplace_back(std::string{ wideName.begin(), wideName.end() }, slot);
+        }
+        return locals;
+    }
+}
+
+TEST(SymReader, Documents)
+{
+    dncp::com_ptr<ISymUnmanagedReader> reader;
+    ASSERT_NO_FATAL_FAILURE(GetAssetReader("Subject.pdb", reader));
+
+    ULONG32 count;
+    ASSERT_EQ(S_OK, reader->GetDocuments(0, &count, nullptr));
+    ASSERT_EQ(3u, count);
+    std::vector<ISymUnmanagedDocument*> raw(count);
+    ASSERT_EQ(S_OK, reader->GetDocuments(count, &count, raw.data()));
+    ASSERT_EQ(3u, count);
+    std::vector<dncp::com_ptr<ISymUnmanagedDocument>> documents = Own(raw);
+    EXPECT_EQ("/src/Subject.cs", GetUrl(documents[0]));
+    EXPECT_EQ("/src/Other.cs", GetUrl(documents[1]));
+    EXPECT_EQ("/src/OTHER.CS", GetUrl(documents[2]));
+
+    // Documents are found by their exact path.
+    WSTR_string url = W("/src/OTHER.CS");
+    dncp::com_ptr<ISymUnmanagedDocument> document;
+    ASSERT_EQ(S_OK, reader->GetDocument(&url[0], {}, {}, {}, &document));
+    EXPECT_EQ("/src/OTHER.CS", GetUrl(document));
+
+    url = W("/src/Missing.cs");
+    dncp::com_ptr<ISymUnmanagedDocument> missing;
+    EXPECT_EQ(S_FALSE, reader->GetDocument(&url[0], {}, {}, {}, &missing));
+    EXPECT_EQ(nullptr, missing);
+}
+
+TEST(SymReader, SequencePoints)
+{
+    dncp::com_ptr<ISymUnmanagedReader> reader;
+    ASSERT_NO_FATAL_FAILURE(GetAssetReader("Subject.pdb", reader));
+
+    dncp::com_ptr<ISymUnmanagedMethod> method;
+    ASSERT_EQ(S_OK, reader->GetMethod(SubjectHidden, &method));
+    mdMethodDef token;
+    ASSERT_EQ(S_OK, method->GetToken(&token));
+    EXPECT_EQ(SubjectHidden, token);
+
+    ULONG32 count;
+    ASSERT_EQ(S_OK, method->GetSequencePointCount(&count));
+    ASSERT_EQ(5u, count);
+
+    std::vector<ULONG32> offsets(count);
+    std::vector<ISymUnmanagedDocument*> rawDocuments(count);
+    std::vector<ULONG32> lines(count);
+    std::vector<ULONG32> columns(count);
+    std::vector<ULONG32> endLines(count);
+    std::vector<ULONG32> endColumns(count);
+    ASSERT_EQ(S_OK, method->GetSequencePoints(count, &count, offsets.data(), rawDocuments.data(), lines.data(), columns.data(), endLines.data(), endColumns.data()));
+    ASSERT_EQ(5u, count);
+    std::vector<dncp::com_ptr<ISymUnmanagedDocument>> documents = Own(rawDocuments);
+
+    EXPECT_EQ((std::vector<ULONG32>{ 0, 1, 5, 9, 13 }), offsets);
+    // The third point is hidden.
+    EXPECT_EQ((std::vector<ULONG32>{ 24, 25, MD_HIDDEN_SEQUENCE_POINT_LINE, 29, 30 }), lines);
+    EXPECT_EQ((std::vector<ULONG32>{ 9, 13, 0, 13, 9 }), columns);
+    EXPECT_EQ((std::vector<ULONG32>{ 24, 25, MD_HIDDEN_SEQUENCE_POINT_LINE, 29, 30 }), endLines);
+    EXPECT_EQ((std::vector<ULONG32>{ 10, 27, 0, 22, 10 }), endColumns);
+    for (dncp::com_ptr<ISymUnmanagedDocument> const& document : documents)
+        EXPECT_EQ("/src/Subject.cs", GetUrl(document));
+
+    // Methods without sequence points aren't found.
+    dncp::com_ptr<ISymUnmanagedMethod> noPoints;
+    EXPECT_EQ(E_FAIL, reader->GetMethod(SubjectClosureCtor, &noPoints));
+}
+
+TEST(SymReader, Scopes)
+{
+    dncp::com_ptr<ISymUnmanagedReader> reader;
+    ASSERT_NO_FATAL_FAILURE(GetAssetReader("Subject.pdb", reader));
+    dncp::com_ptr<ISymUnmanagedMethod> method;
+    ASSERT_EQ(S_OK, reader->GetMethod(SubjectScopes, &method));
+
+    dncp::com_ptr<ISymUnmanagedScope> root;
+    ASSERT_EQ(S_OK, method->GetRootScope(&root));
+    EXPECT_EQ(std::make_pair(0u, 51u), GetRange(root));
+    dncp::com_ptr<ISymUnmanagedScope> rootParent;
+    ASSERT_EQ(S_OK, root->GetParent(&rootParent));
+    EXPECT_EQ(nullptr, rootParent);
+
+    // The for loop and its body.
+    std::vector<dncp::com_ptr<ISymUnmanagedScope>> children;
+    ASSERT_NO_FATAL_FAILURE(GetChildren(root, children));
+    ASSERT_EQ(1u, children.size());
+    EXPECT_EQ(std::make_pair(6u, 32u), GetRange(children[0]));
+    std::vector<dncp::com_ptr<ISymUnmanagedScope>> grandchildren;
+    ASSERT_NO_FATAL_FAILURE(GetChildren(children[0], grandchildren));
+    ASSERT_EQ(1u, grandchildren.size());
+    EXPECT_EQ(std::make_pair(10u, 20u), GetRange(grandchildren[0]));
+    std::vector<dncp::com_ptr<ISymUnmanagedScope>> leaves;
+    ASSERT_NO_FATAL_FAILURE(GetChildren(grandchildren[0], leaves));
+    EXPECT_TRUE(leaves.empty());
+
+    // The innermost scope at an offset is returned and its parents can be walked.
+    dncp::com_ptr<ISymUnmanagedScope> inner;
+    ASSERT_EQ(S_OK, method->GetScopeFromOffset(12, &inner));
+    EXPECT_EQ(std::make_pair(10u, 20u), GetRange(inner));
+    dncp::com_ptr<ISymUnmanagedScope> parent;
+    ASSERT_EQ(S_OK, inner->GetParent(&parent));
+    EXPECT_EQ(std::make_pair(6u, 32u), GetRange(parent));
+
+    // The end of a scope is in its parent.
+    dncp::com_ptr<ISymUnmanagedScope> atEnd;
+    ASSERT_EQ(S_OK, method->GetScopeFromOffset(20, &atEnd));
+    EXPECT_EQ(std::make_pair(6u, 32u), GetRange(atEnd));
+}
+
+TEST(SymReader, LocalsAndConstants)
+{
+    dncp::com_ptr<ISymUnmanagedReader> reader;
+    ASSERT_NO_FATAL_FAILURE(GetAssetReader("Subject.pdb", reader));
+    dncp::com_ptr<ISymUnmanagedScope2> root;
+    ASSERT_NO_FATAL_FAILURE(GetRootScope(reader, SubjectScopes, root));
+
+    // Locals are only returned from the scope that declares them.
+    EXPECT_EQ((Locals{ { "a", 0 } }), GetLocals(root));
+    std::vector<dncp::com_ptr<ISymUnmanagedScope>> children;
+    ASSERT_NO_FATAL_FAILURE(GetChildren(root, children));
+    ASSERT_EQ(1u, children.size());
+    EXPECT_EQ((Locals{ { "i", 1 } }), GetLocals(children[0]));
+    std::vector<dncp::com_ptr<ISymUnmanagedScope>> grandchildren;
+    ASSERT_NO_FATAL_FAILURE(GetChildren(children[0], grandchildren));
+    ASSERT_EQ(1u, grandchildren.size());
+    EXPECT_EQ((Locals{ { "square", 2 } }), GetLocals(grandchildren[0]));
+
+    ULONG32 count;
+    ASSERT_EQ(S_OK, root->GetConstantCount(&count));
+    EXPECT_EQ(2u, count);
+
+    VARIANT value;
+    dncp::com_ptr<ISymUnmanagedConstant> number;
+    ASSERT_NO_FATAL_FAILURE(GetConstant(root, W("K"), number));
+    ASSERT_EQ(S_OK, number->GetValue(&value));
+    ASSERT_EQ(VT_I4, V_VT(&value));
+    EXPECT_EQ(42, V_I4(&value));
+
+    dncp::com_ptr<ISymUnmanagedConstant> text;
+    ASSERT_NO_FATAL_FAILURE(GetConstant(root, W("S"), text));
+    ASSERT_EQ(S_OK, text->GetValue(&value));
+    ASSERT_EQ(VT_BSTR, V_VT(&value));
+    EXPECT_EQ(WSTR_string{ W("text") }, WSTR_string(V_BSTR(&value), 4));
+    ::SysFreeString(V_BSTR(&value));
+
+    // The constant's signature is its LocalConstantSig blob, starting with the type.
+    BYTE signature[16];
+    ULONG32 signatureLength;
+    ASSERT_EQ(S_OK, number->GetSignature(ARRAY_SIZE(signature), &signatureLength, signature));
+    ASSERT_LT(0u, signatureLength);
+    EXPECT_EQ(ELEMENT_TYPE_I4, signature[0]);
+}
+
+TEST(SymReader, MethodFromDocumentPosition)
+{
+    dncp::com_ptr<ISymUnmanagedReader> reader;
+    ASSERT_NO_FATAL_FAILURE(GetAssetReader("Subject.pdb", reader));
+
+    WSTR_string url = W("/src/Subject.cs");
+    dncp::com_ptr<ISymUnmanagedDocument> document;
+    ASSERT_EQ(S_OK, reader->GetDocument(&url[0], {}, {}, {}, &document));
+
+    dncp::com_ptr<ISymUnmanagedMethod> method;
+    ASSERT_EQ(S_OK, reader->GetMethodFromDocumentPosition(document, 17, 0, &method));
+    mdMethodDef token;
+    ASSERT_EQ(S_OK, method->GetToken(&token));
+    EXPECT_EQ(SubjectScopes, token);
+
+    // The lambda's body is inside the method that creates it, which is returned first.
+    dncp::com_ptr<ISymUnmanagedMethod> outer;
+    ASSERT_EQ(S_OK, reader->GetMethodFromDocumentPosition(document, 36, 0, &outer));
+    ASSERT_EQ(S_OK, outer->GetToken(&token));
+    EXPECT_EQ(SubjectLambda, token);
+
+    ULONG32 count;
+    ASSERT_EQ(S_OK, reader->GetMethodsFromDocumentPosition(document, 36, 0, 0, &count, nullptr));
+    ASSERT_EQ(2u, count);
+    std::vector<ISymUnmanagedMethod*> raw(count);
+    ASSERT_EQ(S_OK, reader->GetMethodsFromDocumentPosition(document, 36, 0, count, &count, raw.data()));
+    std::vector<dncp::com_ptr<ISymUnmanagedMethod>> methods = Own(raw);
+    ASSERT_EQ(S_OK, methods[1]->GetToken(&token));
+    EXPECT_EQ(SubjectLambdaBody, token);
+
+    // Lines between methods aren't in any method.
+    dncp::com_ptr<ISymUnmanagedMethod> none;
+    EXPECT_EQ(E_FAIL, reader->GetMethodFromDocumentPosition(document, 22, 0, &none));
+    EXPECT_EQ(nullptr, none);
+
+    // Methods are found in the document they're in.
+    url = W("/src/Other.cs");
+    dncp::com_ptr<ISymUnmanagedDocument> other;
+    ASSERT_EQ(S_OK, reader->GetDocument(&url[0], {}, {}, {}, &other));
+    dncp::com_ptr<ISymUnmanagedMethod> otherMethod;
+    ASSERT_EQ(S_OK, reader->GetMethodFromDocumentPosition(other, 3, 0, &otherMethod));
+    ASSERT_EQ(S_OK, otherMethod->GetToken(&token));
+    EXPECT_EQ(SubjectOther, token);
+}
@@ -31,6 +31,10 @@ namespace
     IMetaDataImport* g_baselineImport;
     IMetaDataImport* g_currentImport;
 
+    // Read-write imports that synchronize with the given thread-safety strategy.
+    IMetaDataImport* g_lockImport;
+    IMetaDataImport* g_snapshotImport;
+
     HRESULT CreateImport(IMetaDataDispenser* disp, IMetaDataImport** import)
     {
         assert(disp != nullptr && import != nullptr);
@@ -42,6 +46,34 @@ namespace
             reinterpret_cast<IUnknown**>(import));
     }
 
+    HRESULT CreateThreadSafeImport(DNMDThreadSafetyStrategy strategy, IMetaDataImport** import)
+    {
+        assert(import != nullptr);
+        IMetaDataDispenserEx* disp;
+        RETURN_IF_FAILED(GetDispenser(IID_IMetaDataDispenserEx, reinterpret_cast<void**>(&disp)));
+
+        VARIANT vt;
+        V_VT(&vt) = VT_UI4;
+        V_UI4(&vt) = MDThreadSafetyOn;
+        HRESULT hr = disp->SetOption(MetaDataThreadSafetyOptions, &vt);
+        if (SUCCEEDED(hr))
+        {
+            V_UI4(&vt) = strategy;
+            hr = disp->SetOption(MetaDataDNMDThreadSafetyStrategy, &vt);
+        }
+        if (SUCCEEDED(hr))
+        {
+            hr = disp->OpenScopeOnMemory(
+                g_data,
+                g_dataLen,
+                CorOpenFlags::ofWrite,
+                IID_IMetaDataImport,
+                reinterpret_cast<IUnknown**>(import));
+        }
+        (void)disp->Release();
+        return hr;
+    }
+
     HRESULT EnumTypeDefs(IMetaDataImport* import)
     {
         assert(import != nullptr);
@@ -87,6 +119,55 @@ namespace
         uint32_t dataLen;
         return import->GetCustomAttributeByName(tk, W("NotAnAttribute"), &data, (ULONG*)&dataLen);
     }
+
+    HRESULT GetFieldMarshals(IMetaDataImport* import)
+    {
+        assert(import != nullptr);
+        // Most fields have no marshalling information, so this mostly measures failed lookups.
+        PCCOR_SIGNATURE nativeType;
+        ULONG nativeTypeLen;
+        for (uint32_t rid = 1; rid <= 64; ++rid)
+        {
+            HRESULT hr = import->GetFieldMarshal(TokenFromRid(rid, mdtFieldDef), &nativeType, &nativeTypeLen);
+            if (FAILED(hr) && hr != CLDB_E_RECORD_NOTFOUND)
+                return hr;
+        }
+        return S_OK;
+    }
+
+    HRESULT GetNativeCallConvs(IMetaDataImport* import)
+    {
+        assert(import != nullptr);
+        // Inspect method signatures from the metadata, as the JIT does for calli and P/Invoke stubs.
+        mdTypeDef parent;
+        ULONG nameLen;
+        DWORD attrs;
+        PCCOR_SIGNATURE sig;
+        ULONG sigLen;
+        ULONG rva;
+        DWORD implFlags;
+        ULONG callConv;
+        for (uint32_t rid = 1; rid <= 64; ++rid)
+        {
+            HRESULT hr = import->GetMethodProps(TokenFromRid(rid, mdtMethodDef), &parent, nullptr, 0, &nameLen, &attrs, &sig, &sigLen, &rva, &implFlags);
+            if (FAILED(hr))
+                return hr;
+
+            if (FAILED(hr = import->GetNativeCallConvFromSig(sig, sigLen, &callConv)))
+                return hr;
+        }
+        return S_OK;
+    }
+
+    HRESULT GetTypeDefProps(IMetaDataImport* import, uint32_t rid)
+    {
+        assert(import != nullptr);
+        WCHAR name[512];
+        ULONG nameLen;
+        DWORD flags;
+        mdToken extends;
+        return import->GetTypeDefProps(TokenFromRid(rid, mdtTypeDef), name, ARRAY_SIZE(name), &nameLen, &flags, &extends);
+    }
 }
 
 HRESULT PerfInitialize(
@@ -103,6 +184,10 @@ HRESULT PerfInitialize(
 
     RETURN_IF_FAILED(CreateImport(g_currentDisp, &g_currentImport));
 
+    RETURN_IF_FAILED(CreateThreadSafeImport(DNMDThreadSafetyLock, &g_lockImport));
+
+    RETURN_IF_FAILED(CreateThreadSafeImport(DNMDThreadSafetySnapshot, &g_snapshotImport));
+
     return S_OK;
 }
 
@@ -178,6 +263,52 @@ void EnumCustomAttributeByName(benchmark::State& state, IMetaDataImport* import)
 
 IMPORT_BENCHMARK(EnumCustomAttributeByName);
 
+void GetFieldMarshals(benchmark::State& state, IMetaDataImport* import)
+{
+    HRESULT hr;
+    for (auto _ : state)
+    {
+        if (FAILED(hr = GetFieldMarshals(import)))
+        {
+            state.SkipWithError("Failed to get field marshals");
+        }
+    }
+}
+
+IMPORT_BENCHMARK(GetFieldMarshals);
+
+void GetNativeCallConvFromSig(benchmark::State& state, IMetaDataImport* import)
+{
+    HRESULT hr;
+    for (auto _ : state)
+    {
+        if (FAILED(hr = GetNativeCallConvs(import)))
+        {
+            state.SkipWithError("Failed to get native calling conventions");
+        }
+    }
+}
+
+IMPORT_BENCHMARK(GetNativeCallConvFromSig);
+
+// Measure how reads on a thread-safe read-write import scale with the number of reading threads.
+void ConcurrentGetTypeDefProps(benchmark::State& state, IMetaDataImport* import)
+{
+    // Each thread walks the first TypeDef rows from a different starting point.
+    uint32_t const rowCount = 256;
+    uint32_t rid = (uint32_t)state.thread_index() * 31;
+    for (auto _ : state)
+    {
+        if (FAILED(GetTypeDefProps(import, (rid++ % rowCount) + 1)))
+        {
+            state.SkipWithError("Failed to get typedef props");
+        }
+    }
+}
+
+BENCHMARK_CAPTURE(ConcurrentGetTypeDefProps, LockConcurrentGetTypeDefProps, g_lockImport)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_CAPTURE(ConcurrentGetTypeDefProps, SnapshotConcurrentGetTypeDefProps, g_snapshotImport)->ThreadRange(1, 8)->UseRealTime();
+
 int main(int argc, char** argv)
 {
     RETURN_IF_FAILED(pal::GetBaselineMetadataDispenser(&g_baselineDisp));